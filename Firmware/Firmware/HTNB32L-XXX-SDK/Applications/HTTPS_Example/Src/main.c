@@ -14,6 +14,9 @@
  */
 
 #include "main.h"
+#ifdef MW_KVCFG_ENABLE
+#include "mw_kvcfg.h"
+#endif
 
 /* HTTP HOST */
 #define TEST_HOST "https://api.openweathermap.org/"
@@ -44,14 +47,25 @@ static void HT_SetConnectioParameters(void) {
     uint8_t bandNum = 1; //number of bands that will be configured
     uint8_t band = 28; //band 28 for TIM network provider
 
+#ifdef MW_KVCFG_ENABLE
+    // Settings kept with mwKvCfgSet() take the place of the defaults here
+    mwKvCfgInit();
+    mwKvCfgGet("band", &band, sizeof(band));
+#endif
+
     ret = appSetBandModeSync(networkMode, bandNum, &band);
     if(ret != CMS_RET_SUCC) {
         while(1);
     }
 
     apnSetting.cid = 0;
+#ifdef MW_KVCFG_ENABLE
+    mwKvCfgGetStr("apn", (CHAR *)apnSetting.apnStr, sizeof(apnSetting.apnStr), "nbiot.gsim");
+    apnSetting.apnLength = strlen((char *)apnSetting.apnStr);
+#else
     apnSetting.apnLength = strlen("nbiot.gsim");
     strcpy((char *)apnSetting.apnStr, "nbiot.gsim");
+#endif
     apnSetting.pdnType = CMI_PS_PDN_TYPE_IP_V4V6;
     appSetAPNSettingSync(&apnSetting, &cid);
 }
@@ -14,6 +14,9 @@
  */
 
 #include "main.h"
+#ifdef MW_KVCFG_ENABLE
+#include "mw_kvcfg.h"
+#endif
 #include "ps_lib_api.h"
 #include "flash_qcx212.h"
 
@@ -45,14 +48,25 @@ static void HT_SetConnectioParameters(void) {
     uint8_t bandNum = 1;
     uint8_t band = 28;
 
+#ifdef MW_KVCFG_ENABLE
+    // Settings kept with mwKvCfgSet() take the place of the defaults here
+    mwKvCfgInit();
+    mwKvCfgGet("band", &band, sizeof(band));
+#endif
+
     ret = appSetBandModeSync(networkMode, bandNum, &band);
     if(ret == CMS_RET_SUCC) {
         printf("SetBand Result: %d\n", ret);
     }
 
     apnSetting.cid = 0;
+#ifdef MW_KVCFG_ENABLE
+    mwKvCfgGetStr("apn", (CHAR *)apnSetting.apnStr, sizeof(apnSetting.apnStr), "nbiot.gsim");
+    apnSetting.apnLength = strlen((char *)apnSetting.apnStr);
+#else
     apnSetting.apnLength = strlen("nbiot.gsim");
     strcpy((char *)apnSetting.apnStr, "nbiot.gsim");
+#endif
     apnSetting.pdnType = CMI_PS_PDN_TYPE_IP_V4V6;
     ret = appSetAPNSettingSync(&apnSetting, &cid);
 }
@@ -14,6 +14,9 @@
  */
 
 #include "HT_Fsm.h"
+#ifdef MW_KVCFG_ENABLE
+#include "mw_kvcfg.h"
+#endif
 
 /* Function prototypes  ------------------------------------------------------------------*/
 
@@ -175,12 +178,22 @@ static uint8_t mqtt_payload[128] = {"Undefined Button"};
 static uint8_t mqttSendbuf[HT_MQTT_BUFFER_SIZE] = {0};
 static uint8_t mqttReadbuf[HT_MQTT_BUFFER_SIZE] = {0};
 
+#ifdef MW_KVCFG_ENABLE
+//Read from the mw_kvcfg keys mqtt.client, mqtt.user and mqtt.pass, defaults in HT_FSM_MQTTConnect().
+static char clientID[32];
+static char username[32];
+static char password[32];
+
+//MQTT broker host address, key mqtt.host.
+static char addr[64];
+#else
 static const char clientID[] = {"SIP_HTNB32L-XXX"};
 static const char username[] = {""};
 static const char password[] = {""};
 
 //MQTT broker host address
 static const char addr[] = {"test.mosquitto.org"};
+#endif
 static char topic[25] = {0};
 
 // Blue button topic where the digital twin will transmit its messages.
@@ -304,6 +317,13 @@ static void HT_FSM_LedStatus(HT_Led_Type led, uint16_t state) {
 
 static HT_ConnectionStatus HT_FSM_MQTTConnect(void) {
 
+#ifdef MW_KVCFG_ENABLE
+    mwKvCfgGetStr("mqtt.host", addr, sizeof(addr), "test.mosquitto.org");
+    mwKvCfgGetStr("mqtt.client", clientID, sizeof(clientID), "SIP_HTNB32L-XXX");
+    mwKvCfgGetStr("mqtt.user", username, sizeof(username), "");
+    mwKvCfgGetStr("mqtt.pass", password, sizeof(password), "");
+#endif
+
     // Connect to MQTT Broker using client, network and parameters needded. 
     if(HT_MQTT_Connect(&mqttClient, &mqttNetwork, (char *)addr, HT_MQTT_PORT, HT_MQTT_SEND_TIMEOUT, HT_MQTT_RECEIVE_TIMEOUT,
                 (char *)clientID, (char *)username, (char *)password, HT_MQTT_VERSION, HT_MQTT_KEEP_ALIVE_INTERVAL, mqttSendbuf, HT_MQTT_BUFFER_SIZE, mqttReadbuf, HT_MQTT_BUFFER_SIZE)) {
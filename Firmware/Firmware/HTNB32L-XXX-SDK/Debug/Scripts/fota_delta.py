@@ -0,0 +1,337 @@
+#   _    _ _______   __  __ _____ _____ _____   ____  _   _
+#  | |  | |__   __| |  \/  |_   _/ ____|  __ \ / __ \| \ | |
+#  | |__| |  | |    | \  / | | || |    | |__) | |  | |  \| |
+#  |  __  |  | |    | |\/| | | || |    |  _  /| |  | | . ` |
+#  | |  | |  | |    | |  | |_| || |____| | \ \| |__| | |\  |
+#  |_|  |_|  |_|    |_|  |_|_____\_____|_|  \_\\____/|_| \_|
+#  =================== Advanced R&D ========================
+
+#  Copyright (c) 2024 HT Micron Semicondutores S.A.
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#  http://www.apache.org/licenses/LICENSE-2.0
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+# file: fota_delta.py
+# brief: Makes, applies and inspects the delta update patches of mw_delta.
+# author: HT Micron Advanced R&D
+# link: https://github.com/htmicron
+# version: 0.1
+# date: October 19, 2026
+#
+# usage: python fota_delta.py make <old.bin> <new.bin> <patch.bin>
+#        python fota_delta.py apply <old.bin> <patch.bin> <new.bin>
+#        python fota_delta.py info <patch.bin>
+#
+# <old.bin> is the application image running on the board, exactly as it
+# was flashed at APP_FLASH_LOAD_ADDR; the board refuses a patch made
+# against any other one. "make" applies the patch it wrote and compares
+# the result with <new.bin> before returning. "apply" rebuilds the image
+# the way the board does, to check a patch without one.
+#
+# Format (see mw_delta.c): an 88-byte header, then operations on a read
+# pointer into the old image, each an opcode byte and a LEB128 varint:
+#   1 COPY n          n old bytes
+#   2 ADD n, d[n]     n old bytes, each plus a byte of d (mod 256)
+#   3 INSERT n, b[n]  n new bytes
+#   4 SEEK delta      move the read pointer, zigzag coded
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+MAGIC = 0x544C444D
+VERSION = 1
+HDR = struct.Struct("<IHHIII32s32s")
+HDR_SIZE = HDR.size + 4
+
+OP_COPY = 1
+OP_ADD = 2
+OP_INSERT = 3
+OP_SEEK = 4
+
+# FLASH_FOTA_REGION_LEN of mem_map.h
+FOTA_REGION_LEN = 0x80000
+
+KEY_LEN = 8         # bytes hashed to find a match elsewhere in the old image
+MIN_RUN = 8         # exact bytes at the read pointer worth a COPY
+MIN_MATCH = 16      # exact bytes elsewhere worth a SEEK and a COPY
+WINDOW = 16         # bytes compared to tell a changed byte (ADD) from a new one (INSERT)
+MIN_SIMILAR = 6     # of WINDOW, equal for ADD
+
+
+def varint(n):
+    out = bytearray()
+    while True:
+        b = n & 0x7F
+        n >>= 7
+        if n:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(n):
+    return (n << 1) if n >= 0 else ((-n << 1) - 1)
+
+
+def match_len(a, i, b, j):
+    """Length of the run of equal bytes of a from i and b from j."""
+    n = 0
+    limit = min(len(a) - i, len(b) - j)
+    while n + 32 <= limit and a[i + n:i + n + 32] == b[j + n:j + n + 32]:
+        n += 32
+    while n < limit and a[i + n] == b[j + n]:
+        n += 1
+    return n
+
+
+class Encoder(object):
+    """Collects operations, merging neighbours of the same kind."""
+
+    def __init__(self):
+        self.out = bytearray()
+        self.kind = None
+        self.data = bytearray()
+        self.count = 0
+        self.stats = {"copy": 0, "add": 0, "insert": 0, "seek": 0}
+
+    def flush(self):
+        if self.kind == OP_COPY:
+            self.out += bytes([OP_COPY]) + varint(self.count)
+            self.stats["copy"] += self.count
+        elif self.kind in (OP_ADD, OP_INSERT):
+            self.out += bytes([self.kind]) + varint(len(self.data)) + self.data
+            self.stats["add" if self.kind == OP_ADD else "insert"] += len(self.data)
+        self.kind = None
+        self.data = bytearray()
+        self.count = 0
+
+    def _switch(self, kind):
+        if self.kind != kind:
+            self.flush()
+            self.kind = kind
+
+    def copy(self, n):
+        self._switch(OP_COPY)
+        self.count += n
+
+    def add(self, d):
+        self._switch(OP_ADD)
+        self.data.append(d)
+
+    def insert(self, b):
+        self._switch(OP_INSERT)
+        self.data.append(b)
+
+    def seek(self, delta):
+        self.flush()
+        self.out += bytes([OP_SEEK]) + varint(zigzag(delta))
+        self.stats["seek"] += 1
+
+
+def diff(old, new):
+    """Operations rebuilding new from old."""
+    index = {}
+    for o in range(len(old) - KEY_LEN, -1, -2):
+        index[old[o:o + KEY_LEN]] = o
+
+    enc = Encoder()
+    p = 0
+    s = 0
+    while p < len(new):
+        r = match_len(new, p, old, s)
+        if r >= MIN_RUN:
+            enc.copy(r)
+            p += r
+            s += r
+            continue
+
+        o = index.get(new[p:p + KEY_LEN])
+        if o is not None and o != s:
+            r = match_len(new, p, old, o)
+            if r >= MIN_MATCH:
+                enc.seek(o - s)
+                enc.copy(r)
+                p += r
+                s = o + r
+                continue
+
+        similar = sum(1 for a, b in zip(new[p:p + WINDOW], old[s:s + WINDOW]) if a == b)
+        if similar >= MIN_SIMILAR:
+            enc.add((new[p] - old[s]) & 0xFF)
+            s += 1
+        else:
+            enc.insert(new[p])
+        p += 1
+    enc.flush()
+    return bytes(enc.out), enc.stats
+
+
+def make_header(old, new, body):
+    hdr = HDR.pack(MAGIC, VERSION, HDR_SIZE, len(old), len(new), len(body),
+                   hashlib.sha256(old).digest(), hashlib.sha256(new).digest())
+    return hdr + struct.pack("<I", zlib.crc32(hdr) & 0xFFFFFFFF)
+
+
+def parse_header(patch):
+    if len(patch) < HDR_SIZE:
+        raise ValueError("patch shorter than its header")
+    fields = HDR.unpack_from(patch)
+    (crc,) = struct.unpack_from("<I", patch, HDR.size)
+    if fields[0] != MAGIC or fields[1] != VERSION or fields[2] != HDR_SIZE:
+        raise ValueError("not a version %d delta patch" % VERSION)
+    if crc != zlib.crc32(patch[:HDR.size]) & 0xFFFFFFFF:
+        raise ValueError("header CRC mismatch")
+    keys = ("magic", "version", "hdr_size", "old_size", "new_size", "body_size", "old_hash", "new_hash")
+    return dict(zip(keys, fields))
+
+
+def read_varint(buf, i):
+    n = 0
+    shift = 0
+    while True:
+        if i >= len(buf) or shift > 28:
+            raise ValueError("bad varint at %d" % i)
+        b = buf[i]
+        i += 1
+        n |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return n, i
+
+
+def patch(old, patch_data):
+    """Rebuild the new image, checking what the board checks."""
+    hdr = parse_header(patch_data)
+    if hdr["old_size"] != len(old) or hashlib.sha256(old).digest() != hdr["old_hash"]:
+        raise ValueError("patch made against another old image")
+    body = patch_data[HDR_SIZE:]
+    if len(body) != hdr["body_size"]:
+        raise ValueError("patch body is %d bytes, header says %d" % (len(body), hdr["body_size"]))
+
+    new = bytearray()
+    i = 0
+    s = 0
+    while i < len(body):
+        op = body[i]
+        n, i = read_varint(body, i + 1)
+        if op == OP_SEEK:
+            s += (n >> 1) ^ -(n & 1)
+            if not 0 <= s <= len(old):
+                raise ValueError("seek out of the old image")
+        elif op == OP_COPY:
+            if s + n > len(old):
+                raise ValueError("copy past the old image")
+            new += old[s:s + n]
+            s += n
+        elif op == OP_ADD:
+            if s + n > len(old) or i + n > len(body):
+                raise ValueError("add past the old image or the patch")
+            new += bytes((a + d) & 0xFF for a, d in zip(old[s:s + n], body[i:i + n]))
+            s += n
+            i += n
+        elif op == OP_INSERT:
+            if i + n > len(body):
+                raise ValueError("insert past the patch")
+            new += body[i:i + n]
+            i += n
+        else:
+            raise ValueError("bad opcode %d at %d" % (op, i))
+        if len(new) > hdr["new_size"]:
+            raise ValueError("patch makes a larger image than its header says")
+
+    if len(new) != hdr["new_size"] or hashlib.sha256(new).digest() != hdr["new_hash"]:
+        raise ValueError("rebuilt image fails its hash")
+    return bytes(new)
+
+
+def read_file(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def write_file(path, data):
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def cmd_make(args):
+    old = read_file(args.old)
+    new = read_file(args.new)
+    if len(new) > FOTA_REGION_LEN:
+        print("%s is %d bytes, the FOTA region holds %d" % (args.new, len(new), FOTA_REGION_LEN))
+        return 1
+
+    body, stats = diff(old, new)
+    data = make_header(old, new, body) + body
+    if patch(old, data) != new:
+        print("internal error: the patch does not rebuild %s" % args.new)
+        return 1
+    write_file(args.patch, data)
+
+    print("old %d bytes, new %d bytes, patch %d bytes (%.1f%% of the new image)"
+          % (len(old), len(new), len(data), 100.0 * len(data) / max(1, len(new))))
+    print("copied %d, added %d, inserted %d bytes, %d seeks"
+          % (stats["copy"], stats["add"], stats["insert"], stats["seek"]))
+    return 0
+
+
+def cmd_apply(args):
+    try:
+        new = patch(read_file(args.old), read_file(args.patch))
+    except ValueError as e:
+        print("%s: %s" % (args.patch, e))
+        return 1
+    write_file(args.new, new)
+    print("%s rebuilt, %d bytes, SHA-256 %s" % (args.new, len(new), hashlib.sha256(new).hexdigest()))
+    return 0
+
+
+def cmd_info(args):
+    try:
+        hdr = parse_header(read_file(args.patch))
+    except ValueError as e:
+        print("%s: %s" % (args.patch, e))
+        return 1
+    print("old image %d bytes, SHA-256 %s" % (hdr["old_size"], hdr["old_hash"].hex()))
+    print("new image %d bytes, SHA-256 %s" % (hdr["new_size"], hdr["new_hash"].hex()))
+    print("body %d bytes" % hdr["body_size"])
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="delta update patches of mw_delta")
+    sub = parser.add_subparsers(dest="cmd")
+    p = sub.add_parser("make", help="make a patch from old.bin to new.bin")
+    p.add_argument("old")
+    p.add_argument("new")
+    p.add_argument("patch")
+    p = sub.add_parser("apply", help="rebuild new.bin from old.bin and a patch")
+    p.add_argument("old")
+    p.add_argument("patch")
+    p.add_argument("new")
+    p = sub.add_parser("info", help="print the header of a patch")
+    p.add_argument("patch")
+    args = parser.parse_args()
+
+    if args.cmd == "make":
+        return cmd_make(args)
+    if args.cmd == "apply":
+        return cmd_apply(args)
+    if args.cmd == "info":
+        return cmd_info(args)
+    parser.print_help()
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
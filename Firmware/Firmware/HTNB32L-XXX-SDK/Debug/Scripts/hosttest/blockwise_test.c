@@ -0,0 +1,396 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * coap_blockwise.c on the host: the Block option codec; the block size
+ * picked from MTU and measured loss; a body sent over a lossy link with
+ * plain Block1, one block per round trip, and with Q-Block1 sets answered
+ * by 2.31 or a 4.08 missing-blocks list, both reassembled byte for byte at
+ * the server and the round trips compared; a Q-Block2 download through the
+ * receiver bitmap with its missing list; resizing at a set boundary.
+ * "bench" sweeps the loss rate and prints the round trips of both.
+ *
+ * er-coap-13.c is prebuilt, coap_serialize_get_size() is below.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "coap-internal.h"
+#include "coap_blockwise.h"
+
+#define BODY_MAX            (64 * 1024)
+
+static uint8_t body[BODY_MAX], rcvd[BODY_MAX];
+static uint8_t have[BODY_MAX / 16];
+static uint32_t lossSeed;
+
+size_t coap_serialize_get_size(void *packet)
+{
+    return 12 + ((qapi_Coap_Packet_t *)packet)->payload_len;
+}
+
+/* Deterministic loss, per mille */
+static int lost(uint32_t lossPm)
+{
+    lossSeed = lossSeed * 1103515245u + 12345u;
+    return (lossSeed >> 16) % 1000 < lossPm;
+}
+
+static void fillBody(uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+        body[i] = (uint8_t)(i * 7 + (i >> 8));
+    memset(rcvd, 0, sizeof(rcvd));
+    memset(have, 0, sizeof(have));
+}
+
+/* The server stores a block it received */
+static void serverStore(const coap_bw_block_t *blk)
+{
+    memcpy(rcvd + blk->offset, body + blk->offset, blk->len);
+    have[blk->num] = 1;
+}
+
+static void testCodec(void)
+{
+    uint32_t num, i;
+    uint8_t more, szx;
+
+    srand(1);
+    for (i = 0; i < 100000; i++)
+    {
+        uint32_t n = (uint32_t)rand() & 0xFFFFF;
+        uint8_t m = (uint8_t)(rand() & 1), s = (uint8_t)(rand() % 7);
+
+        coap_bw_block_decode(coap_bw_block_encode(n, m, s), &num, &more, &szx);
+        HOST_CHECK(num == n && more == m && szx == s);
+    }
+    HOST_CHECK(coap_bw_block_encode(2, 1, 6) == 0x2E);
+    HOST_CHECK(coap_bw_size_to_szx(16) == 0 && coap_bw_size_to_szx(31) == 0 && coap_bw_size_to_szx(32) == 1);
+    HOST_CHECK(coap_bw_size_to_szx(1024) == 6 && coap_bw_size_to_szx(4096) == 6 && coap_bw_size_to_szx(0) == 0);
+    HOST_CHECK(coap_bw_option_for_type(QAPI_COAP_BLOCK1_OPTION, false) == COAP_OPTION_BLOCK1);
+    HOST_CHECK(coap_bw_option_for_type(QAPI_COAP_BLOCK2_OPTION, true) == COAP_OPTION_Q_BLOCK2);
+    HOST_CHECK(coap_bw_option_for_type(QAPI_COAP_BLOCK_OPTION_NONE, true) == 0);
+    printf("codec: Block option values, SZX of a size, option of a block type\n");
+}
+
+static void testSelect(void)
+{
+    coap_bw_link_t link;
+    qapi_Coap_Packet_t pkt;
+    uint8_t szx, prev = COAP_BW_SZX_MAX;
+    uint16_t loss;
+    int i;
+
+    /* Without loss the largest block the MTU takes */
+    coap_bw_link_init(&link, 1280, false, true);
+    HOST_CHECK(link.overhead == COAP_BW_IPV4_UDP_OVERHEAD + COAP_BW_DTLS_OVERHEAD);
+    HOST_CHECK(coap_bw_select_szx(&link, 20) == 6);
+    coap_bw_link_set_mtu(&link, 576);
+    HOST_CHECK(coap_bw_select_szx(&link, 20) == 4);
+    coap_bw_link_set_mtu(&link, 0);
+    HOST_CHECK(link.path_mtu == COAP_BW_DEFAULT_PATH_MTU);
+    coap_bw_link_init(&link, 60, true, true);
+    HOST_CHECK(coap_bw_select_szx(&link, 20) == COAP_BW_SZX_MIN);
+    HOST_CHECK(coap_bw_select_szx(NULL, 20) == COAP_BW_SZX_MAX);
+
+    /* Smaller blocks as the loss grows, never larger */
+    coap_bw_link_init(&link, 1280, false, true);
+    for (loss = 0; loss <= 900; loss += 25)
+    {
+        link.loss_pm = loss;
+        szx = coap_bw_select_szx(&link, 20);
+        HOST_CHECK(szx <= prev);
+        prev = szx;
+    }
+    HOST_CHECK(prev == 4);
+    link.loss_pm = 300;
+    HOST_CHECK(coap_bw_select_szx(&link, 20) == 5);
+
+    /* The loss estimate follows the retransmissions */
+    coap_bw_link_init(&link, 1280, false, true);
+    for (i = 0; i < 60; i++)
+        coap_bw_link_on_exchange(&link, 600, 2);
+    HOST_CHECK(link.loss_pm >= 480 && link.loss_pm <= 500);
+    HOST_CHECK(link.loss_ref_len >= 600 && link.loss_ref_len < 620);
+    HOST_CHECK(link.exchanges == 60 && link.retransmissions == 60);
+    for (i = 0; i < 80; i++)
+        coap_bw_link_on_exchange(&link, 0, 1);
+    HOST_CHECK(link.loss_pm < 20 && link.loss_ref_len >= 600);
+    coap_bw_link_on_exchange(&link, 600, 0);
+    HOST_CHECK(link.exchanges == 140);
+
+    /* AUTO resolved on the link, an explicit size kept */
+    coap_bw_link_init(&link, 1280, false, true);
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.payload_len = 100;
+    HOST_CHECK(coap_bw_block_size(&link, &pkt, 256) == 256);
+    HOST_CHECK(coap_bw_block_size(&link, &pkt, COAP_BW_BLOCK_SIZE_AUTO) == 1024);
+    HOST_CHECK(coap_bw_block_size(NULL, &pkt, COAP_BW_BLOCK_SIZE_AUTO) == COAP_BW_BLOCK_SIZE_AUTO);
+    printf("select: MTU bound, smaller blocks with loss (%d bytes at 30%%), AUTO resolved\n",
+           COAP_BW_SZX_TO_SIZE(5));
+}
+
+/* Plain Block1: every block is a CON waiting for its 2.31 */
+static uint32_t sendBlock1(uint32_t len, uint8_t szx, uint32_t lossPm)
+{
+    coap_bw_window_t win;
+    coap_bw_block_t blk;
+    uint32_t rtt = 0;
+
+    fillBody(len);
+    HOST_CHECK(coap_bw_window_init(&win, COAP_OPTION_BLOCK1, len, szx, 0) == 0);
+    HOST_CHECK(win.max_payloads == 1);
+    while (!coap_bw_window_done(&win))
+    {
+        HOST_CHECK(coap_bw_window_next(&win, &blk));
+        HOST_CHECK(blk.last_of_set && !coap_bw_window_next(&win, &blk));
+        rtt++;
+        if (lost(lossPm))
+        {
+            coap_bw_window_timeout(&win);
+            continue;
+        }
+        serverStore(&blk);
+        if (lost(lossPm))
+        {
+            coap_bw_window_timeout(&win);
+            continue;
+        }
+        coap_bw_window_ack(&win, blk.num);
+    }
+    HOST_CHECK(memcmp(rcvd, body, len) == 0);
+    return rtt;
+}
+
+/* CBOR sequence of the blocks of the set the server lacks */
+static size_t missingList(const coap_bw_window_t *win, uint8_t *cbor)
+{
+    size_t n = 0;
+    uint32_t num;
+
+    for (num = win->set_base; num < win->set_base + win->set_len; num++)
+    {
+        if (have[num])
+            continue;
+        if (num < 24)
+        {
+            cbor[n++] = (uint8_t)num;
+        }
+        else if (num < 256)
+        {
+            cbor[n++] = 24;
+            cbor[n++] = (uint8_t)num;
+        }
+        else
+        {
+            cbor[n++] = 25;
+            cbor[n++] = (uint8_t)(num >> 8);
+            cbor[n++] = (uint8_t)num;
+        }
+    }
+    return n;
+}
+
+/* Q-Block1: a set of NONs ending with a CON, one answer per set */
+static uint32_t sendQBlock1(uint32_t len, uint8_t szx, uint32_t lossPm)
+{
+    coap_bw_window_t win;
+    coap_bw_block_t blk;
+    uint8_t cbor[3 * COAP_BW_MAX_PAYLOADS_LIMIT];
+    uint32_t rtt = 0;
+    size_t n;
+    int answered, resend;
+
+    fillBody(len);
+    HOST_CHECK(coap_bw_window_init(&win, COAP_OPTION_Q_BLOCK1, len, szx, 0) == 0);
+    HOST_CHECK(win.max_payloads == COAP_BW_MAX_PAYLOADS);
+    while (!coap_bw_window_done(&win))
+    {
+        answered = 0;
+        while (coap_bw_window_next(&win, &blk))
+        {
+            HOST_CHECK(blk.len == MIN(COAP_BW_SZX_TO_SIZE(szx), len - blk.offset));
+            HOST_CHECK(blk.more == (blk.offset + blk.len < len));
+            if (lost(lossPm))
+                continue;
+            serverStore(&blk);
+            answered = blk.last_of_set && !lost(lossPm);
+        }
+        rtt++;
+        if (!answered)
+        {
+            coap_bw_window_timeout(&win);
+            continue;
+        }
+        n = missingList(&win, cbor);
+        if (n == 0)
+        {
+            coap_bw_window_ack_set(&win);
+            continue;
+        }
+        resend = coap_bw_window_missing(&win, cbor, n);
+        HOST_CHECK(resend > 0 && (uint32_t)resend <= win.set_len);
+    }
+    HOST_CHECK(memcmp(rcvd, body, len) == 0);
+    return rtt;
+}
+
+static void testSender(void)
+{
+    coap_bw_window_t win;
+    coap_bw_block_t blk;
+    static const uint8_t bad[] = { 0x20 };
+    static const uint8_t cut[] = { 0x19, 0x01 };
+    static const uint8_t wide[] = { 0x1A, 0, 0, 0, 3, 0x18, 0x20 };
+    uint32_t plain, q, len = 50 * 1024 + 100;
+    int i;
+
+    HOST_CHECK(coap_bw_window_init(&win, 99, 100, 2, 0) < 0);
+    HOST_CHECK(coap_bw_window_init(&win, COAP_OPTION_BLOCK2, 100, 7, 0) < 0);
+    HOST_CHECK(coap_bw_window_init(&win, COAP_OPTION_Q_BLOCK2, 100, 0, 200) == 0 && win.max_payloads == 32);
+
+    /* An empty body is one block with M=0 */
+    HOST_CHECK(coap_bw_window_init(&win, COAP_OPTION_BLOCK2, 0, 6, 0) == 0);
+    HOST_CHECK(coap_bw_window_next(&win, &blk) && blk.num == 0 && blk.len == 0 && blk.more == 0);
+    coap_bw_window_ack(&win, 0);
+    HOST_CHECK(coap_bw_window_done(&win) && !coap_bw_window_next(&win, &blk));
+
+    /* Acks outside the set, and partial sets */
+    HOST_CHECK(coap_bw_window_init(&win, COAP_OPTION_Q_BLOCK1, 20 * 64, 2, 4) == 0);
+    for (i = 0; i < 4; i++)
+        HOST_CHECK(coap_bw_window_next(&win, &blk) && blk.num == (uint32_t)i && blk.last_of_set == (i == 3));
+    coap_bw_window_ack(&win, 9);
+    coap_bw_window_ack(&win, 0);
+    coap_bw_window_ack(&win, 2);
+    HOST_CHECK(win.set_base == 0);
+    coap_bw_window_timeout(&win);
+    HOST_CHECK(coap_bw_window_next(&win, &blk) && blk.num == 1);
+    HOST_CHECK(coap_bw_window_next(&win, &blk) && blk.num == 3 && blk.last_of_set);
+    coap_bw_window_ack(&win, 1);
+    coap_bw_window_ack(&win, 3);
+    HOST_CHECK(win.set_base == 4 && win.sent_mask == 0 && win.set_retries == 0);
+
+    /* Missing lists: malformed, truncated, 32 bit numbers, outside the set */
+    HOST_CHECK(coap_bw_window_missing(&win, bad, sizeof(bad)) < 0);
+    HOST_CHECK(coap_bw_window_missing(&win, cut, sizeof(cut)) < 0);
+    HOST_CHECK(coap_bw_window_missing(NULL, bad, 1) < 0 && coap_bw_window_missing(&win, NULL, 1) < 0);
+    for (i = 0; i < 4; i++)
+        HOST_CHECK(coap_bw_window_next(&win, &blk));
+    HOST_CHECK(coap_bw_window_missing(&win, wide, sizeof(wide)) == 0);
+    HOST_CHECK(win.set_base == 8);
+
+    /* Resizing only at a set boundary, on a multiple of the new size */
+    HOST_CHECK(coap_bw_window_next(&win, &blk));
+    HOST_CHECK(coap_bw_window_resize(&win, 1) < 0);
+    coap_bw_window_timeout(&win);
+    HOST_CHECK(coap_bw_window_resize(&win, 1) == 0 && win.set_base == 16 && win.set_offset == 8 * 64);
+    HOST_CHECK(coap_bw_window_resize(&win, 3) == 0 && win.set_base == 4);
+    HOST_CHECK(coap_bw_window_init(&win, COAP_OPTION_Q_BLOCK1, 1000, 0, 3) == 0);
+    coap_bw_window_ack_set(&win);
+    HOST_CHECK(coap_bw_window_resize(&win, 4) < 0 && coap_bw_window_resize(&win, 8) < 0);
+
+    /* The same body over a link without loss and with 10% loss */
+    lossSeed = 1;
+    plain = sendBlock1(len, 6, 0);
+    q = sendQBlock1(len, 6, 0);
+    HOST_CHECK(plain == 51 && q == 6);
+    plain = sendBlock1(len, 6, 100);
+    q = sendQBlock1(len, 6, 100);
+    HOST_CHECK(q * 4 < plain);
+    printf("sender: %u bytes in %u round trips with Block1, %u with Q-Block1 at 10%% loss\n",
+           (unsigned)len, (unsigned)plain, (unsigned)q);
+}
+
+static void testReceiver(void)
+{
+    coap_bw_rx_t rx;
+    uint32_t nums[COAP_BW_MAX_PAYLOADS_LIMIT], num, total = 47, rounds = 0, got = 0;
+    size_t n, i;
+    int r;
+
+    coap_bw_rx_init(&rx, 6, 0);
+    HOST_CHECK(rx.max_payloads == COAP_BW_MAX_PAYLOADS);
+    HOST_CHECK(coap_bw_rx_mark(&rx, 10, 1) < 0);
+    HOST_CHECK(coap_bw_rx_mark(&rx, 3, 1) == 1 && coap_bw_rx_mark(&rx, 3, 1) == 0);
+    HOST_CHECK(!coap_bw_rx_set_complete(&rx));
+    n = coap_bw_rx_missing(&rx, nums, 4);
+    HOST_CHECK(n == 4 && nums[0] == 0 && nums[3] == 4);
+
+    /* A download of 47 blocks over 20% loss, missing blocks asked again */
+    coap_bw_rx_init(&rx, 6, 0);
+    lossSeed = 7;
+    while (rx.set_base < total)
+    {
+        n = 0;
+        for (num = rx.set_base; num < MIN(rx.set_base + rx.max_payloads, total); num++)
+            nums[n++] = num;
+        while (n > 0)
+        {
+            rounds++;
+            for (i = 0; i < n; i++)
+            {
+                /* Past the end the server has nothing to send */
+                if (nums[i] >= total || lost(200))
+                    continue;
+                r = coap_bw_rx_mark(&rx, nums[i], nums[i] + 1 < total);
+                HOST_CHECK(r == 1);
+                got++;
+            }
+            /* Until the block with M=0 arrives the set is taken as full */
+            n = coap_bw_rx_set_complete(&rx) ? 0 : coap_bw_rx_missing(&rx, nums, COAP_BW_MAX_PAYLOADS_LIMIT);
+            HOST_CHECK(n <= rx.max_payloads);
+        }
+        HOST_CHECK(coap_bw_rx_mark(&rx, rx.set_base, 1) == 0);
+        coap_bw_rx_next_set(&rx);
+        HOST_CHECK(coap_bw_rx_mark(&rx, rx.set_base - 1, 1) == 0);
+    }
+    HOST_CHECK(got == total && rx.last_seen && rx.last_num == total - 1);
+    HOST_CHECK(rounds < total / 2);
+    HOST_CHECK(!coap_bw_rx_set_complete(NULL) && coap_bw_rx_missing(NULL, nums, 1) == 0);
+    printf("receiver: %u blocks at 20%% loss in %u requests\n", (unsigned)total, (unsigned)rounds);
+}
+
+static void bench(void)
+{
+    static const uint32_t loss[] = { 0, 20, 50, 100, 200, 300 };
+    coap_bw_link_t link;
+    uint32_t i, len = 64 * 1024;
+    uint8_t szx;
+
+    printf("%8s %6s %16s %16s\n", "loss", "block", "Block1 RTT", "Q-Block1 RTT");
+    for (i = 0; i < sizeof(loss) / sizeof(loss[0]); i++)
+    {
+        coap_bw_link_init(&link, 1280, false, true);
+        link.loss_pm = (uint16_t)loss[i];
+        szx = coap_bw_select_szx(&link, 20);
+        lossSeed = 3;
+        printf("%7.1f%% %6d %16u", loss[i] / 10.0, COAP_BW_SZX_TO_SIZE(szx), (unsigned)sendBlock1(len, szx, loss[i]));
+        printf(" %16u\n", (unsigned)sendQBlock1(len, szx, loss[i]));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testCodec();
+    testSelect();
+    testSender();
+    testReceiver();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
@@ -0,0 +1,382 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * cbor.c, senml_cbor.c and lwm2m_cbor.c on the host: the head and float
+ * encodings of RFC 8949 Appendix A, a round trip of a Connectivity
+ * Monitoring instance through both content formats with the payload
+ * sizes next to OMA TLV, and truncated / corrupted payloads that must be
+ * rejected without touching memory outside the buffer.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "host_stubs.h"
+#include "internals.h"
+#include "cbor.h"
+
+typedef struct
+{
+    int64_t     i;
+    const char *hex;
+} IntVector;
+
+typedef struct
+{
+    double      f;
+    const char *hex;
+} FloatVector;
+
+/* RFC 8949 Appendix A */
+static const IntVector intVectors[] =
+{
+    { 0, "00" }, { 1, "01" }, { 10, "0a" }, { 23, "17" }, { 24, "1818" }, { 25, "1819" },
+    { 100, "1864" }, { 1000, "1903e8" }, { 1000000, "1a000f4240" },
+    { 1000000000000LL, "1b000000e8d4a51000" }, { -1, "20" }, { -10, "29" }, { -100, "3863" },
+    { -1000, "3903e7" },
+};
+
+static const FloatVector floatVectors[] =
+{
+    { 0.0, "f90000" }, { -0.0, "f98000" }, { 1.0, "f93c00" }, { 1.1, "fb3ff199999999999a" },
+    { 1.5, "f93e00" }, { 65504.0, "f97bff" }, { 100000.0, "fa47c35000" },
+    { 3.4028234663852886e+38, "fa7f7fffff" }, { 1.0e+300, "fb7e37e43c8800759c" },
+    { -4.0, "f9c400" }, { -4.1, "fbc010666666666666" },
+};
+
+static void toHex(const uint8_t *b, size_t len, char *out)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        sprintf(out + 2 * i, "%02x", b[i]);
+    out[2 * len] = 0;
+}
+
+static void testPrimitives(void)
+{
+    uint8_t buf[16];
+    char hex[40];
+    cbor_writer_t w;
+    cbor_reader_t r;
+    cbor_item_t item;
+    unsigned i;
+
+    for (i = 0; i < sizeof(intVectors) / sizeof(intVectors[0]); i++)
+    {
+        int64_t back;
+
+        cbor_writer_init(&w, buf, sizeof(buf));
+        cbor_put_int(&w, intVectors[i].i);
+        toHex(buf, w.pos, hex);
+        HOST_CHECK(strcmp(hex, intVectors[i].hex) == 0);
+
+        cbor_reader_init(&r, buf, w.pos);
+        HOST_CHECK(cbor_get_item(&r, &item) == 0 && cbor_item_to_int(&item, &back) == 0);
+        HOST_CHECK(back == intVectors[i].i && r.pos == w.pos);
+    }
+
+    for (i = 0; i < sizeof(floatVectors) / sizeof(floatVectors[0]); i++)
+    {
+        lwm2m_data_t value;
+
+        cbor_writer_init(&w, buf, sizeof(buf));
+        cbor_put_float(&w, floatVectors[i].f);
+        toHex(buf, w.pos, hex);
+        HOST_CHECK(strcmp(hex, floatVectors[i].hex) == 0);
+
+        memset(&value, 0, sizeof(value));
+        cbor_reader_init(&r, buf, w.pos);
+        HOST_CHECK(cbor_get_item(&r, &item) == 0 && cbor_item_to_value(&item, &value) == 0);
+        HOST_CHECK(value.type == LWM2M_TYPE_FLOAT && value.value.asFloat == floatVectors[i].f);
+        HOST_CHECK(signbit(value.value.asFloat) == signbit(floatVectors[i].f));
+    }
+
+    cbor_writer_init(&w, buf, sizeof(buf));
+    cbor_put_bool(&w, false);
+    cbor_put_bool(&w, true);
+    toHex(buf, w.pos, hex);
+    HOST_CHECK(strcmp(hex, "f4f5") == 0);
+
+    /* a writer without buffer counts, a short one flags the overflow */
+    cbor_writer_init(&w, NULL, 0);
+    cbor_put_int(&w, 1000000000000LL);
+    HOST_CHECK(w.pos == 9 && !w.overflow);
+    cbor_writer_init(&w, buf, 4);
+    cbor_put_int(&w, 1000000000000LL);
+    HOST_CHECK(w.overflow);
+
+    printf("primitives: %u integers and %u floats equal to RFC 8949 Appendix A\n",
+           (unsigned)(sizeof(intVectors) / sizeof(intVectors[0])),
+           (unsigned)(sizeof(floatVectors) / sizeof(floatVectors[0])));
+}
+
+/* /4/0, Connectivity Monitoring as a device reports it */
+static lwm2m_data_t *makeConnMon(int *size)
+{
+    lwm2m_data_t *d = lwm2m_data_new(9);
+    lwm2m_data_t *bearers = lwm2m_data_new(2);
+    lwm2m_data_t *ips = lwm2m_data_new(1);
+    lwm2m_data_t *apns = lwm2m_data_new(1);
+
+    d[0].id = 0;  lwm2m_data_encode_int(7, &d[0]);
+    bearers[0].id = 0; lwm2m_data_encode_int(7, &bearers[0]);
+    bearers[1].id = 1; lwm2m_data_encode_int(6, &bearers[1]);
+    d[1].id = 1;  lwm2m_data_encode_instances(bearers, 2, &d[1]);
+    d[2].id = 2;  lwm2m_data_encode_int(-93, &d[2]);
+    d[3].id = 3;  lwm2m_data_encode_int(12, &d[3]);
+    ips[0].id = 0; lwm2m_data_encode_string("10.45.0.7", &ips[0]);
+    d[4].id = 4;  lwm2m_data_encode_instances(ips, 1, &d[4]);
+    apns[0].id = 0; lwm2m_data_encode_string("nbiot.gsim", &apns[0]);
+    d[5].id = 7;  lwm2m_data_encode_instances(apns, 1, &d[5]);
+    d[6].id = 8;  lwm2m_data_encode_int(0x0142A301, &d[6]);
+    d[7].id = 9;  lwm2m_data_encode_int(11, &d[7]);
+    d[8].id = 10; lwm2m_data_encode_int(724, &d[8]);
+    *size = 9;
+    return d;
+}
+
+static bool sameData(int size, const lwm2m_data_t *a, const lwm2m_data_t *b)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+    {
+        if (a[i].id != b[i].id || a[i].type != b[i].type)
+            return false;
+
+        switch (a[i].type)
+        {
+            case LWM2M_TYPE_MULTIPLE_RESOURCE:
+            case LWM2M_TYPE_OBJECT_INSTANCE:
+            case LWM2M_TYPE_OBJECT:
+                if (a[i].value.asChildren.count != b[i].value.asChildren.count ||
+                    !sameData((int)a[i].value.asChildren.count, a[i].value.asChildren.array, b[i].value.asChildren.array))
+                    return false;
+                break;
+            case LWM2M_TYPE_STRING:
+            case LWM2M_TYPE_OPAQUE:
+                if (a[i].value.asBuffer.length != b[i].value.asBuffer.length ||
+                    memcmp(a[i].value.asBuffer.buffer, b[i].value.asBuffer.buffer, a[i].value.asBuffer.length) != 0)
+                    return false;
+                break;
+            case LWM2M_TYPE_INTEGER:
+                if (a[i].value.asInteger != b[i].value.asInteger)
+                    return false;
+                break;
+            case LWM2M_TYPE_FLOAT:
+                if (a[i].value.asFloat != b[i].value.asFloat)
+                    return false;
+                break;
+            case LWM2M_TYPE_BOOLEAN:
+                if (a[i].value.asBoolean != b[i].value.asBoolean)
+                    return false;
+                break;
+            case LWM2M_TYPE_OBJECT_LINK:
+                if (a[i].value.asObjLink != b[i].value.asObjLink)
+                    return false;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+/* Bytes of the same data in OMA TLV (LwM2M 1.0 section 6.4.3) */
+static size_t tlvIntLen(int64_t v)
+{
+    if (v >= INT8_MIN && v <= INT8_MAX)
+        return 1;
+    if (v >= INT16_MIN && v <= INT16_MAX)
+        return 2;
+    if (v >= INT32_MIN && v <= INT32_MAX)
+        return 4;
+    return 8;
+}
+
+static size_t tlvHeader(uint16_t id, size_t len)
+{
+    return 1 + (id > 255 ? 2 : 1) + (len < 8 ? 0 : len < 256 ? 1 : len < 65536 ? 2 : 3);
+}
+
+static size_t tlvSize(int size, const lwm2m_data_t *d)
+{
+    size_t total = 0, len;
+    int i;
+
+    for (i = 0; i < size; i++)
+    {
+        switch (d[i].type)
+        {
+            case LWM2M_TYPE_MULTIPLE_RESOURCE:
+            case LWM2M_TYPE_OBJECT_INSTANCE:
+                len = tlvSize((int)d[i].value.asChildren.count, d[i].value.asChildren.array);
+                break;
+            case LWM2M_TYPE_STRING:
+            case LWM2M_TYPE_OPAQUE:
+                len = d[i].value.asBuffer.length;
+                break;
+            case LWM2M_TYPE_INTEGER:
+                len = tlvIntLen(d[i].value.asInteger);
+                break;
+            case LWM2M_TYPE_FLOAT:
+                len = ((double)(float)d[i].value.asFloat == d[i].value.asFloat) ? 4 : 8;
+                break;
+            case LWM2M_TYPE_BOOLEAN:
+                len = 1;
+                break;
+            default:
+                len = 4;
+                break;
+        }
+        total += tlvHeader(d[i].id, len) + len;
+    }
+    return total;
+}
+
+typedef size_t (*SerializeFn)(lwm2m_uri_t *, int, lwm2m_data_t *, uint8_t **);
+typedef size_t (*SerializeToFn)(lwm2m_uri_t *, int, lwm2m_data_t *, uint8_t *, size_t);
+typedef int (*ParseFn)(lwm2m_uri_t *, uint8_t *, size_t, lwm2m_data_t **);
+
+static size_t roundTrip(const char *name, SerializeFn ser, SerializeToFn serTo, ParseFn parse,
+                        lwm2m_uri_t *uri, int size, lwm2m_data_t *data, int corruptions)
+{
+    uint8_t *buf = NULL;
+    uint8_t *copy;
+    lwm2m_data_t *back = NULL;
+    size_t len, cut;
+    int count, i;
+    int rejected = 0;
+
+    len = ser(uri, size, data, &buf);
+    HOST_CHECK(len > 0 && buf != NULL);
+
+    count = parse(uri, buf, len, &back);
+    HOST_CHECK(count == size && sameData(size, data, back));
+    lwm2m_data_free(count, back);
+
+    /* straight into a buffer: the exact size fits, one byte less does not */
+    copy = (uint8_t *)malloc(len);
+    HOST_CHECK(serTo(uri, size, data, copy, len) == len && memcmp(copy, buf, len) == 0);
+    HOST_CHECK(serTo(uri, size, data, copy, len - 1) == 0);
+    free(copy);
+
+    /* every truncation is rejected; heap copies of the exact length let
+     * the address sanitizer catch any read past the end */
+    for (cut = 0; cut < len; cut++)
+    {
+        copy = (uint8_t *)malloc(cut ? cut : 1);
+        memcpy(copy, buf, cut);
+        back = NULL;
+        count = parse(uri, copy, cut, &back);
+        HOST_CHECK(count <= 0 || back != NULL);
+        if (count > 0)
+            lwm2m_data_free(count, back);
+        else
+            rejected++;
+        free(copy);
+    }
+    HOST_CHECK(rejected == (int)len);
+
+    /* random byte corruption: any result is fine, memory errors are not */
+    for (i = 0; i < corruptions; i++)
+    {
+        copy = (uint8_t *)malloc(len);
+        memcpy(copy, buf, len);
+        copy[rand() % len] ^= (uint8_t)(1 + rand() % 255);
+        if (rand() % 2)
+            copy[rand() % len] = (uint8_t)rand();
+        back = NULL;
+        count = parse(uri, copy, len, &back);
+        if (count > 0)
+            lwm2m_data_free(count, back);
+        free(copy);
+    }
+
+    printf("%-11s %3u bytes, round trip equal, %u truncations rejected, %d corruptions survived\n",
+           name, (unsigned)len, (unsigned)len, corruptions);
+    lwm2m_free(buf);
+    return len;
+}
+
+static void testFormats(void)
+{
+    lwm2m_uri_t uri;
+    lwm2m_data_t *data;
+    int size;
+
+    memset(&uri, 0, sizeof(uri));
+    uri.flag = LWM2M_URI_FLAG_OBJECT_ID | LWM2M_URI_FLAG_INSTANCE_ID;
+    uri.objectId = 4;
+    uri.instanceId = 0;
+
+    data = makeConnMon(&size);
+    srand(29);
+    roundTrip("SenML-CBOR", senml_cbor_serialize, senml_cbor_serialize_to, senml_cbor_parse, &uri, size, data, 20000);
+    roundTrip("LwM2M-CBOR", lwm2m_cbor_serialize, lwm2m_cbor_serialize_to, lwm2m_cbor_parse, &uri, size, data, 20000);
+    printf("%-11s %3u bytes, computed\n", "OMA TLV", (unsigned)tlvSize(size, data));
+    lwm2m_data_free(size, data);
+}
+
+static void bench(void)
+{
+    lwm2m_uri_t uri;
+    lwm2m_data_t *data;
+    lwm2m_data_t *back;
+    uint8_t buf[256];
+    size_t len = 0;
+    int size, i, n = 200000;
+    double t0;
+
+    memset(&uri, 0, sizeof(uri));
+    uri.flag = LWM2M_URI_FLAG_OBJECT_ID | LWM2M_URI_FLAG_INSTANCE_ID;
+    uri.objectId = 4;
+    data = makeConnMon(&size);
+
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+        len = senml_cbor_serialize_to(&uri, size, data, buf, sizeof(buf));
+    printf("SenML-CBOR encode %8.0f ns\n", (host_now() - t0) / n * 1e9);
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+    {
+        HOST_CHECK(senml_cbor_parse(&uri, buf, len, &back) == size);
+        lwm2m_data_free(size, back);
+    }
+    printf("SenML-CBOR decode %8.0f ns\n", (host_now() - t0) / n * 1e9);
+
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+        len = lwm2m_cbor_serialize_to(&uri, size, data, buf, sizeof(buf));
+    printf("LwM2M-CBOR encode %8.0f ns\n", (host_now() - t0) / n * 1e9);
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+    {
+        HOST_CHECK(lwm2m_cbor_parse(&uri, buf, len, &back) == size);
+        lwm2m_data_free(size, back);
+    }
+    printf("LwM2M-CBOR decode %8.0f ns\n", (host_now() - t0) / n * 1e9);
+    lwm2m_data_free(size, data);
+}
+
+int main(int argc, char **argv)
+{
+    testPrimitives();
+    testFormats();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
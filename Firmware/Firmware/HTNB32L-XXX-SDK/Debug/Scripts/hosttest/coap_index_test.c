@@ -0,0 +1,247 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * coap_index.c on the host: the (session, MID) / (session, token) table is
+ * checked against a plain list under random adds and deletes, the dedup
+ * cache is run through first copy, drop, replay, expiry and eviction, and
+ * the lookup cost is timed against the transactionList walk it replaces
+ * for 1 to 256 outstanding exchanges.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "coap_index.h"
+
+#define REF_MAX     2048
+
+typedef struct
+{
+    void *   session;
+    uint16_t mid;
+    uint8_t  token[COAP_TOKEN_LEN];
+    uint8_t  tokenLen;
+    void *   value;
+} RefEntry;
+
+static RefEntry refList[REF_MAX];
+static int refCount;
+
+static uint32_t clockMs(void)
+{
+    return host_ms;
+}
+
+static int refFindMid(void *session, uint16_t mid)
+{
+    int i;
+
+    for (i = 0; i < refCount; i++)
+    {
+        if (refList[i].session == session && refList[i].mid == mid)
+            return i;
+    }
+    return -1;
+}
+
+static void testTable(void)
+{
+    coap_idx_t idx;
+    int op, i;
+    uint32_t refused = 0;
+
+    HOST_CHECK(coap_idx_init(&idx, 256) == 0);
+    srand(28);
+
+    for (op = 0; op < 200000; op++)
+    {
+        void *session = (void *)(uintptr_t)(0x1000 + (rand() % 4) * 0x40);
+        uint16_t mid = (uint16_t)(rand() % 60);
+        int pos = refFindMid(session, mid);
+
+        if (rand() % 4 != 0)
+        {
+            if (pos < 0)
+            {
+                void *value = (void *)(uintptr_t)(op + 1);
+
+                if (coap_idx_add_mid(&idx, session, mid, value) == 0)
+                {
+                    refList[refCount].session = session;
+                    refList[refCount].mid = mid;
+                    refList[refCount].value = value;
+                    refCount++;
+                }
+                else
+                {
+                    /* only the load limit may refuse */
+                    HOST_CHECK(idx.count * COAP_IDX_LOAD_DEN >= (idx.mask + 1u) * COAP_IDX_LOAD_NUM);
+                    refused++;
+                }
+            }
+        }
+        else if (pos >= 0)
+        {
+            HOST_CHECK(coap_idx_del_mid(&idx, session, mid) == 0);
+            refList[pos] = refList[--refCount];
+        }
+        else
+        {
+            HOST_CHECK(coap_idx_del_mid(&idx, session, mid) == -1);
+        }
+
+        if ((op & 1023) == 0)
+        {
+            HOST_CHECK(idx.count == refCount);
+            for (i = 0; i < refCount; i++)
+                HOST_CHECK(coap_idx_find_mid(&idx, refList[i].session, refList[i].mid) == refList[i].value);
+        }
+    }
+    HOST_CHECK(refused == idx.overflows);
+
+    /* tokens of the same bytes differ by length and by session */
+    coap_idx_clear(&idx);
+    refCount = 0;
+    {
+        static const uint8_t tok[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+        for (i = 1; i <= 8; i++)
+            HOST_CHECK(coap_idx_add_token(&idx, (void *)0x10, tok, (uint8_t)i, (void *)(uintptr_t)i) == 0);
+        HOST_CHECK(coap_idx_add_token(&idx, (void *)0x20, tok, 8, (void *)0x99) == 0);
+        for (i = 1; i <= 8; i++)
+            HOST_CHECK(coap_idx_find_token(&idx, (void *)0x10, tok, (uint8_t)i) == (void *)(uintptr_t)i);
+        HOST_CHECK(coap_idx_find_token(&idx, (void *)0x20, tok, 8) == (void *)0x99);
+        HOST_CHECK(coap_idx_find_mid(&idx, (void *)0x10, 0) == NULL);
+        HOST_CHECK(coap_idx_del_token(&idx, (void *)0x10, tok, 4) == 0);
+        HOST_CHECK(coap_idx_find_token(&idx, (void *)0x10, tok, 4) == NULL);
+        HOST_CHECK(coap_idx_find_token(&idx, (void *)0x10, tok, 5) == (void *)5);
+    }
+    coap_idx_deinit(&idx);
+    printf("index: equal to a list over 200000 random operations, %u inserts refused at the load limit\n",
+           (unsigned)refused);
+}
+
+static void testDedup(void)
+{
+    coap_timer_wheel_t wheel;
+    coap_dedup_t dedup;
+    uint8_t buf[COAP_DEDUP_MAX_RESPONSE];
+    static const uint8_t ack[4] = { 0x60, 0x44, 0x12, 0x34 };
+    size_t len;
+    int i;
+
+    host_ms = 0;
+    coap_tw_init(&wheel, clockMs);
+    HOST_CHECK(coap_dedup_init(&dedup, 4, &wheel) == 0);
+
+    HOST_CHECK(coap_dedup_check(&dedup, (void *)1, 0x1234, COAP_DEDUP_EXCHANGE_LIFETIME_MS, buf, sizeof(buf), &len) == COAP_DEDUP_NEW);
+    HOST_CHECK(coap_dedup_check(&dedup, (void *)1, 0x1234, COAP_DEDUP_EXCHANGE_LIFETIME_MS, buf, sizeof(buf), &len) == COAP_DEDUP_IN_PROGRESS);
+    HOST_CHECK(coap_dedup_check(&dedup, (void *)2, 0x1234, COAP_DEDUP_EXCHANGE_LIFETIME_MS, buf, sizeof(buf), &len) == COAP_DEDUP_NEW);
+
+    HOST_CHECK(coap_dedup_store_response(&dedup, (void *)1, 0x1234, ack, sizeof(ack)) == 0);
+    HOST_CHECK(coap_dedup_check(&dedup, (void *)1, 0x1234, COAP_DEDUP_EXCHANGE_LIFETIME_MS, buf, sizeof(buf), &len) == COAP_DEDUP_REPLAY);
+    HOST_CHECK(len == sizeof(ack) && memcmp(buf, ack, sizeof(ack)) == 0);
+
+    /* EXCHANGE_LIFETIME later the MID is new again */
+    host_ms = COAP_DEDUP_EXCHANGE_LIFETIME_MS - 100;
+    coap_tw_advance(&wheel);
+    HOST_CHECK(coap_dedup_check(&dedup, (void *)1, 0x1234, COAP_DEDUP_EXCHANGE_LIFETIME_MS, buf, sizeof(buf), &len) == COAP_DEDUP_REPLAY);
+    host_ms = COAP_DEDUP_EXCHANGE_LIFETIME_MS + 2 * COAP_TW_TICK_MS;
+    coap_tw_advance(&wheel);
+    HOST_CHECK(coap_dedup_check(&dedup, (void *)1, 0x1234, COAP_DEDUP_NON_LIFETIME_MS, buf, sizeof(buf), &len) == COAP_DEDUP_NEW);
+
+    /* a full cache forgets the oldest exchange first */
+    for (i = 0; i < 5; i++)
+        HOST_CHECK(coap_dedup_check(&dedup, (void *)3, (uint16_t)i, COAP_DEDUP_NON_LIFETIME_MS, NULL, 0, NULL) == COAP_DEDUP_NEW);
+    HOST_CHECK(coap_dedup_check(&dedup, (void *)3, 0, COAP_DEDUP_NON_LIFETIME_MS, NULL, 0, NULL) == COAP_DEDUP_NEW);
+    HOST_CHECK(coap_dedup_check(&dedup, (void *)3, 4, COAP_DEDUP_NON_LIFETIME_MS, NULL, 0, NULL) == COAP_DEDUP_IN_PROGRESS);
+
+    HOST_CHECK(coap_dedup_lifetime_ms(0, COAP_TYPE_CON) == COAP_DEDUP_EXCHANGE_LIFETIME_MS);
+    HOST_CHECK(coap_dedup_lifetime_ms(60, COAP_TYPE_CON) == 60000);
+    HOST_CHECK(coap_dedup_lifetime_ms(60, COAP_TYPE_NON) == COAP_DEDUP_NON_LIFETIME_MS);
+
+    coap_dedup_deinit(&dedup);
+    coap_tw_deinit(&wheel);
+    printf("dedup: drop, replay, expiry and eviction as RFC 7252 section 4.5\n");
+}
+
+typedef struct ListTrans_Tag
+{
+    struct ListTrans_Tag *next;
+    void *                sessionH;
+    uint16_t              mid;
+} ListTrans;
+
+static void benchLookup(void)
+{
+    static const int sizes[] = { 1, 4, 16, 64, 256 };
+    static ListTrans trans[256];
+    unsigned s;
+
+    printf("%10s %14s %14s\n", "exchanges", "list walk ns", "index ns");
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        coap_idx_t idx;
+        ListTrans *head = NULL;
+        volatile uintptr_t sink = 0;
+        int n = sizes[s], i, r;
+        int rounds = 2000000 / n;
+        double t0, tList, tIdx;
+
+        HOST_CHECK(coap_idx_init(&idx, (uint16_t)(n * 2)) == 0);
+        for (i = 0; i < n; i++)
+        {
+            trans[i].sessionH = (void *)0x2000;
+            trans[i].mid = (uint16_t)(i * 7 + 1);
+            trans[i].next = head;
+            head = &trans[i];
+            HOST_CHECK(coap_idx_add_mid(&idx, trans[i].sessionH, trans[i].mid, &trans[i]) == 0);
+        }
+
+        t0 = host_now();
+        for (r = 0; r < rounds; r++)
+        {
+            for (i = 0; i < n; i++)
+            {
+                ListTrans *t = head;
+
+                while (t != NULL && !(t->sessionH == (void *)0x2000 && t->mid == trans[i].mid))
+                    t = t->next;
+                sink += (uintptr_t)t;
+            }
+        }
+        tList = (host_now() - t0) / ((double)rounds * n) * 1e9;
+
+        t0 = host_now();
+        for (r = 0; r < rounds; r++)
+        {
+            for (i = 0; i < n; i++)
+                sink += (uintptr_t)coap_idx_find_mid(&idx, (void *)0x2000, trans[i].mid);
+        }
+        tIdx = (host_now() - t0) / ((double)rounds * n) * 1e9;
+
+        printf("%10d %14.1f %14.1f\n", n, tList, tIdx);
+        coap_idx_deinit(&idx);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testTable();
+    testDedup();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        benchLookup();
+    return 0;
+}
@@ -0,0 +1,357 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * coap_timer.c on the host: 512 owners arm, re-arm and stop timers of
+ * milliseconds to hours, some from the callbacks of others, while the
+ * clock sleeps exactly until coap_tw_next_deadline_ms() as tickless idle
+ * would, or wakes early, or jumps hours at once; every timer must fire
+ * once, within a tick of its deadline, in deadline order, across the wrap
+ * of the millisecond clock, and the armed counts must follow. Then the
+ * clamp of long delays, the default wheel wait and the RFC 7252
+ * retransmission back-off. "bench" times the next deadline query and a
+ * start/stop pair against walking a list of the same timers.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "coap_timer.h"
+
+#define OWNERS              512
+#define T                   COAP_TW_TICK_MS
+
+typedef struct
+{
+    coap_tw_timer_t timer;
+    int             armed;
+    uint32_t        armedAt;
+    uint32_t        delay;
+    unsigned        fires;
+}Owner;
+
+static coap_timer_wheel_t wheel;
+static Owner owner[OWNERS];
+static int modelArmed;
+static unsigned long fired;
+static uint32_t lastExpires;
+static int inAdvance, jumping, reArms, crossStops;
+
+static uint32_t clockMs(void)
+{
+    return host_ms;
+}
+
+static uint32_t randomDelay(void)
+{
+    int r = rand() % 100;
+
+    if (r < 50)
+        return (uint32_t)rand() % 2000;
+    if (r < 80)
+        return (uint32_t)rand() % (5 * 60 * 1000);
+    if (r < 95)
+        return (uint32_t)rand() % (3 * 3600 * 1000);
+    return (uint32_t)rand() % (70u * 3600 * 1000);
+}
+
+static void arm(Owner *o, uint32_t delay)
+{
+    if (!o->armed)
+        modelArmed++;
+    o->armed = 1;
+    o->armedAt = host_ms;
+    o->delay = delay;
+    coap_tw_start(&wheel, &o->timer, delay);
+}
+
+static void disarm(Owner *o)
+{
+    if (o->armed)
+        modelArmed--;
+    o->armed = 0;
+    coap_tw_stop(&wheel, &o->timer);
+}
+
+static void expired(coap_tw_timer_t *timer, void *arg)
+{
+    Owner *o = arg;
+    uint32_t ticks = o->delay ? (o->delay + T - 1) / T * T : T;
+
+    HOST_CHECK(&o->timer == timer && o->armed && inAdvance);
+    HOST_CHECK(!coap_tw_is_armed(timer));
+    /* Within a tick of the deadline, the wheel counting from its last tick */
+    HOST_CHECK((int32_t)(host_ms - (o->armedAt + ticks - (T - 1))) >= 0);
+    HOST_CHECK(jumping || (int32_t)(host_ms - (o->armedAt + ticks + (T - 1))) <= 0);
+    HOST_CHECK((int32_t)(timer->expires - lastExpires) >= 0);
+    lastExpires = timer->expires;
+
+    o->armed = 0;
+    o->fires++;
+    modelArmed--;
+    fired++;
+
+    switch (rand() % 8)
+    {
+        case 0:
+            arm(o, randomDelay());
+            reArms++;
+            break;
+        case 1:
+            disarm(&owner[rand() % OWNERS]);
+            crossStops++;
+            break;
+    }
+}
+
+static void advance(void)
+{
+    lastExpires = wheel.now;
+    inAdvance = 1;
+    coap_tw_advance(&wheel);
+    inAdvance = 0;
+}
+
+static void checkCounts(void)
+{
+    uint32_t kinds = 0;
+    int i, armed = 0;
+
+    for (i = 0; i < OWNERS; i++)
+    {
+        HOST_CHECK(coap_tw_is_armed(&owner[i].timer) == (owner[i].armed != 0));
+        armed += owner[i].armed;
+    }
+    for (i = 0; i < COAP_TW_KIND_MAX; i++)
+        kinds += wheel.armed_kind[i];
+    HOST_CHECK(armed == modelArmed && wheel.armed == (uint32_t)armed && kinds == wheel.armed);
+}
+
+static void testRandom(void)
+{
+    uint32_t ms;
+    long step;
+    int i, jumps = 0;
+
+    srand(5);
+    host_ms = 0xFFFFFFFFu - 3600u * 1000;       //the clock wraps after an hour
+    coap_tw_init(&wheel, clockMs);
+    HOST_CHECK(coap_tw_next_deadline_ms(&wheel) == COAP_TW_NO_DEADLINE);
+    for (i = 0; i < OWNERS; i++)
+        coap_tw_timer_init(&owner[i].timer, (coap_tw_kind_t)(i % (COAP_TW_KIND_MAX + 1)), expired, &owner[i]);
+    HOST_CHECK(owner[COAP_TW_KIND_MAX].timer.kind == COAP_TW_KIND_LWM2M);
+
+    for (step = 0; step < 300000; step++)
+    {
+        int r = rand() % 10;
+        Owner *o = &owner[rand() % OWNERS];
+
+        if (r < 4)
+        {
+            arm(o, randomDelay());
+        }
+        else if (r < 6)
+        {
+            disarm(o);
+        }
+        else
+        {
+            ms = coap_tw_next_deadline_ms(&wheel);
+            if (ms == COAP_TW_NO_DEADLINE)
+                continue;
+            /* Woken early by a packet, or sleeping until the deadline */
+            if (r == 6 && ms > 1)
+                ms = (uint32_t)rand() % ms;
+            host_ms += ms;
+            advance();
+        }
+        if (step % 1000 == 0)
+            checkCounts();
+    }
+
+    /* Hours without a call: everything due fires at once, in order */
+    jumping = 1;
+    for (i = 0; i < 20; i++)
+    {
+        uint32_t before = (uint32_t)fired;
+
+        host_ms += 5 * 3600u * 1000;
+        advance();
+        jumps += (fired > before);
+        checkCounts();
+    }
+    jumping = 0;
+
+    while ((ms = coap_tw_next_deadline_ms(&wheel)) != COAP_TW_NO_DEADLINE)
+    {
+        host_ms += ms;
+        advance();
+    }
+    checkCounts();
+    HOST_CHECK(wheel.armed == 0 && wheel.fired == fired);
+    for (i = 0; i < 64; i++)
+        HOST_CHECK(wheel.slots[0][i] == NULL && wheel.slots[COAP_TW_LEVELS - 1][i] == NULL);
+    HOST_CHECK(wheel.occupied[0] == 0 && wheel.occupied[1] == 0 && wheel.occupied[2] == 0 && wheel.occupied[3] == 0);
+    HOST_CHECK(reArms > 0 && crossStops > 0 && jumps > 0);
+    printf("random: %lu expiries within a tick across the clock wrap, %d re-armed and %d stopped from callbacks\n",
+           fired, reArms, crossStops);
+}
+
+static void noop(coap_tw_timer_t *timer, void *arg)
+{
+    (void)timer;
+    *(int *)arg += 1;
+}
+
+static void testEdges(void)
+{
+    coap_tw_timer_t t;
+    int count = 0, i;
+    uint32_t d;
+
+    host_ms = 1000;
+    coap_tw_init(&wheel, clockMs);
+    coap_tw_timer_init(&t, COAP_TW_KIND_RETRANSMIT, noop, &count);
+
+    /* Zero is one tick, a start of an armed timer moves it */
+    coap_tw_start(&wheel, &t, 0);
+    HOST_CHECK(coap_tw_next_deadline_ms(&wheel) == T);
+    coap_tw_start(&wheel, &t, 10 * T);
+    HOST_CHECK(wheel.armed == 1 && wheel.armed_kind[COAP_TW_KIND_RETRANSMIT] == 1);
+    host_ms += 9 * T;
+    HOST_CHECK(coap_tw_advance(&wheel) == 0 && coap_tw_next_deadline_ms(&wheel) == T);
+
+    /* Overdue is 0; stopping twice is harmless */
+    host_ms += 5 * T;
+    HOST_CHECK(coap_tw_next_deadline_ms(&wheel) == 0);
+    coap_tw_stop(&wheel, &t);
+    coap_tw_stop(&wheel, &t);
+    HOST_CHECK(wheel.armed == 0 && coap_tw_advance(&wheel) == 0 && count == 0);
+
+    /* Longer than the wheel: clamped, and reported as a cascade before */
+    coap_tw_start(&wheel, &t, 0xFFFFFFFFu);
+    d = coap_tw_next_deadline_ms(&wheel);
+    HOST_CHECK(d != COAP_TW_NO_DEADLINE && d <= COAP_TW_MAX_DELAY_TICKS * T);
+    HOST_CHECK(t.expires - wheel.now == COAP_TW_MAX_DELAY_TICKS);
+    host_ms += COAP_TW_MAX_DELAY_TICKS * T;
+    HOST_CHECK(coap_tw_advance(&wheel) == 1 && count == 1);
+
+    /* No callback, no timer */
+    coap_tw_timer_init(&t, COAP_TW_KIND_LWM2M, NULL, NULL);
+    coap_tw_start(&wheel, &t, 100);
+    HOST_CHECK(!coap_tw_is_armed(&t) && wheel.armed == 0);
+    coap_tw_start(NULL, &t, 100);
+    coap_tw_stop(&wheel, NULL);
+    HOST_CHECK(coap_tw_advance(NULL) == 0 && coap_tw_next_deadline_ms(NULL) == COAP_TW_NO_DEADLINE);
+    coap_tw_deinit(&wheel);
+
+    /* The default wheel on the kernel tick, the wait of the task loop */
+    host_ms = 5000;
+    HOST_CHECK(coap_tw_wait_ticks() == QURT_TIME_WAIT_FOREVER);
+    coap_tw_timer_init(&t, COAP_TW_KIND_LWM2M, noop, &count);
+    coap_tw_start(coap_tw_default(), &t, 30 * T);
+    HOST_CHECK(coap_tw_wait_ticks() == 30 * T);
+    host_ms += 30 * T;
+    HOST_CHECK(coap_tw_wait_ticks() == 0 && coap_tw_advance(coap_tw_default()) == 1 && count == 2);
+    HOST_CHECK(coap_tw_wait_ticks() == QURT_TIME_WAIT_FOREVER);
+
+    /* [ACK_TIMEOUT, ACK_TIMEOUT * ACK_RANDOM_FACTOR] doubled per retransmission */
+    for (i = 0; i < 10000; i++)
+    {
+        uint8_t n = (uint8_t)(i % 6);
+
+        d = coap_tw_retransmit_delay_ms(2, 1.5, n);
+        HOST_CHECK(d >= (2000u << n) && d <= (3000u << n));
+    }
+    HOST_CHECK(coap_tw_retransmit_delay_ms(2, 1.0, 3) == 16000);
+    HOST_CHECK(coap_tw_retransmit_delay_ms(1, 0.5, 40) == (1000u << 16));
+    printf("edges: one tick minimum, re-arm, overdue, clamp, default wheel wait, back-off\n");
+}
+
+typedef struct ListTimer_Tag
+{
+    struct ListTimer_Tag *next;
+    uint32_t              due;
+}ListTimer;
+
+static void bench(void)
+{
+    static const int sizes[] = { 16, 256, 4096 };
+    static coap_tw_timer_t timers[4096];
+    static ListTimer list[4096];
+    volatile uint32_t sink = 0;
+    unsigned s;
+
+    printf("%8s %16s %16s %16s\n", "timers", "list min ns", "deadline ns", "start+stop ns");
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        ListTimer *head = NULL, *l;
+        int n = sizes[s], i, r, rounds = 4000000 / n;
+        double t0, tList, tWheel, tArm;
+        int count = 0;
+
+        host_ms = 0;
+        coap_tw_init(&wheel, clockMs);
+        srand(9);
+        for (i = 0; i < n; i++)
+        {
+            uint32_t d = randomDelay();
+
+            coap_tw_timer_init(&timers[i], COAP_TW_KIND_RETRANSMIT, noop, &count);
+            coap_tw_start(&wheel, &timers[i], d);
+            list[i].due = d;
+            list[i].next = head;
+            head = &list[i];
+        }
+
+        t0 = host_now();
+        for (r = 0; r < rounds; r++)
+        {
+            uint32_t best = 0xFFFFFFFFu;
+
+            for (l = head; l != NULL; l = l->next)
+                best = (l->due < best) ? l->due : best;
+            sink += best;
+        }
+        tList = (host_now() - t0) * 1e9 / rounds;
+
+        t0 = host_now();
+        for (r = 0; r < rounds * 8; r++)
+            sink += coap_tw_next_deadline_ms(&wheel);
+        tWheel = (host_now() - t0) * 1e9 / (rounds * 8);
+
+        t0 = host_now();
+        for (r = 0; r < rounds * 8; r++)
+        {
+            coap_tw_timer_t *t = &timers[r % n];
+
+            coap_tw_stop(&wheel, t);
+            coap_tw_start(&wheel, t, 2000);
+        }
+        tArm = (host_now() - t0) * 1e9 / (rounds * 8);
+
+        printf("%8d %16.1f %16.1f %16.1f\n", n, tList, tWheel, tArm);
+        coap_tw_deinit(&wheel);
+    }
+    (void)sink;
+}
+
+int main(int argc, char **argv)
+{
+    testRandom();
+    testEdges();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
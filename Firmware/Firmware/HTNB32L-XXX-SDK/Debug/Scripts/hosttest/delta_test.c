@@ -0,0 +1,214 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_delta.c on emulated NOR flash. Two images are made the way a rebuild
+ * changes firmware: 2 KB of code inserted in the middle, the literal
+ * pointers past it moved, a few constants changed. fota_delta.py makes
+ * the patch, which is then applied in chunks of 1 byte, of the whole
+ * patch and of random sizes; every rebuilt image must equal the new one.
+ * Patches with a corrupted byte, a truncated patch and a modified base
+ * image must all be refused. "bench" times the rebuild.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "host_flash.h"
+#include "mw_flashsvc.h"
+#include "mw_delta.h"
+
+#define OLD_SIZE        (256 * 1024)
+#define INS_SIZE        2048
+
+static UINT8 oldImg[OLD_SIZE], newImg[OLD_SIZE + INS_SIZE];
+static UINT8 *patch;
+static long patchLen;
+
+static void save(const char *name, const UINT8 *p, long n)
+{
+    FILE *f = fopen(name, "wb");
+
+    HOST_CHECK(f != NULL && fwrite(p, 1, n, f) == (size_t)n);
+    fclose(f);
+}
+
+static UINT8 *load(const char *name, long *n)
+{
+    FILE *f = fopen(name, "rb");
+    UINT8 *p;
+
+    HOST_CHECK(f != NULL);
+    fseek(f, 0, SEEK_END);
+    *n = ftell(f);
+    rewind(f);
+    p = malloc(*n + 1);
+    HOST_CHECK(p != NULL && fread(p, 1, *n, f) == (size_t)*n);
+    fclose(f);
+    return p;
+}
+
+static void put32(UINT8 *p, UINT32 v)
+{
+    p[0] = (UINT8)v;
+    p[1] = (UINT8)(v >> 8);
+    p[2] = (UINT8)(v >> 16);
+    p[3] = (UINT8)(v >> 24);
+}
+
+static UINT32 get32(const UINT8 *p)
+{
+    return (UINT32)p[0] | ((UINT32)p[1] << 8) | ((UINT32)p[2] << 16) | ((UINT32)p[3] << 24);
+}
+
+/* Thumb-like code from a small set of halfwords, with literal pools of pointers into the image */
+static void makeImages(void)
+{
+    static const UINT16 ops[] = { 0xb510, 0xbd10, 0x4618, 0x6803, 0x2000, 0x4770, 0xf000, 0xf8d0, 0x3301, 0xe7fe };
+    UINT32 i, ins = OLD_SIZE / 2, next;
+    long n;
+
+    srand(1);
+    for (i = 0; i < OLD_SIZE; i += 2)
+    {
+        UINT16 op = ops[rand() % 10] ^ (UINT16)(rand() % 8);
+
+        oldImg[i] = (UINT8)op;
+        oldImg[i + 1] = (UINT8)(op >> 8);
+    }
+    for (i = 0; i < OLD_SIZE; i += 64)
+    {
+        if (rand() % 10 < 3)
+            put32(&oldImg[i], APP_FLASH_LOAD_ADDR + (UINT32)(rand() % OLD_SIZE));
+    }
+
+    memcpy(newImg, oldImg, ins);
+    for (i = 0; i < INS_SIZE; i++)
+        newImg[ins + i] = (UINT8)rand();
+    memcpy(newImg + ins + INS_SIZE, oldImg + ins, OLD_SIZE - ins);
+    for (i = 0; i + 4 <= sizeof(newImg); i += 4)
+    {
+        next = get32(&newImg[i]);
+        if (next >= APP_FLASH_LOAD_ADDR + ins && next < APP_FLASH_LOAD_ADDR + OLD_SIZE)
+            put32(&newImg[i], next + INS_SIZE);
+    }
+    for (i = 0; i < 20; i++)
+        newImg[rand() % sizeof(newImg)] ^= 0x5A;
+
+    save(OUT_DIR "delta_old.bin", oldImg, sizeof(oldImg));
+    save(OUT_DIR "delta_new.bin", newImg, sizeof(newImg));
+    HOST_CHECK(system(FOTA_DELTA " make " OUT_DIR "delta_old.bin " OUT_DIR "delta_new.bin "
+                      OUT_DIR "delta_patch.bin > /dev/null") == 0);
+    patch = load(OUT_DIR "delta_patch.bin", &n);
+    patchLen = n;
+}
+
+/* Feed the patch in chunks of 1 to maxChunk bytes */
+static INT32 feed(long len, long maxChunk)
+{
+    long i = 0;
+    INT32 rc;
+
+    HOST_CHECK(mwDeltaBegin() == MW_DELTA_OK);
+    while (i < len)
+    {
+        long c = 1 + rand() % maxChunk;
+
+        if (c > len - i)
+            c = len - i;
+        rc = mwDeltaWrite(patch + i, (UINT32)c);
+        if (rc != MW_DELTA_OK)
+            return rc;
+        i += c;
+    }
+    return mwDeltaFinish(PNULL);
+}
+
+static void resetFlash(void)
+{
+    host_flash_blank();
+    memset(host_flash, 0xA5, sizeof(host_flash));
+    memcpy(host_flash + MW_DELTA_SRC_OFFSET, oldImg, sizeof(oldImg));
+    /* Not erased: the rebuild has to erase every sector it writes */
+    memset(host_flash + MW_DELTA_DST_OFFSET, 0x00, MW_DELTA_DST_SIZE);
+}
+
+static void testDelta(void)
+{
+    static const long chunks[] = { 1, 0, 3000, 257 };
+    MwDeltaProgress pr;
+    UINT32 size, fails[8] = { 0 };
+    long i;
+    int k;
+
+    makeImages();
+    for (k = 0; k < 4; k++)
+    {
+        resetFlash();
+        HOST_CHECK(feed(patchLen, chunks[k] != 0 ? chunks[k] : patchLen) == MW_DELTA_OK);
+        mwDeltaGetProgress(&pr);
+        HOST_CHECK(pr.state == MW_DELTA_DONE && pr.imageSize == sizeof(newImg));
+        HOST_CHECK(memcmp(host_flash + MW_DELTA_DST_OFFSET, newImg, sizeof(newImg)) == 0);
+    }
+    HOST_CHECK(mwDeltaWrite(patch, 1) == MW_DELTA_ERR_STATE);
+
+    /* A wrong image must never be accepted */
+    for (i = 0; i < patchLen; i += 37)
+    {
+        UINT8 save = patch[i];
+        INT32 rc;
+
+        patch[i] ^= (UINT8)(1 + rand() % 255);
+        rc = feed(patchLen, 1 + rand() % 2000);
+        patch[i] = save;
+        HOST_CHECK(rc < 0 && rc >= -7);
+        fails[-rc]++;
+    }
+    HOST_CHECK(feed(patchLen - 1, 500) == MW_DELTA_ERR_FORMAT);
+    host_flash[MW_DELTA_SRC_OFFSET + OLD_SIZE / 2] ^= 1;
+    HOST_CHECK(feed(patchLen, 500) == MW_DELTA_ERR_BASE);
+    host_flash[MW_DELTA_SRC_OFFSET + OLD_SIZE / 2] ^= 1;
+    HOST_CHECK(feed(patchLen, 500) == MW_DELTA_OK);
+
+    HOST_CHECK(mwDeltaBegin() == MW_DELTA_OK);
+    HOST_CHECK(mwDeltaWrite(patch, (UINT32)patchLen) == MW_DELTA_OK);
+    HOST_CHECK(mwDeltaFinish(&size) == MW_DELTA_OK && size == sizeof(newImg));
+
+    printf("delta: patch %ld B for a %u B image (copy %u, add %u, insert %u); "
+           "corruptions refused: format %u, base %u, size %u, verify %u\n",
+           patchLen, size, pr.copyBytes, pr.addBytes, pr.insertBytes,
+           fails[3], fails[4], fails[5], fails[7]);
+}
+
+static void bench(void)
+{
+    double t0, dt;
+    int k;
+
+    resetFlash();
+    t0 = host_now();
+    for (k = 0; k < 20; k++)
+        HOST_CHECK(feed(patchLen, 1500) == MW_DELTA_OK);
+    dt = (host_now() - t0) / 20;
+    printf("rebuild of %u B from %ld B of patch in 1.5 KB chunks: %.1f ms, %lu sector erases, %lu page programs\n",
+           (UINT32)sizeof(newImg), patchLen, dt * 1e3, host_flash_erases / 20, host_flash_programs / 20);
+}
+
+int main(int argc, char **argv)
+{
+    testDelta();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
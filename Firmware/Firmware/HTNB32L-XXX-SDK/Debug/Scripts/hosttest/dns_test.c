@@ -0,0 +1,649 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_dns.c over host threads, with a table of names behind
+ * netconn_gethostbyname() and the cache file in memory: start failures,
+ * then concurrent first lookups creating one task; misses answered by the
+ * callback, hits without the resolver; an expired entry served at once
+ * while the resolver refreshes it, and no longer past MW_DNS_MAX_STALE;
+ * the wall clock set back; invalidation; prefetch hosts surviving LRU
+ * eviction; failure callbacks and a full waiter table; the cache reloaded
+ * across a simulated reboot, and a corrupt, truncated or empty file.
+ * "bench" times a cache hit against a lookup through the resolver.
+ *
+ * The source is included to reach the cache state. Wall clock seconds are
+ * host_ms / 1000, see host_stubs.c.
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include "host_stubs.h"
+#include "host_os.h"
+#include "mw_dns.c"
+
+#define SEC                 1000u       //host_ms per wall clock second
+
+/* The resolver */
+typedef struct
+{
+    const char  *name;
+    const char  *addr;                  //PNULL: the name does not resolve
+}HostName;
+
+static HostName names[32];
+static pthread_mutex_t resLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t resCond = PTHREAD_COND_INITIALIZER;
+static int resGateClosed, resBusy;
+static volatile int resCalls;
+static UINT32 resDelayUs;
+
+/* The callbacks */
+static pthread_mutex_t cbLock = PTHREAD_MUTEX_INITIALIZER;
+static int cbCount, cbFailed;
+static UINT32 cbAddr;
+static char cbHost[MW_DNS_NAME_LEN];
+
+/* The cache file */
+typedef struct
+{
+    UINT32  pos;
+}HostFp;
+
+static UINT8 fileData[4096];
+static UINT32 fileLen;
+static int fileExists, fileFailWrite;
+
+UINT8 OsaCalcCrcValue(const UINT8 *dataBuf, UINT16 bufSize)
+{
+    UINT32 i;
+    UINT32 a = 1, b = 0;
+
+    /* OsaCheck() on target */
+    HOST_CHECK(dataBuf != PNULL && bufSize > 0);
+
+    for (i = bufSize; i > 0; )
+    {
+        a += (UINT32)(dataBuf[--i]);
+        b += a;
+    }
+
+    return (UINT8)(((a>>24)&0xFF)^((a>>16)&0xFF)^((a>>8)&0xFF)^((a)&0xFF)^
+                   ((b>>24)&0xFF)^((b>>16)&0xFF)^((b>>8)&0xFF)^((b)&0xFF)^
+                   (bufSize&0xFF));
+}
+
+OSAFILE OsaFopen(const char *fileName, const char *mode)
+{
+    HOST_CHECK(strcmp(fileName, MW_DNS_FILE_NAME) == 0);
+    if (mode[0] == 'r' && !fileExists)
+        return PNULL;
+    if (mode[0] == 'w')
+    {
+        if (fileFailWrite)
+            return PNULL;
+        fileLen = 0;
+        fileExists = 1;
+    }
+    return calloc(1, sizeof(HostFp));
+}
+
+INT32 OsaFclose(OSAFILE fp)
+{
+    free(fp);
+    return 0;
+}
+
+UINT32 OsaFread(void *buf, UINT32 size, UINT32 count, OSAFILE fp)
+{
+    HostFp *f = fp;
+    UINT32 n = (fileLen - f->pos) / size;
+
+    if (n > count)
+        n = count;
+    memcpy(buf, fileData + f->pos, n * size);
+    f->pos += n * size;
+    return n;
+}
+
+UINT32 OsaFwrite(void *buf, UINT32 size, UINT32 count, OSAFILE fp)
+{
+    HostFp *f = fp;
+
+    HOST_CHECK(f->pos + size * count <= sizeof(fileData));
+    memcpy(fileData + f->pos, buf, size * count);
+    f->pos += size * count;
+    fileLen = f->pos;
+    return count;
+}
+
+static void setName(const char *name, const char *addr)
+{
+    int i;
+
+    pthread_mutex_lock(&resLock);
+    for (i = 0; names[i].name != PNULL && strcmp(names[i].name, name) != 0; i++)
+        ;
+    HOST_CHECK(i < (int)(sizeof(names) / sizeof(names[0])) - 1);
+    names[i].name = name;
+    names[i].addr = addr;
+    pthread_mutex_unlock(&resLock);
+}
+
+err_t netconn_gethostbyname(const char *name, ip_addr_t *addr)
+{
+    err_t err = ERR_VAL;
+    int i;
+
+    pthread_mutex_lock(&resLock);
+    resCalls++;
+    resBusy = 1;
+    pthread_cond_broadcast(&resCond);
+    while (resGateClosed)
+        pthread_cond_wait(&resCond, &resLock);
+    for (i = 0; names[i].name != PNULL; i++)
+    {
+        if (strcmp(names[i].name, name) == 0 && names[i].addr != PNULL)
+        {
+            HOST_CHECK(inet_pton(AF_INET, names[i].addr, &addr->addr) == 1);
+            err = ERR_OK;
+        }
+    }
+    pthread_mutex_unlock(&resLock);
+
+    if (resDelayUs != 0)
+        usleep(resDelayUs);
+
+    pthread_mutex_lock(&resLock);
+    resBusy = 0;
+    pthread_mutex_unlock(&resLock);
+    return err;
+}
+
+static void closeGate(void)
+{
+    pthread_mutex_lock(&resLock);
+    resGateClosed = 1;
+    pthread_mutex_unlock(&resLock);
+}
+
+static void openGate(void)
+{
+    pthread_mutex_lock(&resLock);
+    resGateClosed = 0;
+    pthread_cond_broadcast(&resCond);
+    pthread_mutex_unlock(&resLock);
+}
+
+/* Wait for the resolver to be called */
+static void waitResolving(void)
+{
+    pthread_mutex_lock(&resLock);
+    while (!resBusy)
+        pthread_cond_wait(&resCond, &resLock);
+    pthread_mutex_unlock(&resLock);
+}
+
+static void resolved(const char *host, const ip_addr_t *addr, void *arg)
+{
+    pthread_mutex_lock(&cbLock);
+    cbCount++;
+    if (addr == PNULL)
+        cbFailed++;
+    else
+        cbAddr = addr->addr;
+    strcpy(cbHost, host);
+    *(int *)arg += 1;
+    pthread_mutex_unlock(&cbLock);
+}
+
+static int callbacks(void)
+{
+    int n;
+
+    pthread_mutex_lock(&cbLock);
+    n = cbCount;
+    pthread_mutex_unlock(&cbLock);
+    return n;
+}
+
+/* Wait up to 5 s for n callbacks in all */
+static void waitCallbacks(int n)
+{
+    int i;
+
+    for (i = 0; i < 5000 && callbacks() < n; i++)
+        osDelay(1);
+    HOST_CHECK(callbacks() == n);
+}
+
+/* Wait for the resolver task to have nothing queued and to be back asleep */
+static void waitIdle(void)
+{
+    int i, j, busy = 1;
+
+    for (i = 0; i < 5000 && busy; i++)
+    {
+        busy = 0;
+        osMutexAcquire(mwDns.lock, osWaitForever);
+        for (j = 0; j < MW_DNS_CACHE_SIZE; j++)
+            busy |= mwDns.entry[j].refresh;
+        osMutexRelease(mwDns.lock);
+        if (busy)
+            osDelay(1);
+    }
+    HOST_CHECK(!busy);
+    osDelay(50);
+}
+
+static UINT32 ip(const char *s)
+{
+    ip_addr_t a;
+
+    HOST_CHECK(inet_pton(AF_INET, s, &a.addr) == 1);
+    return a.addr;
+}
+
+/* Answered from the cache, maybe queueing a refresh */
+static UINT32 served(const char *host)
+{
+    ip_addr_t addr;
+
+    HOST_CHECK(mwDnsGetHostByName(host, &addr) == ERR_OK);
+    return addr.addr;
+}
+
+/* A fresh entry: answered without the resolver */
+static UINT32 hit(const char *host)
+{
+    ip_addr_t addr;
+    int calls = resCalls;
+    int arg = 0;
+
+    HOST_CHECK(mwDnsResolve(host, &addr, resolved, &arg) == MW_DNS_OK);
+    HOST_CHECK(mwDnsGetHostByName(host, &addr) == ERR_OK);
+    HOST_CHECK(resCalls == calls);
+    return addr.addr;
+}
+
+/* A miss, answered by the callback */
+static UINT32 miss(const char *host)
+{
+    ip_addr_t addr;
+    int n = callbacks();
+    int arg = 0;
+
+    HOST_CHECK(mwDnsResolve(host, &addr, resolved, &arg) == MW_DNS_PENDING);
+    waitCallbacks(n + 1);
+    HOST_CHECK(arg == 1 && strcmp(cbHost, host) == 0);
+    waitIdle();
+    return cbAddr;
+}
+
+/*
+ * Power off and on: the task stays blocked on the semaphore of the old
+ * boot, which nobody releases again, and the next call starts afresh.
+ */
+static void reboot(void)
+{
+    waitIdle();
+    osMutexDelete(mwDns.lock);
+    osMutexDelete(mwDns.fileLock);
+    memset(&mwDns, 0, sizeof(mwDns));
+}
+
+static void *firstLookup(void *arg)
+{
+    ip_addr_t addr;
+
+    *(INT32 *)arg = mwDnsGetHostByName("start.example", &addr);
+    return NULL;
+}
+
+static void testStart(void)
+{
+    unsigned long creates;
+    MwDnsStats stats;
+    ip_addr_t addr;
+    pthread_t t[4];
+    INT32 rc[4];
+    int fail, i, arg = 0;
+
+    HOST_CHECK(mwDnsResolve("192.0.2.7", &addr, resolved, &arg) == MW_DNS_OK && addr.addr == ip("192.0.2.7"));
+    HOST_CHECK(mwDnsResolve(PNULL, &addr, resolved, &arg) == MW_DNS_ERR_PARAM);
+    HOST_CHECK(mwDnsResolve("a.example", &addr, PNULL, &arg) == MW_DNS_ERR_PARAM);
+    HOST_CHECK(mwDnsAddPrefetchHost("") == MW_DNS_ERR_PARAM);
+    HOST_CHECK(host_os_creates == 0);
+
+    /* Calls that need no task are harmless before the start */
+    mwDnsInvalidate(PNULL);
+    HOST_CHECK(mwDnsSave() == MW_DNS_OK);
+    mwDnsGetStats(&stats);
+    HOST_CHECK(stats.hits == 0 && stats.saves == 0);
+
+    /* The two mutexes, the semaphore, then the task */
+    for (fail = 0; fail < 4; fail++)
+    {
+        host_os_fail = fail;
+        HOST_CHECK(mwDnsResolve("a.example", &addr, resolved, &arg) == MW_DNS_ERR_SYS);
+        HOST_CHECK(host_os_fail == -1 && mwDns.state == MW_DNS_STOPPED);
+    }
+
+    setName("start.example", "198.51.100.1");
+    creates = host_os_creates;
+    host_os_create_us = 20000;
+    for (i = 0; i < 4; i++)
+        HOST_CHECK(pthread_create(&t[i], NULL, firstLookup, &rc[i]) == 0);
+    for (i = 0; i < 4; i++)
+    {
+        pthread_join(t[i], NULL);
+        HOST_CHECK(rc[i] == ERR_OK);
+    }
+    host_os_create_us = 0;
+    HOST_CHECK(host_os_creates - creates == 4);
+    HOST_CHECK(hit("start.example") == ip("198.51.100.1"));
+    printf("dns: start failures leave nothing behind, 4 concurrent first lookups start one task\n");
+}
+
+static void testHitStale(void)
+{
+    MwDnsStats before, after;
+    ip_addr_t addr;
+    int calls, arg = 0;
+
+    setName("broker.example", "203.0.113.10");
+    mwDnsGetStats(&before);
+    HOST_CHECK(miss("broker.example") == ip("203.0.113.10"));
+    HOST_CHECK(hit("broker.example") == ip("203.0.113.10"));
+    mwDnsGetStats(&after);
+    HOST_CHECK(after.misses - before.misses == 1 && after.hits - before.hits == 2);
+    HOST_CHECK(after.lookups - before.lookups == 1 && after.saves - before.saves == 1);
+
+    /* Close to expiry: answered as a hit, the refresh already queued */
+    host_ms += (MW_DNS_DEFAULT_TTL - MW_DNS_REFRESH_AHEAD) * SEC;
+    mwDnsGetStats(&before);
+    calls = resCalls;
+    HOST_CHECK(served("start.example") == ip("198.51.100.1"));
+    waitIdle();
+    mwDnsGetStats(&after);
+    HOST_CHECK(after.hits - before.hits == 1 && resCalls == calls + 1);
+
+    /* Expired, the address moved: the old one now, the new one once refreshed */
+    host_ms += MW_DNS_DEFAULT_TTL * SEC;
+    setName("broker.example", "203.0.113.20");
+    closeGate();
+    mwDnsGetStats(&before);
+    calls = resCalls;
+    HOST_CHECK(mwDnsResolve("broker.example", &addr, resolved, &arg) == MW_DNS_OK);
+    HOST_CHECK(addr.addr == ip("203.0.113.10"));
+    waitResolving();
+    HOST_CHECK(resCalls == calls + 1);
+    HOST_CHECK(mwDnsGetHostByName("broker.example", &addr) == ERR_OK && addr.addr == ip("203.0.113.10"));
+    openGate();
+    waitIdle();
+    mwDnsGetStats(&after);
+    HOST_CHECK(after.staleHits - before.staleHits == 2 && after.lookups - before.lookups == 1);
+    HOST_CHECK(hit("broker.example") == ip("203.0.113.20"));
+    HOST_CHECK(arg == 0);
+
+    /* A failed refresh keeps the stale answer in service */
+    host_ms += MW_DNS_DEFAULT_TTL * SEC;
+    setName("broker.example", PNULL);
+    mwDnsGetStats(&before);
+    HOST_CHECK(served("broker.example") == ip("203.0.113.20"));
+    waitIdle();
+    HOST_CHECK(served("broker.example") == ip("203.0.113.20"));
+    waitIdle();
+    mwDnsGetStats(&after);
+    HOST_CHECK(after.failures - before.failures == 2 && after.staleHits - before.staleHits == 2);
+
+    /* Past the limit it waits for the resolver, whose failure reaches the callback */
+    host_ms += MW_DNS_MAX_STALE * SEC;
+    calls = callbacks();
+    mwDnsGetStats(&before);
+    HOST_CHECK(mwDnsResolve("broker.example", &addr, resolved, &arg) == MW_DNS_PENDING);
+    waitCallbacks(calls + 1);
+    waitIdle();
+    HOST_CHECK(cbFailed == 1 && arg == 1);
+    HOST_CHECK(mwDnsGetHostByName("broker.example", &addr) == ERR_VAL);
+    mwDnsGetStats(&after);
+    HOST_CHECK(after.misses - before.misses == 2 && after.failures - before.failures == 2);
+
+    /* The entry is still there: the next answer replaces it */
+    setName("broker.example", "203.0.113.30");
+    HOST_CHECK(mwDnsGetHostByName("broker.example", &addr) == ERR_OK && addr.addr == ip("203.0.113.30"));
+    HOST_CHECK(hit("broker.example") == ip("203.0.113.30"));
+
+    /* The clock set back a minute: the entry is treated as expired */
+    host_ms -= 60 * SEC;
+    setName("broker.example", "203.0.113.40");
+    mwDnsGetStats(&before);
+    HOST_CHECK(served("broker.example") == ip("203.0.113.30"));
+    waitIdle();
+    mwDnsGetStats(&after);
+    HOST_CHECK(after.staleHits - before.staleHits == 1 && after.lookups - before.lookups == 1);
+    HOST_CHECK(hit("broker.example") == ip("203.0.113.40"));
+    printf("dns: hits, stale answers refreshed in the background, failures, max stale and the clock set back\n");
+}
+
+static void testInvalidate(void)
+{
+    MwDnsStats before, after;
+
+    setName("a.example", "192.0.2.1");
+    setName("b.example", "192.0.2.2");
+    HOST_CHECK(miss("a.example") == ip("192.0.2.1"));
+    HOST_CHECK(miss("b.example") == ip("192.0.2.2"));
+
+    mwDnsGetStats(&before);
+    mwDnsInvalidate("a.example");
+    mwDnsInvalidate("nothing.example");
+    HOST_CHECK(hit("b.example") == ip("192.0.2.2"));
+    setName("a.example", "192.0.2.11");
+    HOST_CHECK(miss("a.example") == ip("192.0.2.11"));
+
+    mwDnsInvalidate(PNULL);
+    mwDnsGetStats(&after);
+    HOST_CHECK(after.invalidated - before.invalidated == 1 + 4);
+    HOST_CHECK(miss("b.example") == ip("192.0.2.2"));
+    printf("dns: invalidation of one name and of every name\n");
+}
+
+static void testPrefetch(void)
+{
+    static char name[MW_DNS_CACHE_SIZE * 2][MW_DNS_NAME_LEN];
+    MwDnsStats before, after;
+    ip_addr_t addr;
+    int i, calls;
+
+    mwDnsInvalidate(PNULL);
+    setName("pin.example", "198.51.100.50");
+    HOST_CHECK(mwDnsAddPrefetchHost("pin.example") == MW_DNS_OK);
+    waitIdle();
+    HOST_CHECK(hit("pin.example") == ip("198.51.100.50"));
+
+    /* Twice as many names as slots: the pin stays, the least recently used go */
+    for (i = 0; i < MW_DNS_CACHE_SIZE * 2; i++)
+    {
+        snprintf(name[i], MW_DNS_NAME_LEN, "n%d.example", i);
+        setName(name[i], "192.0.2.100");
+        HOST_CHECK(mwDnsGetHostByName(name[i], &addr) == ERR_OK);
+        HOST_CHECK(mwDnsGetHostByName(name[0], &addr) == ERR_OK);
+    }
+    HOST_CHECK(hit("pin.example") == ip("198.51.100.50"));
+    HOST_CHECK(hit(name[0]) == ip("192.0.2.100"));
+    HOST_CHECK(hit(name[MW_DNS_CACHE_SIZE * 2 - 1]) == ip("192.0.2.100"));
+    calls = resCalls;
+    HOST_CHECK(mwDnsGetHostByName(name[1], &addr) == ERR_OK && resCalls == calls + 1);
+
+    /* Refreshed when found expired, and kept even when it no longer resolves */
+    host_ms += MW_DNS_DEFAULT_TTL * SEC;
+    setName("pin.example", "198.51.100.51");
+    HOST_CHECK(mwDnsAddPrefetchHost("pin.example") == MW_DNS_OK);
+    waitIdle();
+    HOST_CHECK(hit("pin.example") == ip("198.51.100.51"));
+    mwDnsInvalidate("pin.example");
+    setName("pin.example", PNULL);
+    mwDnsGetStats(&before);
+    HOST_CHECK(mwDnsGetHostByName("pin.example", &addr) == ERR_VAL);
+    for (i = 0; i < MW_DNS_CACHE_SIZE * 2; i++)
+        HOST_CHECK(mwDnsGetHostByName(name[i], &addr) == ERR_OK);
+    waitIdle();
+    HOST_CHECK(mwDnsFind("pin.example") != PNULL);
+    setName("pin.example", "198.51.100.52");
+    HOST_CHECK(mwDnsAddPrefetchHost("pin.example") == MW_DNS_OK);
+    waitIdle();
+    HOST_CHECK(hit("pin.example") == ip("198.51.100.52"));
+    mwDnsGetStats(&after);
+    HOST_CHECK(after.failures - before.failures == 1);
+    printf("dns: a prefetch host survives %d other names and is refreshed in the background\n", MW_DNS_CACHE_SIZE * 2);
+}
+
+static void testFull(void)
+{
+    static char longName[MW_DNS_NAME_LEN + 1];
+    ip_addr_t addr;
+    int i, n, arg = 0;
+
+    memset(longName, 'x', MW_DNS_NAME_LEN);
+    longName[MW_DNS_NAME_LEN] = 0;
+    HOST_CHECK(mwDnsResolve(longName, &addr, resolved, &arg) == MW_DNS_ERR_PARAM);
+    HOST_CHECK(mwDnsAddPrefetchHost(longName) == MW_DNS_ERR_PARAM);
+    setName(longName, "192.0.2.99");
+    HOST_CHECK(mwDnsGetHostByName(longName, &addr) == ERR_OK && addr.addr == ip("192.0.2.99"));
+
+    /* One lookup in the resolver at a time, the other waiters on the same name */
+    mwDnsInvalidate(PNULL);
+    setName("slow.example", "192.0.2.50");
+    closeGate();
+    n = callbacks();
+    for (i = 0; i < MW_DNS_MAX_WAITERS; i++)
+        HOST_CHECK(mwDnsResolve("slow.example", &addr, resolved, &arg) == MW_DNS_PENDING);
+    HOST_CHECK(mwDnsResolve("slow.example", &addr, resolved, &arg) == MW_DNS_ERR_FULL);
+    HOST_CHECK(mwDnsResolve("other.example", &addr, resolved, &arg) == MW_DNS_ERR_FULL);
+    waitResolving();
+    openGate();
+    waitCallbacks(n + MW_DNS_MAX_WAITERS);
+    waitIdle();
+    HOST_CHECK(arg == MW_DNS_MAX_WAITERS && cbAddr == ip("192.0.2.50"));
+    printf("dns: long names bypass the cache, %d waiters on one name, the next refused\n", MW_DNS_MAX_WAITERS);
+}
+
+static void testReboot(void)
+{
+    MwDnsStats stats;
+    UINT32 len;
+    int calls, i;
+
+    mwDnsInvalidate(PNULL);
+    setName("keep.example", "203.0.113.77");
+    setName("pin.example", "198.51.100.60");
+    HOST_CHECK(miss("keep.example") == ip("203.0.113.77"));
+    HOST_CHECK(mwDnsAddPrefetchHost("pin.example") == MW_DNS_OK);
+    waitIdle();
+    host_ms += 10 * SEC;
+    HOST_CHECK(hit("keep.example") == ip("203.0.113.77"));
+    HOST_CHECK(mwDnsSave() == MW_DNS_OK);
+    mwDnsGetStats(&stats);
+    HOST_CHECK(stats.saves > 0);
+
+    /* Both names answer after the reboot, the pin is left to the new boot */
+    reboot();
+    calls = resCalls;
+    HOST_CHECK(hit("keep.example") == ip("203.0.113.77"));
+    HOST_CHECK(hit("pin.example") == ip("198.51.100.60"));
+    for (i = 0; i < MW_DNS_CACHE_SIZE; i++)
+        HOST_CHECK(!(mwDns.entry[i].flags & MW_DNS_FLAG_PINNED) && !mwDns.entry[i].refresh);
+    HOST_CHECK(resCalls == calls);
+    mwDnsGetStats(&stats);
+    HOST_CHECK(stats.saves == 0 && stats.misses == 0);
+
+    /* Nothing changed since the load: no write */
+    HOST_CHECK(mwDnsSave() == MW_DNS_OK);
+    mwDnsGetStats(&stats);
+    HOST_CHECK(stats.saves == 0);
+
+    /* A failed write is retried by the next save */
+    mwDnsInvalidate("pin.example");
+    fileFailWrite = 1;
+    HOST_CHECK(mwDnsSave() == MW_DNS_ERR_SYS);
+    fileFailWrite = 0;
+    HOST_CHECK(mwDnsSave() == MW_DNS_OK);
+    mwDnsGetStats(&stats);
+    HOST_CHECK(stats.saves == 1);
+
+    /* A flipped bit, a short file and a foreign header all load as empty */
+    len = fileLen;
+    fileData[len - 3] ^= 0x10;
+    reboot();
+    HOST_CHECK(miss("keep.example") == ip("203.0.113.77"));
+    HOST_CHECK(mwDnsSave() == MW_DNS_OK);
+    len = fileLen;
+
+    fileLen = len - 1;
+    reboot();
+    HOST_CHECK(miss("keep.example") == ip("203.0.113.77"));
+    HOST_CHECK(mwDnsSave() == MW_DNS_OK);
+
+    fileData[0] ^= 0xFF;
+    reboot();
+    HOST_CHECK(miss("keep.example") == ip("203.0.113.77"));
+    HOST_CHECK(mwDnsSave() == MW_DNS_OK);
+
+    /* An empty cache is saved and loaded too */
+    mwDnsInvalidate(PNULL);
+    HOST_CHECK(mwDnsSave() == MW_DNS_OK);
+    HOST_CHECK(fileLen == sizeof(MwDnsFileHdr));
+    reboot();
+    HOST_CHECK(miss("keep.example") == ip("203.0.113.77"));
+    printf("dns: the cache reloaded across a reboot, a corrupt, short or empty file loads as empty\n");
+}
+
+static void bench(void)
+{
+    ip_addr_t addr;
+    double start, hitNs;
+    int i, n = 200000;
+
+    setName("bench.example", "192.0.2.200");
+    HOST_CHECK(mwDnsGetHostByName("bench.example", &addr) == ERR_OK);
+    start = host_now();
+    for (i = 0; i < n; i++)
+        mwDnsGetHostByName("bench.example", &addr);
+    hitNs = (host_now() - start) * 1e9 / n;
+
+    /* What NetworkConnect() waited for on every wake-up before the cache */
+    resDelayUs = 200000;
+    mwDnsInvalidate("bench.example");
+    start = host_now();
+    HOST_CHECK(mwDnsGetHostByName("bench.example", &addr) == ERR_OK);
+    printf("  cache hit %.0f ns, miss %.0f ms with a 200 ms resolver\n", hitNs, (host_now() - start) * 1000);
+    resDelayUs = 0;
+}
+
+int main(int argc, char **argv)
+{
+    host_ms = 1000 * SEC;
+    testStart();
+    testHitStale();
+    testInvalidate();
+    testPrefetch();
+    testFull();
+    testReboot();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
@@ -0,0 +1,484 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * dtls_cid.c on the host, built with the mbed TLS config of the firmware
+ * (config_ec_dtls_libcoap.h) so that its draft-05 check is compiled too.
+ * The library is prebuilt for the target, so the calls dtls_cid.c makes
+ * are played here by a connection stand-in that follows their documented
+ * behaviour: context_save() sizes with a NULL buffer and resets the
+ * context, context_load() refuses another library version, and
+ * get_peer_cid() reports a CID only when the server chose a non-empty one.
+ *
+ * Checked are the store names, the file layout, that a session without
+ * CID is not kept, that the saved keys are wiped from the heap, that a
+ * damaged or foreign file falls back to a handshake, and over a few
+ * hundred hibernate cycles with lost connections that no record sequence
+ * number is ever sent twice under the same keys.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "host_fs.h"
+#include "dtls_cid.h"
+
+#define HOST_SAVE_MAGIC     "MBED0223"
+#define HOST_CYCLES         400
+
+/* One connection as the stand-in library sees it, the mbed TLS context
+ * first so that the context pointers dtls_cid.c gets lead back here */
+typedef struct
+{
+    mbedtls_ssl_context ssl;
+    int                 established;
+    int                 cidEnabled;     /* mbedtls_ssl_set_cid() */
+    uint8_t             peerCid[MBEDTLS_SSL_CID_OUT_LEN_MAX];
+    uint8_t             peerCidLen;
+    uint8_t             keys[32];
+    uint16_t            epoch;
+    uint64_t            ctr;            /* next record sequence number */
+    int                 resets;
+} HostConn;
+
+typedef struct
+{
+    char        magic[8];
+    uint8_t     keys[32];
+    uint16_t    epoch;
+    uint64_t    ctr;
+    uint8_t     peerCidLen;
+    uint8_t     peerCid[MBEDTLS_SSL_CID_OUT_LEN_MAX];
+} __attribute__((packed)) HostSaved;
+
+#define CONN(ssl)   ((HostConn *)(ssl))
+
+static size_t confCidLen = 99;
+static int confCidPolicy = -1;
+static int setCidFail;
+static size_t saveExtra;            /* grows the saved state */
+static const void *saveBuf;         /* the buffers dtls_cid.c must wipe */
+static const void *loadBuf;
+static size_t saveLen;
+static int wipedSave;
+static int wipedLoad;
+
+int mbedtls_ssl_conf_cid(mbedtls_ssl_config *conf, size_t len, int ignore_other_cids)
+{
+    confCidLen = len;
+    confCidPolicy = ignore_other_cids;
+    return 0;
+}
+
+int mbedtls_ssl_set_cid(mbedtls_ssl_context *ssl, int enable, unsigned char const *own_cid, size_t own_cid_len)
+{
+    if (setCidFail || own_cid_len != DTLS_CID_OWN_LEN)
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    CONN(ssl)->cidEnabled = (enable == MBEDTLS_SSL_CID_ENABLED);
+    return 0;
+}
+
+int mbedtls_ssl_get_peer_cid(mbedtls_ssl_context *ssl, int *enabled,
+                             unsigned char peer_cid[MBEDTLS_SSL_CID_OUT_LEN_MAX], size_t *peer_cid_len)
+{
+    HostConn *c = CONN(ssl);
+
+    if (!c->established)
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    /* an empty CID on both sides counts as disabled */
+    *enabled = (c->cidEnabled && c->peerCidLen != 0) ? MBEDTLS_SSL_CID_ENABLED : MBEDTLS_SSL_CID_DISABLED;
+    if (peer_cid != NULL)
+    {
+        memcpy(peer_cid, c->peerCid, c->peerCidLen);
+        *peer_cid_len = c->peerCidLen;
+    }
+    return 0;
+}
+
+int mbedtls_ssl_session_reset(mbedtls_ssl_context *ssl)
+{
+    HostConn *c = CONN(ssl);
+    int cidEnabled = c->cidEnabled;
+    int resets = c->resets;
+
+    memset(c, 0, sizeof(HostConn));
+    c->cidEnabled = cidEnabled;
+    c->resets = resets + 1;
+    return 0;
+}
+
+int mbedtls_ssl_context_save(mbedtls_ssl_context *ssl, unsigned char *buf, size_t buf_len, size_t *olen)
+{
+    HostConn *c = CONN(ssl);
+    HostSaved s;
+
+    if (!c->established)
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    *olen = sizeof(HostSaved) + saveExtra;
+    if (buf == NULL || buf_len < *olen)
+        return MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL;
+
+    memcpy(s.magic, HOST_SAVE_MAGIC, sizeof(s.magic));
+    memcpy(s.keys, c->keys, sizeof(s.keys));
+    s.epoch = c->epoch;
+    s.ctr = c->ctr;
+    s.peerCidLen = c->peerCidLen;
+    memcpy(s.peerCid, c->peerCid, sizeof(s.peerCid));
+    memcpy(buf, &s, sizeof(s));
+    memset(buf + sizeof(s), 0xA5, saveExtra);
+    saveBuf = buf;
+    saveLen = *olen;
+
+    return mbedtls_ssl_session_reset(ssl);
+}
+
+int mbedtls_ssl_context_load(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len)
+{
+    HostConn *c = CONN(ssl);
+    HostSaved s;
+
+    loadBuf = buf;
+    if (c->established)
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    if (len < sizeof(s.magic) || memcmp(buf, HOST_SAVE_MAGIC, sizeof(s.magic)) != 0)
+        return MBEDTLS_ERR_SSL_VERSION_MISMATCH;
+    if (len != sizeof(s))
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+
+    memcpy(&s, buf, sizeof(s));
+    memcpy(c->keys, s.keys, sizeof(c->keys));
+    c->epoch = s.epoch;
+    c->ctr = s.ctr;
+    c->peerCidLen = s.peerCidLen;
+    memcpy(c->peerCid, s.peerCid, sizeof(c->peerCid));
+    c->established = 1;
+    return 0;
+}
+
+/* As in platform_util.c, through a volatile pointer the compiler cannot
+ * drop the stores */
+static void *(*const volatile zeroize)(void *, int, size_t) = memset;
+
+void mbedtls_platform_zeroize(void *buf, size_t len)
+{
+    if (len > 0)
+        zeroize(buf, 0, len);
+}
+
+/* dtls_cid.c frees the serialized connection, it must be zero by then */
+void __real_free(void *p);
+
+void __wrap_free(void *p)
+{
+    if (p != NULL && (p == saveBuf || p == loadBuf))
+    {
+        const uint8_t *b = p;
+        size_t i;
+
+        for (i = 0; i < saveLen && b[i] == 0; i++)
+            ;
+        if (p == saveBuf)
+        {
+            wipedSave = (i == saveLen);
+            saveBuf = NULL;
+        }
+        else
+        {
+            wipedLoad = (i == saveLen);
+            loadBuf = NULL;
+        }
+    }
+    __real_free(p);
+}
+
+static void connInit(HostConn *c, mbedtls_ssl_config *conf)
+{
+    memset(c, 0, sizeof(HostConn));
+    c->ssl.conf = conf;
+}
+
+/* A full handshake; the server takes a CID of serverCidLen bytes when the
+ * client offered the extension */
+static void handshake(HostConn *c, uint8_t serverCidLen)
+{
+    int i;
+
+    for (i = 0; i < (int)sizeof(c->keys); i++)
+        c->keys[i] = (uint8_t)rand();
+    c->peerCidLen = c->cidEnabled ? serverCidLen : 0;
+    for (i = 0; i < c->peerCidLen; i++)
+        c->peerCid[i] = (uint8_t)rand();
+    c->epoch = 1;
+    c->ctr = 1;
+    c->established = 1;
+}
+
+static void testPath(void)
+{
+    char path[DTLS_CID_STORE_PATH_LEN];
+    char small[16];
+
+    HOST_CHECK(dtls_cid_store_path(path, sizeof(path), "192.0.2.1", 5684) == DTLS_OK);
+    HOST_CHECK(strcmp(path, "dtls_192.0.2.1_5684.ses") == 0);
+    HOST_CHECK(dtls_cid_store_path(path, sizeof(path), "[2001:db8::1]", 5684) == DTLS_OK);
+    HOST_CHECK(strcmp(path, "dtls__2001_db8__1__5684.ses") == 0);
+    HOST_CHECK(dtls_cid_store_path(path, sizeof(path), "lwm2m.example/x", 0) == DTLS_OK);
+    HOST_CHECK(strcmp(path, "dtls_lwm2m.example_x_0.ses") == 0);
+    HOST_CHECK(dtls_cid_store_path(small, sizeof(small), "192.0.2.1", 5684) == DTLS_BAD_INPUT);
+    HOST_CHECK(dtls_cid_store_path(NULL, sizeof(path), "192.0.2.1", 5684) == DTLS_INVALID_PARAM);
+    HOST_CHECK(dtls_cid_store_path(path, sizeof(path), NULL, 5684) == DTLS_INVALID_PARAM);
+
+    printf("path: server names kept to file name characters, truncation refused\n");
+}
+
+static void testCid(void)
+{
+    mbedtls_ssl_config conf;
+    HostConn c;
+
+    memset(&conf, 0, sizeof(conf));
+    HOST_CHECK(dtls_cid_conf(NULL) == DTLS_INVALID_PARAM);
+    HOST_CHECK(dtls_cid_conf(&conf) == DTLS_OK);
+    HOST_CHECK(confCidLen == DTLS_CID_OWN_LEN && confCidPolicy == MBEDTLS_SSL_UNEXPECTED_CID_IGNORE);
+
+    connInit(&c, &conf);
+    HOST_CHECK(dtls_cid_enable(NULL) == DTLS_INVALID_PARAM);
+    HOST_CHECK(dtls_cid_in_use(&c.ssl) == false);
+    setCidFail = 1;
+    HOST_CHECK(dtls_cid_enable(&c.ssl) == DTLS_FAILURE && !c.cidEnabled);
+    setCidFail = 0;
+    HOST_CHECK(dtls_cid_enable(&c.ssl) == DTLS_OK && c.cidEnabled);
+
+    /* in use only once the server chose a CID */
+    handshake(&c, 0);
+    HOST_CHECK(dtls_cid_in_use(&c.ssl) == false);
+    handshake(&c, 4);
+    HOST_CHECK(dtls_cid_in_use(&c.ssl) == true);
+    HOST_CHECK(dtls_cid_in_use(NULL) == false);
+
+    printf("cid: empty own CID, stray CIDs ignored, in use with a server CID\n");
+}
+
+static void testSuspend(void)
+{
+    const char *path = "dtls_192.0.2.1_5684.ses";
+    mbedtls_ssl_config conf;
+    dtls_cid_store_hdr_t hdr;
+    HostConn c;
+    HostConn was;
+    const uint8_t *data;
+    size_t len;
+    int resets;
+
+    memset(&conf, 0, sizeof(conf));
+    host_fs_clear();
+    connInit(&c, &conf);
+    HOST_CHECK(dtls_cid_suspend(NULL, path) == DTLS_INVALID_PARAM);
+    HOST_CHECK(dtls_cid_suspend(&c.ssl, NULL) == DTLS_INVALID_PARAM);
+
+    /* no handshake yet, or no CID: nothing is kept, the connection stays */
+    HOST_CHECK(dtls_cid_suspend(&c.ssl, path) == DTLS_INVALID_STATE);
+    handshake(&c, 4);
+    HOST_CHECK(dtls_cid_suspend(&c.ssl, path) == DTLS_INVALID_STATE);
+    HOST_CHECK(c.established && host_fs_count() == 0);
+
+    dtls_cid_enable(&c.ssl);
+    handshake(&c, 4);
+    c.ctr = 77;
+    was = c;
+    resets = c.resets;
+    wipedSave = 0;
+    HOST_CHECK(dtls_cid_suspend(&c.ssl, path) == DTLS_OK);
+    HOST_CHECK(!c.established && c.resets == resets + 1);
+    HOST_CHECK(wipedSave);
+
+    data = host_fs_data(path, &len);
+    HOST_CHECK(data != NULL && len == sizeof(hdr) + sizeof(HostSaved));
+    memcpy(&hdr, data, sizeof(hdr));
+    HOST_CHECK(hdr.magic == DTLS_CID_STORE_MAGIC && hdr.version == DTLS_CID_STORE_VERSION);
+    HOST_CHECK(hdr.len == sizeof(HostSaved));
+
+    /* after wake-up, a new context on the same config */
+    connInit(&c, &conf);
+    wipedLoad = 0;
+    HOST_CHECK(dtls_cid_resume(&c.ssl, path) == DTLS_OK);
+    HOST_CHECK(c.established && c.ctr == 77 && c.epoch == was.epoch);
+    HOST_CHECK(memcmp(c.keys, was.keys, sizeof(c.keys)) == 0);
+    HOST_CHECK(c.peerCidLen == 4 && memcmp(c.peerCid, was.peerCid, 4) == 0);
+    HOST_CHECK(wipedLoad);
+
+    /* the file is gone, a second resume gets nothing */
+    HOST_CHECK(host_fs_data(path, &len) == NULL);
+    connInit(&c, &conf);
+    HOST_CHECK(dtls_cid_resume(&c.ssl, path) == DTLS_FAILURE && !c.established);
+    HOST_CHECK(dtls_cid_resume(NULL, path) == DTLS_INVALID_PARAM);
+
+    /* a full file system leaves no partial file behind */
+    dtls_cid_enable(&c.ssl);
+    handshake(&c, 4);
+    host_fs_space = sizeof(hdr) + 10;
+    HOST_CHECK(dtls_cid_suspend(&c.ssl, path) == DTLS_FAILURE);
+    HOST_CHECK(host_fs_count() == 0);
+    host_fs_space = -1;
+
+    /* state larger than the store takes is not saved */
+    handshake(&c, 4);
+    saveExtra = DTLS_CID_STORE_MAX_LEN;
+    HOST_CHECK(dtls_cid_suspend(&c.ssl, path) == DTLS_INVALID_STATE);
+    HOST_CHECK(c.established && host_fs_count() == 0);
+    saveExtra = 0;
+
+    HOST_CHECK(dtls_cid_suspend(&c.ssl, path) == DTLS_OK);
+    dtls_cid_forget(path);
+    HOST_CHECK(host_fs_count() == 0);
+    dtls_cid_forget(NULL);
+
+    printf("suspend: %u byte store, keys wiped, one-shot resume\n", (unsigned)len);
+}
+
+/* Every damaged file is refused, removed, and leaves a clean context for
+ * the handshake */
+static void testDamaged(void)
+{
+    const char *path = "dtls_192.0.2.1_5684.ses";
+    mbedtls_ssl_config conf;
+    dtls_cid_store_hdr_t hdr;
+    uint8_t good[sizeof(hdr) + sizeof(HostSaved)];
+    uint8_t bad[sizeof(good)];
+    HostConn c;
+    const uint8_t *data;
+    size_t len;
+    int n = 0;
+    int k;
+
+    memset(&conf, 0, sizeof(conf));
+    host_fs_clear();
+    connInit(&c, &conf);
+    dtls_cid_enable(&c.ssl);
+    handshake(&c, 8);
+    HOST_CHECK(dtls_cid_suspend(&c.ssl, path) == DTLS_OK);
+    data = host_fs_data(path, &len);
+    HOST_CHECK(len == sizeof(good));
+    memcpy(good, data, len);
+
+    for (k = 0; k < 7; k++)
+    {
+        memcpy(bad, good, sizeof(bad));
+        memcpy(&hdr, bad, sizeof(hdr));
+        len = sizeof(bad);
+        switch (k)
+        {
+        case 0: hdr.magic ^= 1; break;
+        case 1: hdr.version = DTLS_CID_STORE_VERSION + 1; break;
+        case 2: hdr.len = 0; break;
+        case 3: hdr.len = DTLS_CID_STORE_MAX_LEN + 1; break;
+        case 4: len -= 1; break;                              /* torn write */
+        case 5: len = sizeof(hdr) - 1; break;
+        case 6: bad[sizeof(hdr)] ^= 0x20; break;              /* other library version */
+        }
+        memcpy(bad, &hdr, sizeof(hdr));
+        host_fs_put(path, bad, len);
+
+        connInit(&c, &conf);
+        HOST_CHECK(dtls_cid_resume(&c.ssl, path) == DTLS_FAILURE);
+        HOST_CHECK(!c.established && host_fs_count() == 0);
+        /* a load the library refused is followed by a session reset */
+        HOST_CHECK(c.resets == (k == 6));
+        n++;
+    }
+
+    host_fs_put(path, good, sizeof(good));
+    connInit(&c, &conf);
+    HOST_CHECK(dtls_cid_resume(&c.ssl, path) == DTLS_OK && c.peerCidLen == 8);
+
+    printf("damaged: %d damaged stores refused and removed\n", n);
+}
+
+/* The device wakes, resumes or shakes hands, sends a few records and
+ * suspends again; now and then it loses the connection between resume and
+ * suspend, as after a watchdog reset. The server keeps the highest record
+ * number seen per key set and would drop a replay. */
+static void testHibernate(void)
+{
+    const char *path = "dtls_lwm2m.example_5684.ses";
+    mbedtls_ssl_config conf;
+    HostConn c;
+    uint8_t serverKeys[32];
+    uint64_t serverSeen = 0;
+    unsigned resumed = 0;
+    unsigned handshakes = 0;
+    unsigned lost = 0;
+    unsigned records = 0;
+    unsigned reused = 0;
+    int i;
+
+    srand(33);
+    memset(&conf, 0, sizeof(conf));
+    memset(serverKeys, 0, sizeof(serverKeys));
+    host_fs_clear();
+    HOST_CHECK(dtls_cid_conf(&conf) == DTLS_OK);
+
+    for (i = 0; i < HOST_CYCLES; i++)
+    {
+        int n;
+
+        connInit(&c, &conf);
+        HOST_CHECK(dtls_cid_enable(&c.ssl) == DTLS_OK);
+        if (dtls_cid_resume(&c.ssl, path) == DTLS_OK)
+        {
+            resumed++;
+        }
+        else
+        {
+            handshake(&c, 4);
+            memcpy(serverKeys, c.keys, sizeof(serverKeys));
+            serverSeen = 0;
+            handshakes++;
+        }
+        HOST_CHECK(dtls_cid_in_use(&c.ssl));
+        HOST_CHECK(memcmp(c.keys, serverKeys, sizeof(serverKeys)) == 0);
+
+        for (n = 1 + rand() % 5; n > 0; n--)
+        {
+            if (c.ctr <= serverSeen)
+                reused++;
+            else
+                serverSeen = c.ctr;
+            c.ctr++;
+            records++;
+        }
+
+        if (rand() % 10 == 0)
+        {
+            lost++;
+            continue;
+        }
+        HOST_CHECK(dtls_cid_suspend(&c.ssl, path) == DTLS_OK);
+    }
+
+    HOST_CHECK(reused == 0);
+    HOST_CHECK(handshakes == lost + 1 || handshakes == lost);
+    printf("hibernate: %d wake-ups, %u resumed, %u handshakes after %u lost, %u records, %u reused\n",
+           HOST_CYCLES, resumed, handshakes, lost, records, reused);
+}
+
+int main(int argc, char **argv)
+{
+    testPath();
+    testCid();
+    testSuspend();
+    testDamaged();
+    testHibernate();
+    return 0;
+}
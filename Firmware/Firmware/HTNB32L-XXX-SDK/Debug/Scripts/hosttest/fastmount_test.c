@@ -0,0 +1,410 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_lfs_fastmount.c over the emulated flash, with lfs_mount(),
+ * lfs_unmount() and lfs_format() wrapped at link time as on target: a
+ * cold boot mounts with littlefs; a mount right after a wake from
+ * hibernate restores lfs_t from the snapshot with two flash reads and
+ * leaves it as a cold mount of the same disk would, free.ack at
+ * block_count included, while the seed and the lookahead window carry
+ * over from before hibernate. The snapshot is refused when the boot is no
+ * wake, when it was used already or is damaged, when lfs_config changed,
+ * and when the root pair was committed to since; none is taken with a file
+ * open or a lookahead too large, and unmount and format drop it.
+ *
+ * By default littlefs is the stand-in of stubs/host_lfs.c. With
+ * make fastmount_lfs LFS_SRC=<littlefs v2.1.x checkout> the same checks
+ * run on littlefs itself, followed by files written after fast mounts
+ * that a cold mount must read back, and the lookahead bitmap checked
+ * against a traversal of the file system.
+ *
+ * The source is included to reach the snapshot.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "host_flash.h"
+#include "host_slpman.h"
+#include "mw_lfs_fastmount.c"
+
+/* LFS port settings */
+#define PORT_BLOCK_SIZE     4096
+#define PORT_BLOCK_COUNT    (FLASH_FS_REGION_SIZE / PORT_BLOCK_SIZE)
+#define PORT_CACHE_SIZE     256
+#define PORT_LOOKAHEAD_SIZE 16
+
+static uint8_t readBuf[PORT_CACHE_SIZE], progBuf[PORT_CACHE_SIZE];
+static uint8_t lookaheadBuf[MW_LFS_SNAP_MAX_LOOKAHEAD * 2] __attribute__((aligned(4)));
+static struct lfs_config cfg;
+static lfs_t lfs;
+
+void lfs_assert(bool test)
+{
+    HOST_CHECK(test);
+}
+
+static uint32_t addrOf(lfs_block_t block, lfs_off_t off)
+{
+    return FLASH_FS_REGION_OFFSET + block * PORT_BLOCK_SIZE + off;
+}
+
+static int bdRead(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size)
+{
+    (void)c;
+    return BSP_QSPI_Read_Safe(buffer, addrOf(block, off), size) == QSPI_OK ? 0 : LFS_ERR_IO;
+}
+
+static int bdProg(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size)
+{
+    (void)c;
+    return BSP_QSPI_Write_Safe((uint8_t *)buffer, addrOf(block, off), size) == QSPI_OK ? 0 : LFS_ERR_IO;
+}
+
+static int bdErase(const struct lfs_config *c, lfs_block_t block)
+{
+    (void)c;
+    return BSP_QSPI_Erase_Safe(addrOf(block, 0), PORT_BLOCK_SIZE) == QSPI_OK ? 0 : LFS_ERR_IO;
+}
+
+static int bdSync(const struct lfs_config *c)
+{
+    (void)c;
+    return 0;
+}
+
+static void portConfig(void)
+{
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.read = bdRead;
+    cfg.prog = bdProg;
+    cfg.erase = bdErase;
+    cfg.sync = bdSync;
+    cfg.read_size = PORT_CACHE_SIZE;
+    cfg.prog_size = PORT_CACHE_SIZE;
+    cfg.block_size = PORT_BLOCK_SIZE;
+    cfg.block_count = PORT_BLOCK_COUNT;
+    cfg.cache_size = PORT_CACHE_SIZE;
+    cfg.lookahead_size = PORT_LOOKAHEAD_SIZE;
+    cfg.block_cycles = 200;
+    cfg.read_buffer = readBuf;
+    cfg.prog_buffer = progBuf;
+    cfg.lookahead_buffer = lookaheadBuf;
+}
+
+/* A reset: RAM is gone but .usrNvMem and the flash are kept */
+static void powerUp(slpManSlpState_t last)
+{
+    memset(&lfs, 0xA5, sizeof(lfs));
+    memset(readBuf, 0xA5, sizeof(readBuf));
+    memset(progBuf, 0xA5, sizeof(progBuf));
+    memset(lookaheadBuf, 0xA5, sizeof(lookaheadBuf));
+    mwLfsMounted = PNULL;
+    host_slp_last = last;
+}
+
+static MwLfsFastMountStats stats(void)
+{
+    MwLfsFastMountStats s;
+
+    mwLfsFastMountGetStats(&s);
+    return s;
+}
+
+/* Mount after a wake from hibernate, returns the flash reads it took */
+static unsigned long wakeMount(MwLfsSnapReject expect)
+{
+    MwLfsFastMountStats s0 = stats(), s1;
+    unsigned long reads;
+
+    powerUp(SLP_HIB_STATE);
+    reads = host_flash_reads;
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+    reads = host_flash_reads - reads;
+    s1 = stats();
+    HOST_CHECK(s1.lastReject == expect);
+    HOST_CHECK(s1.fastMounts == s0.fastMounts + (expect == MW_LFS_SNAP_REJECT_NONE));
+    HOST_CHECK(s1.fullMounts == s0.fullMounts + (expect != MW_LFS_SNAP_REJECT_NONE));
+    return reads;
+}
+
+/* What a mount rebuilds, the cache contents aside */
+static void checkSameMount(const lfs_t *a, const lfs_t *b, BOOL sameWindow)
+{
+    HOST_CHECK(a->cfg == b->cfg);
+    HOST_CHECK(a->root[0] == b->root[0] && a->root[1] == b->root[1]);
+    HOST_CHECK(a->mlist == PNULL && b->mlist == PNULL);
+    HOST_CHECK(memcmp(&a->gstate, &b->gstate, sizeof(a->gstate)) == 0);
+    HOST_CHECK(memcmp(&a->gdisk, &b->gdisk, sizeof(a->gdisk)) == 0);
+    HOST_CHECK(a->name_max == b->name_max && a->file_max == b->file_max && a->attr_max == b->attr_max);
+    HOST_CHECK(a->free.buffer == b->free.buffer);
+    HOST_CHECK(a->free.ack == b->free.ack);
+    HOST_CHECK(a->rcache.buffer == b->rcache.buffer && a->pcache.buffer == b->pcache.buffer);
+    if (sameWindow)
+    {
+        HOST_CHECK(a->seed == b->seed);
+        HOST_CHECK(a->free.off == b->free.off && a->free.size == b->free.size && a->free.i == b->free.i);
+    }
+}
+
+static void checkCachesDropped(const lfs_t *l)
+{
+    lfs_size_t i;
+
+    HOST_CHECK(l->rcache.block == MW_LFS_BLOCK_NULL && l->pcache.block == MW_LFS_BLOCK_NULL);
+    for (i = 0; i < cfg.cache_size; i++)
+        HOST_CHECK(readBuf[i] == 0xFF && progBuf[i] == 0xFF);
+}
+
+static void testColdBoot(void)
+{
+    host_flash_blank();
+    portConfig();
+    HOST_CHECK(lfs_format(&lfs, &cfg) == 0);
+
+    powerUp(SLP_ACTIVE_STATE);
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+    HOST_CHECK(stats().fullMounts == 1 && stats().fastMounts == 0);
+    HOST_CHECK(stats().lastReject == MW_LFS_SNAP_REJECT_BOOT);
+    HOST_CHECK(host_slp_registered == 1);
+
+    /* A wake without a snapshot */
+    wakeMount(MW_LFS_SNAP_REJECT_INVALID);
+    HOST_CHECK(host_slp_registered == 1);
+    printf("cold boot: full mount, callback registered once\n");
+}
+
+/* Hibernate right after a mount: the fast mount is the cold mount */
+static void testMatchesColdMount(void)
+{
+    static lfs_t cold;
+    unsigned long reads;
+
+    host_slp_hibernate();
+    HOST_CHECK(stats().snapshots == 1);
+    reads = wakeMount(MW_LFS_SNAP_REJECT_NONE);
+    HOST_CHECK(reads == 2);
+    HOST_CHECK(lfs.free.ack == cfg.block_count);
+    checkCachesDropped(&lfs);
+
+    HOST_CHECK(__real_lfs_mount(&cold, &cfg) == 0);
+    checkSameMount(&lfs, &cold, TRUE);
+#ifndef HOST_LFS_REAL
+    /* The stand-in leaves the caches dropped as well: nothing differs */
+    HOST_CHECK(memcmp(&lfs, &cold, sizeof(lfs)) == 0);
+#endif
+    printf("fast mount: %lu flash reads, lfs_t as a cold mount, free.ack %u\n", reads, (unsigned)lfs.free.ack);
+}
+
+/* State moved on before hibernate carries over */
+static void testCarriedState(void)
+{
+    static lfs_t before;
+    static uint8_t window[PORT_LOOKAHEAD_SIZE];
+
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+#ifdef HOST_LFS_REAL
+    {
+        lfs_file_t f;
+
+        HOST_CHECK(lfs_file_open(&lfs, &f, "carry", LFS_O_WRONLY | LFS_O_CREAT) == 0);
+        HOST_CHECK(lfs_file_write(&lfs, &f, "carry", 5) == 5);
+        HOST_CHECK(lfs_file_close(&lfs, &f) == 0);
+        HOST_CHECK(lfs.free.size != 0);
+    }
+#else
+    /* As after allocations: a window filled, some of it used */
+    lfs.seed ^= 0x5A5A1234;
+    lfs.free.off = 40;
+    lfs.free.size = PORT_LOOKAHEAD_SIZE * 8;
+    lfs.free.i = 7;
+    lfs.free.ack = 3;
+    memset(lfs.free.buffer, 0, PORT_LOOKAHEAD_SIZE);
+    lfs.free.buffer[0] = 0x0000007F;
+#endif
+    before = lfs;
+    memcpy(window, lfs.free.buffer, sizeof(window));
+
+    host_slp_hibernate();
+    HOST_CHECK(stats().snapshots == 2);
+    HOST_CHECK(wakeMount(MW_LFS_SNAP_REJECT_NONE) == 2);
+    before.free.ack = cfg.block_count;
+    checkSameMount(&lfs, &before, TRUE);
+    HOST_CHECK(memcmp(lfs.free.buffer, window, sizeof(window)) == 0);
+    checkCachesDropped(&lfs);
+    printf("carried state: seed, lookahead window %u/%u and bitmap restored\n",
+           (unsigned)lfs.free.i, (unsigned)lfs.free.size);
+}
+
+static void testRejects(void)
+{
+    lfs_file_t f;
+    uint8_t *p;
+
+    /* Used once */
+    wakeMount(MW_LFS_SNAP_REJECT_INVALID);
+
+    /* A file open at hibernate */
+    HOST_CHECK(lfs_file_open(&lfs, &f, "open", LFS_O_WRONLY | LFS_O_CREAT) == 0);
+    host_slp_hibernate();
+    HOST_CHECK(mwLfsSnapArea.snap.magic == 0);
+    HOST_CHECK(lfs_file_close(&lfs, &f) == 0);
+    wakeMount(MW_LFS_SNAP_REJECT_INVALID);
+
+    /* Another lfs_config */
+    host_slp_hibernate();
+    cfg.lookahead_size = PORT_LOOKAHEAD_SIZE * 2;
+    wakeMount(MW_LFS_SNAP_REJECT_CONFIG);
+    cfg.lookahead_size = PORT_LOOKAHEAD_SIZE;
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+
+    /* A commit to the root pair after the snapshot */
+    host_slp_hibernate();
+    HOST_CHECK(lfs_mkdir(&lfs, "late") == 0);
+    wakeMount(MW_LFS_SNAP_REJECT_FLASH);
+
+    /* A booted, not woken, device */
+    host_slp_hibernate();
+    powerUp(SLP_ACTIVE_STATE);
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+    HOST_CHECK(stats().lastReject == MW_LFS_SNAP_REJECT_BOOT);
+
+    /* One byte of the snapshot damaged */
+    host_slp_hibernate();
+    p = (uint8_t *)&mwLfsSnapArea.snap.seed;
+    *p ^= 0x01;
+    wakeMount(MW_LFS_SNAP_REJECT_INVALID);
+
+    /* Invalidated */
+    host_slp_hibernate();
+    mwLfsFastMountInvalidate();
+    wakeMount(MW_LFS_SNAP_REJECT_INVALID);
+
+    /* Unmount and format drop it */
+    host_slp_hibernate();
+    HOST_CHECK(mwLfsSnapArea.snap.magic == MW_LFS_SNAP_MAGIC);
+    HOST_CHECK(lfs_unmount(&lfs) == 0);
+    HOST_CHECK(mwLfsSnapArea.snap.magic == 0);
+    host_slp_hibernate();
+    HOST_CHECK(mwLfsSnapArea.snap.magic == 0);
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+    host_slp_hibernate();
+    HOST_CHECK(lfs_format(&lfs, &cfg) == 0);
+    HOST_CHECK(mwLfsSnapArea.snap.magic == 0);
+    wakeMount(MW_LFS_SNAP_REJECT_INVALID);
+
+    /* A lookahead larger than the snapshot keeps */
+    cfg.lookahead_size = sizeof(lookaheadBuf);
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+    host_slp_hibernate();
+    HOST_CHECK(mwLfsSnapArea.snap.magic == 0);
+    wakeMount(MW_LFS_SNAP_REJECT_INVALID);
+    cfg.lookahead_size = PORT_LOOKAHEAD_SIZE;
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+
+    HOST_CHECK(host_slp_registered == 1);
+    printf("rejects: used, open file, config, root commit, boot, damaged, invalidated, unmount, format, lookahead\n");
+}
+
+#ifdef HOST_LFS_REAL
+static int markUsed(void *data, lfs_block_t block)
+{
+    uint8_t *used = data;
+
+    HOST_CHECK(block < PORT_BLOCK_COUNT);
+    used[block] = 1;
+    return 0;
+}
+
+/* No block the window still offers is in use */
+static void checkLookahead(void)
+{
+    static uint8_t used[PORT_BLOCK_COUNT];
+    lfs_block_t i;
+
+    memset(used, 0, sizeof(used));
+    HOST_CHECK(lfs_fs_traverse(&lfs, markUsed, used) == 0);
+    for (i = lfs.free.i; i < lfs.free.size; i++)
+    {
+        if (!(lfs.free.buffer[i / 32] & (1U << (i % 32))))
+            HOST_CHECK(!used[(lfs.free.off + i) % PORT_BLOCK_COUNT]);
+    }
+}
+
+static void fileName(char *name, int n)
+{
+    sprintf(name, "f%02d", n);
+}
+
+/* Files written across hibernate cycles, read back by a cold mount */
+static void testWorkload(void)
+{
+    char name[8], buf[64], got[64];
+    unsigned long fast = 0, full;
+    lfs_file_t f;
+    int cycle, n;
+
+    for (cycle = 0; cycle < 40; cycle++)
+    {
+        host_slp_hibernate();
+        fast += wakeMount(MW_LFS_SNAP_REJECT_NONE);
+        checkLookahead();
+        for (n = 0; n < 4; n++)
+        {
+            fileName(name, (cycle * 4 + n) % 24);
+            memset(buf, 'a' + cycle % 26, sizeof(buf));
+            HOST_CHECK(lfs_file_open(&lfs, &f, name, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) == 0);
+            HOST_CHECK(lfs_file_write(&lfs, &f, buf, sizeof(buf)) == sizeof(buf));
+            HOST_CHECK(lfs_file_close(&lfs, &f) == 0);
+        }
+        checkLookahead();
+    }
+
+    powerUp(SLP_ACTIVE_STATE);
+    full = host_flash_reads;
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+    full = host_flash_reads - full;
+    for (n = 0; n < 24; n++)
+    {
+        int last = (n < 16) ? 36 + n / 4 : 34 + (n - 16) / 4;  //cycle that wrote file n last
+
+        fileName(name, n);
+        memset(buf, 'a' + last % 26, sizeof(buf));
+        HOST_CHECK(lfs_file_open(&lfs, &f, name, LFS_O_RDONLY) == 0);
+        HOST_CHECK(lfs_file_read(&lfs, &f, got, sizeof(got)) == sizeof(got));
+        HOST_CHECK(memcmp(got, buf, sizeof(buf)) == 0);
+        HOST_CHECK(lfs_file_close(&lfs, &f) == 0);
+    }
+    printf("workload: 40 hibernate cycles, %lu flash reads per fast mount, %lu for a full one\n",
+           fast / 40, full);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    testColdBoot();
+    testMatchesColdMount();
+    testCarriedState();
+    testRejects();
+#ifdef HOST_LFS_REAL
+    testWorkload();
+#endif
+    printf("stats: %u fast, %u full, %u snapshots\n",
+           (unsigned)stats().fastMounts, (unsigned)stats().fullMounts, (unsigned)stats().snapshots);
+    return 0;
+}
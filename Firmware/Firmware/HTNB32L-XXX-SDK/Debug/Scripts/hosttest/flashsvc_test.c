@@ -0,0 +1,292 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_flashsvc.c with its task on a host thread, over emulated NOR flash
+ * that takes time to program and erase. Three tasks, started together,
+ * erase and stream their own sectors and read them back while queued,
+ * against a model; erase-ahead skips only the sectors still blank;
+ * a flush that times out leaves no waiter counted and no token behind.
+ * "bench" times a FOTA-like stream written directly and through the
+ * service.
+ *
+ * The source is included for its waiter count and done semaphore.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include "host_stubs.h"
+#include "host_flash.h"
+#include "host_os.h"
+#include "mw_flashsvc.c"
+
+#define PRODUCERS       3
+#define REGION_SECTORS  16
+#define REGION(t)       (0x100000 + (t) * REGION_SECTORS * MW_FLASHSVC_SECTOR_SIZE)
+#define SECTOR_ADDR(t, s) (REGION(t) + (s) * MW_FLASHSVC_SECTOR_SIZE)
+
+typedef struct
+{
+    int             id;
+    unsigned        seed;
+    UINT8           model[REGION_SECTORS * MW_FLASHSVC_SECTOR_SIZE];
+    UINT8           known[REGION_SECTORS];      //0: announced, contents undefined
+    unsigned long   reads;
+} Producer;
+
+static Producer producers[PRODUCERS];
+
+/* What the service reads for the known sectors equals the model */
+static void checkRead(Producer *p)
+{
+    static __thread UINT8 buf[3 * MW_FLASHSVC_SECTOR_SIZE];
+    UINT32 s = rand_r(&p->seed) % REGION_SECTORS;
+    UINT32 off = rand_r(&p->seed) % MW_FLASHSVC_SECTOR_SIZE;
+    UINT32 len = 1 + rand_r(&p->seed) % (2 * MW_FLASHSVC_SECTOR_SIZE);
+    UINT32 from = s * MW_FLASHSVC_SECTOR_SIZE + off, i;
+
+    if (from + len > sizeof(p->model))
+        len = sizeof(p->model) - from;
+    HOST_CHECK(mwFlashSvcRead(REGION(p->id) + from, buf, len) == MW_FLASHSVC_OK);
+    for (i = 0; i < len; i++)
+    {
+        if (p->known[(from + i) / MW_FLASHSVC_SECTOR_SIZE])
+            HOST_CHECK(buf[i] == p->model[from + i]);
+    }
+    p->reads++;
+}
+
+static void *producer(void *arg)
+{
+    Producer *p = arg;
+    UINT8 chunk[600];
+    UINT32 s, other, off, n, i;
+    int round;
+
+    for (round = 0; round < 40; round++)
+    {
+        s = rand_r(&p->seed) % REGION_SECTORS;
+        HOST_CHECK(mwFlashSvcErase(SECTOR_ADDR(p->id, s), MW_FLASHSVC_SECTOR_SIZE) == MW_FLASHSVC_OK);
+        memset(&p->model[s * MW_FLASHSVC_SECTOR_SIZE], 0xFF, MW_FLASHSVC_SECTOR_SIZE);
+        p->known[s] = 1;
+
+        /* Announce another one, written in a later round after its erase */
+        other = rand_r(&p->seed) % REGION_SECTORS;
+        if (other != s && rand_r(&p->seed) % 2)
+        {
+            HOST_CHECK(mwFlashSvcEraseAhead(SECTOR_ADDR(p->id, other), MW_FLASHSVC_SECTOR_SIZE) == MW_FLASHSVC_OK);
+            p->known[other] = 0;
+        }
+
+        /* Stream the sector in pieces that straddle the pages */
+        for (off = 0; off < MW_FLASHSVC_SECTOR_SIZE; off += n)
+        {
+            n = 1 + rand_r(&p->seed) % sizeof(chunk);
+            if (n > MW_FLASHSVC_SECTOR_SIZE - off)
+                n = MW_FLASHSVC_SECTOR_SIZE - off;
+            for (i = 0; i < n; i++)
+                chunk[i] = (UINT8)rand_r(&p->seed);
+            HOST_CHECK(mwFlashSvcProgram(SECTOR_ADDR(p->id, s) + off, chunk, n) == MW_FLASHSVC_OK);
+            memcpy(&p->model[s * MW_FLASHSVC_SECTOR_SIZE + off], chunk, n);
+            if (rand_r(&p->seed) % 4 == 0)
+                checkRead(p);
+        }
+        checkRead(p);
+    }
+    return NULL;
+}
+
+static void testProducers(void)
+{
+    pthread_t t[PRODUCERS];
+    MwFlashSvcStats stats;
+    unsigned long reads = 0;
+    int i, s;
+
+    host_flash_program_us = 20;
+    host_flash_erase_us = 300;
+    for (i = 0; i < PRODUCERS; i++)
+    {
+        producers[i].id = i;
+        producers[i].seed = i + 1;
+        memcpy(producers[i].model, &host_flash[REGION(i)], sizeof(producers[i].model));
+        memset(producers[i].known, 1, sizeof(producers[i].known));
+    }
+
+    /* The first calls start the service, from all of them at once */
+    for (i = 0; i < PRODUCERS; i++)
+        HOST_CHECK(pthread_create(&t[i], NULL, producer, &producers[i]) == 0);
+    for (i = 0; i < PRODUCERS; i++)
+        pthread_join(t[i], NULL);
+    HOST_CHECK(mwFlashSvcFlush(osWaitForever) == MW_FLASHSVC_OK);
+
+    for (i = 0; i < PRODUCERS; i++)
+    {
+        for (s = 0; s < REGION_SECTORS; s++)
+        {
+            if (producers[i].known[s])
+                HOST_CHECK(memcmp(&host_flash[SECTOR_ADDR(i, s)],
+                                  &producers[i].model[s * MW_FLASHSVC_SECTOR_SIZE], MW_FLASHSVC_SECTOR_SIZE) == 0);
+        }
+        reads += producers[i].reads;
+    }
+    HOST_CHECK(host_flash_page_cross == 0);
+
+    mwFlashSvcGetStats(&stats);
+    HOST_CHECK(stats.program.count == host_flash_programs);
+    HOST_CHECK(stats.programRequests - stats.programMerged == stats.program.count);
+    HOST_CHECK(stats.queueHigh == MW_FLASHSVC_QUEUE_DEPTH && stats.callerWaits > 0);
+    HOST_CHECK(stats.erase.count + stats.eraseSkipped == stats.eraseRequests);
+    printf("producers: %d tasks, %u pages asked, %u merged, %u programs, %u erases (%u ahead, %u skipped), "
+           "%lu reads equal to the model\n", PRODUCERS, stats.programRequests, stats.programMerged,
+           stats.program.count, stats.erase.count, stats.eraseAhead.count, stats.eraseSkipped, reads);
+}
+
+static void waitAhead(UINT32 count)
+{
+    MwFlashSvcStats stats;
+    int i;
+
+    for (i = 0; i < 2000; i++)
+    {
+        mwFlashSvcGetStats(&stats);
+        if (stats.eraseAhead.count >= count)
+            return;
+        osDelay(1);
+    }
+    HOST_CHECK(0);
+}
+
+static void testEraseAhead(void)
+{
+    UINT32 base = 0x200000;
+    MwFlashSvcStats stats;
+    UINT8 zero = 0;
+
+    host_flash_program_us = 0;
+    host_flash_erase_us = 0;
+    memset(&host_flash[base], 0, 4 * MW_FLASHSVC_SECTOR_SIZE);
+    mwFlashSvcResetStats();
+
+    /* Announced, erased in the background, so the erases are checks */
+    HOST_CHECK(mwFlashSvcEraseAhead(base, 4 * MW_FLASHSVC_SECTOR_SIZE) == MW_FLASHSVC_OK);
+    waitAhead(4);
+    HOST_CHECK(host_flash[base] == 0xFF && host_flash[base + 4 * MW_FLASHSVC_SECTOR_SIZE - 1] == 0xFF);
+
+    /* Sector 1 no longer blank, as after a write the service did not see:
+     * it is erased again. Sector 2 was programmed through the service
+     * after an erase, so its next erase runs too. */
+    host_flash[base + MW_FLASHSVC_SECTOR_SIZE + 7] = 0x00;
+    HOST_CHECK(mwFlashSvcErase(base + 2 * MW_FLASHSVC_SECTOR_SIZE, MW_FLASHSVC_SECTOR_SIZE) == MW_FLASHSVC_OK);
+    HOST_CHECK(mwFlashSvcProgram(base + 2 * MW_FLASHSVC_SECTOR_SIZE, &zero, 1) == MW_FLASHSVC_OK);
+    HOST_CHECK(mwFlashSvcErase(base, 4 * MW_FLASHSVC_SECTOR_SIZE) == MW_FLASHSVC_OK);
+    HOST_CHECK(mwFlashSvcFlush(osWaitForever) == MW_FLASHSVC_OK);
+
+    mwFlashSvcGetStats(&stats);
+    HOST_CHECK(stats.eraseRequests == 5);
+    HOST_CHECK(stats.eraseSkipped == 3);        //sector 2 once, sectors 0 and 3
+    HOST_CHECK(stats.erase.count == 2);         //sectors 1 and 2
+    HOST_CHECK(host_flash[base + MW_FLASHSVC_SECTOR_SIZE + 7] == 0xFF && host_flash[base + 2 * MW_FLASHSVC_SECTOR_SIZE] == 0xFF);
+}
+
+static void testFlushTimeout(void)
+{
+    UINT32 base = 0x210000;
+    UINT32 waiters;
+    int i;
+
+    host_flash_erase_us = 100000;
+    for (i = 0; i < 3; i++)
+    {
+        HOST_CHECK(mwFlashSvcErase(base + i * MW_FLASHSVC_SECTOR_SIZE, MW_FLASHSVC_SECTOR_SIZE) == MW_FLASHSVC_OK);
+        host_flash[base + i * MW_FLASHSVC_SECTOR_SIZE] = 0;
+    }
+    HOST_CHECK(mwFlashSvcFlush(10) == MW_FLASHSVC_ERR_TIMEOUT);
+    HOST_CHECK(mwFlashSvcFlush(0) == MW_FLASHSVC_ERR_TIMEOUT);
+
+    osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+    waiters = mwFlashSvc.waiters;
+    osMutexRelease(mwFlashSvc.lock);
+    HOST_CHECK(waiters == 0);
+
+    HOST_CHECK(mwFlashSvcFlush(osWaitForever) == MW_FLASHSVC_OK);
+    host_flash_erase_us = 0;
+
+    /* Every completion token went to a waiter */
+    HOST_CHECK(osSemaphoreAcquire(mwFlashSvc.done, 0) != osOK);
+}
+
+/* 16 sectors received in 512 byte pieces, each taking recvUs to arrive */
+static double stream(int queued, unsigned recvUs)
+{
+    static UINT8 image[16 * MW_FLASHSVC_SECTOR_SIZE];
+    UINT32 base = 0x300000, off;
+    double t0;
+
+    for (off = 0; off < sizeof(image); off++)
+        image[off] = (UINT8)(off * 7);
+    t0 = host_now();
+    if (queued)
+        HOST_CHECK(mwFlashSvcEraseAhead(base, sizeof(image)) == MW_FLASHSVC_OK);
+    for (off = 0; off < sizeof(image); off += 512)
+    {
+        usleep(recvUs);
+        if (off % MW_FLASHSVC_SECTOR_SIZE == 0)
+        {
+            if (queued)
+                HOST_CHECK(mwFlashSvcErase(base + off, MW_FLASHSVC_SECTOR_SIZE) == MW_FLASHSVC_OK);
+            else
+                HOST_CHECK(BSP_QSPI_Erase_Safe(base + off, MW_FLASHSVC_SECTOR_SIZE) == QSPI_OK);
+        }
+        if (queued)
+        {
+            HOST_CHECK(mwFlashSvcProgram(base + off, &image[off], 512) == MW_FLASHSVC_OK);
+        }
+        else
+        {
+            HOST_CHECK(BSP_QSPI_Write_Safe(&image[off], base + off, 256) == QSPI_OK);
+            HOST_CHECK(BSP_QSPI_Write_Safe(&image[off + 256], base + off + 256, 256) == QSPI_OK);
+        }
+    }
+    if (queued)
+        HOST_CHECK(mwFlashSvcFlush(osWaitForever) == MW_FLASHSVC_OK);
+    HOST_CHECK(memcmp(&host_flash[base], image, sizeof(image)) == 0);
+    return host_now() - t0;
+}
+
+/* W25Q32 typical times divided by 10: page program 70 us, erase 4.5 ms */
+static void bench(void)
+{
+    double direct, queued;
+
+    host_flash_program_us = 70;
+    host_flash_erase_us = 4500;
+    direct = stream(0, 500);
+    queued = stream(1, 500);
+    printf("bench: 64 KB stream, 512 B every 0.5 ms: direct %.1f ms, queued with erase-ahead %.1f ms "
+           "(receiving alone %.1f ms)\n", direct * 1e3, queued * 1e3, 128 * 0.5);
+}
+
+int main(int argc, char **argv)
+{
+    host_flash_blank();
+    testProducers();
+    testEraseAhead();
+    testFlushTimeout();
+    printf("erase-ahead: blank sectors skipped, dirty ones erased; flush timeouts leave no waiter\n");
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
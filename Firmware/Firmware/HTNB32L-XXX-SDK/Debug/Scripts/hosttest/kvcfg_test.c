@@ -0,0 +1,252 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_kvcfg.c on emulated NOR flash, against a model of the keys: random
+ * sets, deletes and formats with reboots in between; the index built at
+ * boot with no key and with every key; power cuts at random points of
+ * random operations, after each of which the store must hold either the
+ * state before the interrupted operation or the one after it. "bench"
+ * times the lookups and the boot.
+ *
+ * The source is included so that a reboot can be modelled by clearing its
+ * RAM state.
+ */
+
+#include "host_stubs.h"
+#include "host_flash.h"
+#include "mw_kvcfg.c"
+
+#define NKEYS           40
+
+typedef struct
+{
+    int     used;
+    int     len;
+    UINT8   data[MW_KVCFG_SLOT_DATA];
+} Item;
+
+static Item model[NKEYS], prev[NKEYS];
+static char names[NKEYS][32];
+
+static int count(const Item *m)
+{
+    int i, n = 0;
+
+    for (i = 0; i < NKEYS; i++)
+        n += m[i].used;
+    return n;
+}
+
+/* The store holds what m says */
+static int same(const Item *m)
+{
+    UINT8 buf[MW_KVCFG_SLOT_DATA];
+    INT32 rc;
+    int i;
+
+    for (i = 0; i < NKEYS; i++)
+    {
+        rc = mwKvCfgGet(names[i], buf, sizeof(buf));
+        if (!m[i].used)
+        {
+            if (rc != MW_KVCFG_ERR_NOT_FOUND)
+                return 0;
+        }
+        else if (rc != m[i].len || memcmp(buf, m[i].data, rc) != 0)
+        {
+            return 0;
+        }
+    }
+    return mwKvcfg.keys == (UINT32)count(m);
+}
+
+static void reboot(void)
+{
+    host_flash_cut = -1;
+    host_flash_off = 0;
+    memset(&mwKvcfg, 0, sizeof(mwKvcfg));
+    HOST_CHECK(mwKvCfgInit() == MW_KVCFG_OK);
+}
+
+/* One random operation, applied to the model when the store reports it done */
+static void randomOp(void)
+{
+    int id = rand() % NKEYS, r = rand() % 100, keyLen = (int)strlen(names[id]), len, i;
+    UINT8 buf[MW_KVCFG_SLOT_DATA];
+    INT32 rc;
+
+    memcpy(prev, model, sizeof(model));
+    if (r < 80)
+    {
+        if (model[id].used && rand() % 5 == 0)
+        {
+            len = model[id].len;
+            memcpy(buf, model[id].data, len);
+        }
+        else
+        {
+            len = rand() % (MW_KVCFG_SLOT_DATA - keyLen + 1);
+            for (i = 0; i < len; i++)
+                buf[i] = (UINT8)rand();
+        }
+        rc = mwKvCfgSet(names[id], buf, (UINT16)len);
+        if (rc == MW_KVCFG_OK)
+        {
+            model[id].used = 1;
+            model[id].len = len;
+            memcpy(model[id].data, buf, len);
+        }
+        else if (!host_flash_off)
+        {
+            HOST_CHECK(rc == MW_KVCFG_ERR_FULL && !model[id].used && count(model) == MW_KVCFG_MAX_KEYS);
+        }
+    }
+    else if (r < 98)
+    {
+        rc = mwKvCfgDelete(names[id]);
+        if (rc == MW_KVCFG_OK)
+            model[id].used = 0;
+        else if (!host_flash_off)
+            HOST_CHECK(rc == MW_KVCFG_ERR_NOT_FOUND && !model[id].used);
+    }
+    else if (mwKvCfgFormat() == MW_KVCFG_OK)
+    {
+        memset(model, 0, sizeof(model));
+    }
+}
+
+static void testApi(void)
+{
+    UINT8 buf[8] = { 0 };
+    CHAR str[16];
+
+    HOST_CHECK(mwKvCfgSet("", buf, 1) == MW_KVCFG_ERR_PARAM);
+    HOST_CHECK(mwKvCfgSet("k", buf, MW_KVCFG_SLOT_DATA) == MW_KVCFG_ERR_PARAM);
+    HOST_CHECK(strcmp(mwKvCfgGetStr("apn", str, sizeof(str), "nbiot.gsim"), "nbiot.gsim") == 0);
+    HOST_CHECK(mwKvCfgSetStr("apn", "iot.apn") == MW_KVCFG_OK);
+    HOST_CHECK(strcmp(mwKvCfgGetStr("apn", str, sizeof(str), "x"), "iot.apn") == 0);
+    HOST_CHECK(strcmp(mwKvCfgGetStr("apn", str, 5, "x"), "x") == 0);
+    HOST_CHECK(mwKvCfgDelete("apn") == MW_KVCFG_OK);
+    HOST_CHECK(mwKvCfgDelete("apn") == MW_KVCFG_ERR_NOT_FOUND);
+}
+
+static void testModel(void)
+{
+    int k;
+
+    for (k = 0; k < 30000; k++)
+    {
+        randomOp();
+        HOST_CHECK(same(model));
+        if (k % 991 == 0)
+        {
+            reboot();
+            HOST_CHECK(same(model));
+        }
+    }
+    printf("kvcfg: 30000 random operations and %d reboots, equal to the model\n", 30000 / 991 + 1);
+}
+
+/* Boot reads the same number of slots with no key and with every key */
+static void testBoot(void)
+{
+    unsigned long empty;
+    UINT8 b;
+    int k;
+
+    HOST_CHECK(mwKvCfgFormat() == MW_KVCFG_OK);
+    memset(model, 0, sizeof(model));
+    host_flash_reads = 0;
+    reboot();
+    empty = host_flash_reads;
+    for (k = 0; k < MW_KVCFG_MAX_KEYS; k++)
+    {
+        b = (UINT8)k;
+        HOST_CHECK(mwKvCfgSet(names[k], &b, 1) == MW_KVCFG_OK);
+        model[k].used = 1;
+        model[k].len = 1;
+        model[k].data[0] = b;
+    }
+    HOST_CHECK(mwKvCfgSet(names[k], &b, 1) == MW_KVCFG_ERR_FULL);
+    host_flash_reads = 0;
+    reboot();
+    HOST_CHECK(host_flash_reads == empty);
+    HOST_CHECK(same(model));
+    host_flash_reads = 0;
+    HOST_CHECK(mwKvCfgGet(names[5], &b, 1) == 1 && b == 5);
+    HOST_CHECK(host_flash_reads == 1);
+}
+
+static void testPowerCuts(void)
+{
+    int run, k, rolledBack = 0;
+
+    for (run = 0; run < 5000; run++)
+    {
+        host_flash_cut = rand() % 40;
+        while (!host_flash_off)
+            randomOp();
+        reboot();
+        if (!same(model))
+        {
+            HOST_CHECK(same(prev));
+            memcpy(model, prev, sizeof(model));
+            rolledBack++;
+        }
+        for (k = rand() % 30; k > 0; k--)
+        {
+            randomOp();
+            HOST_CHECK(same(model));
+        }
+    }
+    printf("kvcfg: 5000 power cuts, %d operations rolled back, the others kept\n", rolledBack);
+}
+
+static void bench(void)
+{
+    UINT8 buf[MW_KVCFG_SLOT_DATA];
+    double t0;
+    int k;
+
+    t0 = host_now();
+    for (k = 0; k < 1000000; k++)
+        mwKvCfgGet(names[k % MW_KVCFG_MAX_KEYS], buf, sizeof(buf));
+    printf("1M lookups: %.0f ns each\n", (host_now() - t0) * 1e3);
+    host_flash_reads = 0;
+    t0 = host_now();
+    for (k = 0; k < 10000; k++)
+        reboot();
+    printf("boot with %d keys: %.1f us, %lu flash reads\n", count(model), (host_now() - t0) * 1e2,
+           host_flash_reads / 10000);
+}
+
+int main(int argc, char **argv)
+{
+    int k;
+
+    for (k = 0; k < NKEYS; k++)
+        sprintf(names[k], k % 3 ? "key.%d" : "a.much.longer.key.name.%d", k);
+    srand(1);
+    host_flash_blank();
+    reboot();
+    testApi();
+    testModel();
+    testBoot();
+    testPowerCuts();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
@@ -0,0 +1,335 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * littlefs with the LFS port settings on emulated NOR flash, at the FS
+ * area of mem_map.h: the checks cut the power at random points of a
+ * file rewrite, each remount must find the old or the new content. "bench"
+ * runs the suite of the port settings and a sweep of cache, lookahead
+ * and block_cycles: format, small files, a directory scan, remount,
+ * append+sync, and the erase spread of a rewritten file.
+ *
+ * lfs.c is not in this tree (the port ships as HT_Prebuild/Libs/liblfs.a),
+ * so this builds the in-tree lfs.h against a littlefs v2.1 checkout:
+ * make lfs_bench LFS_SRC=<littlefs v2.1.x>. The block device below does
+ * what the port does, BSP_QSPI_*_Safe() at FLASH_FS_REGION_OFFSET.
+ *
+ * Times are those of the flash, modelled per operation with the typical
+ * figures of the QSPI NOR part, not host time.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "host_flash.h"
+#include "flash_qcx212_rt.h"
+#include "mem_map.h"
+#include "lfs.h"
+
+/* LFS port settings */
+#define PORT_READ_SIZE      256
+#define PORT_PROG_SIZE      256
+#define PORT_BLOCK_SIZE     4096
+#define PORT_BLOCK_COUNT    (FLASH_FS_REGION_SIZE / PORT_BLOCK_SIZE)
+#define PORT_CACHE_SIZE     256
+#define PORT_LOOKAHEAD_SIZE 16
+#define PORT_BLOCK_CYCLES   200
+
+/* Typical figures of the QSPI NOR flash, in microseconds */
+#define READ_SETUP_US       2.0
+#define READ_BYTE_US        0.02
+#define PROG_PAGE_US        700.0
+#define ERASE_SECTOR_US     45000.0
+
+#define MAX_SAMPLES         5000
+
+static double flashUs;
+static unsigned long blockErases[PORT_BLOCK_COUNT];
+
+void lfs_assert(bool test)
+{
+    HOST_CHECK(test);
+}
+
+static uint32_t addrOf(lfs_block_t block, lfs_off_t off)
+{
+    return FLASH_FS_REGION_OFFSET + block * PORT_BLOCK_SIZE + off;
+}
+
+static int bdRead(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size)
+{
+    (void)c;
+    flashUs += READ_SETUP_US + READ_BYTE_US * size;
+    return BSP_QSPI_Read_Safe(buffer, addrOf(block, off), size) == QSPI_OK ? 0 : LFS_ERR_IO;
+}
+
+static int bdProg(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size)
+{
+    lfs_size_t n;
+
+    (void)c;
+    /* One page at a time, as the part takes them */
+    for (n = 0; n < size; n += PORT_PROG_SIZE)
+    {
+        flashUs += PROG_PAGE_US;
+        if (BSP_QSPI_Write_Safe((uint8_t *)buffer + n, addrOf(block, off + n), PORT_PROG_SIZE) != QSPI_OK)
+            return LFS_ERR_IO;
+    }
+    return 0;
+}
+
+static int bdErase(const struct lfs_config *c, lfs_block_t block)
+{
+    (void)c;
+    flashUs += ERASE_SECTOR_US;
+    if (!host_flash_off)
+        blockErases[block]++;
+    return BSP_QSPI_Erase_Safe(addrOf(block, 0), PORT_BLOCK_SIZE) == QSPI_OK ? 0 : LFS_ERR_IO;
+}
+
+static int bdSync(const struct lfs_config *c)
+{
+    (void)c;
+    return 0;
+}
+
+static struct lfs_config portConfig(lfs_size_t cache, lfs_size_t lookahead, int32_t cycles)
+{
+    struct lfs_config cfg;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.read = bdRead;
+    cfg.prog = bdProg;
+    cfg.erase = bdErase;
+    cfg.sync = bdSync;
+    cfg.read_size = PORT_READ_SIZE;
+    cfg.prog_size = PORT_PROG_SIZE;
+    cfg.block_size = PORT_BLOCK_SIZE;
+    cfg.block_count = PORT_BLOCK_COUNT;
+    cfg.cache_size = cache;
+    cfg.lookahead_size = lookahead;
+    cfg.block_cycles = cycles;
+    return cfg;
+}
+
+static int cmpDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void summary(const char *what, double *us, int n)
+{
+    double sum = 0;
+    int i;
+
+    qsort(us, n, sizeof(us[0]), cmpDouble);
+    for (i = 0; i < n; i++)
+        sum += us[i];
+    printf("  %-24s mean %8.1f ms  p95 %8.1f ms  max %8.1f ms\n", what,
+           sum / n / 1000, us[n * 95 / 100 - (n > 1)] / 1000, us[n - 1] / 1000);
+}
+
+static int writeFile(lfs_t *lfs, const char *name, const void *data, lfs_size_t len)
+{
+    lfs_file_t f;
+    int err;
+
+    err = lfs_file_open(lfs, &f, name, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC);
+    if (err)
+        return err;
+    if (lfs_file_write(lfs, &f, data, len) != (lfs_ssize_t)len)
+        err = LFS_ERR_IO;
+    return lfs_file_close(lfs, &f) ? LFS_ERR_IO : err;
+}
+
+static int readFile(lfs_t *lfs, const char *name, void *data, lfs_size_t len)
+{
+    lfs_file_t f;
+    lfs_ssize_t n;
+    int err;
+
+    err = lfs_file_open(lfs, &f, name, LFS_O_RDONLY);
+    if (err)
+        return err;
+    n = lfs_file_read(lfs, &f, data, len);
+    lfs_file_close(lfs, &f);
+    return (int)n;
+}
+
+static void suite(lfs_size_t cache, lfs_size_t lookahead, int32_t cycles)
+{
+    static double us[MAX_SAMPLES];
+    struct lfs_config cfg = portConfig(cache, lookahead, cycles);
+    struct lfs_info info;
+    lfs_dir_t dir;
+    lfs_file_t f;
+    lfs_t lfs;
+    char name[32];
+    uint8_t buf[256], back[256];
+    unsigned long erased, min, max;
+    double t0, sum;
+    int i, n;
+
+    host_flash_blank();
+    memset(blockErases, 0, sizeof(blockErases));
+    printf("cache_size %u  lookahead_size %u  block_cycles %d\n", cache, lookahead, (int)cycles);
+
+    t0 = flashUs;
+    HOST_CHECK(lfs_format(&lfs, &cfg) == 0 && lfs_mount(&lfs, &cfg) == 0);
+    printf("  %-24s %8.1f ms\n", "format+mount", (flashUs - t0) / 1000);
+
+    /* 64 files of 100 bytes */
+    HOST_CHECK(lfs_mkdir(&lfs, "small") == 0);
+    for (i = 0; i < 64; i++)
+    {
+        sprintf(name, "small/f%03d", i);
+        memset(buf, i, 100);
+        t0 = flashUs;
+        HOST_CHECK(writeFile(&lfs, name, buf, 100) == 0);
+        us[i] = flashUs - t0;
+    }
+    summary("write 64 x 100 B", us, 64);
+    for (i = 0; i < 64; i++)
+    {
+        sprintf(name, "small/f%03d", i);
+        t0 = flashUs;
+        HOST_CHECK(readFile(&lfs, name, back, sizeof(back)) == 100);
+        us[i] = flashUs - t0;
+        memset(buf, i, 100);
+        HOST_CHECK(memcmp(buf, back, 100) == 0);
+    }
+    summary("read 64 x 100 B", us, 64);
+
+    t0 = flashUs;
+    n = 0;
+    HOST_CHECK(lfs_dir_open(&lfs, &dir, "small") == 0);
+    while (lfs_dir_read(&lfs, &dir, &info) > 0)
+        n++;
+    lfs_dir_close(&lfs, &dir);
+    HOST_CHECK(n == 64 + 2);
+    printf("  %-24s %8.1f ms\n", "scan of 64 entries", (flashUs - t0) / 1000);
+
+    HOST_CHECK(lfs_unmount(&lfs) == 0);
+    t0 = flashUs;
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+    printf("  %-24s %8.1f ms\n", "mount", (flashUs - t0) / 1000);
+
+    /* 2000 records of 24 bytes, each synced */
+    erased = host_flash_erases;
+    sum = 0;
+    HOST_CHECK(lfs_file_open(&lfs, &f, "telemetry.log", LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND) == 0);
+    for (i = 0; i < 2000; i++)
+    {
+        memset(buf, i, 24);
+        t0 = flashUs;
+        HOST_CHECK(lfs_file_write(&lfs, &f, buf, 24) == 24 && lfs_file_sync(&lfs, &f) == 0);
+        us[i] = flashUs - t0;
+        sum += us[i];
+    }
+    HOST_CHECK(lfs_file_close(&lfs, &f) == 0);
+    summary("append+sync 2000 x 24 B", us, 2000);
+    printf("  %.0f records/s of flash time, %.0f erases per million records\n",
+           2000 / (sum / 1e6), (host_flash_erases - erased) * 1e6 / 2000);
+    HOST_CHECK(lfs_remove(&lfs, "telemetry.log") == 0);
+
+    /* Wear of a 200 byte file rewritten 5000 times */
+    memset(blockErases, 0, sizeof(blockErases));
+    for (i = 0; i < 5000; i++)
+    {
+        memset(buf, i, 200);
+        HOST_CHECK(writeFile(&lfs, "config.nvm", buf, 200) == 0);
+    }
+    min = max = blockErases[0];
+    sum = n = 0;
+    for (i = 0; i < PORT_BLOCK_COUNT; i++)
+    {
+        min = blockErases[i] < min ? blockErases[i] : min;
+        max = blockErases[i] > max ? blockErases[i] : max;
+        sum += blockErases[i];
+        n += blockErases[i] == 0;
+    }
+    printf("  5000 rewrites of 200 B: erases min %lu max %lu mean %.1f, %d blocks never erased\n",
+           min, max, sum / PORT_BLOCK_COUNT, n);
+    HOST_CHECK(lfs_unmount(&lfs) == 0);
+    if (host_flash_page_cross)
+        printf("  %lu programs crossed a page\n", host_flash_page_cross);
+}
+
+/* Cut the power at random points of a rewrite loop; every remount must
+ * find the file with its old or its new content */
+static void powerLoss(int runs)
+{
+    struct lfs_config cfg = portConfig(PORT_CACHE_SIZE, PORT_LOOKAHEAD_SIZE, PORT_BLOCK_CYCLES);
+    uint8_t buf[300], back[300];
+    lfs_t lfs;
+    int run, value = 0, kept = 0;
+
+    host_flash_blank();
+    HOST_CHECK(lfs_format(&lfs, &cfg) == 0 && lfs_mount(&lfs, &cfg) == 0);
+    memset(buf, value, sizeof(buf));
+    HOST_CHECK(writeFile(&lfs, "state.nvm", buf, sizeof(buf)) == 0);
+    HOST_CHECK(lfs_unmount(&lfs) == 0);
+
+    for (run = 0; run < runs; run++)
+    {
+        host_flash_cut = 1 + rand() % 40;
+        if (lfs_mount(&lfs, &cfg) == 0)
+        {
+            while (!host_flash_off)
+            {
+                memset(buf, (value + 1) & 0xFF, sizeof(buf));
+                if (writeFile(&lfs, "state.nvm", buf, sizeof(buf)) == 0 && !host_flash_off)
+                    value = (value + 1) & 0xFF;
+            }
+        }
+
+        host_flash_cut = -1;
+        host_flash_off = 0;
+        HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+        HOST_CHECK(readFile(&lfs, "state.nvm", back, sizeof(back)) == (int)sizeof(back));
+        memset(buf, (value + 1) & 0xFF, sizeof(buf));
+        if (memcmp(back, buf, sizeof(buf)) == 0)
+        {
+            value = (value + 1) & 0xFF;
+            kept++;
+        }
+        memset(buf, value, sizeof(buf));
+        HOST_CHECK(memcmp(back, buf, sizeof(buf)) == 0);
+        HOST_CHECK(lfs_unmount(&lfs) == 0);
+    }
+    printf("lfs: %d power cuts during rewrites, every remount found the old (%d) or new (%d) file\n",
+           runs, runs - kept, kept);
+}
+
+int main(int argc, char **argv)
+{
+    static const lfs_size_t caches[] = { 256, 512, 1024 };
+    static const lfs_size_t lookaheads[] = { 16, 32 };
+    static const int32_t cycles[] = { 100, 200, 500 };
+    unsigned i, j, k;
+
+    srand(1);
+    powerLoss(500);
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        suite(PORT_CACHE_SIZE, PORT_LOOKAHEAD_SIZE, PORT_BLOCK_CYCLES);
+        for (i = 0; i < sizeof(caches) / sizeof(caches[0]); i++)
+            for (j = 0; j < sizeof(lookaheads) / sizeof(lookaheads[0]); j++)
+                for (k = 0; k < sizeof(cycles) / sizeof(cycles[0]); k++)
+                    suite(caches[i], lookaheads[j], cycles[k]);
+    }
+    return 0;
+}
@@ -0,0 +1,345 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_lfs_stats.c over the emulated flash, with the BSP_QSPI_*_Safe() and
+ * lfs_file_*() calls wrapped at link time as on target, under the littlefs
+ * stand-in of stubs/host_lfs.c: flash operations outside the FS area
+ * passed on uncounted; a file write charged its data block erase and its
+ * program bytes, its close the metadata commit, counted as a compaction;
+ * erase and sync latencies from the DWT stand-in in the right histogram
+ * buckets; reads counted per file; the file table filling up into the
+ * shared entry; reset; and the three unilog dumps matching the getters.
+ * "bench" times a wrapped flash read against the plain one.
+ *
+ * The source is included to reach the histogram.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "host_flash.h"
+#include "mw_lfs_stats.c"
+
+/* LFS port settings */
+#define PORT_BLOCK_SIZE     MW_LFS_STATS_BLOCK_SIZE
+#define PORT_CACHE_SIZE     256
+#define PORT_LOOKAHEAD_SIZE 16
+
+#define ERASE_US            3000
+
+static uint8_t readBuf[PORT_CACHE_SIZE], progBuf[PORT_CACHE_SIZE];
+static uint8_t lookaheadBuf[PORT_LOOKAHEAD_SIZE] __attribute__((aligned(4)));
+static struct lfs_config cfg;
+static lfs_t lfs;
+
+/* The dumps */
+static int dumps;
+static char dumpId[64][32];
+static uint32_t dumpLen[64];
+static uint8_t dumpData[64][sizeof(MwLfsStats)];
+
+void host_log_dump(const char *id, uint32_t len, const uint8_t *data)
+{
+    HOST_CHECK(dumps < 64 && len <= sizeof(dumpData[0]));
+    snprintf(dumpId[dumps], sizeof(dumpId[0]), "%s", id);
+    dumpLen[dumps] = len;
+    memcpy(dumpData[dumps], data, len);
+    dumps++;
+}
+
+static uint32_t addrOf(lfs_block_t block, lfs_off_t off)
+{
+    return FLASH_FS_REGION_OFFSET + block * PORT_BLOCK_SIZE + off;
+}
+
+static int bdRead(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size)
+{
+    (void)c;
+    return BSP_QSPI_Read_Safe(buffer, addrOf(block, off), size) == QSPI_OK ? 0 : LFS_ERR_IO;
+}
+
+static int bdProg(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size)
+{
+    (void)c;
+    return BSP_QSPI_Write_Safe((uint8_t *)buffer, addrOf(block, off), size) == QSPI_OK ? 0 : LFS_ERR_IO;
+}
+
+static int bdErase(const struct lfs_config *c, lfs_block_t block)
+{
+    (void)c;
+    return BSP_QSPI_Erase_Safe(addrOf(block, 0), PORT_BLOCK_SIZE) == QSPI_OK ? 0 : LFS_ERR_IO;
+}
+
+static int bdSync(const struct lfs_config *c)
+{
+    (void)c;
+    return 0;
+}
+
+static void portConfig(void)
+{
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.read = bdRead;
+    cfg.prog = bdProg;
+    cfg.erase = bdErase;
+    cfg.sync = bdSync;
+    cfg.read_size = PORT_CACHE_SIZE;
+    cfg.prog_size = PORT_CACHE_SIZE;
+    cfg.block_size = PORT_BLOCK_SIZE;
+    cfg.block_count = MW_LFS_STATS_BLOCKS;
+    cfg.cache_size = PORT_CACHE_SIZE;
+    cfg.lookahead_size = PORT_LOOKAHEAD_SIZE;
+    cfg.block_cycles = 200;
+    cfg.read_buffer = readBuf;
+    cfg.prog_buffer = progBuf;
+    cfg.lookahead_buffer = lookaheadBuf;
+}
+
+static MwLfsStats stats(void)
+{
+    MwLfsStats s;
+
+    mwLfsStatsGet(&s);
+    return s;
+}
+
+static MwLfsFileStats fileStats(UINT32 index)
+{
+    MwLfsFileStats f;
+
+    HOST_CHECK(mwLfsStatsGetFile(index, &f) == MW_LFS_STATS_OK);
+    return f;
+}
+
+static UINT32 histSum(const MwLfsOpStats *op, UINT32 from)
+{
+    UINT32 sum = 0;
+
+    for (; from < MW_LFS_STATS_HIST_BUCKETS; from++)
+        sum += op->hist[from];
+    return sum;
+}
+
+static void testHistogram(void)
+{
+    static const UINT32 us[] = { 0, 1, 2, 3, 4, 1023, 1024, 1u << 19, 1u << 25 };
+    static const UINT32 bucket[] = { 0, 0, 1, 1, 2, 9, 10, 19, 19 };
+    MwLfsOpStats op;
+    UINT32 i;
+
+    memset(&op, 0, sizeof(op));
+    for (i = 0; i < sizeof(us) / sizeof(us[0]); i++)
+    {
+        mwLfsStatsCount(&op, us[i], 10);
+        HOST_CHECK(op.hist[bucket[i]] >= 1);
+    }
+    HOST_CHECK(op.count == 9 && op.bytes == 90 && op.maxUs == 1u << 25);
+    HOST_CHECK(op.hist[0] == 2 && op.hist[1] == 2 && op.hist[19] == 2 && histSum(&op, 0) == 9);
+    printf("histogram: log2 buckets of us, the last one open\n");
+}
+
+static void testOutsideFs(void)
+{
+    MwLfsStats s0, s1;
+    uint8_t buf[16] = { 0x12, 0x34 }, got[16];
+
+    host_flash_blank();
+    s0 = stats();
+    HOST_CHECK(BSP_QSPI_Erase_Safe(0x1000, HOST_FLASH_SECTOR) == QSPI_OK);
+    HOST_CHECK(BSP_QSPI_Write_Safe(buf, 0x1000, sizeof(buf)) == QSPI_OK);
+    HOST_CHECK(BSP_QSPI_Read_Safe(got, 0x1000, sizeof(got)) == QSPI_OK);
+    HOST_CHECK(memcmp(got, buf, sizeof(buf)) == 0);
+    HOST_CHECK(BSP_QSPI_Read_Safe(got, FLASH_FS_REGION_END, sizeof(got)) == QSPI_OK);
+    HOST_CHECK(host_flash_erases == 1 && host_flash_programs == 1 && host_flash_reads == 2);
+    s1 = stats();
+    HOST_CHECK(memcmp(&s0, &s1, sizeof(s0)) == 0);
+    printf("outside the FS area: passed on, not counted\n");
+}
+
+/* One file written, closed, read back */
+static void testFile(void)
+{
+    uint8_t buf[100], got[64];
+    MwLfsFileStats f;
+    MwLfsStats s;
+    lfs_file_t file;
+    UINT32 i;
+
+    portConfig();
+    HOST_CHECK(lfs_format(&lfs, &cfg) == 0);
+    HOST_CHECK(lfs_mount(&lfs, &cfg) == 0);
+    s = stats();
+    HOST_CHECK(s.op[MW_LFS_STATS_OP_ERASE].count == 2 && s.compactions == 2);
+    HOST_CHECK(s.blockErases[0] == 1 && s.blockErases[1] == 1);
+    mwLfsStatsReset();
+    s = stats();
+    for (i = 0; i < MW_LFS_STATS_OP_NUM; i++)
+        HOST_CHECK(s.op[i].count == 0 && s.op[i].bytes == 0 && s.op[i].maxUs == 0 && histSum(&s.op[i], 0) == 0);
+    HOST_CHECK(s.compactions == 0 && s.blockErases[0] == 0);
+
+    /* The data block erase is the write's, the commit the close's */
+    host_flash_erase_us = ERASE_US;
+    memset(buf, 0x5A, sizeof(buf));
+    HOST_CHECK(lfs_file_open(&lfs, &file, "cfg.bin", LFS_O_WRONLY | LFS_O_CREAT) == 0);
+    HOST_CHECK(lfs_file_write(&lfs, &file, buf, sizeof(buf)) == sizeof(buf));
+    f = fileStats(0);
+    HOST_CHECK(strcmp(f.name, "cfg.bin") == 0 && f.opens == 1);
+    HOST_CHECK(f.bytesWritten == 100 && f.flashProgBytes == 100 && f.flashErases == 1 && f.compactions == 0);
+    HOST_CHECK(stats().blockErases[2] == 1 && stats().compactions == 0);
+    HOST_CHECK(lfs_file_close(&lfs, &file) == 0);
+    host_flash_erase_us = 0;
+
+    s = stats();
+    f = fileStats(0);
+    HOST_CHECK(f.flashErases == 2 && f.compactions == 1 && s.compactions == 1);
+    HOST_CHECK(f.flashReadBytes == 2 * PORT_CACHE_SIZE && f.flashProgBytes == 100 + PORT_CACHE_SIZE);
+    HOST_CHECK(s.blockErases[0] == 1 && s.blockErases[1] == 0);
+    HOST_CHECK(s.op[MW_LFS_STATS_OP_ERASE].count == 2 && s.op[MW_LFS_STATS_OP_ERASE].bytes == 2 * PORT_BLOCK_SIZE);
+    HOST_CHECK(s.op[MW_LFS_STATS_OP_PROG].count == 2 && s.op[MW_LFS_STATS_OP_PROG].bytes == 100 + PORT_CACHE_SIZE);
+    HOST_CHECK(s.op[MW_LFS_STATS_OP_READ].count == 2);
+
+    /* Latencies: the erases, and the close that waited for one */
+    HOST_CHECK(s.op[MW_LFS_STATS_OP_ERASE].maxUs >= ERASE_US);
+    HOST_CHECK(s.op[MW_LFS_STATS_OP_ERASE].totalUs >= 2 * ERASE_US);
+    HOST_CHECK(histSum(&s.op[MW_LFS_STATS_OP_ERASE], 11) == 2);     //2^11 <= 3000
+    HOST_CHECK(s.op[MW_LFS_STATS_OP_SYNC].count == 1 && f.syncs == 1);
+    HOST_CHECK(f.syncMaxUs >= ERASE_US && s.op[MW_LFS_STATS_OP_SYNC].maxUs == f.syncMaxUs);
+    HOST_CHECK(histSum(&s.op[MW_LFS_STATS_OP_READ], 0) == 2 && s.op[MW_LFS_STATS_OP_READ].maxUs < ERASE_US);
+
+    /* Read back: asked bytes and flash bytes */
+    HOST_CHECK(lfs_file_open(&lfs, &file, "cfg.bin", LFS_O_RDONLY) == 0);
+    HOST_CHECK(lfs_file_read(&lfs, &file, got, sizeof(got)) == sizeof(got));
+    HOST_CHECK(lfs_file_read(&lfs, &file, got, sizeof(got)) == 100 - sizeof(got));
+    HOST_CHECK(memcmp(got, buf, 100 - sizeof(got)) == 0);
+    HOST_CHECK(lfs_file_sync(&lfs, &file) == 0);
+    HOST_CHECK(lfs_file_close(&lfs, &file) == 0);
+    f = fileStats(0);
+    HOST_CHECK(f.opens == 2 && f.bytesRead == 100 && f.flashReadBytes == 2 * PORT_CACHE_SIZE + 100);
+    HOST_CHECK(f.syncs == 3 && f.compactions == 1 && stats().op[MW_LFS_STATS_OP_SYNC].count == 3);
+    HOST_CHECK(mwLfsStatsGetFile(1, &f) == MW_LFS_STATS_END);
+    HOST_CHECK(mwLfsStatsGetFile(0, PNULL) == MW_LFS_STATS_ERR_PARAM);
+    printf("file: data erase charged to the write, commit to the close, %u us erase, %u us close\n",
+           (unsigned)stats().op[MW_LFS_STATS_OP_ERASE].maxUs, (unsigned)fileStats(0).syncMaxUs);
+}
+
+/* More names than entries: the rest share the last one */
+static void testFileTable(void)
+{
+    lfs_file_t file[MW_LFS_STATS_MAX_OPEN + 1];
+    char name[16];
+    MwLfsFileStats f;
+    UINT32 i, n = MW_LFS_STATS_MAX_FILES + 4;
+
+    for (i = 0; i < n; i++)
+    {
+        sprintf(name, "f%02u", (unsigned)i);
+        HOST_CHECK(lfs_file_open(&lfs, &file[0], name, LFS_O_WRONLY | LFS_O_CREAT) == 0);
+        HOST_CHECK(lfs_file_write(&lfs, &file[0], name, 3) == 3);
+        HOST_CHECK(lfs_file_close(&lfs, &file[0]) == 0);
+    }
+    HOST_CHECK(mwLfsStatsGetFile(MW_LFS_STATS_MAX_FILES, &f) == MW_LFS_STATS_END);
+    f = fileStats(1);
+    HOST_CHECK(strcmp(f.name, "f00") == 0 && f.opens == 1 && f.bytesWritten == 3 && f.compactions == 1);
+    f = fileStats(MW_LFS_STATS_SHARED);
+    HOST_CHECK(strcmp(f.name, "*") == 0);
+    HOST_CHECK(f.opens == n - (MW_LFS_STATS_SHARED - 1) && f.bytesWritten == 3 * f.opens);
+
+    /* Names are kept, so a known file finds its entry with the table full */
+    HOST_CHECK(lfs_file_open(&lfs, &file[0], "f00", LFS_O_RDONLY) == 0);
+    HOST_CHECK(lfs_file_close(&lfs, &file[0]) == 0);
+    HOST_CHECK(fileStats(1).opens == 2);
+
+    /* Up to MW_LFS_STATS_MAX_OPEN files open at once are told apart */
+    for (i = 0; i < MW_LFS_STATS_MAX_OPEN; i++)
+    {
+        sprintf(name, "f%02u", (unsigned)i);
+        HOST_CHECK(lfs_file_open(&lfs, &file[i], name, LFS_O_RDONLY) == 0);
+    }
+    for (i = 0; i < MW_LFS_STATS_MAX_OPEN; i++)
+        HOST_CHECK(lfs_file_read(&lfs, &file[MW_LFS_STATS_MAX_OPEN - 1 - i], name, 2) == 2);
+    for (i = 0; i < MW_LFS_STATS_MAX_OPEN; i++)
+    {
+        HOST_CHECK(lfs_file_close(&lfs, &file[i]) == 0);
+        HOST_CHECK(fileStats(1 + i).bytesRead == 2);
+    }
+    for (i = 0; i < MW_LFS_STATS_MAX_OPEN; i++)
+        HOST_CHECK(mwLfsStats.open[i].file == PNULL);
+
+    /* Reset keeps the names */
+    mwLfsStatsReset();
+    f = fileStats(1);
+    HOST_CHECK(strcmp(f.name, "f00") == 0 && f.opens == 0 && f.bytesWritten == 0 && f.flashErases == 0);
+    HOST_CHECK(stats().op[MW_LFS_STATS_OP_PROG].count == 0);
+    printf("file table: %u entries, %u opens shared by the last one\n",
+           (unsigned)MW_LFS_STATS_MAX_FILES, (unsigned)(n - (MW_LFS_STATS_SHARED - 1)));
+}
+
+static void testDump(void)
+{
+    lfs_file_t file;
+    MwLfsFileStats f;
+    MwLfsStats s;
+    int i;
+
+    HOST_CHECK(lfs_file_open(&lfs, &file, "f01", LFS_O_WRONLY | LFS_O_TRUNC) == 0);
+    HOST_CHECK(lfs_file_write(&lfs, &file, "dump", 4) == 4);
+    HOST_CHECK(lfs_file_close(&lfs, &file) == 0);
+
+    dumps = 0;
+    mwLfsStatsDumpToUnilog();
+    s = stats();
+    HOST_CHECK(dumps == 2 + MW_LFS_STATS_MAX_FILES);
+    HOST_CHECK(strcmp(dumpId[0], "mwLfsStatsDump_1") == 0 && dumpLen[0] == offsetof(MwLfsStats, blockErases));
+    HOST_CHECK(memcmp(dumpData[0], &s, dumpLen[0]) == 0);
+    HOST_CHECK(strcmp(dumpId[1], "mwLfsStatsDump_2") == 0 && dumpLen[1] == sizeof(s.blockErases));
+    HOST_CHECK(memcmp(dumpData[1], s.blockErases, dumpLen[1]) == 0);
+    for (i = 0; i < MW_LFS_STATS_MAX_FILES; i++)
+    {
+        f = fileStats(i);
+        HOST_CHECK(strcmp(dumpId[2 + i], "mwLfsStatsDump_3") == 0 && dumpLen[2 + i] == sizeof(f));
+        HOST_CHECK(memcmp(dumpData[2 + i], &f, sizeof(f)) == 0);
+    }
+    HOST_CHECK(fileStats(2).bytesWritten == 4 && fileStats(2).compactions == 1);
+    printf("dump: %d records, as mwLfsStatsGet() and mwLfsStatsGetFile()\n", dumps);
+}
+
+static void bench(void)
+{
+    uint8_t buf[PORT_CACHE_SIZE];
+    double start, plainNs, wrappedNs;
+    int i, n = 1000000;
+
+    start = host_now();
+    for (i = 0; i < n; i++)
+        __real_BSP_QSPI_Read_Safe(buf, FLASH_FS_REGION_OFFSET, sizeof(buf));
+    plainNs = (host_now() - start) * 1e9 / n;
+    start = host_now();
+    for (i = 0; i < n; i++)
+        BSP_QSPI_Read_Safe(buf, FLASH_FS_REGION_OFFSET, sizeof(buf));
+    wrappedNs = (host_now() - start) * 1e9 / n;
+    printf("  %u byte flash read %.0f ns, %.0f ns counted\n", (unsigned)sizeof(buf), plainNs, wrappedNs);
+}
+
+int main(int argc, char **argv)
+{
+    testHistogram();
+    testOutsideFs();
+    testFile();
+    testFileTable();
+    testDump();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
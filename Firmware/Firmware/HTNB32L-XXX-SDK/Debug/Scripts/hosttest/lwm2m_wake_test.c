@@ -0,0 +1,541 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * lwm2m_wake.c on the host: a client with a plain and a DTLS server is
+ * saved before hibernate and loaded into a fresh context after it. The
+ * registrations, message IDs and observations must come back, the
+ * observations only on the first change or pmax report, and only the
+ * secure server or one near the end of its lifetime gets an Update.
+ * Expired, reconfigured and damaged state, a clock that did not run and a
+ * full file system must all end in a normal registration. A few hundred
+ * hibernate cycles check that no registration is ever used within the
+ * lifetime guard and count the Register / Update / plain wake-ups.
+ *
+ * The LwM2M core is prebuilt, so the few calls lwm2m_wake.c makes into it
+ * (prv_getWatcher(), lwm2m_update_registration_for_server() and the CoAP
+ * message ID) are played here.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "host_stubs.h"
+#include "host_fs.h"
+#include "internals.h"
+#include "app_coap.h"
+#include "object_security.h"
+#include "lwm2m_wake.h"
+
+#define HOST_SERVERS        3
+#define HOST_LIFETIME       3600
+#define HOST_CYCLES         500
+
+client_data_t data;
+
+typedef struct
+{
+    uint16_t            mid;
+} HostCoap;
+
+typedef struct
+{
+    lwm2m_context_t     ctx;
+    lwm2m_server_t      servers[HOST_SERVERS];
+    HostCoap            coap[HOST_SERVERS];
+    char                location[HOST_SERVERS][16];
+} HostClient;
+
+static lwm2m_object_t securityObj;
+static security_instance_t security[HOST_SERVERS];
+static time_t hostNow;
+static int updates[HOST_SERVERS];
+
+uint16_t coap_get_message_id(void *coap_Handle)
+{
+    return ((HostCoap *)coap_Handle)->mid;
+}
+
+int lwm2m_update_registration_for_server(lwm2m_context_t *contextP, lwm2m_server_t *targetP, bool withObjects)
+{
+    HOST_CHECK(!withObjects);
+    updates[targetP->secObjInstID]++;
+    targetP->registration = hostNow;
+    return 0;
+}
+
+static bool sameUri(const lwm2m_uri_t *a, const lwm2m_uri_t *b)
+{
+    return a->flag == b->flag && a->objectId == b->objectId && a->instanceId == b->instanceId &&
+           a->resourceId == b->resourceId;
+}
+
+/* As observe.c: the watcher of serverP on uriP, created if need be */
+lwm2m_watcher_t *prv_getWatcher(lwm2m_context_t *contextP, lwm2m_uri_t *uriP, lwm2m_server_t *serverP)
+{
+    lwm2m_observed_t *observedP;
+    lwm2m_watcher_t *watcherP;
+
+    for (observedP = contextP->observedList; observedP != NULL; observedP = observedP->next)
+    {
+        if (sameUri(&observedP->uri, uriP))
+            break;
+    }
+    if (observedP == NULL)
+    {
+        observedP = calloc(1, sizeof(lwm2m_observed_t));
+        HOST_CHECK(observedP != NULL);
+        observedP->uri = *uriP;
+        observedP->next = contextP->observedList;
+        contextP->observedList = observedP;
+    }
+
+    for (watcherP = observedP->watcherList; watcherP != NULL; watcherP = watcherP->next)
+    {
+        if (watcherP->server == serverP)
+            return watcherP;
+    }
+    watcherP = calloc(1, sizeof(lwm2m_watcher_t));
+    HOST_CHECK(watcherP != NULL);
+    watcherP->server = serverP;
+    watcherP->next = observedP->watcherList;
+    observedP->watcherList = watcherP;
+    return watcherP;
+}
+
+static lwm2m_uri_t resUri(uint16_t obj, uint16_t inst, uint16_t res)
+{
+    lwm2m_uri_t uri;
+
+    memset(&uri, 0, sizeof(uri));
+    uri.flag = LWM2M_URI_FLAG_OBJECT_ID | LWM2M_URI_FLAG_INSTANCE_ID | LWM2M_URI_FLAG_RESOURCE_ID;
+    uri.objectId = obj;
+    uri.instanceId = inst;
+    uri.resourceId = res;
+    return uri;
+}
+
+/* Server i is short ID 101 + i on security instance i; instance 1 is PSK */
+static void clientInit(HostClient *c, int servers)
+{
+    int i;
+
+    memset(c, 0, sizeof(HostClient));
+    memset(&securityObj, 0, sizeof(securityObj));
+    memset(security, 0, sizeof(security));
+    memset(updates, 0, sizeof(updates));
+    data.securityObjP = &securityObj;
+
+    for (i = HOST_SERVERS - 1; i >= 0; i--)
+    {
+        security[i].instanceId = (uint16_t)i;
+        security[i].securityMode = (i == 1) ? LWM2M_SECURITY_MODE_PRE_SHARED_KEY : LWM2M_SECURITY_MODE_NONE;
+        security[i].next = (i + 1 < HOST_SERVERS) ? &security[i + 1] : NULL;
+    }
+    securityObj.instanceList = (lwm2m_list_t *)&security[0];
+
+    for (i = servers - 1; i >= 0; i--)
+    {
+        lwm2m_server_t *s = &c->servers[i];
+
+        s->shortID = (uint16_t)(101 + i);
+        s->secObjInstID = (uint16_t)i;
+        s->lifetime = HOST_LIFETIME;
+        s->binding = BINDING_U;
+        s->status = STATE_DEREGISTERED;
+        s->coapHandle = &c->coap[i];
+        s->defaultMaxPeriod = 600;
+        s->next = c->ctx.serverList;
+        c->ctx.serverList = s;
+    }
+    c->ctx.state = STATE_INITIAL;
+}
+
+/* What a Register leaves behind */
+static void registered(HostClient *c, int i, time_t when)
+{
+    lwm2m_server_t *s = &c->servers[i];
+
+    snprintf(c->location[i], sizeof(c->location[i]), "/rd/%d%ld", i, (long)when);
+    if (s->location != NULL)
+        lwm2m_free(s->location);
+    s->location = lwm2m_strdup(c->location[i]);
+    s->registration = when;
+    s->status = STATE_REGISTERED;
+}
+
+static lwm2m_watcher_t *observe(HostClient *c, int i, uint16_t inst, time_t lastTime, uint32_t pmax)
+{
+    lwm2m_uri_t uri = resUri(3303, inst, 5700);
+    lwm2m_watcher_t *w = prv_getWatcher(&c->ctx, &uri, &c->servers[i]);
+
+    w->active = true;
+    w->tokenLen = 4;
+    memcpy(w->token, "\xA0\xB1\xC2", 3);
+    w->token[3] = (uint8_t)(16 * i + inst);
+    w->lastTime = lastTime;
+    w->counter = 40u + inst;
+    w->lastMid = (uint16_t)(1000 + inst);
+    w->lastValue.asInteger = 2150 + inst;
+    w->format = LWM2M_CONTENT_TLV;
+    if (pmax != 0)
+    {
+        w->parameters = calloc(1, sizeof(lwm2m_attributes_t));
+        HOST_CHECK(w->parameters != NULL);
+        w->parameters->toSet = LWM2M_ATTR_FLAG_MAX_PERIOD;
+        w->parameters->maxPeriod = pmax;
+    }
+    return w;
+}
+
+static int watchers(HostClient *c)
+{
+    lwm2m_observed_t *o;
+    lwm2m_watcher_t *w;
+    int n = 0;
+
+    for (o = c->ctx.observedList; o != NULL; o = o->next)
+    {
+        for (w = o->watcherList; w != NULL; w = w->next)
+            n++;
+    }
+    return n;
+}
+
+static void clientFree(HostClient *c)
+{
+    int i;
+
+    while (c->ctx.observedList != NULL)
+    {
+        lwm2m_observed_t *o = c->ctx.observedList;
+
+        while (o->watcherList != NULL)
+        {
+            lwm2m_watcher_t *w = o->watcherList;
+
+            o->watcherList = w->next;
+            free(w->parameters);
+            free(w);
+        }
+        c->ctx.observedList = o->next;
+        free(o);
+    }
+    for (i = 0; i < HOST_SERVERS; i++)
+        lwm2m_free(c->servers[i].location);
+}
+
+static void testResume(void)
+{
+    static HostClient before;
+    static HostClient after;
+    const lwm2m_wake_hdr_t *hdr;
+    lwm2m_watcher_t *w;
+    lwm2m_uri_t uri;
+    uint16_t mid;
+    time_t timeout;
+    size_t len;
+
+    host_fs_clear();
+    clientInit(&before, 3);
+    registered(&before, 0, 1000);
+    registered(&before, 1, 1200);
+    before.coap[0].mid = 0x1234;
+    before.coap[1].mid = 0xFFFF;
+    observe(&before, 0, 0, 1900, 300);
+    observe(&before, 0, 1, 1950, 0);
+    observe(&before, 1, 0, 1800, 0);
+    /* server 2 never registered: neither it nor its watcher is kept */
+    observe(&before, 2, 2, 1800, 60);
+
+    HOST_CHECK(lwm2m_wake_save(&before.ctx, 2000) == 2);
+    hdr = (const lwm2m_wake_hdr_t *)host_fs_data(LWM2M_WAKE_STATE_PERSISTENCE_FILE, &len);
+    HOST_CHECK(hdr != NULL);
+    HOST_CHECK(len == sizeof(lwm2m_wake_hdr_t) + 2 * sizeof(lwm2m_wake_server_t) +
+                      3 * sizeof(lwm2m_persistent_watcher_t));
+    HOST_CHECK(hdr->magic == LWM2M_WAKE_MAGIC && hdr->server_count == 2 && hdr->obs_count == 3);
+    /* pmax 300 after 1900 comes before the default 600 after 1800 */
+    HOST_CHECK(hdr->saved == 2000 && hdr->obs_due == 2200);
+    HOST_CHECK(!lwm2m_wake_resumed());
+
+    /* hibernate: RAM is gone, the server list comes from the objects */
+    clientInit(&after, 3);
+    HOST_CHECK(lwm2m_wake_load(&after.ctx, 2100) == 2);
+    HOST_CHECK(lwm2m_wake_resumed());
+    HOST_CHECK(after.servers[0].status == STATE_REGISTERED && after.servers[1].status == STATE_REGISTERED);
+    HOST_CHECK(after.servers[2].status == STATE_DEREGISTERED);
+    HOST_CHECK(strcmp(after.servers[0].location, before.location[0]) == 0);
+    HOST_CHECK(strcmp(after.servers[1].location, before.location[1]) == 0);
+    HOST_CHECK(after.servers[0].registration == 1000 && after.servers[1].registration == 1200);
+    /* server 2 still has to register, so the client is not ready yet */
+    HOST_CHECK(after.ctx.state == STATE_INITIAL);
+
+    HOST_CHECK(lwm2m_wake_next_mid(&after.servers[0], &mid) && mid == 0x1234);
+    HOST_CHECK(lwm2m_wake_next_mid(&after.servers[1], &mid) && mid == 0xFFFF);
+    HOST_CHECK(!lwm2m_wake_next_mid(&after.servers[2], &mid));
+
+    /* the plain server reports straight away, the secure one rebinds its
+     * new DTLS session with an Update first */
+    HOST_CHECK(lwm2m_wake_action(&after.servers[0], 2100) == LWM2M_WAKE_NONE);
+    HOST_CHECK(lwm2m_wake_action(&after.servers[1], 2100) == LWM2M_WAKE_UPDATE);
+    HOST_CHECK(lwm2m_wake_action(&after.servers[2], 2100) == LWM2M_WAKE_REGISTER);
+    HOST_CHECK(lwm2m_wake_action(NULL, 2100) == LWM2M_WAKE_REGISTER);
+
+    /* the observations wait for the first pmax report, the Update is sent
+     * once */
+    hostNow = 2100;
+    timeout = 3600;
+    lwm2m_wake_step(&after.ctx, 2100, &timeout);
+    HOST_CHECK(timeout == 100 && watchers(&after) == 0);
+    HOST_CHECK(updates[0] == 0 && updates[1] == 1 && after.servers[1].registration == 2100);
+    lwm2m_wake_step(&after.ctx, 2150, &timeout);
+    HOST_CHECK(updates[1] == 1 && watchers(&after) == 0);
+
+    /* or for the first change, whichever comes first */
+    lwm2m_wake_value_changed(&after.ctx);
+    HOST_CHECK(watchers(&after) == 3);
+    HOST_CHECK(host_fs_data(LWM2M_WAKE_STATE_PERSISTENCE_FILE, &len) == NULL);
+    HOST_CHECK(lwm2m_wake_restore_observations(&after.ctx) == 0);
+
+    uri = resUri(3303, 0, 5700);
+    w = prv_getWatcher(&after.ctx, &uri, &after.servers[0]);
+    HOST_CHECK(w->active && w->tokenLen == 4 && memcmp(w->token, "\xA0\xB1\xC2\x00", 4) == 0);
+    HOST_CHECK(w->lastTime == 1900 && w->counter == 40 && w->lastMid == 1000 && w->lastValue.asInteger == 2150);
+    HOST_CHECK(w->format == LWM2M_CONTENT_TLV);
+    HOST_CHECK(w->parameters != NULL && w->parameters->maxPeriod == 300);
+    uri = resUri(3303, 1, 5700);
+    w = prv_getWatcher(&after.ctx, &uri, &after.servers[0]);
+    HOST_CHECK(w->parameters == NULL && w->counter == 41 && w->token[3] == 1);
+    uri = resUri(3303, 0, 5700);
+    w = prv_getWatcher(&after.ctx, &uri, &after.servers[1]);
+    HOST_CHECK(w->token[3] == 16 && w->lastTime == 1800);
+    HOST_CHECK(watchers(&after) == 3);
+
+    clientFree(&before);
+    clientFree(&after);
+    printf("resume: 2 registrations, 3 observations, %u byte file, Update for the DTLS server only\n",
+           (unsigned)(sizeof(lwm2m_wake_hdr_t) + 2 * sizeof(lwm2m_wake_server_t) +
+                      3 * sizeof(lwm2m_persistent_watcher_t)));
+}
+
+static void testObsDue(void)
+{
+    static HostClient c;
+    time_t timeout = 3600;
+
+    host_fs_clear();
+    clientInit(&c, 1);
+    registered(&c, 0, 1000);
+    observe(&c, 0, 0, 1000, 300);
+    HOST_CHECK(lwm2m_wake_save(&c.ctx, 1200) == 1);
+    clientFree(&c);
+
+    clientInit(&c, 1);
+    HOST_CHECK(lwm2m_wake_load(&c.ctx, 1250) == 1 && c.ctx.state == STATE_READY);
+    lwm2m_wake_step(&c.ctx, 1250, &timeout);
+    HOST_CHECK(timeout == 50 && watchers(&c) == 0);
+    lwm2m_wake_step(&c.ctx, 1300, &timeout);
+    HOST_CHECK(watchers(&c) == 1 && updates[0] == 0);
+    clientFree(&c);
+
+    /* without a pmax report pending they come back on the first step */
+    clientInit(&c, 1);
+    registered(&c, 0, 1000);
+    observe(&c, 0, 0, 1000, 0)->active = false;
+    HOST_CHECK(lwm2m_wake_save(&c.ctx, 1200) == 1);
+    clientFree(&c);
+    clientInit(&c, 1);
+    HOST_CHECK(lwm2m_wake_load(&c.ctx, 1250) == 1);
+    timeout = 3600;
+    lwm2m_wake_step(&c.ctx, 1250, &timeout);
+    HOST_CHECK(timeout == 3600 && watchers(&c) == 1);
+    clientFree(&c);
+
+    printf("obs_due: observations back at the first pmax report, or at once without one\n");
+}
+
+/* Saves a client with servers 0 and 1 registered at 1000, for the checks
+ * that follow */
+static void saveTwo(HostClient *c, time_t now)
+{
+    host_fs_clear();
+    clientInit(c, 2);
+    registered(c, 0, 1000);
+    registered(c, 1, 1000);
+    HOST_CHECK(lwm2m_wake_save(&c->ctx, now) == 2);
+    clientFree(c);
+}
+
+static void testRejects(void)
+{
+    static HostClient c;
+    lwm2m_wake_hdr_t hdr;
+    uint8_t file[HOST_FS_FILE_SIZE];
+    uint8_t bad[HOST_FS_FILE_SIZE];
+    const uint8_t *p;
+    size_t len;
+    int k;
+
+    /* the clock did not run through hibernate */
+    saveTwo(&c, 2000);
+    clientInit(&c, 2);
+    HOST_CHECK(lwm2m_wake_load(&c.ctx, 1999) == 0 && !lwm2m_wake_resumed());
+    HOST_CHECK(host_fs_count() == 0 && c.servers[0].status == STATE_DEREGISTERED);
+    HOST_CHECK(lwm2m_wake_action(&c.servers[0], 2000) == LWM2M_WAKE_REGISTER);
+
+    /* registrations within the guard of their end are not resumed */
+    saveTwo(&c, 2000);
+    clientInit(&c, 2);
+    HOST_CHECK(lwm2m_wake_load(&c.ctx, 1000 + HOST_LIFETIME - LWM2M_WAKE_LIFETIME_GUARD) == 0);
+    HOST_CHECK(host_fs_count() == 0);
+    saveTwo(&c, 2000);
+    clientInit(&c, 2);
+    HOST_CHECK(lwm2m_wake_load(&c.ctx, 1000 + HOST_LIFETIME - LWM2M_WAKE_LIFETIME_GUARD - 1) == 2);
+
+    /* past the Update share of the lifetime the plain server updates too */
+    HOST_CHECK(lwm2m_wake_action(&c.servers[0], 1000 + HOST_LIFETIME * LWM2M_WAKE_UPDATE_PCT / 100 - 1) ==
+               LWM2M_WAKE_NONE);
+    HOST_CHECK(lwm2m_wake_action(&c.servers[0], 1000 + HOST_LIFETIME * LWM2M_WAKE_UPDATE_PCT / 100) ==
+               LWM2M_WAKE_UPDATE);
+    clientFree(&c);
+
+    /* a lifetime or binding changed while asleep needs a Register */
+    saveTwo(&c, 2000);
+    clientInit(&c, 2);
+    c.servers[0].lifetime = 2 * HOST_LIFETIME;
+    HOST_CHECK(lwm2m_wake_load(&c.ctx, 2100) == 1);
+    HOST_CHECK(c.servers[0].status == STATE_DEREGISTERED && c.servers[1].status == STATE_REGISTERED);
+    HOST_CHECK(c.ctx.state == STATE_INITIAL);
+    HOST_CHECK(lwm2m_wake_action(&c.servers[0], 2100) == LWM2M_WAKE_REGISTER);
+    HOST_CHECK(lwm2m_wake_action(&c.servers[1], 2100) == LWM2M_WAKE_UPDATE);
+    clientFree(&c);
+    saveTwo(&c, 2000);
+    clientInit(&c, 2);
+    c.servers[0].binding = BINDING_U | BINDING_Q;
+    c.servers[1].binding = BINDING_U | BINDING_Q;
+    HOST_CHECK(lwm2m_wake_load(&c.ctx, 2100) == 0 && host_fs_count() == 0);
+    clientFree(&c);
+
+    /* damaged files */
+    saveTwo(&c, 2000);
+    p = host_fs_data(LWM2M_WAKE_STATE_PERSISTENCE_FILE, &len);
+    memcpy(file, p, len);
+    for (k = 0; k < 6; k++)
+    {
+        size_t n = len;
+
+        memcpy(&hdr, file, sizeof(hdr));
+        switch (k)
+        {
+        case 0: hdr.magic ^= 0x100; break;
+        case 1: hdr.version++; break;
+        case 2: hdr.server_count = 0; break;
+        case 3: hdr.server_count = LWM2M_WAKE_MAX_SERVERS + 1; break;
+        case 4: hdr.obs_count = LWM2M_WAKE_MAX_OBSERVATIONS + 1; break;
+        case 5: n = sizeof(hdr) + sizeof(lwm2m_wake_server_t); break;
+        }
+        memcpy(bad, file, n);
+        memcpy(bad, &hdr, sizeof(hdr));
+        host_fs_put(LWM2M_WAKE_STATE_PERSISTENCE_FILE, bad, n);
+
+        clientInit(&c, 2);
+        HOST_CHECK(lwm2m_wake_load(&c.ctx, 2100) == 0);
+        HOST_CHECK(host_fs_count() == 0 && c.servers[0].location == NULL);
+    }
+
+    /* an unterminated location is cut, not read past */
+    memcpy(bad, file, len);
+    memset(bad + sizeof(hdr) + offsetof(lwm2m_wake_server_t, location), 'x', LWM2M_WAKE_LOCATION_LEN);
+    host_fs_put(LWM2M_WAKE_STATE_PERSISTENCE_FILE, bad, len);
+    clientInit(&c, 2);
+    HOST_CHECK(lwm2m_wake_load(&c.ctx, 2100) == 2);
+    HOST_CHECK(strlen(c.servers[0].location) == LWM2M_WAKE_LOCATION_LEN - 1);
+    clientFree(&c);
+
+    /* nothing registered removes an older file; a full file system or a
+     * location too long for the record saves nothing */
+    saveTwo(&c, 2000);
+    clientInit(&c, 2);
+    HOST_CHECK(lwm2m_wake_save(&c.ctx, 2000) == 0 && host_fs_count() == 0);
+    registered(&c, 0, 1000);
+    host_fs_space = sizeof(lwm2m_wake_hdr_t) + 10;
+    HOST_CHECK(lwm2m_wake_save(&c.ctx, 2000) == -1 && host_fs_count() == 0);
+    host_fs_space = -1;
+    lwm2m_free(c.servers[0].location);
+    c.servers[0].location = lwm2m_strdup("/rd/0123456789012345678901234567890123456789012345678901234567890123");
+    HOST_CHECK(lwm2m_wake_save(&c.ctx, 2000) == 0 && host_fs_count() == 0);
+    clientFree(&c);
+
+    printf("rejects: stale clock, lifetime guard, changed config, 6 damaged files, full file system\n");
+}
+
+/* One plain server, waking every 5 to 20 minutes to report. A wake-up
+ * registers when nothing usable was saved, updates when lwm2m_wake asks,
+ * and otherwise just reports. The registration must never be used within
+ * the guard of its end; a sleep across it costs a Register. */
+static void testCycles(void)
+{
+    static HostClient c;
+    unsigned actions[3] = { 0, 0, 0 };
+    uint16_t mid = 1;
+    time_t now = 1000;
+    int i;
+
+    srand(35);
+    host_fs_clear();
+    clientInit(&c, 1);
+    registered(&c, 0, now);
+    for (i = 0; i < HOST_CYCLES; i++)
+    {
+        lwm2m_wake_action_t action;
+        uint16_t next;
+
+        c.coap[0].mid = mid;
+        HOST_CHECK(lwm2m_wake_save(&c.ctx, now) == 1);
+        clientFree(&c);
+
+        now += 300 + rand() % 900;
+        hostNow = now;
+        clientInit(&c, 1);
+        if (lwm2m_wake_load(&c.ctx, now) == 1)
+        {
+            HOST_CHECK(c.servers[0].registration + HOST_LIFETIME > now + LWM2M_WAKE_LIFETIME_GUARD);
+            HOST_CHECK(lwm2m_wake_next_mid(&c.servers[0], &next) && next == mid);
+        }
+        action = lwm2m_wake_action(&c.servers[0], now);
+        actions[action]++;
+        if (action == LWM2M_WAKE_REGISTER)
+            registered(&c, 0, now);
+        else
+            lwm2m_wake_step(&c.ctx, now, NULL);
+        HOST_CHECK(updates[0] == (action == LWM2M_WAKE_UPDATE));
+        HOST_CHECK(c.servers[0].registration + HOST_LIFETIME > now + LWM2M_WAKE_LIFETIME_GUARD);
+        mid += 2;
+    }
+    clientFree(&c);
+    lwm2m_wake_discard();
+
+    HOST_CHECK(actions[LWM2M_WAKE_NONE] > actions[LWM2M_WAKE_UPDATE] + actions[LWM2M_WAKE_REGISTER]);
+    printf("cycles: %d wake-ups, %u plain, %u Update, %u Register\n", HOST_CYCLES,
+           actions[LWM2M_WAKE_NONE], actions[LWM2M_WAKE_UPDATE], actions[LWM2M_WAKE_REGISTER]);
+}
+
+int main(int argc, char **argv)
+{
+    testResume();
+    testObsDue();
+    testRejects();
+    testCycles();
+    return 0;
+}
@@ -0,0 +1,583 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * notify_sched.c on the host: the pmin / pmax windows, coalescing of
+ * changes within the hold time, alignment with a planned uplink, the
+ * piggyback of periodic reports, the wake-up timeout over two servers,
+ * and a day of random sensor changes in which every report must respect
+ * pmin and pmax and every change must go out by its hold deadline. The
+ * radio wake-ups of that day are printed next to one notification per
+ * change. notify_sched_send() is run against capturing CoAP calls and
+ * its SenML-CBOR payload is parsed back.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "host_stubs.h"
+#include "internals.h"
+#include "cbor.h"
+#include "notify_sched.h"
+
+#define SIM_SENSORS     8
+#define SIM_PMIN        10
+#define SIM_PMAX        600
+#define SIM_HOLD        30
+#define SIM_DAY         86400
+
+/* object_readData() stand-in: /3303/i/5700 reads as 100 * i + 5700,
+ * instance 9 fails */
+static int readCalls;
+
+uint8_t object_readData(lwm2m_context_t *contextP, lwm2m_uri_t *uriP, int *sizeP, lwm2m_data_t **dataP,
+                        lwm2m_server_t *serverP)
+{
+    readCalls++;
+    if (uriP->instanceId == 9)
+        return LWM2M_404_NOT_FOUND;
+
+    *dataP = lwm2m_data_new(1);
+    if (*dataP == NULL)
+        return LWM2M_500_INTERNAL_SERVER_ERROR;
+    *sizeP = 1;
+    (*dataP)->id = uriP->resourceId;
+    lwm2m_data_encode_int(100 * uriP->instanceId + uriP->resourceId, *dataP);
+    return LWM2M_205_CONTENT;
+}
+
+/* The CoAP calls of notify_sched_send(), captured */
+static qapi_Coap_Packet_t sentPacket;
+static int sentCount;
+static int sentType;
+static int sentCode;
+static char sentPath[16];
+static int sentFormat;
+static uint8_t sentPayload[512];
+static size_t sentLength;
+static qapi_Coap_Transaction_Callback_t sentCb;
+
+qapi_Status_t qapi_Coap_Init_Message(qapi_Coap_Session_Hdl_t sessionHandle, qapi_Coap_Packet_t **message,
+                                     qapi_Coap_Message_Type_t coap_msg_type, uint8_t msg_code)
+{
+    memset(&sentPacket, 0, sizeof(sentPacket));
+    sentType = coap_msg_type;
+    sentCode = msg_code;
+    *message = &sentPacket;
+    return QAPI_OK;
+}
+
+qapi_Status_t qapi_Coap_Set_Header(qapi_Coap_Session_Hdl_t session, qapi_Coap_Packet_t *message,
+                                   qapi_Coap_Header_type header_type, const void *header_val, size_t val_len)
+{
+    HOST_CHECK(message == &sentPacket);
+    if (header_type == QAPI_COAP_URI_PATH)
+    {
+        HOST_CHECK(val_len < sizeof(sentPath));
+        memcpy(sentPath, header_val, val_len);
+        sentPath[val_len] = 0;
+    }
+    else if (header_type == QAPI_COAP_CONTENT_TYPE)
+    {
+        sentFormat = *(const qapi_Coap_Content_Type_t *)header_val;
+    }
+    return QAPI_OK;
+}
+
+qapi_Status_t qapi_Coap_Set_Payload(qapi_Coap_Session_Hdl_t session, qapi_Coap_Packet_t *packet,
+                                    const void *payload, size_t length)
+{
+    HOST_CHECK(packet == &sentPacket && length <= sizeof(sentPayload));
+    memcpy(sentPayload, payload, length);
+    sentLength = length;
+    return QAPI_OK;
+}
+
+qapi_Status_t qapi_Coap_Send_Message(qapi_Coap_Session_Hdl_t sessionHandle, qapi_Coap_Packet_t *message,
+                                     qapi_Coap_Message_Params_t *msg_conf)
+{
+    HOST_CHECK(message == &sentPacket);
+    sentCb = msg_conf->msg_cb;
+    sentCount++;
+    return QAPI_OK;
+}
+
+static lwm2m_uri_t resUri(uint16_t obj, uint16_t inst, uint16_t res)
+{
+    lwm2m_uri_t uri;
+
+    memset(&uri, 0, sizeof(uri));
+    uri.flag = LWM2M_URI_FLAG_OBJECT_ID | LWM2M_URI_FLAG_INSTANCE_ID | LWM2M_URI_FLAG_RESOURCE_ID;
+    uri.objectId = obj;
+    uri.instanceId = inst;
+    uri.resourceId = res;
+    return uri;
+}
+
+static int collect(notify_sched_t *s, lwm2m_server_t *server, time_t now, notify_sched_entry_t **batch)
+{
+    return notify_sched_collect(s, server, now, batch, NOTIFY_SCHED_MAX_ENTRIES);
+}
+
+static bool inBatch(notify_sched_entry_t **batch, int n, const lwm2m_uri_t *uri)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        if (batch[i]->uri.objectId == uri->objectId && batch[i]->uri.instanceId == uri->instanceId &&
+            batch[i]->uri.resourceId == uri->resourceId)
+            return true;
+    }
+    return false;
+}
+
+static void testWindows(void)
+{
+    static notify_sched_t s;
+    lwm2m_server_t server;
+    notify_sched_entry_t *batch[NOTIFY_SCHED_MAX_ENTRIES];
+    lwm2m_uri_t uri[5];
+    int i;
+
+    memset(&server, 0, sizeof(server));
+    notify_sched_init(&s, 30, 50);
+    for (i = 0; i < 5; i++)
+    {
+        uri[i] = resUri(3303, i, 5700);
+        HOST_CHECK(notify_sched_track(&s, &server, NULL, &uri[i], 10, 300, 1000) == 0);
+    }
+
+    /* nothing changed: due at pmax, and nothing before */
+    HOST_CHECK(notify_sched_due(&s, &server, 1000) == 1300);
+    HOST_CHECK(collect(&s, &server, 1299, batch) == 0);
+    HOST_CHECK(collect(&s, &server, 1300, batch) == 5);
+    HOST_CHECK(s.batches == 1 && s.reports == 5);
+
+    /* a change right after a report waits for pmin, then the hold */
+    notify_sched_changed(&s, &uri[0]);
+    HOST_CHECK(notify_sched_due(&s, &server, 1301) == 1300 + 10 + 30);
+    HOST_CHECK(collect(&s, &server, 1305, batch) == 0);
+
+    /* the other four change within the hold and join the same batch,
+     * unchanged entries past half of pmax would too */
+    for (i = 1; i < 5; i++)
+        notify_sched_changed(&s, &uri[i]);
+    HOST_CHECK(notify_sched_due(&s, &server, 1320) == 1340);
+    HOST_CHECK(collect(&s, &server, 1340, batch) == 5);
+    HOST_CHECK(s.batches == 2 && s.reports == 10);
+    for (i = 0; i < 5; i++)
+        HOST_CHECK(inBatch(batch, 5, &uri[i]));
+
+    /* a change past pmin is due right after the hold, never past pmax */
+    notify_sched_changed(&s, &uri[2]);
+    HOST_CHECK(notify_sched_due(&s, &server, 1345) == 1380);
+    HOST_CHECK(notify_sched_due(&s, &server, 1500) == 1500);
+    HOST_CHECK(collect(&s, &server, 1500, batch) == 5);
+
+    /* piggyback: unchanged entries ride along once half of pmax passed,
+     * 40 s into it they do not, 200 s into it they do */
+    notify_sched_changed(&s, &uri[0]);
+    HOST_CHECK(collect(&s, &server, 1540, batch) == 1 && inBatch(batch, 1, &uri[0]));
+    notify_sched_changed(&s, &uri[0]);
+    HOST_CHECK(notify_sched_due(&s, &server, 1550) == 1580);
+    HOST_CHECK(collect(&s, &server, 1580, batch) == 1);
+    HOST_CHECK(notify_sched_due(&s, &server, 1600) == 1800);
+    notify_sched_changed(&s, &uri[1]);
+    HOST_CHECK(collect(&s, &server, 1700, batch) == 4 && !inBatch(batch, 4, &uri[0]));
+
+    /* pmax below pmin is raised to pmin, pmax 0 has no periodic report */
+    notify_sched_init(&s, 30, 50);
+    HOST_CHECK(notify_sched_track(&s, &server, NULL, &uri[0], 60, 20, 0) == 0);
+    HOST_CHECK(s.entries[0].pmax == 60);
+    HOST_CHECK(notify_sched_due(&s, &server, 0) == 60);
+    HOST_CHECK(notify_sched_track(&s, &server, NULL, &uri[0], 5, 0, 0) == 0);
+    HOST_CHECK(notify_sched_due(&s, &server, 0) == 0);
+    notify_sched_changed(&s, &uri[0]);
+    HOST_CHECK(notify_sched_due(&s, &server, 0) == 35);
+    HOST_CHECK(notify_sched_due(&s, &server, 100) == 100);
+
+    printf("windows: pmin, pmax, hold and piggyback as specified\n");
+}
+
+static void testUplink(void)
+{
+    static notify_sched_t s;
+    lwm2m_server_t server;
+    notify_sched_entry_t *batch[NOTIFY_SCHED_MAX_ENTRIES];
+    lwm2m_uri_t a = resUri(3303, 0, 5700);
+    lwm2m_uri_t b = resUri(3303, 1, 5700);
+
+    memset(&server, 0, sizeof(server));
+    notify_sched_init(&s, 30, 50);
+    HOST_CHECK(notify_sched_track(&s, &server, NULL, &a, 10, 600, 0) == 0);
+    HOST_CHECK(notify_sched_track(&s, &server, NULL, &b, 60, 600, 0) == 0);
+
+    /* an uplink inside the hold takes the changed value along */
+    notify_sched_plan_uplink(&s, &server, 25);
+    notify_sched_changed(&s, &a);
+    HOST_CHECK(notify_sched_due(&s, &server, 12) == 25);
+    HOST_CHECK(collect(&s, &server, 25, batch) == 1 && batch[0]->uri.instanceId == 0);
+    HOST_CHECK(s.uplinks[0].uplink == 0);
+
+    /* an uplink before pmin cannot carry b and is ignored */
+    notify_sched_plan_uplink(&s, &server, 40);
+    notify_sched_changed(&s, &b);
+    HOST_CHECK(notify_sched_due(&s, &server, 30) == 90);
+    HOST_CHECK(collect(&s, &server, 40, batch) == 0);
+
+    /* an uplink in the past is ignored as well */
+    notify_sched_plan_uplink(&s, &server, 50);
+    HOST_CHECK(notify_sched_due(&s, &server, 60) == 90);
+    HOST_CHECK(collect(&s, &server, 90, batch) == 1 && batch[0]->uri.instanceId == 1);
+    HOST_CHECK(s.uplinks[0].uplink == 0);
+
+    printf("uplink: changes moved onto a planned uplink once their pmin passed\n");
+}
+
+static void testTable(void)
+{
+    static notify_sched_t s;
+    lwm2m_server_t one;
+    lwm2m_server_t two;
+    notify_sched_entry_t *batch[NOTIFY_SCHED_MAX_ENTRIES];
+    lwm2m_watcher_t *w1 = (lwm2m_watcher_t *)0x1000;
+    lwm2m_watcher_t *w2 = (lwm2m_watcher_t *)0x2000;
+    lwm2m_uri_t uri;
+    lwm2m_uri_t obj;
+    time_t timeout;
+    int i;
+    int n;
+
+    memset(&one, 0, sizeof(one));
+    memset(&two, 0, sizeof(two));
+    notify_sched_init(&s, 30, 50);
+
+    /* the same URI per server and watcher is one entry, updated in place */
+    uri = resUri(3303, 0, 5700);
+    HOST_CHECK(notify_sched_track(&s, &one, w1, &uri, 10, 100, 0) == 0);
+    HOST_CHECK(notify_sched_track(&s, &one, w1, &uri, 20, 300, 50) == 0);
+    HOST_CHECK(notify_sched_track(&s, &one, w2, &uri, 10, 100, 0) == 0);
+    HOST_CHECK(notify_sched_track(&s, &two, w1, &uri, 10, 400, 0) == 0);
+    HOST_CHECK(s.entries[0].pmin == 20 && s.entries[0].pmax == 300 && s.entries[0].last == 0);
+    HOST_CHECK(!s.entries[3].used);
+
+    /* step takes the earliest server */
+    timeout = 1000;
+    notify_sched_step(&s, 0, &timeout);
+    HOST_CHECK(timeout == 100);
+    notify_sched_step(&s, 0, &timeout);
+    HOST_CHECK(timeout == 100);
+    HOST_CHECK(collect(&s, &one, 100, batch) == 1 && batch[0]->watcher == w2);
+    timeout = 1000;
+    notify_sched_step(&s, 100, &timeout);
+    HOST_CHECK(timeout == 100);
+
+    /* a change of the whole instance reaches the resource observations,
+     * one of another instance does not */
+    memset(&obj, 0, sizeof(obj));
+    obj.flag = LWM2M_URI_FLAG_OBJECT_ID | LWM2M_URI_FLAG_INSTANCE_ID;
+    obj.objectId = 3303;
+    obj.instanceId = 1;
+    notify_sched_changed(&s, &obj);
+    for (i = 0; i < 3; i++)
+        HOST_CHECK(!s.entries[i].changed);
+    obj.instanceId = 0;
+    notify_sched_changed(&s, &obj);
+    for (i = 0; i < 3; i++)
+        HOST_CHECK(s.entries[i].changed);
+
+    /* an object observation sees a resource change */
+    notify_sched_init(&s, 30, 50);
+    obj.flag = LWM2M_URI_FLAG_OBJECT_ID;
+    HOST_CHECK(notify_sched_track(&s, &one, w1, &obj, 0, 0, 0) == 0);
+    uri = resUri(3303, 7, 5601);
+    notify_sched_changed(&s, &uri);
+    HOST_CHECK(s.entries[0].changed);
+    uri.objectId = 3304;
+    s.entries[0].changed = false;
+    notify_sched_changed(&s, &uri);
+    HOST_CHECK(!s.entries[0].changed);
+
+    /* a full table says so, untrack wildcards clear a watcher or a server */
+    notify_sched_init(&s, 30, 50);
+    for (i = 0; i < NOTIFY_SCHED_MAX_ENTRIES; i++)
+    {
+        uri = resUri(3303, (uint16_t)i, 5700);
+        HOST_CHECK(notify_sched_track(&s, (i & 1) ? &two : &one, (i & 2) ? w2 : w1, &uri, 0, 60, 0) == 0);
+    }
+    uri = resUri(3303, 99, 5700);
+    HOST_CHECK(notify_sched_track(&s, &one, w1, &uri, 0, 60, 0) == -1);
+    notify_sched_plan_uplink(&s, &one, 10);
+    notify_sched_plan_uplink(&s, &two, 10);
+
+    uri = resUri(3303, 0, 5700);
+    notify_sched_untrack(&s, &one, w1, &uri);
+    HOST_CHECK(!s.entries[0].used);
+    notify_sched_untrack(&s, &one, w2, NULL);
+    notify_sched_untrack(&s, &two, NULL, NULL);
+    for (n = 0, i = 0; i < NOTIFY_SCHED_MAX_ENTRIES; i++)
+        n += s.entries[i].used;
+    HOST_CHECK(n == NOTIFY_SCHED_MAX_ENTRIES / 4 - 1);
+    HOST_CHECK(s.uplinks[0].server == &one && s.uplinks[0].uplink == 10);
+    HOST_CHECK(s.uplinks[1].server == NULL);
+    HOST_CHECK(notify_sched_due(&s, &two, 0) == 0);
+    HOST_CHECK(notify_sched_track(&s, &one, w1, &uri, 0, 60, 0) == 0);
+
+    printf("table: %d entries, wildcards, overlap and two servers\n", NOTIFY_SCHED_MAX_ENTRIES);
+}
+
+/* A day of sensors that change at random. The clock runs in seconds and
+ * the scheduler is only collected when the timeout of notify_sched_step()
+ * runs out, so a timeout too long shows as a missed deadline. The
+ * reference reports each change on its own at max(change, last + pmin)
+ * and an unchanged value at last + pmax, as plain observe does. */
+static void testDay(void)
+{
+    static notify_sched_t s;
+    lwm2m_server_t server;
+    notify_sched_entry_t *batch[NOTIFY_SCHED_MAX_ENTRIES];
+    lwm2m_uri_t uri[SIM_SENSORS];
+    time_t last[SIM_SENSORS];
+    time_t changedAt[SIM_SENSORS];
+    time_t nextChange[SIM_SENSORS];
+    time_t refLast[SIM_SENSORS];
+    time_t refPending[SIM_SENSORS];
+    unsigned refWakes = 0;
+    unsigned changes = 0;
+    time_t wake = 0;
+    time_t now;
+    int i;
+
+    srand(30);
+    memset(&server, 0, sizeof(server));
+    notify_sched_init(&s, SIM_HOLD, NOTIFY_SCHED_DEFAULT_PIGGYBACK_PCT);
+    for (i = 0; i < SIM_SENSORS; i++)
+    {
+        uri[i] = resUri(3303, (uint16_t)i, 5700);
+        HOST_CHECK(notify_sched_track(&s, &server, NULL, &uri[i], SIM_PMIN, SIM_PMAX, 0) == 0);
+        last[i] = refLast[i] = 0;
+        changedAt[i] = refPending[i] = -1;
+        /* half of them change every 20 s or so, the others rarely */
+        nextChange[i] = 1 + rand() % ((i & 1) ? 3600 : 40);
+    }
+
+    for (now = 0; now < SIM_DAY; now++)
+    {
+        bool woke = false;
+        bool changed = false;
+        time_t timeout;
+
+        for (i = 0; i < SIM_SENSORS; i++)
+        {
+            if (nextChange[i] != now)
+                continue;
+            notify_sched_changed(&s, &uri[i]);
+            if (changedAt[i] < 0)
+                changedAt[i] = now;
+            if (refPending[i] < 0)
+                refPending[i] = now;
+            nextChange[i] = now + 1 + rand() % ((i & 1) ? 3600 : 40);
+            changed = true;
+            changes++;
+        }
+
+        for (i = 0; i < SIM_SENSORS; i++)
+        {
+            if ((refPending[i] >= 0 && now >= refLast[i] + SIM_PMIN && now >= refPending[i]) ||
+                now >= refLast[i] + SIM_PMAX)
+            {
+                refLast[i] = now;
+                refPending[i] = -1;
+                woke = true;
+            }
+        }
+        refWakes += woke;
+
+        /* a change interrupts the wait, as lwm2m_resource_value_changed()
+         * wakes the client task */
+        if (now == wake || changed)
+        {
+            int n = collect(&s, &server, now, batch);
+
+            for (i = 0; i < n; i++)
+            {
+                int k = batch[i]->uri.instanceId;
+                time_t deadline;
+
+                HOST_CHECK(now >= last[k] + SIM_PMIN);
+                HOST_CHECK(now <= last[k] + SIM_PMAX);
+                if (changedAt[k] >= 0)
+                {
+                    deadline = last[k] + SIM_PMIN + SIM_HOLD;
+                    if (deadline > last[k] + SIM_PMAX)
+                        deadline = last[k] + SIM_PMAX;
+                    if (deadline < changedAt[k])
+                        deadline = changedAt[k];
+                    HOST_CHECK(now <= deadline);
+                }
+                last[k] = now;
+                changedAt[k] = -1;
+            }
+
+            timeout = SIM_DAY;
+            notify_sched_step(&s, now, &timeout);
+            HOST_CHECK(timeout > 0);
+            wake = now + timeout;
+        }
+
+        /* nothing may become overdue while the client sleeps */
+        for (i = 0; i < SIM_SENSORS; i++)
+        {
+            HOST_CHECK(now < last[i] + SIM_PMAX);
+            HOST_CHECK(changedAt[i] < 0 || now < last[i] + SIM_PMIN + SIM_HOLD || now == changedAt[i]);
+        }
+    }
+
+    HOST_CHECK(s.batches * 3 < refWakes);
+    printf("day: %u changes of %d sensors, %u wake-ups batched vs %u one per change, %u reports\n",
+           changes, SIM_SENSORS, (unsigned)s.batches, refWakes, (unsigned)s.reports);
+}
+
+static int64_t leafValue(lwm2m_data_t *data, int size, uint16_t obj, uint16_t inst, uint16_t res)
+{
+    int i;
+    int j;
+    int k;
+
+    for (i = 0; i < size; i++)
+    {
+        if (data[i].id != obj)
+            continue;
+        for (j = 0; j < (int)data[i].value.asChildren.count; j++)
+        {
+            lwm2m_data_t *in = &data[i].value.asChildren.array[j];
+
+            if (in->id != inst)
+                continue;
+            for (k = 0; k < (int)in->value.asChildren.count; k++)
+            {
+                lwm2m_data_t *r = &in->value.asChildren.array[k];
+
+                if (r->id == res && r->type == LWM2M_TYPE_INTEGER)
+                    return r->value.asInteger;
+            }
+        }
+    }
+    return -1;
+}
+
+static void testSend(void)
+{
+    static notify_sched_t s;
+    lwm2m_context_t ctx;
+    lwm2m_server_t server;
+    notify_sched_entry_t *batch[NOTIFY_SCHED_MAX_ENTRIES];
+    lwm2m_watcher_t *w = (lwm2m_watcher_t *)0x1000;
+    lwm2m_uri_t uri;
+    lwm2m_uri_t root;
+    lwm2m_data_t *data;
+    int size;
+    int n;
+
+    memset(&ctx, 0, sizeof(ctx));
+    memset(&server, 0, sizeof(server));
+    server.coapHandle = (void *)0x4000;
+    server.version = 1.0f;
+    notify_sched_init(&s, 30, 50);
+
+    /* instances 1, 2 and 9 by Send, 3 by a watcher, 9 fails to read */
+    uri = resUri(3303, 1, 5700);
+    HOST_CHECK(notify_sched_track(&s, &server, NULL, &uri, 0, 60, 0) == 0);
+    uri = resUri(3303, 3, 5700);
+    HOST_CHECK(notify_sched_track(&s, &server, w, &uri, 0, 60, 0) == 0);
+    uri = resUri(3303, 9, 5700);
+    HOST_CHECK(notify_sched_track(&s, &server, NULL, &uri, 0, 60, 0) == 0);
+    uri = resUri(3304, 2, 5700);
+    HOST_CHECK(notify_sched_track(&s, &server, NULL, &uri, 0, 60, 0) == 0);
+    n = collect(&s, &server, 60, batch);
+    HOST_CHECK(n == 4);
+
+    /* LwM2M 1.0 has no Send, nor has a server without a session */
+    HOST_CHECK(notify_sched_send(&ctx, &server, batch, n) == -1);
+    server.version = 1.1f;
+    server.coapHandle = NULL;
+    HOST_CHECK(notify_sched_send(&ctx, &server, batch, n) == -1);
+    server.coapHandle = (void *)0x4000;
+    HOST_CHECK(sentCount == 0 && readCalls == 0);
+
+    /* the watcher entry alone sends nothing */
+    HOST_CHECK(notify_sched_send(&ctx, &server, &batch[1], 1) == 0);
+    HOST_CHECK(sentCount == 0);
+
+    HOST_CHECK(notify_sched_send(&ctx, &server, batch, n) == 2);
+    HOST_CHECK(readCalls == 3 && sentCount == 1);
+    HOST_CHECK(sentType == QAPI_COAP_TYPE_CON && sentCode == QAPI_COAP_POST);
+    HOST_CHECK(strcmp(sentPath, NOTIFY_SCHED_SEND_PATH) == 0);
+    HOST_CHECK(sentFormat == CBOR_CONTENT_SENML_CBOR && sentCb != NULL);
+
+    memset(&root, 0, sizeof(root));
+    size = senml_cbor_parse(&root, sentPayload, sentLength, &data);
+    HOST_CHECK(size == 2);
+    HOST_CHECK(leafValue(data, size, 3303, 1, 5700) == 100 + 5700);
+    HOST_CHECK(leafValue(data, size, 3304, 2, 5700) == 200 + 5700);
+    HOST_CHECK(leafValue(data, size, 3303, 3, 5700) == -1);
+    HOST_CHECK(leafValue(data, size, 3303, 9, 5700) == -1);
+    lwm2m_data_free(size, data);
+
+    sentCb(server.coapHandle, NULL, NULL);
+    printf("send: %u byte SenML-CBOR POST to /%s with 2 of 4 entries\n", (unsigned)sentLength, sentPath);
+}
+
+static void bench(void)
+{
+    static notify_sched_t s;
+    lwm2m_server_t server[NOTIFY_SCHED_MAX_SERVERS];
+    lwm2m_uri_t uri;
+    double t0;
+    time_t timeout;
+    int n = 200000;
+    int i;
+
+    memset(server, 0, sizeof(server));
+    notify_sched_init(&s, 30, 50);
+    for (i = 0; i < NOTIFY_SCHED_MAX_ENTRIES; i++)
+    {
+        uri = resUri(3303, (uint16_t)i, 5700);
+        notify_sched_track(&s, &server[i % NOTIFY_SCHED_MAX_SERVERS], NULL, &uri, 10, 600, 0);
+    }
+    notify_sched_changed(&s, &uri);
+
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+    {
+        timeout = 3600;
+        notify_sched_step(&s, i & 7, &timeout);
+    }
+    printf("step, %d entries on %d servers %8.0f ns\n", NOTIFY_SCHED_MAX_ENTRIES, NOTIFY_SCHED_MAX_SERVERS,
+           (host_now() - t0) / n * 1e9);
+    HOST_CHECK(timeout == 33);
+}
+
+int main(int argc, char **argv)
+{
+    testWindows();
+    testUplink();
+    testTable();
+    testDay();
+    testSend();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
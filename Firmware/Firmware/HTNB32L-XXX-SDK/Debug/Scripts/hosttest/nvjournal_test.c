@@ -0,0 +1,452 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_nvjournal.c on emulated NOR flash, against a model of the items:
+ * random writes, field writes, deletes and formats with reboots in
+ * between, across many compactions; a power cut at every flash operation
+ * of a write spanning pages of DATA, of a write whose COMMIT is torn, and
+ * of a compaction, after each of which the items must be those before the
+ * write, or, when only the last operation was hit, those after it; the
+ * bank with the newer valid header chosen at boot; a damaged record
+ * rejected by its CRC along with its write. "bench" reports what the
+ * field writes cost in flash.
+ *
+ * The source is included so that a reboot can be modelled by clearing its
+ * RAM state.
+ */
+
+#include "host_stubs.h"
+#include "host_flash.h"
+#include "mw_nvjournal.c"
+
+#define NIDS            8
+#define MAXSIZE         200
+
+typedef struct
+{
+    int     size;                       //0: no item
+    UINT8   data[MW_NVJ_IMAGE_SIZE];
+} Item;
+
+static Item model[MW_NVJ_MAX_ITEMS], prev[MW_NVJ_MAX_ITEMS];
+static UINT8 snapshot[MW_NVJ_REGION_SIZE];
+
+/* The journal holds what m says */
+static int same(const Item *m)
+{
+    UINT8 buf[MW_NVJ_IMAGE_SIZE];
+    int i;
+
+    for (i = 0; i < MW_NVJ_MAX_ITEMS; i++)
+    {
+        if (mwNvJournalSize((UINT8)i) != m[i].size)
+            return 0;
+        if (m[i].size == 0)
+        {
+            if (mwNvJournalRead((UINT8)i, 0, buf, 1) != MW_NVJ_ERR_NOT_FOUND)
+                return 0;
+        }
+        else if (mwNvJournalRead((UINT8)i, 0, buf, (UINT16)m[i].size) != MW_NVJ_OK ||
+                 memcmp(buf, m[i].data, m[i].size) != 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void reboot(void)
+{
+    host_flash_cut = -1;
+    host_flash_off = 0;
+    memset(&mwNvj, 0, sizeof(mwNvj));
+    HOST_CHECK(mwNvJournalInit() == MW_NVJ_OK);
+}
+
+static void save(void)
+{
+    memcpy(snapshot, &host_flash[MW_NVJ_REGION_OFFSET], sizeof(snapshot));
+    memcpy(prev, model, sizeof(model));
+}
+
+static void restore(void)
+{
+    memcpy(&host_flash[MW_NVJ_REGION_OFFSET], snapshot, sizeof(snapshot));
+    memcpy(model, prev, sizeof(model));
+    reboot();
+}
+
+static unsigned long flashOps(void)
+{
+    return host_flash_erases + host_flash_programs;
+}
+
+/* Whole item: new, or the old one with a few bytes changed and maybe resized */
+static void writeItem(int id, int size, int changes)
+{
+    UINT8 buf[MW_NVJ_IMAGE_SIZE];
+    int i;
+
+    memcpy(buf, model[id].data, sizeof(buf));
+    if (model[id].size == 0)
+        changes = size;
+    for (i = model[id].size; i < size; i++)
+        buf[i] = 0;
+    for (i = 0; i < changes; i++)
+        buf[rand() % size] = (UINT8)rand();
+    if (mwNvJournalWrite((UINT8)id, buf, (UINT16)size) == MW_NVJ_OK)
+    {
+        model[id].size = size;
+        memcpy(model[id].data, buf, size);
+    }
+    else
+    {
+        HOST_CHECK(host_flash_off);
+    }
+}
+
+static void randomOp(void)
+{
+    int id = rand() % NIDS, r = rand() % 100, off, len, i;
+    UINT8 buf[16];
+    INT32 rc;
+
+    if (r < 45)
+    {
+        writeItem(id, model[id].size && rand() % 4 ? model[id].size : 1 + rand() % MAXSIZE, 1 + rand() % 8);
+    }
+    else if (r < 90)
+    {
+        len = 1 + rand() % sizeof(buf);
+        off = model[id].size > len ? rand() % (model[id].size - len + 1) : 0;
+        for (i = 0; i < len; i++)
+            buf[i] = (UINT8)rand();
+        rc = mwNvJournalWriteField((UINT8)id, (UINT16)off, buf, (UINT16)len);
+        if (rc == MW_NVJ_OK)
+            memcpy(&model[id].data[off], buf, len);
+        else if (!host_flash_off)
+            HOST_CHECK(model[id].size == 0 ? rc == MW_NVJ_ERR_NOT_FOUND : rc == MW_NVJ_ERR_PARAM);
+    }
+    else if (r < 99)
+    {
+        rc = mwNvJournalDelete((UINT8)id);
+        if (rc == MW_NVJ_OK)
+            model[id].size = 0;
+        else if (!host_flash_off)
+            HOST_CHECK(rc == MW_NVJ_ERR_NOT_FOUND && model[id].size == 0);
+    }
+    else if (mwNvJournalFormat() == MW_NVJ_OK)
+    {
+        memset(model, 0, sizeof(model));
+    }
+}
+
+static void testApi(void)
+{
+    UINT8 buf[64] = { 1, 2, 3 };
+    unsigned long programs;
+
+    HOST_CHECK(mwNvJournalWrite(MW_NVJ_MAX_ITEMS, buf, 1) == MW_NVJ_ERR_PARAM);
+    HOST_CHECK(mwNvJournalWrite(0, buf, 0) == MW_NVJ_ERR_PARAM);
+    HOST_CHECK(mwNvJournalWrite(0, buf, MW_NVJ_IMAGE_SIZE + 1) == MW_NVJ_ERR_PARAM);
+    HOST_CHECK(mwNvJournalRead(0, 0, buf, 1) == MW_NVJ_ERR_NOT_FOUND);
+    HOST_CHECK(mwNvJournalWriteField(0, 0, buf, 1) == MW_NVJ_ERR_NOT_FOUND);
+    HOST_CHECK(mwNvJournalDelete(0) == MW_NVJ_ERR_NOT_FOUND);
+
+    HOST_CHECK(mwNvJournalWrite(0, buf, sizeof(buf)) == MW_NVJ_OK);
+    HOST_CHECK(mwNvJournalRead(0, 60, buf, 8) == MW_NVJ_ERR_PARAM);
+    HOST_CHECK(mwNvJournalWriteField(0, 60, buf, 8) == MW_NVJ_ERR_PARAM);
+
+    /* Nothing changed: no flash; one field: one page program */
+    programs = host_flash_programs;
+    HOST_CHECK(mwNvJournalWrite(0, buf, sizeof(buf)) == MW_NVJ_OK);
+    HOST_CHECK(host_flash_programs == programs);
+    buf[10] = 0x55;
+    HOST_CHECK(mwNvJournalWriteField(0, 10, &buf[10], 1) == MW_NVJ_OK);
+    HOST_CHECK(host_flash_programs == programs + 1);
+    HOST_CHECK(mwNvJournalFormat() == MW_NVJ_OK);
+}
+
+static void testModel(void)
+{
+    MwNvJournalStats stats;
+    UINT32 seq0 = mwNvj.bankSeq, bank;
+    int k, switches = 0;
+
+    for (k = 0; k < 20000; k++)
+    {
+        bank = mwNvj.active;
+        randomOp();
+        switches += (mwNvj.active != bank);
+        HOST_CHECK(same(model));
+        if (k % 499 == 0)
+        {
+            reboot();
+            HOST_CHECK(same(model));
+        }
+    }
+    mwNvJournalGetStats(&stats);
+    HOST_CHECK(switches > 100 && stats.bankSeq - seq0 >= (UINT32)switches);
+    printf("nvjournal: 20000 random operations, %d bank switches and %d reboots, equal to the model\n",
+           switches, 20000 / 499 + 1);
+}
+
+/*
+ * Cut the power at each flash operation of op in turn, from the state
+ * saved before it, with rand() seeded the same each time: a cut before
+ * the last operation leaves the items, and the bank, as they were; one
+ * at the last operation either state. Returns the number of operations.
+ */
+static unsigned long cutSweep(void (*op)(void), unsigned seed, int *kept)
+{
+    Item after[MW_NVJ_MAX_ITEMS];
+    UINT32 seqBefore, seqAfter;
+    unsigned long k;
+    int i, changes, switched = 0;
+
+    save();
+    seqBefore = mwNvj.bankSeq;
+    srand(seed);
+    op();
+    seqAfter = mwNvj.bankSeq;
+    memcpy(after, model, sizeof(model));
+    changes = memcmp(after, prev, sizeof(model)) != 0;
+
+    *kept = 0;
+    for (k = 0; ; k++)
+    {
+        restore();
+        srand(seed);
+        host_flash_cut = (long)k;
+        op();
+        if (!host_flash_off)
+        {
+            /* Done before the cut: k operations */
+            HOST_CHECK(same(after));
+            break;
+        }
+        reboot();
+        if (mwNvj.bankSeq != seqBefore)
+        {
+            HOST_CHECK(mwNvj.bankSeq == seqAfter);
+            switched++;
+        }
+        if (changes && same(after))
+        {
+            memcpy(model, after, sizeof(model));
+            (*kept)++;
+        }
+        else
+        {
+            HOST_CHECK(same(prev));
+            memcpy(model, prev, sizeof(model));
+        }
+
+        /* The journal carries on from either */
+        for (i = 0; i < 20; i++)
+            randomOp();
+        reboot();
+        HOST_CHECK(same(model));
+    }
+
+    /* Only a cut in the last operation may have kept the new state */
+    HOST_CHECK(*kept <= 1 && switched <= 1);
+    if (!changes)
+        *kept = switched;
+    if (*kept)
+    {
+        restore();
+        srand(seed);
+        host_flash_cut = (long)k - 1;
+        op();
+        reboot();
+        HOST_CHECK(same(after));
+        memcpy(model, after, sizeof(model));
+    }
+    else
+    {
+        restore();
+        srand(seed);
+        op();
+    }
+    HOST_CHECK(same(after));
+    return k;
+}
+
+static void opLongWrite(void)
+{
+    writeItem(NIDS, 3 * MW_NVJ_PAGE_SIZE, 0);
+}
+
+static void opField(void)
+{
+    UINT8 b[4];
+
+    b[0] = (UINT8)~model[0].data[0];
+    b[1] = (UINT8)rand();
+    b[2] = (UINT8)rand();
+    b[3] = (UINT8)rand();
+    if (mwNvJournalWriteField(0, 0, b, sizeof(b)) == MW_NVJ_OK)
+        memcpy(model[0].data, b, sizeof(b));
+}
+
+static void opCompact(void)
+{
+    mwNvJournalCompact();
+}
+
+static void testPowerCuts(void)
+{
+    unsigned long ops;
+    UINT32 compactions;
+    unsigned seed;
+    int kept, run, commitKept = 0, onePage = 0, runs = 0;
+
+    /* DATA over three pages and more: only the COMMIT makes it count */
+    ops = cutSweep(opLongWrite, 7, &kept);
+    HOST_CHECK(ops >= 4);
+    printf("nvjournal: %d B write cut at each of its %lu programs, %d kept\n", 3 * MW_NVJ_PAGE_SIZE, ops, kept);
+
+    /* A field write is one page, unless it compacts: whether the torn
+     * program holds its COMMIT decides */
+    writeItem(0, 32, 32);
+    for (run = 0; run < 300; run++)
+    {
+        if (cutSweep(opField, run, &kept) == 1)
+        {
+            onePage++;
+            commitKept += kept;
+        }
+    }
+    HOST_CHECK(onePage > 250 && commitKept > 0 && commitKept < onePage);
+    printf("nvjournal: one-page field write cut %d times, %d kept a whole COMMIT\n", onePage, commitKept);
+
+    /* Compaction: the bank erase, the image, the header last */
+    ops = cutSweep(opCompact, 1, &kept);
+    HOST_CHECK(kept == 0);          //the same items either way
+    printf("nvjournal: compaction cut at each of its %lu operations\n", ops);
+
+    /* And the compactions started by writes that no longer fit */
+    while (runs < 20)
+    {
+        save();
+        compactions = mwNvj.stats.compactions;
+        seed = (unsigned)rand();
+        srand(seed);
+        randomOp();
+        if (mwNvj.stats.compactions == compactions || same(prev))
+            continue;
+        restore();
+        ops = cutSweep(randomOp, seed, &kept);
+        HOST_CHECK(ops >= 3);       //erase, image, header
+        runs++;
+    }
+    printf("nvjournal: 20 writes that compact, cut at each of their operations\n");
+}
+
+/* The newer valid header wins; a damaged one hands over to the other bank */
+static void testBanks(void)
+{
+    MwNvjBankHdr hdr;
+    UINT32 active, seq;
+
+    HOST_CHECK(mwNvJournalCompact() == MW_NVJ_OK);
+    active = mwNvj.active;
+    seq = mwNvj.bankSeq;
+    reboot();
+    HOST_CHECK(mwNvj.active == active && mwNvj.bankSeq == seq && same(model));
+
+    /* The bank left behind still holds the same items, as the compaction
+     * wrote them; only its older header kept it out */
+    host_flash[mwNvjAddr(active, offsetof(MwNvjBankHdr, bankSeq))] ^= 0x01;
+    reboot();
+    HOST_CHECK(mwNvj.active == (active ^ 1) && mwNvj.bankSeq == seq - 1 && same(model));
+
+    /* Both damaged: a fresh journal */
+    memcpy(&hdr, &host_flash[mwNvjAddr(active ^ 1, 0)], sizeof(hdr));
+    host_flash[mwNvjAddr(active ^ 1, 0)] = 0;
+    reboot();
+    memset(model, 0, sizeof(model));
+    HOST_CHECK(same(model) && mwNvj.bankSeq == 1);
+}
+
+/* A record failing its CRC drops its write, and only that write */
+static void testCrc(void)
+{
+    UINT8 b = 0x42;
+    UINT32 off, bank;
+
+    writeItem(1, 40, 40);
+    writeItem(2, 40, 40);
+    memcpy(prev, model, sizeof(model));
+
+    bank = mwNvj.active;
+    off = mwNvj.wrOff;
+    HOST_CHECK(mwNvJournalWriteField(1, 5, &b, 1) == MW_NVJ_OK);
+    HOST_CHECK(mwNvj.wrOff > off);
+
+    /* The DATA record is the first of the write: damage its payload */
+    host_flash[mwNvjAddr(bank, off + sizeof(MwNvjRecHdr))] ^= 0x10;
+    reboot();
+    HOST_CHECK(same(prev));
+    HOST_CHECK(mwNvj.stats.tornRecords == 1 && mwNvj.abortPending);
+
+    /* Written again, past the damaged page */
+    HOST_CHECK(mwNvJournalWriteField(1, 5, &b, 1) == MW_NVJ_OK);
+    model[1].data[5] = b;
+    reboot();
+    HOST_CHECK(same(model) && mwNvj.stats.tornRecords == 1);
+}
+
+static void bench(void)
+{
+    MwNvJournalStats stats;
+    UINT8 b[4];
+    int k;
+
+    HOST_CHECK(mwNvJournalFormat() == MW_NVJ_OK);
+    memset(model, 0, sizeof(model));
+    writeItem(0, 256, 256);
+    memset(&mwNvj.stats, 0, sizeof(mwNvj.stats));
+    host_flash_erases = host_flash_programs = 0;
+    for (k = 0; k < 10000; k++)
+    {
+        b[0] = (UINT8)k;
+        b[1] = (UINT8)(k >> 8);
+        b[2] = b[3] = 0;
+        HOST_CHECK(mwNvJournalWriteField(0, (UINT16)(4 * (k % 64)), b, 4) == MW_NVJ_OK);
+    }
+    mwNvJournalGetStats(&stats);
+    printf("bench: 10000 4-byte field writes to a 256 B item: %lu page programs, %lu sector erases, "
+           "%u compactions (whole-item NV writes: 10000 sector erases)\n",
+           host_flash_programs, host_flash_erases, stats.compactions);
+}
+
+int main(int argc, char **argv)
+{
+    srand(1);
+    host_flash_blank();
+    reboot();
+    testApi();
+    testModel();
+    testPowerCuts();
+    testBanks();
+    testCrc();
+    printf("nvjournal: newer header chosen, damaged one handed over, damaged record dropped with its write\n");
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
@@ -0,0 +1,252 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * obj_index.c on the host: random object and instance churn on top of the
+ * wakaama lists, every lookup, resource check and new instance ID compared
+ * with what the lists give, including instances the index was not told
+ * about. "bench" times the /o/i resolution of 20 objects of 50 instances
+ * against the list walk it replaces.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "internals.h"
+#include "obj_index.h"
+
+#define OBJECTS         20
+#define INSTANCES       50
+#define MAX_INST_ID     80
+
+static lwm2m_context_t context;
+static lwm2m_object_t objects[OBJECTS];
+static lwm2m_list_t nodes[OBJECTS][MAX_INST_ID];
+static bool present[OBJECTS][MAX_INST_ID];
+static const uint16_t resources[] = { 0, 1, 2, 5, 7, 11, 4000 };
+
+static uint16_t objectIdOf(int o)
+{
+    return (uint16_t)(o < 10 ? o : 3300 + o);     //core objects and IPSO ones
+}
+
+static void addInstance(obj_index_t *idx, int o, uint16_t id, bool tell)
+{
+    nodes[o][id].id = id;
+    nodes[o][id].next = NULL;
+    objects[o].instanceList = LWM2M_LIST_ADD(objects[o].instanceList, &nodes[o][id]);
+    present[o][id] = true;
+    if (tell)
+        HOST_CHECK(obj_index_add_instance(idx, objects[o].objID, &nodes[o][id]) == 0);
+}
+
+static void removeInstance(obj_index_t *idx, int o, uint16_t id)
+{
+    lwm2m_list_t *node;
+
+    objects[o].instanceList = LWM2M_LIST_RM(objects[o].instanceList, id, &node);
+    HOST_CHECK(node == &nodes[o][id]);
+    present[o][id] = false;
+    obj_index_remove_instance(idx, objects[o].objID, id);
+}
+
+static void setUp(obj_index_t *idx)
+{
+    int o, i;
+
+    memset(&context, 0, sizeof(context));
+    memset(objects, 0, sizeof(objects));
+    memset(present, 0, sizeof(present));
+    for (o = OBJECTS - 1; o >= 0; o--)
+    {
+        objects[o].objID = objectIdOf(o);
+        for (i = 0; i < INSTANCES; i++)
+            addInstance(idx, o, (uint16_t)i, false);
+        context.objectList = (lwm2m_object_t *)LWM2M_LIST_ADD(context.objectList, &objects[o]);
+    }
+    HOST_CHECK(obj_index_rebuild(idx, &context) == 0);
+}
+
+static void checkAll(obj_index_t *idx)
+{
+    lwm2m_object_t *objectP;
+    lwm2m_list_t *instanceP;
+    lwm2m_uri_t uri;
+    int o, i;
+
+    for (o = 0; o < OBJECTS; o++)
+    {
+        HOST_CHECK(obj_index_new_instance_id(idx, &objects[o]) == lwm2m_list_newId(objects[o].instanceList));
+        for (i = 0; i < MAX_INST_ID; i++)
+        {
+            memset(&uri, 0, sizeof(uri));
+            uri.flag = LWM2M_URI_FLAG_OBJECT_ID | LWM2M_URI_FLAG_INSTANCE_ID;
+            uri.objectId = objects[o].objID;
+            uri.instanceId = (uint16_t)i;
+            objectP = NULL;
+            instanceP = NULL;
+            if (present[o][i])
+            {
+                HOST_CHECK(obj_index_resolve(idx, &context, &uri, &objectP, &instanceP) == LWM2M_NO_ERROR);
+                HOST_CHECK(objectP == &objects[o] && instanceP == &nodes[o][i]);
+            }
+            else
+            {
+                HOST_CHECK(obj_index_resolve(idx, &context, &uri, &objectP, &instanceP) == LWM2M_404_NOT_FOUND);
+            }
+        }
+    }
+}
+
+static void testChurn(void)
+{
+    obj_index_t idx;
+    lwm2m_uri_t uri;
+    uint32_t misses;
+    int step, o;
+    uint16_t id;
+
+    memset(&idx, 0, sizeof(idx));
+    setUp(&idx);
+    checkAll(&idx);
+    HOST_CHECK(idx.misses == 0);
+
+    srand(31);
+    for (step = 0; step < 20000; step++)
+    {
+        o = rand() % OBJECTS;
+        id = (uint16_t)(rand() % MAX_INST_ID);
+        if (present[o][id])
+            removeInstance(&idx, o, id);
+        else
+        {
+            if (rand() % 3)
+                id = obj_index_new_instance_id(&idx, &objects[o]);
+            addInstance(&idx, o, id, true);
+        }
+        if (step % 1000 == 0)
+            checkAll(&idx);
+    }
+    checkAll(&idx);
+    HOST_CHECK(idx.misses == 0);
+
+    /* an instance added behind the back of the index is found through the
+     * list once and then comes from the index */
+    for (id = 0; id < MAX_INST_ID && present[3][id]; id++)
+        ;
+    HOST_CHECK(id < MAX_INST_ID);
+    addInstance(&idx, 3, id, false);
+    misses = idx.misses;
+    HOST_CHECK(obj_index_find_instance(&idx, &objects[3], id) == &nodes[3][id]);
+    HOST_CHECK(idx.misses == misses + 1);
+    HOST_CHECK(obj_index_find_instance(&idx, &objects[3], id) == &nodes[3][id]);
+    HOST_CHECK(idx.misses == misses + 1);
+    checkAll(&idx);
+
+    /* resource tables: unsorted ones are refused, objects without one
+     * accept any resource */
+    HOST_CHECK(obj_index_set_resources(&idx, objectIdOf(4), resources, sizeof(resources) / sizeof(resources[0])) == 0);
+    HOST_CHECK(obj_index_set_resources(&idx, objectIdOf(5), resources + 1, 0) == 0);
+    {
+        static const uint16_t unsorted[] = { 1, 3, 2 };
+        HOST_CHECK(obj_index_set_resources(&idx, objectIdOf(6), unsorted, 3) == -1);
+    }
+    HOST_CHECK(obj_index_has_resource(&idx, objectIdOf(4), 4000));
+    HOST_CHECK(obj_index_has_resource(&idx, objectIdOf(4), 7));
+    HOST_CHECK(!obj_index_has_resource(&idx, objectIdOf(4), 3));
+    HOST_CHECK(!obj_index_has_resource(&idx, objectIdOf(4), 4001));
+    HOST_CHECK(obj_index_has_resource(&idx, objectIdOf(7), 12345));
+
+    for (id = 0; !present[4][id]; id++)
+        ;
+    memset(&uri, 0, sizeof(uri));
+    uri.flag = LWM2M_URI_FLAG_OBJECT_ID | LWM2M_URI_FLAG_INSTANCE_ID | LWM2M_URI_FLAG_RESOURCE_ID;
+    uri.objectId = objectIdOf(4);
+    uri.instanceId = id;
+    uri.resourceId = 5;
+    HOST_CHECK(obj_index_resolve(&idx, &context, &uri, NULL, NULL) == LWM2M_NO_ERROR);
+    uri.resourceId = 6;
+    HOST_CHECK(obj_index_resolve(&idx, &context, &uri, NULL, NULL) == LWM2M_404_NOT_FOUND);
+    uri.objectId = 9999;
+    HOST_CHECK(obj_index_resolve(&idx, &context, &uri, NULL, NULL) == LWM2M_404_NOT_FOUND);
+
+    /* an object leaving the list leaves the index on rebuild, the resource
+     * table of one that stays is kept */
+    context.objectList = (lwm2m_object_t *)LWM2M_LIST_RM(context.objectList, objectIdOf(2), NULL);
+    HOST_CHECK(obj_index_rebuild(&idx, &context) == 0);
+    HOST_CHECK(obj_index_find_object(&idx, &context, objectIdOf(2)) == NULL);
+    HOST_CHECK(!obj_index_has_resource(&idx, objectIdOf(4), 3));
+    HOST_CHECK(idx.count == OBJECTS - 1);
+
+    obj_index_clear(&idx);
+    printf("churn: 20000 instance adds/removes over %d objects, lookups and new IDs equal to the lists\n", OBJECTS);
+}
+
+static void bench(void)
+{
+    static uint16_t keys[2][4096];
+    obj_index_t idx;
+    lwm2m_uri_t uri;
+    lwm2m_object_t *objectP;
+    lwm2m_list_t *instanceP = NULL;
+    uintptr_t sink = 0;
+    int n = 4000000, i, k;
+    double t0, tList, tIndex;
+
+    memset(&idx, 0, sizeof(idx));
+    setUp(&idx);
+    memset(&uri, 0, sizeof(uri));
+    uri.flag = LWM2M_URI_FLAG_OBJECT_ID | LWM2M_URI_FLAG_INSTANCE_ID;
+
+    srand(1);
+    for (k = 0; k < 4096; k++)
+    {
+        keys[0][k] = objectIdOf(rand() % OBJECTS);
+        keys[1][k] = (uint16_t)(rand() % INSTANCES);
+    }
+
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+    {
+        k = i & 4095;
+        objectP = (lwm2m_object_t *)LWM2M_LIST_FIND(context.objectList, keys[0][k]);
+        instanceP = LWM2M_LIST_FIND(objectP->instanceList, keys[1][k]);
+        sink += (uintptr_t)instanceP;
+    }
+    tList = (host_now() - t0) / n * 1e9;
+
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+    {
+        k = i & 4095;
+        uri.objectId = keys[0][k];
+        uri.instanceId = keys[1][k];
+        obj_index_resolve(&idx, &context, &uri, &objectP, &instanceP);
+        sink += (uintptr_t)instanceP;
+    }
+    tIndex = (host_now() - t0) / n * 1e9;
+
+    HOST_CHECK(sink != 0);
+    printf("resolve /o/i, %d objects x %d instances: lists %.1f ns, index %.1f ns\n",
+           OBJECTS, INSTANCES, tList, tIndex);
+    obj_index_clear(&idx);
+}
+
+int main(int argc, char **argv)
+{
+    testChurn();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
@@ -0,0 +1,516 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_pcap.c linked with -Wl,--wrap as on target, in front of the library
+ * calls in host_netif.c. The test calls TcpipPsInpkt(), netif_add(), the
+ * netif output functions and the fast path entries, so every packet goes
+ * through the wrappers into mwPcapRecord() or mwPcapRecordPbuf() and on to
+ * the library. What the ring should hold is modelled record by record:
+ * ROHC feedback and non-IP packets, pbuf chains, segmented uplink packets,
+ * a netif added again and one netif too many, the ring overwriting its
+ * oldest records or stopping when full, and recording stopped. Each ring
+ * is dumped to a file and over unilog, both dumps are converted with
+ * pcap_convert.py, and the two pcapng files must be identical and match
+ * the model: order, lengths, data, interface, flags, CID comment and time
+ * stamp. A dump with a lost unilog chunk converts up to the gap. "bench"
+ * times a captured downlink packet.
+ */
+
+#include <string.h>
+#include "host_stubs.h"
+#include "osasys.h"
+#include "tcpip.h"
+#include "host_netif.h"
+#include "mw_pcap.h"
+
+#define ALIGN4(n)           (((n) + 3) & ~3)
+#define UNILOG_CHUNK        128         //MW_PCAP_UNILOG_CHUNK of mw_pcap.c
+#define MAX_MODEL           1024
+#define DUMP_FILE           OUT_DIR "pcap.dump"
+#define UNILOG_FILE         OUT_DIR "pcap_unilog.txt"
+#define PCAPNG_FILE         OUT_DIR "pcap_file.pcapng"
+#define PCAPNG_UNILOG       OUT_DIR "pcap_unilog.pcapng"
+
+typedef struct
+{
+    UINT8   dir;
+    UINT8   path;
+    UINT8   cid;
+    UINT8   capLen;
+    UINT16  origLen;
+    UINT16  recLen;
+    UINT32  tickMs;
+    UINT8   data[255];
+}Expect;
+
+/* The records the ring should hold, oldest first */
+static Expect model[MAX_MODEL];
+static int modelHead, modelCount;
+static UINT32 modelUsed, modelOverwritten, modelStopped, modelRecorded;
+static UINT16 snapLen;
+static BOOL stopWhenFull;
+
+static FILE *unilogOut;
+static int unilogChunks, unilogDrop = -1;
+
+OSAFILE OsaFopen(const char *fileName, const char *mode)
+{
+    return fopen(fileName, mode);
+}
+
+INT32 OsaFclose(OSAFILE fp)
+{
+    return fclose(fp);
+}
+
+UINT32 OsaFread(void *buf, UINT32 size, UINT32 count, OSAFILE fp)
+{
+    return (UINT32)fread(buf, size, count, fp);
+}
+
+UINT32 OsaFwrite(void *buf, UINT32 size, UINT32 count, OSAFILE fp)
+{
+    return (UINT32)fwrite(buf, size, count, fp);
+}
+
+/* A log export line per chunk, as pcap_convert.py reads it */
+void host_log_dump(const char *id, uint32_t len, const uint8_t *data)
+{
+    uint32_t i;
+
+    HOST_CHECK(strcmp(id, "mwPcapDump_1") == 0 && len > 4 && len <= 4 + UNILOG_CHUNK);
+    if (unilogChunks++ == unilogDrop)
+        return;
+    fprintf(unilogOut, "%u P_INFO mwPcapDump:", host_ms);
+    for (i = 0; i < len; i++)
+        fprintf(unilogOut, " %02X", data[i]);
+    fprintf(unilogOut, "\n");
+}
+
+static void modelStart(UINT16 snap, BOOL stop)
+{
+    modelHead = modelCount = 0;
+    modelUsed = modelOverwritten = modelStopped = modelRecorded = 0;
+    snapLen = snap;
+    stopWhenFull = stop;
+    HOST_CHECK(mwPcapStart(snap, stop) == MW_PCAP_OK);
+}
+
+/* What mwPcapBegin() does with a packet that reaches it */
+static void expect(UINT8 dir, UINT8 path, UINT8 cid, const UINT8 *data, UINT32 origLen)
+{
+    Expect *e;
+    UINT8 capLen = (origLen < snapLen) ? (UINT8)origLen : (UINT8)snapLen;
+    UINT16 recLen = ALIGN4(sizeof(MwPcapRecHdr) + capLen);
+
+    while (MW_PCAP_RING_SIZE - modelUsed < recLen)
+    {
+        if (stopWhenFull)
+        {
+            modelStopped++;
+            return;
+        }
+        modelUsed -= model[modelHead % MAX_MODEL].recLen;
+        modelHead++;
+        modelCount--;
+        modelOverwritten++;
+    }
+    HOST_CHECK(modelCount < MAX_MODEL);
+    e = &model[(modelHead + modelCount++) % MAX_MODEL];
+    e->dir = dir;
+    e->path = path;
+    e->cid = cid;
+    e->capLen = capLen;
+    e->origLen = (UINT16)origLen;
+    e->recLen = recLen;
+    e->tickMs = host_ms;
+    memcpy(e->data, data, capLen);
+    modelUsed += recLen;
+    modelRecorded++;
+}
+
+static void ipPacket(UINT8 *buf, UINT32 len, UINT32 seq, BOOL v6)
+{
+    UINT32 i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = (UINT8)(seq * 7 + i);
+    buf[0] = v6 ? 0x60 : 0x45;
+}
+
+static UINT32 rd32(const UINT8 *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (UINT32)p[3] << 24;
+}
+
+static UINT8 *load(const char *path, long *len)
+{
+    FILE *f = fopen(path, "rb");
+    UINT8 *buf;
+
+    HOST_CHECK(f != NULL);
+    fseek(f, 0, SEEK_END);
+    *len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(*len + 1);
+    HOST_CHECK(fread(buf, 1, *len, f) == (size_t)*len);
+    fclose(f);
+    return buf;
+}
+
+/* Check the enhanced packet blocks of a pcapng file against the model; returns their number */
+static int checkPcapng(const char *path, UINT32 dumpTick, UINT32 dumpUtc, int maxPackets)
+{
+    UINT8 *buf, *opt, *end;
+    long len, off;
+    int n = 0, flags, comment;
+    UINT32 blockLen, capLen;
+    UINT64 ts;
+    char cid[16];
+    Expect *e;
+
+    buf = load(path, &len);
+    HOST_CHECK(len >= 12 && rd32(buf) == 0x0A0D0D0A);
+    for (off = 0; off < len; off += blockLen)
+    {
+        blockLen = rd32(buf + off + 4);
+        HOST_CHECK(blockLen >= 12 && off + blockLen <= len && rd32(buf + off + blockLen - 4) == blockLen);
+        if (rd32(buf + off) == 0x00000001)
+        {
+            /* Raw IP, ms time stamps */
+            HOST_CHECK((buf[off + 8] | buf[off + 9] << 8) == 101 && rd32(buf + off + 12) == snapLen);
+            continue;
+        }
+        if (rd32(buf + off) != 0x00000006)
+            continue;
+
+        HOST_CHECK(n < modelCount && n < maxPackets);
+        e = &model[(modelHead + n++) % MAX_MODEL];
+        ts = (UINT64)rd32(buf + off + 12) << 32 | rd32(buf + off + 16);
+        capLen = rd32(buf + off + 20);
+        HOST_CHECK(rd32(buf + off + 8) == e->path);
+        HOST_CHECK(ts == (UINT64)dumpUtc * 1000 - (dumpTick - e->tickMs));
+        HOST_CHECK(capLen == e->capLen && rd32(buf + off + 24) == e->origLen);
+        HOST_CHECK(memcmp(buf + off + 28, e->data, capLen) == 0);
+
+        flags = comment = 0;
+        end = buf + off + blockLen - 4;
+        for (opt = buf + off + 28 + ALIGN4(capLen); opt + 4 <= end && (opt[0] | opt[1] << 8) != 0;
+             opt += 4 + ALIGN4(opt[2] | opt[3] << 8))
+        {
+            if ((opt[0] | opt[1] << 8) == 2)
+                flags = (int)rd32(opt + 4);
+            if ((opt[0] | opt[1] << 8) == 1)
+            {
+                snprintf(cid, sizeof(cid), "cid %d", e->cid);
+                HOST_CHECK((opt[2] | opt[3] << 8) == strlen(cid) && memcmp(opt + 4, cid, strlen(cid)) == 0);
+                comment = 1;
+            }
+        }
+        HOST_CHECK(flags == (e->dir == MW_PCAP_DIR_IN ? 1 : 2));
+        HOST_CHECK(comment == (e->cid != 0xFF));
+    }
+    free(buf);
+    return n;
+}
+
+/* Dump both ways, convert both, and hold the result against the model */
+static void checkDump(void)
+{
+    UINT8 *a, *b;
+    long aLen, bLen;
+    MwPcapFileHdr hdr;
+    MwPcapStats stats;
+    FILE *f;
+    UINT32 dumpTick = host_ms;
+
+    mwPcapGetStats(&stats);
+    HOST_CHECK(stats.recorded == modelRecorded && stats.overwritten == modelOverwritten);
+    HOST_CHECK(stats.stopped == modelStopped && stats.used == modelUsed);
+
+    HOST_CHECK(mwPcapDumpToFile(DUMP_FILE) == MW_PCAP_OK);
+    f = fopen(DUMP_FILE, "rb");
+    HOST_CHECK(f != NULL && fread(&hdr, sizeof(hdr), 1, f) == 1);
+    fclose(f);
+    HOST_CHECK(hdr.magic == MW_PCAP_FILE_MAGIC && hdr.dataLen == modelUsed && hdr.dumpTickMs == dumpTick);
+
+    unilogOut = fopen(UNILOG_FILE, "w");
+    unilogChunks = 0;
+    HOST_CHECK(mwPcapDumpToUnilog() == MW_PCAP_OK);
+    fclose(unilogOut);
+    HOST_CHECK(unilogChunks == (int)((sizeof(hdr) + modelUsed + UNILOG_CHUNK - 1) / UNILOG_CHUNK));
+
+    HOST_CHECK(system(PCAP_CONVERT " " DUMP_FILE " " PCAPNG_FILE " > /dev/null") == 0);
+    HOST_CHECK(system(PCAP_CONVERT " " UNILOG_FILE " " PCAPNG_UNILOG " > /dev/null") == 0);
+    a = load(PCAPNG_FILE, &aLen);
+    b = load(PCAPNG_UNILOG, &bLen);
+    HOST_CHECK(aLen == bLen && memcmp(a, b, aLen) == 0);
+    free(a);
+    free(b);
+    HOST_CHECK(checkPcapng(PCAPNG_FILE, dumpTick, hdr.dumpUtcSecs, MAX_MODEL) == modelCount);
+}
+
+static int outCalls;
+
+static err_t origOutput(struct netif *netif, struct pbuf *p, const ip4_addr_t *ipaddr)
+{
+    (void)netif;
+    (void)p;
+    (void)ipaddr;
+    outCalls++;
+    return ERR_OK;
+}
+
+static err_t origOutputIp6(struct netif *netif, struct pbuf *p, const ip6_addr_t *ipaddr)
+{
+    (void)netif;
+    (void)p;
+    (void)ipaddr;
+    outCalls += 16;
+    return ERR_OK;
+}
+
+static err_t netifInit(struct netif *netif)
+{
+    netif->output = origOutput;
+    netif->output_ip6 = origOutputIp6;
+    return ERR_OK;
+}
+
+static err_t netifInitNoIp6(struct netif *netif)
+{
+    netif->output = origOutput;
+    netif->output_ip6 = PNULL;
+    return ERR_OK;
+}
+
+static err_t netifInitFail(struct netif *netif)
+{
+    (void)netif;
+    return ERR_IF;
+}
+
+static void testApi(void)
+{
+    MwPcapStats stats;
+
+    HOST_CHECK(mwPcapStart(0, FALSE) == MW_PCAP_ERR_PARAM);
+    HOST_CHECK(mwPcapStart(256, FALSE) == MW_PCAP_ERR_PARAM);
+    HOST_CHECK(mwPcapDumpToFile(DUMP_FILE) == MW_PCAP_ERR_STATE);
+    HOST_CHECK(mwPcapDumpToUnilog() == MW_PCAP_ERR_STATE);
+    mwPcapGetStats(PNULL);
+    mwPcapGetStats(&stats);
+    HOST_CHECK(stats.recorded == 0 && stats.used == 0);
+    modelStart(96, FALSE);
+    HOST_CHECK(mwPcapDumpToFile(PNULL) == MW_PCAP_ERR_PARAM);
+    HOST_CHECK(mwPcapDumpToFile(OUT_DIR "no/such/dir") == MW_PCAP_ERR_FILE);
+    checkDump();
+    printf("pcap: bad calls refused, an empty ring dumps and converts\n");
+}
+
+static void testHooks(void)
+{
+    static struct netif nif[MW_PCAP_MAX_NETIF + 2];
+    static UINT8 pkt[8][400];
+    struct pbuf p1, p2;
+    DlPduBlock dl[5];
+    UlPduBlock ul[4];
+    MwPcapStats stats;
+    int i;
+
+    modelStart(96, FALSE);
+
+    /* Downlink into lwIP: the ROHC feedback is not a packet, the non-IP one is skipped */
+    host_ms += 10;
+    ipPacket(pkt[0], 100, 1, FALSE);
+    ipPacket(pkt[1], 20, 2, FALSE);
+    ipPacket(pkt[2], 60, 3, FALSE);
+    pkt[2][0] = 0xF0;
+    ipPacket(pkt[3], 20, 4, TRUE);
+    memset(dl, 0, sizeof(dl));
+    dl[0].pPdu = pkt[0]; dl[0].length = 100; dl[0].pNext = &dl[1];
+    dl[1].pPdu = pkt[1]; dl[1].length = 20;  dl[1].pNext = &dl[2]; dl[1].bRohcFeedback = 1;
+    dl[2].pPdu = pkt[2]; dl[2].length = 60;  dl[2].pNext = &dl[3];
+    dl[3].pPdu = pkt[3]; dl[3].length = 20;
+    HOST_CHECK(TcpipPsInpkt(1, dl, PNULL) == ERR_OK);
+    expect(MW_PCAP_DIR_IN, MW_PCAP_PATH_LWIP, 1, pkt[0], 100);
+    expect(MW_PCAP_DIR_IN, MW_PCAP_PATH_LWIP, 1, pkt[3], 20);
+    HOST_CHECK(host_netif_calls.psInpkt == 1 && host_netif_calls.lastCid == 1 && host_netif_calls.lastDl == dl);
+    mwPcapGetStats(&stats);
+    HOST_CHECK(stats.skipped == 1);
+
+    /* Output: the original function still runs, the capture spans the pbuf chain */
+    nif[0].primary_ipv4_cid = 1;
+    nif[0].primary_ipv6_cid = 2;
+    HOST_CHECK(netif_add(&nif[0], PNULL, PNULL, PNULL, PNULL, netifInit, PNULL) == &nif[0]);
+    HOST_CHECK(nif[0].output != origOutput && nif[0].output_ip6 != origOutputIp6);
+    host_ms += 10;
+    ipPacket(pkt[4], 300, 5, FALSE);
+    p1.payload = pkt[4]; p1.len = 40; p1.tot_len = 300; p1.next = &p2;
+    p2.payload = pkt[4] + 40; p2.len = 260; p2.tot_len = 260; p2.next = PNULL;
+    outCalls = 0;
+    HOST_CHECK(nif[0].output(&nif[0], &p1, PNULL) == ERR_OK && outCalls == 1);
+    expect(MW_PCAP_DIR_OUT, MW_PCAP_PATH_LWIP, 1, pkt[4], 300);
+    host_ms += 10;
+    ipPacket(pkt[5], 48, 6, TRUE);
+    p1.payload = pkt[5]; p1.len = 48; p1.tot_len = 48; p1.next = PNULL;
+    HOST_CHECK(nif[0].output_ip6(&nif[0], &p1, PNULL) == ERR_OK && outCalls == 17);
+    expect(MW_PCAP_DIR_OUT, MW_PCAP_PATH_LWIP, 2, pkt[5], 48);
+
+    /* Added again: a fresh output from init, hooked in the same slot */
+    HOST_CHECK(netif_add(&nif[0], PNULL, PNULL, PNULL, PNULL, netifInit, PNULL) == &nif[0]);
+    HOST_CHECK(nif[0].output != origOutput);
+    HOST_CHECK(netif_add(&nif[1], PNULL, PNULL, PNULL, PNULL, netifInitFail, PNULL) == PNULL);
+    HOST_CHECK(netif_add(&nif[1], PNULL, PNULL, PNULL, PNULL, netifInitNoIp6, PNULL) == &nif[1]);
+    HOST_CHECK(nif[1].output != origOutput && nif[1].output_ip6 == PNULL);
+    for (i = 2; i < MW_PCAP_MAX_NETIF + 1; i++)
+        HOST_CHECK(netif_add(&nif[i], PNULL, PNULL, PNULL, PNULL, netifInit, PNULL) == &nif[i]);
+    HOST_CHECK(nif[MW_PCAP_MAX_NETIF - 1].output != origOutput);
+    HOST_CHECK(nif[MW_PCAP_MAX_NETIF].output == origOutput && nif[MW_PCAP_MAX_NETIF].output_ip6 == origOutputIp6);
+    HOST_CHECK(host_netif_calls.netifAdd == MW_PCAP_MAX_NETIF + 3);
+
+    /* Fast path downlink: pkgNum packets, or up to the tail */
+    host_ms += 10;
+    for (i = 0; i < 4; i++)
+    {
+        ipPacket(pkt[i], 50 + i, 10 + i, i & 1);
+        dl[i].pPdu = pkt[i];
+        dl[i].length = (UINT16)(50 + i);
+        dl[i].bRohcFeedback = 0;
+        dl[i].pNext = (i < 3) ? &dl[i + 1] : PNULL;
+    }
+    NetifDlPkgFastPathIsr(3, 3, dl, &dl[3], PNULL);
+    for (i = 0; i < 3; i++)
+        expect(MW_PCAP_DIR_IN, MW_PCAP_PATH_FASTPATH, 3, pkt[i], 50 + i);
+    host_ms += 10;
+    NetifDlPkgFastPathIsr(4, 4, dl, &dl[1], PNULL);
+    for (i = 0; i < 2; i++)
+        expect(MW_PCAP_DIR_IN, MW_PCAP_PATH_FASTPATH, 4, pkt[i], 50 + i);
+    HOST_CHECK(host_netif_calls.fastDl == 2 && host_netif_calls.lastPkgNum == 4);
+
+    /* Fast path uplink: the first segment of each packet, past validOffset */
+    host_ms += 10;
+    memset(ul, 0, sizeof(ul));
+    ipPacket(pkt[6] + 8, 200, 20, FALSE);
+    ul[0].ptr = pkt[6]; ul[0].validOffset = 8; ul[0].length = 120; ul[0].bContinue = 1; ul[0].pNext = &ul[1];
+    ul[1].ptr = pkt[6] + 128; ul[1].length = 80; ul[1].pNext = &ul[2];
+    ipPacket(pkt[7], 30, 21, TRUE);
+    ul[2].ptr = pkt[7]; ul[2].length = 30;
+    NetifUlPkgFastPath(0, ul, PNULL);
+    expect(MW_PCAP_DIR_OUT, MW_PCAP_PATH_FASTPATH, 0xFF, pkt[6] + 8, 120);
+    expect(MW_PCAP_DIR_OUT, MW_PCAP_PATH_FASTPATH, 0xFF, pkt[7], 30);
+    HOST_CHECK(host_netif_calls.fastUl == 1 && host_netif_calls.lastUl == ul);
+
+    host_ms += 1000;
+    checkDump();
+
+    /* Stopped: passed on, not recorded; the ring is kept and dumps again */
+    mwPcapStop();
+    HOST_CHECK(TcpipPsInpkt(1, dl, PNULL) == ERR_OK && host_netif_calls.psInpkt == 2);
+    HOST_CHECK(nif[0].output(&nif[0], &p1, PNULL) == ERR_OK);
+    checkDump();
+    printf("pcap: downlink, netif output, fast path and %d netifs through the wrappers, stop\n", MW_PCAP_MAX_NETIF);
+}
+
+static void feed(int packets)
+{
+    static UINT8 pkt[600];
+    DlPduBlock dl;
+    int i;
+    UINT32 len;
+
+    for (i = 0; i < packets; i++)
+    {
+        host_ms += 7;
+        len = 20 + (UINT32)(i * 37) % 580;
+        ipPacket(pkt, len, (UINT32)i, i % 3 == 0);
+        memset(&dl, 0, sizeof(dl));
+        dl.pPdu = pkt;
+        dl.length = (UINT16)len;
+        TcpipPsInpkt((UINT8)(i % 4), &dl, PNULL);
+        expect(MW_PCAP_DIR_IN, MW_PCAP_PATH_LWIP, (UINT8)(i % 4), pkt, len);
+    }
+}
+
+static void testRing(void)
+{
+    long full, part;
+    UINT8 *text;
+    UINT32 tick;
+    int n;
+
+    modelStart(64, FALSE);
+    feed(300);
+    HOST_CHECK(modelOverwritten > 0);
+    checkDump();
+
+    /* Converted up to a lost chunk */
+    unilogOut = fopen(UNILOG_FILE, "w");
+    unilogChunks = 0;
+    unilogDrop = 20;
+    tick = host_ms;
+    HOST_CHECK(mwPcapDumpToUnilog() == MW_PCAP_OK);
+    unilogDrop = -1;
+    fclose(unilogOut);
+    HOST_CHECK(system(PCAP_CONVERT " " UNILOG_FILE " " PCAPNG_UNILOG " > " OUT_DIR "pcap_lost.txt") == 0);
+    text = load(OUT_DIR "pcap_lost.txt", &full);
+    text[full] = 0;
+    HOST_CHECK(strstr((char *)text, "lost at offset") != NULL);
+    free(text);
+    /* The records that end before the gap */
+    for (part = 0, n = sizeof(MwPcapFileHdr); n + model[(modelHead + part) % MAX_MODEL].recLen <= 20 * UNILOG_CHUNK; part++)
+        n += model[(modelHead + part) % MAX_MODEL].recLen;
+    n = checkPcapng(PCAPNG_UNILOG, tick, tick / 1000, MAX_MODEL);
+    HOST_CHECK(n == part && n < modelCount);
+    printf("pcap: 300 packets overwrite %u of the oldest, a lost unilog chunk ends the conversion\n",
+           modelOverwritten);
+
+    modelStart(96, TRUE);
+    feed(300);
+    HOST_CHECK(modelStopped > 0);
+    checkDump();
+    printf("pcap: stop when full keeps the first %d, %u refused\n", modelCount, modelStopped);
+}
+
+static void bench(void)
+{
+    static UINT8 pkt[1500];
+    DlPduBlock dl;
+    double start;
+    int i, n = 1000000;
+
+    HOST_CHECK(mwPcapStart(MW_PCAP_DEFAULT_SNAPLEN, FALSE) == MW_PCAP_OK);
+    ipPacket(pkt, sizeof(pkt), 0, FALSE);
+    memset(&dl, 0, sizeof(dl));
+    dl.pPdu = pkt;
+    dl.length = sizeof(pkt);
+    start = host_now();
+    for (i = 0; i < n; i++)
+        TcpipPsInpkt(1, &dl, PNULL);
+    printf("  1500 B downlink packet, %u B captured: %.0f ns\n", MW_PCAP_DEFAULT_SNAPLEN,
+           (host_now() - start) * 1e9 / n);
+}
+
+int main(int argc, char **argv)
+{
+    host_ms = 1700000000u;
+    testApi();
+    testHooks();
+    testRing();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
@@ -0,0 +1,271 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_pcprof.c without its sampler: random PCs counted per granule against
+ * a model, PC 0 counted as missed; PCs sharing a hash probed into the next
+ * entries, across the end of the table, and the one past
+ * MW_PCPROF_PROBES dropped; the unilog dump as ramcode_hot.py reads it, the
+ * stats, then the entries in chunks of at most 32 (PC, count) pairs of
+ * little-endian words.
+ *
+ * "profile <file>" counts the PCs of this process at 997 Hz of CPU time,
+ * taken by SIGPROF while mw_chksum.c runs, and writes the _2 dumps joined:
+ * the input of ramcode_hot.py, which "make ramcode_hot" runs on it.
+ *
+ * The source is included to reach mwPcProfCount(), which the timer ISR
+ * calls on target.
+ */
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include "host_stubs.h"
+#include "mw_chksum.h"
+#include "mw_pcprof.c"
+
+#define GRANULE         (1UL << MW_PCPROF_PC_SHIFT)
+#define MODEL_PCS       300
+
+static struct
+{
+    char    id[32];
+    UINT32  len;
+    UINT8   data[MW_PCPROF_DUMP_SAMPLES * sizeof(MwPcProfSample)];
+} dumps[MW_PCPROF_SLOTS / MW_PCPROF_DUMP_SAMPLES + 2];
+static int numDumps;
+static FILE *profileOut;
+
+void host_log_dump(const char *id, uint32_t len, const uint8_t *data)
+{
+    if (profileOut != NULL)
+    {
+        if (strcmp(id, "mwPcProfDump_2") == 0)
+            HOST_CHECK(fwrite(data, 1, len, profileOut) == len);
+        return;
+    }
+    HOST_CHECK(numDumps < (int)(sizeof(dumps) / sizeof(dumps[0])) && len <= sizeof(dumps[0].data));
+    snprintf(dumps[numDumps].id, sizeof(dumps[0].id), "%s", id);
+    dumps[numDumps].len = len;
+    memcpy(dumps[numDumps].data, data, len);
+    numDumps++;
+}
+
+static UINT32 hashIndex(UINT32 pc)
+{
+    return (((pc >> MW_PCPROF_PC_SHIFT) * 2654435761UL) >> 16) & (MW_PCPROF_SLOTS - 1);
+}
+
+static UINT32 countOf(UINT32 pc)
+{
+    MwPcProfSample sample;
+    UINT32 i;
+
+    for (i = 0; mwPcProfGetSample(i, &sample) == MW_PCPROF_OK; i++)
+        if (sample.pc == pc)
+            return sample.count;
+    return 0;
+}
+
+static void testCount(void)
+{
+    UINT32 pcs[MODEL_PCS], counts[MODEL_PCS];
+    MwPcProfSample sample;
+    MwPcProfStats stats;
+    UINT32 total = 0, found = 0, i, j, n;
+
+    mwPcProfReset();
+    srand(5);
+    for (i = 0; i < MODEL_PCS; i++)
+    {
+        pcs[i] = (0x00800000 + (UINT32)rand() % 0x100000) & ~(GRANULE - 1);
+        for (j = 0; j < i; j++)
+            if (pcs[j] == pcs[i])
+                break;
+        if (j < i)
+            pcs[i] += 0x200000;
+        counts[i] = 0;
+    }
+    for (n = 0; n < 100000; n++)
+    {
+        i = (UINT32)rand() % MODEL_PCS;
+        mwPcProfCount(pcs[i] + (UINT32)rand() % GRANULE);
+        counts[i]++;
+        total++;
+    }
+    mwPcProfCount(0);
+    mwPcProfCount(GRANULE - 2);
+
+    mwPcProfGetStats(&stats);
+    HOST_CHECK(stats.samples == total && stats.missed == 2 && stats.dropped == 0);
+    HOST_CHECK(stats.slotsUsed == MODEL_PCS);
+    for (i = 0; mwPcProfGetSample(i, &sample) == MW_PCPROF_OK; i++)
+    {
+        for (j = 0; j < MODEL_PCS && pcs[j] != sample.pc; j++)
+            ;
+        HOST_CHECK(j < MODEL_PCS && sample.count == counts[j]);
+        found++;
+    }
+    HOST_CHECK(found == MODEL_PCS);
+    HOST_CHECK(mwPcProfGetSample(0, NULL) == MW_PCPROF_ERR_PARAM);
+
+    mwPcProfReset();
+    mwPcProfGetStats(&stats);
+    HOST_CHECK(stats.samples == 0 && stats.slotsUsed == 0 && mwPcProfGetSample(0, &sample) == MW_PCPROF_END);
+    printf("pcprof: %u samples over %d granules counted as the model, PC 0 missed\n", total, MODEL_PCS);
+}
+
+/* PCs of one hash fill MW_PCPROF_PROBES entries from it, wrapping at the
+ * end of the table; the next is dropped while the others still count */
+static void testProbe(void)
+{
+    UINT32 pcs[MW_PCPROF_PROBES + 1];
+    MwPcProfStats stats;
+    UINT32 pc, n = 0, i;
+
+    mwPcProfReset();
+    for (pc = 0x00800000; n < MW_PCPROF_PROBES + 1; pc += GRANULE)
+        if (hashIndex(pc) == MW_PCPROF_SLOTS - 2)
+            pcs[n++] = pc;
+
+    for (i = 0; i < MW_PCPROF_PROBES; i++)
+        mwPcProfCount(pcs[i]);
+    for (i = 0; i < MW_PCPROF_PROBES; i++)
+        HOST_CHECK(mwPcProf.slots[(MW_PCPROF_SLOTS - 2 + i) & (MW_PCPROF_SLOTS - 1)].pc == pcs[i]);
+
+    mwPcProfCount(pcs[MW_PCPROF_PROBES]);
+    mwPcProfCount(pcs[MW_PCPROF_PROBES - 1]);
+    mwPcProfGetStats(&stats);
+    HOST_CHECK(stats.dropped == 1 && stats.slotsUsed == MW_PCPROF_PROBES);
+    HOST_CHECK(countOf(pcs[MW_PCPROF_PROBES - 1]) == 2 && countOf(pcs[MW_PCPROF_PROBES]) == 0);
+    printf("pcprof: %d PCs of one hash probed across the table end, the next dropped\n", MW_PCPROF_PROBES);
+}
+
+static void testDump(void)
+{
+    MwPcProfSample samples[100];
+    MwPcProfStats stats;
+    UINT32 n = 0, i, j, off;
+    int d;
+
+    mwPcProfReset();
+    numDumps = 0;
+    mwPcProfDumpToUnilog();
+    HOST_CHECK(numDumps == 1 && strcmp(dumps[0].id, "mwPcProfDump_1") == 0);
+
+    for (i = 0; i < 100; i++)
+        for (j = 0; j <= i % 7; j++)
+            mwPcProfCount(0x00810000 + i * 0x40);
+    mwPcProfGetStats(&stats);
+
+    numDumps = 0;
+    mwPcProfDumpToUnilog();
+    HOST_CHECK(numDumps == 1 + (100 + MW_PCPROF_DUMP_SAMPLES - 1) / MW_PCPROF_DUMP_SAMPLES);
+    HOST_CHECK(strcmp(dumps[0].id, "mwPcProfDump_1") == 0 && dumps[0].len == sizeof(stats));
+    HOST_CHECK(memcmp(dumps[0].data, &stats, sizeof(stats)) == 0);
+    for (d = 1; d < numDumps; d++)
+    {
+        HOST_CHECK(strcmp(dumps[d].id, "mwPcProfDump_2") == 0);
+        HOST_CHECK(dumps[d].len > 0 && dumps[d].len % 8 == 0);
+        HOST_CHECK(dumps[d].len <= MW_PCPROF_DUMP_SAMPLES * 8);
+        for (off = 0; off < dumps[d].len; off += 8)
+        {
+            const UINT8 *p = dumps[d].data + off;
+
+            samples[n].pc = p[0] | p[1] << 8 | p[2] << 16 | (UINT32)p[3] << 24;
+            samples[n].count = p[4] | p[5] << 8 | p[6] << 16 | (UINT32)p[7] << 24;
+            n++;
+        }
+    }
+    HOST_CHECK(n == 100);
+    for (i = 0; i < n; i++)
+    {
+        j = (samples[i].pc - 0x00810000) / 0x40;
+        HOST_CHECK(j < 100 && samples[i].pc == 0x00810000 + j * 0x40 && samples[i].count == j % 7 + 1);
+        for (off = 0; off < i; off++)
+            HOST_CHECK(samples[off].pc != samples[i].pc);
+    }
+    printf("pcprof: dump of the stats and 100 entries in %d chunks of (PC, count) pairs\n", numDumps - 1);
+}
+
+/* The PC the SIGPROF tick interrupted, as the XIC entry takes it on
+ * target; above 4 GB, in a shared library, it counts as missed */
+static void onProfTick(int sig, siginfo_t *info, void *context)
+{
+    uintptr_t pc = (uintptr_t)((ucontext_t *)context)->uc_mcontext.gregs[REG_RIP];
+
+    (void)sig;
+    (void)info;
+    mwPcProfCount(pc >> 32 ? 0 : (UINT32)pc);
+}
+
+static void profile(const char *path)
+{
+    static UINT8 buf[4096];
+    struct itimerval tick = { { 0, 1000000 / MW_PCPROF_DEFAULT_RATE_HZ }, { 0, 1000000 / MW_PCPROF_DEFAULT_RATE_HZ } };
+    struct itimerval off = { { 0, 0 }, { 0, 0 } };
+    struct sigaction action;
+    volatile UINT32 sink = 0;
+    MwPcProfStats stats;
+    double end;
+    UINT32 i;
+
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = (UINT8)(i * 131);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = onProfTick;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    HOST_CHECK(sigaction(SIGPROF, &action, NULL) == 0);
+
+    mwPcProfReset();
+    HOST_CHECK(setitimer(ITIMER_PROF, &tick, NULL) == 0);
+    for (end = host_now() + 2; host_now() < end; )
+    {
+        /* The shares of the three checksums on a gateway: mostly IP */
+        for (i = 0; i < 8; i++)
+            sink += mwInetChksum(buf, sizeof(buf));
+        for (i = 0; i < 2; i++)
+            sink += mwCrc32(0, buf, sizeof(buf));
+        sink += mwCrc16Ccitt(0xFFFF, buf, sizeof(buf));
+    }
+    HOST_CHECK(setitimer(ITIMER_PROF, &off, NULL) == 0);
+
+    profileOut = fopen(path, "wb");
+    HOST_CHECK(profileOut != NULL);
+    mwPcProfDumpToUnilog();
+    fclose(profileOut);
+    profileOut = NULL;
+
+    mwPcProfGetStats(&stats);
+    HOST_CHECK(stats.samples > 0);
+    printf("pcprof: %u samples in %u entries, %u missed, %u dropped, written to %s\n",
+           stats.samples, stats.slotsUsed, stats.missed, stats.dropped, path);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 2 && strcmp(argv[1], "profile") == 0)
+    {
+        profile(argv[2]);
+        return 0;
+    }
+    testCount();
+    testProbe();
+    testDump();
+    return 0;
+}
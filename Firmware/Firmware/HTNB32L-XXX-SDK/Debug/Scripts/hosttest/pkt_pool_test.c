@@ -0,0 +1,264 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * lwm2m_pkt_pool.c: packets and their payloads taken and returned until
+ * both ring indices wrap past 2^32, in arrival order and with their
+ * datagrams intact; an empty pool, a datagram above the payload size, a
+ * foreign packet and a packet enqueued twice refused and counted; a
+ * receiver thread feeding the LwM2M side through the rings without a
+ * lock. "bench" compares a datagram through the pool with the malloc()
+ * of a packet and its payload under a mutex it replaces.
+ *
+ * The source is included to start the ring indices near their wrap.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include "host_stubs.h"
+#include "lwm2m_pkt_pool.c"
+
+#define THREAD_PKTS     200000
+
+static unsigned long signals;
+static uint32_t expectSeq;
+
+void lwm2m_set_signal(void)
+{
+    signals++;
+}
+
+static void fill(uint8_t *buf, uint32_t seq, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = (uint8_t)(seq * 31 + i);
+}
+
+static size_t lengthOf(uint32_t seq)
+{
+    return 4 + (seq * 7919) % (LWM2M_PKT_PAYLOAD_SIZE - 3);
+}
+
+/* Each datagram carries its sequence number in its first bytes */
+static void checkPkt(lwm2m_pkt_t *pkt)
+{
+    lwm2m_pkt_payload_t *payload = pkt->cmd_data.message;
+    uint8_t want[LWM2M_PKT_PAYLOAD_SIZE];
+    uint32_t seq;
+
+    HOST_CHECK(pkt->cmd_hdr.cmd_id == LWM2M_REQ_PKT);
+    HOST_CHECK(payload >= &lwm2m_pkt_pool.payloads[0] && payload < &lwm2m_pkt_pool.payloads[LWM2M_PKT_POOL_SIZE]);
+    memcpy(&seq, payload->data, 4);
+    HOST_CHECK(seq == expectSeq);
+    HOST_CHECK(payload->length == lengthOf(seq));
+    HOST_CHECK(pkt->cmd_data.cHandle == (void *)(uintptr_t)(seq | 1));
+    fill(want, seq, payload->length);
+    memcpy(want, &seq, 4);
+    HOST_CHECK(memcmp(want, payload->data, payload->length) == 0);
+    expectSeq++;
+}
+
+static int receive(uint32_t seq)
+{
+    uint8_t buf[LWM2M_PKT_PAYLOAD_SIZE];
+    size_t len = lengthOf(seq);
+
+    fill(buf, seq, len);
+    memcpy(buf, &seq, 4);
+    return lwm2m_pkt_pool_receive((void *)(uintptr_t)(seq | 1), NULL, buf, len);
+}
+
+static void testWrap(void)
+{
+    const uint32_t start = 0u - 64 * LWM2M_PKT_POOL_SIZE;
+    uint32_t seq = 0, rounds;
+    int n, i;
+
+    lwm2m_pkt_pool_init();
+    lwm2m_pkt_pool.free_ring.head += start;
+    lwm2m_pkt_pool.free_ring.tail += start;
+    lwm2m_pkt_pool.ready_ring.head = lwm2m_pkt_pool.ready_ring.tail = start;
+    expectSeq = 0;
+    srand(3);
+
+    /* Bursts of 1 to LWM2M_PKT_POOL_SIZE, then one drain */
+    for (rounds = 0; rounds < 20000; rounds++)
+    {
+        n = 1 + rand() % LWM2M_PKT_POOL_SIZE;
+        for (i = 0; i < n; i++)
+            HOST_CHECK(receive(seq++) == 0);
+        HOST_CHECK(lwm2m_pkt_pool_pending() == n);
+        HOST_CHECK(lwm2m_pkt_pool_drain(checkPkt) == n);
+    }
+    HOST_CHECK(expectSeq == seq);
+    HOST_CHECK(lwm2m_pkt_pool.ready_ring.tail < start && lwm2m_pkt_pool.free_ring.head < start);
+    HOST_CHECK(lwm2m_pkt_pool.stats.enqueued == seq && lwm2m_pkt_pool.stats.high_water == LWM2M_PKT_POOL_SIZE);
+    HOST_CHECK(lwm2m_pkt_pool.stats.exhausted == 0 && lwm2m_pkt_pool.stats.ring_full == 0);
+    printf("pkt_pool: %u datagrams in bursts of up to %d, both rings wrapped 2^32, in order and intact\n",
+           seq, LWM2M_PKT_POOL_SIZE);
+}
+
+static void testRefused(void)
+{
+    uint8_t big[LWM2M_PKT_PAYLOAD_SIZE + 1];
+    lwm2m_pkt_t *pkts[LWM2M_PKT_POOL_SIZE], foreign;
+    lwm2m_pkt_pool_stats_t stats;
+    int i;
+
+    lwm2m_pkt_pool_init();
+    memset(big, 0, sizeof(big));
+    HOST_CHECK(lwm2m_pkt_pool_receive(NULL, NULL, big, sizeof(big)) == -1);
+    HOST_CHECK(lwm2m_pkt_pool_receive(NULL, NULL, big, LWM2M_PKT_PAYLOAD_SIZE) == 0);
+    HOST_CHECK(lwm2m_pkt_pool_drain(NULL) == 1);
+
+    /* Every packet out, each with its own payload */
+    for (i = 0; i < LWM2M_PKT_POOL_SIZE; i++)
+    {
+        pkts[i] = lwm2m_pkt_pool_get();
+        HOST_CHECK(pkts[i] != NULL && lwm2m_pkt_pool_owns(pkts[i]));
+        HOST_CHECK(pkts[i]->cmd_data.message == &lwm2m_pkt_pool.payloads[pkts[i] - lwm2m_pkt_pool.pkts]);
+    }
+    HOST_CHECK(lwm2m_pkt_pool_get() == NULL);
+    HOST_CHECK(receive(0) == -1);
+
+    HOST_CHECK(lwm2m_pkt_pool_enqueue(&foreign) == -1 && !lwm2m_pkt_pool_owns(&foreign));
+    for (i = 0; i < LWM2M_PKT_POOL_SIZE; i++)
+        HOST_CHECK(lwm2m_pkt_pool_enqueue(pkts[i]) == 0);
+    HOST_CHECK(lwm2m_pkt_pool_enqueue(pkts[0]) == -1);
+    HOST_CHECK(lwm2m_pkt_pool_pending() == LWM2M_PKT_POOL_SIZE);
+    HOST_CHECK(lwm2m_pkt_pool_drain(NULL) == LWM2M_PKT_POOL_SIZE);
+    HOST_CHECK(lwm2m_pkt_pool_get() != NULL);
+
+    lwm2m_pkt_pool_get_stats(&stats);
+    HOST_CHECK(stats.oversize == 1 && stats.exhausted == 2 && stats.ring_full == 1);
+    HOST_CHECK(stats.enqueued == 1 + LWM2M_PKT_POOL_SIZE);
+    printf("pkt_pool: oversize, exhausted, foreign and twice enqueued packets refused and counted\n");
+}
+
+static volatile int producerDone;
+
+static void *producer(void *arg)
+{
+    unsigned long *dropped = arg;
+    uint32_t seq = 0;
+
+    while (seq < THREAD_PKTS)
+    {
+        if (receive(seq) == 0)
+            seq++;
+        else
+        {
+            (*dropped)++;
+            sched_yield();
+        }
+    }
+    producerDone = 1;
+    return NULL;
+}
+
+/* The receiver retries a dropped datagram as the peer would retransmit it */
+static void testThreads(void)
+{
+    unsigned long dropped = 0;
+    pthread_t thread;
+
+    lwm2m_pkt_pool_init();
+    expectSeq = 0;
+    producerDone = 0;
+    HOST_CHECK(pthread_create(&thread, NULL, producer, &dropped) == 0);
+    /* The yields stand for the LwM2M task waiting on its signal */
+    while (!producerDone || lwm2m_pkt_pool_pending() > 0)
+        if (lwm2m_pkt_pool_drain(checkPkt) == 0)
+            sched_yield();
+    pthread_join(thread, NULL);
+    HOST_CHECK(expectSeq == THREAD_PKTS);
+    HOST_CHECK(lwm2m_pkt_pool.stats.exhausted == dropped && lwm2m_pkt_pool.stats.ring_full == 0);
+    printf("pkt_pool: %d datagrams from a receiver thread in order, %lu retried on an empty pool\n",
+           THREAD_PKTS, dropped);
+}
+
+/* The path the pool replaces: a packet and its datagram from the heap,
+ * queued under a mutex */
+static pthread_mutex_t heapMutex = PTHREAD_MUTEX_INITIALIZER;
+static lwm2m_pkt_t *heapQueue[LWM2M_PKT_POOL_SIZE];
+static int heapCount;
+
+static void heapReceive(const uint8_t *data, size_t len)
+{
+    lwm2m_pkt_t *pkt = malloc(sizeof(*pkt));
+    uint8_t *message = malloc(len);
+
+    memcpy(message, data, len);
+    pkt->cmd_hdr.cmd_id = LWM2M_REQ_PKT;
+    pkt->cmd_data.message = message;
+    pthread_mutex_lock(&heapMutex);
+    heapQueue[heapCount++] = pkt;
+    pthread_mutex_unlock(&heapMutex);
+}
+
+static void heapDrain(void)
+{
+    int i;
+
+    pthread_mutex_lock(&heapMutex);
+    for (i = 0; i < heapCount; i++)
+    {
+        free(heapQueue[i]->cmd_data.message);
+        free(heapQueue[i]);
+    }
+    heapCount = 0;
+    pthread_mutex_unlock(&heapMutex);
+}
+
+static void bench(void)
+{
+    const int n = 4000000;
+    uint8_t buf[LWM2M_PKT_PAYLOAD_SIZE];
+    double t;
+    int i;
+
+    memset(buf, 0x5A, sizeof(buf));
+    lwm2m_pkt_pool_init();
+    t = host_now();
+    for (i = 0; i < n; i++)
+    {
+        lwm2m_pkt_pool_receive(NULL, NULL, buf, 64 + i % 400);
+        if ((i & 3) == 3)
+            lwm2m_pkt_pool_drain(NULL);
+    }
+    printf("  pool:  %.1f ns per datagram\n", (host_now() - t) * 1e9 / n);
+
+    t = host_now();
+    for (i = 0; i < n; i++)
+    {
+        heapReceive(buf, 64 + i % 400);
+        if ((i & 3) == 3)
+            heapDrain();
+    }
+    printf("  heap:  %.1f ns per datagram\n", (host_now() - t) * 1e9 / n);
+}
+
+int main(int argc, char **argv)
+{
+    testWrap();
+    testRefused();
+    testThreads();
+    HOST_CHECK(signals > 0);
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_reactor.c over host threads and sockets: start failures leave nothing
+ * behind and a later start works, concurrent starts create one task; a
+ * socket is registered, removed, closed and its fd registered again; a
+ * socket closed while still registered is dropped by the reactor, which
+ * keeps running its sockets and timers.
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include "host_stubs.h"
+#include "host_os.h"
+#include "cmsis_os2.h"
+#include "sockets.h"
+#include "mw_reactor.h"
+
+static volatile int lastFd = -1;
+static volatile int reads;
+static volatile int fired;
+
+static void onRead(INT32 fd, UINT8 events, void *arg)
+{
+    UINT8 buf[64];
+
+    (void)arg;
+    if (events & MW_REACTOR_EV_READ)
+    {
+        while (recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0)
+            ;
+    }
+    lastFd = fd;
+    __atomic_add_fetch(&reads, 1, __ATOMIC_SEQ_CST);
+}
+
+static void onTimer(MwReactorTimer *timer, void *arg)
+{
+    (void)timer;
+    (void)arg;
+    __atomic_add_fetch(&fired, 1, __ATOMIC_SEQ_CST);
+}
+
+static void onPost(void *arg)
+{
+    (void)arg;
+}
+
+/* Wait up to 2 s for *v to reach n */
+static int waitFor(volatile int *v, int n)
+{
+    int i;
+
+    for (i = 0; i < 2000 && __atomic_load_n(v, __ATOMIC_SEQ_CST) < n; i++)
+        osDelay(1);
+    return *v >= n;
+}
+
+static int udpOpen(struct sockaddr_in *addr)
+{
+    socklen_t len = sizeof(*addr);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    HOST_CHECK(fd >= 0);
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    HOST_CHECK(bind(fd, (struct sockaddr *)addr, sizeof(*addr)) == 0);
+    HOST_CHECK(getsockname(fd, (struct sockaddr *)addr, &len) == 0);
+    return fd;
+}
+
+static void udpPoke(const struct sockaddr_in *addr)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    HOST_CHECK(sendto(fd, "x", 1, 0, (const struct sockaddr *)addr, sizeof(*addr)) == 1);
+    close(fd);
+}
+
+/* The lowest free fd, the one the next socket gets */
+static int nextFd(void)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    close(fd);
+    return fd;
+}
+
+static void testStartFailures(void)
+{
+    MwReactorTimer timer;
+    int fd = nextFd();
+    int fail;
+
+    HOST_CHECK(mwReactorAddSocket(0, MW_REACTOR_EV_READ, onRead, NULL) == MW_REACTOR_ERR_STATE);
+    HOST_CHECK(mwReactorPost(onPost, NULL) == MW_REACTOR_ERR_STATE);
+    mwReactorTimerInit(&timer, onTimer, NULL);
+    HOST_CHECK(mwReactorTimerStart(&timer, 10, 0) == MW_REACTOR_ERR_STATE);
+
+    /* Two mutexes, then the task */
+    for (fail = 0; fail < 3; fail++)
+    {
+        host_os_fail = fail;
+        HOST_CHECK(mwReactorStart() == MW_REACTOR_ERR_SYS);
+        HOST_CHECK(host_os_fail == -1);
+        HOST_CHECK(mwReactorAddSocket(0, MW_REACTOR_EV_READ, onRead, NULL) == MW_REACTOR_ERR_STATE);
+        HOST_CHECK(nextFd() == fd);         //the wake socket was closed
+    }
+}
+
+static void *starter(void *arg)
+{
+    *(INT32 *)arg = mwReactorStart();
+    return NULL;
+}
+
+static void testConcurrentStart(void)
+{
+    unsigned long creates = host_os_creates;
+    pthread_t t[4];
+    INT32 rc[4];
+    int i;
+
+    for (i = 0; i < 4; i++)
+        HOST_CHECK(pthread_create(&t[i], NULL, starter, &rc[i]) == 0);
+    for (i = 0; i < 4; i++)
+    {
+        pthread_join(t[i], NULL);
+        HOST_CHECK(rc[i] == MW_REACTOR_OK);
+    }
+    HOST_CHECK(host_os_creates - creates == 3);
+    HOST_CHECK(mwReactorStart() == MW_REACTOR_OK);
+}
+
+static void testReregister(void)
+{
+    struct sockaddr_in addr;
+    MwReactorStats stats;
+    int fd, again, i;
+
+    fd = udpOpen(&addr);
+    HOST_CHECK(mwReactorAddSocket(fd, MW_REACTOR_EV_READ, onRead, NULL) == MW_REACTOR_OK);
+    HOST_CHECK(mwReactorAddSocket(fd, MW_REACTOR_EV_READ, onRead, NULL) == MW_REACTOR_ERR_STATE);
+    udpPoke(&addr);
+    HOST_CHECK(waitFor(&reads, 1) && lastFd == fd);
+
+    /* The way the owners do it: remove, close, then the new socket */
+    HOST_CHECK(mwReactorDelSocket(fd) == MW_REACTOR_OK);
+    HOST_CHECK(mwReactorDelSocket(fd) == MW_REACTOR_ERR_NOT_FOUND);
+    close(fd);
+    again = udpOpen(&addr);
+    HOST_CHECK(again == fd);
+    HOST_CHECK(mwReactorAddSocket(again, MW_REACTOR_EV_READ, onRead, NULL) == MW_REACTOR_OK);
+    udpPoke(&addr);
+    HOST_CHECK(waitFor(&reads, 2) && lastFd == again);
+
+    /* Closed while registered: select() fails until the slot is dropped */
+    close(again);
+    HOST_CHECK(mwReactorPost(onPost, NULL) == MW_REACTOR_OK);
+    for (i = 0; i < 2000; i++)
+    {
+        osDelay(1);
+        mwReactorGetStats(&stats);
+        if (stats.sockDropped != 0)
+            break;
+    }
+    HOST_CHECK(stats.sockDropped == 1);
+
+    fd = udpOpen(&addr);
+    HOST_CHECK(fd == again);
+    HOST_CHECK(mwReactorAddSocket(fd, MW_REACTOR_EV_READ, onRead, NULL) == MW_REACTOR_OK);
+    udpPoke(&addr);
+    HOST_CHECK(waitFor(&reads, 3) && lastFd == fd);
+    HOST_CHECK(mwReactorDelSocket(fd) == MW_REACTOR_OK);
+    close(fd);
+}
+
+static void testTimer(void)
+{
+    MwReactorTimer timer;
+    MwReactorStats stats;
+
+    mwReactorTimerInit(&timer, onTimer, NULL);
+    HOST_CHECK(mwReactorTimerStart(&timer, 20, 0) == MW_REACTOR_OK);
+    HOST_CHECK(waitFor(&fired, 1));
+    HOST_CHECK(!mwReactorTimerIsArmed(&timer));
+    mwReactorGetStats(&stats);
+    HOST_CHECK(stats.timersFired == 1 && stats.sockDropped == 1);
+}
+
+int main(void)
+{
+    testStartFailures();
+    testConcurrentStart();
+    testReregister();
+    testTimer();
+    printf("start failures, concurrent start, register / close / register again passed\n");
+    return 0;
+}
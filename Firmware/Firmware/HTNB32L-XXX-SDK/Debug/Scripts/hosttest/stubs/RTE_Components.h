@@ -0,0 +1,7 @@
+#ifndef RTE_COMPONENTS_H
+#define RTE_COMPONENTS_H
+
+/* Host stand-in: the device header is stubs/host_device.h */
+#define CMSIS_device_header "host_device.h"
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef __API_H__
+#define __API_H__
+
+/* Host stand-in for lwIP's api.h: the resolver call, supplied by the tests */
+
+#include <stdint.h>
+#include "ip_addr.h"
+
+typedef int8_t err_t;
+
+#define ERR_OK                      0
+#define ERR_VAL                     -6
+#define ERR_ARG                     -16
+
+err_t netconn_gethostbyname(const char *name, ip_addr_t *addr);
+
+#endif
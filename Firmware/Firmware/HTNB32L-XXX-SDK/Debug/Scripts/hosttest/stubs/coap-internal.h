@@ -0,0 +1,16 @@
+#ifndef _COAP_INIT_H
+#define _COAP_INIT_H
+
+/* Host stand-in for coap-internal.h: the message and transaction types
+ * without the socket, DTLS and task layers */
+
+#include "qurt_os.h"
+#include "iotapp_log_util.h"
+#include "er-coap-13.h"
+#include "coap_trans.h"
+
+#define COAP_LOG_DEBUG(format, ...)
+#define COAP_LOG_INFO(format, ...)
+#define COAP_LOG_ERROR(format, ...)
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef _COMMON_TYPEDEF_H
+#define _COMMON_TYPEDEF_H
+
+/* Host stand-in for commontypedef.h with the target widths: UINT32 is
+ * unsigned long there, 64 bits on a 64-bit host */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef int8_t          INT8;
+typedef uint8_t         UINT8;
+typedef int16_t         INT16;
+typedef uint16_t        UINT16;
+typedef int32_t         INT32;
+typedef uint32_t        UINT32;
+typedef int64_t         INT64;
+typedef uint64_t        UINT64;
+typedef char            CHAR;
+typedef uint8_t         BOOL;
+typedef void *          PVOID;
+
+#ifndef TRUE
+#define TRUE            1
+#endif
+#ifndef FALSE
+#define FALSE           0
+#endif
+#define PNULL           NULL
+
+#define PUBLIC
+#define PRIVATE         static
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef DEBUG_LOG_STUB
+#define DEBUG_LOG_STUB
+#include <stdint.h>
+#define P_INFO 1
+#define P_DEBUG 2
+#define P_ERROR 3
+#define P_SIG 4
+#define P_WARNING 5
+#define P_VALUE 6
+#define HT_TRACE(...) do { } while (0)
+
+/* The dump of a module reaches host_log_dump() under the name of its id */
+void host_log_dump(const char *id, uint32_t len, const uint8_t *data);
+#define QCOMM_DUMP(moduleID, subID, debugLevel, format, dumpLen, dump) \
+    host_log_dump(#subID, (dumpLen), (const uint8_t *)(dump))
+#endif
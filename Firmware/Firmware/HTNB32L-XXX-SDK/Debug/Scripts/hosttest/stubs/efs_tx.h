@@ -0,0 +1 @@
+/* Host stand-in for efs_tx.h, no file system on the host */
@@ -0,0 +1,15 @@
+#ifndef _FLASH_QCX212_RT_H
+#define _FLASH_QCX212_RT_H
+
+/* Host stand-in for flash_qcx212_rt.h, backed by host_flash.c */
+
+#include <stdint.h>
+
+#define QSPI_OK            ((uint8_t)0x00)
+#define QSPI_ERROR         ((uint8_t)0x01)
+
+uint8_t BSP_QSPI_Erase_Safe(uint32_t SectorAddress, uint32_t Size);
+uint8_t BSP_QSPI_Write_Safe(uint8_t* pData, uint32_t WriteAddr, uint32_t Size);
+uint8_t BSP_QSPI_Read_Safe(uint8_t* pData, uint32_t WriteAddr, uint32_t Size);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef __HOST_DEVICE_H__
+#define __HOST_DEVICE_H__
+
+/* The Cortex-M registers and barriers the middleware uses, on the host.
+ * DWT->CYCCNT counts SystemCoreClock cycles per second of the monotonic
+ * clock. */
+
+#include <stdint.h>
+#include "host_stubs.h"
+#include "system_qcx212.h"
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} HostDwt;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} HostCoreDebug;
+
+#define DWT_CTRL_CYCCNTENA_Msk              (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk          (1UL << 24)
+
+extern uint32_t SystemCoreClock;
+
+static inline HostDwt *host_dwt(void)
+{
+    static HostDwt dwt;
+
+    dwt.CYCCNT = (uint32_t)(uint64_t)(host_now() * SystemCoreClock);
+    return &dwt;
+}
+
+static HostCoreDebug host_core_debug __attribute__((unused));
+
+#define DWT                 (host_dwt())
+#define CoreDebug           (&host_core_debug)
+
+#define __DMB()             __sync_synchronize()
+
+/* Code the target copies to RAM runs in place here */
+#define PLAT_CODE_IN_RAM
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Emulated NOR flash for the modules that program the QSPI flash directly */
+
+#include <string.h>
+#include <unistd.h>
+#include "flash_qcx212_rt.h"
+#include "host_stubs.h"
+#include "host_flash.h"
+
+uint8_t host_flash[HOST_FLASH_SIZE];
+unsigned long host_flash_erases, host_flash_programs, host_flash_reads;
+int host_flash_tear = -1;
+long host_flash_cut = -1;
+int host_flash_off;
+unsigned host_flash_program_us, host_flash_erase_us;
+unsigned long host_flash_page_cross;
+
+void host_flash_blank(void)
+{
+    memset(host_flash, 0xFF, sizeof(host_flash));
+    host_flash_erases = host_flash_programs = host_flash_reads = 0;
+    host_flash_tear = -1;
+    host_flash_cut = -1;
+    host_flash_off = 0;
+    host_flash_page_cross = 0;
+}
+
+/* 0: run the operation, 1: drop it, 2: tear it */
+static int host_flash_power(void)
+{
+    if (host_flash_off)
+        return 1;
+    if (host_flash_cut < 0 || host_flash_cut-- > 0)
+        return 0;
+    host_flash_off = 1;
+    return 2;
+}
+
+uint8_t BSP_QSPI_Erase_Safe(uint32_t SectorAddress, uint32_t Size)
+{
+    uint32_t i;
+
+    HOST_CHECK(SectorAddress % HOST_FLASH_SECTOR == 0 && Size % HOST_FLASH_SECTOR == 0);
+    HOST_CHECK(SectorAddress + Size <= HOST_FLASH_SIZE);
+    switch (host_flash_power())
+    {
+        case 1:
+            return QSPI_OK;
+        case 2:
+            /* Cut during the erase: some bytes erased, the others not */
+            for (i = 0; i < Size; i++)
+            {
+                if (rand() % 2)
+                    host_flash[SectorAddress + i] = 0xFF;
+            }
+            return QSPI_OK;
+    }
+    if (host_flash_erase_us)
+        usleep(host_flash_erase_us * (Size / HOST_FLASH_SECTOR));
+    memset(host_flash + SectorAddress, 0xFF, Size);
+    host_flash_erases += Size / HOST_FLASH_SECTOR;
+    return QSPI_OK;
+}
+
+uint8_t BSP_QSPI_Write_Safe(uint8_t* pData, uint32_t WriteAddr, uint32_t Size)
+{
+    uint32_t i;
+
+    HOST_CHECK(WriteAddr + Size <= HOST_FLASH_SIZE);
+    switch (host_flash_power())
+    {
+        case 1:
+            return QSPI_OK;
+        case 2:
+            Size = (uint32_t)rand() % (Size + 1);
+            break;
+    }
+    if (host_flash_tear >= 0)
+    {
+        if ((uint32_t)host_flash_tear < Size)
+            Size = (uint32_t)host_flash_tear;
+        host_flash_tear = -1;
+    }
+    if (host_flash_program_us)
+        usleep(host_flash_program_us);
+    if (WriteAddr % 256 + Size > 256)
+        host_flash_page_cross++;
+    for (i = 0; i < Size; i++)
+        host_flash[WriteAddr + i] &= pData[i];
+    host_flash_programs++;
+    return QSPI_OK;
+}
+
+uint8_t BSP_QSPI_Read_Safe(uint8_t* pData, uint32_t WriteAddr, uint32_t Size)
+{
+    HOST_CHECK(WriteAddr + Size <= HOST_FLASH_SIZE);
+    memcpy(pData, host_flash + WriteAddr, Size);
+    host_flash_reads++;
+    return QSPI_OK;
+}
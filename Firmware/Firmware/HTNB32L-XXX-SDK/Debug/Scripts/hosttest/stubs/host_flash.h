@@ -0,0 +1,32 @@
+#ifndef __HOST_FLASH_H__
+#define __HOST_FLASH_H__
+
+#include <stdint.h>
+
+#define HOST_FLASH_SIZE         0x400000
+#define HOST_FLASH_SECTOR       4096
+
+/* NOR flash behind the BSP_QSPI_*_Safe() stubs: erase sets bytes to 0xFF,
+ * program can only clear bits */
+extern uint8_t host_flash[HOST_FLASH_SIZE];
+extern unsigned long host_flash_erases, host_flash_programs, host_flash_reads;
+
+/* >= 0: the next program stops after that many bytes, as a reset would */
+extern int host_flash_tear;
+
+/* >= 0: a power cut hits after that many more erases and programs. The
+ * one it hits is torn, and host_flash_off is set: later erases and
+ * programs do nothing until it is cleared, as after a reboot */
+extern long host_flash_cut;
+extern int host_flash_off;
+
+/* Time each program and sector erase takes, 0 by default */
+extern unsigned host_flash_program_us, host_flash_erase_us;
+
+/* Programs that ran past the end of their page, which the chip would
+ * have wrapped to its start */
+extern unsigned long host_flash_page_cross;
+
+void host_flash_blank(void);
+
+#endif
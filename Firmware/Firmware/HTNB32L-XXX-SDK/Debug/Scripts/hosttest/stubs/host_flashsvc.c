@@ -0,0 +1,104 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_flashsvc.h run synchronously on the emulated NOR flash: each request
+ * reaches host_flash before the call returns, so Flush() has nothing to
+ * wait for and an erase-ahead announcement is only recorded.
+ */
+
+#include <string.h>
+#include "flash_qcx212_rt.h"
+#include "host_stubs.h"
+#include "host_flash.h"
+#include "mw_flashsvc.h"
+
+#define HOST_FLASH_PAGE         256
+
+static MwFlashSvcStats hostSvcStats;
+static INT32 hostSvcError = MW_FLASHSVC_OK;
+
+INT32 mwFlashSvcInit(void)
+{
+    return MW_FLASHSVC_OK;
+}
+
+INT32 mwFlashSvcProgram(UINT32 addr, const void *data, UINT32 len)
+{
+    const UINT8 *p = (const UINT8 *)data;
+
+    if (data == NULL || addr + len > HOST_FLASH_SIZE)
+        return MW_FLASHSVC_ERR_PARAM;
+    hostSvcStats.programRequests++;
+    hostSvcStats.programBytes += len;
+    while (len > 0)
+    {
+        UINT32 n = HOST_FLASH_PAGE - addr % HOST_FLASH_PAGE;
+
+        if (n > len)
+            n = len;
+        if (BSP_QSPI_Write_Safe((uint8_t *)p, addr, n) != QSPI_OK)
+            hostSvcError = MW_FLASHSVC_ERR_FLASH;
+        hostSvcStats.program.count++;
+        addr += n;
+        p += n;
+        len -= n;
+    }
+    return MW_FLASHSVC_OK;
+}
+
+INT32 mwFlashSvcErase(UINT32 addr, UINT32 len)
+{
+    if (addr % HOST_FLASH_SECTOR != 0 || len % HOST_FLASH_SECTOR != 0 || addr + len > HOST_FLASH_SIZE)
+        return MW_FLASHSVC_ERR_PARAM;
+    hostSvcStats.eraseRequests += len / HOST_FLASH_SECTOR;
+    hostSvcStats.erase.count += len / HOST_FLASH_SECTOR;
+    if (len > 0 && BSP_QSPI_Erase_Safe(addr, len) != QSPI_OK)
+        hostSvcError = MW_FLASHSVC_ERR_FLASH;
+    return MW_FLASHSVC_OK;
+}
+
+INT32 mwFlashSvcFlush(UINT32 timeoutMs)
+{
+    INT32 ret = hostSvcError;
+
+    (void)timeoutMs;
+    hostSvcError = MW_FLASHSVC_OK;
+    return ret;
+}
+
+INT32 mwFlashSvcRead(UINT32 addr, void *data, UINT32 len)
+{
+    if (data == NULL || addr + len > HOST_FLASH_SIZE)
+        return MW_FLASHSVC_ERR_PARAM;
+    return BSP_QSPI_Read_Safe((uint8_t *)data, addr, len) == QSPI_OK ? MW_FLASHSVC_OK : MW_FLASHSVC_ERR_FLASH;
+}
+
+INT32 mwFlashSvcEraseAhead(UINT32 addr, UINT32 len)
+{
+    if (addr % HOST_FLASH_SECTOR != 0 || len % HOST_FLASH_SECTOR != 0 || addr + len > HOST_FLASH_SIZE)
+        return MW_FLASHSVC_ERR_PARAM;
+    return MW_FLASHSVC_OK;
+}
+
+void mwFlashSvcGetStats(MwFlashSvcStats *stats)
+{
+    *stats = hostSvcStats;
+}
+
+void mwFlashSvcResetStats(void)
+{
+    memset(&hostSvcStats, 0, sizeof(hostSvcStats));
+}
@@ -0,0 +1,233 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* The efs calls of qurt_fs.h on a few in-memory files, see host_fs.h */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_fs.h"
+
+typedef struct
+{
+    char        name[64];
+    uint8_t     data[HOST_FS_FILE_SIZE];
+    size_t      len;
+    int         used;
+} HostFile;
+
+typedef struct
+{
+    HostFile    *file;
+    size_t      pos;
+    int         flags;
+    int         used;
+} HostFd;
+
+static HostFile hostFiles[HOST_FS_FILES];
+static HostFd hostFds[HOST_FS_FILES];
+
+long host_fs_space = -1;
+unsigned long host_fs_opens, host_fs_unlinks;
+
+static HostFile *hostFsFind(const char *path)
+{
+    int i;
+
+    for (i = 0; i < HOST_FS_FILES; i++)
+    {
+        if (hostFiles[i].used && strcmp(hostFiles[i].name, path) == 0)
+            return &hostFiles[i];
+    }
+    return NULL;
+}
+
+static HostFile *hostFsCreate(const char *path)
+{
+    int i;
+
+    if (strlen(path) >= sizeof(hostFiles[0].name))
+        return NULL;
+    for (i = 0; i < HOST_FS_FILES; i++)
+    {
+        if (!hostFiles[i].used)
+        {
+            memset(&hostFiles[i], 0, sizeof(HostFile));
+            strcpy(hostFiles[i].name, path);
+            hostFiles[i].used = 1;
+            return &hostFiles[i];
+        }
+    }
+    return NULL;
+}
+
+/* Descriptors start at 1, as efs_open() treats <= 0 as failure */
+static HostFd *hostFsFd(int filedes)
+{
+    if (filedes <= 0 || filedes > HOST_FS_FILES || !hostFds[filedes - 1].used)
+        return NULL;
+    return &hostFds[filedes - 1];
+}
+
+int efs_open(const char *path, int oflag, ...)
+{
+    HostFile *f = hostFsFind(path);
+    int i;
+
+    host_fs_opens++;
+    if (f == NULL)
+    {
+        if (!(oflag & O_CREAT) || (f = hostFsCreate(path)) == NULL)
+            return -1;
+    }
+    else if ((oflag & O_CREAT) && (oflag & O_EXCL))
+    {
+        return -1;
+    }
+
+    for (i = 0; i < HOST_FS_FILES; i++)
+    {
+        if (!hostFds[i].used)
+        {
+            if (oflag & O_TRUNC)
+                f->len = 0;
+            hostFds[i].file = f;
+            hostFds[i].pos = (oflag & O_APPEND) ? f->len : 0;
+            hostFds[i].flags = oflag;
+            hostFds[i].used = 1;
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+fs_ssize_t efs_read(int filedes, void *buf, fs_size_t nbyte)
+{
+    HostFd *fd = hostFsFd(filedes);
+    size_t n;
+
+    if (fd == NULL || !(fd->flags & O_RDONLY))
+        return -1;
+
+    n = (fd->pos < fd->file->len) ? fd->file->len - fd->pos : 0;
+    if (n > nbyte)
+        n = nbyte;
+    memcpy(buf, fd->file->data + fd->pos, n);
+    fd->pos += n;
+    return (fs_ssize_t)n;
+}
+
+fs_ssize_t efs_write(int filedes, const void *buf, fs_size_t nbyte)
+{
+    HostFd *fd = hostFsFd(filedes);
+
+    if (fd == NULL || !(fd->flags & O_WRONLY) || fd->pos + nbyte > HOST_FS_FILE_SIZE)
+        return -1;
+    if (host_fs_space >= 0)
+    {
+        if ((long)nbyte > host_fs_space)
+            return -1;
+        host_fs_space -= nbyte;
+    }
+
+    memcpy(fd->file->data + fd->pos, buf, nbyte);
+    fd->pos += nbyte;
+    if (fd->pos > fd->file->len)
+        fd->file->len = fd->pos;
+    return (fs_ssize_t)nbyte;
+}
+
+fs_off_t efs_lseek(int filedes, fs_off_t offset, int whence)
+{
+    HostFd *fd = hostFsFd(filedes);
+    long pos;
+
+    if (fd == NULL)
+        return -1;
+    if (whence == LFS_SEEK_SET)
+        pos = offset;
+    else if (whence == LFS_SEEK_CUR)
+        pos = (long)fd->pos + offset;
+    else
+        pos = (long)fd->file->len + offset;
+    if (pos < 0 || pos > HOST_FS_FILE_SIZE)
+        return -1;
+    fd->pos = (size_t)pos;
+    return (fs_off_t)pos;
+}
+
+int efs_close(int filedes)
+{
+    HostFd *fd = hostFsFd(filedes);
+
+    if (fd == NULL)
+        return -1;
+    fd->used = 0;
+    return 0;
+}
+
+int efs_unlink(const char *path)
+{
+    HostFile *f = hostFsFind(path);
+
+    host_fs_unlinks++;
+    if (f == NULL)
+        return -1;
+    memset(f, 0, sizeof(HostFile));
+    return 0;
+}
+
+int host_fs_count(void)
+{
+    int n = 0;
+    int i;
+
+    for (i = 0; i < HOST_FS_FILES; i++)
+        n += hostFiles[i].used;
+    return n;
+}
+
+const uint8_t *host_fs_data(const char *path, size_t *len)
+{
+    HostFile *f = hostFsFind(path);
+
+    if (f == NULL)
+        return NULL;
+    *len = f->len;
+    return f->data;
+}
+
+void host_fs_put(const char *path, const void *data, size_t len)
+{
+    HostFile *f = hostFsFind(path);
+
+    if (f == NULL)
+        f = hostFsCreate(path);
+    if (f == NULL || len > HOST_FS_FILE_SIZE)
+    {
+        fprintf(stderr, "host_fs_put: no room for %s\n", path);
+        exit(1);
+    }
+    memcpy(f->data, data, len);
+    f->len = len;
+}
+
+void host_fs_clear(void)
+{
+    memset(hostFiles, 0, sizeof(hostFiles));
+    memset(hostFds, 0, sizeof(hostFds));
+    host_fs_space = -1;
+    host_fs_opens = host_fs_unlinks = 0;
+}
@@ -0,0 +1,26 @@
+#ifndef __HOST_FS_H__
+#define __HOST_FS_H__
+
+#include <stddef.h>
+#include "qurt_fs.h"
+
+#define HOST_FS_FILES       8
+#define HOST_FS_FILE_SIZE   4096
+
+/* >= 0: writes fail once that many more bytes were written, as on a
+ * full file system */
+extern long host_fs_space;
+
+/* Files that exist, and their opens and unlinks so far */
+int host_fs_count(void);
+extern unsigned long host_fs_opens, host_fs_unlinks;
+
+/* Content of path, NULL if it does not exist */
+const uint8_t *host_fs_data(const char *path, size_t *len);
+
+/* Create or replace path with len bytes of data */
+void host_fs_put(const char *path, const void *data, size_t len);
+
+void host_fs_clear(void);
+
+#endif
@@ -0,0 +1,238 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * Stand-in for the prebuilt littlefs library, for the modules that wrap
+ * its calls. It is not littlefs: the "file system" is a root pair in
+ * blocks 0 and 1 whose first word is the revision count, as on a real
+ * metadata pair, and lfs_mount() leaves lfs_t as the v2.1 lfs_mount()
+ * does on a freshly formatted disk. A commit erases the older block of
+ * the pair and programs it with the next revision; lfs_mkdir() commits,
+ * and so do lfs_file_sync() and lfs_file_close() of a written file. A
+ * file is one data block, erased by its first write, found again by name
+ * in a table of this file; an open file sits on mlist. lfs_crc() is the
+ * one of lfs_util.c. make fastmount_lfs LFS_SRC=... runs the fastmount
+ * checks on littlefs itself.
+ */
+
+#include <string.h>
+#include "lfs.h"
+#include "lfs_util.h"
+
+#define HOST_LFS_FILES      32
+
+static uint8_t hostLfsPage[4096];
+
+/* Name, data block and size of the files */
+static struct
+{
+    char        name[LFS_NAME_MAX + 1];
+    lfs_block_t block;
+    lfs_size_t  size;
+}hostLfsFile[HOST_LFS_FILES];
+static int hostLfsFiles;
+static lfs_block_t hostLfsNext;
+
+uint32_t lfs_crc(uint32_t crc, const void *buffer, size_t size)
+{
+    static const uint32_t rtable[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+        0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+    };
+    const uint8_t *data = buffer;
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        crc = (crc >> 4) ^ rtable[(crc ^ (data[i] >> 0)) & 0xf];
+        crc = (crc >> 4) ^ rtable[(crc ^ (data[i] >> 4)) & 0xf];
+    }
+    return crc;
+}
+
+static int hostLfsReadRev(const struct lfs_config *cfg, lfs_block_t block, uint32_t *rev)
+{
+    int err = cfg->read(cfg, block, 0, hostLfsPage, cfg->read_size);
+
+    memcpy(rev, hostLfsPage, sizeof(*rev));
+    return err;
+}
+
+static int hostLfsWriteRev(const struct lfs_config *cfg, lfs_block_t block, uint32_t rev)
+{
+    int err = cfg->erase(cfg, block);
+
+    memset(hostLfsPage, 0xFF, cfg->prog_size);
+    memcpy(hostLfsPage, &rev, sizeof(rev));
+    return err ? err : cfg->prog(cfg, block, 0, hostLfsPage, cfg->prog_size);
+}
+
+int lfs_format(lfs_t *lfs, const struct lfs_config *cfg)
+{
+    memset(lfs, 0, sizeof(*lfs));
+    memset(hostLfsFile, 0, sizeof(hostLfsFile));
+    hostLfsFiles = 0;
+    hostLfsNext = 2;
+    if (hostLfsWriteRev(cfg, 0, 1) || hostLfsWriteRev(cfg, 1, 2))
+        return LFS_ERR_IO;
+    return 0;
+}
+
+int lfs_mount(lfs_t *lfs, const struct lfs_config *cfg)
+{
+    uint32_t rev[2];
+
+    if (hostLfsReadRev(cfg, 0, &rev[0]) || hostLfsReadRev(cfg, 1, &rev[1]))
+        return LFS_ERR_IO;
+    if (rev[0] == 0xFFFFFFFF || rev[1] == 0xFFFFFFFF)
+        return LFS_ERR_CORRUPT;
+
+    memset(lfs, 0, sizeof(*lfs));
+    lfs->cfg = cfg;
+    lfs->rcache.buffer = cfg->read_buffer;
+    lfs->pcache.buffer = cfg->prog_buffer;
+    memset(lfs->rcache.buffer, 0xFF, cfg->cache_size);
+    memset(lfs->pcache.buffer, 0xFF, cfg->cache_size);
+    lfs->rcache.block = (lfs_block_t)-1;
+    lfs->pcache.block = (lfs_block_t)-1;
+    lfs->free.buffer = cfg->lookahead_buffer;
+    lfs->name_max = cfg->name_max ? cfg->name_max : LFS_NAME_MAX;
+    lfs->file_max = cfg->file_max ? cfg->file_max : LFS_FILE_MAX;
+    lfs->attr_max = cfg->attr_max ? cfg->attr_max : LFS_ATTR_MAX;
+
+    lfs->root[0] = 0;
+    lfs->root[1] = 1;
+    lfs->seed = lfs_crc(0, rev, sizeof(rev));
+    lfs->free.off = lfs->seed % cfg->block_size;
+    lfs->free.size = 0;
+    lfs->free.i = 0;
+    lfs->free.ack = cfg->block_count;
+    return 0;
+}
+
+int lfs_unmount(lfs_t *lfs)
+{
+    (void)lfs;
+    return 0;
+}
+
+/* A commit to the root pair: the older block becomes the newer */
+static int hostLfsCommit(lfs_t *lfs)
+{
+    uint32_t rev[2];
+
+    if (hostLfsReadRev(lfs->cfg, 0, &rev[0]) || hostLfsReadRev(lfs->cfg, 1, &rev[1]))
+        return LFS_ERR_IO;
+    if (rev[0] < rev[1])
+        return hostLfsWriteRev(lfs->cfg, 0, rev[1] + 1);
+    return hostLfsWriteRev(lfs->cfg, 1, rev[0] + 1);
+}
+
+int lfs_mkdir(lfs_t *lfs, const char *path)
+{
+    (void)path;
+    return hostLfsCommit(lfs);
+}
+
+int lfs_file_open(lfs_t *lfs, lfs_file_t *file, const char *path, int flags)
+{
+    int i;
+
+    for (i = 0; i < hostLfsFiles && strcmp(hostLfsFile[i].name, path) != 0; i++)
+        ;
+    if (i == hostLfsFiles)
+    {
+        if (!(flags & LFS_O_CREAT))
+            return LFS_ERR_NOENT;
+        if (i == HOST_LFS_FILES || strlen(path) > LFS_NAME_MAX)
+            return LFS_ERR_NOSPC;
+        strcpy(hostLfsFile[i].name, path);
+        hostLfsFile[i].block = (lfs_block_t)-1;
+        hostLfsFiles++;
+    }
+
+    memset(file, 0, sizeof(*file));
+    file->id = (uint16_t)i;
+    file->flags = (uint32_t)flags;
+    file->ctz.head = hostLfsFile[i].block;
+    file->ctz.size = (flags & LFS_O_TRUNC) ? 0 : hostLfsFile[i].size;
+    file->next = (lfs_file_t *)lfs->mlist;
+    lfs->mlist = (struct lfs_mlist *)file;
+    return 0;
+}
+
+lfs_ssize_t lfs_file_read(lfs_t *lfs, lfs_file_t *file, void *buffer, lfs_size_t size)
+{
+    if (file->pos >= file->ctz.size)
+        return 0;
+    if (size > file->ctz.size - file->pos)
+        size = file->ctz.size - file->pos;
+    if (lfs->cfg->read(lfs->cfg, file->ctz.head, file->pos, buffer, size))
+        return LFS_ERR_IO;
+    file->pos += size;
+    return (lfs_ssize_t)size;
+}
+
+/* The first write since open takes a new block; a rewrite of a file is not modelled */
+lfs_ssize_t lfs_file_write(lfs_t *lfs, lfs_file_t *file, const void *buffer, lfs_size_t size)
+{
+    const struct lfs_config *cfg = lfs->cfg;
+
+    if (file->pos + size > cfg->block_size)
+        return LFS_ERR_FBIG;
+    if (!(file->flags & LFS_F_WRITING))
+    {
+        file->ctz.head = hostLfsNext;
+        hostLfsNext = (hostLfsNext + 1 < cfg->block_count) ? hostLfsNext + 1 : 2;
+        if (cfg->erase(cfg, file->ctz.head))
+            return LFS_ERR_IO;
+        file->flags |= LFS_F_WRITING;
+    }
+    if (cfg->prog(cfg, file->ctz.head, file->pos, buffer, size))
+        return LFS_ERR_IO;
+    file->pos += size;
+    if (file->pos > file->ctz.size)
+        file->ctz.size = file->pos;
+    file->flags |= LFS_F_DIRTY;
+    return (lfs_ssize_t)size;
+}
+
+int lfs_file_sync(lfs_t *lfs, lfs_file_t *file)
+{
+    if (!(file->flags & LFS_F_DIRTY))
+        return 0;
+    hostLfsFile[file->id].block = file->ctz.head;
+    hostLfsFile[file->id].size = file->ctz.size;
+    file->flags &= ~LFS_F_DIRTY;
+    return hostLfsCommit(lfs);
+}
+
+int lfs_file_close(lfs_t *lfs, lfs_file_t *file)
+{
+    struct lfs_mlist **p;
+    int err = lfs_file_sync(lfs, file);
+
+    for (p = &lfs->mlist; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == (struct lfs_mlist *)file)
+        {
+            *p = (*p)->next;
+            break;
+        }
+    }
+    return err;
+}
@@ -0,0 +1,68 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * The library side of the lwIP and PS calls that mw_pcap.c wraps with
+ * -Wl,--wrap: the __real_ references of the wrappers land here, so a test
+ * linked that way sees both what was captured and what was passed on.
+ */
+
+#include "netfastpath.h"
+#include "tcpip.h"
+#include "host_netif.h"
+
+HostNetifCalls host_netif_calls;
+
+err_t TcpipPsInpkt(UINT8 lcid, DlPduBlock *pPduHdr, psif_input_fn ps_input_fn)
+{
+    (void)ps_input_fn;
+    host_netif_calls.psInpkt++;
+    host_netif_calls.lastCid = lcid;
+    host_netif_calls.lastDl = pPduHdr;
+    return ERR_OK;
+}
+
+struct netif *netif_add(struct netif *netif, const ip4_addr_t *ipaddr, const ip4_addr_t *netmask,
+                        const ip4_addr_t *gw, void *state, netif_init_fn init, netif_input_fn input)
+{
+    (void)ipaddr;
+    (void)netmask;
+    (void)gw;
+    host_netif_calls.netifAdd++;
+    netif->state = state;
+    netif->input = input;
+    if (init(netif) != ERR_OK)
+        return NULL;
+    return netif;
+}
+
+void NetifDlPkgFastPathIsr(UINT8 cid, UINT32 pkgNum, DlPduBlock *pDlHdr, DlPduBlock *pDlTail,
+                           NetifFastChkInfo *pChannelChkInfo)
+{
+    (void)pDlTail;
+    (void)pChannelChkInfo;
+    host_netif_calls.fastDl++;
+    host_netif_calls.lastCid = cid;
+    host_netif_calls.lastPkgNum = pkgNum;
+    host_netif_calls.lastDl = pDlHdr;
+}
+
+void NetifUlPkgFastPath(UINT8 lanType, UlPduBlock *pUlHdr, void *pUlChkInfo)
+{
+    (void)lanType;
+    (void)pUlChkInfo;
+    host_netif_calls.fastUl++;
+    host_netif_calls.lastUl = pUlHdr;
+}
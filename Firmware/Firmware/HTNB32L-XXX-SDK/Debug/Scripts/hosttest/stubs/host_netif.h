@@ -0,0 +1,21 @@
+#ifndef __HOST_NETIF_H__
+#define __HOST_NETIF_H__
+
+#include "netfastpath.h"
+
+/* Calls that reached the library side in host_netif.c */
+typedef struct
+{
+    unsigned long   psInpkt;
+    unsigned long   netifAdd;
+    unsigned long   fastDl;
+    unsigned long   fastUl;
+    UINT8           lastCid;
+    UINT32          lastPkgNum;
+    DlPduBlock      *lastDl;
+    UlPduBlock      *lastUl;
+}HostNetifCalls;
+
+extern HostNetifCalls host_netif_calls;
+
+#endif
@@ -0,0 +1,243 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * cmsis_os2 over pthreads, for the modules that run a task of their own.
+ * Linked ahead of the single-threaded versions in host_stubs.c, which are
+ * weak. Ticks are real milliseconds.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "cmsis_os2.h"
+#include "host_stubs.h"
+#include "host_os.h"
+
+typedef struct
+{
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+    uint32_t        count;
+    uint32_t        max;
+} HostSem;
+
+typedef struct
+{
+    osThreadFunc_t  func;
+    void            *arg;
+} HostThread;
+
+int host_os_fail = -1;
+unsigned long host_os_creates;
+unsigned host_os_create_us;
+
+static pthread_mutex_t hostKernel = PTHREAD_MUTEX_INITIALIZER;
+
+static int host_os_create(void)
+{
+    if (host_os_create_us != 0)
+        usleep(host_os_create_us);
+    if (host_os_fail >= 0 && host_os_fail-- == 0)
+        return 0;
+    host_os_creates++;
+    return 1;
+}
+
+/* Absolute CLOCK_REALTIME deadline ms from now, for the timed waits */
+static struct timespec host_os_deadline(uint32_t ms)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+uint32_t osKernelGetTickCount(void)
+{
+    return (uint32_t)(host_now() * 1000);
+}
+
+uint32_t osKernelGetTickFreq(void) { return 1000; }
+
+/* The scheduler lock only guards short sections, a global lock will do */
+int32_t osKernelLock(void)
+{
+    pthread_mutex_lock(&hostKernel);
+    return 0;
+}
+
+int32_t osKernelRestoreLock(int32_t lock)
+{
+    pthread_mutex_unlock(&hostKernel);
+    return lock;
+}
+
+osMutexId_t osMutexNew(const osMutexAttr_t *attr)
+{
+    pthread_mutexattr_t ma;
+    pthread_mutex_t *m;
+
+    if (!host_os_create())
+        return NULL;
+    m = malloc(sizeof(*m));
+    pthread_mutexattr_init(&ma);
+    if (attr != NULL && (attr->attr_bits & osMutexRecursive))
+        pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
+    else
+        pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_ERRORCHECK);
+    pthread_mutex_init(m, &ma);
+    pthread_mutexattr_destroy(&ma);
+    return m;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    struct timespec ts;
+
+    if (timeout == osWaitForever)
+    {
+        HOST_CHECK(pthread_mutex_lock(mutex_id) == 0);
+        return osOK;
+    }
+    ts = host_os_deadline(timeout);
+    return pthread_mutex_timedlock(mutex_id, &ts) == 0 ? osOK : osErrorTimeout;
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    /* Error checking: releasing a mutex the task does not hold fails */
+    HOST_CHECK(pthread_mutex_unlock(mutex_id) == 0);
+    return osOK;
+}
+
+osStatus_t osMutexDelete(osMutexId_t mutex_id)
+{
+    HOST_CHECK(pthread_mutex_destroy(mutex_id) == 0);
+    free(mutex_id);
+    return osOK;
+}
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr)
+{
+    HostSem *s;
+
+    (void)attr;
+    if (!host_os_create())
+        return NULL;
+    s = calloc(1, sizeof(*s));
+    pthread_mutex_init(&s->m, NULL);
+    pthread_cond_init(&s->c, NULL);
+    s->count = initial_count;
+    s->max = max_count;
+    return s;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+    HostSem *s = semaphore_id;
+    struct timespec ts = host_os_deadline(timeout == osWaitForever ? 0 : timeout);
+    osStatus_t ret = osErrorTimeout;
+    int err = 0;
+
+    pthread_mutex_lock(&s->m);
+    while (s->count == 0 && err == 0 && timeout != 0)
+    {
+        if (timeout == osWaitForever)
+            pthread_cond_wait(&s->c, &s->m);
+        else
+            err = pthread_cond_timedwait(&s->c, &s->m, &ts);
+    }
+    if (s->count > 0)
+    {
+        s->count--;
+        ret = osOK;
+    }
+    pthread_mutex_unlock(&s->m);
+    return (ret != osOK && timeout == 0) ? osErrorResource : ret;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+    HostSem *s = semaphore_id;
+    osStatus_t ret = osErrorResource;
+
+    pthread_mutex_lock(&s->m);
+    if (s->count < s->max)
+    {
+        s->count++;
+        pthread_cond_signal(&s->c);
+        ret = osOK;
+    }
+    pthread_mutex_unlock(&s->m);
+    return ret;
+}
+
+osStatus_t osSemaphoreDelete(osSemaphoreId_t semaphore_id)
+{
+    HostSem *s = semaphore_id;
+
+    pthread_cond_destroy(&s->c);
+    pthread_mutex_destroy(&s->m);
+    free(s);
+    return osOK;
+}
+
+static void *host_os_thread(void *p)
+{
+    HostThread t = *(HostThread *)p;
+
+    free(p);
+    t.func(t.arg);
+    return NULL;
+}
+
+/* The tasks never return: they run until the test exits */
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+    HostThread *t;
+    pthread_t id;
+
+    (void)attr;
+    if (!host_os_create())
+        return NULL;
+    t = malloc(sizeof(*t));
+    t->func = func;
+    t->arg = argument;
+    HOST_CHECK(pthread_create(&id, NULL, host_os_thread, t) == 0);
+    pthread_detach(id);
+    return (osThreadId_t)id;
+}
+
+osThreadId_t osThreadGetId(void)
+{
+    return (osThreadId_t)pthread_self();
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    usleep(ticks * 1000);
+    return osOK;
+}
@@ -0,0 +1,15 @@
+#ifndef __HOST_OS_H__
+#define __HOST_OS_H__
+
+/* >= 0: the osMutexNew(), osSemaphoreNew() or osThreadNew() call after
+ * that many more successful ones returns NULL, once */
+extern int host_os_fail;
+
+/* Object creations so far, to aim host_os_fail */
+extern unsigned long host_os_creates;
+
+/* Time each creation takes, 0 by default: widens the window in which a
+ * module is half started */
+extern unsigned host_os_create_us;
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * The mbedTLS SHA-256 calls of the middleware, for the host builds: the
+ * mbedTLS library of the SDK is prebuilt, so the hashing is done by the
+ * tinydtls sha2 code, with its state kept in the mbedTLS context.
+ */
+
+#include <string.h>
+#include "sha2.h"
+#include "mbedtls/sha256.h"
+
+static void hostShaLoad(dtls_sha256_ctx *d, const mbedtls_sha256_context *ctx)
+{
+    memcpy(d->state, ctx->state, sizeof(d->state));
+    d->bitcount = ((uint64_t)ctx->total[1] << 32) | ctx->total[0];
+    memcpy(d->buffer, ctx->buffer, sizeof(d->buffer));
+}
+
+static void hostShaStore(mbedtls_sha256_context *ctx, const dtls_sha256_ctx *d)
+{
+    memcpy(ctx->state, d->state, sizeof(ctx->state));
+    ctx->total[0] = (uint32_t)d->bitcount;
+    ctx->total[1] = (uint32_t)(d->bitcount >> 32);
+    memcpy(ctx->buffer, d->buffer, sizeof(ctx->buffer));
+}
+
+void mbedtls_sha256_init(mbedtls_sha256_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_sha256_starts_ret(mbedtls_sha256_context *ctx, int is224)
+{
+    dtls_sha256_ctx d;
+
+    if (is224)
+        return -1;
+    dtls_sha256_init(&d);
+    hostShaStore(ctx, &d);
+    return 0;
+}
+
+int mbedtls_sha256_update_ret(mbedtls_sha256_context *ctx, const unsigned char *input, size_t ilen)
+{
+    dtls_sha256_ctx d;
+
+    hostShaLoad(&d, ctx);
+    dtls_sha256_update(&d, input, ilen);
+    hostShaStore(ctx, &d);
+    return 0;
+}
+
+int mbedtls_sha256_finish_ret(mbedtls_sha256_context *ctx, unsigned char output[32])
+{
+    dtls_sha256_ctx d;
+
+    hostShaLoad(&d, ctx);
+    dtls_sha256_final(output, &d);
+    hostShaStore(ctx, &d);
+    return 0;
+}
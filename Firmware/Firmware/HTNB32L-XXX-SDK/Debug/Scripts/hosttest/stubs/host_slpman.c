@@ -0,0 +1,66 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* The sleep manager calls behind slpman_qcx212.h, see host_slpman.h */
+
+#include <stddef.h>
+#include "host_slpman.h"
+
+#define HOST_SLP_MAX_CB     8
+
+static struct
+{
+    slpManBackupCb_t    cb;
+    void                *pdata;
+    slpManLpState       state;
+}hostSlpCb[HOST_SLP_MAX_CB];
+
+slpManSlpState_t host_slp_last = SLP_ACTIVE_STATE;
+int host_slp_registered;
+
+slpManRet_t slpManRegisterUsrdefinedBackupCb(slpManBackupCb_t backup_cb, void *pdata, slpManLpState state)
+{
+    int i;
+
+    for (i = 0; i < host_slp_registered; i++)
+    {
+        if (hostSlpCb[i].cb == backup_cb)
+            return RET_CALLBACK_EXIST;
+    }
+    if (host_slp_registered == HOST_SLP_MAX_CB)
+        return RET_CB_ARRAY_FULL;
+    hostSlpCb[host_slp_registered].cb = backup_cb;
+    hostSlpCb[host_slp_registered].pdata = pdata;
+    hostSlpCb[host_slp_registered].state = state;
+    host_slp_registered++;
+    return RET_TRUE;
+}
+
+slpManSlpState_t slpManGetLastSlpState(void)
+{
+    return host_slp_last;
+}
+
+void host_slp_hibernate(void)
+{
+    int i;
+
+    for (i = 0; i < host_slp_registered; i++)
+    {
+        if (hostSlpCb[i].state == SLPMAN_HIBERNATE_STATE)
+            hostSlpCb[i].cb(hostSlpCb[i].pdata, SLPMAN_HIBERNATE_STATE);
+    }
+    host_slp_last = SLP_HIB_STATE;
+}
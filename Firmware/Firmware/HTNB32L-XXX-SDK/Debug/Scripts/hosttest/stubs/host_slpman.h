@@ -0,0 +1,16 @@
+#ifndef __HOST_SLPMAN_H__
+#define __HOST_SLPMAN_H__
+
+#include "slpman_qcx212.h"
+
+/* What slpManGetLastSlpState() reports, SLP_ACTIVE_STATE: a cold boot */
+extern slpManSlpState_t host_slp_last;
+
+/* Backup callbacks registered so far */
+extern int host_slp_registered;
+
+/* Run the hibernate backup callbacks, as the idle task does before power
+ * down, and make the next boot a wake from hibernate */
+void host_slp_hibernate(void);
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Single-threaded host versions of the OS calls the middleware modules use */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <time.h>
+#include "qurt_os.h"
+#include "cmsis_os2.h"
+#include "host_stubs.h"
+
+uint32_t host_ms;                       //clock of the OS stubs, moved by the tests
+uint32_t SystemCoreClock = 100000000;   //rate of the DWT stand-in in host_device.h
+
+int qurt_mutex_lock(qurt_mutex_t *m) { (void)m; return QURT_EOK; }
+int qurt_mutex_unlock(qurt_mutex_t *m) { (void)m; return QURT_EOK; }
+int qurt_mutex_create(qurt_mutex_t *m) { (void)m; return QURT_EOK; }
+void qurt_mutex_delete(qurt_mutex_t *m) { (void)m; }
+void qurt_mutex_init(qurt_mutex_t *m) { (void)m; }
+void qurt_mutex_destroy(qurt_mutex_t *m) { (void)m; }
+
+/* Weak: the tests that run tasks link stubs/host_os.c instead */
+#define HOST_WEAK __attribute__((weak))
+
+HOST_WEAK uint32_t osKernelGetTickCount(void) { return host_ms; }
+HOST_WEAK uint32_t osKernelGetTickFreq(void) { return 1000; }
+
+HOST_WEAK osMutexId_t osMutexNew(const osMutexAttr_t *attr) { static int m; (void)attr; return &m; }
+HOST_WEAK osStatus_t osMutexAcquire(osMutexId_t m, uint32_t timeout) { (void)m; (void)timeout; return osOK; }
+HOST_WEAK osStatus_t osMutexRelease(osMutexId_t m) { (void)m; return osOK; }
+HOST_WEAK osStatus_t osMutexDelete(osMutexId_t m) { (void)m; return osOK; }
+HOST_WEAK int32_t osKernelLock(void) { return 0; }
+HOST_WEAK int32_t osKernelRestoreLock(int32_t lock) { return lock; }
+HOST_WEAK osStatus_t osDelay(uint32_t ticks) { host_ms += ticks; return osOK; }
+
+/* Unilog dumps, see debug_log.h; the tests that read them override this */
+HOST_WEAK void host_log_dump(const char *id, uint32_t len, const uint8_t *data) { (void)id; (void)len; (void)data; }
+
+time_t OsaSystemTimeReadSecs(void) { return (time_t)(host_ms / 1000); }
+
+qurt_time_t qurt_timer_convert_time_to_ticks(qurt_time_t t, qurt_time_unit_t unit) { (void)unit; return t; }
+
+void iot_log_print(uint32_t mask, uint8_t argnum, const char *fmt, ...) { (void)mask; (void)argnum; (void)fmt; }
+
+double host_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,22 @@
+#ifndef __HOST_STUBS_H__
+#define __HOST_STUBS_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+extern uint32_t host_ms;
+
+/* Monotonic seconds, for the benchmarks */
+double host_now(void);
+
+#define HOST_CHECK(cond)                                                        \
+    do {                                                                        \
+        if (!(cond))                                                            \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                            \
+        }                                                                       \
+    } while (0)
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef IOTAPP_LOG_H
+#define IOTAPP_LOG_H
+#include <stdint.h>
+#define MSG_LEGACY_HIGH 1
+#define MSG_LEGACY_LOW 2
+#define MSG_LEGACY_ERROR 3
+#define VAR_NARG(...) 0
+void iot_log_print(uint32_t mask, uint8_t argnum, const char *fmt, ...);
+#define iotapp_log(file, line, mask, number, format, ...) iot_log_print(mask, number, format, ##__VA_ARGS__)
+#define IOTAPP_LOG_ERR(format, ...) iot_log_print(3, 0, format, ##__VA_ARGS__)
+#define IOTAPP_LOG_INFO(format,...) iot_log_print(2, 0, format, ##__VA_ARGS__)
+#define LOG_ERR(format,...) iot_log_print(3, 0, format, ##__VA_ARGS__)
+#endif
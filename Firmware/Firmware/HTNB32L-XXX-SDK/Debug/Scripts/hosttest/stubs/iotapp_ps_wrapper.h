@@ -0,0 +1,21 @@
+#ifndef IOTAPP_PS_WRAPPER_STUB_H
+#define IOTAPP_PS_WRAPPER_STUB_H
+
+/* Host stand-in for iotapp_ps_wrapper.h: what liblwm2m.h uses of it,
+ * without the protocol stack API behind it */
+
+#include <stdint.h>
+
+#define PS_MAX_APN_LEN                   100
+#define PS_MAX_AUTH_STR_LEN              20
+#define DATA_CALL_INFO_APN_MAX_LEN       PS_MAX_APN_LEN
+#define DATA_CALL_INFO_USERNAME_MAX_LEN  PS_MAX_AUTH_STR_LEN
+#define DATA_CALL_INFO_PASSWORD_MAX_LEN  PS_MAX_AUTH_STR_LEN
+
+typedef struct {
+  uint8_t network_type;
+  uint8_t lte_mode;
+  uint8_t ciot_mode;
+} network_bearer_t;
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __IP_ADDR_H__
+#define __IP_ADDR_H__
+
+/* Host stand-in for lwIP's ip_addr.h: the IPv4 calls mw_dns.c uses, and
+ * the address types of the netif output functions */
+
+#include <stdint.h>
+#include <arpa/inet.h>
+
+typedef struct ip_addr
+{
+    uint32_t addr;
+}ip_addr_t;
+
+typedef ip_addr_t ip4_addr_t;
+
+typedef struct ip6_addr
+{
+    uint32_t addr[4];
+}ip6_addr_t;
+
+#define ip_addr_copy(dest, src)     ((dest).addr = (src).addr)
+#define ip_addr_cmp(addr1, addr2)   ((addr1)->addr == (addr2)->addr)
+#define ipaddr_aton(cp, ip)         inet_pton(AF_INET, (cp), &(ip)->addr)
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* The lwm2m_data_t helpers of the prebuilt LwM2M core (data.c), as in
+ * Wakaama, for the codecs built on the host */
+
+#include <stdlib.h>
+#include <string.h>
+#include "liblwm2m.h"
+
+void *lwm2m_malloc(size_t s)
+{
+    return malloc(s);
+}
+
+void lwm2m_free(void *p)
+{
+    free(p);
+}
+
+char *lwm2m_strdup(const char *str)
+{
+    return (str == NULL) ? NULL : strdup(str);
+}
+
+/* Behind LWM2M_STRCPY, see qurt_os.h */
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+
+    if (size != 0)
+    {
+        size_t n = (len < size) ? len : size - 1;
+
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+lwm2m_data_t *lwm2m_data_new(int size)
+{
+    return (size <= 0) ? NULL : (lwm2m_data_t *)calloc(size, sizeof(lwm2m_data_t));
+}
+
+void lwm2m_data_free(int size, lwm2m_data_t *dataP)
+{
+    int i;
+
+    if (size == 0 || dataP == NULL)
+        return;
+
+    for (i = 0; i < size; i++)
+    {
+        switch (dataP[i].type)
+        {
+            case LWM2M_TYPE_MULTIPLE_RESOURCE:
+            case LWM2M_TYPE_OBJECT_INSTANCE:
+            case LWM2M_TYPE_OBJECT:
+                lwm2m_data_free((int)dataP[i].value.asChildren.count, dataP[i].value.asChildren.array);
+                break;
+            case LWM2M_TYPE_STRING:
+            case LWM2M_TYPE_OPAQUE:
+                free(dataP[i].value.asBuffer.buffer);
+                break;
+            default:
+                break;
+        }
+    }
+    free(dataP);
+}
+
+void lwm2m_data_encode_nstring(const char *string, size_t length, lwm2m_data_t *dataP)
+{
+    dataP->type = LWM2M_TYPE_STRING;
+    dataP->value.asBuffer.length = length;
+    dataP->value.asBuffer.buffer = NULL;
+    if (length != 0)
+    {
+        dataP->value.asBuffer.buffer = (uint8_t *)malloc(length);
+        memcpy(dataP->value.asBuffer.buffer, string, length);
+    }
+}
+
+void lwm2m_data_encode_string(const char *string, lwm2m_data_t *dataP)
+{
+    lwm2m_data_encode_nstring(string, (string == NULL) ? 0 : strlen(string), dataP);
+}
+
+void lwm2m_data_encode_opaque(uint8_t *buffer, size_t length, lwm2m_data_t *dataP)
+{
+    lwm2m_data_encode_nstring((const char *)buffer, length, dataP);
+    dataP->type = LWM2M_TYPE_OPAQUE;
+}
+
+void lwm2m_data_encode_int(int64_t value, lwm2m_data_t *dataP)
+{
+    dataP->type = LWM2M_TYPE_INTEGER;
+    dataP->value.asInteger = value;
+}
+
+void lwm2m_data_encode_float(double value, lwm2m_data_t *dataP)
+{
+    dataP->type = LWM2M_TYPE_FLOAT;
+    dataP->value.asFloat = value;
+}
+
+void lwm2m_data_encode_bool(bool value, lwm2m_data_t *dataP)
+{
+    dataP->type = LWM2M_TYPE_BOOLEAN;
+    dataP->value.asBoolean = value;
+}
+
+void lwm2m_data_encode_objLink(objlink_t value, lwm2m_data_t *dataP)
+{
+    dataP->type = LWM2M_TYPE_OBJECT_LINK;
+    dataP->value.asObjLink = value;
+}
+
+void lwm2m_data_encode_instances(lwm2m_data_t *subDataP, size_t count, lwm2m_data_t *dataP)
+{
+    dataP->type = LWM2M_TYPE_MULTIPLE_RESOURCE;
+    dataP->value.asChildren.count = count;
+    dataP->value.asChildren.array = subDataP;
+}
+
+/* list.c: lists are kept sorted by id */
+lwm2m_list_t *lwm2m_list_add(lwm2m_list_t *head, lwm2m_list_t *node)
+{
+    lwm2m_list_t *target;
+
+    if (head == NULL)
+        return node;
+
+    if (head->id > node->id)
+    {
+        node->next = head;
+        return node;
+    }
+
+    target = head;
+    while (target->next != NULL && target->next->id < node->id)
+        target = target->next;
+
+    node->next = target->next;
+    target->next = node;
+    return head;
+}
+
+lwm2m_list_t *lwm2m_list_find(lwm2m_list_t *head, uint16_t id)
+{
+    while (head != NULL && head->id < id)
+        head = head->next;
+
+    return (head != NULL && head->id == id) ? head : NULL;
+}
+
+lwm2m_list_t *lwm2m_list_remove(lwm2m_list_t *head, uint16_t id, lwm2m_list_t **nodeP)
+{
+    lwm2m_list_t *target;
+
+    if (head == NULL)
+    {
+        if (nodeP)
+            *nodeP = NULL;
+        return NULL;
+    }
+
+    if (head->id == id)
+    {
+        if (nodeP)
+            *nodeP = head;
+        return head->next;
+    }
+
+    target = head;
+    while (target->next != NULL && target->next->id < id)
+        target = target->next;
+
+    if (target->next != NULL && target->next->id == id)
+    {
+        if (nodeP)
+            *nodeP = target->next;
+        target->next = target->next->next;
+    }
+    else if (nodeP)
+    {
+        *nodeP = NULL;
+    }
+    return head;
+}
+
+uint16_t lwm2m_list_newId(lwm2m_list_t *head)
+{
+    uint16_t id = 0;
+
+    while (head != NULL && id == head->id)
+    {
+        id = head->id + 1;
+        head = head->next;
+    }
+    return id;
+}
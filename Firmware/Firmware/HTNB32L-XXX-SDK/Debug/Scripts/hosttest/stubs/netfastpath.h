@@ -0,0 +1,27 @@
+#ifndef __NET_FAST_PATH_H__
+#define __NET_FAST_PATH_H__
+
+/* Host stand-in for netfastpath.h: the PS/LAN forwarding calls and the
+ * uplink block fields the mw_pcap.c wrappers touch */
+
+#include "netif.h"
+
+typedef struct UlPduBlock_Tag
+{
+    UINT8                   bContinue;      //next block is the same IP packet
+    UINT8                   validOffset;
+    UINT16                  length;
+    UINT8                   *ptr;
+    struct UlPduBlock_Tag   *pNext;
+}UlPduBlock;
+
+typedef struct NetifFastChkInfo_Tag
+{
+    UINT32  reserved;
+}NetifFastChkInfo;
+
+void NetifDlPkgFastPathIsr(UINT8 cid, UINT32 pkgNum, DlPduBlock *pDlHdr, DlPduBlock *pDlTail,
+                           NetifFastChkInfo *pChannelChkInfo);
+void NetifUlPkgFastPath(UINT8 lanType, UlPduBlock *pUlHdr, void *pUlChkInfo);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef __NETIF_H__
+#define __NETIF_H__
+
+/* Host stand-in for lwIP's netif.h and pbuf.h, with the PS downlink block:
+ * the fields the mw_pcap.c wrappers touch */
+
+#include "commontypedef.h"
+#include "api.h"
+
+#define LWIP_IPV4                   1
+#define LWIP_IPV6                   1
+
+#define ERR_IF                      -12
+
+struct pbuf
+{
+    struct pbuf     *next;
+    void            *payload;
+    UINT16          tot_len;
+    UINT16          len;
+};
+
+typedef struct DlPduBlock_Tag
+{
+    UINT16                  length;
+    UINT8                   bRohcFeedback;
+    UINT8                   *pPdu;
+    struct DlPduBlock_Tag   *pNext;
+}DlPduBlock;
+
+struct netif;
+
+typedef err_t (*netif_init_fn)(struct netif *netif);
+typedef err_t (*netif_input_fn)(struct pbuf *p, struct netif *inp);
+typedef err_t (*netif_output_fn)(struct netif *netif, struct pbuf *p, const ip4_addr_t *ipaddr);
+typedef err_t (*netif_output_ip6_fn)(struct netif *netif, struct pbuf *p, const ip6_addr_t *ipaddr);
+typedef err_t (*psif_input_fn)(UINT8 lcid, DlPduBlock *pPduHdr);
+
+struct netif
+{
+    netif_output_fn         output;
+    netif_output_ip6_fn     output_ip6;
+    netif_input_fn          input;
+    void                    *state;
+    UINT8                   primary_ipv4_cid;
+    UINT8                   primary_ipv6_cid;
+};
+
+struct netif *netif_add(struct netif *netif, const ip4_addr_t *ipaddr, const ip4_addr_t *netmask,
+                        const ip4_addr_t *gw, void *state, netif_init_fn init, netif_input_fn input);
+
+#endif
@@ -0,0 +1 @@
+/* Host stand-in for offtarget_stubs.h, included by er-coap-13.h */
@@ -0,0 +1,6 @@
+#ifndef __OS_EXCEPTION_H__
+#define __OS_EXCEPTION_H__
+
+/* Host stand-in: lfs_util.h includes it, nothing of it is used */
+
+#endif
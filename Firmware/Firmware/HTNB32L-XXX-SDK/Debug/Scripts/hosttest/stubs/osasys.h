@@ -0,0 +1,24 @@
+#ifndef _OSASYS_H
+#define _OSASYS_H
+
+/* Host stand-in for osasys.h: the calls of the middleware flash modules,
+ * and the file calls, which the tests that use them supply */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define OsaAllocMemory(S)       malloc((S))
+#define OsaFreeMemory(pPtr)     do { free(*(pPtr)); *(pPtr) = NULL; } while (0)
+
+time_t OsaSystemTimeReadSecs(void);
+
+typedef void *OSAFILE;
+
+uint8_t OsaCalcCrcValue(const uint8_t *dataBuf, uint16_t bufSize);
+OSAFILE OsaFopen(const char *fileName, const char *mode);
+int32_t OsaFclose(OSAFILE fp);
+uint32_t OsaFread(void *buf, uint32_t size, uint32_t count, OSAFILE fp);
+uint32_t OsaFwrite(void *buf, uint32_t size, uint32_t count, OSAFILE fp);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef __HOST_POSIX_SOCKETS_H__
+#define __HOST_POSIX_SOCKETS_H__
+
+/* lwIP's BSD socket calls mapped onto the host's, for the modules that
+ * only use the sockets API */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define lwip_socket         socket
+#define lwip_bind           bind
+#define lwip_getsockname    getsockname
+#define lwip_sendto         sendto
+#define lwip_recv           recv
+#define lwip_close          close
+#define lwip_select         select
+#define lwip_fcntl          fcntl
+
+#define PP_HTONL(x)         htonl(x)
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef QAPI_MBEDTLS_H_
+#define QAPI_MBEDTLS_H_
+
+/* Host stand-in for qapi_mbedtls.h, the CoAP headers only hold pointers */
+
+typedef struct __SSL_Config_s SSL_Config_t;
+
+typedef const void * qapi_Net_SSL_Cert_t;
+typedef const void * qapi_Net_SSL_DICERT_t;
+typedef const void * qapi_Net_SSL_CAList_t;
+typedef const void * qapi_Net_SSL_PSKTable_t;
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef __QC_TCPIP_API_H__
+#define __QC_TCPIP_API_H__
+
+/* Host stand-in: the one call of mw_uplink.c, defined by its test */
+
+#include "commontypedef.h"
+
+INT32 tcpipConnectionSend(INT32 connectionId, UINT8 *data, UINT16 dataLen, UINT8 raiInfo, UINT8 expectFlag, UINT8 sequence);
+
+#endif
@@ -0,0 +1,34 @@
+/* Host stand-in for qurt_fs.h: the efs calls on the in-memory files of
+ * host_fs.c, see host_fs.h */
+#ifndef _QURT_FS_H
+#define _QURT_FS_H
+
+#include <stdint.h>
+
+#define O_RDONLY             0x0001
+#define O_WRONLY             0x0002
+#define O_RDWR               0x0003
+#define O_CREAT              0x0100
+#define O_EXCL               0x0200
+#define O_TRUNC              0x0400
+#define O_APPEND             0x0800
+
+/* The target takes these from lfs.h through lfs_port.h */
+#ifndef LFS_H
+#define LFS_SEEK_SET         0
+#define LFS_SEEK_CUR         1
+#define LFS_SEEK_END         2
+#endif
+
+typedef int32_t fs_ssize_t;
+typedef uint32_t fs_size_t;
+typedef int32_t fs_off_t;
+
+int efs_open(const char *path, int oflag, ...);
+fs_ssize_t efs_read(int filedes, void *buf, fs_size_t nbyte);
+fs_ssize_t efs_write(int filedes, const void *buf, fs_size_t nbyte);
+fs_off_t efs_lseek(int filedes, fs_off_t offset, int whence);
+int efs_close(int filedes);
+int efs_unlink(const char *path);
+
+#endif
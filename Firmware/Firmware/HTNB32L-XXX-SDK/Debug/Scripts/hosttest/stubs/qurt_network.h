@@ -0,0 +1,12 @@
+#ifndef _QURT_NETWORK_H
+#define _QURT_NETWORK_H
+
+/* Host stand-in for qurt_network.h: the socket types from the C library
+ * instead of lwIP */
+
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "commontypedef.h"
+
+#endif
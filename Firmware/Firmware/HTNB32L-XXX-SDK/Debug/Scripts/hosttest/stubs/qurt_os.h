@@ -0,0 +1,30 @@
+#ifndef _QURT_OS_H
+#define _QURT_OS_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#define boolean bool
+typedef void *qurt_mutex_t; typedef void *qurt_signal_t; typedef void *qurt_thread_t; typedef uint32_t qurt_time_t;
+#define QURT_EOK 0
+#define QURT_EFAILED -1
+#define QURT_TIME_WAIT_FOREVER 0xFFFFFFFFu
+#define QURT_SIGNAL_ATTR_WAIT_ANY 0
+#define QURT_SIGNAL_ATTR_CLEAR_MASK 4
+int qurt_mutex_lock(qurt_mutex_t*); int qurt_mutex_unlock(qurt_mutex_t*);
+int qurt_mutex_create(qurt_mutex_t*); void qurt_mutex_delete(qurt_mutex_t*);
+uint32_t qurt_signal_wait(qurt_signal_t*, uint32_t, uint32_t); void qurt_signal_set(qurt_signal_t*, uint32_t);
+int qurt_signal_create(qurt_signal_t*); void qurt_signal_delete(qurt_signal_t*);
+void qurt_signal_clear(qurt_signal_t*, uint32_t);
+uint32_t qurt_timer_get_ticks(void);
+typedef enum { QURT_TIME_TICK, QURT_TIME_USEC, QURT_TIME_MSEC, QURT_TIME_SEC } qurt_time_unit_t;
+#define QURT_TIME_NO_WAIT 0
+void qurt_mutex_init(qurt_mutex_t*); void qurt_mutex_destroy(qurt_mutex_t*);
+qurt_time_t qurt_timer_convert_time_to_ticks(qurt_time_t, qurt_time_unit_t);
+uint32_t osKernelGetTickCount(void); uint32_t osKernelGetTickFreq(void);
+uint32_t qurt_signal_wait_timed_ext(qurt_signal_t*, uint32_t, uint32_t, uint32_t*, qurt_time_t);
+uint32_t time_get_secs(void);
+/* LWM2M_STRCPY of platform.h, in the target libc but only in glibc >= 2.38 */
+size_t strlcpy(char *dst, const char *src, size_t size);
+typedef void * timer_type; typedef void * timer_cb_data_type; typedef timer_type * timer_ptr_type;
+#endif
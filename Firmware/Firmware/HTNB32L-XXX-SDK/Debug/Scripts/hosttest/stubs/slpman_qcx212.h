@@ -0,0 +1,39 @@
+#ifndef SLPMAN_QCX212_H
+#define SLPMAN_QCX212_H
+
+/* Host stand-in for slpman_qcx212.h: the backup callbacks and the last
+ * sleep state, run by host_slpman.c */
+
+typedef enum
+{
+    SLPMAN_INVALID_STATE = 0,
+    SLPMAN_SLEEP1_STATE,
+    SLPMAN_SLEEP2_STATE,
+    SLPMAN_HIBERNATE_STATE,
+    MAX_SLEEP_STATE,
+}slpManLpState;
+
+typedef enum
+{
+    SLP_ACTIVE_STATE = 0,
+    SLP_IDLE_STATE,
+    SLP_SLP1_STATE,
+    SLP_SLP2_STATE,
+    SLP_HIB_STATE,
+    SLP_STATE_MAX
+}slpManSlpState_t;
+
+typedef enum
+{
+    RET_TRUE,
+    RET_UNKNOW_FALSE,
+    RET_CB_ARRAY_FULL,
+    RET_CALLBACK_EXIST,
+}slpManRet_t;
+
+typedef void(* slpManBackupCb_t)(void *pdata, slpManLpState state);
+
+slpManRet_t slpManRegisterUsrdefinedBackupCb(slpManBackupCb_t backup_cb, void *pdata, slpManLpState state);
+slpManSlpState_t slpManGetLastSlpState(void);
+
+#endif
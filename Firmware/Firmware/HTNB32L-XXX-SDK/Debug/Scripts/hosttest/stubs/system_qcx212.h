@@ -0,0 +1,13 @@
+#ifndef SYSTEM_CATERPILLER_H
+#define SYSTEM_CATERPILLER_H
+
+#include <stdint.h>
+
+/* Set by host_stubs.c to the rate of the DWT stand-in in host_device.h */
+extern uint32_t SystemCoreClock;
+
+/* One thread, no interrupts: the tests that need a lock use host_os.c */
+static inline uint32_t SaveAndSetIRQMask(void) { return 0; }
+static inline void RestoreIRQMask(uint32_t mask) { (void)mask; }
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef __TCPIP_H__
+#define __TCPIP_H__
+
+/* Host stand-in for lwIP's tcpip.h: the PS downlink entry */
+
+#include "netif.h"
+
+err_t TcpipPsInpkt(UINT8 lcid, DlPduBlock *pPduHdr, psif_input_fn ps_input_fn);
+
+#endif
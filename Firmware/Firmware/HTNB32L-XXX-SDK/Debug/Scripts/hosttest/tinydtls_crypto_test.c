@@ -0,0 +1,317 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * The tinydtls fast crypto kernels (aes/rijndael_fast.c, sha2/sha2_fast.c,
+ * ecc/ecc_fast.c) on the host against published vectors: FIPS-197 for
+ * AES-128, FIPS 180-2 for SHA-256 and RFC 6979 A.2.5 for P-256 ECDSA, plus
+ * ECDH agreement and rejection of tampered signatures. "bench" times one
+ * AES block, one SHA-256 byte and the P-256 operations.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "host_stubs.h"
+#include "rijndael.h"
+#include "sha2.h"
+#include "ecc.h"
+
+static void fromHex(const char *hex, uint8_t *out, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        unsigned v;
+        sscanf(hex + 2 * i, "%2x", &v);
+        out[i] = (uint8_t)v;
+    }
+}
+
+/* big endian hex to the 8 little endian words ecc.h works with */
+static void toWords(const char *hex, uint32_t w[8])
+{
+    uint8_t b[32];
+    int i;
+
+    fromHex(hex, b, 32);
+    for (i = 0; i < 8; i++)
+        w[i] = ((uint32_t)b[31 - 4 * i]) | ((uint32_t)b[30 - 4 * i] << 8) |
+               ((uint32_t)b[29 - 4 * i] << 16) | ((uint32_t)b[28 - 4 * i] << 24);
+}
+
+static void toWordsFromBytes(const uint8_t b[32], uint32_t w[8])
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+        w[i] = ((uint32_t)b[31 - 4 * i]) | ((uint32_t)b[30 - 4 * i] << 8) |
+               ((uint32_t)b[29 - 4 * i] << 16) | ((uint32_t)b[28 - 4 * i] << 24);
+}
+
+static bool sameHex(const uint8_t *b, const char *hex, size_t len)
+{
+    uint8_t e[64];
+
+    fromHex(hex, e, len);
+    return memcmp(b, e, len) == 0;
+}
+
+static void testAes(void)
+{
+    static const struct { const char *key, *pt, *ct; } v[] =
+    {
+        /* FIPS-197 Appendix B */
+        { "2b7e151628aed2a6abf7158809cf4f3c", "3243f6a8885a308d313198a2e0370734", "3925841d02dc09fbdc118597196a0b32" },
+        /* FIPS-197 Appendix C.1 */
+        { "000102030405060708090a0b0c0d0e0f", "00112233445566778899aabbccddeeff", "69c4e0d86a7b0430d8cdb78070b4c55a" },
+    };
+    rijndael_ctx ctx;
+    uint8_t key[16], pt[16], ct[16];
+    unsigned i;
+
+    for (i = 0; i < sizeof(v) / sizeof(v[0]); i++)
+    {
+        fromHex(v[i].key, key, 16);
+        fromHex(v[i].pt, pt, 16);
+        HOST_CHECK(rijndael_set_key_enc_only(&ctx, key, 128) == 0);
+        rijndael_encrypt(&ctx, pt, ct);
+        HOST_CHECK(sameHex(ct, v[i].ct, 16));
+
+        /* in place, as the CCM code calls it */
+        rijndael_encrypt(&ctx, pt, pt);
+        HOST_CHECK(memcmp(pt, ct, 16) == 0);
+    }
+
+    /* the context only holds an AES-128 schedule */
+    HOST_CHECK(rijndael_set_key_enc_only(&ctx, key, 256) == -1);
+    printf("aes: FIPS-197 B and C.1 equal\n");
+}
+
+static void sha256(const void *data, size_t len, uint8_t digest[32])
+{
+    dtls_sha256_ctx ctx;
+
+    dtls_sha256_init(&ctx);
+    dtls_sha256_update(&ctx, (const uint8_t *)data, len);
+    dtls_sha256_final(digest, &ctx);
+}
+
+static void testSha256(void)
+{
+    static const char twoBlocks[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    static uint8_t buf[1000];
+    dtls_sha256_ctx ctx;
+    uint8_t d[32], d2[32];
+    char str[DTLS_SHA256_DIGEST_STRING_LENGTH];
+    size_t len, pos, n;
+    int i;
+
+    sha256("", 0, d);
+    HOST_CHECK(sameHex(d, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", 32));
+    sha256("abc", 3, d);
+    HOST_CHECK(sameHex(d, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", 32));
+    sha256(twoBlocks, strlen(twoBlocks), d);
+    HOST_CHECK(sameHex(d, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", 32));
+    HOST_CHECK(strcmp(dtls_sha256_data((const uint8_t *)"abc", 3, str),
+                      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad") == 0);
+
+    /* one million 'a', in odd sized pieces */
+    memset(buf, 'a', sizeof(buf));
+    dtls_sha256_init(&ctx);
+    for (pos = 0; pos < 1000000; pos += n)
+    {
+        n = 1 + (pos * 7) % 997;
+        if (n > 1000000 - pos)
+            n = 1000000 - pos;
+        dtls_sha256_update(&ctx, buf, n);
+    }
+    dtls_sha256_final(d, &ctx);
+    HOST_CHECK(sameHex(d, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", 32));
+
+    /* every length around the block and padding boundaries, split updates
+     * equal to one-shot */
+    srand(34);
+    for (i = 0; i < (int)sizeof(buf); i++)
+        buf[i] = (uint8_t)rand();
+    for (len = 0; len <= 300; len++)
+    {
+        sha256(buf, len, d);
+        dtls_sha256_init(&ctx);
+        for (pos = 0; pos < len; pos += n)
+        {
+            n = 1 + rand() % 70;
+            if (n > len - pos)
+                n = len - pos;
+            dtls_sha256_update(&ctx, buf + pos, n);
+        }
+        dtls_sha256_final(d2, &ctx);
+        HOST_CHECK(memcmp(d, d2, 32) == 0);
+    }
+    printf("sha256: FIPS 180-2 vectors equal, split updates of 0..300 bytes equal\n");
+}
+
+/* RFC 6979 A.2.5, P-256 with SHA-256, message "sample" */
+static const char *rfcD  = "C9AFA9D845BA75166B5C215767B1D6934E50C3DB36E89B127B8A622B120F6721";
+static const char *rfcUx = "60FED4BA255A9D31C961EB74C6356D68C049B8923B61FA6CE669622E60F29FB6";
+static const char *rfcUy = "7903FE1008B8BC99A41AE9E95628BC64F2F1B20C2D7E9F5177A3C294D4462299";
+static const char *rfcK  = "A6E3C57DD01ABE90086538398355DD4C3B17AA873382B0F24D6129493D8AAD60";
+static const char *rfcR  = "EFD48B2AACB6A8FD1140DD9CD45E81D69D2C877B56AAF991C34D0EA84EAF3716";
+static const char *rfcS  = "F7CB1C942D657C41D436C7A1B6E29F65F3E900DBB9AFF4064DC4AB2F843ACDA8";
+
+static const char *orderN  = "FFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551";
+static const char *orderN1 = "FFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632550";
+
+static void testP256(void)
+{
+    uint32_t d[8], ux[8], uy[8], k[8], r[8], s[8], e[8];
+    uint32_t x[8], y[8], rr[8], ss[8], zero[8];
+    uint32_t d2[8], ax[8], ay[8], bx[8], by[8], p1x[8], p1y[8], p2x[8], p2y[8];
+    uint8_t hash[32];
+    int i, bit;
+
+    toWords(rfcD, d);
+    toWords(rfcUx, ux);
+    toWords(rfcUy, uy);
+    toWords(rfcK, k);
+    toWords(rfcR, r);
+    toWords(rfcS, s);
+    sha256("sample", 6, hash);
+    toWordsFromBytes(hash, e);
+
+    ecc_gen_pub_key(d, x, y);
+    HOST_CHECK(memcmp(x, ux, 32) == 0 && memcmp(y, uy, 32) == 0);
+
+    HOST_CHECK(ecc_ecdsa_sign(d, e, k, rr, ss) == 0);
+    HOST_CHECK(memcmp(rr, r, 32) == 0 && memcmp(ss, s, 32) == 0);
+    HOST_CHECK(ecc_ecdsa_validate(ux, uy, e, r, s) == 0);
+
+    /* a flipped bit anywhere in the hash, r, s or the key fails */
+    for (bit = 0; bit < 256; bit += 17)
+    {
+        memcpy(rr, e, 32);
+        rr[bit / 32] ^= 1u << (bit % 32);
+        HOST_CHECK(ecc_ecdsa_validate(ux, uy, rr, r, s) != 0);
+        memcpy(rr, r, 32);
+        rr[bit / 32] ^= 1u << (bit % 32);
+        HOST_CHECK(ecc_ecdsa_validate(ux, uy, e, rr, s) != 0);
+        memcpy(ss, s, 32);
+        ss[bit / 32] ^= 1u << (bit % 32);
+        HOST_CHECK(ecc_ecdsa_validate(ux, uy, e, r, ss) != 0);
+        memcpy(x, ux, 32);
+        x[bit / 32] ^= 1u << (bit % 32);
+        HOST_CHECK(ecc_ecdsa_validate(x, uy, e, r, s) != 0);
+    }
+
+    /* r and s outside [1, n - 1] */
+    memset(zero, 0, sizeof(zero));
+    toWords(orderN, rr);
+    HOST_CHECK(ecc_ecdsa_validate(ux, uy, e, zero, s) != 0);
+    HOST_CHECK(ecc_ecdsa_validate(ux, uy, e, r, zero) != 0);
+    HOST_CHECK(ecc_ecdsa_validate(ux, uy, e, rr, s) != 0);
+    HOST_CHECK(ecc_ecdsa_validate(ux, uy, e, r, rr) != 0);
+    HOST_CHECK(!ecc_is_valid_key(rr));
+    toWords(orderN1, rr);
+    HOST_CHECK(ecc_is_valid_key(rr));
+
+    /* (n - 1) G = -G, and 1 G = G */
+    ecc_gen_pub_key(rr, x, y);
+    HOST_CHECK(memcmp(x, ecc_g_point_x, 32) == 0 && memcmp(y, ecc_g_point_y, 32) != 0);
+    memset(rr, 0, sizeof(rr));
+    rr[0] = 1;
+    ecc_gen_pub_key(rr, x, y);
+    HOST_CHECK(memcmp(x, ecc_g_point_x, 32) == 0 && memcmp(y, ecc_g_point_y, 32) == 0);
+
+    /* ECDH: both sides agree, and signatures made with fresh keys verify */
+    srand(256);
+    for (i = 0; i < 16; i++)
+    {
+        int w;
+
+        for (w = 0; w < 8; w++)
+        {
+            d[w] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+            d2[w] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+            k[w] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+            e[w] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+        }
+        d[7] &= 0x7fffffff;
+        d2[7] &= 0x7fffffff;
+        k[7] &= 0x7fffffff;
+
+        ecc_gen_pub_key(d, ax, ay);
+        ecc_gen_pub_key(d2, bx, by);
+        ecc_ecdh(bx, by, d, p1x, p1y);
+        ecc_ecdh(ax, ay, d2, p2x, p2y);
+        HOST_CHECK(memcmp(p1x, p2x, 32) == 0 && memcmp(p1y, p2y, 32) == 0);
+
+        HOST_CHECK(ecc_ecdsa_sign(d, e, k, r, s) == 0);
+        HOST_CHECK(ecc_ecdsa_validate(ax, ay, e, r, s) == 0);
+        HOST_CHECK(ecc_ecdsa_validate(bx, by, e, r, s) != 0);
+    }
+    printf("p256: RFC 6979 A.2.5 key and signature equal, 16 ECDH agreements, tampered inputs rejected\n");
+}
+
+static void bench(void)
+{
+    rijndael_ctx ctx;
+    uint8_t key[16] = { 0 }, block[16] = { 0 };
+    static uint8_t data[4096];
+    uint8_t d[32];
+    uint32_t dk[8], e[8], k[8], x[8], y[8], r[8], s[8];
+    double t0;
+    int i, n;
+
+    rijndael_set_key_enc_only(&ctx, key, 128);
+    n = 2000000;
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+        rijndael_encrypt(&ctx, block, block);
+    printf("aes-128 block    %8.1f ns\n", (host_now() - t0) / n * 1e9);
+
+    n = 5000;
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+        sha256(data, sizeof(data), d);
+    printf("sha-256 byte     %8.2f ns\n", (host_now() - t0) / n / sizeof(data) * 1e9);
+
+    toWords(rfcD, dk);
+    toWords(rfcK, k);
+    sha256("sample", 6, d);
+    toWordsFromBytes(d, e);
+    n = 200;
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+        ecc_gen_pub_key(dk, x, y);
+    printf("p-256 k*G        %8.3f ms\n", (host_now() - t0) / n * 1e3);
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+        ecc_ecdsa_sign(dk, e, k, r, s);
+    printf("p-256 sign       %8.3f ms\n", (host_now() - t0) / n * 1e3);
+    t0 = host_now();
+    for (i = 0; i < n; i++)
+        HOST_CHECK(ecc_ecdsa_validate(x, y, e, r, s) == 0);
+    printf("p-256 verify     %8.3f ms\n", (host_now() - t0) / n * 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    testAes();
+    testSha256();
+    testP256();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
@@ -0,0 +1,198 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_tslog.c on emulated NOR flash: append, seek and read back; a reset
+ * with records still in RAM; a page program torn by a reset; the ring
+ * wrapping around; a cursor left behind by the wrap; format. "bench"
+ * appends 1M records of 24 bytes and counts the erases and programs.
+ *
+ * The source is included so that a reset can be modelled by clearing its
+ * RAM state.
+ */
+
+#include "host_stubs.h"
+#include "host_flash.h"
+#include "mw_tslog.c"
+
+#define REC_LEN(seq)    (((seq) * 7) % 40 + 1)
+
+static void reset(void)
+{
+    memset(&mwTsLog, 0, sizeof(mwTsLog));
+    HOST_CHECK(mwTsLogInit() == MW_TSLOG_OK);
+}
+
+static void append(UINT32 n)
+{
+    UINT8 buf[64];
+    UINT32 seq, i;
+
+    for (i = 0; i < n; i++)
+    {
+        UINT32 next = mwTsLog.nextRecSeq;
+
+        memset(buf, (UINT8)next, sizeof(buf));
+        HOST_CHECK(mwTsLogAppend(buf, REC_LEN(next), &seq) == MW_TSLOG_OK);
+        HOST_CHECK(seq == next);
+    }
+}
+
+/* Read from seq to the end, checking the records; returns how many */
+static UINT32 readFrom(UINT32 seq, UINT32 *first)
+{
+    MwTsLogCursor cur;
+    MwTsLogRecInfo info;
+    UINT8 buf[600];
+    UINT32 n = 0, expect = 0;
+    INT32 rc;
+
+    HOST_CHECK(mwTsLogSeek(&cur, seq) == MW_TSLOG_OK);
+    while ((rc = mwTsLogRead(&cur, &info, buf, sizeof(buf))) == MW_TSLOG_OK)
+    {
+        if (n == 0)
+            *first = expect = info.seq;
+        HOST_CHECK(info.seq == expect);
+        HOST_CHECK(info.len == REC_LEN(info.seq));
+        HOST_CHECK(buf[0] == (UINT8)info.seq);
+        expect++;
+        n++;
+    }
+    HOST_CHECK(rc == MW_TSLOG_END);
+    return n;
+}
+
+static void testLog(void)
+{
+    MwTsLogStats st;
+    UINT32 first = 0, n, lastSeq;
+
+    host_flash_blank();
+    reset();
+    HOST_CHECK(readFrom(0, &first) == 0);
+
+    /* Records wait in RAM until a page is full, the cursor sees them */
+    append(5);
+    HOST_CHECK(readFrom(0, &first) == 5 && first == 0);
+    HOST_CHECK(host_flash_programs == 0);
+    HOST_CHECK(mwTsLogFlush() == MW_TSLOG_OK);
+    HOST_CHECK(readFrom(3, &first) == 2 && first == 3);
+
+    append(500);
+    HOST_CHECK(readFrom(0, &first) == 505 && first == 0);
+    HOST_CHECK(readFrom(321, &first) == 184 && first == 321);
+
+    /* A reset loses what was still in RAM, and only that */
+    lastSeq = mwTsLog.nextRecSeq;
+    reset();
+    n = readFrom(0, &first);
+    HOST_CHECK(first == 0 && n <= lastSeq && mwTsLog.nextRecSeq == n);
+
+    /* Torn page program: readers skip it, appends go on after it */
+    append(30);
+    host_flash_tear = 100;
+    while (mwTsLog.pageFill < 200)
+        append(1);
+    append(20);
+    reset();
+    append(50);
+    HOST_CHECK(mwTsLogFlush() == MW_TSLOG_OK);
+    {
+        MwTsLogCursor cur;
+        MwTsLogRecInfo info;
+        UINT8 buf[64];
+        UINT32 last = 0;
+
+        n = 0;
+        HOST_CHECK(mwTsLogSeek(&cur, 0) == MW_TSLOG_OK);
+        while (mwTsLogRead(&cur, &info, buf, sizeof(buf)) == MW_TSLOG_OK)
+        {
+            HOST_CHECK(n == 0 || info.seq > last);
+            HOST_CHECK(buf[0] == (UINT8)info.seq);
+            last = info.seq;
+            n++;
+        }
+        HOST_CHECK(last == mwTsLog.nextRecSeq - 1);
+    }
+    mwTsLogGetStats(&st);
+    HOST_CHECK(st.crcErrors > 0);
+
+    /* The ring wraps and drops the oldest sectors */
+    append(5000);
+    mwTsLogGetStats(&st);
+    n = readFrom(0, &first);
+    HOST_CHECK(st.lost > 0 && first == st.oldestSeq && first + n == st.nextSeq);
+    reset();
+    readFrom(0, &first);
+    HOST_CHECK(first == st.oldestSeq);
+
+    /* A cursor into an erased sector moves on to the oldest record */
+    {
+        MwTsLogCursor cur = { 0, 16 };
+        MwTsLogRecInfo info;
+        UINT8 buf[64];
+
+        HOST_CHECK(mwTsLogRead(&cur, &info, buf, sizeof(buf)) == MW_TSLOG_OK);
+        HOST_CHECK(info.seq == first);
+        HOST_CHECK(mwTsLogRead(&cur, &info, buf, 0) == MW_TSLOG_ERR_SIZE);
+    }
+
+    HOST_CHECK(mwTsLogFormat() == MW_TSLOG_OK);
+    reset();
+    HOST_CHECK(readFrom(0, &first) == 0);
+    append(3);
+    HOST_CHECK(readFrom(0, &first) == 3 && first == 0);
+
+    printf("log: append/seek/read, reset, torn page (%u CRC errors), wrap (%u lost), format\n",
+           st.crcErrors, st.lost);
+}
+
+static void benchRun(const char *name, UINT32 flushEvery)
+{
+    MwTsLogStats st;
+    UINT8 sample[24] = { 1 };
+    UINT32 i, erases;
+    double t0, dt;
+
+    host_flash_blank();
+    reset();
+    mwTsLogGetStats(&st);
+    erases = st.sectorErases;
+    host_flash_programs = 0;
+
+    t0 = host_now();
+    for (i = 0; i < 1000000; i++)
+    {
+        sample[0] = (UINT8)i;
+        mwTsLogAppend(sample, sizeof(sample), PNULL);
+        if (flushEvery != 0 && i % flushEvery == flushEvery - 1)
+            mwTsLogFlush();
+    }
+    dt = host_now() - t0;
+    mwTsLogGetStats(&st);
+    printf("1M appends of 24 B, %s: %.0f ns each, %u sector erases, %lu page programs\n",
+           name, dt * 1e3, st.sectorErases - erases, host_flash_programs);
+}
+
+int main(int argc, char **argv)
+{
+    testLog();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        benchRun("no flush", 0);
+        benchRun("flush every 10", 10);
+    }
+    return 0;
+}
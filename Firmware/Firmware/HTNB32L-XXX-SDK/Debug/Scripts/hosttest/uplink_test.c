@@ -0,0 +1,376 @@
+/**
+ *
+ * Copyright (c) 2024 HT Micron Semicondutores S.A.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * mw_uplink.c over host threads, with a link of a set bit rate behind the
+ * send function: start failures, then concurrent first submits creating
+ * one task; messages queued behind one on air sent by class, in order
+ * within a class; an alarm submitted during a bulk backlog sent at the
+ * next message boundary; bulk held to its token bucket while telemetry
+ * passes; a class over its byte limit rejecting; failed sends, the done
+ * callback, tcpipConnectionSend() and the delay histogram buckets. "bench"
+ * runs a 20 kbps link with a bulk backlog and periodic alarms.
+ *
+ * The source is included to reach mwUplinkHistBucket().
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include "host_stubs.h"
+#include "host_os.h"
+#include "mw_uplink.c"
+
+#define TAG(cls, seq)       ((UINT32)(cls) << 16 | (seq))
+#define MAX_LOG             256
+
+static pthread_mutex_t linkLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t linkCond = PTHREAD_COND_INITIALIZER;
+static int gateClosed, onAir;
+static UINT32 linkBps;                  //0: no air time
+static INT32 sendResult;
+static UINT32 sentLog[MAX_LOG];
+static int sentCount;
+
+static UINT32 doneParam;
+static INT32 doneResult;
+
+static INT32 linkSend(void *ctx, UINT32 param, const UINT8 *data, UINT16 len)
+{
+    (void)ctx;
+    HOST_CHECK(len == 0 || data[0] == (UINT8)param);
+    pthread_mutex_lock(&linkLock);
+    onAir = 1;
+    pthread_cond_broadcast(&linkCond);
+    while (gateClosed)
+        pthread_cond_wait(&linkCond, &linkLock);
+    if (sentCount < MAX_LOG)
+        sentLog[sentCount++] = param;
+    pthread_mutex_unlock(&linkLock);
+
+    if (linkBps != 0)
+        usleep((useconds_t)((UINT64)len * 8 * 1000000 / linkBps));
+
+    pthread_mutex_lock(&linkLock);
+    onAir = 0;
+    pthread_mutex_unlock(&linkLock);
+    return sendResult;
+}
+
+static void linkDone(void *ctx, UINT32 param, INT32 result)
+{
+    (void)ctx;
+    doneParam = param;
+    doneResult = result;
+}
+
+INT32 tcpipConnectionSend(INT32 connectionId, UINT8 *data, UINT16 dataLen, UINT8 raiInfo, UINT8 expectFlag, UINT8 sequence)
+{
+    (void)expectFlag;
+    (void)sequence;
+    pthread_mutex_lock(&linkLock);
+    sentLog[sentCount++] = TAG(connectionId, raiInfo);
+    pthread_mutex_unlock(&linkLock);
+    return data[dataLen - 1] == 0x55 ? (INT32)dataLen : -1;
+}
+
+static INT32 submit(MwUplinkClass cls, UINT32 seq, UINT16 len)
+{
+    static UINT8 buf[4096];
+
+    memset(buf, (UINT8)TAG(cls, seq), len);
+    return mwUplinkSubmit(cls, linkSend, linkDone, NULL, TAG(cls, seq), buf, len);
+}
+
+static void closeGate(void)
+{
+    pthread_mutex_lock(&linkLock);
+    gateClosed = 1;
+    pthread_mutex_unlock(&linkLock);
+}
+
+static void openGate(void)
+{
+    pthread_mutex_lock(&linkLock);
+    gateClosed = 0;
+    pthread_cond_broadcast(&linkCond);
+    pthread_mutex_unlock(&linkLock);
+}
+
+static void waitOnAir(void)
+{
+    pthread_mutex_lock(&linkLock);
+    while (!onAir)
+        pthread_cond_wait(&linkCond, &linkLock);
+    pthread_mutex_unlock(&linkLock);
+}
+
+static int done(void)
+{
+    MwUplinkClassStats stats;
+    int cls, n = 0;
+
+    for (cls = 0; cls < MW_UPLINK_CLASS_NUM; cls++)
+    {
+        mwUplinkGetStats((MwUplinkClass)cls, &stats);
+        n += stats.sent + stats.failed;
+    }
+    return n;
+}
+
+/* Wait up to 5 s for n messages to be sent or to fail */
+static void waitDone(int n)
+{
+    int i;
+
+    for (i = 0; i < 5000 && done() < n; i++)
+        osDelay(1);
+    HOST_CHECK(done() == n);
+}
+
+static void reset(void)
+{
+    int cls;
+
+    mwUplinkResetStats();
+    for (cls = 0; cls < MW_UPLINK_CLASS_NUM; cls++)
+        HOST_CHECK(mwUplinkSetBudget((MwUplinkClass)cls, 0, 0, 16384) == MW_UPLINK_OK);
+    sentCount = 0;
+    linkBps = 0;
+    sendResult = 0;
+}
+
+static void testHist(void)
+{
+    HOST_CHECK(mwUplinkHistBucket(0) == 0 && mwUplinkHistBucket(1) == 1);
+    HOST_CHECK(mwUplinkHistBucket(2) == 2 && mwUplinkHistBucket(3) == 2 && mwUplinkHistBucket(4) == 3);
+    HOST_CHECK(mwUplinkHistBucket(16383) == 14 && mwUplinkHistBucket(16384) == 15);
+    HOST_CHECK(mwUplinkHistBucket(0xFFFFFFFF) == MW_UPLINK_HIST_BUCKETS - 1);
+}
+
+static void *submitter(void *arg)
+{
+    *(INT32 *)arg = submit(MW_UPLINK_CLASS_ALARM, 0, 8);
+    return NULL;
+}
+
+static void testStart(void)
+{
+    unsigned long creates;
+    MwUplinkClassStats stats;
+    pthread_t t[4];
+    INT32 rc[4];
+    int fail, i;
+
+    /* The mutex, the semaphore, then the task */
+    for (fail = 0; fail < 3; fail++)
+    {
+        host_os_fail = fail;
+        HOST_CHECK(submit(MW_UPLINK_CLASS_ALARM, 0, 8) == MW_UPLINK_ERR_SYS);
+        HOST_CHECK(host_os_fail == -1);
+        mwUplinkGetStats(MW_UPLINK_CLASS_ALARM, &stats);
+        HOST_CHECK(stats.queued == 0);
+    }
+
+    creates = host_os_creates;
+    host_os_create_us = 20000;
+    for (i = 0; i < 4; i++)
+        HOST_CHECK(pthread_create(&t[i], NULL, submitter, &rc[i]) == 0);
+    for (i = 0; i < 4; i++)
+    {
+        pthread_join(t[i], NULL);
+        HOST_CHECK(rc[i] == MW_UPLINK_OK);
+    }
+    host_os_create_us = 0;
+    HOST_CHECK(host_os_creates - creates == 3);
+    waitDone(4);
+    printf("uplink: start failures leave nothing behind, 4 concurrent first submits start one task\n");
+}
+
+static void testOrder(void)
+{
+    static const UINT32 want[] =
+    {
+        TAG(MW_UPLINK_CLASS_BULK, 0),
+        TAG(MW_UPLINK_CLASS_ALARM, 1), TAG(MW_UPLINK_CLASS_ALARM, 2),
+        TAG(MW_UPLINK_CLASS_CONTROL, 1), TAG(MW_UPLINK_CLASS_CONTROL, 2),
+        TAG(MW_UPLINK_CLASS_TELEMETRY, 1), TAG(MW_UPLINK_CLASS_TELEMETRY, 2),
+        TAG(MW_UPLINK_CLASS_BULK, 1), TAG(MW_UPLINK_CLASS_BULK, 2)
+    };
+    int i;
+
+    reset();
+    closeGate();
+    HOST_CHECK(submit(MW_UPLINK_CLASS_BULK, 0, 100) == MW_UPLINK_OK);
+    waitOnAir();
+    HOST_CHECK(submit(MW_UPLINK_CLASS_TELEMETRY, 1, 10) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_BULK, 1, 100) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_CONTROL, 1, 10) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_ALARM, 1, 10) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_TELEMETRY, 2, 10) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_BULK, 2, 100) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_ALARM, 2, 10) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_CONTROL, 2, 10) == MW_UPLINK_OK);
+    openGate();
+    waitDone(9);
+    HOST_CHECK(sentCount == 9);
+    for (i = 0; i < 9; i++)
+        HOST_CHECK(sentLog[i] == want[i]);
+    printf("uplink: 8 messages queued behind one on air sent by class, in order within each\n");
+}
+
+static void testPreempt(void)
+{
+    MwUplinkClassStats alarm, bulk;
+    int i, at;
+
+    reset();
+    linkBps = 100000;               //a 512 byte chunk is 41 ms on air
+    for (i = 0; i < 16; i++)
+        HOST_CHECK(submit(MW_UPLINK_CLASS_BULK, (UINT32)i, MW_UPLINK_CHUNK_HINT) == MW_UPLINK_OK);
+    osDelay(100);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_ALARM, 0, 20) == MW_UPLINK_OK);
+    waitDone(17);
+
+    for (at = 0; sentLog[at] != TAG(MW_UPLINK_CLASS_ALARM, 0); at++)
+        ;
+    mwUplinkGetStats(MW_UPLINK_CLASS_ALARM, &alarm);
+    mwUplinkGetStats(MW_UPLINK_CLASS_BULK, &bulk);
+    HOST_CHECK(at >= 2 && at <= 4);
+    HOST_CHECK(alarm.maxDelayMs <= 41 + 25);
+    printf("uplink: alarm during a 16 x 512 B backlog at 100 kbps sent after chunk %d, %u ms queued (bulk up to %u ms)\n",
+           at, alarm.maxDelayMs, bulk.maxDelayMs);
+}
+
+static void testBudget(void)
+{
+    MwUplinkClassStats tele;
+    double start, secs;
+    int i;
+
+    reset();
+    HOST_CHECK(mwUplinkSetBudget(MW_UPLINK_CLASS_BULK, 10000, 1000, 16384) == MW_UPLINK_OK);
+    start = host_now();
+    for (i = 0; i < 40; i++)
+        HOST_CHECK(submit(MW_UPLINK_CLASS_BULK, (UINT32)i, 250) == MW_UPLINK_OK);
+    osDelay(300);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_TELEMETRY, 0, 50) == MW_UPLINK_OK);
+    waitDone(41);
+    secs = host_now() - start;
+
+    /* 1000 bytes of burst, then 9000 at 10000 B/s */
+    HOST_CHECK(secs > 0.8 && secs < 1.2);
+    mwUplinkGetStats(MW_UPLINK_CLASS_TELEMETRY, &tele);
+    HOST_CHECK(tele.maxDelayMs <= 20);
+    printf("uplink: 10000 B of bulk at 10000 B/s with a 1000 B burst took %.2f s, telemetry %u ms queued\n",
+           secs, tele.maxDelayMs);
+}
+
+static void testFull(void)
+{
+    MwUplinkClassStats stats;
+
+    reset();
+    HOST_CHECK(mwUplinkSetBudget(MW_UPLINK_CLASS_TELEMETRY, 0, 0, 1000) == MW_UPLINK_OK);
+    closeGate();
+    HOST_CHECK(submit(MW_UPLINK_CLASS_ALARM, 0, 10) == MW_UPLINK_OK);
+    waitOnAir();
+    HOST_CHECK(submit(MW_UPLINK_CLASS_TELEMETRY, 1, 300) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_TELEMETRY, 2, 300) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_TELEMETRY, 3, 300) == MW_UPLINK_OK);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_TELEMETRY, 4, 300) == MW_UPLINK_ERR_FULL);
+    HOST_CHECK(submit(MW_UPLINK_CLASS_TELEMETRY, 5, 100) == MW_UPLINK_OK);
+    mwUplinkGetStats(MW_UPLINK_CLASS_TELEMETRY, &stats);
+    HOST_CHECK(stats.queued == 4 && stats.queuedBytes == 1000 && stats.rejected == 1);
+    openGate();
+    waitDone(5);
+    mwUplinkGetStats(MW_UPLINK_CLASS_TELEMETRY, &stats);
+    HOST_CHECK(stats.queued == 0 && stats.queuedBytes == 0 && stats.sent == 4 && stats.sentBytes == 1000);
+    printf("uplink: a class over its 1000 B limit rejects, then takes again once sent\n");
+}
+
+static void testCalls(void)
+{
+    UINT8 data[] = { 1, 2, 0x55 };
+    UINT8 bad[] = { 1, 2, 3 };
+    MwUplinkClassStats stats;
+
+    reset();
+    HOST_CHECK(mwUplinkSubmit(MW_UPLINK_CLASS_ALARM, NULL, NULL, NULL, 0, data, 3) == MW_UPLINK_ERR_PARAM);
+    HOST_CHECK(mwUplinkSubmit(MW_UPLINK_CLASS_NUM, linkSend, NULL, NULL, 0, data, 3) == MW_UPLINK_ERR_PARAM);
+    HOST_CHECK(mwUplinkSubmitV(MW_UPLINK_CLASS_ALARM, linkSend, NULL, NULL, 0, data, 40000, data, 30000) ==
+               MW_UPLINK_ERR_PARAM);
+    HOST_CHECK(mwUplinkSetBudget(MW_UPLINK_CLASS_BULK, 100, 0, 0) == MW_UPLINK_ERR_PARAM);
+
+    sendResult = -1;
+    HOST_CHECK(submit(MW_UPLINK_CLASS_CONTROL, 7, 10) == MW_UPLINK_OK);
+    waitDone(1);
+    mwUplinkGetStats(MW_UPLINK_CLASS_CONTROL, &stats);
+    HOST_CHECK(stats.failed == 1 && stats.sent == 0);
+    HOST_CHECK(doneParam == TAG(MW_UPLINK_CLASS_CONTROL, 7) && doneResult == -1);
+
+    HOST_CHECK(mwUplinkTcpipSend(MW_UPLINK_CLASS_TELEMETRY, 3, data, 3, 1) == MW_UPLINK_OK);
+    HOST_CHECK(mwUplinkTcpipSend(MW_UPLINK_CLASS_TELEMETRY, 4, bad, 3, 2) == MW_UPLINK_OK);
+    waitDone(3);
+    HOST_CHECK(sentLog[1] == TAG(3, 1) && sentLog[2] == TAG(4, 2));
+    mwUplinkGetStats(MW_UPLINK_CLASS_TELEMETRY, &stats);
+    HOST_CHECK(stats.sent == 1 && stats.failed == 1 && stats.delayHist[0] + stats.delayHist[1] + stats.delayHist[2] == 2);
+    printf("uplink: bad calls refused, failed sends counted and reported, tcpipConnectionSend() relayed\n");
+}
+
+/* The case of the arbiter: a 20 kbps link, 20 KB of log backlog in chunks
+ * at the default bulk budget, an alarm every second */
+static void bench(void)
+{
+    MwUplinkClassStats alarm, bulk;
+    double start, secs;
+    int i, alarms = 0;
+
+    reset();
+    HOST_CHECK(mwUplinkSetBudget(MW_UPLINK_CLASS_BULK, 1500, 3000, 24000) == MW_UPLINK_OK);
+    linkBps = 20000;
+    start = host_now();
+    for (i = 0; i < 40; i++)
+        HOST_CHECK(submit(MW_UPLINK_CLASS_BULK, (UINT32)i, MW_UPLINK_CHUNK_HINT) == MW_UPLINK_OK);
+    for (;;)
+    {
+        mwUplinkGetStats(MW_UPLINK_CLASS_BULK, &bulk);
+        if (bulk.queued == 0)
+            break;
+        osDelay(1000);
+        HOST_CHECK(submit(MW_UPLINK_CLASS_ALARM, (UINT32)alarms++, 40) == MW_UPLINK_OK);
+    }
+    waitDone(40 + alarms);
+    secs = host_now() - start;
+    mwUplinkGetStats(MW_UPLINK_CLASS_ALARM, &alarm);
+    mwUplinkGetStats(MW_UPLINK_CLASS_BULK, &bulk);
+    printf("  20 kbps, 20 KB bulk at 1500 B/s: %.1f s, %.0f B/s, bulk queued up to %.1f s\n",
+           secs, bulk.sentBytes / secs, bulk.maxDelayMs / 1000.0);
+    printf("  %d alarms, queued up to %u ms (a 512 B chunk is 205 ms on air)\n", alarms, alarm.maxDelayMs);
+}
+
+int main(int argc, char **argv)
+{
+    testHist();
+    testStart();
+    testOrder();
+    testPreempt();
+    testBudget();
+    testFull();
+    testCalls();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        bench();
+    return 0;
+}
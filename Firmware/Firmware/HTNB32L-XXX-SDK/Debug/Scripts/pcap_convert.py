@@ -0,0 +1,147 @@
+#   _    _ _______   __  __ _____ _____ _____   ____  _   _
+#  | |  | |__   __| |  \/  |_   _/ ____|  __ \ / __ \| \ | |
+#  | |__| |  | |    | \  / | | || |    | |__) | |  | |  \| |
+#  |  __  |  | |    | |\/| | | || |    |  _  /| |  | | . ` |
+#  | |  | |  | |    | |  | |_| || |____| | \ \| |__| | |\  |
+#  |_|  |_|  |_|    |_|  |_|_____\_____|_|  \_\\____/|_| \_|
+#  =================== Advanced R&D ========================
+
+#  Copyright (c) 2024 HT Micron Semicondutores S.A.
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#  http://www.apache.org/licenses/LICENSE-2.0
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+# file: pcap_convert.py
+# brief: Converts a packet capture dump of mw_pcap (file or unilog export) to pcapng.
+# author: HT Micron Advanced R&D
+# link: https://github.com/htmicron
+# version: 0.1
+# date: October 19, 2026
+#
+# usage: python pcap_convert.py <dump> <out.pcapng>
+#
+# <dump> is either the file written by mwPcapDumpToFile(), or a text export
+# of the log holding the mwPcapDump entries of mwPcapDumpToUnilog().
+
+import re
+import struct
+import sys
+
+FILE_MAGIC = 0x5043504D
+FILE_HDR = struct.Struct("<IHHIIIII")
+REC_HDR = struct.Struct("<HHIBBBB")
+
+LINKTYPE_RAW = 101
+PATH_NAMES = ("lwip", "fastpath")
+DIR_IN = 0
+
+HEX_BYTE = re.compile(r"(?<![0-9A-Fa-f])(?:0x)?([0-9A-Fa-f]{2})(?![0-9A-Fa-f])")
+
+
+def load_text(data):
+    """Rebuild the dump from the hex chunks of a log export."""
+    chunks = {}
+    for line in data.decode("utf-8", "replace").splitlines():
+        pos = line.find("mwPcapDump")
+        if pos < 0:
+            continue
+        raw = bytes(int(b, 16) for b in HEX_BYTE.findall(line[pos + len("mwPcapDump"):]))
+        if len(raw) > 4:
+            chunks[struct.unpack_from("<I", raw)[0]] = raw[4:]
+
+    dump = bytearray()
+    for off in sorted(chunks):
+        if off > len(dump):
+            print("warning: %d bytes lost at offset %d" % (off - len(dump), len(dump)))
+            break
+        dump[off:off + len(chunks[off])] = chunks[off]
+    return bytes(dump)
+
+
+def load_dump(path):
+    data = open(path, "rb").read()
+    if len(data) >= 4 and struct.unpack_from("<I", data)[0] == FILE_MAGIC:
+        return data
+    return load_text(data)
+
+
+def parse(dump):
+    if len(dump) < FILE_HDR.size:
+        raise ValueError("dump too short")
+    (magic, version, snaplen, dump_tick, dump_utc,
+     recorded, overwritten, data_len) = FILE_HDR.unpack_from(dump)
+    if magic != FILE_MAGIC or version != 1:
+        raise ValueError("not an mw_pcap dump")
+
+    hdr = {"snaplen": snaplen, "dump_tick": dump_tick, "dump_utc": dump_utc,
+           "recorded": recorded, "overwritten": overwritten}
+    recs = []
+    off = FILE_HDR.size
+    end = min(len(dump), FILE_HDR.size + data_len)
+    while off + REC_HDR.size <= end:
+        rec_len, orig_len, tick, direction, path, cid, cap_len = REC_HDR.unpack_from(dump, off)
+        if rec_len < REC_HDR.size or off + rec_len > end:
+            print("warning: truncated record at offset %d" % off)
+            break
+        data = dump[off + REC_HDR.size:off + REC_HDR.size + cap_len]
+        recs.append((tick, direction, path, cid, orig_len, data))
+        off += rec_len
+    return hdr, recs
+
+
+def block(block_type, body):
+    body += b"\0" * (-len(body) % 4)
+    length = len(body) + 12
+    return struct.pack("<II", block_type, length) + body + struct.pack("<I", length)
+
+
+def option(code, value):
+    return struct.pack("<HH", code, len(value)) + value + b"\0" * (-len(value) % 4)
+
+
+def write_pcapng(path, hdr, recs):
+    out = open(path, "wb")
+    shb = struct.pack("<IHHq", 0x1A2B3C4D, 1, 0, -1)
+    shb += option(4, b"mw_pcap") + option(0, b"")
+    out.write(block(0x0A0D0D0A, shb))
+
+    for name in PATH_NAMES:
+        idb = struct.pack("<HHI", LINKTYPE_RAW, 0, hdr["snaplen"])
+        idb += option(2, name.encode()) + option(9, b"\x03") + option(0, b"")
+        out.write(block(0x00000001, idb))
+
+    for tick, direction, path, cid, orig_len, data in recs:
+        # Ticks are 32 bit milliseconds, dated from the wall clock at dump time
+        age = (hdr["dump_tick"] - tick) & 0xFFFFFFFF
+        ts = hdr["dump_utc"] * 1000 - age if hdr["dump_utc"] else tick
+        flags = 1 if direction == DIR_IN else 2
+        epb = struct.pack("<IIIII", min(path, len(PATH_NAMES) - 1),
+                          (ts >> 32) & 0xFFFFFFFF, ts & 0xFFFFFFFF, len(data), orig_len)
+        epb += data + b"\0" * (-len(data) % 4)
+        epb += option(2, struct.pack("<I", flags))
+        if cid != 0xFF:
+            epb += option(1, ("cid %d" % cid).encode())
+        epb += option(0, b"")
+        out.write(block(0x00000006, epb))
+    out.close()
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("usage: %s <dump> <out.pcapng>" % sys.argv[0])
+        sys.exit(1)
+
+    hdr, recs = parse(load_dump(sys.argv[1]))
+    write_pcapng(sys.argv[2], hdr, recs)
+    print("%d packets written, %d recorded on target, %d overwritten in the ring" %
+          (len(recs), hdr["recorded"], hdr["overwritten"]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,367 @@
+#   _    _ _______   __  __ _____ _____ _____   ____  _   _
+#  | |  | |__   __| |  \/  |_   _/ ____|  __ \ / __ \| \ | |
+#  | |__| |  | |    | \  / | | || |    | |__) | |  | |  \| |
+#  |  __  |  | |    | |\/| | | || |    |  _  /| |  | | . ` |
+#  | |  | |  | |    | |  | |_| || |____| | \ \| |__| | |\  |
+#  |_|  |_|  |_|    |_|  |_|_____\_____|_|  \_\\____/|_| \_|
+#  =================== Advanced R&D ========================
+
+#  Copyright (c) 2024 HT Micron Semicondutores S.A.
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#  http://www.apache.org/licenses/LICENSE-2.0
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+# file: ramcode_hot.py
+# brief: Picks the hot functions to run from RAM out of a mw_pcprof profile.
+# author: HT Micron Advanced R&D
+# link: https://github.com/htmicron
+# version: 0.1
+# date: October 19, 2026
+#
+# usage: python ramcode_hot.py <app.elf> <profile> [<profile> ...]
+#                              [--map app.map] [--top N] [--budget BYTES]
+#                              [--iram-size BYTES] [--granule BYTES] [--xip ADDR]
+#                              [--min-samples N]
+#                              [--exclude REGEX] [-o ramcode_hot.ld]
+#
+# <app.elf> is the image the profile was taken on, built with
+# MW_PCPROF_ENABLE=y; its map file (<app>.map next to it by default) tells
+# which object and input section each function came from. A profile is
+# either the mwPcProfDump_2 payloads of mw_pcprof joined in a binary file
+# (pairs of little-endian 32-bit PC and count), or text with one
+# "<pc in hex> <count>" per line, as printed from mwPcProfGetSample().
+# Several profiles are added up.
+#
+# The input sections holding the most samples are listed, most first, in
+# a linker script fragment, until N of them are picked or the room left
+# in LOAD_IRAM is used up. qcx212_0h00_flash_hot.ld, the variant of the
+# default linker script picked with HT_RAMCODE_HOT_ENABLE=y, includes it in
+# .ramcode1, which the startup copies to RAM like the PLAT_CODE_IN_RAM
+# functions. Put it next to the Makefile of the application and rebuild
+# with HT_RAMCODE_HOT_ENABLE=y. Sections
+# already moved by an earlier fragment are picked again only if they are
+# still hot, so profiling the new image and running the tool again
+# refines the list.
+#
+# Functions need -ffunction-sections (CFLAGS_OPTIMIZE) to be moved one by
+# one; an object built without it is moved whole, and only if it fits.
+# The boot code that runs before the RAM code is copied is never moved.
+
+import argparse
+import bisect
+import os
+import re
+import struct
+import sys
+
+# LOAD_IRAM of qcx212_0h00_flash.ld, shared by .ramcode1 and .ramcode2
+IRAM_SIZE = 36 * 1024
+
+# XIP flash, everything below is RAM
+FLASH_XIP_ADDR = 0x00800000
+
+# Up to the alignment of a section, wasted in front of it
+ALIGN_SLACK = 3
+
+HOT_BASE = "Image$$LOAD_IRAM1_HOT$$Base"
+HOT_LIMIT = "Image$$LOAD_IRAM1_HOT$$Limit"
+
+# Run before CopyRamCodeForDeepSleep() or around the flash and cache
+# drivers, which the default linker script places on its own
+BOOT_OBJECTS = (
+    "startup_qcx212_gcc.o",
+    "system_qcx212.o",
+    "prec_init.o",
+    "vector_qcx212.o",
+    "cache_qcx212.o",
+    "flash_qcx212.o",
+    "flash_qcx212_rt.o",
+    "qspi_qcx212.o",
+)
+
+CODE_SECTIONS = (".text", ".phyCodeFlash")
+
+
+class Elf(object):
+    """Sections and symbols of an ELF file, 32 or 64-bit little-endian."""
+
+    def __init__(self, data):
+        if data[:4] != b"\x7fELF" or data[5] != 1:
+            raise ValueError("not a little-endian ELF file")
+        self.is64 = data[4] == 2
+        if self.is64:
+            shoff, = struct.unpack_from("<Q", data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+        else:
+            shoff, = struct.unpack_from("<I", data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+        raw = []
+        for i in range(shnum):
+            off = shoff + i * shentsize
+            if self.is64:
+                name, typ, _, addr, offset, size, link, _, _, entsize = \
+                    struct.unpack_from("<IIQQQQIIQQ", data, off)
+            else:
+                name, typ, _, addr, offset, size, link, _, _, entsize = \
+                    struct.unpack_from("<IIIIIIIIII", data, off)
+            raw.append((name, typ, addr, offset, size, link, entsize))
+
+        def string(table, off):
+            start = raw[table][3] + off
+            return data[start:data.index(b"\0", start)].decode("latin-1")
+
+        self.sections = {}
+        for name, typ, addr, offset, size, link, entsize in raw:
+            self.sections[string(shstrndx, name)] = (addr, size)
+
+        self.functions = []
+        self.symbols = {}
+        for name, typ, addr, offset, size, link, entsize in raw:
+            if typ != 2:        # SHT_SYMTAB
+                continue
+            for off in range(offset + entsize, offset + size, entsize):
+                if self.is64:
+                    sname, info, _, _, value, ssize = struct.unpack_from("<IBBHQQ", data, off)
+                else:
+                    sname, value, ssize, info = struct.unpack_from("<IIIB", data, off)
+                sym = string(link, sname)
+                if (info & 0xF) == 2 and ssize > 0:           # STT_FUNC
+                    self.functions.append((value & ~1, ssize, sym))
+                elif sym:
+                    self.symbols[sym] = value
+        self.functions.sort()
+        self.func_starts = [f[0] for f in self.functions]
+
+    def function_at(self, pc):
+        i = bisect.bisect_right(self.func_starts, pc) - 1
+        if i >= 0:
+            start, size, name = self.functions[i]
+            if pc < start + size:
+                return name
+        return None
+
+
+class Unit(object):
+    """An input section as placed by the linker: the thing that can move."""
+
+    def __init__(self, output, name, addr, size, obj):
+        self.output = output
+        self.name = name
+        self.addr = addr
+        self.size = size
+        self.obj = obj
+        self.samples = 0
+        self.functions = {}
+
+    def object_name(self):
+        m = re.match(r"(.*)\((.*)\)$", self.obj)
+        if m:
+            return os.path.basename(m.group(2))
+        return os.path.basename(self.obj.replace("\\", "/"))
+
+    def pattern(self):
+        """Input section description matching this section only."""
+        m = re.match(r"(.*)\((.*)\)$", self.obj)
+        path, member = (m.group(1), m.group(2)) if m else (self.obj, None)
+        base = os.path.basename(path.replace("\\", "/"))
+        name = "*[/\\\\]" + base if base != path else base
+        if member is not None:
+            name += ":" + member
+        return "%s(%s)" % (name, self.name)
+
+
+MAP_UNIT = re.compile(r"^ (\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+MAP_OUTPUT = re.compile(r"^(\.\S+|/DISCARD/)(\s+0x[0-9a-fA-F]+)?")
+
+
+def read_map(path):
+    """Input sections of the memory map, in address order."""
+    units = []
+    output = None
+    pending = None
+    started = False
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\r\n")
+            if not started:
+                started = line.startswith("Linker script and memory map")
+                continue
+            m = MAP_OUTPUT.match(line)
+            if m:
+                output = m.group(1)
+                pending = None
+                continue
+            if line.startswith(" *") or line.startswith(" *fill*"):
+                pending = None
+                continue
+            m = MAP_UNIT.match(line)
+            if m:
+                name = m.group(1) or pending
+                pending = None
+                size = int(m.group(3), 16)
+                if name and size and not name.startswith("*"):
+                    units.append(Unit(output, name, int(m.group(2), 16), size, m.group(4).strip()))
+                continue
+            m = re.match(r"^ (\.\S+)$", line)
+            pending = m.group(1) if m else None
+    units.sort(key=lambda u: u.addr)
+    return units
+
+
+def read_profile(path):
+    """(pc, count) pairs of a binary or a text profile."""
+    with open(path, "rb") as f:
+        data = f.read()
+    text = None
+    try:
+        text = data.decode("ascii")
+    except UnicodeDecodeError:
+        pass
+    if text is not None and re.search(r"^\s*(0x)?[0-9a-fA-F]+\s+\d+\s*$", text, re.M):
+        pairs = []
+        for line in text.splitlines():
+            m = re.match(r"^\s*(?:0x)?([0-9a-fA-F]+)\s+(\d+)\s*$", line)
+            if m:
+                pairs.append((int(m.group(1), 16), int(m.group(2))))
+        return pairs
+    if len(data) % 8:
+        raise ValueError("%s: binary profile of %d bytes, not a multiple of 8" % (path, len(data)))
+    return [struct.unpack_from("<II", data, off) for off in range(0, len(data), 8)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="hot functions of a mw_pcprof profile to RAM")
+    parser.add_argument("elf")
+    parser.add_argument("profile", nargs="+")
+    parser.add_argument("--map", help="map file of the link, <elf>.map by default")
+    parser.add_argument("--top", type=int, default=32, help="sections picked at most (32)")
+    parser.add_argument("--budget", type=int, help="RAM bytes for them, all the room left by default")
+    parser.add_argument("--xip", type=lambda x: int(x, 0), default=FLASH_XIP_ADDR,
+                        help="start of the XIP flash, code below it is RAM code (0x%X)" % FLASH_XIP_ADDR)
+    parser.add_argument("--iram-size", type=int, default=IRAM_SIZE,
+                        help="size of LOAD_IRAM in the linker script (%d)" % IRAM_SIZE)
+    parser.add_argument("--granule", type=int, default=8,
+                        help="bytes counted per histogram entry, 1 << MW_PCPROF_PC_SHIFT (8)")
+    parser.add_argument("--min-samples", type=int, default=2, help="samples a section needs (2)")
+    parser.add_argument("--exclude", action="append", default=[],
+                        help="regex of functions, objects or sections never to move")
+    parser.add_argument("-o", "--output", default="ramcode_hot.ld")
+    args = parser.parse_args()
+
+    if args.granule < 2 or args.granule & (args.granule - 1):
+        print("--granule must be a power of two, 2 or more")
+        return 1
+
+    map_path = args.map or os.path.splitext(args.elf)[0] + ".map"
+    try:
+        with open(args.elf, "rb") as f:
+            elf = Elf(f.read())
+        units = read_map(map_path)
+        samples = []
+        for path in args.profile:
+            samples += read_profile(path)
+    except (IOError, ValueError) as e:
+        print(e)
+        return 1
+    if not units:
+        print("%s: no memory map found" % map_path)
+        return 1
+
+    starts = [u.addr for u in units]
+    total = 0
+    unmapped = 0
+    for pc, count in samples:
+        total += count
+        # The PC is anywhere in the granule: share the count over its halfwords
+        part = float(count) * 2 / args.granule
+        for addr in range(pc, pc + args.granule, 2):
+            i = bisect.bisect_right(starts, addr) - 1
+            if i < 0 or addr >= units[i].addr + units[i].size:
+                unmapped += part
+                continue
+            u = units[i]
+            u.samples += part
+            func = elf.function_at(addr) or "?"
+            u.functions[func] = u.functions.get(func, 0) + part
+    if total == 0:
+        print("no samples in the profile")
+        return 1
+
+    hot_base = elf.symbols.get(HOT_BASE)
+    hot_limit = elf.symbols.get(HOT_LIMIT)
+    if hot_base is None or hot_limit is None:
+        print("%s has no %s: not linked with qcx212_0h00_flash_hot.ld (HT_RAMCODE_HOT_ENABLE=y)" % (args.elf, HOT_BASE))
+        return 1
+    hot_now = hot_limit - hot_base
+    ram_used = sum(elf.sections.get(s, (0, 0))[1] for s in (".ramcode1", ".ramcode2"))
+    room = args.iram_size - (ram_used - hot_now)
+    budget = room if args.budget is None else min(args.budget, room)
+    if args.budget is not None and args.budget > room:
+        print("budget cut to the %d bytes left in LOAD_IRAM" % room)
+
+    excludes = [re.compile(x) for x in args.exclude]
+
+    def movable(u):
+        if u.output == ".ramcode1":
+            if not hot_base <= u.addr < hot_limit:
+                return False
+        elif u.output != ".text":
+            return False
+        if not u.name.startswith(CODE_SECTIONS) or u.object_name() in BOOT_OBJECTS:
+            return False
+        names = [u.obj, u.name] + list(u.functions)
+        return not any(x.search(n) for x in excludes for n in names)
+
+    in_hot = sum(u.samples for u in units if hot_base <= u.addr < hot_limit)
+    in_ram = sum(u.samples for u in units if u.addr < args.xip) - in_hot
+
+    hot = sorted((u for u in units if u.samples >= args.min_samples and movable(u)),
+                 key=lambda u: (-u.samples, u.size))
+    picked = []
+    used = 0
+    for u in hot:
+        if len(picked) == args.top:
+            break
+        cost = u.size + ALIGN_SLACK
+        if used + cost <= budget:
+            picked.append(u)
+            used += cost
+
+    def share(n):
+        return 100.0 * n / total
+
+    print("%d samples, %.1f%% in RAM code of the image, %.1f%% in code moved by the current fragment,"
+          " %.1f%% outside the map" % (total, share(in_ram), share(in_hot), share(unmapped)))
+    print("LOAD_IRAM %d bytes: %d taken by RAM code, %d by the current fragment, budget %d"
+          % (args.iram_size, ram_used - hot_now, hot_now, budget))
+    print("")
+    print("  rank  share   bytes  section (function)")
+    for rank, u in enumerate(hot[:max(args.top * 2, 20)], 1):
+        top = max(u.functions, key=u.functions.get)
+        print("  %3d %5.1f%% %7d  %s%s%s" % (rank, share(u.samples), u.size, u.pattern(),
+              "" if u.name.endswith("." + top) else " (%s)" % top, "  <- picked" if u in picked else ""))
+    print("")
+    print("%d sections picked, %d bytes, %.1f%% of the samples"
+          % (len(picked), sum(u.size for u in picked), share(sum(u.samples for u in picked))))
+
+    with open(args.output, "w") as f:
+        f.write("/* Hot functions moved from XIP flash to .ramcode1, included there by\n")
+        f.write("   qcx212_0h00_flash_hot.ld. Written by ramcode_hot.py from %d samples\n" % total)
+        f.write("   of %s, %d bytes of a %d bytes budget. */\n"
+                % (os.path.basename(args.elf), sum(u.size for u in picked), budget))
+        for u in picked:
+            funcs = sorted(u.functions, key=u.functions.get, reverse=True)
+            f.write("    %s    /* %.1f%% %s */\n" % (u.pattern(), share(u.samples), " ".join(funcs[:3])))
+    print("%s written" % args.output)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
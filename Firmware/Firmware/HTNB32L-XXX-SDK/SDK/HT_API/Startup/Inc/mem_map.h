@@ -38,6 +38,24 @@
 #define FLASH_FS_REGION_SIZE            (FLASH_FS_REGION_END-FLASH_FS_REGION_OFFSET)      // 336KB
 /////////////////////////////////////////////////
 
+////////////////MIDDLEWARE AREA//////////////////
+// Free flash between the FOTA region and the PMU backup, written raw by the
+// flash stores of middleware/developed/common. littlefs never sees it.
+#define FLASH_MW_REGION_START           FLASH_FOTA_REGION_END
+#define FLASH_MW_REGION_END             (FLASH_MEM_BACKUP_ADDR-FLASH_XIP_ADDR)              // 160KB
+
+#define FLASH_TSLOG_REGION_OFFSET       FLASH_MW_REGION_START                             // mw_tslog
+#define FLASH_TSLOG_REGION_SIZE         0x10000                                           // 64KB
+#define FLASH_NVJ_REGION_OFFSET         (FLASH_TSLOG_REGION_OFFSET+FLASH_TSLOG_REGION_SIZE) // mw_nvjournal, two banks
+#define FLASH_NVJ_REGION_SIZE           0x4000                                            // 16KB
+#define FLASH_KVCFG_REGION_OFFSET       (FLASH_NVJ_REGION_OFFSET+FLASH_NVJ_REGION_SIZE)   // mw_kvcfg, sector pair
+#define FLASH_KVCFG_REGION_SIZE         0x2000                                            // 8KB
+
+#if (FLASH_KVCFG_REGION_OFFSET+FLASH_KVCFG_REGION_SIZE) > FLASH_MW_REGION_END
+#error "middleware flash area overflow"
+#endif
+/////////////////////////////////////////////////
+
 
 ////////////////EC EXCEPTION AREA////////////////
 #define EC_EXCEPTION_FLASH_BASE         0x3BC000
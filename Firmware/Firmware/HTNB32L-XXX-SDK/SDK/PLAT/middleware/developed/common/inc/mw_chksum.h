@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_chksum.h
+ * Description:  Table-driven CRC16/CRC32 and word-wise Internet checksum
+ *               One place for the checksums computed on every NV write, littlefs
+ *               commit and IP packet: CRC16-CCITT and CRC32 four bytes per step from
+ *               tables in flash, and the one's complement sum 32 bits at a time.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_CHKSUM_H__
+#define __MW_CHKSUM_H__
+
+#include "commontypedef.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/*
+ * CRC16-CCITT, polynomial 0x1021, MSB first, no final XOR. Pass 0xFFFF to
+ * start, or the result of the previous call to continue.
+ */
+UINT16 mwCrc16Ccitt(UINT16 crc, const void *data, UINT32 len);
+
+/*
+ * CRC32, reflected polynomial 0xEDB88320, without the initial and final
+ * inversions: the same as lfs_crc(). For the usual CRC-32 pass 0xFFFFFFFF
+ * and invert the result.
+ */
+UINT32 mwCrc32(UINT32 crc, const void *data, UINT32 len);
+
+/*
+ * Internet checksum (RFC 1071): the one's complement sum of data, folded
+ * to 16 bits and not inverted, in the byte order of data. The same result
+ * as lwip_standard_chksum(), so that it can be lwIP's LWIP_CHKSUM.
+ */
+UINT16 mwInetChksum(const void *data, INT32 len);
+
+#endif
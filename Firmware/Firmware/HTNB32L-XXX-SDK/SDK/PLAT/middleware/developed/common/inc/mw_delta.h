@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_delta.h
+ * Description:  Delta firmware update into the FOTA region
+ *               Built with MW_DELTA_ENABLE=y only. A patch made by
+ *               Debug/Scripts/fota_delta.py against the running application image is
+ *               fed in as it arrives, in chunks of any size; the new image is rebuilt
+ *               from it and the running one straight into the FOTA region, with one
+ *               flash page of RAM, and its SHA-256 checked at the end.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_DELTA_H__
+#define __MW_DELTA_H__
+
+#include "commontypedef.h"
+#include "mem_map.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+/* Flash offsets, not XIP addresses: the image patched and the one rebuilt */
+#ifndef MW_DELTA_SRC_OFFSET
+#define MW_DELTA_SRC_OFFSET           (APP_FLASH_LOAD_ADDR - FLASH_XIP_ADDR)
+#endif
+
+#ifndef MW_DELTA_SRC_SIZE
+#define MW_DELTA_SRC_SIZE             APP_FLASH_LOAD_SIZE
+#endif
+
+#ifndef MW_DELTA_DST_OFFSET
+#define MW_DELTA_DST_OFFSET           FLASH_FOTA_REGION_START
+#endif
+
+#ifndef MW_DELTA_DST_SIZE
+#define MW_DELTA_DST_SIZE             FLASH_FOTA_REGION_LEN
+#endif
+
+#define MW_DELTA_SECTOR_SIZE          4096
+#define MW_DELTA_PAGE_SIZE            256
+
+#define MW_DELTA_HASH_SIZE            32              //SHA-256
+
+#define MW_DELTA_OK                   0
+#define MW_DELTA_ERR_PARAM            -1
+#define MW_DELTA_ERR_STATE            -2
+#define MW_DELTA_ERR_FORMAT           -3              //not a patch, or a corrupted one
+#define MW_DELTA_ERR_BASE             -4              //made against another image than the running one
+#define MW_DELTA_ERR_SIZE             -5              //new image larger than the FOTA region
+#define MW_DELTA_ERR_FLASH            -6
+#define MW_DELTA_ERR_VERIFY           -7              //rebuilt image fails its hash
+
+typedef enum MwDeltaState_Tag
+{
+    MW_DELTA_IDLE = 0,
+    MW_DELTA_HEADER,            //waiting for the patch header
+    MW_DELTA_PATCHING,
+    MW_DELTA_DONE,              //image rebuilt and verified
+    MW_DELTA_FAILED             //see lastError, mwDeltaAbort() to start over
+}MwDeltaState;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwDeltaProgress_Tag
+{
+    MwDeltaState    state;
+    INT32           lastError;
+    UINT32          patchBytes;         //patch consumed so far
+    UINT32          imageBytes;         //new image rebuilt so far
+    UINT32          imageSize;          //from the header, 0 before it
+    UINT32          copyBytes;          //taken unchanged from the running image
+    UINT32          addBytes;           //taken from it with a byte difference
+    UINT32          insertBytes;        //carried in the patch
+}MwDeltaProgress;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/* Start a new update, dropping any previous one. Nothing is erased yet. */
+INT32 mwDeltaBegin(void);
+
+/*
+ * Feed the next len bytes of the patch. The header is checked against the
+ * running image once it is complete (this reads the whole image once),
+ * then the FOTA region is erased and programmed as the image is rebuilt.
+ * Any error ends the update; later calls return it again.
+ */
+INT32 mwDeltaWrite(const void *data, UINT32 len);
+
+/*
+ * Check the whole patch was fed and the SHA-256 of the image now in the
+ * FOTA region matches the one of the patch. imageSize, if not NULL, gets
+ * the size of the new image.
+ */
+INT32 mwDeltaFinish(UINT32 *imageSize);
+
+/* Drop the update. The FOTA region is left as it is. */
+void mwDeltaAbort(void);
+
+void mwDeltaGetProgress(MwDeltaProgress *progress);
+
+#endif
@@ -0,0 +1,131 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_dns.h
+ * Description:  Non-blocking host name resolver with a persistent TTL cache
+ *               Names are answered from a small cache that is kept in the file system,
+ *               so a connect after a wake-up does not wait for a DNS round trip. An
+ *               entry past its TTL is still returned while a background task refreshes
+ *               it; only a name that was never resolved, or not for a long time, costs
+ *               the caller a lookup.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_DNS_H__
+#define __MW_DNS_H__
+
+#include "commontypedef.h"
+#include "ip_addr.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#ifndef MW_DNS_CACHE_SIZE
+#define MW_DNS_CACHE_SIZE             8
+#endif
+
+#ifndef MW_DNS_MAX_WAITERS
+#define MW_DNS_MAX_WAITERS            8
+#endif
+
+#ifndef MW_DNS_TASK_STACK_SIZE
+#define MW_DNS_TASK_STACK_SIZE        2048
+#endif
+
+#define MW_DNS_NAME_LEN               64      //including the terminating 0
+
+/*
+ * lwIP does not hand the record TTL to its callers, so every answer is
+ * kept for MW_DNS_DEFAULT_TTL. Past MW_DNS_MAX_STALE it is no longer
+ * served and the next lookup waits for the resolver again.
+ */
+#ifndef MW_DNS_DEFAULT_TTL
+#define MW_DNS_DEFAULT_TTL            3600    //seconds
+#endif
+
+#ifndef MW_DNS_MAX_STALE
+#define MW_DNS_MAX_STALE              (7 * 24 * 3600)
+#endif
+
+/* A hit this close to expiry already queues the refresh */
+#define MW_DNS_REFRESH_AHEAD          (MW_DNS_DEFAULT_TTL / 8)
+
+#define MW_DNS_FILE_NAME              "mwdnscache.nvm"
+
+#define MW_DNS_OK                     0
+#define MW_DNS_PENDING                1       //callback follows from the resolver task
+#define MW_DNS_ERR_PARAM              -1
+#define MW_DNS_ERR_FULL               -2
+#define MW_DNS_ERR_RESOLVE            -3
+#define MW_DNS_ERR_SYS                -4
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+
+/* Runs in the resolver task. addr is PNULL when the name could not be resolved. */
+typedef void (*MwDnsResolveCb)(const char *host, const ip_addr_t *addr, void *arg);
+
+typedef struct MwDnsStats_Tag
+{
+    UINT32  hits;               //answered from a fresh entry
+    UINT32  staleHits;          //answered from an expired entry, refresh queued
+    UINT32  misses;
+    UINT32  lookups;            //queries sent through lwIP
+    UINT32  failures;
+    UINT32  invalidated;        //entries dropped by mwDnsInvalidate()
+    UINT32  saves;              //cache file writes
+}MwDnsStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/* Load the cache file and start the resolver task. Called by every API on first use. */
+INT32 mwDnsInit(void);
+
+/*
+ * Non-blocking lookup. Returns MW_DNS_OK with addr set when the cache can
+ * answer, or MW_DNS_PENDING when the name is queued, in which case cb runs
+ * once the resolver is done with it. Numeric addresses are answered at once.
+ */
+INT32 mwDnsResolve(const char *host, ip_addr_t *addr, MwDnsResolveCb cb, void *arg);
+
+/*
+ * Drop-in for netconn_gethostbyname(): answers from the cache when it can
+ * and otherwise resolves in the calling task. Returns an lwIP err_t.
+ */
+INT32 mwDnsGetHostByName(const char *host, ip_addr_t *addr);
+
+/*
+ * Keep host in the cache for good and refresh it in the background when
+ * it expires, so that the connects to it never wait for DNS. Meant for
+ * the broker and server names the application always talks to.
+ */
+INT32 mwDnsAddPrefetchHost(const char *host);
+
+/*
+ * Forget the address of host, e.g. after a connect to it failed, so that
+ * the next lookup asks the network. NULL forgets every name.
+ */
+void mwDnsInvalidate(const char *host);
+
+/*
+ * Write the cache file if anything changed since the last write. A new or
+ * changed address is written by the resolver task right away; refreshed
+ * expiry times only here, so call it before hibernate.
+ */
+INT32 mwDnsSave(void);
+
+void mwDnsGetStats(MwDnsStats *stats);
+
+#endif
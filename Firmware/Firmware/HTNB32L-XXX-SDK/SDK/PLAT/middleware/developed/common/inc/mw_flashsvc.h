@@ -0,0 +1,115 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_flashsvc.h
+ * Description:  Queued flash program/erase service with erase-ahead
+ *               Programs and erases are queued to a flash task instead of being run by
+ *               the caller, so a task streaming data to flash only waits for flash when
+ *               the queue is full. Programs that continue each other in the same page
+ *               are merged while queued, and sectors announced as free are erased in the
+ *               background, so that the erase asked for later costs a blank check.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_FLASHSVC_H__
+#define __MW_FLASHSVC_H__
+
+#include "commontypedef.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_FLASHSVC_FLASH_SIZE        0x400000        //W25Q32, flash offsets 0..4MB
+#define MW_FLASHSVC_SECTOR_SIZE       4096
+#define MW_FLASHSVC_PAGE_SIZE         256
+
+/* Requests queued; a program takes one per page it touches, an erase one */
+#ifndef MW_FLASHSVC_QUEUE_DEPTH
+#define MW_FLASHSVC_QUEUE_DEPTH       8
+#endif
+
+#ifndef MW_FLASHSVC_TASK_STACK_SIZE
+#define MW_FLASHSVC_TASK_STACK_SIZE   1024
+#endif
+
+#define MW_FLASHSVC_OK                0
+#define MW_FLASHSVC_ERR_PARAM         -1
+#define MW_FLASHSVC_ERR_FLASH         -2
+#define MW_FLASHSVC_ERR_TIMEOUT       -3
+#define MW_FLASHSVC_ERR_SYS           -4
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwFlashSvcOpStats_Tag
+{
+    UINT32  count;              //flash operations issued
+    UINT32  totalUs;            //time in the flash driver, the system stalls on XIP meanwhile
+    UINT32  maxUs;
+}MwFlashSvcOpStats;
+
+typedef struct MwFlashSvcStats_Tag
+{
+    MwFlashSvcOpStats   program;
+    MwFlashSvcOpStats   erase;              //queued erases actually run
+    MwFlashSvcOpStats   eraseAhead;         //background erases of announced sectors
+    UINT32              programRequests;    //pages asked for, before merging
+    UINT32              programMerged;      //of them appended to a queued program
+    UINT32              programBytes;
+    UINT32              eraseRequests;      //sectors asked for
+    UINT32              eraseSkipped;       //of them found erased ahead and still blank
+    UINT32              flashErrors;
+    UINT32              queueHigh;          //most requests queued at once
+    UINT32              callerWaits;        //calls that blocked on a full queue or a flush
+    UINT32              callerWaitUs;
+    UINT32              callerWaitMaxUs;
+}MwFlashSvcStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/* Start the flash task. The other calls start it as well when needed. */
+INT32 mwFlashSvcInit(void);
+
+/*
+ * Queue a program of len bytes at flash offset addr; data is copied, the
+ * call returns once it is queued. Errors of queued requests are reported
+ * by mwFlashSvcFlush().
+ */
+INT32 mwFlashSvcProgram(UINT32 addr, const void *data, UINT32 len);
+
+/* Queue the erase of the sectors of [addr, addr + len), both sector aligned */
+INT32 mwFlashSvcErase(UINT32 addr, UINT32 len);
+
+/*
+ * Wait until every request queued so far has reached the flash. Returns
+ * the first error since the previous flush, or MW_FLASHSVC_ERR_TIMEOUT.
+ */
+INT32 mwFlashSvcFlush(UINT32 timeoutMs);
+
+/* Read flash as it will be once the queued requests have run */
+INT32 mwFlashSvcRead(UINT32 addr, void *data, UINT32 len);
+
+/*
+ * Announce that the sectors of [addr, addr + len) hold nothing of value
+ * and will be erased with mwFlashSvcErase() before being written: they
+ * are erased whenever the queue is empty. Nothing may write them before
+ * that mwFlashSvcErase(), which also withdraws the announcement.
+ */
+INT32 mwFlashSvcEraseAhead(UINT32 addr, UINT32 len);
+
+void mwFlashSvcGetStats(MwFlashSvcStats *stats);
+
+void mwFlashSvcResetStats(void);
+
+#endif
@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_kvcfg.h
+ * Description:  Key-value configuration store in a flash sector pair
+ *               Application settings, such as the APN, the broker address or the
+ *               credentials, kept as named values in fixed-size flash slots. A RAM index
+ *               of the key hashes, built by one pass over the active sector at start-up,
+ *               finds a key with a single slot read; neither littlefs nor text parsing
+ *               is involved. An update is one slot program, and either the old or the
+ *               new value survives a reset.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_KVCFG_H__
+#define __MW_KVCFG_H__
+
+#include "commontypedef.h"
+#include "mem_map.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+/* Flash offsets, not XIP addresses. Two sectors. */
+#ifndef MW_KVCFG_REGION_OFFSET
+#define MW_KVCFG_REGION_OFFSET        FLASH_KVCFG_REGION_OFFSET
+#endif
+
+#define MW_KVCFG_SECTOR_SIZE          4096            //erase unit
+#define MW_KVCFG_SLOT_SIZE            128             //a power of two, a slot never crosses a page
+#define MW_KVCFG_SLOTS                (MW_KVCFG_SECTOR_SIZE / MW_KVCFG_SLOT_SIZE)
+
+/* Slot 0 of a sector is its header, each of the others holds one key */
+#define MW_KVCFG_MAX_KEYS             (MW_KVCFG_SLOTS - 1)
+
+#define MW_KVCFG_MAX_KEY_LEN          31
+#define MW_KVCFG_SLOT_DATA            116             //key and value bytes of a slot, together
+
+#define MW_KVCFG_OK                   0
+#define MW_KVCFG_ERR_PARAM            -1
+#define MW_KVCFG_ERR_STATE            -2
+#define MW_KVCFG_ERR_NOT_FOUND        -3
+#define MW_KVCFG_ERR_FULL             -4              //MW_KVCFG_MAX_KEYS keys exist
+#define MW_KVCFG_ERR_FLASH            -5
+#define MW_KVCFG_ERR_SYS              -6
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwKvCfgStats_Tag
+{
+    UINT32  sectorSeq;          //compactions since the region was blank
+    UINT32  keys;
+    UINT32  slotsUsed;          //of the active sector, header included
+    UINT32  writes;             //updates and deletes programmed
+    UINT32  unchanged;          //updates skipped, the value was the same
+    UINT32  sectorErases;
+    UINT32  compactions;
+    UINT32  tornSlots;          //slots failing their CRC, skipped
+    UINT32  flashErrors;
+}MwKvCfgStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/* Build the index from flash. Call once from a task at start-up. */
+INT32 mwKvCfgInit(void);
+
+/*
+ * Copy the value of key to value, at most size bytes. Returns the length
+ * of the value, MW_KVCFG_ERR_PARAM if it is longer than size.
+ */
+INT32 mwKvCfgGet(const CHAR *key, void *value, UINT16 size);
+
+/*
+ * The value of key as a NUL-terminated string in str, or def when the
+ * key is missing, does not fit or the store is not started. Returns str.
+ */
+CHAR *mwKvCfgGetStr(const CHAR *key, CHAR *str, UINT16 size, const CHAR *def);
+
+/*
+ * Set key to the len bytes of value; the key and the value together take
+ * at most MW_KVCFG_SLOT_DATA bytes. Setting the value a key already has
+ * does not touch the flash.
+ */
+INT32 mwKvCfgSet(const CHAR *key, const void *value, UINT16 len);
+
+/* mwKvCfgSet() of a string, without its NUL */
+INT32 mwKvCfgSetStr(const CHAR *key, const CHAR *str);
+
+INT32 mwKvCfgDelete(const CHAR *key);
+
+/* Delete every key */
+INT32 mwKvCfgFormat(void);
+
+void mwKvCfgGetStats(MwKvCfgStats *stats);
+
+#endif
@@ -0,0 +1,65 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_lfs_fastmount.h
+ * Description:  littlefs mount from a snapshot kept across hibernate
+ *               Built with MW_LFS_FASTMOUNT_ENABLE=y only. On the way into hibernate the
+ *               mount state of the file system is copied to retention memory; the
+ *               LFS_Init() of the next wake restores it after a few flash reads instead
+ *               of scanning the metadata and rebuilding the lookahead bitmap.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_LFS_FASTMOUNT_H__
+#define __MW_LFS_FASTMOUNT_H__
+
+#include "commontypedef.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_LFS_SNAP_MAX_LOOKAHEAD     64              //bytes of lookahead bitmap kept
+
+typedef enum MwLfsSnapReject_Tag
+{
+    MW_LFS_SNAP_REJECT_NONE = 0,    //snapshot used
+    MW_LFS_SNAP_REJECT_BOOT,        //not a wake from hibernate
+    MW_LFS_SNAP_REJECT_INVALID,     //none taken, or damaged
+    MW_LFS_SNAP_REJECT_CONFIG,      //taken with another lfs_config
+    MW_LFS_SNAP_REJECT_FLASH        //root pair changed on flash since
+}MwLfsSnapReject;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwLfsFastMountStats_Tag
+{
+    UINT32  fastMounts;         //mounts restored from the snapshot
+    UINT32  fullMounts;         //mounts left to littlefs
+    UINT32  snapshots;          //snapshots taken before hibernate
+    UINT8   lastReject;         //MwLfsSnapReject of the last mount
+    UINT8   reserved[3];
+}MwLfsFastMountStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/*
+ * Drop the snapshot, so that the next wake mounts with a full scan. For
+ * anything that writes the file system area without littlefs.
+ */
+void mwLfsFastMountInvalidate(void);
+
+void mwLfsFastMountGetStats(MwLfsFastMountStats *stats);
+
+#endif
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_lfs_stats.h
+ * Description:  I/O latency and wear instrumentation of the LFS port
+ *               Built with MW_LFS_STATS_ENABLE=y only. Every flash read, program and
+ *               erase littlefs issues, and every file sync, is timed into a log2
+ *               histogram; erases are counted per block, and flash and application
+ *               bytes per file, so that the module wearing the flash or holding tasks on
+ *               the file system can be told from the others.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_LFS_STATS_H__
+#define __MW_LFS_STATS_H__
+
+#include "commontypedef.h"
+#include "mem_map.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_LFS_STATS_BLOCK_SIZE       4096
+#define MW_LFS_STATS_BLOCKS           (FLASH_FS_REGION_SIZE / MW_LFS_STATS_BLOCK_SIZE)
+
+/* Bucket n counts latencies of [2^n, 2^(n+1)) us, the last one everything above */
+#define MW_LFS_STATS_HIST_BUCKETS     20
+
+/* Files tracked by name; later names all share the last entry */
+#ifndef MW_LFS_STATS_MAX_FILES
+#define MW_LFS_STATS_MAX_FILES        16
+#endif
+
+/* Files open at the same time */
+#ifndef MW_LFS_STATS_MAX_OPEN
+#define MW_LFS_STATS_MAX_OPEN         8
+#endif
+
+#define MW_LFS_STATS_NAME_LEN         32
+
+#define MW_LFS_STATS_OK               0
+#define MW_LFS_STATS_END              1               //no file at that index
+#define MW_LFS_STATS_ERR_PARAM        -1
+
+typedef enum MwLfsStatsOp_Tag
+{
+    MW_LFS_STATS_OP_READ = 0,       //flash read
+    MW_LFS_STATS_OP_PROG,           //flash program
+    MW_LFS_STATS_OP_ERASE,          //flash sector erase
+    MW_LFS_STATS_OP_SYNC,           //lfs_file_sync() or lfs_file_close()
+    MW_LFS_STATS_OP_NUM
+}MwLfsStatsOp;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwLfsOpStats_Tag
+{
+    UINT32  count;
+    UINT32  bytes;              //flash bytes, 0 for sync
+    UINT32  totalUs;
+    UINT32  maxUs;
+    UINT32  hist[MW_LFS_STATS_HIST_BUCKETS];
+}MwLfsOpStats;
+
+typedef struct MwLfsStats_Tag
+{
+    MwLfsOpStats    op[MW_LFS_STATS_OP_NUM];
+    UINT32          compactions;    //metadata blocks erased, see mw_lfs_stats.c
+    UINT32          flashErrors;
+    UINT32          blockErases[MW_LFS_STATS_BLOCKS];
+}MwLfsStats;
+
+typedef struct MwLfsFileStats_Tag
+{
+    char    name[MW_LFS_STATS_NAME_LEN];    //truncated path, "*" for the shared entry
+    UINT32  opens;
+    UINT32  bytesRead;          //asked by the application
+    UINT32  bytesWritten;
+    UINT32  syncs;
+    UINT32  syncMaxUs;
+    UINT32  flashReadBytes;     //issued by littlefs on behalf of the file
+    UINT32  flashProgBytes;
+    UINT32  flashErases;
+    UINT32  compactions;
+}MwLfsFileStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+void mwLfsStatsGet(MwLfsStats *stats);
+
+/*
+ * Stats of the file at index, in the order the files were first opened.
+ * Returns MW_LFS_STATS_END past the last one.
+ */
+INT32 mwLfsStatsGetFile(UINT32 index, MwLfsFileStats *stats);
+
+/* Clear all counters. The files keep their entries and names. */
+void mwLfsStatsReset(void);
+
+/*
+ * Send the counters to unilog as three dumps: mwLfsStatsDump_1 carries
+ * MwLfsStats without the block array, _2 the erase count of every block,
+ * _3 one MwLfsFileStats per file. Call from a task, e.g. periodically.
+ */
+void mwLfsStatsDumpToUnilog(void);
+
+#endif
@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_nvjournal.h
+ * Description:  Journaled NV items with field-level delta writes
+ *               Small configuration items kept in RAM and backed by a journal in two
+ *               flash banks. A write appends only the bytes that changed, so updating a
+ *               field costs a page program instead of a sector erase; the active bank
+ *               is compacted into the other one when it fills. On start-up the items
+ *               are rebuilt by replaying the journal of the active bank.
+ *
+ *               Library only: nothing in the SDK calls it. An application that wants
+ *               it builds with MW_NVJ_ENABLE=y and calls mwNvJournalInit() at start-up.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_NVJOURNAL_H__
+#define __MW_NVJOURNAL_H__
+
+#include "commontypedef.h"
+#include "mem_map.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+/* Flash offsets, not XIP addresses. Two banks of whole sectors. */
+#ifndef MW_NVJ_REGION_OFFSET
+#define MW_NVJ_REGION_OFFSET          FLASH_NVJ_REGION_OFFSET
+#endif
+
+#ifndef MW_NVJ_REGION_SIZE
+#define MW_NVJ_REGION_SIZE            FLASH_NVJ_REGION_SIZE
+#endif
+
+#define MW_NVJ_SECTOR_SIZE            4096            //erase unit
+#define MW_NVJ_PAGE_SIZE              256             //program unit, a record never crosses one
+#define MW_NVJ_BANK_SIZE              (MW_NVJ_REGION_SIZE / 2)
+
+/* RAM copy of all items together; a compacted bank must hold it as well */
+#ifndef MW_NVJ_IMAGE_SIZE
+#define MW_NVJ_IMAGE_SIZE             2048
+#endif
+
+#define MW_NVJ_MAX_ITEMS              32              //ids 0..MW_NVJ_MAX_ITEMS-1
+
+#define MW_NVJ_OK                     0
+#define MW_NVJ_ERR_PARAM              -1
+#define MW_NVJ_ERR_STATE              -2
+#define MW_NVJ_ERR_NOT_FOUND          -3
+#define MW_NVJ_ERR_FULL               -4              //items do not fit the image or a bank
+#define MW_NVJ_ERR_FLASH              -5
+#define MW_NVJ_ERR_SYS                -6
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwNvJournalStats_Tag
+{
+    UINT32  bankSeq;            //compactions since the region was blank
+    UINT32  journalUsed;        //bytes of the active bank in use
+    UINT32  imageUsed;          //bytes of item data
+    UINT32  writes;             //writes that changed something
+    UINT32  unchanged;          //writes skipped, nothing differed
+    UINT32  deltaBytes;         //item bytes journaled
+    UINT32  pagePrograms;
+    UINT32  sectorErases;
+    UINT32  compactions;
+    UINT32  replayRecords;      //records read back by the last replay
+    UINT32  tornRecords;        //records failing their CRC, skipped
+    UINT32  flashErrors;
+}MwNvJournalStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/* Rebuild the items from flash. Call once from a task at start-up. */
+INT32 mwNvJournalInit(void);
+
+/*
+ * Set item id to the size bytes of data. Only the ranges that differ from
+ * the current content are written; a write that changes nothing does
+ * not touch the flash. The item is created, or resized, as needed.
+ */
+INT32 mwNvJournalWrite(UINT8 id, const void *data, UINT16 size);
+
+/* Update len bytes at offset of an existing item, the rest is kept */
+INT32 mwNvJournalWriteField(UINT8 id, UINT16 offset, const void *data, UINT16 len);
+
+/*
+ * Copy len bytes at offset of item id. Returns MW_NVJ_ERR_NOT_FOUND for an
+ * item never written, MW_NVJ_ERR_PARAM for a range past its size.
+ */
+INT32 mwNvJournalRead(UINT8 id, UINT16 offset, void *data, UINT16 len);
+
+/* Size of item id, 0 when it does not exist */
+UINT16 mwNvJournalSize(UINT8 id);
+
+INT32 mwNvJournalDelete(UINT8 id);
+
+/* Compact the journal now, e.g. in a quiet moment before it fills */
+INT32 mwNvJournalCompact(void);
+
+/* Delete every item */
+INT32 mwNvJournalFormat(void);
+
+void mwNvJournalGetStats(MwNvJournalStats *stats);
+
+#endif
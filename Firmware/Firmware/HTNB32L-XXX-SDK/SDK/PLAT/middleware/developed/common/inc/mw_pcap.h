@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_pcap.h
+ * Description:  In-RAM packet capture ring for field debugging of the IP link
+ *               Built with MW_PCAP_ENABLE=y only. Packets crossing the lwIP netifs and,
+ *               with MW_PCAP_FASTPATH_ENABLE=y, the PS fast path are stored truncated,
+ *               with a millisecond time stamp, in a fixed RAM ring. The ring is dumped
+ *               to a file or over unilog and turned into pcapng on the host by
+ *               Debug/Scripts/pcap_convert.py.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_PCAP_H__
+#define __MW_PCAP_H__
+
+#include "commontypedef.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#ifndef MW_PCAP_RING_SIZE
+#define MW_PCAP_RING_SIZE             8192
+#endif
+
+/* Enough for the IPv4/IPv6 and TCP/UDP headers plus the start of the payload */
+#define MW_PCAP_DEFAULT_SNAPLEN       96
+
+#ifndef MW_PCAP_MAX_NETIF
+#define MW_PCAP_MAX_NETIF             6
+#endif
+
+#define MW_PCAP_FILE_MAGIC            0x5043504D      //"MPCP"
+#define MW_PCAP_FILE_VERSION          1
+
+#define MW_PCAP_OK                    0
+#define MW_PCAP_ERR_PARAM             -1
+#define MW_PCAP_ERR_STATE             -2
+#define MW_PCAP_ERR_FILE              -3
+
+typedef enum MwPcapDir_Tag
+{
+    MW_PCAP_DIR_IN = 0,
+    MW_PCAP_DIR_OUT
+}MwPcapDir;
+
+typedef enum MwPcapPath_Tag
+{
+    MW_PCAP_PATH_LWIP = 0,      //PS downlink into lwIP and netif output
+    MW_PCAP_PATH_FASTPATH       //forwarded between the PS and a LAN without lwIP
+}MwPcapPath;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+
+/*
+ * Dump layout, the same in the file and over unilog: one MwPcapFileHdr,
+ * then dataLen bytes of records, oldest first. A record is an
+ * MwPcapRecHdr followed by the captured bytes, padded to 4 bytes. All
+ * fields are little endian.
+ */
+typedef struct MwPcapFileHdr_Tag
+{
+    UINT32  magic;
+    UINT16  version;
+    UINT16  snapLen;
+    UINT32  dumpTickMs;         //tick time of the dump, to date the records
+    UINT32  dumpUtcSecs;        //wall clock at the same moment, 0 if unknown
+    UINT32  recorded;           //records since mwPcapStart(), kept or not
+    UINT32  overwritten;        //oldest records dropped for new ones
+    UINT32  dataLen;
+}MwPcapFileHdr;
+
+typedef struct MwPcapRecHdr_Tag
+{
+    UINT16  recLen;             //header + captured bytes + padding
+    UINT16  origLen;            //length of the packet on the link
+    UINT32  tickMs;
+    UINT8   dir;                //MwPcapDir
+    UINT8   path;               //MwPcapPath
+    UINT8   cid;                //PDN context, 0xFF when unknown
+    UINT8   capLen;
+}MwPcapRecHdr;
+
+typedef struct MwPcapStats_Tag
+{
+    UINT32  recorded;
+    UINT32  overwritten;
+    UINT32  skipped;            //not an IP packet, e.g. ROHC compressed
+    UINT32  stopped;            //not recorded because the ring was full in stop mode
+    UINT32  used;               //bytes in the ring now
+}MwPcapStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/*
+ * Empty the ring and start recording the first snapLen (at most 255)
+ * bytes of each packet. When full, the oldest records are overwritten,
+ * or with stopWhenFull recording stops instead.
+ */
+INT32 mwPcapStart(UINT16 snapLen, BOOL stopWhenFull);
+void mwPcapStop(void);
+
+/*
+ * Recording is paused while a dump runs and resumes afterwards; the ring
+ * is kept, so a dump may be repeated.
+ */
+INT32 mwPcapDumpToFile(const char *fileName);
+INT32 mwPcapDumpToUnilog(void);
+
+void mwPcapGetStats(MwPcapStats *stats);
+
+#endif
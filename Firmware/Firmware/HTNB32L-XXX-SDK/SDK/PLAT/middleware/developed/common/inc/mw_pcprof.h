@@ -0,0 +1,105 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_pcprof.h
+ * Description:  PC sampling profiler
+ *               Built with MW_PCPROF_ENABLE=y only. A hardware timer interrupts the core
+ *               at a fixed rate and the PC it interrupted is counted into a histogram in
+ *               RAM. Debug/Scripts/ramcode_hot.py maps the histogram to the functions of
+ *               the ELF and writes the linker script fragment that moves the hottest of
+ *               them out of XIP flash into the .ramcode1 section.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_PCPROF_H__
+#define __MW_PCPROF_H__
+
+#include "commontypedef.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+/* TIMER instance taken by the profiler; the example applications use 0 */
+#ifndef MW_PCPROF_TIMER_INSTANCE
+#define MW_PCPROF_TIMER_INSTANCE      2
+#endif
+
+/* Not a divisor of the 1 kHz OS tick, so samples do not lock to it */
+#define MW_PCPROF_DEFAULT_RATE_HZ     997
+
+/* Histogram entries, a power of two */
+#ifndef MW_PCPROF_SLOTS
+#define MW_PCPROF_SLOTS               1024
+#endif
+
+/* PCs are counted per 2^MW_PCPROF_PC_SHIFT bytes of code */
+#ifndef MW_PCPROF_PC_SHIFT
+#define MW_PCPROF_PC_SHIFT            3
+#endif
+
+/* Entries tried for a PC before its sample is dropped */
+#define MW_PCPROF_PROBES              8
+
+#define MW_PCPROF_OK                  0
+#define MW_PCPROF_END                 1               //no entry at that index
+#define MW_PCPROF_ERR_PARAM           -1
+#define MW_PCPROF_ERR_STATE           -2              //already running
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwPcProfSample_Tag
+{
+    UINT32  pc;                 //first address of the code counted
+    UINT32  count;
+}MwPcProfSample;
+
+typedef struct MwPcProfStats_Tag
+{
+    UINT32  rateHz;             //0 when stopped
+    UINT32  samples;            //counted in the histogram
+    UINT32  missed;             //ticks with no PC captured, see mw_pcprof.c
+    UINT32  dropped;            //PCs that found no free entry
+    UINT32  slotsUsed;
+}MwPcProfStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/*
+ * Start sampling at rateHz, 0 for MW_PCPROF_DEFAULT_RATE_HZ. The histogram
+ * carries on from the previous run, mwPcProfReset() clears it. Sleep is
+ * kept to the idle state until mwPcProfStop().
+ */
+INT32 mwPcProfStart(UINT32 rateHz);
+
+void mwPcProfStop(void);
+
+void mwPcProfReset(void);
+
+void mwPcProfGetStats(MwPcProfStats *stats);
+
+/*
+ * Histogram entry at index, in no particular order. Returns MW_PCPROF_END
+ * past the last one.
+ */
+INT32 mwPcProfGetSample(UINT32 index, MwPcProfSample *sample);
+
+/*
+ * Send the histogram to unilog: mwPcProfDump_1 carries MwPcProfStats, then
+ * each mwPcProfDump_2 up to 32 MwPcProfSample. The payloads of the _2
+ * dumps, joined, are the input of ramcode_hot.py. Call from a task.
+ */
+void mwPcProfDumpToUnilog(void);
+
+#endif
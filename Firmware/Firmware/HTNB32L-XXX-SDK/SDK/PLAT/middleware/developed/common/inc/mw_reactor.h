@@ -0,0 +1,130 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_reactor.h
+ * Description:  Single-task socket reactor shared by the protocol engines
+ *               One task waits in select() on every registered socket and on the earliest
+ *               armed timer, and runs the socket and timer callbacks in its own context.
+ *               A protocol engine registers its socket with mwReactorAddSocket() and its
+ *               retransmission / keep-alive work as an MwReactorTimer instead of running
+ *               a receive task of its own.
+ *
+ *               Callbacks must not block: everything registered shares the same task.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_REACTOR_H__
+#define __MW_REACTOR_H__
+
+#include "commontypedef.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#ifndef MW_REACTOR_MAX_SOCKETS
+#define MW_REACTOR_MAX_SOCKETS        8
+#endif
+
+#ifndef MW_REACTOR_MAX_TIMERS
+#define MW_REACTOR_MAX_TIMERS         16
+#endif
+
+#ifndef MW_REACTOR_POST_QUEUE_SIZE
+#define MW_REACTOR_POST_QUEUE_SIZE    8
+#endif
+
+#ifndef MW_REACTOR_TASK_STACK_SIZE
+#define MW_REACTOR_TASK_STACK_SIZE    4096
+#endif
+
+#define MW_REACTOR_EV_READ            0x01
+#define MW_REACTOR_EV_WRITE           0x02
+#define MW_REACTOR_EV_ERROR           0x04
+
+#define MW_REACTOR_OK                 0
+#define MW_REACTOR_ERR_PARAM          -1
+#define MW_REACTOR_ERR_STATE          -2
+#define MW_REACTOR_ERR_FULL           -3
+#define MW_REACTOR_ERR_NOT_FOUND      -4
+#define MW_REACTOR_ERR_SYS            -5
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+struct MwReactorTimer_Tag;
+
+typedef void (*MwReactorSockCb)(INT32 fd, UINT8 events, void *arg);
+typedef void (*MwReactorTimerCb)(struct MwReactorTimer_Tag *timer, void *arg);
+typedef void (*MwReactorPostCb)(void *arg);
+
+/*
+ * Owned by the caller and linked into the reactor's timer heap while armed,
+ * so arming a timer never allocates. A zero-initialised timer is not armed.
+ */
+typedef struct MwReactorTimer_Tag
+{
+    UINT32              expires;    //tick time in ms
+    UINT32              period;     //0: one shot
+    UINT16              heapPos;    //index in the heap + 1, 0 when not armed
+    UINT16              reserved;
+    MwReactorTimerCb    cb;
+    void                *arg;
+}MwReactorTimer;
+
+typedef struct MwReactorStats_Tag
+{
+    UINT32  loops;              //select() calls
+    UINT32  wakeups;            //select() interrupted by an API call from another task
+    UINT32  sockEvents;         //socket callbacks run
+    UINT32  timersFired;        //timer callbacks run
+    UINT32  posts;              //posted calls run
+    UINT32  postDropped;        //mwReactorPost() with the queue full
+    UINT32  sockDropped;        //sockets found closed while still registered
+    UINT32  maxDispatchMs;      //longest run of callbacks after one select()
+}MwReactorStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/*
+ * Create the reactor task. May be called by every engine that uses it, only
+ * the first call creates it.
+ */
+INT32 mwReactorStart(void);
+BOOL mwReactorInContext(void);
+
+/*
+ * The callback runs in the reactor task with the subset of events that
+ * select() reported. The socket stays registered until mwReactorDelSocket(),
+ * which returns only once a callback already running for it has finished,
+ * so the socket may be closed right after. A socket closed while still
+ * registered is dropped when select() next fails on it.
+ */
+INT32 mwReactorAddSocket(INT32 fd, UINT8 events, MwReactorSockCb cb, void *arg);
+INT32 mwReactorModSocket(INT32 fd, UINT8 events);
+INT32 mwReactorDelSocket(INT32 fd);
+
+void mwReactorTimerInit(MwReactorTimer *timer, MwReactorTimerCb cb, void *arg);
+INT32 mwReactorTimerStart(MwReactorTimer *timer, UINT32 delayMs, UINT32 periodMs);
+void mwReactorTimerStop(MwReactorTimer *timer);
+BOOL mwReactorTimerIsArmed(const MwReactorTimer *timer);
+
+/*
+ * Run cb(arg) once in the reactor task, e.g. to send from a state machine
+ * that is otherwise only touched by its callbacks.
+ */
+INT32 mwReactorPost(MwReactorPostCb cb, void *arg);
+
+void mwReactorGetStats(MwReactorStats *stats);
+
+#endif
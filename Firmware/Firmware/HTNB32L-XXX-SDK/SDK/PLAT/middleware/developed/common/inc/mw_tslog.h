@@ -0,0 +1,128 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_tslog.h
+ * Description:  Append-only telemetry log on a raw flash slice
+ *               Periodic samples are appended as CRC-framed records to a ring of flash
+ *               sectors outside littlefs. Records are gathered in RAM and programmed a
+ *               whole page at a time, and the oldest sector is erased when the ring is
+ *               full. A cursor walks the records in order for upload; after a reset the
+ *               log is recovered from the sector headers and the last intact record.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_TSLOG_H__
+#define __MW_TSLOG_H__
+
+#include "commontypedef.h"
+#include "mem_map.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+/* Flash offsets, not XIP addresses. At least two sectors. */
+#ifndef MW_TSLOG_REGION_OFFSET
+#define MW_TSLOG_REGION_OFFSET        FLASH_TSLOG_REGION_OFFSET
+#endif
+
+#ifndef MW_TSLOG_REGION_SIZE
+#define MW_TSLOG_REGION_SIZE          FLASH_TSLOG_REGION_SIZE
+#endif
+
+#define MW_TSLOG_SECTOR_SIZE          4096            //erase unit
+#define MW_TSLOG_PAGE_SIZE            256             //program unit, and the RAM batch
+
+#ifndef MW_TSLOG_MAX_PAYLOAD
+#define MW_TSLOG_MAX_PAYLOAD          512
+#endif
+
+#define MW_TSLOG_OK                   0
+#define MW_TSLOG_END                  1               //no record after the cursor yet
+#define MW_TSLOG_ERR_PARAM            -1
+#define MW_TSLOG_ERR_STATE            -2
+#define MW_TSLOG_ERR_SIZE             -3              //buffer too small, len tells the size
+#define MW_TSLOG_ERR_FLASH            -4
+#define MW_TSLOG_ERR_SYS              -5
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+
+/* Read position. Plain data: may be copied, or kept across a reset. */
+typedef struct MwTsLogCursor_Tag
+{
+    UINT32  sectorSeq;
+    UINT32  offset;             //in the sector
+}MwTsLogCursor;
+
+typedef struct MwTsLogRecInfo_Tag
+{
+    UINT32  seq;                //record number, one more for each append
+    UINT32  timeSecs;           //wall clock at the append
+    UINT16  len;
+    UINT16  reserved;
+}MwTsLogRecInfo;
+
+typedef struct MwTsLogStats_Tag
+{
+    UINT32  oldestSeq;          //first record still in flash
+    UINT32  nextSeq;            //number the next append gets
+    UINT32  appended;
+    UINT32  pagePrograms;
+    UINT32  sectorErases;
+    UINT32  padBytes;           //page tails left empty by mwTsLogFlush()
+    UINT32  lost;               //records erased by the ring wrapping around
+    UINT32  crcErrors;          //torn or damaged records skipped by readers
+    UINT32  flashErrors;
+}MwTsLogStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+/* Recover the log from flash. Call once from a task at start-up. */
+INT32 mwTsLogInit(void);
+
+/*
+ * O(1) append of one record. Only a full page is programmed; the record
+ * stays in RAM until then, or until mwTsLogFlush(). Starting a new sector
+ * erases it first, which holds the caller for the erase time.
+ */
+INT32 mwTsLogAppend(const void *data, UINT16 len, UINT32 *seq);
+
+/*
+ * Program the records still in RAM, e.g. before hibernate. The rest of
+ * the page is left unused, so flush no more often than needed.
+ */
+INT32 mwTsLogFlush(void);
+
+/* Erase the whole log. Record numbering starts again at 0. */
+INT32 mwTsLogFormat(void);
+
+/*
+ * Place cur on the first record numbered seq or later, or on the oldest
+ * record when seq was already erased. The records still in RAM are seen
+ * by the cursor as well.
+ */
+INT32 mwTsLogSeek(MwTsLogCursor *cur, UINT32 seq);
+
+/*
+ * Copy the record at cur into buf and move cur past it. Returns
+ * MW_TSLOG_END when cur has reached the newest record, and skips records
+ * that fail their CRC. A cursor left behind by a wrap of the ring moves
+ * on to the oldest record; the jump shows in info->seq.
+ */
+INT32 mwTsLogRead(MwTsLogCursor *cur, MwTsLogRecInfo *info, void *buf, UINT16 size);
+
+void mwTsLogGetStats(MwTsLogStats *stats);
+
+#endif
@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_uplink.h
+ * Description:  Prioritized uplink arbiter between the application APIs and sockets
+ *               Messages are queued per traffic class and sent by one task, always from
+ *               the highest class that has something to send and budget left. A long
+ *               upload therefore delays an alarm by at most the message on air, provided
+ *               it is submitted in chunks (MW_UPLINK_CHUNK_HINT) rather than as one
+ *               large write.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifndef __MW_UPLINK_H__
+#define __MW_UPLINK_H__
+
+#include "commontypedef.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#ifndef MW_UPLINK_TASK_STACK_SIZE
+#define MW_UPLINK_TASK_STACK_SIZE     2048
+#endif
+
+/* A bulk chunk of this size is ~0.2 s on air at 20 kbps */
+#define MW_UPLINK_CHUNK_HINT          512
+
+/*
+ * Queueing delay histogram: bucket 0 counts 0 ms, bucket i counts
+ * [2^(i-1), 2^i) ms and the last bucket everything from 16.4 s up.
+ */
+#define MW_UPLINK_HIST_BUCKETS        16
+
+#define MW_UPLINK_OK                  0
+#define MW_UPLINK_ERR_PARAM           -1
+#define MW_UPLINK_ERR_FULL            -2
+#define MW_UPLINK_ERR_NO_MEMORY       -3
+#define MW_UPLINK_ERR_SYS             -4
+
+typedef enum MwUplinkClass_Tag
+{
+    MW_UPLINK_CLASS_ALARM = 0,      //never budget limited by default
+    MW_UPLINK_CLASS_CONTROL,        //registration, acks, responses
+    MW_UPLINK_CLASS_TELEMETRY,      //periodic reports
+    MW_UPLINK_CLASS_BULK,           //uploads, log backlog, firmware reports
+    MW_UPLINK_CLASS_NUM
+}MwUplinkClass;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+
+/* Runs in the uplink task. Returns < 0 on failure. */
+typedef INT32 (*MwUplinkSendFn)(void *ctx, UINT32 param, const UINT8 *data, UINT16 len);
+/* Optional, runs in the uplink task with the result of the send function */
+typedef void (*MwUplinkDoneFn)(void *ctx, UINT32 param, INT32 result);
+
+typedef struct MwUplinkClassStats_Tag
+{
+    UINT32  queued;             //messages waiting now
+    UINT32  queuedBytes;
+    UINT32  sent;
+    UINT32  sentBytes;
+    UINT32  failed;             //send function returned < 0
+    UINT32  rejected;           //queue over its byte limit at submit
+    UINT32  maxDelayMs;
+    UINT32  delayHist[MW_UPLINK_HIST_BUCKETS];
+}MwUplinkClassStats;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+INT32 mwUplinkInit(void);
+
+/*
+ * Token bucket for one class: bytesPerSec 0 means unlimited. maxQueuedBytes
+ * bounds what may wait in the class queue, 0 keeps the current limit.
+ * Defaults: BULK 1500 B/s, 3000 byte burst and 8 KB of queue; the others
+ * unlimited with 2 KB of queue.
+ */
+INT32 mwUplinkSetBudget(MwUplinkClass cls, UINT32 bytesPerSec, UINT32 burstBytes, UINT32 maxQueuedBytes);
+
+/*
+ * Queue a copy of data, to be passed to send(ctx, param, ...) when its turn
+ * comes. Messages of one class are sent in submission order.
+ */
+INT32 mwUplinkSubmit(MwUplinkClass cls, MwUplinkSendFn send, MwUplinkDoneFn done,
+                     void *ctx, UINT32 param, const UINT8 *data, UINT16 len);
+/* Same, with head stored in front of data, e.g. a topic before its payload */
+INT32 mwUplinkSubmitV(MwUplinkClass cls, MwUplinkSendFn send, MwUplinkDoneFn done, void *ctx, UINT32 param,
+                      const UINT8 *head, UINT16 headLen, const UINT8 *data, UINT16 dataLen);
+
+/* tcpipConnectionSend() through the arbiter */
+INT32 mwUplinkTcpipSend(MwUplinkClass cls, INT32 connectionId, const UINT8 *data, UINT16 len, UINT8 raiInfo);
+
+void mwUplinkGetStats(MwUplinkClass cls, MwUplinkClassStats *stats);
+void mwUplinkResetStats(void);
+
+#endif
@@ -0,0 +1,632 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_delta.c
+ * Description:  Delta firmware update into the FOTA region
+ *               Between two builds most of the application image is unchanged, only
+ *               moved: code is inserted or removed somewhere and everything behind it
+ *               shifts, and the addresses that refer across the shift change by the
+ *               same amount. A patch that says where to take each part of the new image
+ *               from the old one, plus the bytes that are really new, is a small part of
+ *               a full image, which over NB-IoT is the bulk of the time and energy of an
+ *               update.
+ *
+ *               The patch is a header and a stream of operations on a read pointer into
+ *               the running image:
+ *
+ *               COPY   n          n bytes of the old image, as they are
+ *               ADD    n, d[n]    n bytes of the old image, each plus the byte of d
+ *               INSERT n, b[n]    n bytes carried in the patch
+ *               SEEK   delta      move the read pointer
+ *
+ *               ADD is what keeps moved code cheap: an instruction whose branch offset
+ *               or literal changed differs from the old one in a byte or two, so the
+ *               difference is mostly zeros and runs of COPY/ADD follow each other
+ *               without SEEKs. Numbers are LEB128 varints, SEEK zigzag coded.
+ *
+ *               Operations are applied as their bytes arrive, so the patch is never
+ *               stored: the new image is built in a one-page buffer that is queued to
+ *               the flash service when full, each sector erased as the image reaches
+ *               it. The whole FOTA area the image needs is announced to the service as
+ *               soon as the header is accepted, so the erases mostly happen in the
+ *               background while the next patch bytes are on their way. The old image
+ *               is read from flash as needed, the running image is never written. The
+ *               header carries the SHA-256 of the old image, checked before anything is
+ *               erased, and of the new one, checked on the FOTA region once the image
+ *               is complete.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifdef MW_DELTA_ENABLE
+
+#include <string.h>
+#include "mbedtls/sha256.h"
+#include "cmsis_os2.h"
+#include "flash_qcx212_rt.h"
+#include "debug_log.h"
+#include "mw_chksum.h"
+#include "mw_flashsvc.h"
+#include "mw_delta.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_DELTA_MAGIC                0x544C444D      //"MDLT"
+#define MW_DELTA_VERSION              1
+
+/* Header, little endian, see fota_delta.py */
+#define MW_DELTA_HDR_MAGIC            0
+#define MW_DELTA_HDR_VERSION          4               //UINT16
+#define MW_DELTA_HDR_HDRSIZE          6               //UINT16
+#define MW_DELTA_HDR_OLDSIZE          8
+#define MW_DELTA_HDR_NEWSIZE          12
+#define MW_DELTA_HDR_BODYSIZE         16              //operation bytes after the header
+#define MW_DELTA_HDR_OLDHASH          20
+#define MW_DELTA_HDR_NEWHASH          52
+#define MW_DELTA_HDR_CRC              84              //CRC-32 of the bytes above
+#define MW_DELTA_HDR_SIZE             88
+
+typedef enum MwDeltaOp_Tag
+{
+    MW_DELTA_OP_COPY = 1,
+    MW_DELTA_OP_ADD,
+    MW_DELTA_OP_INSERT,
+    MW_DELTA_OP_SEEK
+}MwDeltaOp;
+
+typedef enum MwDeltaPhase_Tag
+{
+    MW_DELTA_PHASE_OP = 0,              //next byte is an operation
+    MW_DELTA_PHASE_ARG,                 //in its varint
+    MW_DELTA_PHASE_DATA                 //in the bytes of an ADD or INSERT
+}MwDeltaPhase;
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwDeltaContext_Tag
+{
+    UINT8               phase;
+    UINT8               op;
+    UINT8               argShift;
+    UINT8               reserved;
+    UINT32              arg;
+    UINT32              remaining;                  //bytes left of the ADD or INSERT
+    UINT32              hdrFill;
+    UINT32              oldSize;
+    UINT32              newSize;
+    UINT32              bodySize;
+    UINT32              bodyFill;
+    UINT32              src;                        //read pointer into the old image
+    UINT32              pageFill;                   //new image is at imageBytes, page[] holds its tail
+    UINT8               newHash[MW_DELTA_HASH_SIZE];
+    UINT8               hdr[MW_DELTA_HDR_SIZE];
+    UINT8               page[MW_DELTA_PAGE_SIZE];
+    MwDeltaProgress     progress;
+}MwDeltaContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwDeltaContext mwDelta;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT32 mwDeltaGet32(const UINT8 *p)
+{
+    return (UINT32)p[0] | ((UINT32)p[1] << 8) | ((UINT32)p[2] << 16) | ((UINT32)p[3] << 24);
+}
+
+static UINT16 mwDeltaGet16(const UINT8 *p)
+{
+    return (UINT16)(p[0] | (p[1] << 8));
+}
+
+static INT32 mwDeltaFail(INT32 err)
+{
+    mwDelta.progress.state = MW_DELTA_FAILED;
+    mwDelta.progress.lastError = err;
+
+    HT_TRACE(UNILOG_PLA_MIDWARE, mwDeltaFail_1, P_WARNING, 3,
+             "delta: error %d at patch byte %u, image byte %u",
+             err, mwDelta.progress.patchBytes, mwDelta.progress.imageBytes);
+    return err;
+}
+
+/* SHA-256 of len bytes of flash at addr, read through page[] */
+static INT32 mwDeltaHashFlash(UINT32 addr, UINT32 len, UINT8 *hash)
+{
+    mbedtls_sha256_context sha;
+    INT32 ret = MW_DELTA_OK;
+    UINT32 n;
+
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+
+    while (len > 0)
+    {
+        n = (len < MW_DELTA_PAGE_SIZE) ? len : MW_DELTA_PAGE_SIZE;
+        if (BSP_QSPI_Read_Safe(mwDelta.page, addr, n) != QSPI_OK)
+        {
+            ret = MW_DELTA_ERR_FLASH;
+            break;
+        }
+
+        mbedtls_sha256_update_ret(&sha, mwDelta.page, n);
+        addr += n;
+        len -= n;
+    }
+
+    mbedtls_sha256_finish_ret(&sha, hash);
+    mbedtls_sha256_free(&sha);
+    return ret;
+}
+
+static INT32 mwDeltaCheckHeader(void)
+{
+    const UINT8 *h = mwDelta.hdr;
+    UINT8 hash[MW_DELTA_HASH_SIZE];
+    INT32 ret;
+
+    if (mwDeltaGet32(&h[MW_DELTA_HDR_MAGIC]) != MW_DELTA_MAGIC ||
+        mwDeltaGet16(&h[MW_DELTA_HDR_VERSION]) != MW_DELTA_VERSION ||
+        mwDeltaGet16(&h[MW_DELTA_HDR_HDRSIZE]) != MW_DELTA_HDR_SIZE ||
+        mwDeltaGet32(&h[MW_DELTA_HDR_CRC]) != ~mwCrc32(0xFFFFFFFF, h, MW_DELTA_HDR_CRC))
+    {
+        return MW_DELTA_ERR_FORMAT;
+    }
+
+    mwDelta.oldSize = mwDeltaGet32(&h[MW_DELTA_HDR_OLDSIZE]);
+    mwDelta.newSize = mwDeltaGet32(&h[MW_DELTA_HDR_NEWSIZE]);
+    mwDelta.bodySize = mwDeltaGet32(&h[MW_DELTA_HDR_BODYSIZE]);
+    memcpy(mwDelta.newHash, &h[MW_DELTA_HDR_NEWHASH], MW_DELTA_HASH_SIZE);
+
+    HT_TRACE(UNILOG_PLA_MIDWARE, mwDeltaHeader_1, P_INFO, 3,
+             "delta: old image %u, new image %u, patch %u",
+             mwDelta.oldSize, mwDelta.newSize, mwDelta.bodySize);
+
+    if (mwDelta.newSize == 0 || mwDelta.bodySize == 0)
+    {
+        return MW_DELTA_ERR_FORMAT;
+    }
+
+    if (mwDelta.newSize > MW_DELTA_DST_SIZE)
+    {
+        return MW_DELTA_ERR_SIZE;
+    }
+
+    if (mwDelta.oldSize > MW_DELTA_SRC_SIZE)
+    {
+        return MW_DELTA_ERR_BASE;
+    }
+
+    ret = mwDeltaHashFlash(MW_DELTA_SRC_OFFSET, mwDelta.oldSize, hash);
+    if (ret != MW_DELTA_OK)
+    {
+        return ret;
+    }
+
+    if (memcmp(hash, &h[MW_DELTA_HDR_OLDHASH], MW_DELTA_HASH_SIZE) != 0)
+    {
+        return MW_DELTA_ERR_BASE;
+    }
+
+    /* Nothing in the FOTA region is of value any more */
+    mwFlashSvcEraseAhead(MW_DELTA_DST_OFFSET,
+                         (mwDelta.newSize + MW_DELTA_SECTOR_SIZE - 1) & ~(UINT32)(MW_DELTA_SECTOR_SIZE - 1));
+
+    mwDelta.progress.imageSize = mwDelta.newSize;
+    mwDelta.progress.state = MW_DELTA_PATCHING;
+    return MW_DELTA_OK;
+}
+
+/*
+ * Room left in page[] for the new image, erasing the sector the page
+ * belongs to when it is the first one of it
+ */
+static INT32 mwDeltaRoom(UINT32 *room)
+{
+    UINT32 out = mwDelta.progress.imageBytes;
+
+    if (mwDelta.pageFill == 0 && (out % MW_DELTA_SECTOR_SIZE) == 0)
+    {
+        if (mwFlashSvcErase(MW_DELTA_DST_OFFSET + out, MW_DELTA_SECTOR_SIZE) != MW_FLASHSVC_OK)
+        {
+            return MW_DELTA_ERR_FLASH;
+        }
+    }
+
+    *room = MW_DELTA_PAGE_SIZE - mwDelta.pageFill;
+    return MW_DELTA_OK;
+}
+
+/* Queue page[] up to pageFill to be programmed at the page it belongs to */
+static INT32 mwDeltaFlushPage(void)
+{
+    UINT32 addr = MW_DELTA_DST_OFFSET + mwDelta.progress.imageBytes - mwDelta.pageFill;
+
+    if (mwDelta.pageFill == 0)
+    {
+        return MW_DELTA_OK;
+    }
+
+    if (mwFlashSvcProgram(addr, mwDelta.page, mwDelta.pageFill) != MW_FLASHSVC_OK)
+    {
+        return MW_DELTA_ERR_FLASH;
+    }
+
+    mwDelta.pageFill = 0;
+    return MW_DELTA_OK;
+}
+
+/* n bytes were placed at page[pageFill] */
+static INT32 mwDeltaCommit(UINT32 n)
+{
+    mwDelta.pageFill += n;
+    mwDelta.progress.imageBytes += n;
+
+    if (mwDelta.pageFill == MW_DELTA_PAGE_SIZE)
+    {
+        return mwDeltaFlushPage();
+    }
+
+    return MW_DELTA_OK;
+}
+
+/* Place up to n bytes of the old image at the read pointer, returns how many or an error */
+static INT32 mwDeltaTakeOld(UINT32 n)
+{
+    UINT32 room;
+    INT32 ret;
+
+    ret = mwDeltaRoom(&room);
+    if (ret != MW_DELTA_OK)
+    {
+        return ret;
+    }
+
+    if (n > room)
+    {
+        n = room;
+    }
+
+    if (BSP_QSPI_Read_Safe(&mwDelta.page[mwDelta.pageFill], MW_DELTA_SRC_OFFSET + mwDelta.src, n) != QSPI_OK)
+    {
+        return MW_DELTA_ERR_FLASH;
+    }
+
+    mwDelta.src += n;
+    return (INT32)n;
+}
+
+static INT32 mwDeltaCopy(UINT32 len)
+{
+    INT32 n, ret;
+
+    while (len > 0)
+    {
+        n = mwDeltaTakeOld(len);
+        if (n < 0)
+        {
+            return n;
+        }
+
+        ret = mwDeltaCommit((UINT32)n);
+        if (ret != MW_DELTA_OK)
+        {
+            return ret;
+        }
+
+        len -= (UINT32)n;
+    }
+
+    return MW_DELTA_OK;
+}
+
+/* Bytes of the current ADD or INSERT, returns how many of data were used or an error */
+static INT32 mwDeltaData(const UINT8 *data, UINT32 len)
+{
+    UINT32 room, i;
+    INT32 n, ret;
+
+    if (len > mwDelta.remaining)
+    {
+        len = mwDelta.remaining;
+    }
+
+    if (mwDelta.op == MW_DELTA_OP_ADD)
+    {
+        n = mwDeltaTakeOld(len);
+        if (n < 0)
+        {
+            return n;
+        }
+
+        for (i = 0; i < (UINT32)n; i++)
+        {
+            mwDelta.page[mwDelta.pageFill + i] += data[i];
+        }
+        mwDelta.progress.addBytes += (UINT32)n;
+    }
+    else
+    {
+        ret = mwDeltaRoom(&room);
+        if (ret != MW_DELTA_OK)
+        {
+            return ret;
+        }
+
+        n = (INT32)((len < room) ? len : room);
+        memcpy(&mwDelta.page[mwDelta.pageFill], data, (UINT32)n);
+        mwDelta.progress.insertBytes += (UINT32)n;
+    }
+
+    mwDelta.remaining -= (UINT32)n;
+    ret = mwDeltaCommit((UINT32)n);
+    return (ret == MW_DELTA_OK) ? n : ret;
+}
+
+/* The varint of the current operation is complete */
+static INT32 mwDeltaApply(void)
+{
+    UINT32 arg = mwDelta.arg;
+    INT32 delta;
+
+    if (mwDelta.op == MW_DELTA_OP_SEEK)
+    {
+        delta = (INT32)(arg >> 1) ^ -(INT32)(arg & 1);
+        if ((delta < 0 && (UINT32)-delta > mwDelta.src) ||
+            (delta > 0 && (UINT32)delta > mwDelta.oldSize - mwDelta.src))
+        {
+            return MW_DELTA_ERR_FORMAT;
+        }
+
+        mwDelta.src += (UINT32)delta;
+        mwDelta.phase = MW_DELTA_PHASE_OP;
+        return MW_DELTA_OK;
+    }
+
+    if (arg > mwDelta.newSize - mwDelta.progress.imageBytes ||
+        (mwDelta.op != MW_DELTA_OP_INSERT && arg > mwDelta.oldSize - mwDelta.src))
+    {
+        return MW_DELTA_ERR_FORMAT;
+    }
+
+    if (mwDelta.op == MW_DELTA_OP_COPY)
+    {
+        mwDelta.progress.copyBytes += arg;
+        mwDelta.phase = MW_DELTA_PHASE_OP;
+        return mwDeltaCopy(arg);
+    }
+
+    mwDelta.remaining = arg;
+    mwDelta.phase = (arg > 0) ? MW_DELTA_PHASE_DATA : MW_DELTA_PHASE_OP;
+    return MW_DELTA_OK;
+}
+
+/* Operation bytes, at most what is left of the body */
+static INT32 mwDeltaBody(const UINT8 *data, UINT32 len)
+{
+    UINT8 b;
+    INT32 n, ret;
+
+    while (len > 0)
+    {
+        switch (mwDelta.phase)
+        {
+            case MW_DELTA_PHASE_OP:
+                b = *data++;
+                len--;
+                if (b < MW_DELTA_OP_COPY || b > MW_DELTA_OP_SEEK)
+                {
+                    return MW_DELTA_ERR_FORMAT;
+                }
+
+                mwDelta.op = b;
+                mwDelta.arg = 0;
+                mwDelta.argShift = 0;
+                mwDelta.phase = MW_DELTA_PHASE_ARG;
+                break;
+
+            case MW_DELTA_PHASE_ARG:
+                b = *data++;
+                len--;
+                if (mwDelta.argShift > 28 || (mwDelta.argShift == 28 && (b & 0x70) != 0))
+                {
+                    return MW_DELTA_ERR_FORMAT;
+                }
+
+                mwDelta.arg |= (UINT32)(b & 0x7F) << mwDelta.argShift;
+                mwDelta.argShift += 7;
+                if ((b & 0x80) == 0)
+                {
+                    ret = mwDeltaApply();
+                    if (ret != MW_DELTA_OK)
+                    {
+                        return ret;
+                    }
+                }
+                break;
+
+            default:
+                n = mwDeltaData(data, len);
+                if (n < 0)
+                {
+                    return n;
+                }
+
+                data += n;
+                len -= (UINT32)n;
+                if (mwDelta.remaining == 0)
+                {
+                    mwDelta.phase = MW_DELTA_PHASE_OP;
+                }
+                break;
+        }
+    }
+
+    return MW_DELTA_OK;
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+INT32 mwDeltaBegin(void)
+{
+    memset(&mwDelta, 0, sizeof(mwDelta));
+    mwDelta.progress.state = MW_DELTA_HEADER;
+    return MW_DELTA_OK;
+}
+
+INT32 mwDeltaWrite(const void *data, UINT32 len)
+{
+    const UINT8 *p = (const UINT8 *)data;
+    UINT32 n;
+    INT32 ret;
+
+    if (mwDelta.progress.state == MW_DELTA_FAILED)
+    {
+        return mwDelta.progress.lastError;
+    }
+
+    if (mwDelta.progress.state != MW_DELTA_HEADER && mwDelta.progress.state != MW_DELTA_PATCHING)
+    {
+        return MW_DELTA_ERR_STATE;
+    }
+
+    if (p == NULL && len > 0)
+    {
+        return MW_DELTA_ERR_PARAM;
+    }
+
+    if (mwDelta.progress.state == MW_DELTA_HEADER)
+    {
+        n = MW_DELTA_HDR_SIZE - mwDelta.hdrFill;
+        if (n > len)
+        {
+            n = len;
+        }
+
+        memcpy(&mwDelta.hdr[mwDelta.hdrFill], p, n);
+        mwDelta.hdrFill += n;
+        mwDelta.progress.patchBytes += n;
+        p += n;
+        len -= n;
+
+        if (mwDelta.hdrFill < MW_DELTA_HDR_SIZE)
+        {
+            return MW_DELTA_OK;
+        }
+
+        ret = mwDeltaCheckHeader();
+        if (ret != MW_DELTA_OK)
+        {
+            return mwDeltaFail(ret);
+        }
+    }
+
+    if (len > mwDelta.bodySize - mwDelta.bodyFill)
+    {
+        return mwDeltaFail(MW_DELTA_ERR_FORMAT);
+    }
+
+    ret = mwDeltaBody(p, len);
+    mwDelta.bodyFill += len;
+    mwDelta.progress.patchBytes += len;
+    if (ret != MW_DELTA_OK)
+    {
+        return mwDeltaFail(ret);
+    }
+
+    return MW_DELTA_OK;
+}
+
+INT32 mwDeltaFinish(UINT32 *imageSize)
+{
+    UINT8 hash[MW_DELTA_HASH_SIZE];
+    INT32 ret;
+
+    if (mwDelta.progress.state == MW_DELTA_FAILED)
+    {
+        return mwDelta.progress.lastError;
+    }
+
+    if (mwDelta.progress.state != MW_DELTA_PATCHING && mwDelta.progress.state != MW_DELTA_DONE)
+    {
+        return MW_DELTA_ERR_STATE;
+    }
+
+    if (mwDelta.progress.state == MW_DELTA_PATCHING)
+    {
+        if (mwDelta.bodyFill != mwDelta.bodySize || mwDelta.phase != MW_DELTA_PHASE_OP ||
+            mwDelta.progress.imageBytes != mwDelta.newSize)
+        {
+            return mwDeltaFail(MW_DELTA_ERR_FORMAT);
+        }
+
+        ret = mwDeltaFlushPage();
+        if (ret == MW_DELTA_OK && mwFlashSvcFlush(osWaitForever) != MW_FLASHSVC_OK)
+        {
+            ret = MW_DELTA_ERR_FLASH;
+        }
+        if (ret == MW_DELTA_OK)
+        {
+            ret = mwDeltaHashFlash(MW_DELTA_DST_OFFSET, mwDelta.newSize, hash);
+        }
+
+        if (ret == MW_DELTA_OK && memcmp(hash, mwDelta.newHash, MW_DELTA_HASH_SIZE) != 0)
+        {
+            ret = MW_DELTA_ERR_VERIFY;
+        }
+
+        if (ret != MW_DELTA_OK)
+        {
+            return mwDeltaFail(ret);
+        }
+
+        mwDelta.progress.state = MW_DELTA_DONE;
+
+        HT_TRACE(UNILOG_PLA_MIDWARE, mwDeltaDone_1, P_INFO, 4,
+                 "delta: image %u rebuilt from patch %u, copied %u, inserted %u",
+                 mwDelta.newSize, mwDelta.progress.patchBytes,
+                 mwDelta.progress.copyBytes + mwDelta.progress.addBytes, mwDelta.progress.insertBytes);
+    }
+
+    if (imageSize != NULL)
+    {
+        *imageSize = mwDelta.newSize;
+    }
+
+    return MW_DELTA_OK;
+}
+
+void mwDeltaAbort(void)
+{
+    memset(&mwDelta, 0, sizeof(mwDelta));
+}
+
+void mwDeltaGetProgress(MwDeltaProgress *progress)
+{
+    if (progress != NULL)
+    {
+        *progress = mwDelta.progress;
+    }
+}
+
+#endif
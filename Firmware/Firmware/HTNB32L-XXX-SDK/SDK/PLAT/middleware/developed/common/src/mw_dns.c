@@ -0,0 +1,709 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_dns.c
+ * Description:  Non-blocking host name resolver with a persistent TTL cache
+ *               NetworkConnect() used to call netconn_gethostbyname() before every
+ *               connect. lwIP's own cache does not survive hibernate, so each wake-up
+ *               paid a DNS round trip, often more than a second on NB-IoT, before the
+ *               first byte of the session could go out.
+ *
+ *               The cache here lives in the file system and is served stale-while-
+ *               revalidate: an expired entry still answers at once, and the name is
+ *               queued for the resolver task, which runs the blocking lwIP lookup and
+ *               stores the result. A connect to an address that has moved fails, the
+ *               caller invalidates the name and the retry resolves it afresh, so a
+ *               stale answer costs at most one failed attempt. Names registered with
+ *               mwDnsAddPrefetchHost() are never evicted and are refreshed as soon as
+ *               they are found expired, normally before anybody asks for them.
+ *
+ *               Ages are taken from the wall clock, which keeps running in hibernate.
+ *               An entry that appears to come from the future, because the clock was
+ *               set back, is treated as expired.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#include <string.h>
+#include "cmsis_os2.h"
+#include "osasys.h"
+#include "api.h"
+#include "mw_dns.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_DNS_FILE_MAGIC             0x534E444D      //"MDNS"
+#define MW_DNS_FILE_VERSION           1
+
+#define MW_DNS_FLAG_VALID             0x01            //addr holds an answer
+#define MW_DNS_FLAG_PINNED            0x02            //prefetch host, never evicted
+
+typedef enum MwDnsState_Tag
+{
+    MW_DNS_STOPPED = 0,
+    MW_DNS_STARTING,                //one caller of mwDnsInit() creates the task
+    MW_DNS_RUNNING
+}MwDnsState;
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwDnsEntry_Tag
+{
+    char        name[MW_DNS_NAME_LEN];      //empty: slot free
+    ip_addr_t   addr;
+    UINT32      resolved;                   //wall clock seconds of the last answer
+    UINT32      lastUse;                    //use sequence number, for LRU eviction
+    UINT8       flags;
+    UINT8       refresh;                    //queued for, or in, the resolver; not saved
+    UINT16      reserved;
+}MwDnsEntry;
+
+typedef struct MwDnsFileHdr_Tag
+{
+    UINT32      magic;
+    UINT16      version;
+    UINT8       count;
+    UINT8       crc;                        //mwDnsCrc() over the entries
+}MwDnsFileHdr;
+
+typedef struct MwDnsWaiter_Tag
+{
+    MwDnsResolveCb  cb;
+    void            *arg;
+    UINT8           used;
+    UINT8           entry;
+}MwDnsWaiter;
+
+typedef struct MwDnsContext_Tag
+{
+    osThreadId_t        task;
+    osMutexId_t         lock;
+    osMutexId_t         fileLock;
+    osSemaphoreId_t     work;
+    volatile UINT8      state;
+    UINT8               dirty;
+    UINT32              useSeq;
+    MwDnsEntry          entry[MW_DNS_CACHE_SIZE];
+    MwDnsWaiter         waiter[MW_DNS_MAX_WAITERS];
+    MwDnsStats          stats;
+}MwDnsContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwDnsContext mwDns;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT32 mwDnsNow(void)
+{
+    return (UINT32)OsaSystemTimeReadSecs();
+}
+
+static UINT32 mwDnsAge(const MwDnsEntry *e, UINT32 now)
+{
+    if (now < e->resolved)
+    {
+        return MW_DNS_DEFAULT_TTL;
+    }
+    return now - e->resolved;
+}
+
+/* OsaCalcCrcValue() asserts on an empty buffer, and an empty cache is saved too */
+static UINT8 mwDnsCrc(const MwDnsEntry *entry, UINT32 count)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    return OsaCalcCrcValue((const UINT8 *)entry, (UINT16)(count * sizeof(MwDnsEntry)));
+}
+
+static MwDnsEntry *mwDnsFind(const char *host)
+{
+    UINT32 i;
+
+    for (i = 0; i < MW_DNS_CACHE_SIZE; i++)
+    {
+        if (mwDns.entry[i].name[0] != 0 && strcmp(mwDns.entry[i].name, host) == 0)
+        {
+            return &mwDns.entry[i];
+        }
+    }
+    return PNULL;
+}
+
+/* A free slot, else the least recently used one that is neither pinned nor being resolved */
+static MwDnsEntry *mwDnsAlloc(const char *host)
+{
+    MwDnsEntry *victim = PNULL;
+    MwDnsEntry *e;
+    UINT32 i;
+
+    for (i = 0; i < MW_DNS_CACHE_SIZE; i++)
+    {
+        e = &mwDns.entry[i];
+        if (e->name[0] == 0)
+        {
+            victim = e;
+            break;
+        }
+        if ((e->flags & MW_DNS_FLAG_PINNED) || e->refresh)
+        {
+            continue;
+        }
+        if (victim == PNULL || (INT32)(e->lastUse - victim->lastUse) < 0)
+        {
+            victim = e;
+        }
+    }
+
+    if (victim != PNULL)
+    {
+        memset(victim, 0, sizeof(MwDnsEntry));
+        strcpy(victim->name, host);
+    }
+    return victim;
+}
+
+static void mwDnsQueue(MwDnsEntry *e)
+{
+    if (!e->refresh)
+    {
+        e->refresh = 1;
+        osSemaphoreRelease(mwDns.work);
+    }
+}
+
+/*
+ * Look host up in the cache with the lock held. Returns TRUE with addr set
+ * when the entry may be served, queueing a refresh when it is due.
+ */
+static BOOL mwDnsLookup(const char *host, ip_addr_t *addr)
+{
+    MwDnsEntry *e = mwDnsFind(host);
+    UINT32 age;
+
+    if (e == PNULL || !(e->flags & MW_DNS_FLAG_VALID))
+    {
+        mwDns.stats.misses++;
+        return FALSE;
+    }
+
+    age = mwDnsAge(e, mwDnsNow());
+    if (age >= MW_DNS_MAX_STALE)
+    {
+        mwDns.stats.misses++;
+        return FALSE;
+    }
+
+    if (age < MW_DNS_DEFAULT_TTL)
+    {
+        mwDns.stats.hits++;
+    }
+    else
+    {
+        mwDns.stats.staleHits++;
+    }
+    if (age >= MW_DNS_DEFAULT_TTL - MW_DNS_REFRESH_AHEAD)
+    {
+        mwDnsQueue(e);
+    }
+
+    e->lastUse = ++mwDns.useSeq;
+    ip_addr_copy(*addr, e->addr);
+    return TRUE;
+}
+
+/* Store an answer with the lock held. Returns TRUE when the saved state changed. */
+static BOOL mwDnsStore(MwDnsEntry *e, const ip_addr_t *addr)
+{
+    BOOL changed = !(e->flags & MW_DNS_FLAG_VALID) || !ip_addr_cmp(&e->addr, addr);
+
+    ip_addr_copy(e->addr, *addr);
+    e->resolved = mwDnsNow();
+    e->lastUse = ++mwDns.useSeq;
+    e->flags |= MW_DNS_FLAG_VALID;
+    mwDns.dirty = TRUE;
+    return changed;
+}
+
+static void mwDnsLoad(void)
+{
+    MwDnsFileHdr hdr;
+    OSAFILE fp;
+    UINT32 i;
+
+    fp = OsaFopen(MW_DNS_FILE_NAME, "rb");
+    if (fp == PNULL)
+    {
+        return;
+    }
+
+    if (OsaFread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        hdr.magic != MW_DNS_FILE_MAGIC || hdr.version != MW_DNS_FILE_VERSION ||
+        hdr.count > MW_DNS_CACHE_SIZE ||
+        OsaFread(mwDns.entry, sizeof(MwDnsEntry), hdr.count, fp) != hdr.count ||
+        mwDnsCrc(mwDns.entry, hdr.count) != hdr.crc)
+    {
+        memset(mwDns.entry, 0, sizeof(mwDns.entry));
+        OsaFclose(fp);
+        return;
+    }
+    OsaFclose(fp);
+
+    /* Pins belong to this boot's configuration, the resolver state to no boot at all */
+    for (i = 0; i < hdr.count; i++)
+    {
+        mwDns.entry[i].name[MW_DNS_NAME_LEN - 1] = 0;
+        mwDns.entry[i].flags &= MW_DNS_FLAG_VALID;
+        mwDns.entry[i].refresh = 0;
+        if ((INT32)(mwDns.entry[i].lastUse - mwDns.useSeq) > 0)
+        {
+            mwDns.useSeq = mwDns.entry[i].lastUse;
+        }
+    }
+}
+
+static void mwDnsTask(void *argument)
+{
+    MwDnsWaiter done[MW_DNS_MAX_WAITERS];
+    char host[MW_DNS_NAME_LEN];
+    ip_addr_t addr;
+    MwDnsEntry *e;
+    UINT32 doneNum;
+    UINT32 i;
+    BOOL changed;
+    err_t err;
+
+    (void)argument;
+
+    for (;;)
+    {
+        osMutexAcquire(mwDns.lock, osWaitForever);
+        e = PNULL;
+        for (i = 0; i < MW_DNS_CACHE_SIZE; i++)
+        {
+            if (mwDns.entry[i].refresh)
+            {
+                e = &mwDns.entry[i];
+                strcpy(host, e->name);
+                break;
+            }
+        }
+        osMutexRelease(mwDns.lock);
+
+        if (e == PNULL)
+        {
+            osSemaphoreAcquire(mwDns.work, osWaitForever);
+            continue;
+        }
+
+        /* The slot is neither evicted nor freed while refresh is set */
+        err = netconn_gethostbyname(host, &addr);
+
+        osMutexAcquire(mwDns.lock, osWaitForever);
+        mwDns.stats.lookups++;
+        changed = FALSE;
+        if (err == ERR_OK)
+        {
+            changed = mwDnsStore(e, &addr);
+        }
+        else
+        {
+            /* A stale answer stays in service until MW_DNS_MAX_STALE */
+            mwDns.stats.failures++;
+        }
+        e->refresh = 0;
+
+        doneNum = 0;
+        for (i = 0; i < MW_DNS_MAX_WAITERS; i++)
+        {
+            if (mwDns.waiter[i].used && &mwDns.entry[mwDns.waiter[i].entry] == e)
+            {
+                done[doneNum++] = mwDns.waiter[i];
+                mwDns.waiter[i].used = 0;
+            }
+        }
+
+        if (!(e->flags & (MW_DNS_FLAG_VALID | MW_DNS_FLAG_PINNED)))
+        {
+            memset(e, 0, sizeof(MwDnsEntry));
+        }
+        osMutexRelease(mwDns.lock);
+
+        for (i = 0; i < doneNum; i++)
+        {
+            done[i].cb(host, (err == ERR_OK) ? &addr : PNULL, done[i].arg);
+        }
+
+        if (changed)
+        {
+            mwDnsSave();
+        }
+    }
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+INT32 mwDnsInit(void)
+{
+    const osMutexAttr_t lockAttr = { "mwDns", osMutexPrioInherit, NULL, 0 };
+    const osMutexAttr_t fileLockAttr = { "mwDnsFile", 0, NULL, 0 };
+    osThreadAttr_t taskAttr;
+    int32_t kernelLock;
+    UINT8 state;
+
+    /* Only one task loads the cache, the others wait for its outcome */
+    for (;;)
+    {
+        kernelLock = osKernelLock();
+        state = mwDns.state;
+        if (state == MW_DNS_STOPPED)
+        {
+            mwDns.state = MW_DNS_STARTING;
+        }
+        osKernelRestoreLock(kernelLock);
+
+        if (state != MW_DNS_STARTING)
+        {
+            break;
+        }
+        osDelay(1);
+    }
+    if (state == MW_DNS_RUNNING)
+    {
+        return MW_DNS_OK;
+    }
+
+    mwDns.lock = osMutexNew(&lockAttr);
+    mwDns.fileLock = osMutexNew(&fileLockAttr);
+    mwDns.work = osSemaphoreNew(1, 0, PNULL);
+    if (mwDns.lock == PNULL || mwDns.fileLock == PNULL || mwDns.work == PNULL)
+    {
+        goto fail;
+    }
+
+    mwDnsLoad();
+
+    memset(&taskAttr, 0, sizeof(taskAttr));
+    taskAttr.name = "mwDns";
+    taskAttr.stack_size = MW_DNS_TASK_STACK_SIZE;
+    taskAttr.priority = osPriorityBelowNormal7;
+
+    mwDns.task = osThreadNew(mwDnsTask, PNULL, &taskAttr);
+    if (mwDns.task == PNULL)
+    {
+        goto fail;
+    }
+    mwDns.state = MW_DNS_RUNNING;
+    return MW_DNS_OK;
+
+fail:
+    if (mwDns.lock != PNULL)
+    {
+        osMutexDelete(mwDns.lock);
+        mwDns.lock = PNULL;
+    }
+    if (mwDns.fileLock != PNULL)
+    {
+        osMutexDelete(mwDns.fileLock);
+        mwDns.fileLock = PNULL;
+    }
+    if (mwDns.work != PNULL)
+    {
+        osSemaphoreDelete(mwDns.work);
+        mwDns.work = PNULL;
+    }
+    memset(mwDns.entry, 0, sizeof(mwDns.entry));
+    mwDns.state = MW_DNS_STOPPED;
+    return MW_DNS_ERR_SYS;
+}
+
+INT32 mwDnsResolve(const char *host, ip_addr_t *addr, MwDnsResolveCb cb, void *arg)
+{
+    MwDnsEntry *e;
+    UINT32 i;
+
+    if (host == PNULL || addr == PNULL || cb == PNULL || strlen(host) >= MW_DNS_NAME_LEN)
+    {
+        return MW_DNS_ERR_PARAM;
+    }
+    if (ipaddr_aton(host, addr))
+    {
+        return MW_DNS_OK;
+    }
+    if (mwDnsInit() != MW_DNS_OK)
+    {
+        return MW_DNS_ERR_SYS;
+    }
+
+    osMutexAcquire(mwDns.lock, osWaitForever);
+    if (mwDnsLookup(host, addr))
+    {
+        osMutexRelease(mwDns.lock);
+        return MW_DNS_OK;
+    }
+
+    for (i = 0; i < MW_DNS_MAX_WAITERS; i++)
+    {
+        if (!mwDns.waiter[i].used)
+        {
+            break;
+        }
+    }
+    e = mwDnsFind(host);
+    if (e == PNULL && i < MW_DNS_MAX_WAITERS)
+    {
+        e = mwDnsAlloc(host);
+    }
+    if (e == PNULL || i == MW_DNS_MAX_WAITERS)
+    {
+        osMutexRelease(mwDns.lock);
+        return MW_DNS_ERR_FULL;
+    }
+
+    mwDns.waiter[i].cb = cb;
+    mwDns.waiter[i].arg = arg;
+    mwDns.waiter[i].entry = (UINT8)(e - mwDns.entry);
+    mwDns.waiter[i].used = 1;
+    mwDnsQueue(e);
+    osMutexRelease(mwDns.lock);
+    return MW_DNS_PENDING;
+}
+
+INT32 mwDnsGetHostByName(const char *host, ip_addr_t *addr)
+{
+    MwDnsEntry *e;
+    BOOL changed = FALSE;
+    err_t err;
+
+    if (host == PNULL || addr == PNULL)
+    {
+        return ERR_ARG;
+    }
+    if (ipaddr_aton(host, addr))
+    {
+        return ERR_OK;
+    }
+    if (strlen(host) >= MW_DNS_NAME_LEN || mwDnsInit() != MW_DNS_OK)
+    {
+        return netconn_gethostbyname(host, addr);
+    }
+
+    osMutexAcquire(mwDns.lock, osWaitForever);
+    if (mwDnsLookup(host, addr))
+    {
+        osMutexRelease(mwDns.lock);
+        return ERR_OK;
+    }
+    osMutexRelease(mwDns.lock);
+
+    err = netconn_gethostbyname(host, addr);
+
+    osMutexAcquire(mwDns.lock, osWaitForever);
+    mwDns.stats.lookups++;
+    if (err != ERR_OK)
+    {
+        mwDns.stats.failures++;
+    }
+    else
+    {
+        e = mwDnsFind(host);
+        if (e == PNULL)
+        {
+            e = mwDnsAlloc(host);
+        }
+        if (e != PNULL)
+        {
+            changed = mwDnsStore(e, addr);
+        }
+    }
+    osMutexRelease(mwDns.lock);
+
+    if (changed)
+    {
+        mwDnsSave();
+    }
+    return err;
+}
+
+INT32 mwDnsAddPrefetchHost(const char *host)
+{
+    MwDnsEntry *e;
+    INT32 ret = MW_DNS_OK;
+
+    if (host == PNULL || host[0] == 0 || strlen(host) >= MW_DNS_NAME_LEN)
+    {
+        return MW_DNS_ERR_PARAM;
+    }
+    if (mwDnsInit() != MW_DNS_OK)
+    {
+        return MW_DNS_ERR_SYS;
+    }
+
+    osMutexAcquire(mwDns.lock, osWaitForever);
+    e = mwDnsFind(host);
+    if (e == PNULL)
+    {
+        e = mwDnsAlloc(host);
+    }
+    if (e == PNULL)
+    {
+        ret = MW_DNS_ERR_FULL;
+    }
+    else
+    {
+        e->flags |= MW_DNS_FLAG_PINNED;
+        if (!(e->flags & MW_DNS_FLAG_VALID) ||
+            mwDnsAge(e, mwDnsNow()) >= MW_DNS_DEFAULT_TTL - MW_DNS_REFRESH_AHEAD)
+        {
+            mwDnsQueue(e);
+        }
+    }
+    osMutexRelease(mwDns.lock);
+    return ret;
+}
+
+void mwDnsInvalidate(const char *host)
+{
+    MwDnsEntry *e;
+    UINT32 i;
+
+    if (mwDns.state != MW_DNS_RUNNING)
+    {
+        return;
+    }
+
+    osMutexAcquire(mwDns.lock, osWaitForever);
+    for (i = 0; i < MW_DNS_CACHE_SIZE; i++)
+    {
+        e = &mwDns.entry[i];
+        if (e->name[0] == 0 || (host != PNULL && strcmp(e->name, host) != 0))
+        {
+            continue;
+        }
+
+        if (e->flags & MW_DNS_FLAG_VALID)
+        {
+            mwDns.stats.invalidated++;
+            mwDns.dirty = TRUE;
+        }
+        if ((e->flags & MW_DNS_FLAG_PINNED) || e->refresh)
+        {
+            e->flags &= ~MW_DNS_FLAG_VALID;
+        }
+        else
+        {
+            memset(e, 0, sizeof(MwDnsEntry));
+        }
+    }
+    osMutexRelease(mwDns.lock);
+}
+
+INT32 mwDnsSave(void)
+{
+    MwDnsFileHdr hdr;
+    MwDnsEntry *buf;
+    OSAFILE fp;
+    UINT32 i;
+    INT32 ret = MW_DNS_OK;
+
+    if (mwDns.state != MW_DNS_RUNNING)
+    {
+        return MW_DNS_OK;
+    }
+
+    buf = (MwDnsEntry *)OsaAllocMemory(sizeof(mwDns.entry));
+    if (buf == PNULL)
+    {
+        return MW_DNS_ERR_SYS;
+    }
+
+    osMutexAcquire(mwDns.fileLock, osWaitForever);
+
+    osMutexAcquire(mwDns.lock, osWaitForever);
+    if (!mwDns.dirty)
+    {
+        osMutexRelease(mwDns.lock);
+        goto exit;
+    }
+    hdr.count = 0;
+    for (i = 0; i < MW_DNS_CACHE_SIZE; i++)
+    {
+        if (mwDns.entry[i].flags & MW_DNS_FLAG_VALID)
+        {
+            buf[hdr.count] = mwDns.entry[i];
+            buf[hdr.count].refresh = 0;
+            hdr.count++;
+        }
+    }
+    mwDns.dirty = FALSE;
+    osMutexRelease(mwDns.lock);
+
+    hdr.magic = MW_DNS_FILE_MAGIC;
+    hdr.version = MW_DNS_FILE_VERSION;
+    hdr.crc = mwDnsCrc(buf, hdr.count);
+
+    fp = OsaFopen(MW_DNS_FILE_NAME, "wb");
+    if (fp == PNULL ||
+        OsaFwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        (hdr.count != 0 && OsaFwrite(buf, sizeof(MwDnsEntry), hdr.count, fp) != hdr.count))
+    {
+        ret = MW_DNS_ERR_SYS;
+    }
+    if (fp != PNULL)
+    {
+        OsaFclose(fp);
+    }
+
+    osMutexAcquire(mwDns.lock, osWaitForever);
+    if (ret == MW_DNS_OK)
+    {
+        mwDns.stats.saves++;
+    }
+    else
+    {
+        mwDns.dirty = TRUE;
+    }
+    osMutexRelease(mwDns.lock);
+
+exit:
+    osMutexRelease(mwDns.fileLock);
+    OsaFreeMemory(&buf);
+    return ret;
+}
+
+void mwDnsGetStats(MwDnsStats *stats)
+{
+    if (stats == PNULL)
+    {
+        return;
+    }
+    if (mwDns.state != MW_DNS_RUNNING)
+    {
+        memset(stats, 0, sizeof(MwDnsStats));
+        return;
+    }
+
+    osMutexAcquire(mwDns.lock, osWaitForever);
+    *stats = mwDns.stats;
+    osMutexRelease(mwDns.lock);
+}
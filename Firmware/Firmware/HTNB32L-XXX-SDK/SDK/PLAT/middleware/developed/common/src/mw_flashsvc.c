@@ -0,0 +1,718 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_flashsvc.c
+ * Description:  Queued flash program/erase service with erase-ahead
+ *               The code runs XIP from the flash it writes, so BSP_QSPI_Write_Safe()
+ *               and BSP_QSPI_Erase_Safe() hold the caller for the whole operation, up
+ *               to a few hundred milliseconds for an erase, and every caller writing a
+ *               stream pays the sum of them in line with its own work: the FOTA download
+ *               stops receiving while a sector erases, a journal write waits for the
+ *               erase of the bank it compacts into.
+ *
+ *               Here callers queue requests and a flash task runs them in order. The
+ *               queue is a small ring of page-sized requests, so memory stays bounded
+ *               and a caller only blocks once it is full. A program that continues the
+ *               last queued one in the same page is appended to it, so the byte streams
+ *               of the journals cost one program per page instead of one per record.
+ *               Reads overlay the queued requests, in order, on what the flash holds;
+ *               erase and program are idempotent on NOR, so the one being run can be
+ *               overlaid whatever point it has reached.
+ *
+ *               Owners announce sectors they know to be free with mwFlashSvcEraseAhead(),
+ *               and the task erases them while the queue is empty. A sector erased this
+ *               way, or by a queued erase, is remembered until the task programs it; the
+ *               erase asked for later is skipped if the sector still reads blank. The
+ *               blank check alone would not do: a sector left by a reset in the middle
+ *               of its erase may read blank and still not hold a program.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#include <string.h>
+#include "RTE_Components.h"
+#include CMSIS_device_header
+#include "cmsis_os2.h"
+#include "osasys.h"
+#include "system_qcx212.h"
+#include "flash_qcx212_rt.h"
+#include "mw_flashsvc.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_FLASHSVC_SECTORS           (MW_FLASHSVC_FLASH_SIZE / MW_FLASHSVC_SECTOR_SIZE)
+
+#define MW_FLASHSVC_PAGE_OF(addr)     ((addr) & ~(UINT32)(MW_FLASHSVC_PAGE_SIZE - 1))
+
+/* Tasks waiting on the service at the same time */
+#define MW_FLASHSVC_MAX_WAITERS       32
+
+typedef enum MwFlashSvcState_Tag
+{
+    MW_FLASHSVC_STOPPED = 0,
+    MW_FLASHSVC_STARTING,       //a task is creating the objects below
+    MW_FLASHSVC_RUNNING
+}MwFlashSvcState;
+
+typedef enum MwFlashSvcReqOp_Tag
+{
+    MW_FLASHSVC_REQ_PROGRAM = 0,
+    MW_FLASHSVC_REQ_ERASE
+}MwFlashSvcReqOp;
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwFlashSvcReq_Tag
+{
+    UINT8               op;
+    UINT8               reserved[3];
+    UINT32              addr;
+    UINT32              len;
+    UINT8               data[MW_FLASHSVC_PAGE_SIZE];    //program only, never across a page
+}MwFlashSvcReq;
+
+typedef struct MwFlashSvcContext_Tag
+{
+    osThreadId_t        task;
+    osMutexId_t         lock;
+    osSemaphoreId_t     work;                   //requests or announcements pending
+    osSemaphoreId_t     done;                   //a request completed, for the waiters
+    volatile UINT8      state;
+    UINT8               timerOn;
+    UINT8               running;                //queue[head] is being run
+    UINT8               reserved;
+    UINT32              head;
+    UINT32              count;
+    UINT32              waiters;
+    UINT32              doneSeq;                //completions, for the waiters that time out
+    INT32               error;                  //first since the last flush
+    UINT8               ahead[MW_FLASHSVC_SECTORS / 8];     //announced, not erased yet
+    UINT8               erased[MW_FLASHSVC_SECTORS / 8];    //erased by the task, not programmed since
+    UINT8               scratch[MW_FLASHSVC_PAGE_SIZE];     //blank checks
+    MwFlashSvcReq       queue[MW_FLASHSVC_QUEUE_DEPTH];
+    MwFlashSvcStats     stats;
+}MwFlashSvcContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwFlashSvcContext mwFlashSvc;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT32 mwFlashSvcNow(void)
+{
+    if (!mwFlashSvc.timerOn)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        mwFlashSvc.timerOn = TRUE;
+    }
+    return DWT->CYCCNT;
+}
+
+static UINT32 mwFlashSvcElapsedUs(UINT32 start)
+{
+    UINT32 mhz = SystemCoreClock / 1000000;
+
+    return (DWT->CYCCNT - start) / (mhz != 0 ? mhz : 1);
+}
+
+static void mwFlashSvcRecord(MwFlashSvcOpStats *op, UINT32 us)
+{
+    op->count++;
+    op->totalUs += us;
+    if (us > op->maxUs)
+    {
+        op->maxUs = us;
+    }
+}
+
+static BOOL mwFlashSvcBit(const UINT8 *map, UINT32 sector)
+{
+    return (map[sector >> 3] & (1 << (sector & 7))) != 0;
+}
+
+static void mwFlashSvcSetBit(UINT8 *map, UINT32 sector, BOOL on)
+{
+    if (on)
+    {
+        map[sector >> 3] |= (UINT8)(1 << (sector & 7));
+    }
+    else
+    {
+        map[sector >> 3] &= (UINT8)~(1 << (sector & 7));
+    }
+}
+
+static BOOL mwFlashSvcRangeOk(UINT32 addr, UINT32 len)
+{
+    return len <= MW_FLASHSVC_FLASH_SIZE && addr <= MW_FLASHSVC_FLASH_SIZE - len;
+}
+
+static BOOL mwFlashSvcSectorsOk(UINT32 addr, UINT32 len)
+{
+    return mwFlashSvcRangeOk(addr, len) &&
+           (addr % MW_FLASHSVC_SECTOR_SIZE) == 0 && (len % MW_FLASHSVC_SECTOR_SIZE) == 0;
+}
+
+static UINT32 mwFlashSvcTicks(UINT32 ms)
+{
+    if (ms == osWaitForever)
+    {
+        return osWaitForever;
+    }
+    return (UINT32)(((UINT64)ms * osKernelGetTickFreq() + 999) / 1000);
+}
+
+/* Called and returns with the lock held; blocks while cond() holds */
+static INT32 mwFlashSvcWait(BOOL (*cond)(void), UINT32 timeoutMs)
+{
+    UINT32 ticks = mwFlashSvcTicks(timeoutMs);
+    UINT32 startTick = osKernelGetTickCount();
+    UINT32 start = mwFlashSvcNow();
+    UINT32 waited, us, seq;
+    osStatus_t status;
+    INT32 ret = MW_FLASHSVC_OK;
+
+    if (!cond())
+    {
+        return MW_FLASHSVC_OK;
+    }
+
+    while (cond())
+    {
+        waited = osKernelGetTickCount() - startTick;
+        if (ticks != osWaitForever && waited >= ticks)
+        {
+            ret = MW_FLASHSVC_ERR_TIMEOUT;
+            break;
+        }
+
+        mwFlashSvc.waiters++;
+        seq = mwFlashSvc.doneSeq;
+        osMutexRelease(mwFlashSvc.lock);
+        status = osSemaphoreAcquire(mwFlashSvc.done, (ticks == osWaitForever) ? osWaitForever : ticks - waited);
+        osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+
+        /* Timed out: still counted, unless a completion came in between and
+         * released a token for us, which must not be left for a later waiter */
+        if (status != osOK)
+        {
+            if (mwFlashSvc.doneSeq == seq)
+            {
+                mwFlashSvc.waiters--;
+            }
+            else
+            {
+                osSemaphoreAcquire(mwFlashSvc.done, 0);
+            }
+        }
+    }
+
+    us = mwFlashSvcElapsedUs(start);
+    mwFlashSvc.stats.callerWaits++;
+    mwFlashSvc.stats.callerWaitUs += us;
+    if (us > mwFlashSvc.stats.callerWaitMaxUs)
+    {
+        mwFlashSvc.stats.callerWaitMaxUs = us;
+    }
+    return ret;
+}
+
+static BOOL mwFlashSvcQueueFull(void)
+{
+    return mwFlashSvc.count == MW_FLASHSVC_QUEUE_DEPTH;
+}
+
+static BOOL mwFlashSvcQueueBusy(void)
+{
+    return mwFlashSvc.count != 0;
+}
+
+/* Next free slot, with the lock held; waits for one when the queue is full */
+static MwFlashSvcReq *mwFlashSvcSlot(void)
+{
+    mwFlashSvcWait(mwFlashSvcQueueFull, osWaitForever);
+    return &mwFlashSvc.queue[(mwFlashSvc.head + mwFlashSvc.count) % MW_FLASHSVC_QUEUE_DEPTH];
+}
+
+/* Queue the slot just filled, with the lock held */
+static void mwFlashSvcPush(void)
+{
+    mwFlashSvc.count++;
+    if (mwFlashSvc.count > mwFlashSvc.stats.queueHigh)
+    {
+        mwFlashSvc.stats.queueHigh = mwFlashSvc.count;
+    }
+    osSemaphoreRelease(mwFlashSvc.work);
+}
+
+static void mwFlashSvcFail(void)
+{
+    osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+    mwFlashSvc.stats.flashErrors++;
+    if (mwFlashSvc.error == MW_FLASHSVC_OK)
+    {
+        mwFlashSvc.error = MW_FLASHSVC_ERR_FLASH;
+    }
+    osMutexRelease(mwFlashSvc.lock);
+}
+
+/* Erase one sector, timed into op; the task only */
+static BOOL mwFlashSvcEraseSector(UINT32 sector, MwFlashSvcOpStats *op)
+{
+    UINT32 start = mwFlashSvcNow();
+    UINT8 ret;
+
+    ret = BSP_QSPI_Erase_Safe(sector * MW_FLASHSVC_SECTOR_SIZE, MW_FLASHSVC_SECTOR_SIZE);
+
+    osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+    mwFlashSvcRecord(op, mwFlashSvcElapsedUs(start));
+    osMutexRelease(mwFlashSvc.lock);
+
+    mwFlashSvcSetBit(mwFlashSvc.erased, sector, ret == QSPI_OK);
+    if (ret != QSPI_OK)
+    {
+        mwFlashSvcFail();
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL mwFlashSvcBlank(UINT32 sector)
+{
+    UINT32 addr = sector * MW_FLASHSVC_SECTOR_SIZE;
+    UINT32 off, i;
+
+    for (off = 0; off < MW_FLASHSVC_SECTOR_SIZE; off += MW_FLASHSVC_PAGE_SIZE)
+    {
+        if (BSP_QSPI_Read_Safe(mwFlashSvc.scratch, addr + off, MW_FLASHSVC_PAGE_SIZE) != QSPI_OK)
+        {
+            return FALSE;
+        }
+
+        for (i = 0; i < MW_FLASHSVC_PAGE_SIZE; i++)
+        {
+            if (mwFlashSvc.scratch[i] != 0xFF)
+            {
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
+
+static void mwFlashSvcRun(MwFlashSvcReq *req)
+{
+    UINT32 sector = req->addr / MW_FLASHSVC_SECTOR_SIZE;
+    UINT32 start;
+    UINT8 ret;
+
+    if (req->op == MW_FLASHSVC_REQ_PROGRAM)
+    {
+        mwFlashSvcSetBit(mwFlashSvc.erased, sector, FALSE);
+
+        start = mwFlashSvcNow();
+        ret = BSP_QSPI_Write_Safe(req->data, req->addr, req->len);
+
+        osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+        mwFlashSvcRecord(&mwFlashSvc.stats.program, mwFlashSvcElapsedUs(start));
+        osMutexRelease(mwFlashSvc.lock);
+
+        if (ret != QSPI_OK)
+        {
+            mwFlashSvcFail();
+        }
+        return;
+    }
+
+    for (; sector < (req->addr + req->len) / MW_FLASHSVC_SECTOR_SIZE; sector++)
+    {
+        if (mwFlashSvcBit(mwFlashSvc.erased, sector) && mwFlashSvcBlank(sector))
+        {
+            osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+            mwFlashSvc.stats.eraseSkipped++;
+            osMutexRelease(mwFlashSvc.lock);
+            continue;
+        }
+
+        if (!mwFlashSvcEraseSector(sector, &mwFlashSvc.stats.erase))
+        {
+            return;
+        }
+    }
+}
+
+/* An announced sector to erase, with the lock held; its announcement is taken */
+static INT32 mwFlashSvcNextAhead(void)
+{
+    UINT32 i, bit;
+
+    for (i = 0; i < sizeof(mwFlashSvc.ahead); i++)
+    {
+        if (mwFlashSvc.ahead[i] != 0)
+        {
+            for (bit = 0; (mwFlashSvc.ahead[i] & (1 << bit)) == 0; bit++)
+            {
+            }
+            mwFlashSvc.ahead[i] &= (UINT8)~(1 << bit);
+            return (INT32)(i * 8 + bit);
+        }
+    }
+    return -1;
+}
+
+static void mwFlashSvcTask(void *argument)
+{
+    MwFlashSvcReq *req;
+    INT32 sector;
+
+    (void)argument;
+
+    for (;;)
+    {
+        osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+        if (mwFlashSvc.count != 0)
+        {
+            req = &mwFlashSvc.queue[mwFlashSvc.head];
+            mwFlashSvc.running = TRUE;
+            osMutexRelease(mwFlashSvc.lock);
+
+            mwFlashSvcRun(req);
+
+            osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+            mwFlashSvc.running = FALSE;
+            mwFlashSvc.head = (mwFlashSvc.head + 1) % MW_FLASHSVC_QUEUE_DEPTH;
+            mwFlashSvc.count--;
+            mwFlashSvc.doneSeq++;
+            while (mwFlashSvc.waiters != 0)
+            {
+                osSemaphoreRelease(mwFlashSvc.done);
+                mwFlashSvc.waiters--;
+            }
+            osMutexRelease(mwFlashSvc.lock);
+            continue;
+        }
+
+        sector = mwFlashSvcNextAhead();
+        osMutexRelease(mwFlashSvc.lock);
+
+        if (sector >= 0)
+        {
+            mwFlashSvcEraseSector((UINT32)sector, &mwFlashSvc.stats.eraseAhead);
+            continue;
+        }
+
+        osSemaphoreAcquire(mwFlashSvc.work, osWaitForever);
+    }
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+INT32 mwFlashSvcInit(void)
+{
+    const osMutexAttr_t lockAttr = { "mwFlashSvc", osMutexPrioInherit, NULL, 0 };
+    osThreadAttr_t taskAttr;
+    int32_t kernelLock;
+    UINT8 state;
+
+    /* Only one task creates the service, the others wait for its outcome */
+    for (;;)
+    {
+        kernelLock = osKernelLock();
+        state = mwFlashSvc.state;
+        if (state == MW_FLASHSVC_STOPPED)
+        {
+            mwFlashSvc.state = MW_FLASHSVC_STARTING;
+        }
+        osKernelRestoreLock(kernelLock);
+
+        if (state != MW_FLASHSVC_STARTING)
+        {
+            break;
+        }
+        osDelay(1);
+    }
+    if (state == MW_FLASHSVC_RUNNING)
+    {
+        return MW_FLASHSVC_OK;
+    }
+
+    mwFlashSvc.lock = osMutexNew(&lockAttr);
+    mwFlashSvc.work = osSemaphoreNew(1, 0, PNULL);
+    mwFlashSvc.done = osSemaphoreNew(MW_FLASHSVC_MAX_WAITERS, 0, PNULL);
+    if (mwFlashSvc.lock == PNULL || mwFlashSvc.work == PNULL || mwFlashSvc.done == PNULL)
+    {
+        goto fail;
+    }
+
+    memset(&taskAttr, 0, sizeof(taskAttr));
+    taskAttr.name = "mwFlashSvc";
+    taskAttr.stack_size = MW_FLASHSVC_TASK_STACK_SIZE;
+    taskAttr.priority = osPriorityBelowNormal7;
+
+    mwFlashSvc.task = osThreadNew(mwFlashSvcTask, PNULL, &taskAttr);
+    if (mwFlashSvc.task == PNULL)
+    {
+        goto fail;
+    }
+    mwFlashSvc.state = MW_FLASHSVC_RUNNING;
+    return MW_FLASHSVC_OK;
+
+fail:
+    if (mwFlashSvc.lock != PNULL)
+    {
+        osMutexDelete(mwFlashSvc.lock);
+        mwFlashSvc.lock = PNULL;
+    }
+    if (mwFlashSvc.work != PNULL)
+    {
+        osSemaphoreDelete(mwFlashSvc.work);
+        mwFlashSvc.work = PNULL;
+    }
+    if (mwFlashSvc.done != PNULL)
+    {
+        osSemaphoreDelete(mwFlashSvc.done);
+        mwFlashSvc.done = PNULL;
+    }
+    mwFlashSvc.state = MW_FLASHSVC_STOPPED;
+    return MW_FLASHSVC_ERR_SYS;
+}
+
+INT32 mwFlashSvcProgram(UINT32 addr, const void *data, UINT32 len)
+{
+    const UINT8 *p = (const UINT8 *)data;
+    MwFlashSvcReq *req;
+    UINT32 n;
+
+    if ((p == PNULL && len > 0) || !mwFlashSvcRangeOk(addr, len))
+    {
+        return MW_FLASHSVC_ERR_PARAM;
+    }
+    if (mwFlashSvcInit() != MW_FLASHSVC_OK)
+    {
+        return MW_FLASHSVC_ERR_SYS;
+    }
+
+    while (len > 0)
+    {
+        n = MW_FLASHSVC_PAGE_SIZE - (addr % MW_FLASHSVC_PAGE_SIZE);
+        if (n > len)
+        {
+            n = len;
+        }
+
+        osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+        mwFlashSvc.stats.programRequests++;
+        mwFlashSvc.stats.programBytes += n;
+
+        /* The last queued request, unless it is already being run */
+        req = PNULL;
+        if (mwFlashSvc.count > (mwFlashSvc.running ? 1U : 0U))
+        {
+            req = &mwFlashSvc.queue[(mwFlashSvc.head + mwFlashSvc.count - 1) % MW_FLASHSVC_QUEUE_DEPTH];
+        }
+
+        if (req != PNULL && req->op == MW_FLASHSVC_REQ_PROGRAM && req->addr + req->len == addr &&
+            MW_FLASHSVC_PAGE_OF(req->addr) == MW_FLASHSVC_PAGE_OF(addr))
+        {
+            memcpy(&req->data[req->len], p, n);
+            req->len += n;
+            mwFlashSvc.stats.programMerged++;
+        }
+        else
+        {
+            req = mwFlashSvcSlot();
+            req->op = MW_FLASHSVC_REQ_PROGRAM;
+            req->addr = addr;
+            req->len = n;
+            memcpy(req->data, p, n);
+            mwFlashSvcPush();
+        }
+        osMutexRelease(mwFlashSvc.lock);
+
+        addr += n;
+        p += n;
+        len -= n;
+    }
+
+    return MW_FLASHSVC_OK;
+}
+
+INT32 mwFlashSvcErase(UINT32 addr, UINT32 len)
+{
+    MwFlashSvcReq *req;
+    UINT32 sector;
+
+    if (!mwFlashSvcSectorsOk(addr, len))
+    {
+        return MW_FLASHSVC_ERR_PARAM;
+    }
+    if (mwFlashSvcInit() != MW_FLASHSVC_OK)
+    {
+        return MW_FLASHSVC_ERR_SYS;
+    }
+    if (len == 0)
+    {
+        return MW_FLASHSVC_OK;
+    }
+
+    osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+    for (sector = addr / MW_FLASHSVC_SECTOR_SIZE; sector < (addr + len) / MW_FLASHSVC_SECTOR_SIZE; sector++)
+    {
+        mwFlashSvcSetBit(mwFlashSvc.ahead, sector, FALSE);
+    }
+    mwFlashSvc.stats.eraseRequests += len / MW_FLASHSVC_SECTOR_SIZE;
+
+    req = mwFlashSvcSlot();
+    req->op = MW_FLASHSVC_REQ_ERASE;
+    req->addr = addr;
+    req->len = len;
+    mwFlashSvcPush();
+    osMutexRelease(mwFlashSvc.lock);
+
+    return MW_FLASHSVC_OK;
+}
+
+INT32 mwFlashSvcFlush(UINT32 timeoutMs)
+{
+    INT32 ret;
+
+    if (mwFlashSvcInit() != MW_FLASHSVC_OK)
+    {
+        return MW_FLASHSVC_ERR_SYS;
+    }
+
+    osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+    ret = mwFlashSvcWait(mwFlashSvcQueueBusy, timeoutMs);
+    if (ret == MW_FLASHSVC_OK)
+    {
+        ret = mwFlashSvc.error;
+        mwFlashSvc.error = MW_FLASHSVC_OK;
+    }
+    osMutexRelease(mwFlashSvc.lock);
+
+    return ret;
+}
+
+INT32 mwFlashSvcRead(UINT32 addr, void *data, UINT32 len)
+{
+    UINT8 *p = (UINT8 *)data;
+    MwFlashSvcReq *req;
+    UINT32 i, from, to;
+    INT32 ret = MW_FLASHSVC_OK;
+
+    if ((p == PNULL && len > 0) || !mwFlashSvcRangeOk(addr, len))
+    {
+        return MW_FLASHSVC_ERR_PARAM;
+    }
+    if (mwFlashSvcInit() != MW_FLASHSVC_OK)
+    {
+        return MW_FLASHSVC_ERR_SYS;
+    }
+    if (len == 0)
+    {
+        return MW_FLASHSVC_OK;
+    }
+
+    /* Requests leave the queue with the lock held only, so none is missed */
+    osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+    if (BSP_QSPI_Read_Safe(p, addr, len) != QSPI_OK)
+    {
+        ret = MW_FLASHSVC_ERR_FLASH;
+    }
+
+    for (i = 0; i < mwFlashSvc.count && ret == MW_FLASHSVC_OK; i++)
+    {
+        req = &mwFlashSvc.queue[(mwFlashSvc.head + i) % MW_FLASHSVC_QUEUE_DEPTH];
+        from = (req->addr > addr) ? req->addr : addr;
+        to = (req->addr + req->len < addr + len) ? req->addr + req->len : addr + len;
+
+        for (; from < to; from++)
+        {
+            if (req->op == MW_FLASHSVC_REQ_ERASE)
+            {
+                p[from - addr] = 0xFF;
+            }
+            else
+            {
+                p[from - addr] &= req->data[from - req->addr];
+            }
+        }
+    }
+    osMutexRelease(mwFlashSvc.lock);
+
+    return ret;
+}
+
+INT32 mwFlashSvcEraseAhead(UINT32 addr, UINT32 len)
+{
+    UINT32 sector;
+
+    if (!mwFlashSvcSectorsOk(addr, len))
+    {
+        return MW_FLASHSVC_ERR_PARAM;
+    }
+    if (mwFlashSvcInit() != MW_FLASHSVC_OK)
+    {
+        return MW_FLASHSVC_ERR_SYS;
+    }
+
+    osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+    for (sector = addr / MW_FLASHSVC_SECTOR_SIZE; sector < (addr + len) / MW_FLASHSVC_SECTOR_SIZE; sector++)
+    {
+        mwFlashSvcSetBit(mwFlashSvc.ahead, sector, TRUE);
+    }
+    osMutexRelease(mwFlashSvc.lock);
+
+    osSemaphoreRelease(mwFlashSvc.work);
+    return MW_FLASHSVC_OK;
+}
+
+void mwFlashSvcGetStats(MwFlashSvcStats *stats)
+{
+    if (stats == PNULL)
+    {
+        return;
+    }
+
+    if (mwFlashSvc.lock == PNULL)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+    *stats = mwFlashSvc.stats;
+    osMutexRelease(mwFlashSvc.lock);
+}
+
+void mwFlashSvcResetStats(void)
+{
+    if (mwFlashSvc.lock == PNULL)
+    {
+        return;
+    }
+
+    osMutexAcquire(mwFlashSvc.lock, osWaitForever);
+    memset(&mwFlashSvc.stats, 0, sizeof(mwFlashSvc.stats));
+    osMutexRelease(mwFlashSvc.lock);
+}
@@ -0,0 +1,700 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_kvcfg.c
+ * Description:  Key-value configuration store in a flash sector pair
+ *               Settings read by the applications at start-up were either compiled in
+ *               or kept in littlefs files that had to be opened and parsed. Here each
+ *               key has one fixed-size slot in a flash sector, and a RAM index maps the
+ *               hash of the key to its slot, so a lookup is a probe of the index and one
+ *               slot read to confirm the key and fetch the value.
+ *
+ *               Slot 0 of the active sector is a header carrying the sequence number of
+ *               the sector; the other slots are written in order, each in a single
+ *               program, with a CRC16 over the key and the value. A newer slot for a key
+ *               supersedes the older ones, a DELETE slot removes the key. A slot cut by
+ *               a reset fails its CRC and is skipped, so the key keeps the value of its
+ *               previous slot.
+ *
+ *               When no free slot is left the live keys are copied to the other sector,
+ *               erased first, with the update that did not fit; the header of the new
+ *               sector is programmed last. Until then the old sector is the newest one
+ *               with a valid header, and a reset finds it, and the value, unchanged.
+ *
+ *               On start-up the index is built from the newest sector: one read of each
+ *               of its slots, however many keys there are.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "osasys.h"
+#include "flash_qcx212_rt.h"
+#include "mw_chksum.h"
+#include "mw_flashsvc.h"
+#include "mw_kvcfg.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_KVCFG_REGION_SIZE          (2 * MW_KVCFG_SECTOR_SIZE)
+
+/* The sectors are written raw, nothing else may own them */
+#if (MW_KVCFG_REGION_OFFSET < FLASH_FS_REGION_END) && \
+    (MW_KVCFG_REGION_OFFSET + MW_KVCFG_REGION_SIZE > FLASH_FS_REGION_OFFSET)
+#error "MW_KVCFG_REGION overlaps the littlefs region"
+#endif
+#if (MW_KVCFG_REGION_OFFSET < FLASH_FOTA_REGION_END) && \
+    (MW_KVCFG_REGION_OFFSET + MW_KVCFG_REGION_SIZE > FLASH_FOTA_REGION_START)
+#error "MW_KVCFG_REGION overlaps the FOTA region"
+#endif
+
+#define MW_KVCFG_SECTOR_MAGIC         0x4643564B      //"KVCF"
+#define MW_KVCFG_SECTOR_NONE          0xFF
+
+#define MW_KVCFG_SLOT_HEADER          0x01            //slot 0, the sequence number in data[]
+#define MW_KVCFG_SLOT_VALUE           0x02
+#define MW_KVCFG_SLOT_DELETE          0x03
+
+/* Hash table of the keys, a power of two at least twice MW_KVCFG_MAX_KEYS */
+#define MW_KVCFG_INDEX_SIZE           64
+#define MW_KVCFG_NO_ENTRY             -1
+
+#define MW_KVCFG_READ_OK              0
+#define MW_KVCFG_READ_FREE            1
+#define MW_KVCFG_READ_TORN            2
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwKvcfgSlot_Tag
+{
+    UINT32      hash;                       //of the key, MW_KVCFG_SECTOR_MAGIC in the header
+    UINT8       type;
+    UINT8       keyLen;
+    UINT8       valLen;
+    UINT8       reserved;
+    UINT16      reserved2;
+    UINT16      crc;                        //over the fields above, the key and the value
+    UINT8       data[MW_KVCFG_SLOT_DATA];   //the key, then the value
+}MwKvcfgSlot;
+
+typedef struct MwKvcfgEntry_Tag
+{
+    UINT32      hash;
+    UINT8       slot;                       //0 for a free entry
+}MwKvcfgEntry;
+
+typedef struct MwKvcfgContext_Tag
+{
+    osMutexId_t         lock;
+    UINT8               started;
+    UINT8               active;             //MW_KVCFG_SECTOR_NONE before the first header
+    UINT8               wrSlot;             //where the next slot goes
+    UINT8               reserved;
+    UINT32              sectorSeq;
+    UINT32              keys;
+    MwKvcfgEntry        index[MW_KVCFG_INDEX_SIZE];
+    MwKvcfgSlot         cur;                //slot of the key last looked up
+    MwKvcfgSlot         rec;                //slot being written or scanned
+    MwKvCfgStats        stats;
+}MwKvcfgContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwKvcfgContext mwKvcfg;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT32 mwKvcfgAddr(UINT32 sector, UINT32 slot)
+{
+    return MW_KVCFG_REGION_OFFSET + sector * MW_KVCFG_SECTOR_SIZE + slot * MW_KVCFG_SLOT_SIZE;
+}
+
+static UINT32 mwKvcfgHash(const CHAR *key, UINT32 keyLen)
+{
+    return mwCrc32(0xFFFFFFFF, key, keyLen);
+}
+
+static UINT16 mwKvcfgSlotCrc(const MwKvcfgSlot *s)
+{
+    UINT16 crc;
+
+    crc = mwCrc16Ccitt(0xFFFF, s, offsetof(MwKvcfgSlot, crc));
+    return mwCrc16Ccitt(crc, s->data, (UINT32)s->keyLen + s->valLen);
+}
+
+static void mwKvcfgSlotInit(MwKvcfgSlot *s, UINT8 type, UINT32 hash, const void *key, UINT8 keyLen,
+                            const void *value, UINT8 valLen)
+{
+    memset(s, 0xFF, sizeof(*s));
+    s->hash = hash;
+    s->type = type;
+    s->keyLen = keyLen;
+    s->valLen = valLen;
+    if (keyLen > 0)
+    {
+        memcpy(s->data, key, keyLen);
+    }
+    if (valLen > 0)
+    {
+        memcpy(&s->data[keyLen], value, valLen);
+    }
+    s->crc = mwKvcfgSlotCrc(s);
+}
+
+/*
+ * Read a slot into s. Returns MW_KVCFG_READ_FREE for an erased slot,
+ * MW_KVCFG_READ_TORN for one that does not hold a whole record.
+ */
+static INT32 mwKvcfgReadSlot(UINT32 sector, UINT32 slot, MwKvcfgSlot *s)
+{
+    const UINT8 *p = (const UINT8 *)s;
+    UINT32 i;
+
+    if (BSP_QSPI_Read_Safe((UINT8 *)s, mwKvcfgAddr(sector, slot), sizeof(*s)) != QSPI_OK)
+    {
+        mwKvcfg.stats.flashErrors++;
+        return MW_KVCFG_ERR_FLASH;
+    }
+
+    for (i = 0; i < sizeof(*s) && p[i] == 0xFF; i++)
+    {
+    }
+    if (i == sizeof(*s))
+    {
+        return MW_KVCFG_READ_FREE;
+    }
+    if ((UINT32)s->keyLen + s->valLen > MW_KVCFG_SLOT_DATA || s->crc != mwKvcfgSlotCrc(s))
+    {
+        return MW_KVCFG_READ_TORN;
+    }
+    return MW_KVCFG_READ_OK;
+}
+
+static INT32 mwKvcfgProgram(UINT32 sector, UINT32 slot, const MwKvcfgSlot *s)
+{
+    if (BSP_QSPI_Write_Safe((UINT8 *)s, mwKvcfgAddr(sector, slot), sizeof(*s)) != QSPI_OK)
+    {
+        mwKvcfg.stats.flashErrors++;
+        return MW_KVCFG_ERR_FLASH;
+    }
+    return MW_KVCFG_OK;
+}
+
+/*
+ * Index entry of key, its slot left in mwKvcfg.cur. Slots whose hash
+ * matches are read to compare the keys, so a hash collision costs one
+ * more read. Returns MW_KVCFG_NO_ENTRY when the key does not exist.
+ */
+static INT32 mwKvcfgFind(UINT32 hash, const void *key, UINT8 keyLen, INT32 *err)
+{
+    UINT32 pos = hash & (MW_KVCFG_INDEX_SIZE - 1);
+    UINT32 n;
+
+    *err = MW_KVCFG_OK;
+    for (n = 0; n < MW_KVCFG_INDEX_SIZE && mwKvcfg.index[pos].slot != 0; n++)
+    {
+        if (mwKvcfg.index[pos].hash == hash)
+        {
+            if (mwKvcfgReadSlot(mwKvcfg.active, mwKvcfg.index[pos].slot, &mwKvcfg.cur) == MW_KVCFG_ERR_FLASH)
+            {
+                *err = MW_KVCFG_ERR_FLASH;
+                return MW_KVCFG_NO_ENTRY;
+            }
+            if (mwKvcfg.cur.keyLen == keyLen && memcmp(mwKvcfg.cur.data, key, keyLen) == 0)
+            {
+                return (INT32)pos;
+            }
+        }
+        pos = (pos + 1) & (MW_KVCFG_INDEX_SIZE - 1);
+    }
+    return MW_KVCFG_NO_ENTRY;
+}
+
+static void mwKvcfgInsert(UINT32 hash, UINT8 slot)
+{
+    UINT32 pos = hash & (MW_KVCFG_INDEX_SIZE - 1);
+
+    while (mwKvcfg.index[pos].slot != 0)
+    {
+        pos = (pos + 1) & (MW_KVCFG_INDEX_SIZE - 1);
+    }
+    mwKvcfg.index[pos].hash = hash;
+    mwKvcfg.index[pos].slot = slot;
+    mwKvcfg.keys++;
+}
+
+/* Free an entry, moving back the ones after it that would no longer be found */
+static void mwKvcfgRemove(UINT32 pos)
+{
+    UINT32 next = pos;
+    UINT32 home;
+
+    mwKvcfg.index[pos].slot = 0;
+    while (1)
+    {
+        next = (next + 1) & (MW_KVCFG_INDEX_SIZE - 1);
+        if (mwKvcfg.index[next].slot == 0)
+        {
+            break;
+        }
+        home = mwKvcfg.index[next].hash & (MW_KVCFG_INDEX_SIZE - 1);
+        if (((next - home) & (MW_KVCFG_INDEX_SIZE - 1)) >= ((next - pos) & (MW_KVCFG_INDEX_SIZE - 1)))
+        {
+            mwKvcfg.index[pos] = mwKvcfg.index[next];
+            mwKvcfg.index[next].slot = 0;
+            pos = next;
+        }
+    }
+    mwKvcfg.keys--;
+}
+
+/* Take the slot in mwKvcfg.rec, found at slot, into the index */
+static INT32 mwKvcfgApply(UINT8 slot)
+{
+    const MwKvcfgSlot *s = &mwKvcfg.rec;
+    INT32 pos;
+    INT32 err;
+
+    pos = mwKvcfgFind(s->hash, s->data, s->keyLen, &err);
+    if (err != MW_KVCFG_OK)
+    {
+        return err;
+    }
+
+    if (s->type == MW_KVCFG_SLOT_VALUE)
+    {
+        if (pos != MW_KVCFG_NO_ENTRY)
+        {
+            mwKvcfg.index[pos].slot = slot;
+        }
+        else if (mwKvcfg.keys < MW_KVCFG_MAX_KEYS)
+        {
+            mwKvcfgInsert(s->hash, slot);
+        }
+    }
+    else if (s->type == MW_KVCFG_SLOT_DELETE && pos != MW_KVCFG_NO_ENTRY)
+    {
+        mwKvcfgRemove((UINT32)pos);
+    }
+    return MW_KVCFG_OK;
+}
+
+static INT32 mwKvcfgScan(UINT32 sector)
+{
+    UINT32 slot;
+    INT32 ret;
+
+    memset(mwKvcfg.index, 0, sizeof(mwKvcfg.index));
+    mwKvcfg.keys = 0;
+    mwKvcfg.active = (UINT8)sector;
+    mwKvcfg.wrSlot = 1;
+
+    for (slot = 1; slot < MW_KVCFG_SLOTS; slot++)
+    {
+        ret = mwKvcfgReadSlot(sector, slot, &mwKvcfg.rec);
+        if (ret == MW_KVCFG_ERR_FLASH)
+        {
+            return ret;
+        }
+        if (ret == MW_KVCFG_READ_FREE)
+        {
+            continue;
+        }
+
+        mwKvcfg.wrSlot = (UINT8)(slot + 1);
+        if (ret == MW_KVCFG_READ_TORN)
+        {
+            mwKvcfg.stats.tornSlots++;
+        }
+        else if (mwKvcfgApply((UINT8)slot) != MW_KVCFG_OK)
+        {
+            return MW_KVCFG_ERR_FLASH;
+        }
+    }
+    return MW_KVCFG_OK;
+}
+
+static BOOL mwKvcfgReadHeader(UINT32 sector, UINT32 *seq)
+{
+    MwKvcfgSlot *s = &mwKvcfg.rec;
+
+    if (mwKvcfgReadSlot(sector, 0, s) != MW_KVCFG_READ_OK ||
+        s->type != MW_KVCFG_SLOT_HEADER || s->hash != MW_KVCFG_SECTOR_MAGIC || s->valLen != sizeof(UINT32))
+    {
+        return FALSE;
+    }
+    memcpy(seq, s->data, sizeof(UINT32));
+    return TRUE;
+}
+
+/*
+ * Copy the live keys to the other sector, but the one at index entry
+ * skip, then extra if not PNULL, and make it the active sector.
+ */
+static INT32 mwKvcfgCompact(const MwKvcfgSlot *extra, INT32 skip)
+{
+    UINT32 sector = (mwKvcfg.active == MW_KVCFG_SECTOR_NONE) ? 0 : mwKvcfg.active ^ 1;
+    UINT32 seq = mwKvcfg.sectorSeq + 1;
+    UINT32 slot = 1;
+    UINT32 i;
+    INT32 ret = MW_KVCFG_OK;
+
+    /* Usually erased ahead since the last compaction, then only blank checked */
+    mwKvcfg.stats.sectorErases++;
+    if (mwFlashSvcErase(mwKvcfgAddr(sector, 0), MW_KVCFG_SECTOR_SIZE) != MW_FLASHSVC_OK ||
+        mwFlashSvcFlush(osWaitForever) != MW_FLASHSVC_OK)
+    {
+        mwKvcfg.stats.flashErrors++;
+        ret = MW_KVCFG_ERR_FLASH;
+    }
+
+    for (i = 0; i < MW_KVCFG_INDEX_SIZE && ret == MW_KVCFG_OK; i++)
+    {
+        if (mwKvcfg.index[i].slot == 0 || (INT32)i == skip)
+        {
+            continue;
+        }
+        if (mwKvcfgReadSlot(mwKvcfg.active, mwKvcfg.index[i].slot, &mwKvcfg.cur) != MW_KVCFG_READ_OK)
+        {
+            ret = MW_KVCFG_ERR_FLASH;
+            break;
+        }
+        ret = mwKvcfgProgram(sector, slot++, &mwKvcfg.cur);
+    }
+    if (ret == MW_KVCFG_OK && extra != PNULL)
+    {
+        ret = mwKvcfgProgram(sector, slot++, extra);
+    }
+    if (ret == MW_KVCFG_OK)
+    {
+        mwKvcfgSlotInit(&mwKvcfg.cur, MW_KVCFG_SLOT_HEADER, MW_KVCFG_SECTOR_MAGIC, PNULL, 0, &seq, sizeof(seq));
+        ret = mwKvcfgProgram(sector, 0, &mwKvcfg.cur);
+    }
+
+    if (ret != MW_KVCFG_OK)
+    {
+        /* The old sector is still the newest one with a header */
+        if (mwKvcfg.active != MW_KVCFG_SECTOR_NONE)
+        {
+            mwKvcfgScan(mwKvcfg.active);
+        }
+        return ret;
+    }
+
+    mwKvcfg.sectorSeq = seq;
+    mwKvcfg.stats.compactions++;
+    ret = mwKvcfgScan(sector);
+
+    /* The sector left behind is the next one to compact into */
+    mwFlashSvcEraseAhead(mwKvcfgAddr(sector ^ 1, 0), MW_KVCFG_SECTOR_SIZE);
+    return ret;
+}
+
+static INT32 mwKvcfgRecover(void)
+{
+    UINT32 seq[2];
+    BOOL valid[2];
+    UINT32 sector;
+    INT32 ret;
+
+    valid[0] = mwKvcfgReadHeader(0, &seq[0]);
+    valid[1] = mwKvcfgReadHeader(1, &seq[1]);
+
+    mwKvcfg.active = MW_KVCFG_SECTOR_NONE;
+    if (!valid[0] && !valid[1])
+    {
+        mwKvcfg.sectorSeq = 0;
+        return mwKvcfgCompact(PNULL, MW_KVCFG_NO_ENTRY);
+    }
+
+    sector = (valid[1] && (!valid[0] || (INT32)(seq[1] - seq[0]) > 0)) ? 1 : 0;
+    mwKvcfg.sectorSeq = seq[sector];
+    ret = mwKvcfgScan(sector);
+    if (ret == MW_KVCFG_OK)
+    {
+        mwFlashSvcEraseAhead(mwKvcfgAddr(sector ^ 1, 0), MW_KVCFG_SECTOR_SIZE);
+    }
+    return ret;
+}
+
+/* Write a VALUE or a DELETE slot for key, in the active sector if it has room */
+static INT32 mwKvcfgUpdate(UINT8 type, const CHAR *key, UINT8 keyLen, const void *value, UINT8 valLen)
+{
+    UINT32 hash = mwKvcfgHash(key, keyLen);
+    INT32 pos;
+    INT32 ret;
+
+    pos = mwKvcfgFind(hash, key, keyLen, &ret);
+    if (ret != MW_KVCFG_OK)
+    {
+        return ret;
+    }
+
+    if (type == MW_KVCFG_SLOT_DELETE)
+    {
+        if (pos == MW_KVCFG_NO_ENTRY)
+        {
+            return MW_KVCFG_ERR_NOT_FOUND;
+        }
+    }
+    else if (pos != MW_KVCFG_NO_ENTRY)
+    {
+        if (mwKvcfg.cur.valLen == valLen && memcmp(&mwKvcfg.cur.data[keyLen], value, valLen) == 0)
+        {
+            mwKvcfg.stats.unchanged++;
+            return MW_KVCFG_OK;
+        }
+    }
+    else if (mwKvcfg.keys >= MW_KVCFG_MAX_KEYS)
+    {
+        return MW_KVCFG_ERR_FULL;
+    }
+
+    mwKvcfgSlotInit(&mwKvcfg.rec, type, hash, key, keyLen, value, valLen);
+    if (mwKvcfg.wrSlot < MW_KVCFG_SLOTS)
+    {
+        ret = mwKvcfgProgram(mwKvcfg.active, mwKvcfg.wrSlot, &mwKvcfg.rec);
+
+        /* A failed program may have left part of the slot behind; it is not reused */
+        mwKvcfg.wrSlot++;
+        if (ret == MW_KVCFG_OK)
+        {
+            ret = mwKvcfgApply((UINT8)(mwKvcfg.wrSlot - 1));
+        }
+    }
+    else if (type == MW_KVCFG_SLOT_DELETE)
+    {
+        ret = mwKvcfgCompact(PNULL, pos);
+    }
+    else
+    {
+        ret = mwKvcfgCompact(&mwKvcfg.rec, pos);
+    }
+
+    if (ret == MW_KVCFG_OK)
+    {
+        mwKvcfg.stats.writes++;
+    }
+    return ret;
+}
+
+static INT32 mwKvcfgCheckKey(const CHAR *key)
+{
+    UINT32 len;
+
+    if (key == PNULL)
+    {
+        return MW_KVCFG_ERR_PARAM;
+    }
+    len = strlen(key);
+    if (len == 0 || len > MW_KVCFG_MAX_KEY_LEN)
+    {
+        return MW_KVCFG_ERR_PARAM;
+    }
+    return (INT32)len;
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+INT32 mwKvCfgInit(void)
+{
+    const osMutexAttr_t lockAttr = { "mwKvCfg", osMutexPrioInherit, NULL, 0 };
+    int32_t kernelLock;
+
+    kernelLock = osKernelLock();
+    if (mwKvcfg.started)
+    {
+        osKernelRestoreLock(kernelLock);
+        return MW_KVCFG_OK;
+    }
+    mwKvcfg.started = TRUE;
+    osKernelRestoreLock(kernelLock);
+
+    mwKvcfg.lock = osMutexNew(&lockAttr);
+    if (mwKvcfg.lock == PNULL)
+    {
+        goto fail;
+    }
+
+    if (mwKvcfgRecover() != MW_KVCFG_OK)
+    {
+        osMutexDelete(mwKvcfg.lock);
+        mwKvcfg.lock = PNULL;
+        mwKvcfg.started = FALSE;
+        return MW_KVCFG_ERR_FLASH;
+    }
+    return MW_KVCFG_OK;
+
+fail:
+    mwKvcfg.started = FALSE;
+    return MW_KVCFG_ERR_SYS;
+}
+
+INT32 mwKvCfgGet(const CHAR *key, void *value, UINT16 size)
+{
+    INT32 keyLen = mwKvcfgCheckKey(key);
+    INT32 pos;
+    INT32 ret;
+
+    if (keyLen < 0 || (value == PNULL && size > 0))
+    {
+        return MW_KVCFG_ERR_PARAM;
+    }
+    if (mwKvcfg.lock == PNULL)
+    {
+        return MW_KVCFG_ERR_STATE;
+    }
+
+    osMutexAcquire(mwKvcfg.lock, osWaitForever);
+    pos = mwKvcfgFind(mwKvcfgHash(key, (UINT32)keyLen), key, (UINT8)keyLen, &ret);
+    if (ret == MW_KVCFG_OK)
+    {
+        if (pos == MW_KVCFG_NO_ENTRY)
+        {
+            ret = MW_KVCFG_ERR_NOT_FOUND;
+        }
+        else if (mwKvcfg.cur.valLen > size)
+        {
+            ret = MW_KVCFG_ERR_PARAM;
+        }
+        else
+        {
+            memcpy(value, &mwKvcfg.cur.data[keyLen], mwKvcfg.cur.valLen);
+            ret = mwKvcfg.cur.valLen;
+        }
+    }
+    osMutexRelease(mwKvcfg.lock);
+    return ret;
+}
+
+CHAR *mwKvCfgGetStr(const CHAR *key, CHAR *str, UINT16 size, const CHAR *def)
+{
+    INT32 len;
+
+    if (str == PNULL || size == 0)
+    {
+        return str;
+    }
+
+    len = mwKvCfgGet(key, str, size - 1);
+    if (len >= 0)
+    {
+        str[len] = '\0';
+    }
+    else if (def != PNULL && strlen(def) < size)
+    {
+        strcpy(str, def);
+    }
+    else
+    {
+        str[0] = '\0';
+    }
+    return str;
+}
+
+INT32 mwKvCfgSet(const CHAR *key, const void *value, UINT16 len)
+{
+    INT32 keyLen = mwKvcfgCheckKey(key);
+    INT32 ret;
+
+    if (keyLen < 0 || (value == PNULL && len > 0) || keyLen + len > MW_KVCFG_SLOT_DATA)
+    {
+        return MW_KVCFG_ERR_PARAM;
+    }
+    if (mwKvcfg.lock == PNULL)
+    {
+        return MW_KVCFG_ERR_STATE;
+    }
+
+    osMutexAcquire(mwKvcfg.lock, osWaitForever);
+    ret = mwKvcfgUpdate(MW_KVCFG_SLOT_VALUE, key, (UINT8)keyLen, value, (UINT8)len);
+    osMutexRelease(mwKvcfg.lock);
+    return ret;
+}
+
+INT32 mwKvCfgSetStr(const CHAR *key, const CHAR *str)
+{
+    if (str == PNULL || strlen(str) > MW_KVCFG_SLOT_DATA)
+    {
+        return MW_KVCFG_ERR_PARAM;
+    }
+    return mwKvCfgSet(key, str, (UINT16)strlen(str));
+}
+
+INT32 mwKvCfgDelete(const CHAR *key)
+{
+    INT32 keyLen = mwKvcfgCheckKey(key);
+    INT32 ret;
+
+    if (keyLen < 0)
+    {
+        return MW_KVCFG_ERR_PARAM;
+    }
+    if (mwKvcfg.lock == PNULL)
+    {
+        return MW_KVCFG_ERR_STATE;
+    }
+
+    osMutexAcquire(mwKvcfg.lock, osWaitForever);
+    ret = mwKvcfgUpdate(MW_KVCFG_SLOT_DELETE, key, (UINT8)keyLen, PNULL, 0);
+    osMutexRelease(mwKvcfg.lock);
+    return ret;
+}
+
+INT32 mwKvCfgFormat(void)
+{
+    INT32 ret;
+
+    if (mwKvcfg.lock == PNULL)
+    {
+        return MW_KVCFG_ERR_STATE;
+    }
+
+    osMutexAcquire(mwKvcfg.lock, osWaitForever);
+    memset(mwKvcfg.index, 0, sizeof(mwKvcfg.index));
+    mwKvcfg.keys = 0;
+    ret = mwKvcfgCompact(PNULL, MW_KVCFG_NO_ENTRY);
+    osMutexRelease(mwKvcfg.lock);
+    return ret;
+}
+
+void mwKvCfgGetStats(MwKvCfgStats *stats)
+{
+    if (stats == PNULL)
+    {
+        return;
+    }
+
+    if (mwKvcfg.lock != PNULL)
+    {
+        osMutexAcquire(mwKvcfg.lock, osWaitForever);
+    }
+    *stats = mwKvcfg.stats;
+    stats->sectorSeq = mwKvcfg.sectorSeq;
+    stats->keys = mwKvcfg.keys;
+    stats->slotsUsed = mwKvcfg.wrSlot;
+    if (mwKvcfg.lock != PNULL)
+    {
+        osMutexRelease(mwKvcfg.lock);
+    }
+}
@@ -0,0 +1,329 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_lfs_fastmount.c
+ * Description:  littlefs mount from a snapshot kept across hibernate
+ *               Each wake from hibernate boots afresh and LFS_Init() mounts littlefs
+ *               again: lfs_mount() fetches every metadata pair of the tail list to find
+ *               the superblock and the global state, and the first block allocation
+ *               after it traverses the whole file system to fill the lookahead bitmap.
+ *               On the 84 blocks of the FS area that is tens of milliseconds of flash
+ *               reads before the first log line can be written.
+ *
+ *               lfs_mount() is wrapped at link time. It remembers the lfs_t of the port,
+ *               and a hibernate backup callback copies the part of it that a mount
+ *               rebuilds - root pair, seed, global state, lookahead window and bitmap,
+ *               size limits - into the user retention memory (.usrNvMem). The backup
+ *               callbacks run from the idle task just before power down, with every
+ *               other task blocked, and the port completes each littlefs call under its
+ *               mutex without blocking, so the copy is taken between two operations.
+ *
+ *               On the next mount the snapshot is used only when the boot is a wake from
+ *               hibernate, its CRC and the lfs_config match, and the revision counts of
+ *               the root pair read back from flash are the ones recorded; then the work
+ *               of lfs_init() is redone on the same buffers and the state copied back.
+ *               Anything else falls back to the real lfs_mount(). The snapshot is used
+ *               once: it is dropped by every mount, and by lfs_format() and
+ *               lfs_unmount().
+ *
+ *               The restore depends on the layout of lfs_t, so it is tied to the littlefs
+ *               version of lfs.h.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifdef MW_LFS_FASTMOUNT_ENABLE
+
+#include <stddef.h>
+#include <string.h>
+#include "lfs.h"
+#include "lfs_util.h"
+#include "mem_map.h"
+#include "flash_qcx212_rt.h"
+#include "slpman_qcx212.h"
+#include "mw_lfs_fastmount.h"
+
+#if LFS_VERSION != 0x00020001
+#error "mw_lfs_fastmount restores lfs_t of littlefs v2.1, check it against the new lfs.h"
+#endif
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_LFS_SNAP_MAGIC             0x4E534C4D      //"MLSN"
+#define MW_LFS_SNAP_STATS_MAGIC       0x54534C4D      //"MLST"
+#define MW_LFS_SNAP_VERSION           1
+
+#define MW_LFS_BLOCK_NULL             ((lfs_block_t)-1)
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwLfsSnap_Tag
+{
+    UINT32          magic;
+    UINT16          version;
+    UINT16          lfsSize;                //sizeof(lfs_t) it was taken from
+    UINT32          blockSize;
+    UINT32          blockCount;
+    UINT32          cacheSize;
+    UINT32          lookaheadSize;
+
+    lfs_block_t     root[2];
+    UINT32          rootRev[2];             //revision counts of the root pair
+    UINT32          seed;
+    lfs_gstate_t    gstate;
+    lfs_gstate_t    gdisk;
+    lfs_block_t     freeOff;
+    lfs_block_t     freeSize;
+    lfs_block_t     freeI;
+    lfs_size_t      nameMax;
+    lfs_size_t      fileMax;
+    lfs_size_t      attrMax;
+    UINT32          lookahead[MW_LFS_SNAP_MAX_LOOKAHEAD / 4];
+
+    UINT32          crc;                    //lfs_crc() over the fields above
+}MwLfsSnap;
+
+/*
+ * prec_init.c makes the last 32 bytes of .usrNvMem read-only, so the
+ * area ends with a guard that is never written.
+ */
+typedef struct MwLfsSnapArea_Tag
+{
+    MwLfsSnap               snap;
+    UINT32                  statsMagic;
+    MwLfsFastMountStats     stats;
+    UINT8                   guard[32] __attribute__((aligned(32)));
+}MwLfsSnapArea;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwLfsSnapArea mwLfsSnapArea __attribute__((section(".usrNvMem"), aligned(32)));
+
+static lfs_t *mwLfsMounted;
+static BOOL mwLfsCbRegistered;
+
+extern int __real_lfs_mount(lfs_t *lfs, const struct lfs_config *cfg);
+extern int __real_lfs_unmount(lfs_t *lfs);
+extern int __real_lfs_format(lfs_t *lfs, const struct lfs_config *cfg);
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static MwLfsFastMountStats *mwLfsSnapStats(void)
+{
+    if (mwLfsSnapArea.statsMagic != MW_LFS_SNAP_STATS_MAGIC)
+    {
+        memset(&mwLfsSnapArea.stats, 0, sizeof(mwLfsSnapArea.stats));
+        mwLfsSnapArea.statsMagic = MW_LFS_SNAP_STATS_MAGIC;
+    }
+    return &mwLfsSnapArea.stats;
+}
+
+static UINT32 mwLfsSnapCrc(const MwLfsSnap *snap)
+{
+    return lfs_crc(0xFFFFFFFF, snap, offsetof(MwLfsSnap, crc));
+}
+
+static BOOL mwLfsSnapReadRev(const struct lfs_config *cfg, lfs_block_t block, UINT32 *rev)
+{
+    UINT8 buf[4];
+
+    if (block >= cfg->block_count ||
+        BSP_QSPI_Read_Safe(buf, FLASH_FS_REGION_OFFSET + block * cfg->block_size, sizeof(buf)) != QSPI_OK)
+    {
+        return FALSE;
+    }
+    *rev = (UINT32)buf[0] | ((UINT32)buf[1] << 8) | ((UINT32)buf[2] << 16) | ((UINT32)buf[3] << 24);
+    return TRUE;
+}
+
+static BOOL mwLfsSnapConfigMatches(const MwLfsSnap *snap, const struct lfs_config *cfg)
+{
+    return snap->lfsSize == sizeof(lfs_t) &&
+           snap->blockSize == cfg->block_size &&
+           snap->blockCount == cfg->block_count &&
+           snap->cacheSize == cfg->cache_size &&
+           snap->lookaheadSize == cfg->lookahead_size &&
+           cfg->read_buffer != PNULL && cfg->prog_buffer != PNULL && cfg->lookahead_buffer != PNULL;
+}
+
+static MwLfsSnapReject mwLfsSnapCheck(const MwLfsSnap *snap, const struct lfs_config *cfg)
+{
+    UINT32 rev;
+    UINT32 i;
+
+    if (slpManGetLastSlpState() != SLP_HIB_STATE)
+    {
+        return MW_LFS_SNAP_REJECT_BOOT;
+    }
+    if (snap->magic != MW_LFS_SNAP_MAGIC || snap->version != MW_LFS_SNAP_VERSION || snap->crc != mwLfsSnapCrc(snap))
+    {
+        return MW_LFS_SNAP_REJECT_INVALID;
+    }
+    if (!mwLfsSnapConfigMatches(snap, cfg))
+    {
+        return MW_LFS_SNAP_REJECT_CONFIG;
+    }
+    for (i = 0; i < 2; i++)
+    {
+        if (!mwLfsSnapReadRev(cfg, snap->root[i], &rev) || rev != snap->rootRev[i])
+        {
+            return MW_LFS_SNAP_REJECT_FLASH;
+        }
+    }
+    return MW_LFS_SNAP_REJECT_NONE;
+}
+
+/* What lfs_init() and the end of lfs_mount() do, with the scanned state taken from snap */
+static void mwLfsSnapRestore(lfs_t *lfs, const struct lfs_config *cfg, const MwLfsSnap *snap)
+{
+    memset(lfs, 0, sizeof(*lfs));
+    lfs->cfg = cfg;
+
+    lfs->rcache.buffer = cfg->read_buffer;
+    lfs->pcache.buffer = cfg->prog_buffer;
+    memset(lfs->rcache.buffer, 0xFF, cfg->cache_size);
+    memset(lfs->pcache.buffer, 0xFF, cfg->cache_size);
+    lfs->rcache.block = MW_LFS_BLOCK_NULL;
+    lfs->pcache.block = MW_LFS_BLOCK_NULL;
+
+    lfs->free.buffer = cfg->lookahead_buffer;
+    memcpy(lfs->free.buffer, snap->lookahead, cfg->lookahead_size);
+    lfs->free.off = snap->freeOff;
+    lfs->free.size = snap->freeSize;
+    lfs->free.i = snap->freeI;
+    lfs->free.ack = cfg->block_count;
+
+    lfs->name_max = snap->nameMax;
+    lfs->file_max = snap->fileMax;
+    lfs->attr_max = snap->attrMax;
+
+    lfs->root[0] = snap->root[0];
+    lfs->root[1] = snap->root[1];
+    lfs->mlist = PNULL;
+    lfs->seed = snap->seed;
+    lfs->gstate = snap->gstate;
+    lfs->gdisk = snap->gdisk;
+}
+
+static void mwLfsSnapBackup(void *pdata, slpManLpState state)
+{
+    MwLfsSnap *snap = &mwLfsSnapArea.snap;
+    const struct lfs_config *cfg;
+    lfs_t *lfs = mwLfsMounted;
+
+    snap->magic = 0;
+    if (lfs == PNULL || lfs->mlist != PNULL)
+    {
+        return;
+    }
+
+    cfg = lfs->cfg;
+    if (cfg->lookahead_size > MW_LFS_SNAP_MAX_LOOKAHEAD ||
+        !mwLfsSnapReadRev(cfg, lfs->root[0], &snap->rootRev[0]) ||
+        !mwLfsSnapReadRev(cfg, lfs->root[1], &snap->rootRev[1]))
+    {
+        return;
+    }
+
+    snap->version = MW_LFS_SNAP_VERSION;
+    snap->lfsSize = sizeof(lfs_t);
+    snap->blockSize = cfg->block_size;
+    snap->blockCount = cfg->block_count;
+    snap->cacheSize = cfg->cache_size;
+    snap->lookaheadSize = cfg->lookahead_size;
+    snap->root[0] = lfs->root[0];
+    snap->root[1] = lfs->root[1];
+    snap->seed = lfs->seed;
+    snap->gstate = lfs->gstate;
+    snap->gdisk = lfs->gdisk;
+    snap->freeOff = lfs->free.off;
+    snap->freeSize = lfs->free.size;
+    snap->freeI = lfs->free.i;
+    snap->nameMax = lfs->name_max;
+    snap->fileMax = lfs->file_max;
+    snap->attrMax = lfs->attr_max;
+    memset(snap->lookahead, 0, sizeof(snap->lookahead));
+    memcpy(snap->lookahead, lfs->free.buffer, cfg->lookahead_size);
+    snap->magic = MW_LFS_SNAP_MAGIC;
+    snap->crc = mwLfsSnapCrc(snap);
+
+    mwLfsSnapStats()->snapshots++;
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+int __wrap_lfs_mount(lfs_t *lfs, const struct lfs_config *cfg)
+{
+    MwLfsFastMountStats *stats = mwLfsSnapStats();
+    MwLfsSnapReject reject;
+    int ret = 0;
+
+    if (!mwLfsCbRegistered)
+    {
+        mwLfsCbRegistered = (slpManRegisterUsrdefinedBackupCb(mwLfsSnapBackup, PNULL, SLPMAN_HIBERNATE_STATE) == RET_TRUE);
+    }
+
+    reject = mwLfsSnapCheck(&mwLfsSnapArea.snap, cfg);
+    if (reject == MW_LFS_SNAP_REJECT_NONE)
+    {
+        mwLfsSnapRestore(lfs, cfg, &mwLfsSnapArea.snap);
+        stats->fastMounts++;
+    }
+    else
+    {
+        ret = __real_lfs_mount(lfs, cfg);
+        stats->fullMounts++;
+    }
+    stats->lastReject = (UINT8)reject;
+    mwLfsSnapArea.snap.magic = 0;
+
+    mwLfsMounted = (ret == 0) ? lfs : PNULL;
+    return ret;
+}
+
+int __wrap_lfs_unmount(lfs_t *lfs)
+{
+    mwLfsMounted = PNULL;
+    mwLfsSnapArea.snap.magic = 0;
+    return __real_lfs_unmount(lfs);
+}
+
+int __wrap_lfs_format(lfs_t *lfs, const struct lfs_config *cfg)
+{
+    mwLfsMounted = PNULL;
+    mwLfsSnapArea.snap.magic = 0;
+    return __real_lfs_format(lfs, cfg);
+}
+
+void mwLfsFastMountInvalidate(void)
+{
+    mwLfsSnapArea.snap.magic = 0;
+}
+
+void mwLfsFastMountGetStats(MwLfsFastMountStats *stats)
+{
+    if (stats != PNULL)
+    {
+        *stats = *mwLfsSnapStats();
+    }
+}
+
+#endif
@@ -0,0 +1,483 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_lfs_stats.c
+ * Description:  I/O latency and wear instrumentation of the LFS port
+ *               LFS_GetFileWriteMonitorResult() and LFS_GetBlockEraseCountResult() of
+ *               the port only count write calls and erases. They do not tell how long
+ *               the flash held a task, nor which file the erases were done for.
+ *
+ *               The port is prebuilt, so it is instrumented at link time. Its flash
+ *               calls, BSP_QSPI_Read/Write/Erase_Safe(), are wrapped and timed with the
+ *               DWT cycle counter; calls outside the FS area of mem_map.h are passed on
+ *               untouched. Its lfs_file_open/read/write/sync/close() calls are wrapped
+ *               as well: they count the bytes the application asks for, time the syncs,
+ *               and mark the file in progress, so that the flash operations littlefs
+ *               issues meanwhile are charged to that file. Every littlefs call of the
+ *               port runs under the port mutex, so one file is in progress at a time.
+ *
+ *               littlefs erases a data block only from lfs_file_write(), when it
+ *               allocates one for the file. An erase of the FS area anywhere else is
+ *               taken as a metadata block being compacted or relocated: by the commit of
+ *               a sync, a close, a create, a remove. Each is counted, and also traced to
+ *               unilog as it happens.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifdef MW_LFS_STATS_ENABLE
+
+#include <stddef.h>
+#include <string.h>
+#include "RTE_Components.h"
+#include CMSIS_device_header
+#include "cmsis_os2.h"
+#include "osasys.h"
+#include "system_qcx212.h"
+#include "lfs.h"
+#include "flash_qcx212_rt.h"
+#include "debug_log.h"
+#include "mw_lfs_stats.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_LFS_STATS_SHARED           (MW_LFS_STATS_MAX_FILES - 1)
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwLfsStatsOpen_Tag
+{
+    lfs_file_t      *file;
+    MwLfsFileStats  *stats;
+}MwLfsStatsOpen;
+
+typedef struct MwLfsStatsContext_Tag
+{
+    MwLfsStats      stats;
+    MwLfsFileStats  files[MW_LFS_STATS_MAX_FILES];
+    UINT32          fileNum;
+    MwLfsStatsOpen  open[MW_LFS_STATS_MAX_OPEN];
+
+    MwLfsFileStats  *cur;           //file of the littlefs call in progress
+    BOOL            inWrite;        //inside lfs_file_write()
+    BOOL            timerOn;
+}MwLfsStatsContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwLfsStatsContext mwLfsStats;
+
+extern uint8_t __real_BSP_QSPI_Read_Safe(uint8_t *pData, uint32_t ReadAddr, uint32_t Size);
+extern uint8_t __real_BSP_QSPI_Write_Safe(uint8_t *pData, uint32_t WriteAddr, uint32_t Size);
+extern uint8_t __real_BSP_QSPI_Erase_Safe(uint32_t SectorAddress, uint32_t Size);
+extern int __real_lfs_file_open(lfs_t *lfs, lfs_file_t *file, const char *path, int flags);
+extern int __real_lfs_file_close(lfs_t *lfs, lfs_file_t *file);
+extern int __real_lfs_file_sync(lfs_t *lfs, lfs_file_t *file);
+extern lfs_ssize_t __real_lfs_file_read(lfs_t *lfs, lfs_file_t *file, void *buffer, lfs_size_t size);
+extern lfs_ssize_t __real_lfs_file_write(lfs_t *lfs, lfs_file_t *file, const void *buffer, lfs_size_t size);
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT32 mwLfsStatsNow(void)
+{
+    if (!mwLfsStats.timerOn)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        mwLfsStats.timerOn = TRUE;
+    }
+    return DWT->CYCCNT;
+}
+
+static UINT32 mwLfsStatsElapsedUs(UINT32 start)
+{
+    UINT32 mhz = SystemCoreClock / 1000000;
+
+    return (DWT->CYCCNT - start) / (mhz != 0 ? mhz : 1);
+}
+
+static BOOL mwLfsStatsInFs(UINT32 addr)
+{
+    return addr >= FLASH_FS_REGION_OFFSET && addr < FLASH_FS_REGION_END;
+}
+
+static void mwLfsStatsCount(MwLfsOpStats *op, UINT32 us, UINT32 bytes)
+{
+    UINT32 bucket = 0;
+    UINT32 v = us;
+
+    while (v > 1 && bucket < MW_LFS_STATS_HIST_BUCKETS - 1)
+    {
+        v >>= 1;
+        bucket++;
+    }
+
+    op->count++;
+    op->bytes += bytes;
+    op->totalUs += us;
+    if (us > op->maxUs)
+    {
+        op->maxUs = us;
+    }
+    op->hist[bucket]++;
+}
+
+static void mwLfsStatsFlashOp(MwLfsStatsOp op, UINT32 addr, UINT32 size, UINT32 start, uint8_t ret)
+{
+    MwLfsFileStats *file;
+    UINT32 us = mwLfsStatsElapsedUs(start);
+    UINT32 block = (addr - FLASH_FS_REGION_OFFSET) / MW_LFS_STATS_BLOCK_SIZE;
+    UINT32 end = block + (size + MW_LFS_STATS_BLOCK_SIZE - 1) / MW_LFS_STATS_BLOCK_SIZE;
+    BOOL compaction = FALSE;
+    UINT32 mask;
+
+    mask = SaveAndSetIRQMask();
+
+    file = mwLfsStats.cur;
+    mwLfsStatsCount(&mwLfsStats.stats.op[op], us, size);
+    if (ret != QSPI_OK)
+    {
+        mwLfsStats.stats.flashErrors++;
+    }
+
+    switch (op)
+    {
+        case MW_LFS_STATS_OP_READ:
+            if (file != PNULL)
+            {
+                file->flashReadBytes += size;
+            }
+            break;
+
+        case MW_LFS_STATS_OP_PROG:
+            if (file != PNULL)
+            {
+                file->flashProgBytes += size;
+            }
+            break;
+
+        default:
+            for (; block < end && block < MW_LFS_STATS_BLOCKS; block++)
+            {
+                mwLfsStats.stats.blockErases[block]++;
+            }
+            if (file != PNULL)
+            {
+                file->flashErases++;
+            }
+            if (!mwLfsStats.inWrite)
+            {
+                compaction = TRUE;
+                mwLfsStats.stats.compactions++;
+                if (file != PNULL)
+                {
+                    file->compactions++;
+                }
+            }
+            break;
+    }
+
+    RestoreIRQMask(mask);
+
+    if (compaction)
+    {
+        HT_TRACE(UNILOG_PLA_MIDWARE, mwLfsStatsCompaction_1, P_INFO, 3,
+                 "LFS compaction: block %d, %d us, file %d",
+                 (addr - FLASH_FS_REGION_OFFSET) / MW_LFS_STATS_BLOCK_SIZE, us,
+                 file != PNULL ? (INT32)(file - mwLfsStats.files) : -1);
+    }
+}
+
+static MwLfsFileStats *mwLfsStatsFind(const lfs_file_t *file)
+{
+    UINT32 i;
+
+    for (i = 0; i < MW_LFS_STATS_MAX_OPEN; i++)
+    {
+        if (mwLfsStats.open[i].file == file)
+        {
+            return mwLfsStats.open[i].stats;
+        }
+    }
+    return PNULL;
+}
+
+/* Entry of path, new or shared when the table is full */
+static MwLfsFileStats *mwLfsStatsByName(const char *path)
+{
+    MwLfsFileStats *entry;
+    UINT32 i;
+
+    for (i = 0; i < mwLfsStats.fileNum && i < MW_LFS_STATS_SHARED; i++)
+    {
+        if (strncmp(mwLfsStats.files[i].name, path, MW_LFS_STATS_NAME_LEN - 1) == 0)
+        {
+            return &mwLfsStats.files[i];
+        }
+    }
+
+    entry = &mwLfsStats.files[mwLfsStats.fileNum < MW_LFS_STATS_SHARED ? mwLfsStats.fileNum : MW_LFS_STATS_SHARED];
+    if (mwLfsStats.fileNum < MW_LFS_STATS_MAX_FILES)
+    {
+        if (mwLfsStats.fileNum < MW_LFS_STATS_SHARED)
+        {
+            strncpy(entry->name, path, MW_LFS_STATS_NAME_LEN - 1);
+        }
+        else
+        {
+            strcpy(entry->name, "*");
+        }
+        mwLfsStats.fileNum++;
+    }
+    return entry;
+}
+
+static void mwLfsStatsSync(MwLfsFileStats *file, UINT32 start)
+{
+    UINT32 us = mwLfsStatsElapsedUs(start);
+    UINT32 mask;
+
+    mask = SaveAndSetIRQMask();
+    mwLfsStatsCount(&mwLfsStats.stats.op[MW_LFS_STATS_OP_SYNC], us, 0);
+    if (file != PNULL)
+    {
+        file->syncs++;
+        if (us > file->syncMaxUs)
+        {
+            file->syncMaxUs = us;
+        }
+    }
+    RestoreIRQMask(mask);
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+uint8_t __wrap_BSP_QSPI_Read_Safe(uint8_t *pData, uint32_t ReadAddr, uint32_t Size)
+{
+    UINT32 start;
+    uint8_t ret;
+
+    if (!mwLfsStatsInFs(ReadAddr))
+    {
+        return __real_BSP_QSPI_Read_Safe(pData, ReadAddr, Size);
+    }
+    start = mwLfsStatsNow();
+    ret = __real_BSP_QSPI_Read_Safe(pData, ReadAddr, Size);
+    mwLfsStatsFlashOp(MW_LFS_STATS_OP_READ, ReadAddr, Size, start, ret);
+    return ret;
+}
+
+uint8_t __wrap_BSP_QSPI_Write_Safe(uint8_t *pData, uint32_t WriteAddr, uint32_t Size)
+{
+    UINT32 start;
+    uint8_t ret;
+
+    if (!mwLfsStatsInFs(WriteAddr))
+    {
+        return __real_BSP_QSPI_Write_Safe(pData, WriteAddr, Size);
+    }
+    start = mwLfsStatsNow();
+    ret = __real_BSP_QSPI_Write_Safe(pData, WriteAddr, Size);
+    mwLfsStatsFlashOp(MW_LFS_STATS_OP_PROG, WriteAddr, Size, start, ret);
+    return ret;
+}
+
+uint8_t __wrap_BSP_QSPI_Erase_Safe(uint32_t SectorAddress, uint32_t Size)
+{
+    UINT32 start;
+    uint8_t ret;
+
+    if (!mwLfsStatsInFs(SectorAddress))
+    {
+        return __real_BSP_QSPI_Erase_Safe(SectorAddress, Size);
+    }
+    start = mwLfsStatsNow();
+    ret = __real_BSP_QSPI_Erase_Safe(SectorAddress, Size);
+    mwLfsStatsFlashOp(MW_LFS_STATS_OP_ERASE, SectorAddress, Size, start, ret);
+    return ret;
+}
+
+int __wrap_lfs_file_open(lfs_t *lfs, lfs_file_t *file, const char *path, int flags)
+{
+    MwLfsFileStats *entry;
+    UINT32 i;
+    int ret;
+
+    entry = mwLfsStatsByName(path);
+    mwLfsStats.cur = entry;
+    ret = __real_lfs_file_open(lfs, file, path, flags);
+    mwLfsStats.cur = PNULL;
+
+    if (ret == 0)
+    {
+        entry->opens++;
+        for (i = 0; i < MW_LFS_STATS_MAX_OPEN; i++)
+        {
+            if (mwLfsStats.open[i].file == PNULL)
+            {
+                mwLfsStats.open[i].file = file;
+                mwLfsStats.open[i].stats = entry;
+                break;
+            }
+        }
+    }
+    return ret;
+}
+
+int __wrap_lfs_file_close(lfs_t *lfs, lfs_file_t *file)
+{
+    MwLfsFileStats *entry = mwLfsStatsFind(file);
+    UINT32 start;
+    UINT32 i;
+    int ret;
+
+    mwLfsStats.cur = entry;
+    start = mwLfsStatsNow();
+    ret = __real_lfs_file_close(lfs, file);
+    mwLfsStatsSync(entry, start);
+    mwLfsStats.cur = PNULL;
+
+    for (i = 0; i < MW_LFS_STATS_MAX_OPEN; i++)
+    {
+        if (mwLfsStats.open[i].file == file)
+        {
+            mwLfsStats.open[i].file = PNULL;
+        }
+    }
+    return ret;
+}
+
+int __wrap_lfs_file_sync(lfs_t *lfs, lfs_file_t *file)
+{
+    MwLfsFileStats *entry = mwLfsStatsFind(file);
+    UINT32 start;
+    int ret;
+
+    mwLfsStats.cur = entry;
+    start = mwLfsStatsNow();
+    ret = __real_lfs_file_sync(lfs, file);
+    mwLfsStatsSync(entry, start);
+    mwLfsStats.cur = PNULL;
+    return ret;
+}
+
+lfs_ssize_t __wrap_lfs_file_read(lfs_t *lfs, lfs_file_t *file, void *buffer, lfs_size_t size)
+{
+    MwLfsFileStats *entry = mwLfsStatsFind(file);
+    lfs_ssize_t ret;
+
+    mwLfsStats.cur = entry;
+    ret = __real_lfs_file_read(lfs, file, buffer, size);
+    mwLfsStats.cur = PNULL;
+
+    if (entry != PNULL && ret > 0)
+    {
+        entry->bytesRead += (UINT32)ret;
+    }
+    return ret;
+}
+
+lfs_ssize_t __wrap_lfs_file_write(lfs_t *lfs, lfs_file_t *file, const void *buffer, lfs_size_t size)
+{
+    MwLfsFileStats *entry = mwLfsStatsFind(file);
+    lfs_ssize_t ret;
+
+    mwLfsStats.cur = entry;
+    mwLfsStats.inWrite = TRUE;
+    ret = __real_lfs_file_write(lfs, file, buffer, size);
+    mwLfsStats.inWrite = FALSE;
+    mwLfsStats.cur = PNULL;
+
+    if (entry != PNULL && ret > 0)
+    {
+        entry->bytesWritten += (UINT32)ret;
+    }
+    return ret;
+}
+
+void mwLfsStatsGet(MwLfsStats *stats)
+{
+    UINT32 mask;
+
+    if (stats != PNULL)
+    {
+        mask = SaveAndSetIRQMask();
+        *stats = mwLfsStats.stats;
+        RestoreIRQMask(mask);
+    }
+}
+
+INT32 mwLfsStatsGetFile(UINT32 index, MwLfsFileStats *stats)
+{
+    UINT32 mask;
+
+    if (stats == PNULL)
+    {
+        return MW_LFS_STATS_ERR_PARAM;
+    }
+    if (index >= mwLfsStats.fileNum || index >= MW_LFS_STATS_MAX_FILES)
+    {
+        return MW_LFS_STATS_END;
+    }
+
+    mask = SaveAndSetIRQMask();
+    *stats = mwLfsStats.files[index];
+    RestoreIRQMask(mask);
+    return MW_LFS_STATS_OK;
+}
+
+void mwLfsStatsReset(void)
+{
+    UINT32 mask;
+    UINT32 i;
+
+    mask = SaveAndSetIRQMask();
+    memset(&mwLfsStats.stats, 0, sizeof(mwLfsStats.stats));
+    for (i = 0; i < mwLfsStats.fileNum; i++)
+    {
+        memset((UINT8 *)&mwLfsStats.files[i] + MW_LFS_STATS_NAME_LEN, 0,
+               sizeof(MwLfsFileStats) - MW_LFS_STATS_NAME_LEN);
+    }
+    RestoreIRQMask(mask);
+}
+
+void mwLfsStatsDumpToUnilog(void)
+{
+    MwLfsStats stats;
+    MwLfsFileStats file;
+    UINT32 i;
+
+    mwLfsStatsGet(&stats);
+    QCOMM_DUMP(UNILOG_PLA_MIDWARE, mwLfsStatsDump_1, P_INFO, "mwLfsStats",
+               offsetof(MwLfsStats, blockErases), (UINT8 *)&stats);
+    QCOMM_DUMP(UNILOG_PLA_MIDWARE, mwLfsStatsDump_2, P_INFO, "mwLfsStatsBlocks",
+               sizeof(stats.blockErases), (UINT8 *)stats.blockErases);
+
+    for (i = 0; mwLfsStatsGetFile(i, &file) == MW_LFS_STATS_OK; i++)
+    {
+        /* Leave the log task time to drain */
+        osDelay(1);
+        QCOMM_DUMP(UNILOG_PLA_MIDWARE, mwLfsStatsDump_3, P_INFO, "mwLfsStatsFile",
+                   sizeof(file), (UINT8 *)&file);
+    }
+}
+
+#endif
@@ -0,0 +1,916 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_nvjournal.c
+ * Description:  Journaled NV items with field-level delta writes
+ *               nvram_write() stores a whole NV item behind its NV_HEADER, so changing
+ *               one field of a configuration rewrites, and erases, a 4KB sector. The
+ *               nvram backend is prebuilt and hands out flash addresses of the items
+ *               through nvram_get_addr(), so it cannot be journaled underneath; this is
+ *               a separate store for the configuration an application updates often.
+ *
+ *               The items live in a RAM image. The region is split in two banks of
+ *               whole sectors; the active one starts with a header carrying its
+ *               sequence number, followed by records, 4-byte aligned, each framed by a
+ *               CRC16 and never crossing a page. A write compares the new content with
+ *               the image and appends a DATA record per run of changed bytes, then a
+ *               COMMIT record. Records gathered in a page-sized buffer are programmed
+ *               together, so a small update costs one page program.
+ *
+ *               When the active bank has no room left the image is written, as SIZE and
+ *               DATA records, to the other bank, erased first, and its header is
+ *               programmed last with the next sequence number. A compaction cut by a
+ *               reset leaves a bank without a header, and the old one stays active.
+ *
+ *               On start-up the bank with the highest valid header is replayed. Records
+ *               take effect at their COMMIT, so the records of a write cut by a reset
+ *               are dropped; an ABORT record is appended before the next write so that
+ *               they are never taken for part of it. A record failing its CRC is
+ *               skipped with the rest of its page. The replay reads at most one bank
+ *               twice, whatever the number of writes since the last compaction.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "osasys.h"
+#include "flash_qcx212_rt.h"
+#include "mw_chksum.h"
+#include "mw_flashsvc.h"
+#include "mw_nvjournal.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+/* The region is written raw, nothing else may own it */
+#if (MW_NVJ_REGION_OFFSET < FLASH_FS_REGION_END) && \
+    (MW_NVJ_REGION_OFFSET + MW_NVJ_REGION_SIZE > FLASH_FS_REGION_OFFSET)
+#error "MW_NVJ_REGION overlaps the littlefs region"
+#endif
+#if (MW_NVJ_REGION_OFFSET < FLASH_FOTA_REGION_END) && \
+    (MW_NVJ_REGION_OFFSET + MW_NVJ_REGION_SIZE > FLASH_FOTA_REGION_START)
+#error "MW_NVJ_REGION overlaps the FOTA region"
+#endif
+
+#define MW_NVJ_BANK_MAGIC             0x4A564E4D      //"MNVJ"
+#define MW_NVJ_BANK_NONE              0xFF
+
+#define MW_NVJ_REC_PAD                0x01            //rest of the page unused
+#define MW_NVJ_REC_SIZE               0x02            //create, resize or delete (size 0) an item
+#define MW_NVJ_REC_DATA               0x03
+#define MW_NVJ_REC_COMMIT             0x04
+#define MW_NVJ_REC_ABORT              0x05            //drop the uncommitted records before it
+
+#define MW_NVJ_MAX_PAYLOAD            (MW_NVJ_PAGE_SIZE - sizeof(MwNvjRecHdr))
+#define MW_NVJ_MIN_PAYLOAD            16              //below that a run goes to the next page
+
+#define MW_NVJ_ALIGN(n)               (((n) + 3) & ~3UL)
+#define MW_NVJ_PAGE_OF(off)           ((off) & ~(UINT32)(MW_NVJ_PAGE_SIZE - 1))
+
+#define MW_NVJ_NEXT_OK                0
+#define MW_NVJ_NEXT_END               1
+#define MW_NVJ_NEXT_TORN              2
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwNvjBankHdr_Tag
+{
+    UINT32      magic;
+    UINT32      bankSeq;
+    UINT32      reserved;
+    UINT16      reserved2;
+    UINT16      crc;                        //over the fields above
+}MwNvjBankHdr;
+
+typedef struct MwNvjRecHdr_Tag
+{
+    UINT16      len;                        //payload bytes
+    UINT8       type;
+    UINT8       id;
+    UINT16      off;                        //DATA: offset in the item, SIZE: new size
+    UINT16      crc;                        //over the fields above and the payload
+}MwNvjRecHdr;
+
+#define MW_NVJ_DATA_START             sizeof(MwNvjBankHdr)
+
+typedef struct MwNvjItem_Tag
+{
+    UINT16      off;                        //in image[]
+    UINT16      size;
+    UINT8       used;
+}MwNvjItem;
+
+/* Lays records out in a bank. A dry run only works out where they go. */
+typedef struct MwNvjWriter_Tag
+{
+    UINT32      bank;
+    UINT32      off;                        //bank offset of page[0]
+    UINT32      fill;
+    UINT32      records;
+    UINT32      dataBytes;
+    INT32       err;
+    BOOL        dry;
+}MwNvjWriter;
+
+typedef struct MwNvjContext_Tag
+{
+    osMutexId_t         lock;
+    UINT8               started;
+    UINT8               active;             //bank replayed, MW_NVJ_BANK_NONE before the first
+    UINT8               abortPending;       //uncommitted records at the end of the journal
+    UINT8               reserved;
+    UINT32              bankSeq;
+    UINT32              wrOff;              //where the next record goes
+    UINT32              imageUsed;
+    MwNvjItem           items[MW_NVJ_MAX_ITEMS];
+    UINT8               image[MW_NVJ_IMAGE_SIZE];
+    UINT8               page[MW_NVJ_PAGE_SIZE];
+    UINT8               payload[MW_NVJ_PAGE_SIZE];
+    MwNvJournalStats    stats;
+}MwNvjContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwNvjContext mwNvj;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT16 mwNvjRecCrc(const MwNvjRecHdr *hdr, const void *data)
+{
+    UINT16 crc;
+
+    crc = mwCrc16Ccitt(0xFFFF, (const UINT8 *)hdr, offsetof(MwNvjRecHdr, crc));
+    if (hdr->type == MW_NVJ_REC_PAD)
+    {
+        return crc;
+    }
+    return mwCrc16Ccitt(crc, (const UINT8 *)data, hdr->len);
+}
+
+static UINT32 mwNvjAddr(UINT32 bank, UINT32 off)
+{
+    return MW_NVJ_REGION_OFFSET + bank * MW_NVJ_BANK_SIZE + off;
+}
+
+static INT32 mwNvjFlashRead(UINT32 addr, void *buf, UINT32 len)
+{
+    if (BSP_QSPI_Read_Safe((UINT8 *)buf, addr, len) != QSPI_OK)
+    {
+        mwNvj.stats.flashErrors++;
+        return MW_NVJ_ERR_FLASH;
+    }
+    return MW_NVJ_OK;
+}
+
+static UINT32 mwNvjCurSize(UINT8 id)
+{
+    return mwNvj.items[id].used ? mwNvj.items[id].size : 0;
+}
+
+/*
+ * Give item id a new size, keeping its content up to the smaller of the
+ * two sizes and zeroing the rest. Items after it in the image move.
+ */
+static BOOL mwNvjResize(UINT8 id, UINT16 size)
+{
+    MwNvjItem *it = &mwNvj.items[id];
+    UINT32 old = mwNvjCurSize(id);
+    UINT32 tail;
+    UINT32 i;
+
+    if (mwNvj.imageUsed - old + size > MW_NVJ_IMAGE_SIZE)
+    {
+        return FALSE;
+    }
+    if (!it->used)
+    {
+        if (size == 0)
+        {
+            return TRUE;
+        }
+        it->off = (UINT16)mwNvj.imageUsed;
+        it->size = 0;
+        it->used = TRUE;
+    }
+
+    tail = it->off + old;
+    memmove(&mwNvj.image[it->off + size], &mwNvj.image[tail], mwNvj.imageUsed - tail);
+    for (i = 0; i < MW_NVJ_MAX_ITEMS; i++)
+    {
+        if (mwNvj.items[i].used && mwNvj.items[i].off > it->off)
+        {
+            mwNvj.items[i].off = (UINT16)(mwNvj.items[i].off + size - old);
+        }
+    }
+    if (size > old)
+    {
+        memset(&mwNvj.image[it->off + old], 0, size - old);
+    }
+
+    mwNvj.imageUsed = mwNvj.imageUsed - old + size;
+    it->size = size;
+    it->used = (size != 0);
+    return TRUE;
+}
+
+static void mwNvjApply(UINT8 id, UINT16 size, UINT16 off, const UINT8 *data, UINT16 len)
+{
+    mwNvjResize(id, size);
+    if (len > 0)
+    {
+        memcpy(&mwNvj.image[mwNvj.items[id].off + off], data, len);
+    }
+}
+
+static void mwNvjWriterInit(MwNvjWriter *w, UINT32 bank, UINT32 off, BOOL dry)
+{
+    memset(w, 0, sizeof(*w));
+    w->bank = bank;
+    w->off = off;
+    w->dry = dry;
+}
+
+static void mwNvjFlush(MwNvjWriter *w)
+{
+    if (w->fill == 0)
+    {
+        return;
+    }
+    if (!w->dry && w->err == MW_NVJ_OK)
+    {
+        mwNvj.stats.pagePrograms++;
+        if (BSP_QSPI_Write_Safe(mwNvj.page, mwNvjAddr(w->bank, w->off), w->fill) != QSPI_OK)
+        {
+            mwNvj.stats.flashErrors++;
+            w->err = MW_NVJ_ERR_FLASH;
+        }
+    }
+    w->off += w->fill;
+    w->fill = 0;
+}
+
+static void mwNvjPut(MwNvjWriter *w, UINT8 type, UINT8 id, UINT16 off, const void *data, UINT16 len)
+{
+    MwNvjRecHdr hdr;
+    UINT32 size = MW_NVJ_ALIGN(sizeof(hdr) + len);
+
+    if (type == MW_NVJ_REC_PAD)
+    {
+        size = sizeof(hdr) + len;
+    }
+    if (w->off + w->fill + size > MW_NVJ_BANK_SIZE)
+    {
+        if (w->err == MW_NVJ_OK)
+        {
+            w->err = MW_NVJ_ERR_FULL;
+        }
+        return;
+    }
+
+    hdr.len = len;
+    hdr.type = type;
+    hdr.id = id;
+    hdr.off = off;
+    hdr.crc = mwNvjRecCrc(&hdr, data);
+
+    if (!w->dry)
+    {
+        memcpy(&mwNvj.page[w->fill], &hdr, sizeof(hdr));
+        if (type != MW_NVJ_REC_PAD)
+        {
+            if (len > 0)
+            {
+                memcpy(&mwNvj.page[w->fill + sizeof(hdr)], data, len);
+            }
+            memset(&mwNvj.page[w->fill + sizeof(hdr) + len], 0xFF, size - sizeof(hdr) - len);
+        }
+    }
+
+    if (type == MW_NVJ_REC_PAD)
+    {
+        /* Only the header is programmed, the rest of the page stays erased */
+        w->fill += sizeof(hdr);
+        mwNvjFlush(w);
+        w->off += len;
+    }
+    else
+    {
+        w->fill += size;
+        if ((w->off + w->fill) % MW_NVJ_PAGE_SIZE == 0)
+        {
+            mwNvjFlush(w);
+        }
+    }
+    w->records++;
+    if (type == MW_NVJ_REC_DATA)
+    {
+        w->dataBytes += len;
+    }
+}
+
+/*
+ * Payload room for the next record, moving to the next page first when
+ * this one cannot take at least want bytes, or MW_NVJ_MIN_PAYLOAD.
+ */
+static UINT32 mwNvjRoom(MwNvjWriter *w, UINT32 want)
+{
+    UINT32 pos = w->off + w->fill;
+    UINT32 rem = MW_NVJ_PAGE_SIZE - pos % MW_NVJ_PAGE_SIZE;
+
+    if (want > MW_NVJ_MIN_PAYLOAD)
+    {
+        want = MW_NVJ_MIN_PAYLOAD;
+    }
+    if (rem < sizeof(MwNvjRecHdr) + want)
+    {
+        if (rem >= sizeof(MwNvjRecHdr))
+        {
+            mwNvjPut(w, MW_NVJ_REC_PAD, 0, 0, PNULL, (UINT16)(rem - sizeof(MwNvjRecHdr)));
+        }
+        else
+        {
+            /* Too short for a header; readers skip it the same way */
+            mwNvjFlush(w);
+            w->off = MW_NVJ_PAGE_OF(pos) + MW_NVJ_PAGE_SIZE;
+        }
+        rem = MW_NVJ_PAGE_SIZE;
+    }
+    return rem - sizeof(MwNvjRecHdr);
+}
+
+static void mwNvjPutData(MwNvjWriter *w, UINT8 id, UINT32 off, const UINT8 *data, UINT32 len)
+{
+    UINT32 n;
+
+    while (len > 0 && w->err == MW_NVJ_OK)
+    {
+        n = mwNvjRoom(w, len);
+        if (n > len)
+        {
+            n = len;
+        }
+        mwNvjPut(w, MW_NVJ_REC_DATA, id, (UINT16)off, data, (UINT16)n);
+        off += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static BOOL mwNvjDiffers(UINT8 id, UINT32 pos, UINT8 value)
+{
+    const MwNvjItem *it = &mwNvj.items[id];
+
+    return !(it->used && pos < it->size && mwNvj.image[it->off + pos] == value);
+}
+
+/*
+ * Records of a write: the resize if any, then one DATA run per changed
+ * range, runs closer than a record header merged. Returns FALSE when
+ * nothing would change.
+ */
+static BOOL mwNvjEmitWrite(MwNvjWriter *w, UINT8 id, UINT16 size, UINT16 off, const UINT8 *data, UINT16 len)
+{
+    UINT32 start, end, j;
+    UINT32 mark;
+    BOOL ext;
+
+    if (mwNvj.abortPending)
+    {
+        mwNvjRoom(w, 0);
+        mwNvjPut(w, MW_NVJ_REC_ABORT, 0, 0, PNULL, 0);
+    }
+    mark = w->records;
+
+    if (mwNvjCurSize(id) != size)
+    {
+        mwNvjRoom(w, 0);
+        mwNvjPut(w, MW_NVJ_REC_SIZE, id, size, PNULL, 0);
+    }
+
+    for (start = 0; start < len; start = end)
+    {
+        end = start + 1;
+        if (!mwNvjDiffers(id, off + start, data[start]))
+        {
+            continue;
+        }
+        do
+        {
+            ext = FALSE;
+            for (j = end; j < len && j < end + sizeof(MwNvjRecHdr); j++)
+            {
+                if (mwNvjDiffers(id, off + j, data[j]))
+                {
+                    end = j + 1;
+                    ext = TRUE;
+                    break;
+                }
+            }
+        } while (ext);
+        mwNvjPutData(w, id, off + start, &data[start], end - start);
+    }
+
+    if (w->records == mark && w->err == MW_NVJ_OK)
+    {
+        return FALSE;
+    }
+    mwNvjRoom(w, 0);
+    mwNvjPut(w, MW_NVJ_REC_COMMIT, 0, 0, PNULL, 0);
+    mwNvjFlush(w);
+    return TRUE;
+}
+
+static BOOL mwNvjReadBankHdr(UINT32 bank, MwNvjBankHdr *hdr)
+{
+    if (mwNvjFlashRead(mwNvjAddr(bank, 0), hdr, sizeof(*hdr)) != MW_NVJ_OK)
+    {
+        return FALSE;
+    }
+    return hdr->magic == MW_NVJ_BANK_MAGIC &&
+           hdr->crc == mwCrc16Ccitt(0xFFFF, (const UINT8 *)hdr, offsetof(MwNvjBankHdr, crc));
+}
+
+/*
+ * Read the record at *pos into hdr and payload[] and step past it.
+ * Returns MW_NVJ_NEXT_END at the first erased header, MW_NVJ_NEXT_TORN
+ * for a damaged record, which is skipped with the rest of its page.
+ */
+static INT32 mwNvjNextRec(UINT32 bank, UINT32 *pos, MwNvjRecHdr *hdr)
+{
+    UINT32 p = *pos;
+
+    if (MW_NVJ_PAGE_SIZE - p % MW_NVJ_PAGE_SIZE < sizeof(*hdr))
+    {
+        p = MW_NVJ_PAGE_OF(p) + MW_NVJ_PAGE_SIZE;
+    }
+    *pos = p;
+    if (p + sizeof(*hdr) > MW_NVJ_BANK_SIZE)
+    {
+        return MW_NVJ_NEXT_END;
+    }
+    if (mwNvjFlashRead(mwNvjAddr(bank, p), hdr, sizeof(*hdr)) != MW_NVJ_OK)
+    {
+        return MW_NVJ_ERR_FLASH;
+    }
+    if (hdr->len == 0xFFFF && hdr->type == 0xFF && hdr->id == 0xFF && hdr->off == 0xFFFF && hdr->crc == 0xFFFF)
+    {
+        return MW_NVJ_NEXT_END;
+    }
+
+    if (hdr->type < MW_NVJ_REC_PAD || hdr->type > MW_NVJ_REC_ABORT ||
+        p % MW_NVJ_PAGE_SIZE + sizeof(*hdr) + hdr->len > MW_NVJ_PAGE_SIZE)
+    {
+        goto torn;
+    }
+    if (hdr->type != MW_NVJ_REC_PAD && hdr->len > 0 &&
+        mwNvjFlashRead(mwNvjAddr(bank, p + sizeof(*hdr)), mwNvj.payload, hdr->len) != MW_NVJ_OK)
+    {
+        return MW_NVJ_ERR_FLASH;
+    }
+    if (hdr->crc != mwNvjRecCrc(hdr, mwNvj.payload))
+    {
+        goto torn;
+    }
+
+    mwNvj.stats.replayRecords++;
+    *pos = p + ((hdr->type == MW_NVJ_REC_PAD) ? sizeof(*hdr) + hdr->len : MW_NVJ_ALIGN(sizeof(*hdr) + hdr->len));
+    return MW_NVJ_NEXT_OK;
+
+torn:
+    mwNvj.stats.tornRecords++;
+    *pos = MW_NVJ_PAGE_OF(p) + MW_NVJ_PAGE_SIZE;
+    return MW_NVJ_NEXT_TORN;
+}
+
+/* Apply the records from pos up to the COMMIT that ends them */
+static INT32 mwNvjApplyTxn(UINT32 bank, UINT32 pos)
+{
+    MwNvjRecHdr hdr;
+    INT32 ret;
+
+    while ((ret = mwNvjNextRec(bank, &pos, &hdr)) == MW_NVJ_NEXT_OK && hdr.type != MW_NVJ_REC_COMMIT)
+    {
+        if (hdr.id >= MW_NVJ_MAX_ITEMS)
+        {
+            continue;
+        }
+        if (hdr.type == MW_NVJ_REC_SIZE)
+        {
+            mwNvjResize(hdr.id, hdr.off);
+        }
+        else if (hdr.type == MW_NVJ_REC_DATA && mwNvj.items[hdr.id].used &&
+                 hdr.off + hdr.len <= mwNvj.items[hdr.id].size)
+        {
+            memcpy(&mwNvj.image[mwNvj.items[hdr.id].off + hdr.off], mwNvj.payload, hdr.len);
+        }
+    }
+    return (ret == MW_NVJ_ERR_FLASH) ? MW_NVJ_ERR_FLASH : MW_NVJ_OK;
+}
+
+static INT32 mwNvjReplay(UINT32 bank)
+{
+    MwNvjRecHdr hdr;
+    UINT32 pos = MW_NVJ_DATA_START;
+    UINT32 txnStart = MW_NVJ_DATA_START;
+    BOOL pending = FALSE;
+    BOOL bad = FALSE;
+    INT32 ret;
+
+    memset(mwNvj.items, 0, sizeof(mwNvj.items));
+    mwNvj.imageUsed = 0;
+    mwNvj.stats.replayRecords = 0;
+
+    while ((ret = mwNvjNextRec(bank, &pos, &hdr)) != MW_NVJ_NEXT_END)
+    {
+        if (ret == MW_NVJ_ERR_FLASH)
+        {
+            return MW_NVJ_ERR_FLASH;
+        }
+        if (ret == MW_NVJ_NEXT_TORN)
+        {
+            bad = TRUE;
+            continue;
+        }
+
+        switch (hdr.type)
+        {
+            case MW_NVJ_REC_SIZE:
+            case MW_NVJ_REC_DATA:
+                pending = TRUE;
+                break;
+
+            case MW_NVJ_REC_COMMIT:
+                if (!bad && mwNvjApplyTxn(bank, txnStart) != MW_NVJ_OK)
+                {
+                    return MW_NVJ_ERR_FLASH;
+                }
+                /* fall through */
+            case MW_NVJ_REC_ABORT:
+                txnStart = pos;
+                pending = FALSE;
+                bad = FALSE;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    mwNvj.active = (UINT8)bank;
+    mwNvj.wrOff = pos;
+    mwNvj.abortPending = (pending || bad);
+    return MW_NVJ_OK;
+}
+
+/* Write the image to the other bank, and make it the active one */
+static INT32 mwNvjCompact(void)
+{
+    MwNvjWriter w;
+    MwNvjBankHdr hdr;
+    UINT32 bank = (mwNvj.active == MW_NVJ_BANK_NONE) ? 0 : mwNvj.active ^ 1;
+    UINT32 i;
+
+    /* Usually erased ahead since the last compaction, then only blank checked */
+    mwNvj.stats.sectorErases += MW_NVJ_BANK_SIZE / MW_NVJ_SECTOR_SIZE;
+    if (mwFlashSvcErase(mwNvjAddr(bank, 0), MW_NVJ_BANK_SIZE) != MW_FLASHSVC_OK ||
+        mwFlashSvcFlush(osWaitForever) != MW_FLASHSVC_OK)
+    {
+        mwNvj.stats.flashErrors++;
+        return MW_NVJ_ERR_FLASH;
+    }
+
+    mwNvjWriterInit(&w, bank, MW_NVJ_DATA_START, FALSE);
+    for (i = 0; i < MW_NVJ_MAX_ITEMS; i++)
+    {
+        if (mwNvj.items[i].used)
+        {
+            mwNvjRoom(&w, 0);
+            mwNvjPut(&w, MW_NVJ_REC_SIZE, (UINT8)i, mwNvj.items[i].size, PNULL, 0);
+            mwNvjPutData(&w, (UINT8)i, 0, &mwNvj.image[mwNvj.items[i].off], mwNvj.items[i].size);
+        }
+    }
+    mwNvjRoom(&w, 0);
+    mwNvjPut(&w, MW_NVJ_REC_COMMIT, 0, 0, PNULL, 0);
+    mwNvjFlush(&w);
+    if (w.err != MW_NVJ_OK)
+    {
+        return w.err;
+    }
+
+    hdr.magic = MW_NVJ_BANK_MAGIC;
+    hdr.bankSeq = mwNvj.bankSeq + 1;
+    hdr.reserved = 0xFFFFFFFF;
+    hdr.reserved2 = 0xFFFF;
+    hdr.crc = mwCrc16Ccitt(0xFFFF, (const UINT8 *)&hdr, offsetof(MwNvjBankHdr, crc));
+    mwNvj.stats.pagePrograms++;
+    if (BSP_QSPI_Write_Safe((UINT8 *)&hdr, mwNvjAddr(bank, 0), sizeof(hdr)) != QSPI_OK)
+    {
+        mwNvj.stats.flashErrors++;
+        return MW_NVJ_ERR_FLASH;
+    }
+
+    mwNvj.active = (UINT8)bank;
+    mwNvj.bankSeq = hdr.bankSeq;
+    mwNvj.wrOff = w.off;
+    mwNvj.abortPending = FALSE;
+    mwNvj.stats.compactions++;
+
+    /* The bank left behind is the next one to compact into */
+    mwFlashSvcEraseAhead(mwNvjAddr(bank ^ 1, 0), MW_NVJ_BANK_SIZE);
+    return MW_NVJ_OK;
+}
+
+static INT32 mwNvjRecover(void)
+{
+    MwNvjBankHdr hdr[2];
+    BOOL valid[2];
+    UINT32 bank;
+    INT32 ret;
+
+    valid[0] = mwNvjReadBankHdr(0, &hdr[0]);
+    valid[1] = mwNvjReadBankHdr(1, &hdr[1]);
+
+    mwNvj.active = MW_NVJ_BANK_NONE;
+    if (!valid[0] && !valid[1])
+    {
+        mwNvj.bankSeq = 0;
+        return mwNvjCompact();
+    }
+
+    bank = (valid[1] && (!valid[0] || (INT32)(hdr[1].bankSeq - hdr[0].bankSeq) > 0)) ? 1 : 0;
+    mwNvj.bankSeq = hdr[bank].bankSeq;
+    ret = mwNvjReplay(bank);
+    if (ret == MW_NVJ_OK)
+    {
+        mwFlashSvcEraseAhead(mwNvjAddr(bank ^ 1, 0), MW_NVJ_BANK_SIZE);
+    }
+    return ret;
+}
+
+/*
+ * Set item id to size bytes, with len bytes of data at off. Appended to
+ * the journal when it fits, else carried into a compaction.
+ */
+static INT32 mwNvjUpdate(UINT8 id, UINT16 size, UINT16 off, const UINT8 *data, UINT16 len)
+{
+    MwNvjWriter w;
+    INT32 ret;
+
+    if (mwNvj.imageUsed - mwNvjCurSize(id) + size > MW_NVJ_IMAGE_SIZE)
+    {
+        return MW_NVJ_ERR_FULL;
+    }
+
+    mwNvjWriterInit(&w, mwNvj.active, mwNvj.wrOff, TRUE);
+    if (!mwNvjEmitWrite(&w, id, size, off, data, len))
+    {
+        mwNvj.stats.unchanged++;
+        return MW_NVJ_OK;
+    }
+
+    if (w.err == MW_NVJ_OK)
+    {
+        mwNvjWriterInit(&w, mwNvj.active, mwNvj.wrOff, FALSE);
+        mwNvjEmitWrite(&w, id, size, off, data, len);
+        if (w.err != MW_NVJ_OK)
+        {
+            /* Whatever reached the flash has no COMMIT; the next write aborts it */
+            mwNvj.abortPending = TRUE;
+            mwNvj.wrOff = MW_NVJ_PAGE_OF(w.off + w.fill) + MW_NVJ_PAGE_SIZE;
+            return w.err;
+        }
+        mwNvj.wrOff = w.off;
+        mwNvj.abortPending = FALSE;
+        mwNvjApply(id, size, off, data, len);
+    }
+    else
+    {
+        mwNvjApply(id, size, off, data, len);
+        ret = mwNvjCompact();
+        if (ret != MW_NVJ_OK)
+        {
+            /* Back to what the flash holds */
+            mwNvjReplay(mwNvj.active);
+            return ret;
+        }
+    }
+
+    mwNvj.stats.writes++;
+    mwNvj.stats.deltaBytes += w.dataBytes;
+    return MW_NVJ_OK;
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+INT32 mwNvJournalInit(void)
+{
+    const osMutexAttr_t lockAttr = { "mwNvJournal", osMutexPrioInherit, NULL, 0 };
+    int32_t kernelLock;
+
+    kernelLock = osKernelLock();
+    if (mwNvj.started)
+    {
+        osKernelRestoreLock(kernelLock);
+        return MW_NVJ_OK;
+    }
+    mwNvj.started = TRUE;
+    osKernelRestoreLock(kernelLock);
+
+    mwNvj.lock = osMutexNew(&lockAttr);
+    if (mwNvj.lock == PNULL)
+    {
+        goto fail;
+    }
+
+    if (mwNvjRecover() != MW_NVJ_OK)
+    {
+        osMutexDelete(mwNvj.lock);
+        mwNvj.lock = PNULL;
+        mwNvj.started = FALSE;
+        return MW_NVJ_ERR_FLASH;
+    }
+    return MW_NVJ_OK;
+
+fail:
+    mwNvj.started = FALSE;
+    return MW_NVJ_ERR_SYS;
+}
+
+INT32 mwNvJournalWrite(UINT8 id, const void *data, UINT16 size)
+{
+    INT32 ret;
+
+    if (id >= MW_NVJ_MAX_ITEMS || data == PNULL || size == 0 || size > MW_NVJ_IMAGE_SIZE)
+    {
+        return MW_NVJ_ERR_PARAM;
+    }
+    if (mwNvj.lock == PNULL)
+    {
+        return MW_NVJ_ERR_STATE;
+    }
+
+    osMutexAcquire(mwNvj.lock, osWaitForever);
+    ret = mwNvjUpdate(id, size, 0, (const UINT8 *)data, size);
+    osMutexRelease(mwNvj.lock);
+    return ret;
+}
+
+INT32 mwNvJournalWriteField(UINT8 id, UINT16 offset, const void *data, UINT16 len)
+{
+    INT32 ret;
+
+    if (id >= MW_NVJ_MAX_ITEMS || (data == PNULL && len > 0))
+    {
+        return MW_NVJ_ERR_PARAM;
+    }
+    if (mwNvj.lock == PNULL)
+    {
+        return MW_NVJ_ERR_STATE;
+    }
+
+    osMutexAcquire(mwNvj.lock, osWaitForever);
+    if (!mwNvj.items[id].used)
+    {
+        ret = MW_NVJ_ERR_NOT_FOUND;
+    }
+    else if ((UINT32)offset + len > mwNvj.items[id].size)
+    {
+        ret = MW_NVJ_ERR_PARAM;
+    }
+    else
+    {
+        ret = mwNvjUpdate(id, mwNvj.items[id].size, offset, (const UINT8 *)data, len);
+    }
+    osMutexRelease(mwNvj.lock);
+    return ret;
+}
+
+INT32 mwNvJournalRead(UINT8 id, UINT16 offset, void *data, UINT16 len)
+{
+    INT32 ret = MW_NVJ_OK;
+
+    if (id >= MW_NVJ_MAX_ITEMS || (data == PNULL && len > 0))
+    {
+        return MW_NVJ_ERR_PARAM;
+    }
+    if (mwNvj.lock == PNULL)
+    {
+        return MW_NVJ_ERR_STATE;
+    }
+
+    osMutexAcquire(mwNvj.lock, osWaitForever);
+    if (!mwNvj.items[id].used)
+    {
+        ret = MW_NVJ_ERR_NOT_FOUND;
+    }
+    else if ((UINT32)offset + len > mwNvj.items[id].size)
+    {
+        ret = MW_NVJ_ERR_PARAM;
+    }
+    else
+    {
+        memcpy(data, &mwNvj.image[mwNvj.items[id].off + offset], len);
+    }
+    osMutexRelease(mwNvj.lock);
+    return ret;
+}
+
+UINT16 mwNvJournalSize(UINT8 id)
+{
+    if (id >= MW_NVJ_MAX_ITEMS)
+    {
+        return 0;
+    }
+    return (UINT16)mwNvjCurSize(id);
+}
+
+INT32 mwNvJournalDelete(UINT8 id)
+{
+    INT32 ret;
+
+    if (id >= MW_NVJ_MAX_ITEMS)
+    {
+        return MW_NVJ_ERR_PARAM;
+    }
+    if (mwNvj.lock == PNULL)
+    {
+        return MW_NVJ_ERR_STATE;
+    }
+
+    osMutexAcquire(mwNvj.lock, osWaitForever);
+    ret = mwNvj.items[id].used ? mwNvjUpdate(id, 0, 0, PNULL, 0) : MW_NVJ_ERR_NOT_FOUND;
+    osMutexRelease(mwNvj.lock);
+    return ret;
+}
+
+INT32 mwNvJournalCompact(void)
+{
+    INT32 ret;
+
+    if (mwNvj.lock == PNULL)
+    {
+        return MW_NVJ_ERR_STATE;
+    }
+
+    osMutexAcquire(mwNvj.lock, osWaitForever);
+    ret = mwNvjCompact();
+    osMutexRelease(mwNvj.lock);
+    return ret;
+}
+
+INT32 mwNvJournalFormat(void)
+{
+    INT32 ret;
+
+    if (mwNvj.lock == PNULL)
+    {
+        return MW_NVJ_ERR_STATE;
+    }
+
+    osMutexAcquire(mwNvj.lock, osWaitForever);
+    memset(mwNvj.items, 0, sizeof(mwNvj.items));
+    mwNvj.imageUsed = 0;
+    ret = mwNvjCompact();
+    osMutexRelease(mwNvj.lock);
+    return ret;
+}
+
+void mwNvJournalGetStats(MwNvJournalStats *stats)
+{
+    if (stats == PNULL)
+    {
+        return;
+    }
+
+    if (mwNvj.lock != PNULL)
+    {
+        osMutexAcquire(mwNvj.lock, osWaitForever);
+    }
+    *stats = mwNvj.stats;
+    stats->bankSeq = mwNvj.bankSeq;
+    stats->journalUsed = mwNvj.wrOff;
+    stats->imageUsed = mwNvj.imageUsed;
+    if (mwNvj.lock != PNULL)
+    {
+        osMutexRelease(mwNvj.lock);
+    }
+}
@@ -0,0 +1,576 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_pcap.c
+ * Description:  In-RAM packet capture ring for field debugging of the IP link
+ *               lwIP and the PS libraries are prebuilt, so the capture points are made
+ *               at their boundaries instead of inside them:
+ *
+ *               - Downlink into lwIP: every packet the PS hands to lwIP goes through
+ *               TcpipPsInpkt(), which is wrapped at link time (-Wl,--wrap).
+ *               - Output: netif_add() is wrapped as well, and output / output_ip6 of
+ *               each new netif are replaced by functions that record the packet and
+ *               call the original. This covers the NB-IoT netifs, which are added
+ *               again on every bearer activation, and the LAN netifs.
+ *               - Fast path: NetifDlPkgFastPathIsr() and NetifUlPkgFastPath() forward
+ *               between the PS and PPP/RNDIS without lwIP and are wrapped too, with
+ *               MW_PCAP_FASTPATH_ENABLE.
+ *
+ *               The downlink hooks run in interrupt context, so the ring is a plain byte
+ *               ring written with interrupts masked for the few dozen bytes copied per
+ *               packet; nothing is allocated. Packets that are not IPv4 or IPv6 at the
+ *               capture point, such as ROHC compressed ones, are counted and skipped.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifdef MW_PCAP_ENABLE
+
+#include <string.h>
+#include "cmsis_os2.h"
+#include "osasys.h"
+#include "system_qcx212.h"
+#include "netif.h"
+#include "tcpip.h"
+#include "debug_log.h"
+#include "mw_pcap.h"
+#ifdef MW_PCAP_FASTPATH_ENABLE
+#include "netfastpath.h"
+#endif
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_PCAP_ALIGN(len)            (((len) + 3) & ~3)
+#define MW_PCAP_UNILOG_CHUNK          128
+#define MW_PCAP_NO_CID                0xFF
+
+#if (MW_PCAP_RING_SIZE & 3) || (MW_PCAP_RING_SIZE > 65535)
+#error "MW_PCAP_RING_SIZE must be a multiple of 4 below 64 KB"
+#endif
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwPcapNetif_Tag
+{
+    struct netif        *netif;
+    netif_output_fn     output;
+#if LWIP_IPV6
+    netif_output_ip6_fn output_ip6;
+#endif
+}MwPcapNetif;
+
+typedef struct MwPcapContext_Tag
+{
+    UINT8           ring[MW_PCAP_RING_SIZE];
+    UINT16          head;           //next byte to write
+    UINT16          tail;           //oldest record
+    UINT16          used;
+    UINT8           snapLen;
+    UINT8           running;
+    UINT8           paused;
+    UINT8           stopWhenFull;
+    MwPcapStats     stats;
+    MwPcapNetif     netif[MW_PCAP_MAX_NETIF];
+}MwPcapContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwPcapContext mwPcap;
+
+extern err_t __real_TcpipPsInpkt(UINT8 lcid, DlPduBlock *pPduHdr, psif_input_fn ps_input_fn);
+extern struct netif *__real_netif_add(struct netif *netif,
+#if LWIP_IPV4
+                                      const ip4_addr_t *ipaddr, const ip4_addr_t *netmask, const ip4_addr_t *gw,
+#endif
+                                      void *state, netif_init_fn init, netif_input_fn input);
+#ifdef MW_PCAP_FASTPATH_ENABLE
+extern void __real_NetifDlPkgFastPathIsr(UINT8 cid, UINT32 pkgNum, DlPduBlock *pDlHdr, DlPduBlock *pDlTail,
+                                         NetifFastChkInfo *pChannelChkInfo);
+extern void __real_NetifUlPkgFastPath(UINT8 lanType, UlPduBlock *pUlHdr, void *pUlChkInfo);
+#endif
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT32 mwPcapNowMs(void)
+{
+    UINT32 ticks = osKernelGetTickCount();
+    UINT32 freq = osKernelGetTickFreq();
+
+    if (freq == 1000)
+    {
+        return ticks;
+    }
+    return (UINT32)(((UINT64)ticks * 1000) / freq);
+}
+
+static BOOL mwPcapIsIp(const UINT8 *data, UINT32 len)
+{
+    return len != 0 && ((data[0] >> 4) == 4 || (data[0] >> 4) == 6);
+}
+
+static void mwPcapPut(UINT16 *pos, const void *src, UINT16 len)
+{
+    UINT16 first = MW_PCAP_RING_SIZE - *pos;
+
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(&mwPcap.ring[*pos], src, first);
+    memcpy(&mwPcap.ring[0], (const UINT8 *)src + first, len - first);
+    *pos = (UINT16)((*pos + len) % MW_PCAP_RING_SIZE);
+}
+
+static void mwPcapGet(UINT16 pos, void *dst, UINT16 len)
+{
+    UINT16 first = MW_PCAP_RING_SIZE - pos;
+
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(dst, &mwPcap.ring[pos], first);
+    memcpy((UINT8 *)dst + first, &mwPcap.ring[0], len - first);
+}
+
+/*
+ * Reserve room for a record of a packet of origLen bytes starting with
+ * data, dropping the oldest records if allowed, and write its header.
+ * Interrupts must be masked. Returns the position for the captured bytes
+ * with their number in capLen, or -1 when the packet is not recorded.
+ */
+static INT32 mwPcapBegin(UINT8 dir, UINT8 path, UINT8 cid, const UINT8 *data, UINT32 dataLen,
+                         UINT32 origLen, UINT8 *capLen)
+{
+    MwPcapRecHdr hdr;
+    UINT16 recLen;
+    UINT16 oldLen;
+    UINT16 pos;
+
+    /* Paused while a dump is reading the ring */
+    if (!mwPcap.running || mwPcap.paused)
+    {
+        return -1;
+    }
+    if (!mwPcapIsIp(data, dataLen))
+    {
+        mwPcap.stats.skipped++;
+        return -1;
+    }
+
+    *capLen = (origLen < mwPcap.snapLen) ? (UINT8)origLen : mwPcap.snapLen;
+    recLen = MW_PCAP_ALIGN(sizeof(MwPcapRecHdr) + *capLen);
+    while (MW_PCAP_RING_SIZE - mwPcap.used < recLen)
+    {
+        if (mwPcap.stopWhenFull)
+        {
+            mwPcap.stats.stopped++;
+            return -1;
+        }
+        /* Records are 4 byte aligned, so recLen itself never wraps */
+        oldLen = *(UINT16 *)&mwPcap.ring[mwPcap.tail];
+        mwPcap.tail = (UINT16)((mwPcap.tail + oldLen) % MW_PCAP_RING_SIZE);
+        mwPcap.used -= oldLen;
+        mwPcap.stats.overwritten++;
+    }
+
+    hdr.recLen = recLen;
+    hdr.origLen = (origLen > 0xFFFF) ? 0xFFFF : (UINT16)origLen;
+    hdr.tickMs = mwPcapNowMs();
+    hdr.dir = dir;
+    hdr.path = path;
+    hdr.cid = cid;
+    hdr.capLen = *capLen;
+
+    pos = mwPcap.head;
+    mwPcapPut(&pos, &hdr, sizeof(hdr));
+    mwPcap.head = (UINT16)((mwPcap.head + recLen) % MW_PCAP_RING_SIZE);
+    mwPcap.used += recLen;
+    mwPcap.stats.recorded++;
+    return pos;
+}
+
+/* Record one contiguous packet */
+static void mwPcapRecord(UINT8 dir, UINT8 path, UINT8 cid, const UINT8 *data, UINT32 len)
+{
+    UINT8 capLen;
+    UINT32 mask;
+    INT32 pos;
+    UINT16 wr;
+
+    mask = SaveAndSetIRQMask();
+    pos = mwPcapBegin(dir, path, cid, data, len, len, &capLen);
+    if (pos >= 0)
+    {
+        wr = (UINT16)pos;
+        mwPcapPut(&wr, data, capLen);
+    }
+    RestoreIRQMask(mask);
+}
+
+static void mwPcapRecordPbuf(UINT8 dir, UINT8 cid, struct pbuf *p)
+{
+    struct pbuf *q;
+    UINT8 capLen;
+    UINT16 left;
+    UINT16 n;
+    UINT32 mask;
+    INT32 pos;
+    UINT16 wr;
+
+    if (p == PNULL)
+    {
+        return;
+    }
+
+    mask = SaveAndSetIRQMask();
+    pos = mwPcapBegin(dir, MW_PCAP_PATH_LWIP, cid, (const UINT8 *)p->payload, p->len, p->tot_len, &capLen);
+    if (pos >= 0)
+    {
+        wr = (UINT16)pos;
+        left = capLen;
+        for (q = p; q != PNULL && left != 0; q = q->next)
+        {
+            n = (q->len < left) ? q->len : left;
+            mwPcapPut(&wr, q->payload, n);
+            left -= n;
+        }
+    }
+    RestoreIRQMask(mask);
+}
+
+static MwPcapNetif *mwPcapFindNetif(struct netif *netif)
+{
+    UINT32 i;
+
+    for (i = 0; i < MW_PCAP_MAX_NETIF; i++)
+    {
+        if (mwPcap.netif[i].netif == netif)
+        {
+            return &mwPcap.netif[i];
+        }
+    }
+    return PNULL;
+}
+
+static err_t mwPcapOutput(struct netif *netif, struct pbuf *p, const ip4_addr_t *ipaddr)
+{
+    MwPcapNetif *slot = mwPcapFindNetif(netif);
+
+    if (slot == PNULL || slot->output == PNULL)
+    {
+        return ERR_IF;
+    }
+    mwPcapRecordPbuf(MW_PCAP_DIR_OUT, netif->primary_ipv4_cid, p);
+    return slot->output(netif, p, ipaddr);
+}
+
+#if LWIP_IPV6
+static err_t mwPcapOutputIp6(struct netif *netif, struct pbuf *p, const ip6_addr_t *ipaddr)
+{
+    MwPcapNetif *slot = mwPcapFindNetif(netif);
+
+    if (slot == PNULL || slot->output_ip6 == PNULL)
+    {
+        return ERR_IF;
+    }
+    mwPcapRecordPbuf(MW_PCAP_DIR_OUT, netif->primary_ipv6_cid, p);
+    return slot->output_ip6(netif, p, ipaddr);
+}
+#endif
+
+static INT32 mwPcapSnapshot(MwPcapFileHdr *hdr)
+{
+    UINT32 mask;
+
+    mask = SaveAndSetIRQMask();
+    if (mwPcap.snapLen == 0)
+    {
+        RestoreIRQMask(mask);
+        return MW_PCAP_ERR_STATE;
+    }
+    mwPcap.paused = TRUE;
+    hdr->magic = MW_PCAP_FILE_MAGIC;
+    hdr->version = MW_PCAP_FILE_VERSION;
+    hdr->snapLen = mwPcap.snapLen;
+    hdr->dumpTickMs = mwPcapNowMs();
+    hdr->recorded = mwPcap.stats.recorded;
+    hdr->overwritten = mwPcap.stats.overwritten;
+    hdr->dataLen = mwPcap.used;
+    RestoreIRQMask(mask);
+
+    hdr->dumpUtcSecs = (UINT32)OsaSystemTimeReadSecs();
+    return MW_PCAP_OK;
+}
+
+/* Copy len bytes at off of the dump: the header followed by the records from the tail */
+static void mwPcapRead(const MwPcapFileHdr *hdr, UINT32 off, UINT8 *dst, UINT32 len)
+{
+    UINT32 n;
+
+    if (off < sizeof(MwPcapFileHdr))
+    {
+        n = sizeof(MwPcapFileHdr) - off;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(dst, (const UINT8 *)hdr + off, n);
+        dst += n;
+        off += n;
+        len -= n;
+    }
+    if (len != 0)
+    {
+        mwPcapGet((UINT16)((mwPcap.tail + off - sizeof(MwPcapFileHdr)) % MW_PCAP_RING_SIZE), dst, (UINT16)len);
+    }
+}
+
+static void mwPcapResume(void)
+{
+    mwPcap.paused = FALSE;
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * LINK TIME WRAPPERS
+ *****************************************************************************
+******************************************************************************/
+err_t __wrap_TcpipPsInpkt(UINT8 lcid, DlPduBlock *pPduHdr, psif_input_fn ps_input_fn)
+{
+    DlPduBlock *pdu;
+
+    for (pdu = pPduHdr; pdu != PNULL && mwPcap.running; pdu = pdu->pNext)
+    {
+        if (!pdu->bRohcFeedback)
+        {
+            mwPcapRecord(MW_PCAP_DIR_IN, MW_PCAP_PATH_LWIP, lcid, pdu->pPdu, pdu->length);
+        }
+    }
+    return __real_TcpipPsInpkt(lcid, pPduHdr, ps_input_fn);
+}
+
+struct netif *__wrap_netif_add(struct netif *netif,
+#if LWIP_IPV4
+                               const ip4_addr_t *ipaddr, const ip4_addr_t *netmask, const ip4_addr_t *gw,
+#endif
+                               void *state, netif_init_fn init, netif_input_fn input)
+{
+    MwPcapNetif *slot;
+    struct netif *ret;
+
+    ret = __real_netif_add(netif,
+#if LWIP_IPV4
+                           ipaddr, netmask, gw,
+#endif
+                           state, init, input);
+    if (ret == PNULL)
+    {
+        return ret;
+    }
+
+    /* A netif struct added again gets a fresh output from its init function */
+    slot = mwPcapFindNetif(netif);
+    if (slot == PNULL)
+    {
+        slot = mwPcapFindNetif(PNULL);
+    }
+    if (slot == PNULL)
+    {
+        return ret;
+    }
+
+    slot->netif = netif;
+    slot->output = netif->output;
+    if (netif->output != PNULL)
+    {
+        netif->output = mwPcapOutput;
+    }
+#if LWIP_IPV6
+    slot->output_ip6 = netif->output_ip6;
+    if (netif->output_ip6 != PNULL)
+    {
+        netif->output_ip6 = mwPcapOutputIp6;
+    }
+#endif
+    return ret;
+}
+
+#ifdef MW_PCAP_FASTPATH_ENABLE
+void __wrap_NetifDlPkgFastPathIsr(UINT8 cid, UINT32 pkgNum, DlPduBlock *pDlHdr, DlPduBlock *pDlTail,
+                                  NetifFastChkInfo *pChannelChkInfo)
+{
+    DlPduBlock *pdu = pDlHdr;
+    UINT32 i;
+
+    for (i = 0; i < pkgNum && pdu != PNULL && mwPcap.running; i++)
+    {
+        if (!pdu->bRohcFeedback)
+        {
+            mwPcapRecord(MW_PCAP_DIR_IN, MW_PCAP_PATH_FASTPATH, cid, pdu->pPdu, pdu->length);
+        }
+        if (pdu == pDlTail)
+        {
+            break;
+        }
+        pdu = pdu->pNext;
+    }
+    __real_NetifDlPkgFastPathIsr(cid, pkgNum, pDlHdr, pDlTail, pChannelChkInfo);
+}
+
+void __wrap_NetifUlPkgFastPath(UINT8 lanType, UlPduBlock *pUlHdr, void *pUlChkInfo)
+{
+    UlPduBlock *pdu;
+
+    /* Only the first segment of a packet is captured, it holds the headers */
+    for (pdu = pUlHdr; pdu != PNULL && mwPcap.running; pdu = pdu->pNext)
+    {
+        mwPcapRecord(MW_PCAP_DIR_OUT, MW_PCAP_PATH_FASTPATH, MW_PCAP_NO_CID,
+                     pdu->ptr + pdu->validOffset, pdu->length);
+        while (pdu->bContinue && pdu->pNext != PNULL)
+        {
+            pdu = pdu->pNext;
+        }
+    }
+    __real_NetifUlPkgFastPath(lanType, pUlHdr, pUlChkInfo);
+}
+#endif
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+INT32 mwPcapStart(UINT16 snapLen, BOOL stopWhenFull)
+{
+    UINT32 mask;
+
+    if (snapLen == 0 || snapLen > 255)
+    {
+        return MW_PCAP_ERR_PARAM;
+    }
+
+    mask = SaveAndSetIRQMask();
+    mwPcap.head = 0;
+    mwPcap.tail = 0;
+    mwPcap.used = 0;
+    memset(&mwPcap.stats, 0, sizeof(mwPcap.stats));
+    mwPcap.snapLen = (UINT8)snapLen;
+    mwPcap.stopWhenFull = stopWhenFull ? TRUE : FALSE;
+    mwPcap.paused = FALSE;
+    mwPcap.running = TRUE;
+    RestoreIRQMask(mask);
+    return MW_PCAP_OK;
+}
+
+void mwPcapStop(void)
+{
+    mwPcap.running = FALSE;
+}
+
+INT32 mwPcapDumpToFile(const char *fileName)
+{
+    MwPcapFileHdr hdr;
+    OSAFILE fp;
+    UINT16 first;
+    INT32 ret = MW_PCAP_OK;
+
+    if (fileName == PNULL)
+    {
+        return MW_PCAP_ERR_PARAM;
+    }
+    if (mwPcapSnapshot(&hdr) != MW_PCAP_OK)
+    {
+        return MW_PCAP_ERR_STATE;
+    }
+
+    first = MW_PCAP_RING_SIZE - mwPcap.tail;
+    if (first > hdr.dataLen)
+    {
+        first = (UINT16)hdr.dataLen;
+    }
+
+    fp = OsaFopen(fileName, "wb");
+    if (fp == PNULL ||
+        OsaFwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        (first != 0 && OsaFwrite(&mwPcap.ring[mwPcap.tail], first, 1, fp) != 1) ||
+        (hdr.dataLen > first && OsaFwrite(&mwPcap.ring[0], hdr.dataLen - first, 1, fp) != 1))
+    {
+        ret = MW_PCAP_ERR_FILE;
+    }
+    if (fp != PNULL)
+    {
+        OsaFclose(fp);
+    }
+
+    mwPcapResume();
+    return ret;
+}
+
+INT32 mwPcapDumpToUnilog(void)
+{
+    UINT8 chunk[4 + MW_PCAP_UNILOG_CHUNK];
+    MwPcapFileHdr hdr;
+    UINT32 total;
+    UINT32 off;
+    UINT32 n;
+
+    if (mwPcapSnapshot(&hdr) != MW_PCAP_OK)
+    {
+        return MW_PCAP_ERR_STATE;
+    }
+
+    total = sizeof(hdr) + hdr.dataLen;
+    for (off = 0; off < total; off += n)
+    {
+        n = total - off;
+        if (n > MW_PCAP_UNILOG_CHUNK)
+        {
+            n = MW_PCAP_UNILOG_CHUNK;
+        }
+        /* Each chunk starts with its offset in the dump, so lost chunks show up as gaps */
+        memcpy(chunk, &off, 4);
+        mwPcapRead(&hdr, off, &chunk[4], n);
+
+        QCOMM_DUMP(UNILOG_PLA_MIDWARE, mwPcapDump_1, P_INFO, "mwPcapDump", 4 + n, chunk);
+        /* Leave the log task time to drain, the ring is several kB */
+        osDelay(2);
+    }
+
+    mwPcapResume();
+    return MW_PCAP_OK;
+}
+
+void mwPcapGetStats(MwPcapStats *stats)
+{
+    UINT32 mask;
+
+    if (stats == PNULL)
+    {
+        return;
+    }
+
+    mask = SaveAndSetIRQMask();
+    *stats = mwPcap.stats;
+    stats->used = mwPcap.used;
+    RestoreIRQMask(mask);
+}
+
+#endif
@@ -0,0 +1,402 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_pcprof.c
+ * Description:  PC sampling profiler
+ *               The code runs XIP from the QSPI flash through the instruction cache, and
+ *               a cache miss stalls the core on a flash fetch. Code tagged
+ *               PLAT_CODE_IN_RAM or OS_CODE_IN_RAM is copied to RAM at boot instead; this
+ *               module tells which other functions are worth the same, by where the core
+ *               actually spends its time.
+ *
+ *               A TIMER instance interrupts at a fixed rate. Its ISR is not entered from
+ *               the exception vector but from XIC_IntHandler(), the dispatcher of the
+ *               peripheral XIC, which leaves a frame of unknown size on the stack, so
+ *               the interrupted PC cannot be found from the ISR. The vector table is
+ *               therefore copied to RAM with the peripheral XIC entry replaced by
+ *               mwPcProfXicEntry(), which reads the PC from the exception frame, stores
+ *               it, and jumps to XIC_IntHandler() with the registers it got. Every
+ *               peripheral interrupt goes through it, at a cost of a few cycles; the
+ *               ISR takes the PC of its own entry. Both run from RAM, so the profiler
+ *               does not evict the code it measures from the cache.
+ *
+ *               PCs are counted per 2^MW_PCPROF_PC_SHIFT bytes in an open addressed hash
+ *               table, so the RAM taken depends on the code that runs, not on the size
+ *               of the image. While sampling, sleep is voted down to the idle state: the
+ *               boot from sleep1 and deeper restores the vector table of the image, and
+ *               the ticks after it would find no PC (counted as missed).
+ *
+ *               MW_PCPROF_NO_SAMPLER leaves out the timer and the vector hook, and with
+ *               them mwPcProfStart() and mwPcProfStop(): the histogram and its dump then
+ *               build anywhere, which Debug/Scripts/hosttest uses to count the PCs of a
+ *               host process.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#ifdef MW_PCPROF_ENABLE
+
+#include <string.h>
+#include "RTE_Components.h"
+#include CMSIS_device_header
+#include "cmsis_os2.h"
+#include "osasys.h"
+#ifndef MW_PCPROF_NO_SAMPLER
+#include "clock_qcx212.h"
+#include "timer_qcx212.h"
+#include "ic_qcx212.h"
+#include "slpman_qcx212.h"
+#endif
+#include "debug_log.h"
+#include "mw_pcprof.h"
+
+#if (MW_PCPROF_SLOTS & (MW_PCPROF_SLOTS - 1)) != 0 || MW_PCPROF_SLOTS > 65536
+#error "MW_PCPROF_SLOTS must be a power of two, up to 65536"
+#endif
+
+#if !defined(MW_PCPROF_NO_SAMPLER) && MW_PCPROF_TIMER_INSTANCE >= TIMER_INSTANCE_NUM
+#error "MW_PCPROF_TIMER_INSTANCE is not a TIMER instance"
+#endif
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+/* The 25 vectors of the image, padded to the VTOR alignment of 128 bytes */
+#define MW_PCPROF_VECTORS             32
+#define MW_PCPROF_VECTOR_USED         (16 + ModemXIC_IRQn + 1)
+
+#define MW_PCPROF_MAX_RATE_HZ         20000
+
+#define MW_PCPROF_TIMER_CLK           ((clock_ID_t)(GPR_TIMER0FuncClk + MW_PCPROF_TIMER_INSTANCE))
+#define MW_PCPROF_TIMER_IRQ           ((IRQn_Type)(PXIC_Timer0_IRQn + MW_PCPROF_TIMER_INSTANCE))
+
+#define MW_PCPROF_DUMP_SAMPLES        32
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwPcProfContext_Tag
+{
+    MwPcProfSample  slots[MW_PCPROF_SLOTS];     //pc 0 for a free one
+    MwPcProfStats   stats;
+    UINT32          savedVtor;
+    BOOL            running;
+    BOOL            timerInit;
+    BOOL            voteOk;
+    UINT8           voteHandle;
+}MwPcProfContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwPcProfContext mwPcProf;
+
+#ifndef MW_PCPROF_NO_SAMPLER
+static UINT32 mwPcProfVectors[MW_PCPROF_VECTORS] __attribute__((aligned(128)));
+
+static const clock_select_t mwPcProfClkSel[TIMER_INSTANCE_NUM] =
+{
+    GPR_TIMER0ClkSel_26M, GPR_TIMER1ClkSel_26M, GPR_TIMER2ClkSel_26M,
+    GPR_TIMER3ClkSel_26M, GPR_TIMER4ClkSel_26M, GPR_TIMER5ClkSel_26M
+};
+
+/* Shared with mwPcProfXicEntry(), which names them in assembly */
+volatile UINT32 mwPcProfLastPc;
+volatile UINT32 mwPcProfXicHandler;
+#endif
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+/*
+ * Count pc, 0 when the tick found none, in the open addressed table:
+ * MW_PCPROF_PROBES entries from its hash, the first with its granule or
+ * free taken.
+ */
+static void PLAT_CODE_IN_RAM mwPcProfCount(UINT32 pc)
+{
+    UINT32 index;
+    UINT32 i;
+
+    pc &= ~((1UL << MW_PCPROF_PC_SHIFT) - 1);
+    if (pc == 0)
+    {
+        mwPcProf.stats.missed++;
+        return;
+    }
+
+    index = (((pc >> MW_PCPROF_PC_SHIFT) * 2654435761UL) >> 16) & (MW_PCPROF_SLOTS - 1);
+    for (i = 0; i < MW_PCPROF_PROBES; i++)
+    {
+        MwPcProfSample *slot = &mwPcProf.slots[index];
+
+        if (slot->pc == pc)
+        {
+            slot->count++;
+            mwPcProf.stats.samples++;
+            return;
+        }
+        if (slot->pc == 0)
+        {
+            slot->pc = pc;
+            slot->count = 1;
+            mwPcProf.stats.samples++;
+            mwPcProf.stats.slotsUsed++;
+            return;
+        }
+        index = (index + 1) & (MW_PCPROF_SLOTS - 1);
+    }
+    mwPcProf.stats.dropped++;
+}
+
+#ifndef MW_PCPROF_NO_SAMPLER
+/*
+ * Peripheral XIC vector while sampling. r0, r1 and the flags are stacked
+ * by the exception entry, and lr still holds EXC_RETURN for the handler.
+ * The frame is on the process stack if a task was interrupted, on the
+ * main stack otherwise; its PC is the seventh word.
+ */
+__attribute__((naked)) static void PLAT_CODE_IN_RAM mwPcProfXicEntry(void)
+{
+    __asm volatile(
+        "tst    lr, #4                              \n"
+        "ite    eq                                  \n"
+        "mrseq  r0, msp                             \n"
+        "mrsne  r0, psp                             \n"
+        "ldr    r0, [r0, #24]                       \n"
+        "movw   r1, #:lower16:mwPcProfLastPc        \n"
+        "movt   r1, #:upper16:mwPcProfLastPc        \n"
+        "str    r0, [r1]                            \n"
+        "movw   r1, #:lower16:mwPcProfXicHandler    \n"
+        "movt   r1, #:upper16:mwPcProfXicHandler    \n"
+        "ldr    r1, [r1]                            \n"
+        "bx     r1                                  \n"
+    );
+}
+
+static void PLAT_CODE_IN_RAM mwPcProfTimerIsr(void)
+{
+    UINT32 pc = mwPcProfLastPc;
+
+    mwPcProfLastPc = 0;
+    mwPcProfCount(pc);
+}
+
+static void mwPcProfHookVectors(void)
+{
+    const UINT32 *vectors = (const UINT32 *)SCB->VTOR;
+    UINT32 i;
+
+    for (i = 0; i < MW_PCPROF_VECTOR_USED; i++)
+    {
+        mwPcProfVectors[i] = vectors[i];
+    }
+    mwPcProfXicHandler = vectors[16 + PeripheralXIC_IRQn];
+    mwPcProfVectors[16 + PeripheralXIC_IRQn] = (UINT32)mwPcProfXicEntry;
+
+    mwPcProf.savedVtor = SCB->VTOR;
+    __DSB();
+    SCB->VTOR = (UINT32)mwPcProfVectors;
+    __DSB();
+    __ISB();
+}
+
+static void mwPcProfUnhookVectors(void)
+{
+    if (SCB->VTOR == (UINT32)mwPcProfVectors)
+    {
+        SCB->VTOR = mwPcProf.savedVtor;
+        __DSB();
+        __ISB();
+    }
+}
+#endif
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+
+#ifndef MW_PCPROF_NO_SAMPLER
+INT32 mwPcProfStart(UINT32 rateHz)
+{
+    timer_config_t config;
+    UINT32 freq;
+    UINT32 mask;
+
+    if (rateHz == 0)
+    {
+        rateHz = MW_PCPROF_DEFAULT_RATE_HZ;
+    }
+    if (rateHz > MW_PCPROF_MAX_RATE_HZ)
+    {
+        return MW_PCPROF_ERR_PARAM;
+    }
+    if (mwPcProf.running)
+    {
+        return MW_PCPROF_ERR_STATE;
+    }
+
+    if (!mwPcProf.voteOk)
+    {
+        mwPcProf.voteOk = (slpManApplyPlatVoteHandle("PCPROF", &mwPcProf.voteHandle) == RET_TRUE);
+    }
+    if (mwPcProf.voteOk)
+    {
+        slpManPlatVoteDisableSleep(mwPcProf.voteHandle, SLP_SLP1_STATE);
+    }
+
+    CLOCK_SetClockSrc(MW_PCPROF_TIMER_CLK, mwPcProfClkSel[MW_PCPROF_TIMER_INSTANCE]);
+    CLOCK_SetClockDiv(MW_PCPROF_TIMER_CLK, 1);
+    freq = CLOCK_GetClockFreq(MW_PCPROF_TIMER_CLK);
+
+    if (!mwPcProf.timerInit)
+    {
+        TIMER_DriverInit();
+        mwPcProf.timerInit = TRUE;
+    }
+    TIMER_GetDefaultConfig(&config);
+    config.reloadOption = TIMER_ReloadOnMatch0;
+    config.match0 = freq / rateHz;
+    TIMER_Init(MW_PCPROF_TIMER_INSTANCE, &config);
+
+    // Note interrupt flag won't assert in TIMER_InterruptPulse mode
+    TIMER_InterruptConfig(MW_PCPROF_TIMER_INSTANCE, TIMER_Match0Select, TIMER_InterruptPulse);
+    TIMER_InterruptConfig(MW_PCPROF_TIMER_INSTANCE, TIMER_Match1Select, TIMER_InterruptDisabled);
+    TIMER_InterruptConfig(MW_PCPROF_TIMER_INSTANCE, TIMER_Match2Select, TIMER_InterruptDisabled);
+
+    mask = SaveAndSetIRQMask();
+    mwPcProfHookVectors();
+    mwPcProfLastPc = 0;
+    mwPcProf.stats.rateHz = rateHz;
+    mwPcProf.running = TRUE;
+    RestoreIRQMask(mask);
+
+    XIC_SetVector(MW_PCPROF_TIMER_IRQ, mwPcProfTimerIsr);
+    XIC_EnableIRQ(MW_PCPROF_TIMER_IRQ);
+    TIMER_Start(MW_PCPROF_TIMER_INSTANCE);
+
+    return MW_PCPROF_OK;
+}
+
+void mwPcProfStop(void)
+{
+    UINT32 mask;
+
+    if (!mwPcProf.running)
+    {
+        return;
+    }
+
+    TIMER_Stop(MW_PCPROF_TIMER_INSTANCE);
+    XIC_DisableIRQ(MW_PCPROF_TIMER_IRQ);
+
+    mask = SaveAndSetIRQMask();
+    mwPcProfUnhookVectors();
+    mwPcProf.stats.rateHz = 0;
+    mwPcProf.running = FALSE;
+    RestoreIRQMask(mask);
+
+    if (mwPcProf.voteOk)
+    {
+        slpManPlatVoteEnableSleep(mwPcProf.voteHandle, SLP_SLP1_STATE);
+    }
+}
+#endif
+
+void mwPcProfReset(void)
+{
+    UINT32 mask;
+    UINT32 rateHz;
+
+    mask = SaveAndSetIRQMask();
+    rateHz = mwPcProf.stats.rateHz;
+    memset(mwPcProf.slots, 0, sizeof(mwPcProf.slots));
+    memset(&mwPcProf.stats, 0, sizeof(mwPcProf.stats));
+    mwPcProf.stats.rateHz = rateHz;
+    RestoreIRQMask(mask);
+}
+
+void mwPcProfGetStats(MwPcProfStats *stats)
+{
+    UINT32 mask;
+
+    if (stats == PNULL)
+    {
+        return;
+    }
+
+    mask = SaveAndSetIRQMask();
+    *stats = mwPcProf.stats;
+    RestoreIRQMask(mask);
+}
+
+INT32 mwPcProfGetSample(UINT32 index, MwPcProfSample *sample)
+{
+    UINT32 mask;
+    UINT32 i;
+
+    if (sample == PNULL)
+    {
+        return MW_PCPROF_ERR_PARAM;
+    }
+
+    mask = SaveAndSetIRQMask();
+    for (i = 0; i < MW_PCPROF_SLOTS; i++)
+    {
+        if (mwPcProf.slots[i].pc != 0 && index-- == 0)
+        {
+            *sample = mwPcProf.slots[i];
+            RestoreIRQMask(mask);
+            return MW_PCPROF_OK;
+        }
+    }
+    RestoreIRQMask(mask);
+    return MW_PCPROF_END;
+}
+
+void mwPcProfDumpToUnilog(void)
+{
+    MwPcProfStats stats;
+    MwPcProfSample chunk[MW_PCPROF_DUMP_SAMPLES];
+    UINT32 num = 0;
+    UINT32 mask;
+    UINT32 i;
+
+    mwPcProfGetStats(&stats);
+    QCOMM_DUMP(UNILOG_PLA_MIDWARE, mwPcProfDump_1, P_INFO, "mwPcProf",
+               sizeof(stats), (UINT8 *)&stats);
+
+    for (i = 0; i < MW_PCPROF_SLOTS; i++)
+    {
+        mask = SaveAndSetIRQMask();
+        if (mwPcProf.slots[i].pc != 0)
+        {
+            chunk[num++] = mwPcProf.slots[i];
+        }
+        RestoreIRQMask(mask);
+
+        if (num == MW_PCPROF_DUMP_SAMPLES || (i == MW_PCPROF_SLOTS - 1 && num != 0))
+        {
+            /* Leave the log task time to drain */
+            osDelay(1);
+            QCOMM_DUMP(UNILOG_PLA_MIDWARE, mwPcProfDump_2, P_INFO, "mwPcProfSamples",
+                       num * sizeof(MwPcProfSample), (UINT8 *)chunk);
+            num = 0;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,807 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_reactor.c
+ * Description:  Single-task socket reactor shared by the protocol engines
+ *               Each engine used to run its own receive task (MQTT, CoAP, LwM2M RX, HTTP)
+ *               that polled or blocked on one socket, at 4-6.5 KB of stack per task and
+ *               a context switch for every poll even with no traffic. Here one task
+ *               blocks in select() on all registered sockets, with the timeout set to the
+ *               earliest timer in a binary min-heap, and sleeps until there is work.
+ *
+ *               API calls from other tasks update the tables under a short lock and then
+ *               send one byte to a UDP socket bound to the loopback interface, which is
+ *               in the select() set, so that the next timeout is recomputed at once.
+ *
+ *               Callbacks run under a second, recursive lock held for the whole dispatch
+ *               phase. Removing a socket or stopping a timer from another task takes it
+ *               once after the removal, which is what makes it safe to close the socket
+ *               or free the timer as soon as the call returns.
+ *
+ *               Only the MQTT client uses it so far, with MQTT_USE_REACTOR=y.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#include <string.h>
+#include "cmsis_os2.h"
+#include "sockets.h"
+#include "mw_reactor.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+#define MW_REACTOR_TIME_BEFORE(a, b)    ((INT32)((a) - (b)) < 0)
+
+typedef enum MwReactorState_Tag
+{
+    MW_REACTOR_STOPPED = 0,
+    MW_REACTOR_STARTING,        //a task is creating the objects below
+    MW_REACTOR_RUNNING
+}MwReactorState;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwReactorSock_Tag
+{
+    INT32               fd;         //-1: free
+    UINT8               events;
+    MwReactorSockCb     cb;
+    void                *arg;
+}MwReactorSock;
+
+typedef struct MwReactorPost_Tag
+{
+    MwReactorPostCb     cb;
+    void                *arg;
+}MwReactorPost;
+
+typedef struct MwReactorContext_Tag
+{
+    osThreadId_t        task;
+    osMutexId_t         lock;           //tables below
+    osMutexId_t         dispatchLock;   //held while callbacks run
+    INT32               wakeFd;
+    struct sockaddr_in  wakeAddr;
+    volatile UINT8      wakePending;
+    volatile UINT8      state;
+
+    MwReactorSock       socks[MW_REACTOR_MAX_SOCKETS];
+
+    MwReactorTimer      *heap[MW_REACTOR_MAX_TIMERS];
+    UINT16              heapCount;
+
+    MwReactorPost       posts[MW_REACTOR_POST_QUEUE_SIZE];
+    UINT8               postHead;
+    UINT8               postCount;
+
+    MwReactorStats      stats;
+}MwReactorContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwReactorContext mwReactor;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT32 mwReactorNowMs(void)
+{
+    UINT32 ticks = osKernelGetTickCount();
+    UINT32 freq = osKernelGetTickFreq();
+
+    if (freq == 1000)
+    {
+        return ticks;
+    }
+    return (UINT32)(((UINT64)ticks * 1000) / freq);
+}
+
+static void mwReactorLock(void)
+{
+    osMutexAcquire(mwReactor.lock, osWaitForever);
+}
+
+static void mwReactorUnlock(void)
+{
+    osMutexRelease(mwReactor.lock);
+}
+
+/* Wait for the callbacks of the current dispatch phase to finish */
+static void mwReactorDispatchBarrier(void)
+{
+    if (!mwReactorInContext())
+    {
+        osMutexAcquire(mwReactor.dispatchLock, osWaitForever);
+        osMutexRelease(mwReactor.dispatchLock);
+    }
+}
+
+static void mwReactorWake(void)
+{
+    UINT8 b = 0;
+
+    if (mwReactorInContext() || mwReactor.wakePending)
+    {
+        return;
+    }
+    mwReactor.wakePending = TRUE;
+    if (lwip_sendto(mwReactor.wakeFd, &b, 1, MSG_DONTWAIT,
+                    (struct sockaddr *)&mwReactor.wakeAddr, sizeof(mwReactor.wakeAddr)) < 0)
+    {
+        //nothing queued, the reactor would never drain the flag
+        mwReactor.wakePending = FALSE;
+    }
+}
+
+static void mwReactorDrainWake(void)
+{
+    UINT8 buf[8];
+
+    mwReactor.wakePending = FALSE;
+    while (lwip_recv(mwReactor.wakeFd, buf, sizeof(buf), MSG_DONTWAIT) > 0)
+    {
+        ;
+    }
+}
+
+static MwReactorSock *mwReactorFindSock(INT32 fd)
+{
+    UINT32 i;
+
+    for (i = 0; i < MW_REACTOR_MAX_SOCKETS; i++)
+    {
+        if (mwReactor.socks[i].fd == fd)
+        {
+            return &mwReactor.socks[i];
+        }
+    }
+    return PNULL;
+}
+
+/*
+ * Binary min-heap on expires, each timer keeps its own index so that
+ * stopping an armed timer is O(log n) as well.
+ */
+static void mwReactorHeapSet(UINT16 idx, MwReactorTimer *timer)
+{
+    mwReactor.heap[idx] = timer;
+    timer->heapPos = idx + 1;
+}
+
+static void mwReactorHeapUp(UINT16 idx)
+{
+    MwReactorTimer *timer = mwReactor.heap[idx];
+
+    while (idx > 0)
+    {
+        UINT16 parent = (idx - 1) / 2;
+
+        if (!MW_REACTOR_TIME_BEFORE(timer->expires, mwReactor.heap[parent]->expires))
+        {
+            break;
+        }
+        mwReactorHeapSet(idx, mwReactor.heap[parent]);
+        idx = parent;
+    }
+    mwReactorHeapSet(idx, timer);
+}
+
+static void mwReactorHeapDown(UINT16 idx)
+{
+    MwReactorTimer *timer = mwReactor.heap[idx];
+
+    for (;;)
+    {
+        UINT16 child = 2 * idx + 1;
+
+        if (child >= mwReactor.heapCount)
+        {
+            break;
+        }
+        if (child + 1 < mwReactor.heapCount &&
+            MW_REACTOR_TIME_BEFORE(mwReactor.heap[child + 1]->expires, mwReactor.heap[child]->expires))
+        {
+            child++;
+        }
+        if (!MW_REACTOR_TIME_BEFORE(mwReactor.heap[child]->expires, timer->expires))
+        {
+            break;
+        }
+        mwReactorHeapSet(idx, mwReactor.heap[child]);
+        idx = child;
+    }
+    mwReactorHeapSet(idx, timer);
+}
+
+static BOOL mwReactorHeapPush(MwReactorTimer *timer)
+{
+    if (mwReactor.heapCount >= MW_REACTOR_MAX_TIMERS)
+    {
+        return FALSE;
+    }
+    mwReactorHeapSet(mwReactor.heapCount, timer);
+    mwReactorHeapUp(mwReactor.heapCount++);
+    return TRUE;
+}
+
+static void mwReactorHeapRemove(MwReactorTimer *timer)
+{
+    UINT16 idx = timer->heapPos - 1;
+    MwReactorTimer *last;
+
+    timer->heapPos = 0;
+    last = mwReactor.heap[--mwReactor.heapCount];
+    if (last == timer)
+    {
+        return;
+    }
+    mwReactorHeapSet(idx, last);
+    if (idx > 0 && MW_REACTOR_TIME_BEFORE(last->expires, mwReactor.heap[(idx - 1) / 2]->expires))
+    {
+        mwReactorHeapUp(idx);
+    }
+    else
+    {
+        mwReactorHeapDown(idx);
+    }
+}
+
+/* Called with the lock held. Returns -1 to wait forever. */
+static INT32 mwReactorNextTimeout(UINT32 now)
+{
+    UINT32 expires;
+
+    if (mwReactor.postCount > 0)
+    {
+        return 0;
+    }
+    if (mwReactor.heapCount == 0)
+    {
+        return -1;
+    }
+    expires = mwReactor.heap[0]->expires;
+    if (!MW_REACTOR_TIME_BEFORE(now, expires))
+    {
+        return 0;
+    }
+    return (INT32)(expires - now);
+}
+
+/*
+ * select() fails for the whole set once one of its sockets has been closed
+ * without mwReactorDelSocket(). Free the slots of the sockets lwIP no longer
+ * knows, so that the loop goes on and the fd can be registered again.
+ */
+static UINT32 mwReactorDropClosed(void)
+{
+    UINT32 dropped = 0;
+    UINT32 i;
+
+    mwReactorLock();
+    for (i = 0; i < MW_REACTOR_MAX_SOCKETS; i++)
+    {
+        if (mwReactor.socks[i].fd >= 0 && lwip_fcntl(mwReactor.socks[i].fd, F_GETFL, 0) < 0)
+        {
+            mwReactor.socks[i].fd = -1;
+            mwReactor.stats.sockDropped++;
+            dropped++;
+        }
+    }
+    mwReactorUnlock();
+
+    return dropped;
+}
+
+static void mwReactorRunPosts(void)
+{
+    MwReactorPost post;
+    UINT32 n = MW_REACTOR_POST_QUEUE_SIZE;
+
+    /* Bounded, a callback that posts again runs on the next loop */
+    while (n-- > 0)
+    {
+        mwReactorLock();
+        if (mwReactor.postCount == 0)
+        {
+            mwReactorUnlock();
+            break;
+        }
+        post = mwReactor.posts[mwReactor.postHead];
+        mwReactor.postHead = (mwReactor.postHead + 1) % MW_REACTOR_POST_QUEUE_SIZE;
+        mwReactor.postCount--;
+        mwReactor.stats.posts++;
+        mwReactorUnlock();
+
+        post.cb(post.arg);
+    }
+}
+
+static void mwReactorRunSockets(fd_set *rd, fd_set *wr, fd_set *ex)
+{
+    MwReactorSock sock;
+    UINT8 events;
+    UINT32 i;
+
+    for (i = 0; i < MW_REACTOR_MAX_SOCKETS; i++)
+    {
+        mwReactorLock();
+        sock = mwReactor.socks[i];
+        mwReactorUnlock();
+
+        if (sock.fd < 0)
+        {
+            continue;
+        }
+
+        events = 0;
+        if ((sock.events & MW_REACTOR_EV_READ) && FD_ISSET(sock.fd, rd))
+        {
+            events |= MW_REACTOR_EV_READ;
+        }
+        if ((sock.events & MW_REACTOR_EV_WRITE) && FD_ISSET(sock.fd, wr))
+        {
+            events |= MW_REACTOR_EV_WRITE;
+        }
+        if (FD_ISSET(sock.fd, ex))
+        {
+            events |= MW_REACTOR_EV_ERROR;
+        }
+
+        if (events != 0)
+        {
+            mwReactor.stats.sockEvents++;
+            sock.cb(sock.fd, events, sock.arg);
+        }
+    }
+}
+
+static void mwReactorRunTimers(void)
+{
+    MwReactorTimer *timer;
+    MwReactorTimerCb cb;
+    void *arg;
+    UINT32 now;
+    UINT32 n = MW_REACTOR_MAX_TIMERS;
+
+    while (n-- > 0)
+    {
+        mwReactorLock();
+        now = mwReactorNowMs();
+        if (mwReactor.heapCount == 0 || MW_REACTOR_TIME_BEFORE(now, mwReactor.heap[0]->expires))
+        {
+            mwReactorUnlock();
+            break;
+        }
+
+        timer = mwReactor.heap[0];
+        mwReactorHeapRemove(timer);
+        if (timer->period != 0)
+        {
+            /* Keep the phase, but do not try to catch up on missed periods */
+            timer->expires += timer->period;
+            if (MW_REACTOR_TIME_BEFORE(timer->expires, now))
+            {
+                timer->expires = now + timer->period;
+            }
+            mwReactorHeapPush(timer);
+        }
+        cb = timer->cb;
+        arg = timer->arg;
+        mwReactor.stats.timersFired++;
+        mwReactorUnlock();
+
+        cb(timer, arg);
+    }
+}
+
+static void mwReactorTask(void *argument)
+{
+    fd_set rd, wr, ex;
+    struct timeval tv;
+    INT32 maxFd;
+    INT32 timeout;
+    INT32 n;
+    UINT32 start, elapsed;
+    UINT32 i;
+
+    (void)argument;
+
+    for (;;)
+    {
+        FD_ZERO(&rd);
+        FD_ZERO(&wr);
+        FD_ZERO(&ex);
+        FD_SET(mwReactor.wakeFd, &rd);
+        maxFd = mwReactor.wakeFd;
+
+        mwReactorLock();
+        for (i = 0; i < MW_REACTOR_MAX_SOCKETS; i++)
+        {
+            MwReactorSock *sock = &mwReactor.socks[i];
+
+            if (sock->fd < 0)
+            {
+                continue;
+            }
+            if (sock->events & MW_REACTOR_EV_READ)
+            {
+                FD_SET(sock->fd, &rd);
+            }
+            if (sock->events & MW_REACTOR_EV_WRITE)
+            {
+                FD_SET(sock->fd, &wr);
+            }
+            FD_SET(sock->fd, &ex);
+            if (sock->fd > maxFd)
+            {
+                maxFd = sock->fd;
+            }
+        }
+        timeout = mwReactorNextTimeout(mwReactorNowMs());
+        mwReactor.stats.loops++;
+        mwReactorUnlock();
+
+        if (timeout >= 0)
+        {
+            tv.tv_sec = timeout / 1000;
+            tv.tv_usec = (timeout % 1000) * 1000;
+        }
+        n = lwip_select(maxFd + 1, &rd, &wr, &ex, timeout >= 0 ? &tv : NULL);
+        if (n < 0)
+        {
+            /* Nothing closed behind our back: do not spin on whatever it is */
+            if (mwReactorDropClosed() == 0)
+            {
+                osDelay(10);
+            }
+            continue;
+        }
+
+        if (n > 0 && FD_ISSET(mwReactor.wakeFd, &rd))
+        {
+            mwReactor.stats.wakeups++;
+            mwReactorDrainWake();
+        }
+
+        osMutexAcquire(mwReactor.dispatchLock, osWaitForever);
+        start = mwReactorNowMs();
+
+        mwReactorRunPosts();
+        if (n > 0)
+        {
+            mwReactorRunSockets(&rd, &wr, &ex);
+        }
+        mwReactorRunTimers();
+
+        elapsed = mwReactorNowMs() - start;
+        if (elapsed > mwReactor.stats.maxDispatchMs)
+        {
+            mwReactor.stats.maxDispatchMs = elapsed;
+        }
+        osMutexRelease(mwReactor.dispatchLock);
+    }
+}
+
+static INT32 mwReactorOpenWake(void)
+{
+    socklen_t len = sizeof(mwReactor.wakeAddr);
+    INT32 fd;
+
+    fd = lwip_socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        return MW_REACTOR_ERR_SYS;
+    }
+
+    memset(&mwReactor.wakeAddr, 0, sizeof(mwReactor.wakeAddr));
+    mwReactor.wakeAddr.sin_family = AF_INET;
+    mwReactor.wakeAddr.sin_addr.s_addr = PP_HTONL(INADDR_LOOPBACK);
+    mwReactor.wakeAddr.sin_port = 0;
+
+    if (lwip_bind(fd, (struct sockaddr *)&mwReactor.wakeAddr, sizeof(mwReactor.wakeAddr)) != 0 ||
+        lwip_getsockname(fd, (struct sockaddr *)&mwReactor.wakeAddr, &len) != 0)
+    {
+        lwip_close(fd);
+        return MW_REACTOR_ERR_SYS;
+    }
+
+    mwReactor.wakeFd = fd;
+    return MW_REACTOR_OK;
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+INT32 mwReactorStart(void)
+{
+    const osMutexAttr_t lockAttr = { "mwReactor", osMutexPrioInherit, NULL, 0 };
+    const osMutexAttr_t dispatchAttr = { "mwReactorCb", osMutexRecursive | osMutexPrioInherit, NULL, 0 };
+    osThreadAttr_t taskAttr;
+    int32_t kernelLock;
+    UINT8 state;
+    UINT32 i;
+
+    /* Only one task creates the reactor, the others wait for its outcome */
+    for (;;)
+    {
+        kernelLock = osKernelLock();
+        state = mwReactor.state;
+        if (state == MW_REACTOR_STOPPED)
+        {
+            mwReactor.state = MW_REACTOR_STARTING;
+        }
+        osKernelRestoreLock(kernelLock);
+
+        if (state != MW_REACTOR_STARTING)
+        {
+            break;
+        }
+        osDelay(1);
+    }
+    if (state == MW_REACTOR_RUNNING)
+    {
+        return MW_REACTOR_OK;
+    }
+
+    for (i = 0; i < MW_REACTOR_MAX_SOCKETS; i++)
+    {
+        mwReactor.socks[i].fd = -1;
+    }
+
+    mwReactor.lock = osMutexNew(&lockAttr);
+    mwReactor.dispatchLock = osMutexNew(&dispatchAttr);
+    if (mwReactor.lock == PNULL || mwReactor.dispatchLock == PNULL ||
+        mwReactorOpenWake() != MW_REACTOR_OK)
+    {
+        goto fail;
+    }
+
+    memset(&taskAttr, 0, sizeof(taskAttr));
+    taskAttr.name = "mwReactor";
+    taskAttr.stack_size = MW_REACTOR_TASK_STACK_SIZE;
+    taskAttr.priority = osPriorityBelowNormal7;
+
+    mwReactor.task = osThreadNew(mwReactorTask, PNULL, &taskAttr);
+    if (mwReactor.task == PNULL)
+    {
+        lwip_close(mwReactor.wakeFd);
+        goto fail;
+    }
+    mwReactor.state = MW_REACTOR_RUNNING;
+    return MW_REACTOR_OK;
+
+fail:
+    if (mwReactor.lock != PNULL)
+    {
+        osMutexDelete(mwReactor.lock);
+        mwReactor.lock = PNULL;
+    }
+    if (mwReactor.dispatchLock != PNULL)
+    {
+        osMutexDelete(mwReactor.dispatchLock);
+        mwReactor.dispatchLock = PNULL;
+    }
+    mwReactor.state = MW_REACTOR_STOPPED;
+    return MW_REACTOR_ERR_SYS;
+}
+
+BOOL mwReactorInContext(void)
+{
+    return mwReactor.task != PNULL && osThreadGetId() == mwReactor.task;
+}
+
+INT32 mwReactorAddSocket(INT32 fd, UINT8 events, MwReactorSockCb cb, void *arg)
+{
+    MwReactorSock *sock;
+
+    if (fd < 0 || cb == PNULL)
+    {
+        return MW_REACTOR_ERR_PARAM;
+    }
+    if (mwReactor.task == PNULL)
+    {
+        return MW_REACTOR_ERR_STATE;
+    }
+
+    mwReactorLock();
+    if (mwReactorFindSock(fd) != PNULL)
+    {
+        mwReactorUnlock();
+        return MW_REACTOR_ERR_STATE;
+    }
+    sock = mwReactorFindSock(-1);
+    if (sock == PNULL)
+    {
+        mwReactorUnlock();
+        return MW_REACTOR_ERR_FULL;
+    }
+    sock->events = events;
+    sock->cb = cb;
+    sock->arg = arg;
+    sock->fd = fd;
+    mwReactorUnlock();
+
+    mwReactorWake();
+    return MW_REACTOR_OK;
+}
+
+INT32 mwReactorModSocket(INT32 fd, UINT8 events)
+{
+    MwReactorSock *sock;
+
+    if (fd < 0 || mwReactor.task == PNULL)
+    {
+        return MW_REACTOR_ERR_PARAM;
+    }
+
+    mwReactorLock();
+    sock = mwReactorFindSock(fd);
+    if (sock == PNULL)
+    {
+        mwReactorUnlock();
+        return MW_REACTOR_ERR_NOT_FOUND;
+    }
+    sock->events = events;
+    mwReactorUnlock();
+
+    mwReactorWake();
+    return MW_REACTOR_OK;
+}
+
+INT32 mwReactorDelSocket(INT32 fd)
+{
+    MwReactorSock *sock;
+
+    if (fd < 0 || mwReactor.task == PNULL)
+    {
+        return MW_REACTOR_ERR_PARAM;
+    }
+
+    mwReactorLock();
+    sock = mwReactorFindSock(fd);
+    if (sock == PNULL)
+    {
+        mwReactorUnlock();
+        return MW_REACTOR_ERR_NOT_FOUND;
+    }
+    sock->fd = -1;
+    mwReactorUnlock();
+
+    /* select() must stop watching fd before the owner closes it */
+    mwReactorWake();
+    mwReactorDispatchBarrier();
+    return MW_REACTOR_OK;
+}
+
+void mwReactorTimerInit(MwReactorTimer *timer, MwReactorTimerCb cb, void *arg)
+{
+    memset(timer, 0, sizeof(MwReactorTimer));
+    timer->cb = cb;
+    timer->arg = arg;
+}
+
+/*
+ * Arm, or re-arm, timer to fire delayMs from now and then every periodMs
+ * if that is not 0.
+ */
+INT32 mwReactorTimerStart(MwReactorTimer *timer, UINT32 delayMs, UINT32 periodMs)
+{
+    BOOL first;
+
+    if (timer == PNULL || timer->cb == PNULL || delayMs > 0x7FFFFFFF)
+    {
+        return MW_REACTOR_ERR_PARAM;
+    }
+    if (mwReactor.task == PNULL)
+    {
+        return MW_REACTOR_ERR_STATE;
+    }
+
+    mwReactorLock();
+    if (timer->heapPos != 0)
+    {
+        mwReactorHeapRemove(timer);
+    }
+    timer->expires = mwReactorNowMs() + delayMs;
+    timer->period = periodMs;
+    if (!mwReactorHeapPush(timer))
+    {
+        mwReactorUnlock();
+        return MW_REACTOR_ERR_FULL;
+    }
+    first = (timer->heapPos == 1);
+    mwReactorUnlock();
+
+    /* Only a new earliest timer changes the select() timeout */
+    if (first)
+    {
+        mwReactorWake();
+    }
+    return MW_REACTOR_OK;
+}
+
+void mwReactorTimerStop(MwReactorTimer *timer)
+{
+    if (timer == PNULL || mwReactor.task == PNULL)
+    {
+        return;
+    }
+
+    mwReactorLock();
+    if (timer->heapPos != 0)
+    {
+        mwReactorHeapRemove(timer);
+    }
+    mwReactorUnlock();
+
+    mwReactorDispatchBarrier();
+}
+
+BOOL mwReactorTimerIsArmed(const MwReactorTimer *timer)
+{
+    return timer != PNULL && timer->heapPos != 0;
+}
+
+INT32 mwReactorPost(MwReactorPostCb cb, void *arg)
+{
+    UINT8 tail;
+
+    if (cb == PNULL)
+    {
+        return MW_REACTOR_ERR_PARAM;
+    }
+    if (mwReactor.task == PNULL)
+    {
+        return MW_REACTOR_ERR_STATE;
+    }
+
+    mwReactorLock();
+    if (mwReactor.postCount >= MW_REACTOR_POST_QUEUE_SIZE)
+    {
+        mwReactor.stats.postDropped++;
+        mwReactorUnlock();
+        return MW_REACTOR_ERR_FULL;
+    }
+    tail = (mwReactor.postHead + mwReactor.postCount) % MW_REACTOR_POST_QUEUE_SIZE;
+    mwReactor.posts[tail].cb = cb;
+    mwReactor.posts[tail].arg = arg;
+    mwReactor.postCount++;
+    mwReactorUnlock();
+
+    mwReactorWake();
+    return MW_REACTOR_OK;
+}
+
+void mwReactorGetStats(MwReactorStats *stats)
+{
+    if (stats == PNULL)
+    {
+        return;
+    }
+    if (mwReactor.lock == PNULL)
+    {
+        memset(stats, 0, sizeof(MwReactorStats));
+        return;
+    }
+
+    mwReactorLock();
+    *stats = mwReactor.stats;
+    mwReactorUnlock();
+}
@@ -0,0 +1,690 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_tslog.c
+ * Description:  Append-only telemetry log on a raw flash slice
+ *               A sample written with LFS_FileWrite() and LFS_FileSync() costs a
+ *               rewrite of the file's last block and a commit to its metadata pair, so
+ *               a few bytes of telemetry every minute wear the file system sectors far
+ *               faster than the data itself would.
+ *
+ *               Here the region is a ring of 4KB sectors written strictly in order. A
+ *               sector starts with a header carrying its sequence number and the number
+ *               of its first record; records follow back to back, 4-byte aligned, each
+ *               framed by its length and a CRC16. Appends go to a one-page RAM buffer
+ *               that is programmed when full, so flash sees one program per page and
+ *               one erase per sector, the minimum for the data written. mwTsLogFlush()
+ *               programs a partial page and fills its tail with zeros, which readers
+ *               skip.
+ *
+ *               Every page is programmed once, in full. On start-up the newest sector is
+ *               the valid header with the highest sequence number, the ring runs back
+ *               from it as long as the sequence numbers follow, and appends resume on
+ *               the first erased page after the last programmed one. A page torn by a
+ *               reset fails its CRC and is skipped by readers; the records behind it,
+ *               which were never acknowledged, are lost.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#include <string.h>
+#include "cmsis_os2.h"
+#include "osasys.h"
+#include "flash_qcx212_rt.h"
+#include "mw_chksum.h"
+#include "mw_tslog.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+/* The region is written raw, nothing else may own it */
+#if (MW_TSLOG_REGION_OFFSET < FLASH_FS_REGION_END) && \
+    (MW_TSLOG_REGION_OFFSET + MW_TSLOG_REGION_SIZE > FLASH_FS_REGION_OFFSET)
+#error "MW_TSLOG_REGION overlaps the littlefs region"
+#endif
+#if (MW_TSLOG_REGION_OFFSET < FLASH_FOTA_REGION_END) && \
+    (MW_TSLOG_REGION_OFFSET + MW_TSLOG_REGION_SIZE > FLASH_FOTA_REGION_START)
+#error "MW_TSLOG_REGION overlaps the FOTA region"
+#endif
+
+#define MW_TSLOG_SECTOR_MAGIC         0x474C534D      //"MSLG"
+#define MW_TSLOG_SECTORS              (MW_TSLOG_REGION_SIZE / MW_TSLOG_SECTOR_SIZE)
+
+#define MW_TSLOG_LEN_ERASED           0xFFFF
+#define MW_TSLOG_LEN_PAD              0x0000
+
+#define MW_TSLOG_ALIGN(n)             (((n) + 3) & ~3UL)
+#define MW_TSLOG_PAGE_OF(off)         ((off) & ~(UINT32)(MW_TSLOG_PAGE_SIZE - 1))
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwTsLogSectorHdr_Tag
+{
+    UINT32      magic;
+    UINT32      sectorSeq;
+    UINT32      firstRecSeq;
+    UINT16      reserved;
+    UINT16      crc;                        //over the fields above
+}MwTsLogSectorHdr;
+
+typedef struct MwTsLogRecHdr_Tag
+{
+    UINT16      len;                        //payload bytes
+    UINT16      crc;                        //over seq, timeSecs and the payload
+    UINT32      seq;
+    UINT32      timeSecs;
+}MwTsLogRecHdr;
+
+#define MW_TSLOG_DATA_START           sizeof(MwTsLogSectorHdr)
+
+typedef struct MwTsLogContext_Tag
+{
+    osMutexId_t         lock;
+    UINT8               started;
+    UINT8               reserved;
+    UINT16              live;                       //sectors holding records, 0: empty
+    UINT32              headIdx;                    //sector appended to
+    UINT32              headSeq;
+    UINT32              nextRecSeq;
+    UINT32              pageOff;                    //offset in the head sector of page[]
+    UINT32              pageFill;
+    UINT32              firstRec[MW_TSLOG_SECTORS]; //firstRecSeq of the live sectors
+    UINT8               page[MW_TSLOG_PAGE_SIZE];
+    MwTsLogStats        stats;
+}MwTsLogContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwTsLogContext mwTsLog;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT16 mwTsLogRecCrc(const MwTsLogRecHdr *hdr, const void *data)
+{
+    UINT16 crc;
+
+    crc = mwCrc16Ccitt(0xFFFF, (const UINT8 *)&hdr->seq, sizeof(hdr->seq) + sizeof(hdr->timeSecs));
+    return mwCrc16Ccitt(crc, (const UINT8 *)data, hdr->len);
+}
+
+static UINT32 mwTsLogAddr(UINT32 idx, UINT32 off)
+{
+    return MW_TSLOG_REGION_OFFSET + idx * MW_TSLOG_SECTOR_SIZE + off;
+}
+
+/* Ring index of a live sector */
+static UINT32 mwTsLogIdxOf(UINT32 sectorSeq)
+{
+    return (mwTsLog.headIdx + MW_TSLOG_SECTORS - (mwTsLog.headSeq - sectorSeq)) % MW_TSLOG_SECTORS;
+}
+
+static UINT32 mwTsLogTailSeq(void)
+{
+    return mwTsLog.headSeq - (mwTsLog.live - 1);
+}
+
+static INT32 mwTsLogFlashRead(UINT32 addr, void *buf, UINT32 len)
+{
+    if (BSP_QSPI_Read_Safe((UINT8 *)buf, addr, len) != QSPI_OK)
+    {
+        mwTsLog.stats.flashErrors++;
+        return MW_TSLOG_ERR_FLASH;
+    }
+    return MW_TSLOG_OK;
+}
+
+/* Read from the log, with the page still in RAM laid over the flash */
+static INT32 mwTsLogReadAt(UINT32 sectorSeq, UINT32 off, void *buf, UINT32 len)
+{
+    UINT32 from, to;
+
+    if (mwTsLogFlashRead(mwTsLogAddr(mwTsLogIdxOf(sectorSeq), off), buf, len) != MW_TSLOG_OK)
+    {
+        return MW_TSLOG_ERR_FLASH;
+    }
+
+    if (sectorSeq == mwTsLog.headSeq && mwTsLog.pageFill > 0)
+    {
+        from = (off > mwTsLog.pageOff) ? off : mwTsLog.pageOff;
+        to = (off + len < mwTsLog.pageOff + mwTsLog.pageFill) ? off + len : mwTsLog.pageOff + mwTsLog.pageFill;
+        if (from < to)
+        {
+            memcpy((UINT8 *)buf + (from - off), &mwTsLog.page[from - mwTsLog.pageOff], to - from);
+        }
+    }
+    return MW_TSLOG_OK;
+}
+
+/* Program page[] in full, zeros after pageFill, and move on to the next page */
+static INT32 mwTsLogProgramPage(void)
+{
+    INT32 ret = MW_TSLOG_OK;
+
+    if (mwTsLog.pageFill == 0)
+    {
+        return MW_TSLOG_OK;
+    }
+
+    mwTsLog.stats.padBytes += MW_TSLOG_PAGE_SIZE - mwTsLog.pageFill;
+    memset(&mwTsLog.page[mwTsLog.pageFill], 0, MW_TSLOG_PAGE_SIZE - mwTsLog.pageFill);
+
+    if (BSP_QSPI_Write_Safe(mwTsLog.page, mwTsLogAddr(mwTsLog.headIdx, mwTsLog.pageOff), MW_TSLOG_PAGE_SIZE) != QSPI_OK)
+    {
+        mwTsLog.stats.flashErrors++;
+        ret = MW_TSLOG_ERR_FLASH;
+    }
+    mwTsLog.stats.pagePrograms++;
+
+    /* A failed page is given up like a torn one; readers skip it by its CRC */
+    mwTsLog.pageOff += MW_TSLOG_PAGE_SIZE;
+    mwTsLog.pageFill = 0;
+    return ret;
+}
+
+/* Erase the sector after the head, dropping the oldest one when the ring is full */
+static INT32 mwTsLogStartSector(void)
+{
+    MwTsLogSectorHdr hdr;
+    UINT32 idx;
+
+    idx = (mwTsLog.live == 0) ? 0 : (mwTsLog.headIdx + 1) % MW_TSLOG_SECTORS;
+
+    if (mwTsLog.live == MW_TSLOG_SECTORS)
+    {
+        mwTsLog.stats.lost += mwTsLog.firstRec[(idx + 1) % MW_TSLOG_SECTORS] - mwTsLog.firstRec[idx];
+        mwTsLog.live--;
+    }
+
+    mwTsLog.stats.sectorErases++;
+    if (BSP_QSPI_Erase_Safe(mwTsLogAddr(idx, 0), MW_TSLOG_SECTOR_SIZE) != QSPI_OK)
+    {
+        mwTsLog.stats.flashErrors++;
+        return MW_TSLOG_ERR_FLASH;
+    }
+
+    hdr.magic = MW_TSLOG_SECTOR_MAGIC;
+    hdr.sectorSeq = (mwTsLog.live == 0) ? mwTsLog.headSeq : mwTsLog.headSeq + 1;
+    hdr.firstRecSeq = mwTsLog.nextRecSeq;
+    hdr.reserved = 0xFFFF;
+    hdr.crc = mwCrc16Ccitt(0xFFFF, (const UINT8 *)&hdr, sizeof(hdr) - sizeof(hdr.crc));
+
+    mwTsLog.headIdx = idx;
+    mwTsLog.headSeq = hdr.sectorSeq;
+    mwTsLog.live++;
+    mwTsLog.firstRec[idx] = hdr.firstRecSeq;
+
+    /* The header goes out with the first page, so an erased sector is never mistaken for a live one */
+    memcpy(mwTsLog.page, &hdr, sizeof(hdr));
+    mwTsLog.pageOff = 0;
+    mwTsLog.pageFill = sizeof(hdr);
+    return MW_TSLOG_OK;
+}
+
+static void mwTsLogPut(const void *data, UINT32 len)
+{
+    const UINT8 *p = (const UINT8 *)data;
+    UINT32 n;
+
+    while (len > 0)
+    {
+        n = MW_TSLOG_PAGE_SIZE - mwTsLog.pageFill;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(&mwTsLog.page[mwTsLog.pageFill], p, n);
+        mwTsLog.pageFill += n;
+        p += n;
+        len -= n;
+
+        if (mwTsLog.pageFill == MW_TSLOG_PAGE_SIZE)
+        {
+            mwTsLogProgramPage();
+        }
+    }
+}
+
+static BOOL mwTsLogRecIntact(const MwTsLogCursor *cur, const MwTsLogRecHdr *hdr)
+{
+    UINT8 buf[64];
+    UINT32 done, n;
+    UINT16 crc;
+
+    crc = mwCrc16Ccitt(0xFFFF, (const UINT8 *)&hdr->seq, sizeof(hdr->seq) + sizeof(hdr->timeSecs));
+    for (done = 0; done < hdr->len; done += n)
+    {
+        n = (hdr->len - done < sizeof(buf)) ? hdr->len - done : sizeof(buf);
+        if (mwTsLogReadAt(cur->sectorSeq, cur->offset + sizeof(*hdr) + done, buf, n) != MW_TSLOG_OK)
+        {
+            return FALSE;
+        }
+        crc = mwCrc16Ccitt(crc, buf, n);
+    }
+    return crc == hdr->crc;
+}
+
+static BOOL mwTsLogReadSectorHdr(UINT32 idx, MwTsLogSectorHdr *hdr)
+{
+    if (mwTsLogFlashRead(mwTsLogAddr(idx, 0), hdr, sizeof(*hdr)) != MW_TSLOG_OK)
+    {
+        return FALSE;
+    }
+    return hdr->magic == MW_TSLOG_SECTOR_MAGIC &&
+           hdr->crc == mwCrc16Ccitt(0xFFFF, (const UINT8 *)hdr, sizeof(*hdr) - sizeof(hdr->crc));
+}
+
+static BOOL mwTsLogPageErased(UINT32 idx, UINT32 off)
+{
+    UINT32 buf[32];
+    UINT32 i, j;
+
+    for (i = 0; i < MW_TSLOG_PAGE_SIZE; i += sizeof(buf))
+    {
+        if (mwTsLogFlashRead(mwTsLogAddr(idx, off + i), buf, sizeof(buf)) != MW_TSLOG_OK)
+        {
+            return FALSE;
+        }
+        for (j = 0; j < sizeof(buf) / sizeof(buf[0]); j++)
+        {
+            if (buf[j] != 0xFFFFFFFF)
+            {
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * Step cur to the next record header that is plausible, without checking
+ * the payload. Returns MW_TSLOG_END at the end of the log.
+ */
+static INT32 mwTsLogNextHdr(MwTsLogCursor *cur, MwTsLogRecHdr *hdr)
+{
+    while (1)
+    {
+        if (mwTsLog.live == 0)
+        {
+            return MW_TSLOG_END;
+        }
+
+        /* Behind the ring, or left over from before a format */
+        if ((INT32)(cur->sectorSeq - mwTsLogTailSeq()) < 0 || (INT32)(cur->sectorSeq - mwTsLog.headSeq) > 0)
+        {
+            cur->sectorSeq = mwTsLogTailSeq();
+            cur->offset = MW_TSLOG_DATA_START;
+        }
+        if (cur->offset < MW_TSLOG_DATA_START)
+        {
+            cur->offset = MW_TSLOG_DATA_START;
+        }
+
+        if (cur->offset + sizeof(*hdr) > MW_TSLOG_SECTOR_SIZE)
+        {
+            if (cur->sectorSeq == mwTsLog.headSeq)
+            {
+                return MW_TSLOG_END;
+            }
+            cur->sectorSeq++;
+            cur->offset = MW_TSLOG_DATA_START;
+            continue;
+        }
+
+        if (mwTsLogReadAt(cur->sectorSeq, cur->offset, hdr, sizeof(*hdr)) != MW_TSLOG_OK)
+        {
+            return MW_TSLOG_ERR_FLASH;
+        }
+
+        /*
+         * Erased: the end of the log in the head sector. Elsewhere the rest
+         * of a sector a record did not fit in, or a page a reset left blank.
+         */
+        if (hdr->len == MW_TSLOG_LEN_ERASED)
+        {
+            if (cur->sectorSeq == mwTsLog.headSeq && cur->offset >= mwTsLog.pageOff)
+            {
+                return MW_TSLOG_END;
+            }
+            cur->offset = MW_TSLOG_PAGE_OF(cur->offset) + MW_TSLOG_PAGE_SIZE;
+            continue;
+        }
+
+        if (hdr->len == MW_TSLOG_LEN_PAD)
+        {
+            cur->offset = MW_TSLOG_PAGE_OF(cur->offset) + MW_TSLOG_PAGE_SIZE;
+            continue;
+        }
+
+        if (hdr->len > MW_TSLOG_MAX_PAYLOAD || cur->offset + sizeof(*hdr) + hdr->len > MW_TSLOG_SECTOR_SIZE)
+        {
+            /* Torn page: appends went on at a page boundary after it */
+            mwTsLog.stats.crcErrors++;
+            cur->offset = MW_TSLOG_PAGE_OF(cur->offset) + MW_TSLOG_PAGE_SIZE;
+            continue;
+        }
+        return MW_TSLOG_OK;
+    }
+}
+
+/*
+ * Find the end of the head sector after a reset: the record numbering
+ * goes on after the last intact record, appends on the first page past
+ * the last one that was programmed.
+ */
+static void mwTsLogRecoverHead(void)
+{
+    MwTsLogCursor cur;
+    MwTsLogRecHdr hdr;
+    UINT32 off;
+
+    mwTsLog.nextRecSeq = mwTsLog.firstRec[mwTsLog.headIdx];
+    mwTsLog.pageFill = 0;
+
+    for (off = MW_TSLOG_SECTOR_SIZE; off > 0; off -= MW_TSLOG_PAGE_SIZE)
+    {
+        if (!mwTsLogPageErased(mwTsLog.headIdx, off - MW_TSLOG_PAGE_SIZE))
+        {
+            break;
+        }
+    }
+    mwTsLog.pageOff = off;
+
+    cur.sectorSeq = mwTsLog.headSeq;
+    cur.offset = MW_TSLOG_DATA_START;
+    while (cur.offset < off && mwTsLogNextHdr(&cur, &hdr) == MW_TSLOG_OK && cur.sectorSeq == mwTsLog.headSeq)
+    {
+        if (mwTsLogRecIntact(&cur, &hdr))
+        {
+            mwTsLog.nextRecSeq = hdr.seq + 1;
+            cur.offset += MW_TSLOG_ALIGN(sizeof(hdr) + hdr.len);
+        }
+        else
+        {
+            cur.offset = MW_TSLOG_PAGE_OF(cur.offset) + MW_TSLOG_PAGE_SIZE;
+        }
+    }
+}
+
+static void mwTsLogRecover(void)
+{
+    MwTsLogSectorHdr hdr;
+    UINT32 idx, seq, n;
+    BOOL found = FALSE;
+
+    mwTsLog.live = 0;
+    mwTsLog.headSeq = 0;
+    mwTsLog.nextRecSeq = 0;
+    mwTsLog.pageOff = 0;
+    mwTsLog.pageFill = 0;
+
+    for (idx = 0; idx < MW_TSLOG_SECTORS; idx++)
+    {
+        if (mwTsLogReadSectorHdr(idx, &hdr) && (!found || (INT32)(hdr.sectorSeq - mwTsLog.headSeq) > 0))
+        {
+            found = TRUE;
+            mwTsLog.headIdx = idx;
+            mwTsLog.headSeq = hdr.sectorSeq;
+        }
+    }
+    if (!found)
+    {
+        return;
+    }
+
+    /* Walk back while the sequence numbers follow; anything else is free, or a torn erase */
+    for (n = 0; n < MW_TSLOG_SECTORS; n++)
+    {
+        idx = (mwTsLog.headIdx + MW_TSLOG_SECTORS - n) % MW_TSLOG_SECTORS;
+        seq = mwTsLog.headSeq - n;
+        if (!mwTsLogReadSectorHdr(idx, &hdr) || hdr.sectorSeq != seq)
+        {
+            break;
+        }
+        mwTsLog.firstRec[idx] = hdr.firstRecSeq;
+    }
+    mwTsLog.live = n;
+
+    mwTsLogRecoverHead();
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+INT32 mwTsLogInit(void)
+{
+    const osMutexAttr_t lockAttr = { "mwTsLog", osMutexPrioInherit, NULL, 0 };
+    int32_t kernelLock;
+
+    kernelLock = osKernelLock();
+    if (mwTsLog.started)
+    {
+        osKernelRestoreLock(kernelLock);
+        return MW_TSLOG_OK;
+    }
+    mwTsLog.started = TRUE;
+    osKernelRestoreLock(kernelLock);
+
+    mwTsLog.lock = osMutexNew(&lockAttr);
+    if (mwTsLog.lock == PNULL)
+    {
+        goto fail;
+    }
+
+    mwTsLogRecover();
+    return MW_TSLOG_OK;
+
+fail:
+    mwTsLog.started = FALSE;
+    return MW_TSLOG_ERR_SYS;
+}
+
+INT32 mwTsLogAppend(const void *data, UINT16 len, UINT32 *seq)
+{
+    MwTsLogRecHdr hdr;
+    UINT32 pad = 0;
+    INT32 ret = MW_TSLOG_OK;
+
+    if ((data == PNULL && len > 0) || len > MW_TSLOG_MAX_PAYLOAD)
+    {
+        return MW_TSLOG_ERR_PARAM;
+    }
+    if (mwTsLog.lock == PNULL)
+    {
+        return MW_TSLOG_ERR_STATE;
+    }
+
+    osMutexAcquire(mwTsLog.lock, osWaitForever);
+
+    if (mwTsLog.live == 0 || mwTsLog.pageOff + mwTsLog.pageFill + MW_TSLOG_ALIGN(sizeof(hdr) + len) > MW_TSLOG_SECTOR_SIZE)
+    {
+        mwTsLogProgramPage();
+        ret = mwTsLogStartSector();
+        if (ret != MW_TSLOG_OK)
+        {
+            osMutexRelease(mwTsLog.lock);
+            return ret;
+        }
+    }
+
+    hdr.len = len;
+    hdr.seq = mwTsLog.nextRecSeq++;
+    hdr.timeSecs = (UINT32)OsaSystemTimeReadSecs();
+    hdr.crc = mwTsLogRecCrc(&hdr, data);
+
+    mwTsLogPut(&hdr, sizeof(hdr));
+    mwTsLogPut(data, len);
+    mwTsLogPut(&pad, MW_TSLOG_ALIGN(sizeof(hdr) + len) - (sizeof(hdr) + len));
+    mwTsLog.stats.appended++;
+
+    if (seq != PNULL)
+    {
+        *seq = hdr.seq;
+    }
+
+    osMutexRelease(mwTsLog.lock);
+    return MW_TSLOG_OK;
+}
+
+INT32 mwTsLogFlush(void)
+{
+    INT32 ret;
+
+    if (mwTsLog.lock == PNULL)
+    {
+        return MW_TSLOG_ERR_STATE;
+    }
+
+    osMutexAcquire(mwTsLog.lock, osWaitForever);
+    ret = mwTsLogProgramPage();
+    osMutexRelease(mwTsLog.lock);
+    return ret;
+}
+
+INT32 mwTsLogFormat(void)
+{
+    UINT32 idx;
+    INT32 ret = MW_TSLOG_OK;
+
+    if (mwTsLog.lock == PNULL)
+    {
+        return MW_TSLOG_ERR_STATE;
+    }
+
+    osMutexAcquire(mwTsLog.lock, osWaitForever);
+    for (idx = 0; idx < MW_TSLOG_SECTORS; idx++)
+    {
+        mwTsLog.stats.sectorErases++;
+        if (BSP_QSPI_Erase_Safe(mwTsLogAddr(idx, 0), MW_TSLOG_SECTOR_SIZE) != QSPI_OK)
+        {
+            mwTsLog.stats.flashErrors++;
+            ret = MW_TSLOG_ERR_FLASH;
+        }
+    }
+    mwTsLog.live = 0;
+    mwTsLog.headSeq = 0;
+    mwTsLog.nextRecSeq = 0;
+    mwTsLog.pageOff = 0;
+    mwTsLog.pageFill = 0;
+    osMutexRelease(mwTsLog.lock);
+    return ret;
+}
+
+INT32 mwTsLogSeek(MwTsLogCursor *cur, UINT32 seq)
+{
+    MwTsLogRecHdr hdr;
+    UINT32 s;
+    INT32 ret;
+
+    if (cur == PNULL)
+    {
+        return MW_TSLOG_ERR_PARAM;
+    }
+    if (mwTsLog.lock == PNULL)
+    {
+        return MW_TSLOG_ERR_STATE;
+    }
+
+    osMutexAcquire(mwTsLog.lock, osWaitForever);
+
+    /* The newest sector that starts at or before seq, then record by record */
+    cur->sectorSeq = (mwTsLog.live == 0) ? 0 : mwTsLogTailSeq();
+    for (s = cur->sectorSeq; mwTsLog.live > 0 && (INT32)(s - mwTsLog.headSeq) <= 0; s++)
+    {
+        if ((INT32)(mwTsLog.firstRec[mwTsLogIdxOf(s)] - seq) <= 0)
+        {
+            cur->sectorSeq = s;
+        }
+    }
+    cur->offset = MW_TSLOG_DATA_START;
+
+    while ((ret = mwTsLogNextHdr(cur, &hdr)) == MW_TSLOG_OK && (INT32)(hdr.seq - seq) < 0)
+    {
+        cur->offset += MW_TSLOG_ALIGN(sizeof(hdr) + hdr.len);
+    }
+
+    osMutexRelease(mwTsLog.lock);
+    return (ret == MW_TSLOG_ERR_FLASH) ? ret : MW_TSLOG_OK;
+}
+
+INT32 mwTsLogRead(MwTsLogCursor *cur, MwTsLogRecInfo *info, void *buf, UINT16 size)
+{
+    MwTsLogRecHdr hdr;
+    INT32 ret;
+
+    if (cur == PNULL || info == PNULL || (buf == PNULL && size > 0))
+    {
+        return MW_TSLOG_ERR_PARAM;
+    }
+    if (mwTsLog.lock == PNULL)
+    {
+        return MW_TSLOG_ERR_STATE;
+    }
+
+    osMutexAcquire(mwTsLog.lock, osWaitForever);
+    while ((ret = mwTsLogNextHdr(cur, &hdr)) == MW_TSLOG_OK)
+    {
+        if (hdr.len > size)
+        {
+            info->len = hdr.len;
+            ret = MW_TSLOG_ERR_SIZE;
+            break;
+        }
+
+        ret = mwTsLogReadAt(cur->sectorSeq, cur->offset + sizeof(hdr), buf, hdr.len);
+        if (ret != MW_TSLOG_OK)
+        {
+            break;
+        }
+        if (hdr.crc != mwTsLogRecCrc(&hdr, buf))
+        {
+            mwTsLog.stats.crcErrors++;
+            cur->offset = MW_TSLOG_PAGE_OF(cur->offset) + MW_TSLOG_PAGE_SIZE;
+            continue;
+        }
+
+        info->seq = hdr.seq;
+        info->timeSecs = hdr.timeSecs;
+        info->len = hdr.len;
+        info->reserved = 0;
+        cur->offset += MW_TSLOG_ALIGN(sizeof(hdr) + hdr.len);
+        break;
+    }
+    osMutexRelease(mwTsLog.lock);
+    return ret;
+}
+
+void mwTsLogGetStats(MwTsLogStats *stats)
+{
+    if (stats == PNULL)
+    {
+        return;
+    }
+
+    if (mwTsLog.lock != PNULL)
+    {
+        osMutexAcquire(mwTsLog.lock, osWaitForever);
+    }
+    *stats = mwTsLog.stats;
+    stats->oldestSeq = (mwTsLog.live == 0) ? mwTsLog.nextRecSeq : mwTsLog.firstRec[mwTsLogIdxOf(mwTsLogTailSeq())];
+    stats->nextSeq = mwTsLog.nextRecSeq;
+    if (mwTsLog.lock != PNULL)
+    {
+        osMutexRelease(mwTsLog.lock);
+    }
+}
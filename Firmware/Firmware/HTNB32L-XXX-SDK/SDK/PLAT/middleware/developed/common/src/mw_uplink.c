@@ -0,0 +1,514 @@
+/****************************************************************************
+ *
+ * Copy right:   2026-, Copyrights of HT Micron Semicondutores S.A.
+ * File name:    mw_uplink.c
+ * Description:  Prioritized uplink arbiter between the application APIs and sockets
+ *               Without it the uplink goes to whichever task reaches its socket first,
+ *               and on a 20 kbps NB-IoT link an HTTP upload or an LFS backlog flush holds
+ *               it for tens of seconds while an alarm waits behind it.
+ *
+ *               Each class has a FIFO and a token bucket. The uplink task always sends
+ *               the head of the highest class whose bucket covers it, so bulk traffic is
+ *               held to its rate and takes the link only when nothing more urgent is
+ *               waiting, while it still gets the whole link when it is alone within its
+ *               budget. Preemption happens between messages, never inside one.
+ *
+ *               A message larger than its class burst is let through once the bucket is
+ *               full, so that a misconfigured budget delays it instead of blocking the
+ *               class for good.
+ * History:      Rev1.0   2026-10-19
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "osasys.h"
+#include "qc_tcpip_api.h"
+#include "mw_uplink.h"
+
+/******************************************************************************
+ *****************************************************************************
+ * MARCO/ENUM
+ *****************************************************************************
+******************************************************************************/
+typedef enum MwUplinkState_Tag
+{
+    MW_UPLINK_STOPPED = 0,
+    MW_UPLINK_STARTING,             //one caller of mwUplinkInit() creates the task
+    MW_UPLINK_RUNNING
+}MwUplinkState;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STRUCT
+ *****************************************************************************
+******************************************************************************/
+typedef struct MwUplinkMsg_Tag
+{
+    struct MwUplinkMsg_Tag  *next;
+    MwUplinkSendFn          send;
+    MwUplinkDoneFn          done;
+    void                    *ctx;
+    UINT32                  param;
+    UINT32                  enqueueMs;
+    UINT16                  len;
+    UINT8                   cls;
+    UINT8                   data[];
+}MwUplinkMsg;
+
+typedef struct MwUplinkQueue_Tag
+{
+    MwUplinkMsg         *head;
+    MwUplinkMsg         *tail;
+
+    UINT32              rate;           //bytes per second, 0: unlimited
+    UINT32              burst;
+    UINT32              tokens;
+    UINT32              refillMs;
+    UINT32              maxQueuedBytes;
+
+    MwUplinkClassStats  stats;
+}MwUplinkQueue;
+
+typedef struct MwUplinkContext_Tag
+{
+    osThreadId_t        task;
+    osMutexId_t         lock;
+    osSemaphoreId_t     work;
+    volatile UINT8      state;
+    MwUplinkQueue       queue[MW_UPLINK_CLASS_NUM];
+}MwUplinkContext;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * GLOBAL VARIABLES
+ *****************************************************************************
+******************************************************************************/
+static MwUplinkContext mwUplink;
+
+
+/******************************************************************************
+ *****************************************************************************
+ * STATIC FUNCTION
+ *****************************************************************************
+******************************************************************************/
+static UINT32 mwUplinkNowMs(void)
+{
+    UINT32 ticks = osKernelGetTickCount();
+    UINT32 freq = osKernelGetTickFreq();
+
+    if (freq == 1000)
+    {
+        return ticks;
+    }
+    return (UINT32)(((UINT64)ticks * 1000) / freq);
+}
+
+static UINT8 mwUplinkHistBucket(UINT32 delayMs)
+{
+    UINT8 bucket = 0;
+
+    while (delayMs != 0 && bucket < MW_UPLINK_HIST_BUCKETS - 1)
+    {
+        delayMs >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void mwUplinkRefill(MwUplinkQueue *q, UINT32 now)
+{
+    UINT64 add;
+
+    if (q->rate == 0)
+    {
+        return;
+    }
+    add = ((UINT64)(now - q->refillMs) * q->rate) / 1000;
+    if (add == 0)
+    {
+        /* Keep the remainder for the next call */
+        return;
+    }
+    if (q->tokens + add >= q->burst)
+    {
+        q->tokens = q->burst;
+        q->refillMs = now;
+    }
+    else
+    {
+        /* Only advance by the time the tokens account for */
+        q->tokens += (UINT32)add;
+        q->refillMs += (UINT32)((add * 1000) / q->rate);
+    }
+}
+
+/*
+ * Called with the lock held. Returns 0 if the head of q may go now, else
+ * the time in ms until its bucket covers it.
+ */
+static UINT32 mwUplinkWaitMs(MwUplinkQueue *q)
+{
+    UINT32 need;
+
+    if (q->rate == 0)
+    {
+        return 0;
+    }
+    need = (q->head->len < q->burst) ? q->head->len : q->burst;
+    if (q->tokens >= need)
+    {
+        return 0;
+    }
+    return (UINT32)((((UINT64)(need - q->tokens)) * 1000 + q->rate - 1) / q->rate);
+}
+
+/* Called with the lock held. Returns the next message or PNULL, and in
+ * *waitMs how long to sleep if every waiting class is out of budget. */
+static MwUplinkMsg *mwUplinkPick(UINT32 now, UINT32 *waitMs)
+{
+    MwUplinkQueue *q;
+    MwUplinkMsg *msg;
+    UINT32 wait;
+    UINT32 cls;
+
+    *waitMs = osWaitForever;
+    for (cls = 0; cls < MW_UPLINK_CLASS_NUM; cls++)
+    {
+        q = &mwUplink.queue[cls];
+        if (q->head == PNULL)
+        {
+            continue;
+        }
+
+        mwUplinkRefill(q, now);
+        wait = mwUplinkWaitMs(q);
+        if (wait != 0)
+        {
+            if (wait < *waitMs)
+            {
+                *waitMs = wait;
+            }
+            continue;
+        }
+
+        msg = q->head;
+        q->head = msg->next;
+        if (q->head == PNULL)
+        {
+            q->tail = PNULL;
+        }
+        if (q->rate != 0)
+        {
+            q->tokens = (q->tokens > msg->len) ? q->tokens - msg->len : 0;
+        }
+        q->stats.queued--;
+        q->stats.queuedBytes -= msg->len;
+        return msg;
+    }
+    return PNULL;
+}
+
+static void mwUplinkRecord(MwUplinkMsg *msg, UINT32 delayMs, INT32 ret)
+{
+    MwUplinkClassStats *stats = &mwUplink.queue[msg->cls].stats;
+
+    osMutexAcquire(mwUplink.lock, osWaitForever);
+    if (ret < 0)
+    {
+        stats->failed++;
+    }
+    else
+    {
+        stats->sent++;
+        stats->sentBytes += msg->len;
+    }
+    if (delayMs > stats->maxDelayMs)
+    {
+        stats->maxDelayMs = delayMs;
+    }
+    stats->delayHist[mwUplinkHistBucket(delayMs)]++;
+    osMutexRelease(mwUplink.lock);
+}
+
+static void mwUplinkTask(void *argument)
+{
+    MwUplinkMsg *msg;
+    UINT32 waitMs;
+    UINT32 delayMs;
+    INT32 ret;
+
+    (void)argument;
+
+    for (;;)
+    {
+        osMutexAcquire(mwUplink.lock, osWaitForever);
+        msg = mwUplinkPick(mwUplinkNowMs(), &waitMs);
+        osMutexRelease(mwUplink.lock);
+
+        if (msg == PNULL)
+        {
+            /* Woken by the next submit, or once a bucket has refilled */
+            osSemaphoreAcquire(mwUplink.work, waitMs);
+            continue;
+        }
+
+        delayMs = mwUplinkNowMs() - msg->enqueueMs;
+        ret = msg->send(msg->ctx, msg->param, msg->data, msg->len);
+        mwUplinkRecord(msg, delayMs, ret);
+        if (msg->done != PNULL)
+        {
+            msg->done(msg->ctx, msg->param, ret);
+        }
+
+        OsaFreeMemory(&msg);
+    }
+}
+
+static INT32 mwUplinkTcpipSendFn(void *ctx, UINT32 param, const UINT8 *data, UINT16 len)
+{
+    return tcpipConnectionSend((INT32)(intptr_t)ctx, (UINT8 *)data, len, (UINT8)param, 0, 0);
+}
+
+
+/******************************************************************************
+ *****************************************************************************
+ * API
+ *****************************************************************************
+******************************************************************************/
+INT32 mwUplinkInit(void)
+{
+    const osMutexAttr_t lockAttr = { "mwUplink", osMutexPrioInherit, NULL, 0 };
+    osThreadAttr_t taskAttr;
+    int32_t kernelLock;
+    UINT8 state;
+    UINT32 cls;
+
+    /* Only one task creates the arbiter, the others wait for its outcome */
+    for (;;)
+    {
+        kernelLock = osKernelLock();
+        state = mwUplink.state;
+        if (state == MW_UPLINK_STOPPED)
+        {
+            mwUplink.state = MW_UPLINK_STARTING;
+        }
+        osKernelRestoreLock(kernelLock);
+
+        if (state != MW_UPLINK_STARTING)
+        {
+            break;
+        }
+        osDelay(1);
+    }
+    if (state == MW_UPLINK_RUNNING)
+    {
+        return MW_UPLINK_OK;
+    }
+
+    for (cls = 0; cls < MW_UPLINK_CLASS_NUM; cls++)
+    {
+        mwUplink.queue[cls].maxQueuedBytes = (cls == MW_UPLINK_CLASS_BULK) ? 8192 : 2048;
+    }
+    mwUplink.queue[MW_UPLINK_CLASS_BULK].rate = 1500;
+    mwUplink.queue[MW_UPLINK_CLASS_BULK].burst = 3000;
+    mwUplink.queue[MW_UPLINK_CLASS_BULK].tokens = 3000;
+    mwUplink.queue[MW_UPLINK_CLASS_BULK].refillMs = mwUplinkNowMs();
+
+    mwUplink.lock = osMutexNew(&lockAttr);
+    mwUplink.work = osSemaphoreNew(1, 0, PNULL);
+    if (mwUplink.lock == PNULL || mwUplink.work == PNULL)
+    {
+        goto fail;
+    }
+
+    memset(&taskAttr, 0, sizeof(taskAttr));
+    taskAttr.name = "mwUplink";
+    taskAttr.stack_size = MW_UPLINK_TASK_STACK_SIZE;
+    taskAttr.priority = osPriorityBelowNormal7;
+
+    mwUplink.task = osThreadNew(mwUplinkTask, PNULL, &taskAttr);
+    if (mwUplink.task == PNULL)
+    {
+        goto fail;
+    }
+    mwUplink.state = MW_UPLINK_RUNNING;
+    return MW_UPLINK_OK;
+
+fail:
+    if (mwUplink.lock != PNULL)
+    {
+        osMutexDelete(mwUplink.lock);
+        mwUplink.lock = PNULL;
+    }
+    if (mwUplink.work != PNULL)
+    {
+        osSemaphoreDelete(mwUplink.work);
+        mwUplink.work = PNULL;
+    }
+    mwUplink.state = MW_UPLINK_STOPPED;
+    return MW_UPLINK_ERR_SYS;
+}
+
+INT32 mwUplinkSetBudget(MwUplinkClass cls, UINT32 bytesPerSec, UINT32 burstBytes, UINT32 maxQueuedBytes)
+{
+    MwUplinkQueue *q;
+
+    if (cls >= MW_UPLINK_CLASS_NUM || (bytesPerSec != 0 && burstBytes == 0))
+    {
+        return MW_UPLINK_ERR_PARAM;
+    }
+    if (mwUplinkInit() != MW_UPLINK_OK)
+    {
+        return MW_UPLINK_ERR_SYS;
+    }
+
+    q = &mwUplink.queue[cls];
+    osMutexAcquire(mwUplink.lock, osWaitForever);
+    q->rate = bytesPerSec;
+    q->burst = burstBytes;
+    q->tokens = burstBytes;
+    q->refillMs = mwUplinkNowMs();
+    if (maxQueuedBytes != 0)
+    {
+        q->maxQueuedBytes = maxQueuedBytes;
+    }
+    osMutexRelease(mwUplink.lock);
+
+    /* The task may be sleeping on the old refill time */
+    osSemaphoreRelease(mwUplink.work);
+    return MW_UPLINK_OK;
+}
+
+INT32 mwUplinkSubmit(MwUplinkClass cls, MwUplinkSendFn send, MwUplinkDoneFn done,
+                     void *ctx, UINT32 param, const UINT8 *data, UINT16 len)
+{
+    return mwUplinkSubmitV(cls, send, done, ctx, param, PNULL, 0, data, len);
+}
+
+INT32 mwUplinkSubmitV(MwUplinkClass cls, MwUplinkSendFn send, MwUplinkDoneFn done, void *ctx, UINT32 param,
+                      const UINT8 *head, UINT16 headLen, const UINT8 *data, UINT16 dataLen)
+{
+    MwUplinkQueue *q;
+    MwUplinkMsg *msg;
+    UINT32 len = (UINT32)headLen + dataLen;
+
+    if (cls >= MW_UPLINK_CLASS_NUM || send == PNULL || len > 0xFFFF ||
+        (head == PNULL && headLen != 0) || (data == PNULL && dataLen != 0))
+    {
+        return MW_UPLINK_ERR_PARAM;
+    }
+    if (mwUplinkInit() != MW_UPLINK_OK)
+    {
+        return MW_UPLINK_ERR_SYS;
+    }
+
+    q = &mwUplink.queue[cls];
+
+    /* Checked again under the lock, this only saves the copy */
+    if (q->stats.queuedBytes + len > q->maxQueuedBytes)
+    {
+        goto full;
+    }
+
+    msg = (MwUplinkMsg *)OsaAllocMemory(sizeof(MwUplinkMsg) + len);
+    if (msg == PNULL)
+    {
+        return MW_UPLINK_ERR_NO_MEMORY;
+    }
+    msg->next = PNULL;
+    msg->send = send;
+    msg->done = done;
+    msg->ctx = ctx;
+    msg->param = param;
+    msg->len = (UINT16)len;
+    msg->cls = (UINT8)cls;
+    if (headLen != 0)
+    {
+        memcpy(msg->data, head, headLen);
+    }
+    if (dataLen != 0)
+    {
+        memcpy(msg->data + headLen, data, dataLen);
+    }
+
+    osMutexAcquire(mwUplink.lock, osWaitForever);
+    if (q->stats.queuedBytes + len > q->maxQueuedBytes)
+    {
+        osMutexRelease(mwUplink.lock);
+        OsaFreeMemory(&msg);
+        goto full;
+    }
+    msg->enqueueMs = mwUplinkNowMs();
+    if (q->tail != PNULL)
+    {
+        q->tail->next = msg;
+    }
+    else
+    {
+        q->head = msg;
+    }
+    q->tail = msg;
+    q->stats.queued++;
+    q->stats.queuedBytes += len;
+    osMutexRelease(mwUplink.lock);
+
+    osSemaphoreRelease(mwUplink.work);
+    return MW_UPLINK_OK;
+
+full:
+    osMutexAcquire(mwUplink.lock, osWaitForever);
+    q->stats.rejected++;
+    osMutexRelease(mwUplink.lock);
+    return MW_UPLINK_ERR_FULL;
+}
+
+INT32 mwUplinkTcpipSend(MwUplinkClass cls, INT32 connectionId, const UINT8 *data, UINT16 len, UINT8 raiInfo)
+{
+    return mwUplinkSubmit(cls, mwUplinkTcpipSendFn, PNULL, (void *)(intptr_t)connectionId, raiInfo, data, len);
+}
+
+void mwUplinkGetStats(MwUplinkClass cls, MwUplinkClassStats *stats)
+{
+    if (cls >= MW_UPLINK_CLASS_NUM || stats == PNULL)
+    {
+        return;
+    }
+    if (mwUplink.state != MW_UPLINK_RUNNING)
+    {
+        memset(stats, 0, sizeof(MwUplinkClassStats));
+        return;
+    }
+
+    osMutexAcquire(mwUplink.lock, osWaitForever);
+    *stats = mwUplink.queue[cls].stats;
+    osMutexRelease(mwUplink.lock);
+}
+
+/* Clears the counters and histograms, not what is still queued */
+void mwUplinkResetStats(void)
+{
+    MwUplinkClassStats *stats;
+    UINT32 queued, queuedBytes;
+    UINT32 cls;
+
+    if (mwUplink.state != MW_UPLINK_RUNNING)
+    {
+        return;
+    }
+
+    osMutexAcquire(mwUplink.lock, osWaitForever);
+    for (cls = 0; cls < MW_UPLINK_CLASS_NUM; cls++)
+    {
+        stats = &mwUplink.queue[cls].stats;
+        queued = stats->queued;
+        queuedBytes = stats->queuedBytes;
+        memset(stats, 0, sizeof(MwUplinkClassStats));
+        stats->queued = queued;
+        stats->queuedBytes = queuedBytes;
+    }
+    osMutexRelease(mwUplink.lock);
+}
@@ -4742,6 +4742,16 @@ typedef enum
 	UNILOG_PLA_MIDWARE_npiSaveNvmConfig_1,
 	UNILOG_PLA_MIDWARE_npiSaveNvmConfig_2,
 	UNILOG_PLA_MIDWARE_npiSaveNvmConfig_3,
+	UNILOG_PLA_MIDWARE_mwPcapDump_1,
+	UNILOG_PLA_MIDWARE_mwLfsStatsCompaction_1,
+	UNILOG_PLA_MIDWARE_mwLfsStatsDump_1,
+	UNILOG_PLA_MIDWARE_mwLfsStatsDump_2,
+	UNILOG_PLA_MIDWARE_mwLfsStatsDump_3,
+	UNILOG_PLA_MIDWARE_mwDeltaHeader_1,
+	UNILOG_PLA_MIDWARE_mwDeltaFail_1,
+	UNILOG_PLA_MIDWARE_mwDeltaDone_1,
+	UNILOG_PLA_MIDWARE_mwPcProfDump_1,
+	UNILOG_PLA_MIDWARE_mwPcProfDump_2,
 	UNILOG_PLA_MIDWARE_INVALID_ID
 }UNILOG_PLA_MIDWARE_Tag;
 
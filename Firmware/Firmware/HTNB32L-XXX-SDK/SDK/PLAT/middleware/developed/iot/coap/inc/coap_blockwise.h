@@ -0,0 +1,130 @@
+/******************************************************************************
+
+  @file    coap_blockwise.h
+  @brief   Block-wise transfer engine: adaptive block size and Q-Block windows
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#ifndef _COAP_BLOCKWISE_H
+#define _COAP_BLOCKWISE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "er-coap-13.h"
+#include "qapi_coap.h"
+
+/* RFC 9177 option numbers. Q-Block1 shares its number with the internal
+ * COAP_OPTION_TOKEN id, so it is only ever carried as an extended option. */
+#define COAP_OPTION_Q_BLOCK1                 19
+#define COAP_OPTION_Q_BLOCK2                 31
+
+/* application/missing-blocks+cbor-seq, payload of a 4.08 for Q-Block1 */
+#define COAP_CONTENT_MISSING_BLOCKS          272
+
+#define COAP_BW_SZX_MIN                      0      /* 16 bytes */
+#define COAP_BW_SZX_MAX                      6      /* 1024 bytes */
+#define COAP_BW_SZX_TO_SIZE(szx)             ((uint16_t)(16u << (szx)))
+
+/* blocksize asking coap_bw_block_size() to pick the size from the link */
+#define COAP_BW_BLOCK_SIZE_AUTO              0
+
+#define COAP_BW_DEFAULT_PATH_MTU             1280   /* IPv6 minimum link MTU */
+#define COAP_BW_IPV4_UDP_OVERHEAD            28
+#define COAP_BW_IPV6_UDP_OVERHEAD            48
+#define COAP_BW_DTLS_OVERHEAD                29     /* record header + explicit nonce + CCM_8 tag */
+
+#define COAP_BW_MAX_PAYLOADS                 10     /* RFC 9177 MAX_PAYLOADS default */
+#define COAP_BW_MAX_PAYLOADS_LIMIT           32     /* width of the per-set bitmaps */
+
+#define COAP_BW_LOSS_SCALE                   1000   /* loss is kept in per mille */
+#define COAP_BW_LOSS_EWMA_SHIFT              3      /* new sample weight 1/8 */
+
+/* Per-session link statistics used to pick the block size. */
+typedef struct _coap_bw_link_s
+{
+  uint16_t  path_mtu;           /* IP MTU towards the peer */
+  uint16_t  overhead;           /* IP + UDP (+ DTLS) bytes added to every CoAP message */
+  uint16_t  loss_pm;            /* smoothed per-datagram loss, per mille */
+  uint16_t  loss_ref_len;       /* smoothed datagram length loss_pm was measured at */
+  uint32_t  exchanges;          /* completed confirmable exchanges */
+  uint32_t  retransmissions;    /* retransmissions over all exchanges */
+} coap_bw_link_t;
+
+/* One block to be put on the wire. */
+typedef struct _coap_bw_block_s
+{
+  uint32_t  num;                /* block number */
+  uint32_t  offset;             /* byte offset in the complete body */
+  uint16_t  len;                /* payload bytes in this block */
+  uint8_t   more;               /* M bit */
+  uint8_t   szx;                /* size exponent */
+  bool      last_of_set;        /* last block of a Q-Block set, sent CON to solicit 2.31 */
+} coap_bw_block_t;
+
+/* Sender side window over the body. For plain Block1/Block2 the set holds
+ * one block, so every block waits for its response as RFC 7959 requires.
+ * For Q-Block1/Q-Block2 up to max_payloads blocks are in flight and the
+ * peer answers the whole set at once. */
+typedef struct _coap_bw_window_s
+{
+  uint16_t  block_opt;          /* COAP_OPTION_BLOCK1/2 or COAP_OPTION_Q_BLOCK1/2 */
+  uint8_t   szx;
+  uint8_t   max_payloads;
+  uint32_t  total_len;
+  uint32_t  set_base;           /* first block number of the current set */
+  uint32_t  set_offset;         /* byte offset of set_base */
+  uint32_t  set_len;            /* blocks in the current set */
+  uint32_t  sent_mask;          /* bit n: block set_base + n is on the wire */
+  uint32_t  acked_mask;         /* bit n: block set_base + n confirmed by the peer */
+  uint8_t   set_retries;        /* times the current set was (partly) resent */
+} coap_bw_window_t;
+
+/* Receiver side bitmap for Q-Block2 downloads. */
+typedef struct _coap_bw_rx_s
+{
+  uint8_t   szx;
+  uint8_t   max_payloads;
+  uint32_t  set_base;
+  uint32_t  rcvd_mask;
+  bool      last_seen;          /* a block with M=0 arrived in this set */
+  uint32_t  last_num;
+} coap_bw_rx_t;
+
+/* Block option value encoding (RFC 7959 section 2.2). */
+uint32_t coap_bw_block_encode(uint32_t num, uint8_t more, uint8_t szx);
+void coap_bw_block_decode(uint32_t value, uint32_t *num, uint8_t *more, uint8_t *szx);
+uint8_t coap_bw_size_to_szx(uint16_t size);
+
+void coap_bw_link_init(coap_bw_link_t *link, uint16_t path_mtu, bool ipv6, bool dtls);
+void coap_bw_link_set_mtu(coap_bw_link_t *link, uint16_t path_mtu);
+void coap_bw_link_on_exchange(coap_bw_link_t *link, uint16_t dgram_len, uint8_t attempts);
+uint8_t coap_bw_select_szx(const coap_bw_link_t *link, uint16_t coap_hdr_len);
+
+int coap_bw_window_init(coap_bw_window_t *win, uint16_t block_opt, uint32_t total_len, uint8_t szx, uint8_t max_payloads);
+bool coap_bw_window_next(coap_bw_window_t *win, coap_bw_block_t *blk);
+void coap_bw_window_ack(coap_bw_window_t *win, uint32_t num);
+void coap_bw_window_ack_set(coap_bw_window_t *win);
+int coap_bw_window_missing(coap_bw_window_t *win, const uint8_t *cbor, size_t len);
+void coap_bw_window_timeout(coap_bw_window_t *win);
+int coap_bw_window_resize(coap_bw_window_t *win, uint8_t szx);
+bool coap_bw_window_done(const coap_bw_window_t *win);
+uint32_t coap_bw_window_blocks_total(const coap_bw_window_t *win);
+
+void coap_bw_rx_init(coap_bw_rx_t *rx, uint8_t szx, uint8_t max_payloads);
+int coap_bw_rx_mark(coap_bw_rx_t *rx, uint32_t num, uint8_t more);
+bool coap_bw_rx_set_complete(const coap_bw_rx_t *rx);
+size_t coap_bw_rx_missing(const coap_bw_rx_t *rx, uint32_t *nums, size_t max_nums);
+void coap_bw_rx_next_set(coap_bw_rx_t *rx);
+
+/* Block option number for a qapi block type, its Q-Block variant if qblock */
+uint16_t coap_bw_option_for_type(qapi_Coap_Block_Wise_Options_t btype, bool qblock);
+uint16_t coap_bw_block_size(const coap_bw_link_t *link, qapi_Coap_Packet_t *pkt, uint16_t requested);
+
+#endif
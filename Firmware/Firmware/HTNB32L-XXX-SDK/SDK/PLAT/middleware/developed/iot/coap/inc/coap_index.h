@@ -0,0 +1,127 @@
+/******************************************************************************
+
+  @file    coap_index.h
+  @brief   Hashed MID / token index and RFC 7252 duplicate detection cache
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#ifndef _COAP_INDEX_H
+#define _COAP_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "er-coap-13.h"
+#include "coap_timer.h"
+#include "coap_trans.h"
+
+/* Default table size per client context. Every outstanding exchange takes
+ * one MID and one token slot, so 64 slots hold 24 exchanges below the
+ * load limit. */
+#ifndef COAP_IDX_DEFAULT_SLOTS
+#define COAP_IDX_DEFAULT_SLOTS        64
+#endif
+#define COAP_IDX_LOAD_NUM             3   /* refuse inserts above 3/4 load */
+#define COAP_IDX_LOAD_DEN             4
+
+#ifndef COAP_DEDUP_DEFAULT_ENTRIES
+#define COAP_DEDUP_DEFAULT_ENTRIES    8
+#endif
+#define COAP_DEDUP_MAX_RESPONSE       256 /* larger responses are not cached, only dropped duplicates */
+
+/* RFC 7252 section 4.8.2 with default transmission parameters */
+#define COAP_DEDUP_EXCHANGE_LIFETIME_MS  247000u
+#define COAP_DEDUP_NON_LIFETIME_MS       145000u
+
+typedef enum
+{
+  COAP_IDX_KIND_EMPTY = 0,
+  COAP_IDX_KIND_MID,
+  COAP_IDX_KIND_TOKEN
+} coap_idx_kind_t;
+
+typedef struct _coap_idx_entry_s
+{
+  void *    session;
+  void *    value;
+  uint32_t  hash;
+  uint16_t  mid;
+  uint8_t   kind;
+  uint8_t   token_len;
+  uint8_t   token[COAP_TOKEN_LEN];
+} coap_idx_entry_t;
+
+/* Open addressing, linear probing, backward shift delete (no tombstones).
+ * Sessions are compared by handle, the caller passes the same pointer it
+ * keeps in coap_transaction_t::sessionH. */
+typedef struct _coap_idx_s
+{
+  coap_idx_entry_t * slots;
+  uint16_t           mask;            /* slot count - 1, slot count is a power of two */
+  uint16_t           count;
+  uint32_t           overflows;       /* inserts refused at the load limit */
+} coap_idx_t;
+
+typedef enum
+{
+  COAP_DEDUP_NEW = 0,                 /* first copy, process it */
+  COAP_DEDUP_IN_PROGRESS,             /* duplicate, response not built yet: drop */
+  COAP_DEDUP_REPLAY                   /* duplicate, resend the cached response */
+} coap_dedup_result_t;
+
+typedef struct _coap_dedup_s coap_dedup_t;
+
+typedef struct _coap_dedup_entry_s
+{
+  coap_tw_timer_t timer;              /* COAP_TW_KIND_DEDUP_EXPIRY */
+  coap_dedup_t *  owner;
+  void *          session;
+  uint8_t *       response;
+  uint16_t        response_len;
+  uint16_t        mid;
+  bool            used;
+} coap_dedup_entry_t;
+
+/* Entries are reused in insertion order, so a full cache evicts the
+ * oldest exchange first. */
+struct _coap_dedup_s
+{
+  coap_dedup_entry_t * entries;
+  uint16_t             capacity;
+  uint16_t             head;
+  coap_idx_t           idx;           /* (session, MID) -> entry */
+  coap_timer_wheel_t * wheel;
+  qurt_mutex_t         lock;
+  uint32_t             replayed;
+  uint32_t             dropped;
+};
+
+int coap_idx_init(coap_idx_t *idx, uint16_t slots);
+void coap_idx_deinit(coap_idx_t *idx);
+void coap_idx_clear(coap_idx_t *idx);
+int coap_idx_add_mid(coap_idx_t *idx, void *session, uint16_t mid, void *value);
+void * coap_idx_find_mid(const coap_idx_t *idx, void *session, uint16_t mid);
+int coap_idx_del_mid(coap_idx_t *idx, void *session, uint16_t mid);
+int coap_idx_add_token(coap_idx_t *idx, void *session, const uint8_t *token, uint8_t token_len, void *value);
+void * coap_idx_find_token(const coap_idx_t *idx, void *session, const uint8_t *token, uint8_t token_len);
+int coap_idx_del_token(coap_idx_t *idx, void *session, const uint8_t *token, uint8_t token_len);
+
+int coap_dedup_init(coap_dedup_t *dedup, uint16_t entries, coap_timer_wheel_t *wheel);
+void coap_dedup_deinit(coap_dedup_t *dedup);
+coap_dedup_result_t coap_dedup_check(coap_dedup_t *dedup, void *session, uint16_t mid, uint32_t lifetime_ms, uint8_t *buf, size_t buf_len, size_t *resp_len);
+int coap_dedup_store_response(coap_dedup_t *dedup, void *session, uint16_t mid, const uint8_t *response, size_t len);
+uint32_t coap_dedup_lifetime_ms(uint32_t exchange_lifetime_s, coap_message_type_t type);
+
+/* Hooks for the transaction code. A transaction the index refused, or
+ * one find() does not know, is handled by the transactionList walk. */
+int coap_index_transaction_add(coap_idx_t *idx, coap_transaction_t *transacP);
+void coap_index_transaction_remove(coap_idx_t *idx, coap_transaction_t *transacP);
+coap_transaction_t * coap_index_transaction_find(const coap_idx_t *idx, void *sessionH, coap_packet_t *message);
+
+#endif
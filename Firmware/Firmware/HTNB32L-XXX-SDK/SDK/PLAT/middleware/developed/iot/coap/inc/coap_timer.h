@@ -0,0 +1,96 @@
+/******************************************************************************
+
+  @file    coap_timer.h
+  @brief   Hierarchical timer wheel for CoAP / LwM2M protocol deadlines
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#ifndef _COAP_TIMER_H
+#define _COAP_TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "qurt_os.h"
+
+/* 4 levels of 64 slots with a 16 ms tick cover about 74 hours, far more
+ * than EXCHANGE_LIFETIME or any LwM2M lifetime we arm. Longer delays are
+ * clamped and simply cascade again. */
+#define COAP_TW_LEVELS                4
+#define COAP_TW_SLOT_BITS             6
+#define COAP_TW_SLOTS                 (1u << COAP_TW_SLOT_BITS)
+#define COAP_TW_SLOT_MASK             (COAP_TW_SLOTS - 1u)
+#ifndef COAP_TW_TICK_MS
+#define COAP_TW_TICK_MS               16
+#endif
+#define COAP_TW_MAX_DELAY_TICKS       ((1uL << (COAP_TW_SLOT_BITS * COAP_TW_LEVELS)) - 1u)
+
+#define COAP_TW_NO_DEADLINE           0xFFFFFFFFu
+#define COAP_TW_DETACHED              0xFF
+
+typedef enum
+{
+  COAP_TW_KIND_RETRANSMIT = 0,        /* CON retransmission (ACK_TIMEOUT back-off) */
+  COAP_TW_KIND_RESPONSE_TIMEOUT,      /* separate response / token timeout */
+  COAP_TW_KIND_EXCHANGE_LIFETIME,     /* MID must not be reused before this */
+  COAP_TW_KIND_DEDUP_EXPIRY,          /* duplicate detection entry ages out */
+  COAP_TW_KIND_BLOCKWISE,             /* block session max age / NON_RECEIVE_TIMEOUT */
+  COAP_TW_KIND_LWM2M,                 /* registration update, pmin/pmax, lifetime */
+  COAP_TW_KIND_MAX
+} coap_tw_kind_t;
+
+typedef struct _coap_tw_timer_s coap_tw_timer_t;
+
+typedef void (*coap_tw_callback_t)(coap_tw_timer_t *timer, void *arg);
+
+typedef uint32_t (*coap_tw_clock_t)(void);
+
+/* Embedded in the owner (transaction, observation, ...); the wheel never
+ * allocates. */
+struct _coap_tw_timer_s
+{
+  coap_tw_timer_t *  next;
+  coap_tw_timer_t ** pprev;           /* NULL when not armed */
+  uint32_t           expires;         /* absolute wheel tick */
+  coap_tw_callback_t cb;
+  void *             arg;
+  uint8_t            kind;
+  uint8_t            level;
+  uint8_t            slot;
+};
+
+typedef struct _coap_timer_wheel_s
+{
+  uint32_t          now;              /* last processed tick */
+  uint32_t          now_ms;           /* clock value that corresponds to now */
+  coap_tw_clock_t   clock;            /* millisecond clock, wraps modulo 2^32 */
+  uint32_t          armed;            /* timers in the wheel */
+  uint32_t          armed_kind[COAP_TW_KIND_MAX];
+  uint32_t          fired;
+  uint64_t          occupied[COAP_TW_LEVELS];
+  coap_tw_timer_t * slots[COAP_TW_LEVELS][COAP_TW_SLOTS];
+  qurt_mutex_t      lock;
+} coap_timer_wheel_t;
+
+void coap_tw_init(coap_timer_wheel_t *wheel, coap_tw_clock_t clock);
+void coap_tw_deinit(coap_timer_wheel_t *wheel);
+void coap_tw_timer_init(coap_tw_timer_t *timer, coap_tw_kind_t kind, coap_tw_callback_t cb, void *arg);
+void coap_tw_start(coap_timer_wheel_t *wheel, coap_tw_timer_t *timer, uint32_t delay_ms);
+void coap_tw_stop(coap_timer_wheel_t *wheel, coap_tw_timer_t *timer);
+bool coap_tw_is_armed(const coap_tw_timer_t *timer);
+uint32_t coap_tw_advance(coap_timer_wheel_t *wheel);
+uint32_t coap_tw_next_deadline_ms(coap_timer_wheel_t *wheel);
+
+/* Process wide wheel shared by the CoAP and LwM2M tasks. */
+coap_timer_wheel_t * coap_tw_default(void);
+uint32_t coap_tw_now_ms(void);
+qurt_time_t coap_tw_wait_ticks(void);
+
+uint32_t coap_tw_retransmit_delay_ms(uint32_t ack_timeout_s, double ack_random_factor, uint8_t retrans_counter);
+
+#endif
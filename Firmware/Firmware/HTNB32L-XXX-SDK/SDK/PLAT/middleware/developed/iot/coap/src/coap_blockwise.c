@@ -0,0 +1,474 @@
+/******************************************************************************
+
+  @file    coap_blockwise.c
+  @brief   Block-wise transfer engine: adaptive block size and Q-Block windows
+
+  The engine does not own any packet. The transaction layer asks it which
+  block goes next, serializes it with coap_set_header_block1/2() (or as a
+  Q-Block1/Q-Block2 extended option) and reports responses and losses back.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <string.h>
+#include "coap-internal.h"
+#include "coap_blockwise.h"
+
+#define COAP_BW_SET_MASK(n)  (((n) >= 32u) ? 0xFFFFFFFFu : ((1u << (n)) - 1u))
+
+static bool coap_bw_is_qblock(uint16_t block_opt)
+{
+  return (block_opt == COAP_OPTION_Q_BLOCK1 || block_opt == COAP_OPTION_Q_BLOCK2);
+}
+
+/* Reads one CBOR unsigned integer (major type 0). Returns bytes consumed,
+ * 0 on malformed or unsupported input. */
+static size_t coap_bw_cbor_uint(const uint8_t *buf, size_t len, uint32_t *value)
+{
+  uint8_t ai;
+
+  if (len == 0 || (buf[0] >> 5) != 0)
+    return 0;
+
+  ai = buf[0] & 0x1F;
+  if (ai < 24)
+  {
+    *value = ai;
+    return 1;
+  }
+  if (ai == 24 && len >= 2)
+  {
+    *value = buf[1];
+    return 2;
+  }
+  if (ai == 25 && len >= 3)
+  {
+    *value = ((uint32_t)buf[1] << 8) | buf[2];
+    return 3;
+  }
+  if (ai == 26 && len >= 5)
+  {
+    *value = ((uint32_t)buf[1] << 24) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 8) | buf[4];
+    return 5;
+  }
+  return 0;
+}
+
+uint32_t coap_bw_block_encode(uint32_t num, uint8_t more, uint8_t szx)
+{
+  return (num << 4) | (more ? 0x08u : 0u) | (szx & 0x07u);
+}
+
+void coap_bw_block_decode(uint32_t value, uint32_t *num, uint8_t *more, uint8_t *szx)
+{
+  if (num)  *num  = value >> 4;
+  if (more) *more = (value & 0x08u) ? 1 : 0;
+  if (szx)  *szx  = value & 0x07u;
+}
+
+uint8_t coap_bw_size_to_szx(uint16_t size)
+{
+  uint8_t szx = COAP_BW_SZX_MIN;
+
+  while (szx < COAP_BW_SZX_MAX && COAP_BW_SZX_TO_SIZE(szx + 1) <= size)
+    szx++;
+  return szx;
+}
+
+/*------------------------------------------------------------------------------
+ * Link estimation and block size selection
+ *----------------------------------------------------------------------------*/
+
+void coap_bw_link_init(coap_bw_link_t *link, uint16_t path_mtu, bool ipv6, bool dtls)
+{
+  if (link == NULL)
+    return;
+
+  memset(link, 0, sizeof(coap_bw_link_t));
+  link->overhead = (ipv6 ? COAP_BW_IPV6_UDP_OVERHEAD : COAP_BW_IPV4_UDP_OVERHEAD) +
+                   (dtls ? COAP_BW_DTLS_OVERHEAD : 0);
+  coap_bw_link_set_mtu(link, path_mtu);
+  link->loss_ref_len = link->path_mtu;
+}
+
+void coap_bw_link_set_mtu(coap_bw_link_t *link, uint16_t path_mtu)
+{
+  if (link == NULL)
+    return;
+
+  link->path_mtu = (path_mtu != 0) ? path_mtu : COAP_BW_DEFAULT_PATH_MTU;
+}
+
+/* Called once per finished confirmable exchange. attempts is the number of
+ * times the request went on the wire, so attempts - 1 datagrams were lost. */
+void coap_bw_link_on_exchange(coap_bw_link_t *link, uint16_t dgram_len, uint8_t attempts)
+{
+  int32_t sample;
+
+  if (link == NULL || attempts == 0)
+    return;
+
+  sample = (int32_t)(COAP_BW_LOSS_SCALE * (attempts - 1) / attempts);
+  link->loss_pm = (uint16_t)((int32_t)link->loss_pm + ((sample - (int32_t)link->loss_pm) >> COAP_BW_LOSS_EWMA_SHIFT));
+  if (dgram_len != 0)
+    link->loss_ref_len = (uint16_t)((int32_t)link->loss_ref_len + (((int32_t)dgram_len - (int32_t)link->loss_ref_len) >> COAP_BW_LOSS_EWMA_SHIFT));
+
+  link->exchanges++;
+  link->retransmissions += attempts - 1;
+}
+
+/* Picks the SZX with the lowest expected bytes on air per payload byte.
+ * Per-datagram loss is scaled linearly with datagram length from the
+ * measured reference, which holds for the low loss rates we care about:
+ *
+ *   cost(S) = (overhead + hdr + S) / (S * (1 - p(S)))
+ *
+ * Without loss the largest block that fits the MTU always wins; as loss
+ * grows, smaller blocks waste less on every retransmission. */
+uint8_t coap_bw_select_szx(const coap_bw_link_t *link, uint16_t coap_hdr_len)
+{
+  uint8_t  szx;
+  uint8_t  best_szx = COAP_BW_SZX_MIN;
+  uint64_t best_cost = UINT64_MAX;
+
+  if (link == NULL)
+    return COAP_BW_SZX_MAX;
+
+  for (szx = COAP_BW_SZX_MAX + 1; szx-- > COAP_BW_SZX_MIN; )
+  {
+    uint32_t size  = COAP_BW_SZX_TO_SIZE(szx);
+    uint32_t dgram = link->overhead + coap_hdr_len + size;
+    uint32_t loss;
+    uint64_t cost;
+
+    if (dgram > link->path_mtu && szx != COAP_BW_SZX_MIN)
+      continue;
+
+    loss = (link->loss_ref_len != 0) ? (uint32_t)link->loss_pm * dgram / link->loss_ref_len : link->loss_pm;
+    if (loss > (COAP_BW_LOSS_SCALE * 9) / 10)
+      loss = (COAP_BW_LOSS_SCALE * 9) / 10;
+
+    cost = ((uint64_t)dgram * COAP_BW_LOSS_SCALE << 10) / ((uint64_t)size * (COAP_BW_LOSS_SCALE - loss));
+    if (cost < best_cost)
+    {
+      best_cost = cost;
+      best_szx  = szx;
+    }
+  }
+
+  return best_szx;
+}
+
+/*------------------------------------------------------------------------------
+ * Sender window
+ *----------------------------------------------------------------------------*/
+
+uint32_t coap_bw_window_blocks_total(const coap_bw_window_t *win)
+{
+  uint32_t size = COAP_BW_SZX_TO_SIZE(win->szx);
+
+  if (win->total_len == 0)
+    return 1;
+  return (win->total_len + size - 1) / size;
+}
+
+static void coap_bw_window_load_set(coap_bw_window_t *win)
+{
+  uint32_t total = coap_bw_window_blocks_total(win);
+
+  win->sent_mask   = 0;
+  win->acked_mask  = 0;
+  win->set_retries = 0;
+  win->set_len     = (win->set_base < total) ? MIN((uint32_t)win->max_payloads, total - win->set_base) : 0;
+}
+
+int coap_bw_window_init(coap_bw_window_t *win, uint16_t block_opt, uint32_t total_len, uint8_t szx, uint8_t max_payloads)
+{
+  if (win == NULL || szx > COAP_BW_SZX_MAX)
+    return -1;
+
+  if (block_opt != COAP_OPTION_BLOCK1 && block_opt != COAP_OPTION_BLOCK2 && !coap_bw_is_qblock(block_opt))
+    return -1;
+
+  memset(win, 0, sizeof(coap_bw_window_t));
+  win->block_opt = block_opt;
+  win->szx       = szx;
+  win->total_len = total_len;
+
+  if (!coap_bw_is_qblock(block_opt))
+    win->max_payloads = 1;
+  else if (max_payloads == 0)
+    win->max_payloads = COAP_BW_MAX_PAYLOADS;
+  else
+    win->max_payloads = MIN(max_payloads, COAP_BW_MAX_PAYLOADS_LIMIT);
+
+  coap_bw_window_load_set(win);
+  return 0;
+}
+
+/* Returns the next block of the current set that is not on the wire yet.
+ * false means the whole set is out and the caller has to wait for the
+ * peer (or for coap_bw_window_timeout()). */
+bool coap_bw_window_next(coap_bw_window_t *win, coap_bw_block_t *blk)
+{
+  uint32_t size;
+  uint32_t idx;
+  uint32_t set_mask;
+
+  if (win == NULL || blk == NULL || coap_bw_window_done(win))
+    return false;
+
+  set_mask = COAP_BW_SET_MASK(win->set_len);
+  if ((win->sent_mask & set_mask) == set_mask)
+    return false;
+
+  for (idx = 0; idx < win->set_len; idx++)
+  {
+    if (!(win->sent_mask & (1u << idx)))
+      break;
+  }
+
+  size = COAP_BW_SZX_TO_SIZE(win->szx);
+  blk->num    = win->set_base + idx;
+  blk->offset = win->set_offset + idx * size;
+  blk->len    = (uint16_t)MIN(size, win->total_len - MIN(blk->offset, win->total_len));
+  blk->more   = (blk->num + 1 < coap_bw_window_blocks_total(win)) ? 1 : 0;
+  blk->szx    = win->szx;
+
+  win->sent_mask |= (1u << idx);
+  blk->last_of_set = ((win->sent_mask & set_mask) == set_mask);
+  return true;
+}
+
+static void coap_bw_window_advance(coap_bw_window_t *win)
+{
+  win->set_offset += win->set_len * COAP_BW_SZX_TO_SIZE(win->szx);
+  win->set_base   += win->set_len;
+  coap_bw_window_load_set(win);
+}
+
+/* A response acknowledged one block (2.31 for Block1, 2.05 for Block2). */
+void coap_bw_window_ack(coap_bw_window_t *win, uint32_t num)
+{
+  uint32_t set_mask;
+
+  if (win == NULL || num < win->set_base || num >= win->set_base + win->set_len)
+    return;
+
+  win->acked_mask |= (1u << (num - win->set_base));
+  set_mask = COAP_BW_SET_MASK(win->set_len);
+  if ((win->acked_mask & set_mask) == set_mask)
+    coap_bw_window_advance(win);
+}
+
+/* The peer confirmed the whole set (Q-Block1 2.31 Continue). */
+void coap_bw_window_ack_set(coap_bw_window_t *win)
+{
+  if (win == NULL || win->set_len == 0)
+    return;
+
+  coap_bw_window_advance(win);
+}
+
+/* 4.08 Request Entity Incomplete carrying application/missing-blocks+cbor-seq.
+ * Listed blocks of the current set are queued again, every other block that
+ * was sent is taken as received. Returns the number of blocks to resend. */
+int coap_bw_window_missing(coap_bw_window_t *win, const uint8_t *cbor, size_t len)
+{
+  uint32_t missing = 0;
+  uint32_t num;
+  size_t   used;
+  int      count = 0;
+
+  if (win == NULL || (cbor == NULL && len != 0))
+    return -1;
+
+  while (len > 0)
+  {
+    used = coap_bw_cbor_uint(cbor, len, &num);
+    if (used == 0)
+    {
+      COAP_LOG_ERROR("blockwise: malformed missing-blocks payload");
+      return -1;
+    }
+    cbor += used;
+    len  -= used;
+
+    if (num >= win->set_base && num < win->set_base + win->set_len)
+      missing |= (1u << (num - win->set_base));
+  }
+
+  win->acked_mask |= win->sent_mask & ~missing;
+  win->sent_mask  &= ~missing;
+  win->set_retries++;
+
+  for (num = 0; num < win->set_len; num++)
+  {
+    if (missing & (1u << num))
+      count++;
+  }
+
+  if (count == 0)
+    coap_bw_window_ack_set(win);
+
+  return count;
+}
+
+/* Nothing came back for the set within NON_RECEIVE_TIMEOUT: requeue every
+ * block that is not known to be received. */
+void coap_bw_window_timeout(coap_bw_window_t *win)
+{
+  if (win == NULL)
+    return;
+
+  win->sent_mask = win->acked_mask;
+  win->set_retries++;
+}
+
+/* Changes the block size at a set boundary, e.g. when the server answers
+ * with a smaller SZX (RFC 7959 section 2.5) or the link estimate moved. */
+int coap_bw_window_resize(coap_bw_window_t *win, uint8_t szx)
+{
+  uint32_t size;
+
+  if (win == NULL || szx > COAP_BW_SZX_MAX)
+    return -1;
+
+  if (szx == win->szx)
+    return 0;
+
+  size = COAP_BW_SZX_TO_SIZE(szx);
+  if (win->sent_mask != 0 || (win->set_offset % size) != 0)
+    return -1;
+
+  win->szx      = szx;
+  win->set_base = win->set_offset / size;
+  coap_bw_window_load_set(win);
+  return 0;
+}
+
+bool coap_bw_window_done(const coap_bw_window_t *win)
+{
+  return (win == NULL) || (win->set_base >= coap_bw_window_blocks_total(win));
+}
+
+/*------------------------------------------------------------------------------
+ * Q-Block2 receiver
+ *----------------------------------------------------------------------------*/
+
+void coap_bw_rx_init(coap_bw_rx_t *rx, uint8_t szx, uint8_t max_payloads)
+{
+  if (rx == NULL)
+    return;
+
+  memset(rx, 0, sizeof(coap_bw_rx_t));
+  rx->szx = szx;
+  rx->max_payloads = (max_payloads == 0) ? COAP_BW_MAX_PAYLOADS : MIN(max_payloads, COAP_BW_MAX_PAYLOADS_LIMIT);
+}
+
+/* Returns 1 for a new block, 0 for a duplicate and -1 for a block outside
+ * the current set. */
+int coap_bw_rx_mark(coap_bw_rx_t *rx, uint32_t num, uint8_t more)
+{
+  uint32_t bit;
+
+  if (rx == NULL || num >= rx->set_base + rx->max_payloads)
+    return -1;
+  if (num < rx->set_base)
+    return 0;
+
+  bit = 1u << (num - rx->set_base);
+  if (!more)
+  {
+    rx->last_seen = true;
+    rx->last_num  = num;
+  }
+  if (rx->rcvd_mask & bit)
+    return 0;
+
+  rx->rcvd_mask |= bit;
+  return 1;
+}
+
+static uint32_t coap_bw_rx_expected(const coap_bw_rx_t *rx)
+{
+  return rx->last_seen ? (rx->last_num - rx->set_base + 1) : rx->max_payloads;
+}
+
+bool coap_bw_rx_set_complete(const coap_bw_rx_t *rx)
+{
+  uint32_t mask;
+
+  if (rx == NULL)
+    return false;
+
+  mask = COAP_BW_SET_MASK(coap_bw_rx_expected(rx));
+  return (rx->rcvd_mask & mask) == mask;
+}
+
+/* Fills nums with the block numbers of the current set still missing, to be
+ * requested again with one Q-Block2 option each. */
+size_t coap_bw_rx_missing(const coap_bw_rx_t *rx, uint32_t *nums, size_t max_nums)
+{
+  uint32_t idx;
+  uint32_t expected;
+  size_t   count = 0;
+
+  if (rx == NULL || nums == NULL)
+    return 0;
+
+  expected = coap_bw_rx_expected(rx);
+  for (idx = 0; idx < expected && count < max_nums; idx++)
+  {
+    if (!(rx->rcvd_mask & (1u << idx)))
+      nums[count++] = rx->set_base + idx;
+  }
+  return count;
+}
+
+void coap_bw_rx_next_set(coap_bw_rx_t *rx)
+{
+  if (rx == NULL)
+    return;
+
+  rx->set_base += rx->max_payloads;
+  rx->rcvd_mask = 0;
+}
+
+/*------------------------------------------------------------------------------
+ * Glue for the qapi_Coap_Send_Message_v2() path
+ *----------------------------------------------------------------------------*/
+
+uint16_t coap_bw_option_for_type(qapi_Coap_Block_Wise_Options_t btype, bool qblock)
+{
+  switch (btype)
+  {
+    case QAPI_COAP_BLOCK1_OPTION: return qblock ? COAP_OPTION_Q_BLOCK1 : COAP_OPTION_BLOCK1;
+    case QAPI_COAP_BLOCK2_OPTION: return qblock ? COAP_OPTION_Q_BLOCK2 : COAP_OPTION_BLOCK2;
+    default:                      return 0;
+  }
+}
+
+/* Resolves COAP_BW_BLOCK_SIZE_AUTO against the link estimate of the session.
+ * An explicit block size from the application is kept as is. */
+uint16_t coap_bw_block_size(const coap_bw_link_t *link, qapi_Coap_Packet_t *pkt, uint16_t requested)
+{
+  size_t  hdr_len;
+  uint8_t szx;
+
+  if (requested != COAP_BW_BLOCK_SIZE_AUTO || link == NULL || pkt == NULL)
+    return requested;
+
+  hdr_len = coap_serialize_get_size(pkt);
+  hdr_len = (hdr_len > pkt->payload_len) ? hdr_len - pkt->payload_len : COAP_MAX_HEADER_SIZE;
+
+  szx = coap_bw_select_szx(link, (uint16_t)(hdr_len + COAP_MAX_OPTION_HEADER_LEN));
+  COAP_LOG_DEBUG("blockwise: auto size %d (loss %d/1000, mtu %d)", COAP_BW_SZX_TO_SIZE(szx),
+                 link->loss_pm, link->path_mtu);
+  return COAP_BW_SZX_TO_SIZE(szx);
+}
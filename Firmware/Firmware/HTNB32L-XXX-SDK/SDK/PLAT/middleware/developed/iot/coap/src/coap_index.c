@@ -0,0 +1,475 @@
+/******************************************************************************
+
+  @file    coap_index.c
+  @brief   Hashed MID / token index and RFC 7252 duplicate detection cache
+
+  Responses used to be matched to transactions by walking transactionList
+  and comparing sessions, which is O(n) per received datagram once observe
+  and several requests are in flight. The index keeps (session, MID) and
+  (session, token) keys in a fixed open addressing table so a lookup costs
+  one hash and a short probe run.
+
+  The dedup cache implements RFC 7252 section 4.5: the first copy of a CON
+  or NON is remembered for EXCHANGE_LIFETIME / NON_LIFETIME, duplicates of
+  a CON are answered with the cached response and everything else is
+  dropped. Entries age out on the shared timer wheel.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "coap-internal.h"
+#include "coap_index.h"
+
+static uint32_t coap_idx_mix(uint32_t h)
+{
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h;
+}
+
+static uint32_t coap_idx_hash_mid(void *session, uint16_t mid)
+{
+  return coap_idx_mix((uint32_t)(uintptr_t)session * 0x9E3779B1u ^ ((uint32_t)mid << 8) ^ COAP_IDX_KIND_MID);
+}
+
+static uint32_t coap_idx_hash_token(void *session, const uint8_t *token, uint8_t token_len)
+{
+  uint32_t h = 0x811C9DC5u ^ (uint32_t)(uintptr_t)session;
+  uint8_t  i;
+
+  for (i = 0; i < token_len; i++)
+  {
+    h ^= token[i];
+    h *= 0x01000193u;
+  }
+  return coap_idx_mix(h ^ ((uint32_t)token_len << 24) ^ COAP_IDX_KIND_TOKEN);
+}
+
+static bool coap_idx_match(const coap_idx_entry_t *e, uint32_t hash, uint8_t kind, void *session,
+                           uint16_t mid, const uint8_t *token, uint8_t token_len)
+{
+  if (e->kind != kind || e->hash != hash || e->session != session)
+    return false;
+
+  if (kind == COAP_IDX_KIND_MID)
+    return e->mid == mid;
+
+  return e->token_len == token_len && memcmp(e->token, token, token_len) == 0;
+}
+
+static int coap_idx_lookup(const coap_idx_t *idx, uint32_t hash, uint8_t kind, void *session,
+                           uint16_t mid, const uint8_t *token, uint8_t token_len)
+{
+  uint16_t pos;
+  uint16_t n;
+
+  if (idx->slots == NULL)
+    return -1;
+
+  pos = (uint16_t)(hash & idx->mask);
+  for (n = 0; n <= idx->mask; n++)
+  {
+    const coap_idx_entry_t *e = &idx->slots[pos];
+
+    if (e->kind == COAP_IDX_KIND_EMPTY)
+      return -1;
+    if (coap_idx_match(e, hash, kind, session, mid, token, token_len))
+      return pos;
+    pos = (pos + 1) & idx->mask;
+  }
+  return -1;
+}
+
+static int coap_idx_insert(coap_idx_t *idx, uint32_t hash, uint8_t kind, void *session,
+                           uint16_t mid, const uint8_t *token, uint8_t token_len, void *value)
+{
+  coap_idx_entry_t *e;
+  uint16_t pos;
+
+  if (idx->slots == NULL || token_len > COAP_TOKEN_LEN)
+    return -1;
+
+  if ((uint32_t)(idx->count + 1) * COAP_IDX_LOAD_DEN > (uint32_t)(idx->mask + 1) * COAP_IDX_LOAD_NUM)
+  {
+    idx->overflows++;
+    return -1;
+  }
+
+  pos = (uint16_t)(hash & idx->mask);
+  while (idx->slots[pos].kind != COAP_IDX_KIND_EMPTY)
+  {
+    if (coap_idx_match(&idx->slots[pos], hash, kind, session, mid, token, token_len))
+    {
+      idx->slots[pos].value = value;
+      return 0;
+    }
+    pos = (pos + 1) & idx->mask;
+  }
+
+  e = &idx->slots[pos];
+  e->session   = session;
+  e->value     = value;
+  e->hash      = hash;
+  e->kind      = kind;
+  e->mid       = mid;
+  e->token_len = token_len;
+  if (token_len != 0)
+    memcpy(e->token, token, token_len);
+  idx->count++;
+  return 0;
+}
+
+/* Backward shift deletion: pull later members of the probe run into the
+ * hole as long as that does not move them in front of their home slot. */
+static void coap_idx_remove_at(coap_idx_t *idx, uint16_t hole)
+{
+  uint16_t pos = hole;
+
+  for (;;)
+  {
+    uint16_t home;
+
+    pos = (pos + 1) & idx->mask;
+    if (idx->slots[pos].kind == COAP_IDX_KIND_EMPTY)
+      break;
+
+    home = (uint16_t)(idx->slots[pos].hash & idx->mask);
+    if (((pos - home) & idx->mask) >= ((pos - hole) & idx->mask))
+    {
+      idx->slots[hole] = idx->slots[pos];
+      hole = pos;
+    }
+  }
+
+  memset(&idx->slots[hole], 0, sizeof(coap_idx_entry_t));
+  idx->count--;
+}
+
+int coap_idx_init(coap_idx_t *idx, uint16_t slots)
+{
+  uint16_t size = 8;
+
+  if (idx == NULL || slots == 0 || slots > 0x8000)
+    return -1;
+
+  while (size < slots)
+    size <<= 1;
+
+  memset(idx, 0, sizeof(coap_idx_t));
+  idx->slots = calloc(size, sizeof(coap_idx_entry_t));
+  if (idx->slots == NULL)
+    return -1;
+
+  idx->mask = size - 1;
+  return 0;
+}
+
+void coap_idx_deinit(coap_idx_t *idx)
+{
+  if (idx == NULL)
+    return;
+
+  free(idx->slots);
+  memset(idx, 0, sizeof(coap_idx_t));
+}
+
+void coap_idx_clear(coap_idx_t *idx)
+{
+  if (idx == NULL || idx->slots == NULL)
+    return;
+
+  memset(idx->slots, 0, (idx->mask + 1) * sizeof(coap_idx_entry_t));
+  idx->count = 0;
+}
+
+int coap_idx_add_mid(coap_idx_t *idx, void *session, uint16_t mid, void *value)
+{
+  return coap_idx_insert(idx, coap_idx_hash_mid(session, mid), COAP_IDX_KIND_MID, session, mid, NULL, 0, value);
+}
+
+void * coap_idx_find_mid(const coap_idx_t *idx, void *session, uint16_t mid)
+{
+  int pos = coap_idx_lookup(idx, coap_idx_hash_mid(session, mid), COAP_IDX_KIND_MID, session, mid, NULL, 0);
+
+  return (pos < 0) ? NULL : idx->slots[pos].value;
+}
+
+int coap_idx_del_mid(coap_idx_t *idx, void *session, uint16_t mid)
+{
+  int pos = coap_idx_lookup(idx, coap_idx_hash_mid(session, mid), COAP_IDX_KIND_MID, session, mid, NULL, 0);
+
+  if (pos < 0)
+    return -1;
+
+  coap_idx_remove_at(idx, (uint16_t)pos);
+  return 0;
+}
+
+int coap_idx_add_token(coap_idx_t *idx, void *session, const uint8_t *token, uint8_t token_len, void *value)
+{
+  return coap_idx_insert(idx, coap_idx_hash_token(session, token, token_len), COAP_IDX_KIND_TOKEN,
+                         session, 0, token, token_len, value);
+}
+
+void * coap_idx_find_token(const coap_idx_t *idx, void *session, const uint8_t *token, uint8_t token_len)
+{
+  int pos = coap_idx_lookup(idx, coap_idx_hash_token(session, token, token_len), COAP_IDX_KIND_TOKEN,
+                            session, 0, token, token_len);
+
+  return (pos < 0) ? NULL : idx->slots[pos].value;
+}
+
+int coap_idx_del_token(coap_idx_t *idx, void *session, const uint8_t *token, uint8_t token_len)
+{
+  int pos = coap_idx_lookup(idx, coap_idx_hash_token(session, token, token_len), COAP_IDX_KIND_TOKEN,
+                            session, 0, token, token_len);
+
+  if (pos < 0)
+    return -1;
+
+  coap_idx_remove_at(idx, (uint16_t)pos);
+  return 0;
+}
+
+static void coap_dedup_release(coap_dedup_t *dedup, coap_dedup_entry_t *entry)
+{
+  coap_idx_del_mid(&dedup->idx, entry->session, entry->mid);
+  if (dedup->wheel != NULL)
+    coap_tw_stop(dedup->wheel, &entry->timer);
+
+  free(entry->response);
+  entry->response     = NULL;
+  entry->response_len = 0;
+  entry->session      = NULL;
+  entry->used         = false;
+}
+
+static void coap_dedup_expired(coap_tw_timer_t *timer, void *arg)
+{
+  coap_dedup_entry_t *entry = (coap_dedup_entry_t *)arg;
+  coap_dedup_t *dedup = entry->owner;
+
+  qurt_mutex_lock(&dedup->lock);
+  if (entry->used)
+    coap_dedup_release(dedup, entry);
+  qurt_mutex_unlock(&dedup->lock);
+}
+
+int coap_dedup_init(coap_dedup_t *dedup, uint16_t entries, coap_timer_wheel_t *wheel)
+{
+  uint16_t i;
+
+  if (dedup == NULL || entries == 0)
+    return -1;
+
+  memset(dedup, 0, sizeof(coap_dedup_t));
+  dedup->entries = calloc(entries, sizeof(coap_dedup_entry_t));
+  if (dedup->entries == NULL)
+    return -1;
+
+  /* two slots per entry keeps the (session, MID) table at half load */
+  if (coap_idx_init(&dedup->idx, (uint16_t)(entries * 2)) != 0)
+  {
+    free(dedup->entries);
+    dedup->entries = NULL;
+    return -1;
+  }
+
+  for (i = 0; i < entries; i++)
+  {
+    dedup->entries[i].owner = dedup;
+    coap_tw_timer_init(&dedup->entries[i].timer, COAP_TW_KIND_DEDUP_EXPIRY, coap_dedup_expired, &dedup->entries[i]);
+  }
+
+  dedup->capacity = entries;
+  dedup->wheel    = wheel;
+  qurt_mutex_init(&dedup->lock);
+  return 0;
+}
+
+void coap_dedup_deinit(coap_dedup_t *dedup)
+{
+  uint16_t i;
+
+  if (dedup == NULL || dedup->entries == NULL)
+    return;
+
+  qurt_mutex_lock(&dedup->lock);
+  for (i = 0; i < dedup->capacity; i++)
+  {
+    if (dedup->entries[i].used)
+      coap_dedup_release(dedup, &dedup->entries[i]);
+  }
+  free(dedup->entries);
+  dedup->entries = NULL;
+  coap_idx_deinit(&dedup->idx);
+  qurt_mutex_unlock(&dedup->lock);
+
+  qurt_mutex_destroy(&dedup->lock);
+}
+
+/* Looks up (session, MID). A first copy is recorded for lifetime_ms and
+ * COAP_DEDUP_NEW returned. For a duplicate the cached response, if any, is
+ * copied into buf so the caller can resend it without holding the lock. */
+coap_dedup_result_t coap_dedup_check(coap_dedup_t *dedup, void *session, uint16_t mid, uint32_t lifetime_ms,
+                                     uint8_t *buf, size_t buf_len, size_t *resp_len)
+{
+  coap_dedup_entry_t *entry;
+  coap_dedup_result_t result = COAP_DEDUP_NEW;
+
+  if (resp_len != NULL)
+    *resp_len = 0;
+
+  if (dedup == NULL || dedup->entries == NULL)
+    return COAP_DEDUP_NEW;
+
+  qurt_mutex_lock(&dedup->lock);
+
+  entry = (coap_dedup_entry_t *)coap_idx_find_mid(&dedup->idx, session, mid);
+  if (entry != NULL)
+  {
+    if (entry->response != NULL && buf != NULL && entry->response_len <= buf_len)
+    {
+      memcpy(buf, entry->response, entry->response_len);
+      if (resp_len != NULL)
+        *resp_len = entry->response_len;
+      dedup->replayed++;
+      result = COAP_DEDUP_REPLAY;
+    }
+    else
+    {
+      dedup->dropped++;
+      result = COAP_DEDUP_IN_PROGRESS;
+    }
+    qurt_mutex_unlock(&dedup->lock);
+    return result;
+  }
+
+  entry = &dedup->entries[dedup->head];
+  if (entry->used)
+    coap_dedup_release(dedup, entry);
+
+  if (coap_idx_add_mid(&dedup->idx, session, mid, entry) == 0)
+  {
+    entry->session = session;
+    entry->mid     = mid;
+    entry->used    = true;
+    if (dedup->wheel != NULL)
+      coap_tw_start(dedup->wheel, &entry->timer, lifetime_ms);
+    dedup->head = (uint16_t)((dedup->head + 1) % dedup->capacity);
+  }
+
+  qurt_mutex_unlock(&dedup->lock);
+  return result;
+}
+
+/* Keeps a copy of the serialized ACK / response sent for (session, MID). */
+int coap_dedup_store_response(coap_dedup_t *dedup, void *session, uint16_t mid, const uint8_t *response, size_t len)
+{
+  coap_dedup_entry_t *entry;
+  int ret = -1;
+
+  if (dedup == NULL || dedup->entries == NULL || response == NULL || len == 0 || len > COAP_DEDUP_MAX_RESPONSE)
+    return -1;
+
+  qurt_mutex_lock(&dedup->lock);
+  entry = (coap_dedup_entry_t *)coap_idx_find_mid(&dedup->idx, session, mid);
+  if (entry != NULL)
+  {
+    uint8_t *copy = (uint8_t *)malloc(len);
+
+    if (copy != NULL)
+    {
+      memcpy(copy, response, len);
+      free(entry->response);
+      entry->response     = copy;
+      entry->response_len = (uint16_t)len;
+      ret = 0;
+    }
+  }
+  qurt_mutex_unlock(&dedup->lock);
+  return ret;
+}
+
+/* Registers an outgoing CON / NON with the transaction index of its client
+ * context. ACK and RST are matched on MID, separate and NON responses on
+ * token. */
+int coap_index_transaction_add(coap_idx_t * idx, coap_transaction_t * transacP)
+{
+  coap_packet_t * message;
+
+  if (idx == NULL || transacP == NULL || transacP->message == NULL)
+    return -1;
+
+  message = (coap_packet_t *)transacP->message;
+
+  if (coap_idx_add_mid(idx, transacP->sessionH, transacP->mID, transacP) != 0)
+  {
+    COAP_LOG_DEBUG("trans_idx full, mid %d falls back to list walk", transacP->mID);
+    return -1;
+  }
+
+  if (message->token_len != 0 &&
+      coap_idx_add_token(idx, transacP->sessionH, message->token, message->token_len, transacP) != 0)
+  {
+    coap_idx_del_mid(idx, transacP->sessionH, transacP->mID);
+    return -1;
+  }
+  return 0;
+}
+
+void coap_index_transaction_remove(coap_idx_t * idx, coap_transaction_t * transacP)
+{
+  coap_packet_t * message;
+
+  if (idx == NULL || transacP == NULL)
+    return;
+
+  coap_idx_del_mid(idx, transacP->sessionH, transacP->mID);
+
+  message = (coap_packet_t *)transacP->message;
+  if (message != NULL && message->token_len != 0 &&
+      coap_idx_find_token(idx, transacP->sessionH, message->token, message->token_len) == transacP)
+    coap_idx_del_token(idx, transacP->sessionH, message->token, message->token_len);
+}
+
+/* Returns the transaction an incoming message answers, NULL when the
+ * index has no entry (the caller then walks transactionList as before). */
+coap_transaction_t * coap_index_transaction_find(const coap_idx_t * idx, void * sessionH, coap_packet_t * message)
+{
+  coap_transaction_t * transacP = NULL;
+
+  if (idx == NULL || message == NULL)
+    return NULL;
+
+  if (message->type == COAP_TYPE_ACK || message->type == COAP_TYPE_RST)
+    transacP = (coap_transaction_t *)coap_idx_find_mid(idx, sessionH, message->mid);
+
+  if (transacP == NULL && message->type != COAP_TYPE_RST && message->token_len != 0)
+    transacP = (coap_transaction_t *)coap_idx_find_token(idx, sessionH, message->token, message->token_len);
+
+  return transacP;
+}
+
+/* exchange_lifetime_s is the configured EXCHANGE_LIFETIME of the client
+ * context, 0 for the RFC 7252 default. */
+uint32_t coap_dedup_lifetime_ms(uint32_t exchange_lifetime_s, coap_message_type_t type)
+{
+  if (type == COAP_TYPE_CON)
+  {
+    if (exchange_lifetime_s != 0)
+      return exchange_lifetime_s * 1000;
+    return COAP_DEDUP_EXCHANGE_LIFETIME_MS;
+  }
+  return COAP_DEDUP_NON_LIFETIME_MS;
+}
@@ -0,0 +1,354 @@
+/******************************************************************************
+
+  @file    coap_timer.c
+  @brief   Hierarchical timer wheel for CoAP / LwM2M protocol deadlines
+
+  Every retransmission, exchange-lifetime, dedup-expiry and LwM2M deadline
+  is a coap_tw_timer_t embedded in its owner and hashed into one wheel.
+  Arming and stopping are O(1). The next deadline is found with one
+  rotate + count-trailing-zeros per level, so the task can block on its
+  signal exactly until then and FreeRTOS tickless idle sleeps the whole
+  interval instead of waking up every poll period.
+
+  A timer in level L > 0 is only known to fall inside a 64^L tick slot,
+  the wheel therefore reports the slot start for those. Waking up there
+  costs one cascade and the wait is re-armed with the exact value.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "coap_timer.h"
+
+static coap_timer_wheel_t coap_default_wheel;
+static bool coap_default_wheel_init = false;
+
+static void coap_tw_link(coap_timer_wheel_t *wheel, coap_tw_timer_t *timer)
+{
+  uint32_t delta = timer->expires - wheel->now;
+  uint8_t  level = 0;
+  uint8_t  slot;
+
+  while (level < COAP_TW_LEVELS - 1 && (delta >> (COAP_TW_SLOT_BITS * (level + 1))) != 0)
+    level++;
+
+  slot = (uint8_t)((timer->expires >> (COAP_TW_SLOT_BITS * level)) & COAP_TW_SLOT_MASK);
+
+  timer->level = level;
+  timer->slot  = slot;
+  timer->next  = wheel->slots[level][slot];
+  if (timer->next != NULL)
+    timer->next->pprev = &timer->next;
+  timer->pprev = &wheel->slots[level][slot];
+  wheel->slots[level][slot] = timer;
+  wheel->occupied[level] |= ((uint64_t)1 << slot);
+}
+
+static void coap_tw_unlink(coap_timer_wheel_t *wheel, coap_tw_timer_t *timer)
+{
+  *timer->pprev = timer->next;
+  if (timer->next != NULL)
+    timer->next->pprev = timer->pprev;
+
+  if (timer->level != COAP_TW_DETACHED && wheel->slots[timer->level][timer->slot] == NULL)
+    wheel->occupied[timer->level] &= ~((uint64_t)1 << timer->slot);
+
+  timer->next  = NULL;
+  timer->pprev = NULL;
+}
+
+/* Takes a whole slot off the wheel. The returned chain keeps valid pprev
+ * links into *head so coap_tw_stop() works on it from a callback. */
+static void coap_tw_detach_slot(coap_timer_wheel_t *wheel, uint8_t level, uint8_t slot, coap_tw_timer_t **head)
+{
+  coap_tw_timer_t *timer;
+
+  *head = wheel->slots[level][slot];
+  wheel->slots[level][slot] = NULL;
+  wheel->occupied[level] &= ~((uint64_t)1 << slot);
+
+  if (*head != NULL)
+    (*head)->pprev = head;
+  for (timer = *head; timer != NULL; timer = timer->next)
+    timer->level = COAP_TW_DETACHED;
+}
+
+/* Earliest tick at which something has to happen: a level 0 expiry or a
+ * level L cascade. */
+static bool coap_tw_next_event(const coap_timer_wheel_t *wheel, uint32_t *tick)
+{
+  uint8_t  level;
+  bool     found = false;
+  uint32_t best = 0;
+
+  for (level = 0; level < COAP_TW_LEVELS; level++)
+  {
+    uint64_t occ = wheel->occupied[level];
+    uint8_t  shift = COAP_TW_SLOT_BITS * level;
+    uint32_t cur;
+    uint8_t  start;
+    uint32_t cand;
+
+    if (occ == 0)
+      continue;
+
+    cur   = wheel->now >> shift;
+    start = (uint8_t)((cur + 1) & COAP_TW_SLOT_MASK);
+    if (start != 0)
+      occ = (occ >> start) | (occ << (COAP_TW_SLOTS - start));
+
+    cand = (cur + 1 + (uint32_t)__builtin_ctzll(occ)) << shift;
+    if (!found || (int32_t)(cand - wheel->now) < (int32_t)(best - wheel->now))
+    {
+      best  = cand;
+      found = true;
+    }
+  }
+
+  if (found)
+    *tick = best;
+  return found;
+}
+
+static void coap_tw_process_tick(coap_timer_wheel_t *wheel, uint32_t *fired)
+{
+  coap_tw_timer_t *head;
+  coap_tw_timer_t *timer;
+  int8_t level;
+
+  /* Top-down, a level 2 cascade may refill the level 1 slot due now. */
+  for (level = COAP_TW_LEVELS - 1; level > 0; level--)
+  {
+    uint8_t shift = COAP_TW_SLOT_BITS * level;
+    uint8_t slot;
+
+    if ((wheel->now & ((1uL << shift) - 1u)) != 0)
+      continue;
+
+    slot = (uint8_t)((wheel->now >> shift) & COAP_TW_SLOT_MASK);
+    if (!(wheel->occupied[level] & ((uint64_t)1 << slot)))
+      continue;
+
+    coap_tw_detach_slot(wheel, level, slot, &head);
+    while ((timer = head) != NULL)
+    {
+      coap_tw_unlink(wheel, timer);
+      coap_tw_link(wheel, timer);
+    }
+  }
+
+  coap_tw_detach_slot(wheel, 0, (uint8_t)(wheel->now & COAP_TW_SLOT_MASK), &head);
+  while ((timer = head) != NULL)
+  {
+    coap_tw_unlink(wheel, timer);
+    if (timer->expires != wheel->now)
+    {
+      coap_tw_link(wheel, timer);
+      continue;
+    }
+
+    wheel->armed--;
+    wheel->armed_kind[timer->kind]--;
+    wheel->fired++;
+    (*fired)++;
+
+    /* The owner may re-arm, stop or free timers from its callback. */
+    qurt_mutex_unlock(&wheel->lock);
+    timer->cb(timer, timer->arg);
+    qurt_mutex_lock(&wheel->lock);
+  }
+}
+
+uint32_t coap_tw_now_ms(void)
+{
+  uint32_t ticks = osKernelGetTickCount();
+  uint32_t freq  = osKernelGetTickFreq();
+
+  if (freq == 1000u || freq == 0)
+    return ticks;
+  return (uint32_t)((uint64_t)ticks * 1000u / freq);
+}
+
+void coap_tw_init(coap_timer_wheel_t *wheel, coap_tw_clock_t clock)
+{
+  if (wheel == NULL)
+    return;
+
+  memset(wheel, 0, sizeof(coap_timer_wheel_t));
+  wheel->clock  = (clock != NULL) ? clock : coap_tw_now_ms;
+  wheel->now_ms = wheel->clock();
+  qurt_mutex_init(&wheel->lock);
+}
+
+void coap_tw_deinit(coap_timer_wheel_t *wheel)
+{
+  if (wheel == NULL)
+    return;
+
+  qurt_mutex_destroy(&wheel->lock);
+  memset(wheel, 0, sizeof(coap_timer_wheel_t));
+}
+
+void coap_tw_timer_init(coap_tw_timer_t *timer, coap_tw_kind_t kind, coap_tw_callback_t cb, void *arg)
+{
+  if (timer == NULL)
+    return;
+
+  memset(timer, 0, sizeof(coap_tw_timer_t));
+  timer->kind = (uint8_t)((kind < COAP_TW_KIND_MAX) ? kind : COAP_TW_KIND_LWM2M);
+  timer->cb   = cb;
+  timer->arg  = arg;
+}
+
+bool coap_tw_is_armed(const coap_tw_timer_t *timer)
+{
+  return (timer != NULL && timer->pprev != NULL);
+}
+
+void coap_tw_start(coap_timer_wheel_t *wheel, coap_tw_timer_t *timer, uint32_t delay_ms)
+{
+  uint32_t lag;
+  uint32_t ticks;
+
+  if (wheel == NULL || timer == NULL || timer->cb == NULL)
+    return;
+
+  qurt_mutex_lock(&wheel->lock);
+
+  if (timer->pprev != NULL)
+  {
+    coap_tw_unlink(wheel, timer);
+    wheel->armed--;
+    wheel->armed_kind[timer->kind]--;
+  }
+
+  /* The wheel only moves in coap_tw_advance(), account for the time
+   * elapsed since then so the deadline is relative to the real clock. */
+  lag   = (wheel->clock() - wheel->now_ms) / COAP_TW_TICK_MS;
+  ticks = delay_ms / COAP_TW_TICK_MS + ((delay_ms % COAP_TW_TICK_MS) != 0);
+  if (ticks == 0)
+    ticks = 1;
+  ticks += lag;
+  if (ticks > COAP_TW_MAX_DELAY_TICKS)
+    ticks = COAP_TW_MAX_DELAY_TICKS;
+
+  timer->expires = wheel->now + ticks;
+  coap_tw_link(wheel, timer);
+  wheel->armed++;
+  wheel->armed_kind[timer->kind]++;
+
+  qurt_mutex_unlock(&wheel->lock);
+}
+
+void coap_tw_stop(coap_timer_wheel_t *wheel, coap_tw_timer_t *timer)
+{
+  if (wheel == NULL || timer == NULL)
+    return;
+
+  qurt_mutex_lock(&wheel->lock);
+  if (timer->pprev != NULL)
+  {
+    coap_tw_unlink(wheel, timer);
+    wheel->armed--;
+    wheel->armed_kind[timer->kind]--;
+  }
+  qurt_mutex_unlock(&wheel->lock);
+}
+
+/* Runs every timer that is due. Idle stretches are skipped in one jump per
+ * pending event, not tick by tick. Returns the number of callbacks run. */
+uint32_t coap_tw_advance(coap_timer_wheel_t *wheel)
+{
+  uint32_t fired = 0;
+  uint32_t steps;
+  uint32_t target;
+  uint32_t tick;
+
+  if (wheel == NULL)
+    return 0;
+
+  qurt_mutex_lock(&wheel->lock);
+
+  steps  = (wheel->clock() - wheel->now_ms) / COAP_TW_TICK_MS;
+  target = wheel->now + steps;
+
+  while (coap_tw_next_event(wheel, &tick) && (int32_t)(tick - target) <= 0)
+  {
+    wheel->now_ms += (tick - wheel->now) * COAP_TW_TICK_MS;
+    wheel->now     = tick;
+    coap_tw_process_tick(wheel, &fired);
+  }
+
+  wheel->now_ms += (target - wheel->now) * COAP_TW_TICK_MS;
+  wheel->now     = target;
+
+  qurt_mutex_unlock(&wheel->lock);
+  return fired;
+}
+
+/* Milliseconds until coap_tw_advance() has work, 0 if overdue and
+ * COAP_TW_NO_DEADLINE when the wheel is empty. */
+uint32_t coap_tw_next_deadline_ms(coap_timer_wheel_t *wheel)
+{
+  uint32_t tick;
+  uint32_t due_ms;
+  int32_t  remaining;
+
+  if (wheel == NULL)
+    return COAP_TW_NO_DEADLINE;
+
+  qurt_mutex_lock(&wheel->lock);
+  if (!coap_tw_next_event(wheel, &tick))
+  {
+    qurt_mutex_unlock(&wheel->lock);
+    return COAP_TW_NO_DEADLINE;
+  }
+
+  due_ms    = wheel->now_ms + (tick - wheel->now) * COAP_TW_TICK_MS;
+  remaining = (int32_t)(due_ms - wheel->clock());
+  qurt_mutex_unlock(&wheel->lock);
+
+  return (remaining > 0) ? (uint32_t)remaining : 0;
+}
+
+coap_timer_wheel_t * coap_tw_default(void)
+{
+  if (!coap_default_wheel_init)
+  {
+    coap_tw_init(&coap_default_wheel, NULL);
+    coap_default_wheel_init = true;
+  }
+  return &coap_default_wheel;
+}
+
+/* Timeout for qurt_signal_wait_timed_ext() in the CoAP / LwM2M task loop.
+ * Blocking exactly this long is what lets tickless idle sleep through. */
+qurt_time_t coap_tw_wait_ticks(void)
+{
+  uint32_t ms = coap_tw_next_deadline_ms(coap_tw_default());
+
+  if (ms == COAP_TW_NO_DEADLINE)
+    return QURT_TIME_WAIT_FOREVER;
+  return qurt_timer_convert_time_to_ticks(ms, QURT_TIME_MSEC);
+}
+
+/* RFC 7252 section 4.2: initial timeout is random in
+ * [ACK_TIMEOUT, ACK_TIMEOUT * ACK_RANDOM_FACTOR], doubled per retransmission. */
+uint32_t coap_tw_retransmit_delay_ms(uint32_t ack_timeout_s, double ack_random_factor, uint8_t retrans_counter)
+{
+  uint32_t base_ms = ack_timeout_s * 1000u;
+  uint32_t spread  = 0;
+
+  if (ack_random_factor > 1.0)
+    spread = (uint32_t)((double)base_ms * (ack_random_factor - 1.0) * ((double)rand() / (double)RAND_MAX));
+
+  if (retrans_counter > 16)
+    retrans_counter = 16;
+  return (base_ms + spread) << retrans_counter;
+}
@@ -1,8 +1,11 @@
 #ifndef _QURT_NETWORK_H
 #define _QURT_NETWORK_H
 
+#include <string.h>
 #include "sockets.h"
 #include "netdb.h"
+#include "api.h"
+#include "pbuf.h"
 
 #define QAPI_OK 0
 
@@ -59,4 +62,213 @@ static inline int qapi_select(fd_set *rd, fd_set *wr, fd_set *ex, int32_t timeou
 	return lwip_select(FD_SETSIZE, rd, wr, ex, &timeout);
 }
 
+/*
+ * Zero-copy receive.
+ *
+ * The socket calls above copy every datagram or segment out of the lwIP
+ * pbufs into a caller buffer. A connection opened with qapi_nc_new() hands
+ * the received pbuf chain itself to the caller instead, which parses it in
+ * place with a qapi_pbuf_reader_t and gives it back with
+ * qapi_pbuf_release(). Until then the chain counts against PBUF_POOL, so
+ * release it as soon as the message is parsed.
+ */
+typedef struct netconn *qapi_nc_t;
+
+/* type is SOCK_DGRAM or SOCK_STREAM, family AF_INET or AF_INET6 */
+static inline qapi_nc_t qapi_nc_new(int32_t family, int32_t type)
+{
+	enum netconn_type t = (type == SOCK_STREAM) ? NETCONN_TCP : NETCONN_UDP;
+
+#if LWIP_IPV6
+	if (family == AF_INET6)
+		t = (enum netconn_type)(t | NETCONN_TYPE_IPV6);
+#endif
+	return netconn_new(t);
+}
+
+static inline int qapi_nc_bind(qapi_nc_t nc, const ip_addr_t *addr, uint16_t port)
+{
+	return netconn_bind(nc, addr, port);
+}
+
+static inline int qapi_nc_connect(qapi_nc_t nc, const ip_addr_t *addr, uint16_t port)
+{
+	return netconn_connect(nc, addr, port);
+}
+
+/* 0 blocks until data arrives */
+static inline void qapi_nc_set_recvtimeout(qapi_nc_t nc, int32_t timeout_ms)
+{
+	netconn_set_recvtimeout(nc, timeout_ms);
+}
+
+static inline int qapi_nc_close(qapi_nc_t nc)
+{
+	if (NETCONNTYPE_GROUP(netconn_type(nc)) == NETCONN_TCP)
+		netconn_close(nc);
+	return netconn_delete(nc);
+}
+
+/*
+ * On QAPI_OK *pP holds the only reference the caller has to the received
+ * chain: one datagram for UDP, whatever the stack has queued for TCP.
+ * from and port may be NULL. Returns an lwIP err_t otherwise, ERR_TIMEOUT
+ * once the receive timeout expires.
+ */
+static inline int qapi_nc_recv(qapi_nc_t nc, struct pbuf **pP, ip_addr_t *from, uint16_t *port)
+{
+	struct netbuf *buf = NULL;
+	err_t err;
+
+	*pP = NULL;
+	if (NETCONNTYPE_GROUP(netconn_type(nc)) == NETCONN_TCP)
+	{
+		err = netconn_recv_tcp_pbuf(nc, pP);
+		if (err == ERR_OK && (from != NULL || port != NULL))
+		{
+			ip_addr_t addr;
+			u16_t p;
+
+			if (netconn_peer(nc, &addr, &p) == ERR_OK)
+			{
+				if (from != NULL)
+					ip_addr_copy(*from, addr);
+				if (port != NULL)
+					*port = p;
+			}
+		}
+		return err;
+	}
+
+	err = netconn_recv(nc, &buf);
+	if (err != ERR_OK)
+		return err;
+
+	if (from != NULL)
+		ip_addr_copy(*from, *netbuf_fromaddr(buf));
+	if (port != NULL)
+		*port = netbuf_fromport(buf);
+
+	/* Take the netbuf's reference instead of adding one */
+	*pP = buf->p;
+	buf->p = NULL;
+	buf->ptr = NULL;
+	netbuf_delete(buf);
+	return QAPI_OK;
+}
+
+/* UDP: to/port are used when not connected. The data is not copied. */
+static inline int qapi_nc_send(qapi_nc_t nc, const void *data, uint16_t len, const ip_addr_t *to, uint16_t port)
+{
+	struct netbuf *buf;
+	err_t err;
+
+	if (NETCONNTYPE_GROUP(netconn_type(nc)) == NETCONN_TCP)
+	{
+		/* netconn_write() lacks the sequence argument with ENABLE_PSIF */
+#if ENABLE_PSIF
+		return netconn_write_partly(nc, data, len, NETCONN_COPY, NULL, 0, 0, 0);
+#else
+		return netconn_write_partly(nc, data, len, NETCONN_COPY, NULL);
+#endif
+	}
+
+	buf = netbuf_new();
+	if (buf == NULL)
+		return ERR_MEM;
+	err = netbuf_ref(buf, data, len);
+	if (err == ERR_OK)
+		err = (to != NULL) ? netconn_sendto(nc, buf, to, port) : netconn_send(nc, buf);
+	netbuf_delete(buf);
+	return err;
+}
+
+static inline void qapi_pbuf_release(struct pbuf *p)
+{
+	if (p != NULL)
+		pbuf_free(p);
+}
+
+/* Sequential reader over a pbuf chain, does not take a reference */
+typedef struct
+{
+	struct pbuf *p;     /* pbuf holding the next byte */
+	uint16_t     off;   /* offset of the next byte in p */
+	uint32_t     left;  /* bytes left in the chain */
+} qapi_pbuf_reader_t;
+
+static inline uint32_t qapi_pbuf_reader_left(const qapi_pbuf_reader_t *r)
+{
+	return r->left;
+}
+
+static inline void qapi_pbuf_reader_advance(qapi_pbuf_reader_t *r, uint32_t n)
+{
+	r->left -= n;
+	r->off += (uint16_t)n;
+	while (r->p != NULL && r->off >= r->p->len && r->left > 0)
+	{
+		r->off -= r->p->len;
+		r->p = r->p->next;
+	}
+}
+
+static inline void qapi_pbuf_reader_init(qapi_pbuf_reader_t *r, struct pbuf *p)
+{
+	r->p = p;
+	r->off = 0;
+	r->left = (p != NULL) ? p->tot_len : 0;
+	qapi_pbuf_reader_advance(r, 0);
+}
+
+/* Returns -1 at the end of the chain */
+static inline int qapi_pbuf_read_u8(qapi_pbuf_reader_t *r)
+{
+	uint8_t v;
+
+	if (r->left == 0)
+		return -1;
+	v = ((const uint8_t *)r->p->payload)[r->off];
+	qapi_pbuf_reader_advance(r, 1);
+	return v;
+}
+
+/*
+ * Pointer to the next len bytes if they sit in one pbuf, which is the case
+ * for most headers and for whole datagrams smaller than a pool buffer. The
+ * reader moves past them. NULL if they straddle pbufs or the chain is
+ * shorter, and the reader does not move; use qapi_pbuf_read() then.
+ */
+static inline const uint8_t *qapi_pbuf_contig(qapi_pbuf_reader_t *r, uint32_t len)
+{
+	const uint8_t *ptr;
+
+	if (len > r->left || r->p == NULL || (uint32_t)r->off + len > r->p->len)
+		return NULL;
+	ptr = (const uint8_t *)r->p->payload + r->off;
+	qapi_pbuf_reader_advance(r, len);
+	return ptr;
+}
+
+/* Copy up to len bytes out, or skip them if dst is NULL. Returns the count. */
+static inline uint32_t qapi_pbuf_read(qapi_pbuf_reader_t *r, void *dst, uint32_t len)
+{
+	uint32_t done = 0;
+
+	if (len > r->left)
+		len = r->left;
+	while (done < len)
+	{
+		uint32_t n = r->p->len - r->off;
+
+		if (n > len - done)
+			n = len - done;
+		if (dst != NULL)
+			memcpy((uint8_t *)dst + done, (const uint8_t *)r->p->payload + r->off, n);
+		qapi_pbuf_reader_advance(r, n);
+		done += n;
+	}
+	return done;
+}
+
 #endif //_QURT_NETWORK_H
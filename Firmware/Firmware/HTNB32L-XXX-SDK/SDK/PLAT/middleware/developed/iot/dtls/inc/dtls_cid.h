@@ -0,0 +1,65 @@
+/******************************************************************************
+
+  @file    dtls_cid.h
+  @brief   DTLS Connection ID and session persistence across hibernate
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#ifndef _DTLS_CID_H
+#define _DTLS_CID_H
+
+#include <stdbool.h>
+#include "mbedtls/ssl.h"
+#include "qapi_mbedtls.h"
+
+/* Length of the CID the device asks the server to put in its records.
+ * The device keeps its address towards the server's view only through the
+ * server CID, so its own can stay empty. */
+#ifndef DTLS_CID_OWN_LEN
+#define DTLS_CID_OWN_LEN          0
+#endif
+
+/* The bundled mbed TLS 2.23 negotiates the CID with the code point of
+ * draft-ietf-tls-dtls-connection-id-05 (254), not the one of RFC 9146 (54),
+ * so only servers that still accept the draft extension agree on a CID.
+ * mbedtls_ssl_context_load() refuses sessions saved by another library
+ * version, so an upgrade to RFC 9146 falls back to a handshake. */
+#define DTLS_CID_EXT_DRAFT_05     254
+
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID) && (MBEDTLS_TLS_EXT_CID != DTLS_CID_EXT_DRAFT_05)
+#error "dtls_cid targets the draft-05 Connection ID extension of mbed TLS 2.23"
+#endif
+
+#define DTLS_CID_STORE_MAGIC      0x44434944   /* "DCID" */
+#define DTLS_CID_STORE_VERSION    1
+#define DTLS_CID_STORE_MAX_LEN    1024
+
+#define DTLS_CID_STORE_PATH_LEN   48
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t len;                /* bytes of mbedtls_ssl_context_save() output that follow */
+} dtls_cid_store_hdr_t;
+
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
+int dtls_cid_conf(mbedtls_ssl_config * conf);
+int dtls_cid_enable(mbedtls_ssl_context * ssl);
+bool dtls_cid_in_use(mbedtls_ssl_context * ssl);
+#endif
+
+#if defined(MBEDTLS_SSL_CONTEXT_SERIALIZATION)
+int dtls_cid_store_path(char * path, size_t len, const char * host, uint16_t port);
+int dtls_cid_suspend(mbedtls_ssl_context * ssl, const char * path);
+int dtls_cid_resume(mbedtls_ssl_context * ssl, const char * path);
+void dtls_cid_forget(const char * path);
+#endif
+
+#endif
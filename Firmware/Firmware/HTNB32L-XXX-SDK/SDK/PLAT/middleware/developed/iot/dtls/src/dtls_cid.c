@@ -0,0 +1,234 @@
+/******************************************************************************
+
+  @file    dtls_cid.c
+  @brief   DTLS Connection ID and session persistence across hibernate
+
+  After PSM or a long eDRX sleep the carrier NAT usually hands the device a
+  new UDP port. Without a Connection ID the server can no longer map the
+  records to the DTLS connection and the device runs a full 4-6 flight
+  handshake before its first CoAP message.
+
+  With the CID negotiated, the server identifies the connection by the CID
+  carried in each record, whatever the source address. What is left is
+  surviving hibernate, which loses RAM: dtls_cid_suspend() serializes the
+  established connection (keys, epoch, record counters, CIDs) into a file
+  right before sleep and dtls_cid_resume() loads it on wake-up, so that the
+  first datagram after wake-up is already application data.
+
+  The file is consumed when it is loaded. A connection that is resumed and
+  then lost without another suspend therefore falls back to a handshake
+  instead of reusing record sequence numbers the server has already seen.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "dtls_cid.h"
+#include "mbedtls/platform_util.h"
+#include "qurt_fs.h"
+#include "iotapp_log_util.h"
+
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
+
+int dtls_cid_conf(mbedtls_ssl_config * conf)
+{
+  if (conf == NULL)
+    return DTLS_INVALID_PARAM;
+
+  /* Records with an unexpected CID are dropped silently, as a stray
+   * datagram on a rebound port must not tear the connection down. */
+  if (mbedtls_ssl_conf_cid(conf, DTLS_CID_OWN_LEN, MBEDTLS_SSL_UNEXPECTED_CID_IGNORE) != 0)
+    return DTLS_FAILURE;
+  return DTLS_OK;
+}
+
+int dtls_cid_enable(mbedtls_ssl_context * ssl)
+{
+  unsigned char own_cid[DTLS_CID_OWN_LEN + 1] = { 0 };
+  int ret;
+
+  if (ssl == NULL || ssl->conf == NULL)
+    return DTLS_INVALID_PARAM;
+
+#if DTLS_CID_OWN_LEN > 0
+  ret = ssl->conf->f_rng(ssl->conf->p_rng, own_cid, DTLS_CID_OWN_LEN);
+  if (ret != 0)
+    return DTLS_FAILURE;
+#endif
+
+  ret = mbedtls_ssl_set_cid(ssl, MBEDTLS_SSL_CID_ENABLED, own_cid, DTLS_CID_OWN_LEN);
+  if (ret != 0)
+  {
+    IOTAPP_LOG_ERR("DTLS CID enable failed %d", ret);
+    return DTLS_FAILURE;
+  }
+  return DTLS_OK;
+}
+
+/* True once the handshake agreed on a CID. Servers that do not support the
+ * extension leave it disabled and the connection works as before. */
+bool dtls_cid_in_use(mbedtls_ssl_context * ssl)
+{
+  int enabled = MBEDTLS_SSL_CID_DISABLED;
+
+  if (ssl == NULL || mbedtls_ssl_get_peer_cid(ssl, &enabled, NULL, NULL) != 0)
+    return false;
+  return enabled == MBEDTLS_SSL_CID_ENABLED;
+}
+
+#endif /* MBEDTLS_SSL_DTLS_CONNECTION_ID */
+
+#if defined(MBEDTLS_SSL_CONTEXT_SERIALIZATION)
+
+int dtls_cid_store_path(char * path, size_t len, const char * host, uint16_t port)
+{
+  size_t i;
+  int n;
+
+  if (path == NULL || host == NULL)
+    return DTLS_INVALID_PARAM;
+
+  n = snprintf(path, len, "dtls_%s_%u.ses", host, port);
+  if (n < 0 || (size_t)n >= len)
+    return DTLS_BAD_INPUT;
+
+  /* IPv6 literals and host names carry characters we keep out of names. */
+  for (i = 0; path[i] != '\0'; i++)
+  {
+    if (path[i] == ':' || path[i] == '/' || path[i] == '[' || path[i] == ']')
+      path[i] = '_';
+  }
+  return DTLS_OK;
+}
+
+/* Serialize ssl into path. mbedtls_ssl_context_save() also resets ssl, so
+ * this is the last thing done with the connection before sleep. */
+int dtls_cid_suspend(mbedtls_ssl_context * ssl, const char * path)
+{
+  dtls_cid_store_hdr_t hdr;
+  unsigned char * buf = NULL;
+  size_t olen = 0;
+  int fd;
+  int ret;
+
+  if (ssl == NULL || path == NULL)
+    return DTLS_INVALID_PARAM;
+
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
+  /* Without a CID the saved keys are useless once the NAT rebinds. */
+  if (!dtls_cid_in_use(ssl))
+    return DTLS_INVALID_STATE;
+#endif
+
+  ret = mbedtls_ssl_context_save(ssl, NULL, 0, &olen);
+  if (ret != MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL || olen == 0 || olen > DTLS_CID_STORE_MAX_LEN)
+  {
+    IOTAPP_LOG_ERR("DTLS suspend: cannot save context %d len %d", ret, olen);
+    return DTLS_INVALID_STATE;
+  }
+
+  buf = malloc(olen);
+  if (buf == NULL)
+    return DTLS_MEMORY_ERROR;
+
+  ret = mbedtls_ssl_context_save(ssl, buf, olen, &olen);
+  if (ret != 0)
+  {
+    free(buf);
+    return DTLS_FAILURE;
+  }
+
+  hdr.magic   = DTLS_CID_STORE_MAGIC;
+  hdr.version = DTLS_CID_STORE_VERSION;
+  hdr.len     = (uint16_t)olen;
+
+  ret = DTLS_FAILURE;
+  fd = efs_open(path, O_CREAT | O_WRONLY | O_TRUNC);
+  if (fd > 0)
+  {
+    if (efs_write(fd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+        efs_write(fd, buf, olen) == (fs_ssize_t)olen)
+      ret = DTLS_OK;
+    efs_close(fd);
+  }
+
+  /* The keys are in buf, do not leave them on the heap. A memset() right
+   * before free() is a dead store the compiler may drop. */
+  mbedtls_platform_zeroize(buf, olen);
+  free(buf);
+
+  if (ret != DTLS_OK)
+  {
+    efs_unlink(path);
+    IOTAPP_LOG_ERR("DTLS suspend: write of %s failed", path);
+  }
+  return ret;
+}
+
+/* Load the connection saved by dtls_cid_suspend() into ssl, which must have
+ * been set up with the same mbedtls_ssl_config. On any failure the caller
+ * runs a normal handshake. */
+int dtls_cid_resume(mbedtls_ssl_context * ssl, const char * path)
+{
+  dtls_cid_store_hdr_t hdr;
+  unsigned char * buf = NULL;
+  int fd;
+  int ret = DTLS_FAILURE;
+
+  if (ssl == NULL || path == NULL)
+    return DTLS_INVALID_PARAM;
+
+  fd = efs_open(path, O_RDONLY);
+  if (fd <= 0)
+    return DTLS_FAILURE;
+
+  if (efs_read(fd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+      hdr.magic == DTLS_CID_STORE_MAGIC && hdr.version == DTLS_CID_STORE_VERSION &&
+      hdr.len != 0 && hdr.len <= DTLS_CID_STORE_MAX_LEN)
+  {
+    buf = malloc(hdr.len);
+    if (buf != NULL && efs_read(fd, buf, hdr.len) == hdr.len)
+      ret = DTLS_OK;
+  }
+  efs_close(fd);
+
+  /* One shot: the record counters in the file are only valid once. */
+  efs_unlink(path);
+
+  if (ret == DTLS_OK)
+  {
+    ret = mbedtls_ssl_context_load(ssl, buf, hdr.len);
+    if (ret != 0)
+    {
+      IOTAPP_LOG_ERR("DTLS resume: load failed %d", ret);
+      mbedtls_ssl_session_reset(ssl);
+      ret = DTLS_FAILURE;
+    }
+    else
+    {
+      IOTAPP_LOG_INFO("DTLS resume: connection restored from %s", path);
+    }
+  }
+
+  if (buf != NULL)
+  {
+    mbedtls_platform_zeroize(buf, hdr.len);
+    free(buf);
+  }
+  return ret;
+}
+
+void dtls_cid_forget(const char * path)
+{
+  if (path != NULL)
+    efs_unlink(path);
+}
+
+#endif /* MBEDTLS_SSL_CONTEXT_SERIALIZATION */
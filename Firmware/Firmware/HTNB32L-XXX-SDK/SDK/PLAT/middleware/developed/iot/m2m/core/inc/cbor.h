@@ -0,0 +1,124 @@
+/******************************************************************************
+
+  @file    cbor.h
+  @brief   Minimal CBOR (RFC 8949) writer / reader for the SenML-CBOR and
+           LwM2M-CBOR content formats
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#ifndef _LWM2M_CBOR_H
+#define _LWM2M_CBOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "liblwm2m.h"
+
+/* CoAP Content-Format numbers. lwm2m_media_type_t does not list them, the
+ * format switch of lwm2m_data_parse() / lwm2m_data_serialize() compares
+ * against these. */
+#define CBOR_CONTENT_SENML_CBOR  112   /* application/senml+cbor, RFC 8428 */
+#define CBOR_CONTENT_LWM2M_CBOR  11544 /* application/vnd.oma.lwm2m+cbor */
+
+#define CBOR_MAJOR_UINT          0
+#define CBOR_MAJOR_NINT          1
+#define CBOR_MAJOR_BSTR          2
+#define CBOR_MAJOR_TSTR          3
+#define CBOR_MAJOR_ARRAY         4
+#define CBOR_MAJOR_MAP           5
+#define CBOR_MAJOR_TAG           6
+#define CBOR_MAJOR_SIMPLE        7
+
+#define CBOR_SIMPLE_FALSE        20
+#define CBOR_SIMPLE_TRUE         21
+#define CBOR_AI_FLOAT16          25
+#define CBOR_AI_FLOAT32          26
+#define CBOR_AI_FLOAT64          27
+#define CBOR_AI_INDEFINITE       31
+
+#define CBOR_MAX_DEPTH           4     /* object / instance / resource / resource instance */
+#define CBOR_MAX_RECORDS         64    /* leaves accepted in one payload */
+
+/* A writer with buf == NULL only counts, so every encoder runs once to size
+ * the payload and once to fill it; nothing is built in between. */
+typedef struct
+{
+  uint8_t * buf;
+  size_t    len;
+  size_t    pos;
+  bool      overflow;
+} cbor_writer_t;
+
+typedef struct
+{
+  const uint8_t * buf;
+  size_t          len;
+  size_t          pos;
+} cbor_reader_t;
+
+/* One decoded head. For strings ptr/val give the payload, for arrays and
+ * maps val is the item count (CBOR_AI_INDEFINITE sets indefinite). */
+typedef struct
+{
+  uint8_t         major;
+  uint8_t         ai;
+  bool            indefinite;
+  uint64_t        val;
+  double          f;
+  const uint8_t * ptr;
+} cbor_item_t;
+
+/* Leaf collected by a decoder, path is absolute (object first). */
+typedef struct
+{
+  uint16_t     ids[CBOR_MAX_DEPTH];
+  uint8_t      depth;
+  lwm2m_data_t value;
+} cbor_record_t;
+
+void cbor_writer_init(cbor_writer_t * w, uint8_t * buf, size_t len);
+void cbor_put_head(cbor_writer_t * w, uint8_t major, uint64_t val);
+void cbor_put_int(cbor_writer_t * w, int64_t val);
+void cbor_put_float(cbor_writer_t * w, double val);
+void cbor_put_bool(cbor_writer_t * w, bool val);
+void cbor_put_bytes(cbor_writer_t * w, uint8_t major, const uint8_t * data, size_t len);
+void cbor_put_objlink(cbor_writer_t * w, objlink_t link);
+bool cbor_put_value(cbor_writer_t * w, const lwm2m_data_t * dataP);
+
+void cbor_reader_init(cbor_reader_t * r, const uint8_t * buf, size_t len);
+int cbor_get_item(cbor_reader_t * r, cbor_item_t * item);
+bool cbor_at_break(cbor_reader_t * r);
+int cbor_item_to_int(const cbor_item_t * item, int64_t * val);
+int cbor_item_to_value(const cbor_item_t * item, lwm2m_data_t * dataP);
+int cbor_parse_objlink(const uint8_t * str, size_t len, objlink_t * link);
+
+uint8_t cbor_uri_base_depth(const lwm2m_uri_t * uriP);
+void cbor_uri_to_ids(const lwm2m_uri_t * uriP, uint16_t * ids);
+int cbor_records_to_data(const lwm2m_uri_t * uriP, cbor_record_t * records, int count, lwm2m_data_t ** dataP);
+void cbor_records_free(cbor_record_t * records, int count);
+
+// defined in senml_cbor.c
+int senml_cbor_parse(lwm2m_uri_t * uriP, uint8_t * buffer, size_t bufferLen,
+                     lwm2m_data_t ** dataP);
+size_t senml_cbor_serialize(lwm2m_uri_t * uriP, int size, lwm2m_data_t * dataP,
+                            uint8_t ** bufferP);
+size_t senml_cbor_serialize_to(lwm2m_uri_t * uriP, int size, lwm2m_data_t * dataP,
+                               uint8_t * buffer, size_t length);
+size_t senml_cbor_serialize_multi(int groups, lwm2m_uri_t * uris, int * sizes,
+                                  lwm2m_data_t ** datas, uint8_t ** bufferP);
+
+// defined in lwm2m_cbor.c
+int lwm2m_cbor_parse(lwm2m_uri_t * uriP, uint8_t * buffer, size_t bufferLen,
+                     lwm2m_data_t ** dataP);
+size_t lwm2m_cbor_serialize(lwm2m_uri_t * uriP, int size, lwm2m_data_t * dataP,
+                            uint8_t ** bufferP);
+size_t lwm2m_cbor_serialize_to(lwm2m_uri_t * uriP, int size, lwm2m_data_t * dataP,
+                               uint8_t * buffer, size_t length);
+
+#endif
@@ -0,0 +1,91 @@
+/******************************************************************************
+
+  @file    lwm2m_wake.h
+  @brief   LwM2M client state kept across hibernate, update-only wake path
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#ifndef _LWM2M_WAKE_H
+#define _LWM2M_WAKE_H
+
+#include "liblwm2m.h"
+
+/* Registration and observations kept across hibernate, next to the other
+ * persistence files of liblwm2m.h */
+#define LWM2M_WAKE_STATE_PERSISTENCE_FILE "wake_state_pr"
+
+#define LWM2M_WAKE_MAGIC              0x4C574B31   /* "LWK1" */
+#define LWM2M_WAKE_VERSION            1
+
+#define LWM2M_WAKE_MAX_SERVERS        4
+#define LWM2M_WAKE_MAX_OBSERVATIONS   32
+#define LWM2M_WAKE_LOCATION_LEN       64
+
+/* A registration is refreshed with an Update once this share of its
+ * lifetime has elapsed, and is not resumed at all within the guard of its
+ * end, so that the server never sees a notification from an expired
+ * registration. */
+#ifndef LWM2M_WAKE_UPDATE_PCT
+#define LWM2M_WAKE_UPDATE_PCT         90
+#endif
+#define LWM2M_WAKE_LIFETIME_GUARD     30
+
+/* Servers reached without DTLS learn the new NAT binding from the source
+ * address of the first CON. Set to 1 for servers that only accept it from
+ * an Update. */
+#ifndef LWM2M_WAKE_NOSEC_UPDATE
+#define LWM2M_WAKE_NOSEC_UPDATE       0
+#endif
+
+typedef enum
+{
+  LWM2M_WAKE_NONE = 0,        /* registration resumed, next report is one CON */
+  LWM2M_WAKE_UPDATE,          /* registration resumed, Update without objects first */
+  LWM2M_WAKE_REGISTER,        /* nothing usable saved, full registration */
+} lwm2m_wake_action_t;
+
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t server_count;
+  uint16_t obs_count;
+  uint16_t reserved;
+  time_t   saved;             /* lwm2m_gettime() at suspend */
+  time_t   obs_due;           /* earliest pmax report among the observations */
+} lwm2m_wake_hdr_t;
+
+typedef struct
+{
+  uint16_t short_id;
+  uint16_t next_mid;          /* carries on the CoAP MID sequence */
+  uint32_t lifetime;
+  time_t   registration;      /* last Register or Update */
+  uint16_t binding;
+  uint8_t  secure;
+  uint8_t  reserved;
+  char     location[LWM2M_WAKE_LOCATION_LEN];
+} lwm2m_wake_server_t;
+
+/* The file holds an lwm2m_wake_hdr_t, server_count lwm2m_wake_server_t and
+ * obs_count lwm2m_persistent_watcher_t, the latter only read on demand. */
+
+int lwm2m_wake_save(lwm2m_context_t * contextP, time_t now);
+int lwm2m_wake_load(lwm2m_context_t * contextP, time_t now);
+void lwm2m_wake_discard(void);
+
+bool lwm2m_wake_resumed(void);
+lwm2m_wake_action_t lwm2m_wake_action(lwm2m_server_t * serverP, time_t now);
+bool lwm2m_wake_next_mid(lwm2m_server_t * serverP, uint16_t * midP);
+
+int lwm2m_wake_restore_observations(lwm2m_context_t * contextP);
+void lwm2m_wake_value_changed(lwm2m_context_t * contextP);
+void lwm2m_wake_step(lwm2m_context_t * contextP, time_t now, time_t * timeoutP);
+
+#endif
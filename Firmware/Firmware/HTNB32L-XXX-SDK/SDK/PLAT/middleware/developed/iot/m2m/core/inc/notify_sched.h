@@ -0,0 +1,76 @@
+/******************************************************************************
+
+  @file    notify_sched.h
+  @brief   pmin/pmax aware notification scheduler with batching and LwM2M Send
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#ifndef _NOTIFY_SCHED_H
+#define _NOTIFY_SCHED_H
+
+#include "liblwm2m.h"
+
+#define NOTIFY_SCHED_MAX_ENTRIES      24
+#define NOTIFY_SCHED_MAX_SERVERS      4
+
+/* A changed value may wait this long after pmin for other changes or a
+ * planned uplink to join it. Never beyond pmax. */
+#define NOTIFY_SCHED_DEFAULT_HOLD     30
+/* An unchanged pmax report rides along once this share of pmax elapsed. */
+#define NOTIFY_SCHED_DEFAULT_PIGGYBACK_PCT  50
+
+#define NOTIFY_SCHED_SEND_PATH        "dp"
+
+typedef struct
+{
+  lwm2m_uri_t       uri;
+  lwm2m_server_t *  server;
+  lwm2m_watcher_t * watcher;          /* NULL for resources reported with Send */
+  time_t            last;             /* last report of this entry */
+  uint32_t          pmin;
+  uint32_t          pmax;             /* 0: no periodic report */
+  bool              changed;
+  bool              used;
+} notify_sched_entry_t;
+
+typedef struct
+{
+  lwm2m_server_t *  server;
+  time_t            uplink;           /* next planned uplink, 0 if none */
+} notify_sched_uplink_t;
+
+typedef struct
+{
+  notify_sched_entry_t  entries[NOTIFY_SCHED_MAX_ENTRIES];
+  notify_sched_uplink_t uplinks[NOTIFY_SCHED_MAX_SERVERS];
+  uint32_t              max_hold;
+  uint8_t               piggyback_pct;
+  uint32_t              batches;      /* radio wake-ups spent on reports */
+  uint32_t              reports;      /* entries reported in those */
+  qurt_mutex_t          lock;
+} notify_sched_t;
+
+notify_sched_t * notify_sched_default(void);
+void notify_sched_init(notify_sched_t * schedP, uint32_t max_hold, uint8_t piggyback_pct);
+
+int notify_sched_track(notify_sched_t * schedP, lwm2m_server_t * serverP, lwm2m_watcher_t * watcherP,
+                       lwm2m_uri_t * uriP, uint32_t pmin, uint32_t pmax, time_t now);
+void notify_sched_untrack(notify_sched_t * schedP, lwm2m_server_t * serverP, lwm2m_watcher_t * watcherP,
+                          lwm2m_uri_t * uriP);
+void notify_sched_changed(notify_sched_t * schedP, lwm2m_uri_t * uriP);
+void notify_sched_plan_uplink(notify_sched_t * schedP, lwm2m_server_t * serverP, time_t when);
+
+time_t notify_sched_due(notify_sched_t * schedP, lwm2m_server_t * serverP, time_t now);
+void notify_sched_step(notify_sched_t * schedP, time_t now, time_t * timeoutP);
+int notify_sched_collect(notify_sched_t * schedP, lwm2m_server_t * serverP, time_t now,
+                         notify_sched_entry_t ** batch, int max);
+int notify_sched_send(lwm2m_context_t * contextP, lwm2m_server_t * serverP,
+                      notify_sched_entry_t ** batch, int count);
+
+#endif
@@ -0,0 +1,69 @@
+/******************************************************************************
+
+  @file    obj_index.h
+  @brief   Sorted object/instance/resource index for LwM2M URI dispatch
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#ifndef _OBJ_INDEX_H
+#define _OBJ_INDEX_H
+
+#include "liblwm2m.h"
+
+#define OBJ_INDEX_MIN_CAPACITY        4
+
+typedef struct
+{
+  uint16_t        id;
+  lwm2m_list_t *  node;                 /* entry of lwm2m_object_t::instanceList */
+} obj_index_inst_t;
+
+typedef struct
+{
+  uint16_t          id;
+  lwm2m_object_t *  objectP;
+  obj_index_inst_t * insts;             /* sorted by id */
+  uint16_t          inst_count;
+  uint16_t          inst_cap;
+  const uint16_t *  res;                /* sorted resource IDs, owned by the object */
+  uint16_t          res_count;
+} obj_index_obj_t;
+
+typedef struct
+{
+  obj_index_obj_t * objs;               /* sorted by id */
+  uint16_t          count;
+  uint16_t          cap;
+  uint32_t          hits;
+  uint32_t          misses;             /* lookups that fell back to the lists */
+} obj_index_t;
+
+/* The index mirrors lwm2m_context_t::objectList and the instance lists
+ * hanging off it. It is not locked on its own: like the lists, it is only
+ * touched with the LwM2M global mutex held. */
+obj_index_t * obj_index_default(void);
+void obj_index_clear(obj_index_t * idxP);
+int obj_index_rebuild(obj_index_t * idxP, lwm2m_context_t * contextP);
+
+int obj_index_add_object(obj_index_t * idxP, lwm2m_object_t * objectP);
+void obj_index_remove_object(obj_index_t * idxP, uint16_t objectId);
+int obj_index_sync_object(obj_index_t * idxP, lwm2m_object_t * objectP);
+int obj_index_add_instance(obj_index_t * idxP, uint16_t objectId, lwm2m_list_t * instanceP);
+void obj_index_remove_instance(obj_index_t * idxP, uint16_t objectId, uint16_t instanceId);
+int obj_index_set_resources(obj_index_t * idxP, uint16_t objectId, const uint16_t * ids, uint16_t count);
+
+lwm2m_object_t * obj_index_find_object(obj_index_t * idxP, lwm2m_context_t * contextP, uint16_t objectId);
+lwm2m_list_t * obj_index_find_instance(obj_index_t * idxP, lwm2m_object_t * objectP, uint16_t instanceId);
+bool obj_index_has_resource(obj_index_t * idxP, uint16_t objectId, uint16_t resourceId);
+uint16_t obj_index_new_instance_id(obj_index_t * idxP, lwm2m_object_t * objectP);
+
+uint8_t obj_index_resolve(obj_index_t * idxP, lwm2m_context_t * contextP, lwm2m_uri_t * uriP,
+                          lwm2m_object_t ** objectPP, lwm2m_list_t ** instancePP);
+
+#endif
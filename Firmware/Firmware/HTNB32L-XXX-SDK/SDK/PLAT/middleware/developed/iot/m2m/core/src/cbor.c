@@ -0,0 +1,554 @@
+/******************************************************************************
+
+  @file    cbor.c
+  @brief   Minimal CBOR (RFC 8949) writer / reader for the SenML-CBOR and
+           LwM2M-CBOR content formats
+
+  Only what the two LwM2M formats use is supported: definite and
+  indefinite arrays / maps, integers, half / single / double floats,
+  byte and text strings, booleans and tags (skipped). Floats are written
+  in the shortest width that keeps the value exact.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include "internals.h"
+#include "cbor.h"
+
+static void cbor_put_raw(cbor_writer_t * w, const uint8_t * data, size_t len)
+{
+  if (w->buf != NULL)
+  {
+    if (w->pos + len > w->len)
+    {
+      w->overflow = true;
+      w->pos += len;
+      return;
+    }
+    memcpy(w->buf + w->pos, data, len);
+  }
+  w->pos += len;
+}
+
+void cbor_writer_init(cbor_writer_t * w, uint8_t * buf, size_t len)
+{
+  w->buf      = buf;
+  w->len      = len;
+  w->pos      = 0;
+  w->overflow = false;
+}
+
+void cbor_put_head(cbor_writer_t * w, uint8_t major, uint64_t val)
+{
+  uint8_t hdr[9];
+  size_t  n;
+
+  major <<= 5;
+  if (val < 24)
+  {
+    hdr[0] = major | (uint8_t)val;
+    n = 1;
+  }
+  else if (val <= 0xFF)
+  {
+    hdr[0] = major | 24;
+    hdr[1] = (uint8_t)val;
+    n = 2;
+  }
+  else if (val <= 0xFFFF)
+  {
+    hdr[0] = major | 25;
+    hdr[1] = (uint8_t)(val >> 8);
+    hdr[2] = (uint8_t)val;
+    n = 3;
+  }
+  else if (val <= 0xFFFFFFFFu)
+  {
+    hdr[0] = major | 26;
+    hdr[1] = (uint8_t)(val >> 24);
+    hdr[2] = (uint8_t)(val >> 16);
+    hdr[3] = (uint8_t)(val >> 8);
+    hdr[4] = (uint8_t)val;
+    n = 5;
+  }
+  else
+  {
+    int i;
+
+    hdr[0] = major | 27;
+    for (i = 0; i < 8; i++)
+      hdr[1 + i] = (uint8_t)(val >> (56 - 8 * i));
+    n = 9;
+  }
+  cbor_put_raw(w, hdr, n);
+}
+
+void cbor_put_int(cbor_writer_t * w, int64_t val)
+{
+  if (val >= 0)
+    cbor_put_head(w, CBOR_MAJOR_UINT, (uint64_t)val);
+  else
+    cbor_put_head(w, CBOR_MAJOR_NINT, (uint64_t)(-(val + 1)));
+}
+
+static bool cbor_float_to_half(float f, uint16_t * half)
+{
+  uint32_t bits;
+  uint32_t exp;
+  uint32_t mant;
+
+  memcpy(&bits, &f, sizeof(bits));
+  exp  = (bits >> 23) & 0xFF;
+  mant = bits & 0x7FFFFF;
+
+  if (exp == 0 && mant == 0)
+  {
+    *half = (uint16_t)((bits >> 16) & 0x8000);
+    return true;
+  }
+  /* normal halves only, 10 bit mantissa */
+  if (exp < 113 || exp > 142 || (mant & 0x1FFF) != 0)
+    return false;
+
+  *half = (uint16_t)(((bits >> 16) & 0x8000) | ((exp - 112) << 10) | (mant >> 13));
+  return true;
+}
+
+void cbor_put_float(cbor_writer_t * w, double val)
+{
+  uint8_t  b[9];
+  float    f = (float)val;
+  uint16_t half;
+
+  if ((double)f == val || val != val)
+  {
+    uint32_t bits;
+
+    if (cbor_float_to_half(f, &half))
+    {
+      b[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_AI_FLOAT16;
+      b[1] = (uint8_t)(half >> 8);
+      b[2] = (uint8_t)half;
+      cbor_put_raw(w, b, 3);
+      return;
+    }
+    memcpy(&bits, &f, sizeof(bits));
+    b[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_AI_FLOAT32;
+    b[1] = (uint8_t)(bits >> 24);
+    b[2] = (uint8_t)(bits >> 16);
+    b[3] = (uint8_t)(bits >> 8);
+    b[4] = (uint8_t)bits;
+    cbor_put_raw(w, b, 5);
+  }
+  else
+  {
+    uint64_t bits;
+    int i;
+
+    memcpy(&bits, &val, sizeof(bits));
+    b[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_AI_FLOAT64;
+    for (i = 0; i < 8; i++)
+      b[1 + i] = (uint8_t)(bits >> (56 - 8 * i));
+    cbor_put_raw(w, b, 9);
+  }
+}
+
+void cbor_put_bool(cbor_writer_t * w, bool val)
+{
+  uint8_t b = (CBOR_MAJOR_SIMPLE << 5) | (val ? CBOR_SIMPLE_TRUE : CBOR_SIMPLE_FALSE);
+
+  cbor_put_raw(w, &b, 1);
+}
+
+void cbor_put_bytes(cbor_writer_t * w, uint8_t major, const uint8_t * data, size_t len)
+{
+  cbor_put_head(w, major, len);
+  if (len != 0)
+    cbor_put_raw(w, data, len);
+}
+
+/* Object links travel as the text "oid:iid" in both formats. */
+void cbor_put_objlink(cbor_writer_t * w, objlink_t link)
+{
+  char str[12];
+  int  len = snprintf(str, sizeof(str), "%u:%u", (unsigned)(link >> 16), (unsigned)(link & 0xFFFF));
+
+  cbor_put_bytes(w, CBOR_MAJOR_TSTR, (const uint8_t *)str, (size_t)len);
+}
+
+bool cbor_put_value(cbor_writer_t * w, const lwm2m_data_t * dataP)
+{
+  switch (dataP->type)
+  {
+    case LWM2M_TYPE_STRING:
+      cbor_put_bytes(w, CBOR_MAJOR_TSTR, dataP->value.asBuffer.buffer, dataP->value.asBuffer.length);
+      break;
+    case LWM2M_TYPE_OPAQUE:
+      cbor_put_bytes(w, CBOR_MAJOR_BSTR, dataP->value.asBuffer.buffer, dataP->value.asBuffer.length);
+      break;
+    case LWM2M_TYPE_INTEGER:
+      cbor_put_int(w, dataP->value.asInteger);
+      break;
+    case LWM2M_TYPE_FLOAT:
+      cbor_put_float(w, dataP->value.asFloat);
+      break;
+    case LWM2M_TYPE_BOOLEAN:
+      cbor_put_bool(w, dataP->value.asBoolean);
+      break;
+    case LWM2M_TYPE_OBJECT_LINK:
+      cbor_put_objlink(w, dataP->value.asObjLink);
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+void cbor_reader_init(cbor_reader_t * r, const uint8_t * buf, size_t len)
+{
+  r->buf = buf;
+  r->len = len;
+  r->pos = 0;
+}
+
+static double cbor_half_to_double(uint16_t half)
+{
+  uint32_t exp  = (half >> 10) & 0x1F;
+  uint32_t mant = half & 0x3FF;
+  double   val;
+
+  if (exp == 0)
+    val = (double)mant / 16777216.0;                          /* mant * 2^-24 */
+  else if (exp == 31)
+    val = (mant == 0) ? 1.0 / 0.0 : 0.0 / 0.0;
+  else
+  {
+    val = (double)(mant + 1024);
+    if (exp > 25)
+      val *= (double)(1u << (exp - 25));
+    else
+      val /= (double)(1u << (25 - exp));
+  }
+  return (half & 0x8000) ? -val : val;
+}
+
+/* Reads one head and, for strings, skips the payload. Returns 0 or -1 on
+ * truncated / unsupported input. */
+int cbor_get_item(cbor_reader_t * r, cbor_item_t * item)
+{
+  uint8_t  ib;
+  uint8_t  n;
+  uint64_t val = 0;
+
+  if (r->pos >= r->len)
+    return -1;
+
+  ib = r->buf[r->pos++];
+  memset(item, 0, sizeof(cbor_item_t));
+  item->major = ib >> 5;
+  item->ai    = ib & 0x1F;
+
+  if (item->ai < 24)
+    val = item->ai;
+  else if (item->ai <= 27)
+  {
+    n = (uint8_t)(1u << (item->ai - 24));
+    if (r->pos + n > r->len)
+      return -1;
+    while (n--)
+      val = (val << 8) | r->buf[r->pos++];
+  }
+  else if (item->ai == CBOR_AI_INDEFINITE)
+  {
+    if (item->major != CBOR_MAJOR_ARRAY && item->major != CBOR_MAJOR_MAP && item->major != CBOR_MAJOR_SIMPLE)
+      return -1;                                              /* chunked strings are not used by LwM2M */
+    item->indefinite = true;
+  }
+  else
+    return -1;
+
+  item->val = val;
+
+  switch (item->major)
+  {
+    case CBOR_MAJOR_BSTR:
+    case CBOR_MAJOR_TSTR:
+      if (val > r->len - r->pos)
+        return -1;
+      item->ptr = r->buf + r->pos;
+      r->pos += (size_t)val;
+      break;
+
+    case CBOR_MAJOR_SIMPLE:
+      if (item->ai == CBOR_AI_FLOAT16)
+        item->f = cbor_half_to_double((uint16_t)val);
+      else if (item->ai == CBOR_AI_FLOAT32)
+      {
+        uint32_t bits = (uint32_t)val;
+        float    f;
+
+        memcpy(&f, &bits, sizeof(f));
+        item->f = f;
+      }
+      else if (item->ai == CBOR_AI_FLOAT64)
+        memcpy(&item->f, &val, sizeof(item->f));
+      break;
+
+    default:
+      break;
+  }
+  return 0;
+}
+
+/* Consumes a break byte (0xFF) ending an indefinite container. */
+bool cbor_at_break(cbor_reader_t * r)
+{
+  if (r->pos < r->len && r->buf[r->pos] == 0xFF)
+  {
+    r->pos++;
+    return true;
+  }
+  return false;
+}
+
+int cbor_item_to_int(const cbor_item_t * item, int64_t * val)
+{
+  if (item->major == CBOR_MAJOR_UINT && item->val <= (uint64_t)INT64_MAX)
+    *val = (int64_t)item->val;
+  else if (item->major == CBOR_MAJOR_NINT && item->val <= (uint64_t)INT64_MAX)
+    *val = -1 - (int64_t)item->val;
+  else
+    return -1;
+  return 0;
+}
+
+int cbor_parse_objlink(const uint8_t * str, size_t len, objlink_t * link)
+{
+  uint32_t oid = 0;
+  uint32_t iid = 0;
+  uint32_t * cur = &oid;
+  size_t   i;
+
+  for (i = 0; i < len; i++)
+  {
+    if (str[i] == ':' && cur == &oid && i != 0)
+      cur = &iid;
+    else if (str[i] >= '0' && str[i] <= '9')
+    {
+      *cur = *cur * 10 + (str[i] - '0');
+      if (*cur > 0xFFFF)
+        return -1;
+    }
+    else
+      return -1;
+  }
+  if (cur != &iid || str[len - 1] == ':')
+    return -1;
+
+  *link = (objlink_t)((oid << 16) | iid);
+  return 0;
+}
+
+/* Converts a scalar item. Text is kept as a string, the object knows
+ * whether it is really an object link. Buffers are copied so the result
+ * can be released with lwm2m_data_free(). */
+int cbor_item_to_value(const cbor_item_t * item, lwm2m_data_t * dataP)
+{
+  int64_t ival;
+
+  switch (item->major)
+  {
+    case CBOR_MAJOR_UINT:
+    case CBOR_MAJOR_NINT:
+      if (cbor_item_to_int(item, &ival) != 0)
+        return -1;
+      lwm2m_data_encode_int(ival, dataP);
+      return 0;
+
+    case CBOR_MAJOR_TSTR:
+    case CBOR_MAJOR_BSTR:
+      dataP->type = (item->major == CBOR_MAJOR_TSTR) ? LWM2M_TYPE_STRING : LWM2M_TYPE_OPAQUE;
+      dataP->value.asBuffer.length = (size_t)item->val;
+      dataP->value.asBuffer.buffer = NULL;
+      if (item->val != 0)
+      {
+        dataP->value.asBuffer.buffer = (uint8_t *)lwm2m_malloc((size_t)item->val);
+        if (dataP->value.asBuffer.buffer == NULL)
+          return -1;
+        memcpy(dataP->value.asBuffer.buffer, item->ptr, (size_t)item->val);
+      }
+      return 0;
+
+    case CBOR_MAJOR_SIMPLE:
+      if (item->ai == CBOR_SIMPLE_FALSE || item->ai == CBOR_SIMPLE_TRUE)
+      {
+        lwm2m_data_encode_bool(item->ai == CBOR_SIMPLE_TRUE, dataP);
+        return 0;
+      }
+      if (item->ai >= CBOR_AI_FLOAT16 && item->ai <= CBOR_AI_FLOAT64)
+      {
+        lwm2m_data_encode_float(item->f, dataP);
+        return 0;
+      }
+      return -1;
+
+    default:
+      return -1;
+  }
+}
+
+/* Number of path segments the payload shares with the request URI. The
+ * lwm2m_data_t array handed to / returned by the codecs starts one level
+ * below it, like for TLV and JSON: resources for /o/i and /o/i/r,
+ * instances for /o, resource instances for /o/i/r/ri. */
+uint8_t cbor_uri_base_depth(const lwm2m_uri_t * uriP)
+{
+  if (uriP == NULL || !LWM2M_URI_IS_SET_OBJECT(uriP))
+    return 0;
+  if (!LWM2M_URI_IS_SET_INSTANCE(uriP))
+    return 1;
+  if (!LWM2M_URI_IS_SET_RESOURCE_INST(uriP))
+    return 2;
+  return 3;
+}
+
+void cbor_uri_to_ids(const lwm2m_uri_t * uriP, uint16_t * ids)
+{
+  memset(ids, 0, CBOR_MAX_DEPTH * sizeof(uint16_t));
+  if (uriP == NULL)
+    return;
+
+  ids[0] = uriP->objectId;
+  ids[1] = uriP->instanceId;
+  ids[2] = uriP->resourceId;
+  ids[3] = uriP->resourceInstId;
+}
+
+static int cbor_record_cmp(const cbor_record_t * a, const cbor_record_t * b)
+{
+  uint8_t i;
+
+  for (i = 0; i < a->depth && i < b->depth; i++)
+  {
+    if (a->ids[i] != b->ids[i])
+      return (a->ids[i] < b->ids[i]) ? -1 : 1;
+  }
+  return (int)a->depth - (int)b->depth;
+}
+
+static int cbor_build_level(cbor_record_t * records, int count, uint8_t level, lwm2m_data_t ** dataP)
+{
+  lwm2m_data_t * out;
+  int groups = 0;
+  int i;
+  int g;
+
+  for (i = 0; i < count; i++)
+  {
+    if (i == 0 || records[i].ids[level] != records[i - 1].ids[level])
+      groups++;
+  }
+
+  out = lwm2m_data_new(groups);
+  if (out == NULL)
+    return -1;
+
+  for (i = 0, g = 0; i < count; g++)
+  {
+    int end = i + 1;
+
+    while (end < count && records[end].ids[level] == records[i].ids[level])
+      end++;
+
+    out[g].id = records[i].ids[level];
+    if (records[i].depth == level + 1)
+    {
+      if (end != i + 1)
+        goto error;                                           /* same leaf twice, or leaf and children */
+      out[g].type  = records[i].value.type;
+      out[g].value = records[i].value.value;
+      memset(&records[i].value, 0, sizeof(lwm2m_data_t));     /* ownership moved */
+    }
+    else
+    {
+      lwm2m_data_t * children = NULL;
+      int n;
+
+      if (records[i].depth <= level + 1)
+        goto error;
+      n = cbor_build_level(records + i, end - i, (uint8_t)(level + 1), &children);
+      if (n < 0)
+        goto error;
+      out[g].type = (level == 0) ? LWM2M_TYPE_OBJECT :
+                    (level == 1) ? LWM2M_TYPE_OBJECT_INSTANCE : LWM2M_TYPE_MULTIPLE_RESOURCE;
+      out[g].value.asChildren.count = (size_t)n;
+      out[g].value.asChildren.array = children;
+    }
+    i = end;
+  }
+
+  *dataP = out;
+  return groups;
+
+error:
+  lwm2m_data_free(groups, out);
+  return -1;
+}
+
+/* Turns the decoded leaves into the lwm2m_data_t layout the object
+ * callbacks expect. Every leaf must lie under the request URI. */
+int cbor_records_to_data(const lwm2m_uri_t * uriP, cbor_record_t * records, int count, lwm2m_data_t ** dataP)
+{
+  uint16_t base[CBOR_MAX_DEPTH];
+  uint8_t  depth = cbor_uri_base_depth(uriP);
+  int i;
+  int j;
+
+  *dataP = NULL;
+  if (count <= 0)
+    return 0;
+
+  cbor_uri_to_ids(uriP, base);
+  for (i = 0; i < count; i++)
+  {
+    if (records[i].depth <= depth)
+      return -1;
+    for (j = 0; j < depth; j++)
+    {
+      if (records[i].ids[j] != base[j])
+        return -1;
+    }
+  }
+
+  /* payloads are small and usually already ordered, insertion sort */
+  for (i = 1; i < count; i++)
+  {
+    cbor_record_t tmp = records[i];
+
+    for (j = i; j > 0 && cbor_record_cmp(&records[j - 1], &tmp) > 0; j--)
+      records[j] = records[j - 1];
+    records[j] = tmp;
+  }
+
+  return cbor_build_level(records, count, depth, dataP);
+}
+
+void cbor_records_free(cbor_record_t * records, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+  {
+    if ((records[i].value.type == LWM2M_TYPE_STRING || records[i].value.type == LWM2M_TYPE_OPAQUE) &&
+        records[i].value.value.asBuffer.buffer != NULL)
+      lwm2m_free(records[i].value.value.asBuffer.buffer);
+    memset(&records[i].value, 0, sizeof(lwm2m_data_t));
+  }
+}
@@ -0,0 +1,231 @@
+/******************************************************************************
+
+  @file    lwm2m_cbor.c
+  @brief   LwM2M-CBOR content format (application/vnd.oma.lwm2m+cbor, 11544)
+
+  Nested maps keyed by path segment, as defined in LwM2M 1.2. The common
+  prefix given by the request URI is sent once as an array key, so a read
+  of /3/0 becomes {[3, 0]: {0: "...", 1: "...", ...}}. Decoding accepts
+  both plain integer keys and array keys at any level.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <string.h>
+#include "internals.h"
+#include "cbor.h"
+
+static bool lwm2m_cbor_is_container(const lwm2m_data_t * dataP)
+{
+  return dataP->type == LWM2M_TYPE_OBJECT || dataP->type == LWM2M_TYPE_OBJECT_INSTANCE ||
+         dataP->type == LWM2M_TYPE_MULTIPLE_RESOURCE;
+}
+
+static bool lwm2m_cbor_write_map(cbor_writer_t * w, int size, const lwm2m_data_t * dataP, uint8_t depth)
+{
+  int entries = 0;
+  int i;
+
+  if (depth > CBOR_MAX_DEPTH)
+    return false;
+
+  for (i = 0; i < size; i++)
+  {
+    if (dataP[i].type != LWM2M_TYPE_UNDEFINED)
+      entries++;
+  }
+
+  cbor_put_head(w, CBOR_MAJOR_MAP, (uint64_t)entries);
+  for (i = 0; i < size; i++)
+  {
+    if (dataP[i].type == LWM2M_TYPE_UNDEFINED)
+      continue;
+
+    cbor_put_int(w, dataP[i].id);
+    if (lwm2m_cbor_is_container(&dataP[i]))
+    {
+      if (!lwm2m_cbor_write_map(w, (int)dataP[i].value.asChildren.count, dataP[i].value.asChildren.array,
+                                (uint8_t)(depth + 1)))
+        return false;
+    }
+    else if (!cbor_put_value(w, &dataP[i]))
+      return false;
+  }
+  return true;
+}
+
+static size_t lwm2m_cbor_write(lwm2m_uri_t * uriP, int size, lwm2m_data_t * dataP, cbor_writer_t * w)
+{
+  uint16_t ids[CBOR_MAX_DEPTH];
+  uint8_t  base = cbor_uri_base_depth(uriP);
+  uint8_t  i;
+
+  if (size <= 0 || dataP == NULL)
+    return 0;
+
+  cbor_uri_to_ids(uriP, ids);
+  if (base != 0)
+  {
+    cbor_put_head(w, CBOR_MAJOR_MAP, 1);
+    if (base == 1)
+      cbor_put_int(w, ids[0]);
+    else
+    {
+      cbor_put_head(w, CBOR_MAJOR_ARRAY, base);
+      for (i = 0; i < base; i++)
+        cbor_put_int(w, ids[i]);
+    }
+  }
+
+  if (!lwm2m_cbor_write_map(w, size, dataP, base) || w->overflow)
+    return 0;
+
+  return w->pos;
+}
+
+/* Encodes into a caller supplied buffer, typically the CoAP payload area.
+ * Returns the payload length or 0 if it does not fit. */
+size_t lwm2m_cbor_serialize_to(lwm2m_uri_t * uriP, int size, lwm2m_data_t * dataP, uint8_t * buffer, size_t length)
+{
+  cbor_writer_t w;
+
+  cbor_writer_init(&w, buffer, length);
+  return lwm2m_cbor_write(uriP, size, dataP, &w);
+}
+
+size_t lwm2m_cbor_serialize(lwm2m_uri_t * uriP, int size, lwm2m_data_t * dataP, uint8_t ** bufferP)
+{
+  cbor_writer_t w;
+  size_t length;
+
+  *bufferP = NULL;
+
+  cbor_writer_init(&w, NULL, 0);
+  length = lwm2m_cbor_write(uriP, size, dataP, &w);
+  if (length == 0)
+    return 0;
+
+  *bufferP = (uint8_t *)lwm2m_malloc(length);
+  if (*bufferP == NULL)
+    return 0;
+
+  if (lwm2m_cbor_serialize_to(uriP, size, dataP, *bufferP, length) != length)
+  {
+    lwm2m_free(*bufferP);
+    *bufferP = NULL;
+    return 0;
+  }
+  return length;
+}
+
+typedef struct
+{
+  cbor_reader_t   r;
+  cbor_record_t * records;
+  int             count;
+} lwm2m_cbor_parser_t;
+
+static int lwm2m_cbor_parse_key(lwm2m_cbor_parser_t * p, uint16_t * ids, uint8_t * depth)
+{
+  cbor_item_t item;
+  int64_t     id;
+  uint64_t    n;
+
+  if (cbor_get_item(&p->r, &item) != 0)
+    return -1;
+
+  if (item.major == CBOR_MAJOR_UINT)
+  {
+    if (*depth >= CBOR_MAX_DEPTH || item.val > 0xFFFF)
+      return -1;
+    ids[(*depth)++] = (uint16_t)item.val;
+    return 0;
+  }
+
+  if (item.major != CBOR_MAJOR_ARRAY || item.indefinite || item.val == 0)
+    return -1;
+
+  for (n = item.val; n > 0; n--)
+  {
+    cbor_item_t seg;
+
+    if (cbor_get_item(&p->r, &seg) != 0 || cbor_item_to_int(&seg, &id) != 0 ||
+        id < 0 || id > 0xFFFF || *depth >= CBOR_MAX_DEPTH)
+      return -1;
+    ids[(*depth)++] = (uint16_t)id;
+  }
+  return 0;
+}
+
+static int lwm2m_cbor_parse_map(lwm2m_cbor_parser_t * p, const uint16_t * parent, uint8_t parent_depth,
+                                const cbor_item_t * head)
+{
+  uint64_t remaining = head->val;
+
+  while (head->indefinite ? !cbor_at_break(&p->r) : remaining-- > 0)
+  {
+    uint16_t    ids[CBOR_MAX_DEPTH];
+    uint8_t     depth = parent_depth;
+    cbor_item_t value;
+
+    memcpy(ids, parent, sizeof(ids));
+    if (lwm2m_cbor_parse_key(p, ids, &depth) != 0)
+      return -1;
+
+    if (cbor_get_item(&p->r, &value) != 0)
+      return -1;
+
+    if (value.major == CBOR_MAJOR_MAP)
+    {
+      if (lwm2m_cbor_parse_map(p, ids, depth, &value) != 0)
+        return -1;
+      continue;
+    }
+
+    if (p->count >= CBOR_MAX_RECORDS)
+      return -1;
+
+    memcpy(p->records[p->count].ids, ids, sizeof(ids));
+    p->records[p->count].depth = depth;
+    if (cbor_item_to_value(&value, &p->records[p->count].value) != 0)
+    {
+      p->count++;                                             /* let the caller free a half built value */
+      return -1;
+    }
+    p->count++;
+  }
+  return 0;
+}
+
+int lwm2m_cbor_parse(lwm2m_uri_t * uriP, uint8_t * buffer, size_t bufferLen, lwm2m_data_t ** dataP)
+{
+  lwm2m_cbor_parser_t p;
+  cbor_item_t head;
+  uint16_t    root[CBOR_MAX_DEPTH];
+  int         result = -1;
+
+  *dataP = NULL;
+
+  cbor_reader_init(&p.r, buffer, bufferLen);
+  if (cbor_get_item(&p.r, &head) != 0 || head.major != CBOR_MAJOR_MAP)
+    return -1;
+
+  p.records = (cbor_record_t *)lwm2m_malloc(CBOR_MAX_RECORDS * sizeof(cbor_record_t));
+  if (p.records == NULL)
+    return -1;
+  memset(p.records, 0, CBOR_MAX_RECORDS * sizeof(cbor_record_t));
+  p.count = 0;
+
+  memset(root, 0, sizeof(root));
+  if (lwm2m_cbor_parse_map(&p, root, 0, &head) == 0 && p.r.pos == p.r.len)
+    result = cbor_records_to_data(uriP, p.records, p.count, dataP);
+
+  cbor_records_free(p.records, p.count);
+  lwm2m_free(p.records);
+  return result;
+}
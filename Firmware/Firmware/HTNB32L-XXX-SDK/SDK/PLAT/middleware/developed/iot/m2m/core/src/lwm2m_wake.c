@@ -0,0 +1,466 @@
+/******************************************************************************
+
+  @file    lwm2m_wake.c
+  @brief   LwM2M client state kept across hibernate, update-only wake path
+
+  Hibernate loses RAM, so after every wake-up the client used to register
+  again, wait for the server to observe its resources again and, with DTLS,
+  run a full handshake first. A periodic report therefore cost a dozen
+  datagrams where one CON and its ACK carry the actual data.
+
+  Right before hibernate lwm2m_wake_save() writes what the server already
+  knows about the client: per server the registration location, lifetime,
+  time of the last Register/Update and the next CoAP message ID, and per
+  observation its token, counter, last MID and attributes. The DTLS
+  state of secure connections is not kept: the SSL wrapper ships prebuilt
+  and cannot hand it to dtls_cid_suspend(), so those servers get a new
+  handshake and an Update on wake-up.
+
+  On wake-up lwm2m_wake_load() reads only the server part and marks the
+  still valid registrations as registered; the server table drives the
+  state machine past Register. Observations are rebuilt lazily, when a
+  value changes or when the earliest pmax report falls due, whichever
+  comes first. lwm2m_wake_action() then decides per server whether the
+  report can go out as is or an Update without objects must precede it:
+  near the end of the lifetime, or for a secure connection, whose new
+  session the server has to bind to the registration.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <string.h>
+#include "internals.h"
+#include "app_coap.h"
+#include "object_security.h"
+#include "lwm2m_wake.h"
+
+typedef struct
+{
+  lwm2m_wake_hdr_t    hdr;
+  lwm2m_wake_server_t servers[LWM2M_WAKE_MAX_SERVERS];
+  bool                restored[LWM2M_WAKE_MAX_SERVERS];
+  bool                update_sent[LWM2M_WAKE_MAX_SERVERS];
+  bool                loaded;
+  bool                obs_restored;
+} lwm2m_wake_t;
+
+static lwm2m_wake_t lwm2m_wake;
+
+static lwm2m_server_t * lwm2m_wake_find_server(lwm2m_context_t * contextP, uint16_t short_id)
+{
+  lwm2m_server_t * serverP;
+
+  for (serverP = contextP->serverList; serverP != NULL; serverP = serverP->next)
+  {
+    if (serverP->shortID == short_id)
+      return serverP;
+  }
+  return NULL;
+}
+
+static int lwm2m_wake_find_record(uint16_t short_id)
+{
+  int i;
+
+  for (i = 0; i < lwm2m_wake.hdr.server_count; i++)
+  {
+    if (lwm2m_wake.servers[i].short_id == short_id)
+      return i;
+  }
+  return -1;
+}
+
+static bool lwm2m_wake_is_secure(lwm2m_server_t * serverP)
+{
+  security_instance_t * instanceP;
+
+  if (data.securityObjP == NULL)
+    return false;
+
+  instanceP = (security_instance_t *)LWM2M_LIST_FIND(data.securityObjP->instanceList, serverP->secObjInstID);
+  return instanceP != NULL && instanceP->securityMode != LWM2M_SECURITY_MODE_NONE;
+}
+
+static time_t lwm2m_wake_pmax(lwm2m_watcher_t * watcherP)
+{
+  if (watcherP->parameters != NULL && (watcherP->parameters->toSet & LWM2M_ATTR_FLAG_MAX_PERIOD))
+    return watcherP->parameters->maxPeriod;
+  if (watcherP->server != NULL)
+    return watcherP->server->defaultMaxPeriod;
+  return 0;
+}
+
+/* Fills the watcher records for the saved servers. Returns their number,
+ * obs_due is the earliest pmax report among them (0 if none). */
+static int lwm2m_wake_collect_observations(lwm2m_context_t * contextP, lwm2m_persistent_watcher_t * obs,
+                                           time_t * obs_due)
+{
+  lwm2m_observed_t * observedP;
+  lwm2m_watcher_t * watcherP;
+  time_t pmax;
+  int count = 0;
+
+  *obs_due = 0;
+  for (observedP = contextP->observedList; observedP != NULL; observedP = observedP->next)
+  {
+    for (watcherP = observedP->watcherList; watcherP != NULL; watcherP = watcherP->next)
+    {
+      lwm2m_persistent_watcher_t * recP;
+
+      if (watcherP->server == NULL || lwm2m_wake_find_record(watcherP->server->shortID) < 0)
+        continue;
+      if (count == LWM2M_WAKE_MAX_OBSERVATIONS)
+      {
+        LOG("wake: too many observations, the rest is not kept");
+        return count;
+      }
+
+      recP = &obs[count++];
+      memset(recP, 0, sizeof(lwm2m_persistent_watcher_t));
+      recP->uri = observedP->uri;
+      memcpy(recP->token, watcherP->token, TOKEN_LEN);
+      recP->tokenLen = watcherP->tokenLen;
+      recP->lastValue.asInteger = watcherP->lastValue.asInteger;
+      recP->lastTime = watcherP->lastTime;
+      recP->counter = watcherP->counter;
+      recP->lastMid = watcherP->lastMid;
+      recP->serverID = watcherP->server->shortID;
+      recP->active = watcherP->active;
+      recP->format = watcherP->format;
+      recP->pmin_wait_count = watcherP->pmin_wait_count;
+      if (watcherP->parameters != NULL)
+      {
+        recP->parameters = *watcherP->parameters;
+        recP->isParameterSet = true;
+      }
+
+      pmax = lwm2m_wake_pmax(watcherP);
+      if (watcherP->active && pmax > 0 && (*obs_due == 0 || watcherP->lastTime + pmax < *obs_due))
+        *obs_due = watcherP->lastTime + pmax;
+    }
+  }
+  return count;
+}
+
+/* Call right before hibernate. Returns the number of registrations saved,
+ * or -1. */
+int lwm2m_wake_save(lwm2m_context_t * contextP, time_t now)
+{
+  lwm2m_persistent_watcher_t * obs = NULL;
+  lwm2m_server_t * serverP;
+  size_t obs_size;
+  int count = 0;
+  int fd;
+
+  if (contextP == NULL)
+    return -1;
+
+  memset(&lwm2m_wake, 0, sizeof(lwm2m_wake));
+  for (serverP = contextP->serverList; serverP != NULL; serverP = serverP->next)
+  {
+    lwm2m_wake_server_t * recP;
+
+    if (serverP->status != STATE_REGISTERED || serverP->location == NULL ||
+        strlen(serverP->location) >= LWM2M_WAKE_LOCATION_LEN)
+      continue;
+    if (count == LWM2M_WAKE_MAX_SERVERS)
+      break;
+
+    recP = &lwm2m_wake.servers[count++];
+    recP->short_id = serverP->shortID;
+    recP->lifetime = (uint32_t)serverP->lifetime;
+    recP->registration = serverP->registration;
+    recP->binding = (uint16_t)serverP->binding;
+    recP->secure = lwm2m_wake_is_secure(serverP);
+    LWM2M_STRCPY(recP->location, serverP->location, LWM2M_WAKE_LOCATION_LEN);
+    if (serverP->coapHandle != NULL)
+      recP->next_mid = coap_get_message_id(serverP->coapHandle);
+  }
+  lwm2m_wake.hdr.server_count = (uint16_t)count;
+
+  if (count == 0)
+  {
+    efs_unlink(LWM2M_WAKE_STATE_PERSISTENCE_FILE);
+    return 0;
+  }
+
+  obs_size = LWM2M_WAKE_MAX_OBSERVATIONS * sizeof(lwm2m_persistent_watcher_t);
+  obs = lwm2m_malloc(obs_size);
+  if (obs != NULL)
+    lwm2m_wake.hdr.obs_count = (uint16_t)lwm2m_wake_collect_observations(contextP, obs, &lwm2m_wake.hdr.obs_due);
+
+  lwm2m_wake.hdr.magic = LWM2M_WAKE_MAGIC;
+  lwm2m_wake.hdr.version = LWM2M_WAKE_VERSION;
+  lwm2m_wake.hdr.saved = now;
+
+  fd = efs_open(LWM2M_WAKE_STATE_PERSISTENCE_FILE, O_CREAT | O_WRONLY | O_TRUNC);
+  if (fd <= 0 ||
+      efs_write(fd, &lwm2m_wake.hdr, sizeof(lwm2m_wake_hdr_t)) != sizeof(lwm2m_wake_hdr_t) ||
+      efs_write(fd, lwm2m_wake.servers, count * sizeof(lwm2m_wake_server_t)) != (fs_ssize_t)(count * sizeof(lwm2m_wake_server_t)) ||
+      (lwm2m_wake.hdr.obs_count > 0 &&
+       efs_write(fd, obs, lwm2m_wake.hdr.obs_count * sizeof(lwm2m_persistent_watcher_t)) !=
+       (fs_ssize_t)(lwm2m_wake.hdr.obs_count * sizeof(lwm2m_persistent_watcher_t))))
+  {
+    LOG("wake: saving the client state failed");
+    count = -1;
+  }
+  if (fd > 0)
+    efs_close(fd);
+  if (count < 0)
+    efs_unlink(LWM2M_WAKE_STATE_PERSISTENCE_FILE);
+
+  if (obs != NULL)
+    lwm2m_free(obs);
+  memset(&lwm2m_wake, 0, sizeof(lwm2m_wake));
+
+  if (count > 0)
+  {
+    LOG_ARG("wake: %d registrations saved", count);
+  }
+  return count;
+}
+
+/* Call on wake-up, after the server list is built and before registration
+ * starts. Returns the number of registrations resumed; 0 means the client
+ * registers as after a cold boot. */
+int lwm2m_wake_load(lwm2m_context_t * contextP, time_t now)
+{
+  lwm2m_server_t * serverP;
+  int restored = 0;
+  int pending = 0;
+  int fd;
+  int i;
+
+  memset(&lwm2m_wake, 0, sizeof(lwm2m_wake));
+  if (contextP == NULL)
+    return 0;
+
+  fd = efs_open(LWM2M_WAKE_STATE_PERSISTENCE_FILE, O_RDONLY);
+  if (fd <= 0)
+    return 0;
+
+  if (efs_read(fd, &lwm2m_wake.hdr, sizeof(lwm2m_wake_hdr_t)) != sizeof(lwm2m_wake_hdr_t) ||
+      lwm2m_wake.hdr.magic != LWM2M_WAKE_MAGIC || lwm2m_wake.hdr.version != LWM2M_WAKE_VERSION ||
+      lwm2m_wake.hdr.server_count == 0 || lwm2m_wake.hdr.server_count > LWM2M_WAKE_MAX_SERVERS ||
+      lwm2m_wake.hdr.obs_count > LWM2M_WAKE_MAX_OBSERVATIONS ||
+      efs_read(fd, lwm2m_wake.servers, lwm2m_wake.hdr.server_count * sizeof(lwm2m_wake_server_t)) !=
+      (fs_ssize_t)(lwm2m_wake.hdr.server_count * sizeof(lwm2m_wake_server_t)) ||
+      now < lwm2m_wake.hdr.saved)
+  {
+    /* Unreadable, or the clock did not run through hibernate. */
+    efs_close(fd);
+    lwm2m_wake_discard();
+    return 0;
+  }
+  efs_close(fd);
+
+  for (i = 0; i < lwm2m_wake.hdr.server_count; i++)
+  {
+    lwm2m_wake_server_t * recP = &lwm2m_wake.servers[i];
+    char * location;
+
+    recP->location[LWM2M_WAKE_LOCATION_LEN - 1] = '\0';
+    serverP = lwm2m_wake_find_server(contextP, recP->short_id);
+    if (serverP == NULL || (uint32_t)serverP->lifetime != recP->lifetime ||
+        (uint16_t)serverP->binding != recP->binding ||
+        recP->registration + (time_t)recP->lifetime <= now + LWM2M_WAKE_LIFETIME_GUARD)
+      continue;
+
+    location = lwm2m_strdup(recP->location);
+    if (location == NULL)
+      continue;
+    if (serverP->location != NULL)
+      lwm2m_free(serverP->location);
+    serverP->location = location;
+    serverP->registration = recP->registration;
+    serverP->status = STATE_REGISTERED;
+    lwm2m_wake.restored[i] = true;
+    restored++;
+  }
+
+  if (restored == 0)
+  {
+    lwm2m_wake_discard();
+    return 0;
+  }
+
+  for (serverP = contextP->serverList; serverP != NULL; serverP = serverP->next)
+  {
+    if (serverP->status != STATE_REGISTERED)
+      pending++;
+  }
+  if (pending == 0)
+    contextP->state = STATE_READY;
+
+  lwm2m_wake.obs_restored = (lwm2m_wake.hdr.obs_count == 0);
+  lwm2m_wake.loaded = true;
+  LOG_ARG("wake: %d registrations resumed, %d observations pending", restored, lwm2m_wake.hdr.obs_count);
+  return restored;
+}
+
+void lwm2m_wake_discard(void)
+{
+  memset(&lwm2m_wake, 0, sizeof(lwm2m_wake));
+  efs_unlink(LWM2M_WAKE_STATE_PERSISTENCE_FILE);
+}
+
+bool lwm2m_wake_resumed(void)
+{
+  return lwm2m_wake.loaded;
+}
+
+lwm2m_wake_action_t lwm2m_wake_action(lwm2m_server_t * serverP, time_t now)
+{
+  lwm2m_wake_server_t * recP;
+  int i;
+
+  if (serverP == NULL || !lwm2m_wake.loaded)
+    return LWM2M_WAKE_REGISTER;
+
+  i = lwm2m_wake_find_record(serverP->shortID);
+  if (i < 0 || !lwm2m_wake.restored[i])
+    return LWM2M_WAKE_REGISTER;
+  recP = &lwm2m_wake.servers[i];
+
+  if ((uint64_t)(now - serverP->registration) * 100 >= (uint64_t)recP->lifetime * LWM2M_WAKE_UPDATE_PCT)
+    return LWM2M_WAKE_UPDATE;
+  if (recP->secure)
+    return LWM2M_WAKE_UPDATE;
+  if (!recP->secure && LWM2M_WAKE_NOSEC_UPDATE)
+    return LWM2M_WAKE_UPDATE;
+  return LWM2M_WAKE_NONE;
+}
+
+/* The message ID the CoAP session of a resumed server continues with, so
+ * that the server does not take the first CON after wake-up for a
+ * duplicate. False when serverP was not resumed. */
+bool lwm2m_wake_next_mid(lwm2m_server_t * serverP, uint16_t * midP)
+{
+  int i;
+
+  if (serverP == NULL || midP == NULL || !lwm2m_wake.loaded)
+    return false;
+
+  i = lwm2m_wake_find_record(serverP->shortID);
+  if (i < 0 || !lwm2m_wake.restored[i])
+    return false;
+
+  *midP = lwm2m_wake.servers[i].next_mid;
+  return true;
+}
+
+/* Rebuilds the watchers saved for the resumed servers. Runs once, the file
+ * is removed afterwards. */
+int lwm2m_wake_restore_observations(lwm2m_context_t * contextP)
+{
+  lwm2m_persistent_watcher_t rec;
+  lwm2m_server_t * serverP;
+  lwm2m_watcher_t * watcherP;
+  int restored = 0;
+  int fd;
+  int i;
+
+  if (contextP == NULL || !lwm2m_wake.loaded || lwm2m_wake.obs_restored)
+    return 0;
+  lwm2m_wake.obs_restored = true;
+
+  fd = efs_open(LWM2M_WAKE_STATE_PERSISTENCE_FILE, O_RDONLY);
+  if (fd <= 0)
+    return 0;
+
+  if (efs_lseek(fd, sizeof(lwm2m_wake_hdr_t) + lwm2m_wake.hdr.server_count * sizeof(lwm2m_wake_server_t),
+                LFS_SEEK_SET) < 0)
+  {
+    efs_close(fd);
+    return 0;
+  }
+
+  for (i = 0; i < lwm2m_wake.hdr.obs_count; i++)
+  {
+    int rec_idx;
+
+    if (efs_read(fd, &rec, sizeof(rec)) != sizeof(rec))
+      break;
+
+    rec_idx = lwm2m_wake_find_record(rec.serverID);
+    if (rec_idx < 0 || !lwm2m_wake.restored[rec_idx] || rec.tokenLen > TOKEN_LEN)
+      continue;
+    serverP = lwm2m_wake_find_server(contextP, rec.serverID);
+    if (serverP == NULL)
+      continue;
+
+    watcherP = prv_getWatcher(contextP, &rec.uri, serverP);
+    if (watcherP == NULL)
+      continue;
+
+    memcpy(watcherP->token, rec.token, TOKEN_LEN);
+    watcherP->tokenLen = rec.tokenLen;
+    watcherP->lastValue.asInteger = rec.lastValue.asInteger;
+    watcherP->lastTime = rec.lastTime;
+    watcherP->counter = rec.counter;
+    watcherP->lastMid = rec.lastMid;
+    watcherP->active = rec.active;
+    watcherP->format = rec.format;
+    watcherP->pmin_wait_count = rec.pmin_wait_count;
+    if (rec.isParameterSet)
+    {
+      if (watcherP->parameters == NULL)
+        watcherP->parameters = lwm2m_malloc(sizeof(lwm2m_attributes_t));
+      if (watcherP->parameters != NULL)
+        *watcherP->parameters = rec.parameters;
+    }
+    restored++;
+  }
+  efs_close(fd);
+  efs_unlink(LWM2M_WAKE_STATE_PERSISTENCE_FILE);
+
+  LOG_ARG("wake: %d observations restored", restored);
+  return restored;
+}
+
+void lwm2m_wake_value_changed(lwm2m_context_t * contextP)
+{
+  if (lwm2m_wake.loaded && !lwm2m_wake.obs_restored)
+    lwm2m_wake_restore_observations(contextP);
+}
+
+/* From lwm2m_step(): restores the observations when the first periodic
+ * report is due and sends the Updates lwm2m_wake_action() asks for. */
+void lwm2m_wake_step(lwm2m_context_t * contextP, time_t now, time_t * timeoutP)
+{
+  lwm2m_server_t * serverP;
+  int i;
+
+  if (contextP == NULL || !lwm2m_wake.loaded)
+    return;
+
+  if (!lwm2m_wake.obs_restored)
+  {
+    if (lwm2m_wake.hdr.obs_due == 0 || now >= lwm2m_wake.hdr.obs_due)
+      lwm2m_wake_restore_observations(contextP);
+    else if (timeoutP != NULL && lwm2m_wake.hdr.obs_due - now < *timeoutP)
+      *timeoutP = lwm2m_wake.hdr.obs_due - now;
+  }
+
+  for (i = 0; i < lwm2m_wake.hdr.server_count; i++)
+  {
+    if (!lwm2m_wake.restored[i] || lwm2m_wake.update_sent[i])
+      continue;
+
+    serverP = lwm2m_wake_find_server(contextP, lwm2m_wake.servers[i].short_id);
+    if (serverP == NULL || serverP->status != STATE_REGISTERED)
+      continue;
+
+    if (lwm2m_wake_action(serverP, now) == LWM2M_WAKE_UPDATE)
+    {
+      LOG_ARG("wake: Update for server %d", serverP->shortID);
+      lwm2m_update_registration_for_server(contextP, serverP, false);
+    }
+    lwm2m_wake.update_sent[i] = true;
+  }
+}
@@ -0,0 +1,468 @@
+/******************************************************************************
+
+  @file    notify_sched.c
+  @brief   pmin/pmax aware notification scheduler with batching and LwM2M Send
+
+  Each tracked observation or Send-reported resource has a window in which
+  a report is allowed: it opens at last + pmin and must be closed by
+  last + pmax (periodic) or, for a changed value, by the end of the hold
+  time. The scheduler picks one instant per server that satisfies the
+  most urgent window, moves it to a planned uplink when one falls inside,
+  and then reports every entry whose window is already open. Sensors that
+  change together are therefore reported in one radio wake-up, and the
+  Send-reported ones in one composite SenML-CBOR message.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <string.h>
+#include "internals.h"
+#include "cbor.h"
+#include "notify_sched.h"
+
+static notify_sched_t notify_sched_global;
+static bool notify_sched_global_init = false;
+
+notify_sched_t * notify_sched_default(void)
+{
+  if (!notify_sched_global_init)
+  {
+    notify_sched_init(&notify_sched_global, NOTIFY_SCHED_DEFAULT_HOLD, NOTIFY_SCHED_DEFAULT_PIGGYBACK_PCT);
+    notify_sched_global_init = true;
+  }
+  return &notify_sched_global;
+}
+
+void notify_sched_init(notify_sched_t * schedP, uint32_t max_hold, uint8_t piggyback_pct)
+{
+  if (schedP == NULL)
+    return;
+
+  memset(schedP, 0, sizeof(notify_sched_t));
+  schedP->max_hold      = max_hold;
+  schedP->piggyback_pct = (piggyback_pct > 100) ? 100 : piggyback_pct;
+  qurt_mutex_init(&schedP->lock);
+}
+
+static bool notify_sched_same_uri(const lwm2m_uri_t * a, const lwm2m_uri_t * b)
+{
+  return a->flag == b->flag && a->objectId == b->objectId &&
+         (!LWM2M_URI_IS_SET_INSTANCE(a) || a->instanceId == b->instanceId) &&
+         (!LWM2M_URI_IS_SET_RESOURCE(a) || a->resourceId == b->resourceId) &&
+         (!LWM2M_URI_IS_SET_RESOURCE_INST(a) || a->resourceInstId == b->resourceInstId);
+}
+
+/* True when a change at changedP is visible through an observation of
+ * watchedP, i.e. one of the two paths is a prefix of the other. */
+static bool notify_sched_overlaps(const lwm2m_uri_t * watchedP, const lwm2m_uri_t * changedP)
+{
+  if (!LWM2M_URI_IS_SET_OBJECT(watchedP) || !LWM2M_URI_IS_SET_OBJECT(changedP))
+    return true;
+  if (watchedP->objectId != changedP->objectId)
+    return false;
+  if (!LWM2M_URI_IS_SET_INSTANCE(watchedP) || !LWM2M_URI_IS_SET_INSTANCE(changedP))
+    return true;
+  if (watchedP->instanceId != changedP->instanceId)
+    return false;
+  if (!LWM2M_URI_IS_SET_RESOURCE(watchedP) || !LWM2M_URI_IS_SET_RESOURCE(changedP))
+    return true;
+  if (watchedP->resourceId != changedP->resourceId)
+    return false;
+  if (!LWM2M_URI_IS_SET_RESOURCE_INST(watchedP) || !LWM2M_URI_IS_SET_RESOURCE_INST(changedP))
+    return true;
+  return watchedP->resourceInstId == changedP->resourceInstId;
+}
+
+static time_t notify_sched_ready(const notify_sched_entry_t * e)
+{
+  return e->last + (time_t)e->pmin;
+}
+
+/* Latest instant the entry may be reported, 0 when it has nothing due. */
+static time_t notify_sched_deadline(const notify_sched_t * schedP, const notify_sched_entry_t * e)
+{
+  time_t ready = notify_sched_ready(e);
+  time_t limit;
+
+  if (!e->changed)
+    return (e->pmax != 0) ? e->last + (time_t)e->pmax : 0;
+
+  limit = ready + (time_t)schedP->max_hold;
+  if (e->pmax != 0 && e->last + (time_t)e->pmax < limit)
+    limit = e->last + (time_t)e->pmax;
+
+  return (limit < ready) ? ready : limit;
+}
+
+/* An open window is worth taking along when the value changed, or when a
+ * periodic report would be due soon anyway. */
+static bool notify_sched_worth(const notify_sched_t * schedP, const notify_sched_entry_t * e, time_t at)
+{
+  if (at < notify_sched_ready(e))
+    return false;
+  if (e->changed)
+    return true;
+  if (e->pmax == 0)
+    return false;
+  return (uint64_t)(at - e->last) * 100 >= (uint64_t)e->pmax * schedP->piggyback_pct;
+}
+
+static notify_sched_uplink_t * notify_sched_uplink(notify_sched_t * schedP, lwm2m_server_t * serverP, bool create)
+{
+  notify_sched_uplink_t * freeP = NULL;
+  int i;
+
+  for (i = 0; i < NOTIFY_SCHED_MAX_SERVERS; i++)
+  {
+    if (schedP->uplinks[i].server == serverP)
+      return &schedP->uplinks[i];
+    if (freeP == NULL && schedP->uplinks[i].server == NULL)
+      freeP = &schedP->uplinks[i];
+  }
+
+  if (create && freeP != NULL)
+    freeP->server = serverP;
+  return create ? freeP : NULL;
+}
+
+int notify_sched_track(notify_sched_t * schedP, lwm2m_server_t * serverP, lwm2m_watcher_t * watcherP,
+                       lwm2m_uri_t * uriP, uint32_t pmin, uint32_t pmax, time_t now)
+{
+  notify_sched_entry_t * e = NULL;
+  int i;
+
+  if (schedP == NULL || serverP == NULL || uriP == NULL)
+    return -1;
+
+  qurt_mutex_lock(&schedP->lock);
+  for (i = 0; i < NOTIFY_SCHED_MAX_ENTRIES; i++)
+  {
+    notify_sched_entry_t * cur = &schedP->entries[i];
+
+    if (cur->used && cur->server == serverP && cur->watcher == watcherP && notify_sched_same_uri(&cur->uri, uriP))
+    {
+      e = cur;
+      break;
+    }
+    if (e == NULL && !cur->used)
+      e = cur;
+  }
+
+  if (e == NULL)
+  {
+    qurt_mutex_unlock(&schedP->lock);
+    LOG("notify_sched full, observation reported unbatched");
+    return -1;
+  }
+
+  if (!e->used)
+  {
+    memset(e, 0, sizeof(notify_sched_entry_t));
+    e->uri     = *uriP;
+    e->server  = serverP;
+    e->watcher = watcherP;
+    e->last    = now;
+    e->used    = true;
+  }
+  e->pmin = pmin;
+  e->pmax = (pmax != 0 && pmax < pmin) ? pmin : pmax;
+  qurt_mutex_unlock(&schedP->lock);
+  return 0;
+}
+
+/* Drops matching entries. NULL watcher / URI act as wildcards, so a
+ * deregistration can clear a whole server. */
+void notify_sched_untrack(notify_sched_t * schedP, lwm2m_server_t * serverP, lwm2m_watcher_t * watcherP,
+                          lwm2m_uri_t * uriP)
+{
+  int i;
+
+  if (schedP == NULL)
+    return;
+
+  qurt_mutex_lock(&schedP->lock);
+  for (i = 0; i < NOTIFY_SCHED_MAX_ENTRIES; i++)
+  {
+    notify_sched_entry_t * e = &schedP->entries[i];
+
+    if (!e->used || e->server != serverP)
+      continue;
+    if (watcherP != NULL && e->watcher != watcherP)
+      continue;
+    if (uriP != NULL && !notify_sched_same_uri(&e->uri, uriP))
+      continue;
+    e->used = false;
+  }
+
+  if (watcherP == NULL && uriP == NULL)
+  {
+    notify_sched_uplink_t * u = notify_sched_uplink(schedP, serverP, false);
+
+    if (u != NULL)
+      memset(u, 0, sizeof(notify_sched_uplink_t));
+  }
+  qurt_mutex_unlock(&schedP->lock);
+}
+
+/* Called from lwm2m_resource_value_changed(). */
+void notify_sched_changed(notify_sched_t * schedP, lwm2m_uri_t * uriP)
+{
+  int i;
+
+  if (schedP == NULL || uriP == NULL)
+    return;
+
+  qurt_mutex_lock(&schedP->lock);
+  for (i = 0; i < NOTIFY_SCHED_MAX_ENTRIES; i++)
+  {
+    if (schedP->entries[i].used && notify_sched_overlaps(&schedP->entries[i].uri, uriP))
+      schedP->entries[i].changed = true;
+  }
+  qurt_mutex_unlock(&schedP->lock);
+}
+
+/* Registers the next uplink the client will make anyway (registration
+ * update, application data, PSM wake-up). Reports are moved onto it when
+ * their windows allow. */
+void notify_sched_plan_uplink(notify_sched_t * schedP, lwm2m_server_t * serverP, time_t when)
+{
+  notify_sched_uplink_t * u;
+
+  if (schedP == NULL || serverP == NULL)
+    return;
+
+  qurt_mutex_lock(&schedP->lock);
+  u = notify_sched_uplink(schedP, serverP, true);
+  if (u != NULL)
+    u->uplink = when;
+  qurt_mutex_unlock(&schedP->lock);
+}
+
+static time_t notify_sched_due_locked(notify_sched_t * schedP, lwm2m_server_t * serverP, time_t now)
+{
+  notify_sched_uplink_t * u;
+  time_t due = 0;
+  int i;
+
+  for (i = 0; i < NOTIFY_SCHED_MAX_ENTRIES; i++)
+  {
+    notify_sched_entry_t * e = &schedP->entries[i];
+    time_t deadline;
+
+    if (!e->used || e->server != serverP)
+      continue;
+
+    deadline = notify_sched_deadline(schedP, e);
+    if (deadline != 0 && (due == 0 || deadline < due))
+      due = deadline;
+  }
+
+  if (due == 0)
+    return 0;
+
+  /* an earlier planned uplink wins if it can already carry something */
+  u = notify_sched_uplink(schedP, serverP, false);
+  if (u != NULL && u->uplink != 0 && u->uplink >= now && u->uplink < due)
+  {
+    for (i = 0; i < NOTIFY_SCHED_MAX_ENTRIES; i++)
+    {
+      notify_sched_entry_t * e = &schedP->entries[i];
+
+      if (e->used && e->server == serverP && e->changed && notify_sched_ready(e) <= u->uplink)
+      {
+        due = u->uplink;
+        break;
+      }
+    }
+  }
+
+  return (due < now) ? now : due;
+}
+
+/* Absolute time of the next batch for serverP, 0 if nothing is pending. */
+time_t notify_sched_due(notify_sched_t * schedP, lwm2m_server_t * serverP, time_t now)
+{
+  time_t due;
+
+  if (schedP == NULL)
+    return 0;
+
+  qurt_mutex_lock(&schedP->lock);
+  due = notify_sched_due_locked(schedP, serverP, now);
+  qurt_mutex_unlock(&schedP->lock);
+  return due;
+}
+
+/* Lowers *timeoutP to the next batch of any server, for lwm2m_step(). */
+void notify_sched_step(notify_sched_t * schedP, time_t now, time_t * timeoutP)
+{
+  int i;
+
+  if (schedP == NULL || timeoutP == NULL)
+    return;
+
+  qurt_mutex_lock(&schedP->lock);
+  for (i = 0; i < NOTIFY_SCHED_MAX_ENTRIES; i++)
+  {
+    notify_sched_entry_t * e = &schedP->entries[i];
+    time_t due;
+    int j;
+
+    if (!e->used)
+      continue;
+
+    /* evaluate each server once, at its first entry */
+    for (j = 0; j < i; j++)
+    {
+      if (schedP->entries[j].used && schedP->entries[j].server == e->server)
+        break;
+    }
+    if (j != i)
+      continue;
+
+    due = notify_sched_due_locked(schedP, e->server, now);
+    if (due != 0 && due - now < *timeoutP)
+      *timeoutP = due - now;
+  }
+  qurt_mutex_unlock(&schedP->lock);
+}
+
+/* When the batch of serverP is due, hands out every entry worth reporting
+ * now and restarts their windows. Entries with a watcher are notified by
+ * observe_step() back to back in this wake-up, the others go out in one
+ * notify_sched_send(). Returns the number of entries in batch. */
+int notify_sched_collect(notify_sched_t * schedP, lwm2m_server_t * serverP, time_t now,
+                         notify_sched_entry_t ** batch, int max)
+{
+  notify_sched_uplink_t * u;
+  time_t due;
+  int count = 0;
+  int i;
+
+  if (schedP == NULL || batch == NULL || max <= 0)
+    return 0;
+
+  qurt_mutex_lock(&schedP->lock);
+  due = notify_sched_due_locked(schedP, serverP, now);
+  if (due == 0 || due > now)
+  {
+    qurt_mutex_unlock(&schedP->lock);
+    return 0;
+  }
+
+  for (i = 0; i < NOTIFY_SCHED_MAX_ENTRIES && count < max; i++)
+  {
+    notify_sched_entry_t * e = &schedP->entries[i];
+    time_t deadline;
+
+    if (!e->used || e->server != serverP)
+      continue;
+
+    deadline = notify_sched_deadline(schedP, e);
+    if ((deadline != 0 && deadline <= now) || notify_sched_worth(schedP, e, now))
+    {
+      batch[count++] = e;
+      e->last    = now;
+      e->changed = false;
+    }
+  }
+
+  u = notify_sched_uplink(schedP, serverP, false);
+  if (u != NULL && u->uplink <= now)
+    u->uplink = 0;
+
+  if (count != 0)
+  {
+    schedP->batches++;
+    schedP->reports += (uint32_t)count;
+  }
+  qurt_mutex_unlock(&schedP->lock);
+
+  LOG_ARG("notify_sched: %d reports in batch %u", count, (unsigned)schedP->batches);
+  return count;
+}
+
+static void notify_sched_send_cb(qapi_Coap_Session_Hdl_t hdl, qapi_Coap_Transaction_t * transacP,
+                                 qapi_Coap_Packet_t * message)
+{
+  if (message == NULL)
+  {
+    LOG("Send to /dp timed out");
+  }
+  else
+  {
+    LOG_ARG("Send to /dp answered %u", (unsigned)message->code);
+  }
+}
+
+/* Reports the Send-reported entries (no watcher) of a batch as one
+ * composite SenML-CBOR POST to /dp (LwM2M 1.1 Send). Returns the number
+ * of resources sent, or -1 when the server cannot take a Send. */
+int notify_sched_send(lwm2m_context_t * contextP, lwm2m_server_t * serverP,
+                      notify_sched_entry_t ** batch, int count)
+{
+  lwm2m_uri_t    uris[NOTIFY_SCHED_MAX_ENTRIES];
+  int            sizes[NOTIFY_SCHED_MAX_ENTRIES];
+  lwm2m_data_t * datas[NOTIFY_SCHED_MAX_ENTRIES];
+  qapi_Coap_Packet_t * message = NULL;
+  qapi_Coap_Message_Params_t params;
+  qapi_Coap_Content_Type_t content_type = (qapi_Coap_Content_Type_t)CBOR_CONTENT_SENML_CBOR;
+  uint8_t * buffer = NULL;
+  size_t    length;
+  int       groups = 0;
+  int       result = -1;
+  int       i;
+
+  if (contextP == NULL || serverP == NULL || serverP->coapHandle == NULL || serverP->version < 1.1f)
+    return -1;
+
+  for (i = 0; i < count && groups < NOTIFY_SCHED_MAX_ENTRIES; i++)
+  {
+    if (batch[i]->watcher != NULL)
+      continue;
+
+    uris[groups]  = batch[i]->uri;
+    sizes[groups] = 0;
+    datas[groups] = NULL;
+    if (object_readData(contextP, &uris[groups], &sizes[groups], &datas[groups], serverP) != LWM2M_205_CONTENT)
+    {
+      LOG_URI(&uris[groups]);
+      continue;
+    }
+    groups++;
+  }
+
+  if (groups == 0)
+    return 0;
+
+  length = senml_cbor_serialize_multi(groups, uris, sizes, datas, &buffer);
+  if (length == 0)
+    goto exit;
+
+  if (qapi_Coap_Init_Message(serverP->coapHandle, &message, QAPI_COAP_TYPE_CON, QAPI_COAP_POST) != QAPI_OK)
+    goto exit;
+
+  qapi_Coap_Set_Header(serverP->coapHandle, message, QAPI_COAP_URI_PATH, NOTIFY_SCHED_SEND_PATH,
+                       strlen(NOTIFY_SCHED_SEND_PATH));
+  qapi_Coap_Set_Header(serverP->coapHandle, message, QAPI_COAP_CONTENT_TYPE, &content_type, sizeof(content_type));
+  qapi_Coap_Set_Payload(serverP->coapHandle, message, buffer, length);
+
+  memset(&params, 0, sizeof(params));
+  params.msg_cb = notify_sched_send_cb;
+
+  /* the message is owned by the CoAP stack from here on, also on failure */
+  if (qapi_Coap_Send_Message(serverP->coapHandle, message, &params) == QAPI_OK)
+    result = groups;
+
+exit:
+  if (buffer != NULL)
+    lwm2m_free(buffer);
+  for (i = 0; i < groups; i++)
+    lwm2m_data_free(sizes[i], datas[i]);
+  return result;
+}
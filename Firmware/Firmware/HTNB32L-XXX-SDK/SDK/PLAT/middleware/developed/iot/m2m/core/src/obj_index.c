@@ -0,0 +1,446 @@
+/******************************************************************************
+
+  @file    obj_index.c
+  @brief   Sorted object/instance/resource index for LwM2M URI dispatch
+
+  The object list and each object's instance list are singly linked and
+  every read, write, observe check and notification walked them through
+  lwm2m_list_find(). This module keeps a sorted array of objects, each with
+  a sorted array of its instances and an optional sorted resource table,
+  so that resolving /o/i/r costs three binary searches.
+
+  The lists stay the owners of the nodes. The index only mirrors them: the
+  object add/remove and instance create/delete paths update it, and a
+  lookup that misses in the index falls back to the list and repairs the
+  index, so an instance added behind its back is still found. An instance
+  removed behind its back must be reported with obj_index_remove_instance()
+  or obj_index_sync_object() before its node is freed.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <string.h>
+#include "internals.h"
+#include "obj_index.h"
+
+static obj_index_t obj_index_global;
+
+obj_index_t * obj_index_default(void)
+{
+  return &obj_index_global;
+}
+
+/* First position whose id is >= id. */
+static uint16_t obj_index_obj_pos(const obj_index_t * idxP, uint16_t id)
+{
+  uint16_t lo = 0;
+  uint16_t hi = idxP->count;
+
+  while (lo < hi)
+  {
+    uint16_t mid = lo + (hi - lo) / 2;
+    if (idxP->objs[mid].id < id)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static uint16_t obj_index_inst_pos(const obj_index_obj_t * entryP, uint16_t id)
+{
+  uint16_t lo = 0;
+  uint16_t hi = entryP->inst_count;
+
+  while (lo < hi)
+  {
+    uint16_t mid = lo + (hi - lo) / 2;
+    if (entryP->insts[mid].id < id)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static obj_index_obj_t * obj_index_entry(obj_index_t * idxP, uint16_t objectId)
+{
+  uint16_t pos;
+
+  if (idxP == NULL || idxP->count == 0)
+    return NULL;
+
+  pos = obj_index_obj_pos(idxP, objectId);
+  if (pos < idxP->count && idxP->objs[pos].id == objectId)
+    return &idxP->objs[pos];
+  return NULL;
+}
+
+/* Make room for one more element of an array of elem_size bytes. */
+static int obj_index_grow(void ** arrayP, uint16_t * capP, uint16_t count, size_t elem_size)
+{
+  void * bigger;
+  uint32_t cap;
+
+  if (count < *capP)
+    return 0;
+
+  cap = (*capP == 0) ? OBJ_INDEX_MIN_CAPACITY : (uint32_t)*capP * 2;
+  if (cap > LWM2M_MAX_ID)
+    cap = LWM2M_MAX_ID;
+  if (cap <= count)
+    return -1;
+
+  bigger = lwm2m_malloc(cap * elem_size);
+  if (bigger == NULL)
+    return -1;
+
+  if (*arrayP != NULL)
+  {
+    memcpy(bigger, *arrayP, count * elem_size);
+    lwm2m_free(*arrayP);
+  }
+  *arrayP = bigger;
+  *capP = (uint16_t)cap;
+  return 0;
+}
+
+static int obj_index_insert_inst(obj_index_obj_t * entryP, lwm2m_list_t * instanceP)
+{
+  uint16_t pos = obj_index_inst_pos(entryP, instanceP->id);
+
+  if (pos < entryP->inst_count && entryP->insts[pos].id == instanceP->id)
+  {
+    entryP->insts[pos].node = instanceP;
+    return 0;
+  }
+
+  if (obj_index_grow((void **)&entryP->insts, &entryP->inst_cap, entryP->inst_count,
+                     sizeof(obj_index_inst_t)) != 0)
+    return -1;
+
+  memmove(&entryP->insts[pos + 1], &entryP->insts[pos],
+          (entryP->inst_count - pos) * sizeof(obj_index_inst_t));
+  entryP->insts[pos].id   = instanceP->id;
+  entryP->insts[pos].node = instanceP;
+  entryP->inst_count++;
+  return 0;
+}
+
+/* Reload the instances of entryP from its object's list. The list is
+ * sorted by id already (lwm2m_list_add() keeps it that way), so this is
+ * an append in the common case. */
+static int obj_index_load_insts(obj_index_obj_t * entryP)
+{
+  lwm2m_list_t * nodeP;
+
+  entryP->inst_count = 0;
+  for (nodeP = entryP->objectP->instanceList; nodeP != NULL; nodeP = nodeP->next)
+  {
+    if (obj_index_insert_inst(entryP, nodeP) != 0)
+    {
+      entryP->inst_count = 0;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void obj_index_clear(obj_index_t * idxP)
+{
+  uint16_t i;
+
+  if (idxP == NULL)
+    return;
+
+  for (i = 0; i < idxP->count; i++)
+  {
+    if (idxP->objs[i].insts != NULL)
+      lwm2m_free(idxP->objs[i].insts);
+  }
+  if (idxP->objs != NULL)
+    lwm2m_free(idxP->objs);
+  memset(idxP, 0, sizeof(obj_index_t));
+}
+
+int obj_index_add_object(obj_index_t * idxP, lwm2m_object_t * objectP)
+{
+  obj_index_obj_t * entryP;
+  uint16_t pos;
+
+  if (idxP == NULL || objectP == NULL)
+    return -1;
+
+  pos = obj_index_obj_pos(idxP, objectP->objID);
+  if (pos < idxP->count && idxP->objs[pos].id == objectP->objID)
+  {
+    entryP = &idxP->objs[pos];
+  }
+  else
+  {
+    if (obj_index_grow((void **)&idxP->objs, &idxP->cap, idxP->count, sizeof(obj_index_obj_t)) != 0)
+    {
+      LOG_ARG("obj_index: no memory for object %d", objectP->objID);
+      return -1;
+    }
+    memmove(&idxP->objs[pos + 1], &idxP->objs[pos], (idxP->count - pos) * sizeof(obj_index_obj_t));
+    entryP = &idxP->objs[pos];
+    memset(entryP, 0, sizeof(obj_index_obj_t));
+    entryP->id = objectP->objID;
+    idxP->count++;
+  }
+
+  entryP->objectP = objectP;
+  return obj_index_load_insts(entryP);
+}
+
+void obj_index_remove_object(obj_index_t * idxP, uint16_t objectId)
+{
+  obj_index_obj_t * entryP = obj_index_entry(idxP, objectId);
+  uint16_t pos;
+
+  if (entryP == NULL)
+    return;
+
+  if (entryP->insts != NULL)
+    lwm2m_free(entryP->insts);
+
+  pos = (uint16_t)(entryP - idxP->objs);
+  memmove(&idxP->objs[pos], &idxP->objs[pos + 1], (idxP->count - pos - 1) * sizeof(obj_index_obj_t));
+  idxP->count--;
+}
+
+int obj_index_sync_object(obj_index_t * idxP, lwm2m_object_t * objectP)
+{
+  obj_index_obj_t * entryP;
+
+  if (objectP == NULL)
+    return -1;
+
+  entryP = obj_index_entry(idxP, objectP->objID);
+  if (entryP == NULL)
+    return obj_index_add_object(idxP, objectP);
+
+  entryP->objectP = objectP;
+  return obj_index_load_insts(entryP);
+}
+
+int obj_index_rebuild(obj_index_t * idxP, lwm2m_context_t * contextP)
+{
+  lwm2m_object_t * objectP;
+  uint16_t i = 0;
+
+  if (idxP == NULL || contextP == NULL)
+    return -1;
+
+  /* Drop objects that left the list but keep the resource tables of
+   * those that stay. */
+  while (i < idxP->count)
+  {
+    if (LWM2M_LIST_FIND(contextP->objectList, idxP->objs[i].id) == NULL)
+      obj_index_remove_object(idxP, idxP->objs[i].id);
+    else
+      i++;
+  }
+
+  for (objectP = contextP->objectList; objectP != NULL; objectP = objectP->next)
+  {
+    if (obj_index_add_object(idxP, objectP) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+int obj_index_add_instance(obj_index_t * idxP, uint16_t objectId, lwm2m_list_t * instanceP)
+{
+  obj_index_obj_t * entryP = obj_index_entry(idxP, objectId);
+
+  if (entryP == NULL || instanceP == NULL)
+    return -1;
+  return obj_index_insert_inst(entryP, instanceP);
+}
+
+void obj_index_remove_instance(obj_index_t * idxP, uint16_t objectId, uint16_t instanceId)
+{
+  obj_index_obj_t * entryP = obj_index_entry(idxP, objectId);
+  uint16_t pos;
+
+  if (entryP == NULL)
+    return;
+
+  pos = obj_index_inst_pos(entryP, instanceId);
+  if (pos >= entryP->inst_count || entryP->insts[pos].id != instanceId)
+    return;
+
+  memmove(&entryP->insts[pos], &entryP->insts[pos + 1],
+          (entryP->inst_count - pos - 1) * sizeof(obj_index_inst_t));
+  entryP->inst_count--;
+}
+
+/* ids must be sorted ascending and stay valid while the object is
+ * registered; objects pass their static resource tables. */
+int obj_index_set_resources(obj_index_t * idxP, uint16_t objectId, const uint16_t * ids, uint16_t count)
+{
+  obj_index_obj_t * entryP = obj_index_entry(idxP, objectId);
+  uint16_t i;
+
+  if (entryP == NULL || (ids == NULL && count != 0))
+    return -1;
+
+  for (i = 1; i < count; i++)
+  {
+    if (ids[i - 1] >= ids[i])
+    {
+      LOG_ARG("obj_index: resource table of object %d is not sorted", objectId);
+      return -1;
+    }
+  }
+
+  entryP->res       = ids;
+  entryP->res_count = count;
+  return 0;
+}
+
+lwm2m_object_t * obj_index_find_object(obj_index_t * idxP, lwm2m_context_t * contextP, uint16_t objectId)
+{
+  obj_index_obj_t * entryP = obj_index_entry(idxP, objectId);
+  lwm2m_object_t * objectP;
+
+  if (entryP != NULL)
+  {
+    idxP->hits++;
+    return entryP->objectP;
+  }
+
+  if (contextP == NULL)
+    return NULL;
+
+  objectP = (lwm2m_object_t *)LWM2M_LIST_FIND(contextP->objectList, objectId);
+  if (objectP != NULL && idxP != NULL)
+  {
+    idxP->misses++;
+    obj_index_add_object(idxP, objectP);
+  }
+  return objectP;
+}
+
+lwm2m_list_t * obj_index_find_instance(obj_index_t * idxP, lwm2m_object_t * objectP, uint16_t instanceId)
+{
+  obj_index_obj_t * entryP;
+  lwm2m_list_t * instanceP;
+  uint16_t pos;
+
+  if (objectP == NULL)
+    return NULL;
+
+  entryP = obj_index_entry(idxP, objectP->objID);
+  if (entryP != NULL && entryP->objectP == objectP)
+  {
+    pos = obj_index_inst_pos(entryP, instanceId);
+    if (pos < entryP->inst_count && entryP->insts[pos].id == instanceId)
+    {
+      idxP->hits++;
+      return entryP->insts[pos].node;
+    }
+  }
+
+  instanceP = lwm2m_list_find(objectP->instanceList, instanceId);
+  if (instanceP != NULL && idxP != NULL)
+  {
+    idxP->misses++;
+    if (entryP == NULL || entryP->objectP != objectP)
+      obj_index_sync_object(idxP, objectP);
+    else
+      obj_index_insert_inst(entryP, instanceP);
+  }
+  return instanceP;
+}
+
+/* Objects that never registered a resource table accept any resource ID
+ * here; their read/write callbacks keep rejecting unknown ones. */
+bool obj_index_has_resource(obj_index_t * idxP, uint16_t objectId, uint16_t resourceId)
+{
+  obj_index_obj_t * entryP = obj_index_entry(idxP, objectId);
+  uint16_t lo = 0;
+  uint16_t hi;
+
+  if (entryP == NULL || entryP->res == NULL)
+    return true;
+
+  hi = entryP->res_count;
+  while (lo < hi)
+  {
+    uint16_t mid = lo + (hi - lo) / 2;
+    if (entryP->res[mid] == resourceId)
+      return true;
+    if (entryP->res[mid] < resourceId)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return false;
+}
+
+/* Same result as lwm2m_list_newId(): the lowest unused instance ID. With
+ * unique sorted IDs, insts[i].id - i never decreases, so the first gap is
+ * the first i with insts[i].id > i and can be found by bisection. */
+uint16_t obj_index_new_instance_id(obj_index_t * idxP, lwm2m_object_t * objectP)
+{
+  obj_index_obj_t * entryP;
+  uint16_t lo = 0;
+  uint16_t hi;
+
+  if (objectP == NULL)
+    return 0;
+
+  entryP = obj_index_entry(idxP, objectP->objID);
+  if (entryP == NULL || entryP->objectP != objectP)
+    return lwm2m_list_newId(objectP->instanceList);
+
+  hi = entryP->inst_count;
+  while (lo < hi)
+  {
+    uint16_t mid = lo + (hi - lo) / 2;
+    if (entryP->insts[mid].id > mid)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+uint8_t obj_index_resolve(obj_index_t * idxP, lwm2m_context_t * contextP, lwm2m_uri_t * uriP,
+                          lwm2m_object_t ** objectPP, lwm2m_list_t ** instancePP)
+{
+  lwm2m_object_t * objectP;
+  lwm2m_list_t * instanceP = NULL;
+
+  if (uriP == NULL || !LWM2M_URI_IS_SET_OBJECT(uriP))
+    return LWM2M_404_NOT_FOUND;
+
+  objectP = obj_index_find_object(idxP, contextP, uriP->objectId);
+  if (objectP == NULL)
+    return LWM2M_404_NOT_FOUND;
+
+  if (LWM2M_URI_IS_SET_INSTANCE(uriP))
+  {
+    instanceP = obj_index_find_instance(idxP, objectP, uriP->instanceId);
+    if (instanceP == NULL)
+      return LWM2M_404_NOT_FOUND;
+
+    if (LWM2M_URI_IS_SET_RESOURCE(uriP) &&
+        !obj_index_has_resource(idxP, uriP->objectId, uriP->resourceId))
+      return LWM2M_404_NOT_FOUND;
+  }
+
+  if (objectPP != NULL)
+    *objectPP = objectP;
+  if (instancePP != NULL)
+    *instancePP = instanceP;
+  return LWM2M_NO_ERROR;
+}
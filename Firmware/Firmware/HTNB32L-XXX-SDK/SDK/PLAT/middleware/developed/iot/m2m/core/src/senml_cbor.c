@@ -0,0 +1,425 @@
+/******************************************************************************
+
+  @file    senml_cbor.c
+  @brief   SenML-CBOR content format (application/senml+cbor, 112)
+
+  RFC 8428 records as CBOR maps with integer labels. The base name is only
+  sent once, every following record just carries its relative name, and
+  the encoder writes straight into the payload buffer after a sizing pass.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include "internals.h"
+#include "cbor.h"
+
+#define SENML_LABEL_BN      (-2)
+#define SENML_LABEL_BT      (-3)
+#define SENML_LABEL_N       0
+#define SENML_LABEL_V       2
+#define SENML_LABEL_VS      3
+#define SENML_LABEL_VB      4
+#define SENML_LABEL_VD      8
+#define SENML_LABEL_VLO     "vlo"
+#define SENML_LABEL_VLO_LEN 3
+
+#define SENML_NAME_MAX      32
+
+static int senml_cbor_path_to_text(const uint16_t * ids, uint8_t from, uint8_t to, bool trailing, char * str, size_t len)
+{
+  int pos = 0;
+  uint8_t i;
+
+  for (i = from; i < to; i++)
+  {
+    int n = snprintf(str + pos, len - pos, (i + 1 < to || trailing) ? "%u/" : "%u", (unsigned)ids[i]);
+
+    if (n < 0 || (size_t)(pos + n) >= len)
+      return -1;
+    pos += n;
+  }
+  return pos;
+}
+
+static int senml_cbor_count(int size, const lwm2m_data_t * dataP)
+{
+  int count = 0;
+  int i;
+
+  for (i = 0; i < size; i++)
+  {
+    switch (dataP[i].type)
+    {
+      case LWM2M_TYPE_OBJECT:
+      case LWM2M_TYPE_OBJECT_INSTANCE:
+      case LWM2M_TYPE_MULTIPLE_RESOURCE:
+        count += senml_cbor_count((int)dataP[i].value.asChildren.count, dataP[i].value.asChildren.array);
+        break;
+      case LWM2M_TYPE_UNDEFINED:
+        break;
+      default:
+        count++;
+        break;
+    }
+  }
+  return count;
+}
+
+static bool senml_cbor_write_records(cbor_writer_t * w, uint16_t * ids, uint8_t base, uint8_t depth,
+                                     int size, const lwm2m_data_t * dataP, bool * first)
+{
+  int i;
+
+  if (depth >= CBOR_MAX_DEPTH)
+    return false;
+
+  for (i = 0; i < size; i++)
+  {
+    const lwm2m_data_t * d = &dataP[i];
+    char name[SENML_NAME_MAX];
+    int  len;
+
+    ids[depth] = d->id;
+
+    switch (d->type)
+    {
+      case LWM2M_TYPE_OBJECT:
+      case LWM2M_TYPE_OBJECT_INSTANCE:
+      case LWM2M_TYPE_MULTIPLE_RESOURCE:
+        if (!senml_cbor_write_records(w, ids, base, (uint8_t)(depth + 1), (int)d->value.asChildren.count,
+                                      d->value.asChildren.array, first))
+          return false;
+        continue;
+      case LWM2M_TYPE_UNDEFINED:
+        continue;
+      default:
+        break;
+    }
+
+    cbor_put_head(w, CBOR_MAJOR_MAP, *first ? 3 : 2);
+    if (*first)
+    {
+      name[0] = '/';
+      len = senml_cbor_path_to_text(ids, 0, base, true, name + 1, sizeof(name) - 1);
+      if (len < 0)
+        return false;
+      cbor_put_int(w, SENML_LABEL_BN);
+      cbor_put_bytes(w, CBOR_MAJOR_TSTR, (const uint8_t *)name, (size_t)len + 1);
+      *first = false;
+    }
+
+    len = senml_cbor_path_to_text(ids, base, (uint8_t)(depth + 1), false, name, sizeof(name));
+    if (len < 0)
+      return false;
+    cbor_put_int(w, SENML_LABEL_N);
+    cbor_put_bytes(w, CBOR_MAJOR_TSTR, (const uint8_t *)name, (size_t)len);
+
+    switch (d->type)
+    {
+      case LWM2M_TYPE_INTEGER:
+      case LWM2M_TYPE_FLOAT:
+        cbor_put_int(w, SENML_LABEL_V);
+        break;
+      case LWM2M_TYPE_STRING:
+        cbor_put_int(w, SENML_LABEL_VS);
+        break;
+      case LWM2M_TYPE_BOOLEAN:
+        cbor_put_int(w, SENML_LABEL_VB);
+        break;
+      case LWM2M_TYPE_OPAQUE:
+        cbor_put_int(w, SENML_LABEL_VD);
+        break;
+      case LWM2M_TYPE_OBJECT_LINK:
+        cbor_put_bytes(w, CBOR_MAJOR_TSTR, (const uint8_t *)SENML_LABEL_VLO, SENML_LABEL_VLO_LEN);
+        break;
+      default:
+        return false;
+    }
+    if (!cbor_put_value(w, d))
+      return false;
+  }
+  return true;
+}
+
+/* Writes one SenML pack for any number of (URI, data) groups. Each group
+ * opens with its own base name, so a composite Send needs no tree. */
+static size_t senml_cbor_write(int groups, lwm2m_uri_t * uris, int * sizes, lwm2m_data_t ** datas, cbor_writer_t * w)
+{
+  uint16_t ids[CBOR_MAX_DEPTH];
+  int      count = 0;
+  int      g;
+
+  for (g = 0; g < groups; g++)
+    count += senml_cbor_count(sizes[g], datas[g]);
+  if (count == 0)
+    return 0;
+
+  cbor_put_head(w, CBOR_MAJOR_ARRAY, (uint64_t)count);
+  for (g = 0; g < groups; g++)
+  {
+    uint8_t base = cbor_uri_base_depth(&uris[g]);
+    bool    first = true;
+
+    cbor_uri_to_ids(&uris[g], ids);
+    if (!senml_cbor_write_records(w, ids, base, base, sizes[g], datas[g], &first))
+      return 0;
+  }
+
+  return w->overflow ? 0 : w->pos;
+}
+
+/* Encodes into a caller supplied buffer, typically the CoAP payload area.
+ * Returns the payload length or 0 if it does not fit. */
+size_t senml_cbor_serialize_to(lwm2m_uri_t * uriP, int size, lwm2m_data_t * dataP, uint8_t * buffer, size_t length)
+{
+  cbor_writer_t w;
+
+  cbor_writer_init(&w, buffer, length);
+  return senml_cbor_write(1, uriP, &size, &dataP, &w);
+}
+
+size_t senml_cbor_serialize_multi(int groups, lwm2m_uri_t * uris, int * sizes, lwm2m_data_t ** datas,
+                                  uint8_t ** bufferP)
+{
+  cbor_writer_t w;
+  size_t length;
+
+  *bufferP = NULL;
+
+  cbor_writer_init(&w, NULL, 0);
+  length = senml_cbor_write(groups, uris, sizes, datas, &w);
+  if (length == 0)
+    return 0;
+
+  *bufferP = (uint8_t *)lwm2m_malloc(length);
+  if (*bufferP == NULL)
+    return 0;
+
+  cbor_writer_init(&w, *bufferP, length);
+  if (senml_cbor_write(groups, uris, sizes, datas, &w) != length)
+  {
+    lwm2m_free(*bufferP);
+    *bufferP = NULL;
+    return 0;
+  }
+  return length;
+}
+
+size_t senml_cbor_serialize(lwm2m_uri_t * uriP, int size, lwm2m_data_t * dataP, uint8_t ** bufferP)
+{
+  return senml_cbor_serialize_multi(1, uriP, &size, &dataP, bufferP);
+}
+
+static int senml_cbor_text_to_path(const char * str, size_t len, cbor_record_t * rec)
+{
+  size_t   i = 0;
+  uint32_t val;
+
+  if (len == 0 || str[0] != '/')
+    return -1;
+
+  rec->depth = 0;
+  i = 1;
+  while (i < len)
+  {
+    size_t start = i;
+
+    val = 0;
+    while (i < len && str[i] >= '0' && str[i] <= '9')
+    {
+      val = val * 10 + (uint32_t)(str[i] - '0');
+      if (val > 0xFFFF)
+        return -1;
+      i++;
+    }
+    if (i == start || rec->depth >= CBOR_MAX_DEPTH)
+      return -1;
+    rec->ids[rec->depth++] = (uint16_t)val;
+
+    if (i < len)
+    {
+      if (str[i] != '/')
+        return -1;
+      i++;
+    }
+  }
+  return rec->depth == 0 ? -1 : 0;
+}
+
+/* Skips one complete data item (used for labels we do not care about). */
+static int senml_cbor_skip(cbor_reader_t * r, int nesting)
+{
+  cbor_item_t item;
+  uint64_t n;
+
+  if (nesting > CBOR_MAX_DEPTH || cbor_get_item(r, &item) != 0)
+    return -1;
+
+  if (item.major == CBOR_MAJOR_TAG)
+    return senml_cbor_skip(r, nesting + 1);
+
+  if (item.major != CBOR_MAJOR_ARRAY && item.major != CBOR_MAJOR_MAP)
+    return 0;
+
+  if (item.indefinite)
+  {
+    while (!cbor_at_break(r))
+    {
+      if (senml_cbor_skip(r, nesting + 1) != 0)
+        return -1;
+      if (item.major == CBOR_MAJOR_MAP && senml_cbor_skip(r, nesting + 1) != 0)
+        return -1;
+    }
+    return 0;
+  }
+
+  for (n = 0; n < item.val * (item.major == CBOR_MAJOR_MAP ? 2 : 1); n++)
+  {
+    if (senml_cbor_skip(r, nesting + 1) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+int senml_cbor_parse(lwm2m_uri_t * uriP, uint8_t * buffer, size_t bufferLen, lwm2m_data_t ** dataP)
+{
+  cbor_record_t * records;
+  cbor_reader_t r;
+  cbor_item_t   item;
+  char     bn[SENML_NAME_MAX];
+  size_t   bn_len = 0;
+  uint64_t remaining;
+  bool     indefinite;
+  int      count = 0;
+  int      result = -1;
+
+  *dataP = NULL;
+
+  cbor_reader_init(&r, buffer, bufferLen);
+  if (cbor_get_item(&r, &item) != 0 || item.major != CBOR_MAJOR_ARRAY)
+    return -1;
+  indefinite = item.indefinite;
+  remaining  = item.val;
+
+  records = (cbor_record_t *)lwm2m_malloc(CBOR_MAX_RECORDS * sizeof(cbor_record_t));
+  if (records == NULL)
+    return -1;
+  memset(records, 0, CBOR_MAX_RECORDS * sizeof(cbor_record_t));
+
+  while (indefinite ? !cbor_at_break(&r) : remaining-- > 0)
+  {
+    cbor_record_t * rec;
+    char     name[2 * SENML_NAME_MAX];
+    size_t   name_len = 0;
+    bool     has_value = false;
+    uint64_t labels;
+    bool     map_indef;
+
+    if (cbor_get_item(&r, &item) != 0 || item.major != CBOR_MAJOR_MAP)
+      goto exit;
+    map_indef = item.indefinite;
+    labels    = item.val;
+
+    if (count >= CBOR_MAX_RECORDS)
+      goto exit;
+    rec = &records[count];
+
+    while (map_indef ? !cbor_at_break(&r) : labels-- > 0)
+    {
+      cbor_item_t label;
+      cbor_item_t value;
+      int64_t     key;
+
+      if (cbor_get_item(&r, &label) != 0)
+        goto exit;
+
+      if (label.major == CBOR_MAJOR_TSTR)
+      {
+        if (label.val != SENML_LABEL_VLO_LEN || memcmp(label.ptr, SENML_LABEL_VLO, SENML_LABEL_VLO_LEN) != 0)
+        {
+          if (senml_cbor_skip(&r, 0) != 0)
+            goto exit;
+          continue;
+        }
+        if (cbor_get_item(&r, &value) != 0 || value.major != CBOR_MAJOR_TSTR ||
+            cbor_parse_objlink(value.ptr, (size_t)value.val, &rec->value.value.asObjLink) != 0)
+          goto exit;
+        rec->value.type = LWM2M_TYPE_OBJECT_LINK;
+        has_value = true;
+        continue;
+      }
+
+      if (cbor_item_to_int(&label, &key) != 0)
+        goto exit;
+
+      if (key != SENML_LABEL_BN && key != SENML_LABEL_N && key != SENML_LABEL_V && key != SENML_LABEL_VS &&
+          key != SENML_LABEL_VB && key != SENML_LABEL_VD)
+      {
+        if (senml_cbor_skip(&r, 0) != 0)                    /* bt, t, u, s, ... */
+          goto exit;
+        continue;
+      }
+
+      if (cbor_get_item(&r, &value) != 0)
+        goto exit;
+
+      switch (key)
+      {
+        case SENML_LABEL_BN:
+          if (value.major != CBOR_MAJOR_TSTR || value.val >= sizeof(bn))
+            goto exit;
+          memcpy(bn, value.ptr, (size_t)value.val);
+          bn_len = (size_t)value.val;
+          break;
+
+        case SENML_LABEL_N:
+          if (value.major != CBOR_MAJOR_TSTR || value.val >= sizeof(name) - SENML_NAME_MAX)
+            goto exit;
+          memcpy(name + SENML_NAME_MAX, value.ptr, (size_t)value.val);
+          name_len = (size_t)value.val;
+          break;
+
+        case SENML_LABEL_V:
+          if (value.major != CBOR_MAJOR_UINT && value.major != CBOR_MAJOR_NINT &&
+              !(value.major == CBOR_MAJOR_SIMPLE && value.ai >= CBOR_AI_FLOAT16 && value.ai <= CBOR_AI_FLOAT64))
+            goto exit;
+          /* fall through */
+        default:
+          if ((key == SENML_LABEL_VS && value.major != CBOR_MAJOR_TSTR) ||
+              (key == SENML_LABEL_VD && value.major != CBOR_MAJOR_BSTR) ||
+              (key == SENML_LABEL_VB && value.major != CBOR_MAJOR_SIMPLE) ||
+              has_value || cbor_item_to_value(&value, &rec->value) != 0)
+            goto exit;
+          has_value = true;
+          break;
+      }
+    }
+
+    /* records without a value (e.g. only a base name) carry no resource */
+    if (!has_value)
+      continue;
+
+    memcpy(name, bn, bn_len);
+    memmove(name + bn_len, name + SENML_NAME_MAX, name_len);
+    if (senml_cbor_text_to_path(name, bn_len + name_len, rec) != 0)
+    {
+      count++;
+      goto exit;
+    }
+    count++;
+  }
+
+  result = cbor_records_to_data(uriP, records, count, dataP);
+
+exit:
+  cbor_records_free(records, count < CBOR_MAX_RECORDS ? count + 1 : count);
+  lwm2m_free(records);
+  return result;
+}
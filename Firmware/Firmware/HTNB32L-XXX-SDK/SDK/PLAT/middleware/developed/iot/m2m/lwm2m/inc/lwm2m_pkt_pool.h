@@ -0,0 +1,160 @@
+/******************************************************************************
+
+  @file    lwm2m_pkt_pool.h
+  @brief   Preallocated packet pool and SPSC ring for the LwM2M receive path
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#ifndef LWM2M_PKT_POOL_H
+#define LWM2M_PKT_POOL_H
+
+#include "lwm2m_rx.h"
+
+/* Number of preallocated packets, must be a power of two. */
+#ifndef LWM2M_PKT_POOL_SIZE
+#define LWM2M_PKT_POOL_SIZE    8
+#endif
+
+#if (LWM2M_PKT_POOL_SIZE & (LWM2M_PKT_POOL_SIZE - 1)) != 0 || LWM2M_PKT_POOL_SIZE > 256
+#error "LWM2M_PKT_POOL_SIZE must be a power of two not above 256"
+#endif
+
+/* Largest datagram a packet carries: a CoAP header and a 512 byte block.
+ * The pool holds LWM2M_PKT_POOL_SIZE of them, 4.8 KB by default. */
+#ifndef LWM2M_PKT_PAYLOAD_SIZE
+#define LWM2M_PKT_PAYLOAD_SIZE 600
+#endif
+
+/*------------------------------------------------------------------------------
+  Datagram storage of a pool packet, cmd_data.message points at it.
+------------------------------------------------------------------------------*/
+typedef struct
+{
+  uint16_t                      length;
+  uint8_t                       data[LWM2M_PKT_PAYLOAD_SIZE];
+} lwm2m_pkt_payload_t;
+
+/*------------------------------------------------------------------------------
+  Single producer / single consumer ring of packet slot numbers. head is
+  only written by the consumer and tail only by the producer.
+------------------------------------------------------------------------------*/
+typedef struct
+{
+  volatile uint32_t             head;
+  volatile uint32_t             tail;
+  uint8_t                       slot[LWM2M_PKT_POOL_SIZE];
+} lwm2m_pkt_ring_t;
+
+typedef struct
+{
+  uint32_t                      enqueued;     /* packets handed to the LwM2M task */
+  uint32_t                      exhausted;    /* lwm2m_pkt_pool_get() found no free packet */
+  uint32_t                      ring_full;    /* enqueue refused, should stay 0 */
+  uint32_t                      oversize;     /* datagram above LWM2M_PKT_PAYLOAD_SIZE, dropped */
+  uint32_t                      high_water;   /* most packets in use at once */
+} lwm2m_pkt_pool_stats_t;
+
+typedef struct
+{
+  lwm2m_pkt_t                   pkts[LWM2M_PKT_POOL_SIZE];
+  lwm2m_pkt_payload_t           payloads[LWM2M_PKT_POOL_SIZE];
+  lwm2m_pkt_ring_t              free_ring;    /* consumer -> producer */
+  lwm2m_pkt_ring_t              ready_ring;   /* producer -> consumer */
+  lwm2m_pkt_pool_stats_t        stats;        /* written by the producer only */
+} lwm2m_pkt_pool_t;
+
+typedef void (*lwm2m_pkt_handler_t)(lwm2m_pkt_t * pkt);
+
+/*===========================================================================
+
+FUNCTION LWM2M_PKT_POOL_INIT
+
+DESCRIPTION
+  Put every packet of the pool on the free ring. Must run before the
+  socket receiver and the LwM2M task use the pool.
+
+=========================================================================*/
+void lwm2m_pkt_pool_init(void);
+
+/*===========================================================================
+
+FUNCTION LWM2M_PKT_POOL_GET
+
+DESCRIPTION
+  Producer side. Take a free packet without blocking or allocating. Its
+  cmd_data.message points at its own lwm2m_pkt_payload_t, which the
+  receiver can read the datagram into directly.
+
+RETURN VALUE
+  Pointer to the packet, NULL (and the exhaustion counter incremented)
+  when all packets are queued or being processed.
+
+=========================================================================*/
+lwm2m_pkt_t* lwm2m_pkt_pool_get(void);
+
+/*===========================================================================
+
+FUNCTION LWM2M_PKT_POOL_ENQUEUE
+
+DESCRIPTION
+  Producer side. Publish a packet taken with lwm2m_pkt_pool_get() to the
+  LwM2M task and set its signal.
+
+RETURN VALUE
+  0 on success, -1 if pkt does not belong to the pool.
+
+=========================================================================*/
+int lwm2m_pkt_pool_enqueue(lwm2m_pkt_t* pkt);
+
+/*===========================================================================
+
+FUNCTION LWM2M_PKT_POOL_RECEIVE
+
+DESCRIPTION
+  Producer side, for the socket receiver. Copy a datagram into a pool
+  packet as an LWM2M_REQ_PKT with cHandle and clientData and publish it.
+  Nothing is allocated: when the pool is empty or the datagram does not
+  fit, it is dropped and counted, CoAP retransmission recovers.
+
+RETURN VALUE
+  0 on success, -1 if the datagram was dropped.
+
+=========================================================================*/
+int lwm2m_pkt_pool_receive(void * cHandle, void * clientData, const uint8_t * data, size_t length);
+
+/*===========================================================================
+
+FUNCTION LWM2M_PKT_POOL_DRAIN
+
+DESCRIPTION
+  Consumer side. Pass every published packet to handler in arrival
+  order, then return it to the pool with its payload. The handler must
+  not keep pointers into either.
+
+RETURN VALUE
+  Number of packets handled.
+
+=========================================================================*/
+int lwm2m_pkt_pool_drain(lwm2m_pkt_handler_t handler);
+
+/*===========================================================================
+
+FUNCTION LWM2M_PKT_POOL_OWNS
+
+DESCRIPTION
+  True when pkt is one of the pool packets, i.e. it must be returned with
+  the pool and not freed to the heap.
+
+=========================================================================*/
+bool lwm2m_pkt_pool_owns(const lwm2m_pkt_t* pkt);
+
+int lwm2m_pkt_pool_pending(void);
+void lwm2m_pkt_pool_get_stats(lwm2m_pkt_pool_stats_t * stats);
+
+#endif /* LWM2M_PKT_POOL_H */
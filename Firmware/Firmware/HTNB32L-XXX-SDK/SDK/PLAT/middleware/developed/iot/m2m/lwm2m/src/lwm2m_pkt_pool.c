@@ -0,0 +1,168 @@
+/******************************************************************************
+
+  @file    lwm2m_pkt_pool.c
+  @brief   Preallocated packet pool and SPSC ring for the LwM2M receive path
+
+  The socket receiver used to malloc() a command for every inbound datagram
+  and queue it under the LwM2M mutex. A burst such as a bootstrap write
+  sequence then hit the small heap with many short lived blocks and could
+  block on the mutex while the LwM2M task was dequeuing.
+
+  Here the packets come from a fixed array, each with its own datagram
+  buffer in the pool, and travel through two single
+  producer / single consumer rings of slot numbers: the ready ring from the
+  receiver to the LwM2M task and the free ring back. Each ring index is
+  written by one side only, so neither side takes a lock; a barrier orders
+  the slot write before the index update. When the pool is empty the
+  receiver drops the datagram and counts it, CoAP retransmission recovers.
+
+  ---------------------------------------------------------------------------
+
+  Copyright (c) 2026 HT Micron Semicondutores S.A.
+  All Rights Reserved.
+  ---------------------------------------------------------------------------
+
+ *****************************************************************************/
+
+#include "RTE_Components.h"
+#include CMSIS_device_header
+#include "lwm2m_pkt_pool.h"
+
+#define LWM2M_PKT_POOL_MASK    (LWM2M_PKT_POOL_SIZE - 1)
+
+static lwm2m_pkt_pool_t lwm2m_pkt_pool;
+
+static int lwm2m_pkt_ring_push(lwm2m_pkt_ring_t * ring, uint8_t slot)
+{
+  uint32_t tail = ring->tail;
+
+  if (tail - ring->head >= LWM2M_PKT_POOL_SIZE)
+    return -1;
+
+  ring->slot[tail & LWM2M_PKT_POOL_MASK] = slot;
+  __DMB();
+  ring->tail = tail + 1;
+  return 0;
+}
+
+static int lwm2m_pkt_ring_pop(lwm2m_pkt_ring_t * ring)
+{
+  uint32_t head = ring->head;
+  uint8_t slot;
+
+  if (head == ring->tail)
+    return -1;
+
+  __DMB();
+  slot = ring->slot[head & LWM2M_PKT_POOL_MASK];
+  __DMB();
+  ring->head = head + 1;
+  return slot;
+}
+
+void lwm2m_pkt_pool_init(void)
+{
+  uint32_t i;
+
+  memset(&lwm2m_pkt_pool, 0, sizeof(lwm2m_pkt_pool));
+  for (i = 0; i < LWM2M_PKT_POOL_SIZE; i++)
+    lwm2m_pkt_pool.free_ring.slot[i] = (uint8_t)i;
+  lwm2m_pkt_pool.free_ring.tail = LWM2M_PKT_POOL_SIZE;
+}
+
+bool lwm2m_pkt_pool_owns(const lwm2m_pkt_t* pkt)
+{
+  return pkt >= &lwm2m_pkt_pool.pkts[0] && pkt < &lwm2m_pkt_pool.pkts[LWM2M_PKT_POOL_SIZE];
+}
+
+lwm2m_pkt_t* lwm2m_pkt_pool_get(void)
+{
+  lwm2m_pkt_pool_stats_t * stats = &lwm2m_pkt_pool.stats;
+  lwm2m_pkt_ring_t * free_ring = &lwm2m_pkt_pool.free_ring;
+  uint32_t in_use;
+  int slot;
+
+  slot = lwm2m_pkt_ring_pop(free_ring);
+  if (slot < 0)
+  {
+    stats->exhausted++;
+    return NULL;
+  }
+
+  in_use = LWM2M_PKT_POOL_SIZE - (free_ring->tail - free_ring->head);
+  if (in_use > stats->high_water)
+    stats->high_water = in_use;
+
+  memset(&lwm2m_pkt_pool.pkts[slot], 0, sizeof(lwm2m_pkt_t));
+  lwm2m_pkt_pool.payloads[slot].length = 0;
+  lwm2m_pkt_pool.pkts[slot].cmd_data.message = &lwm2m_pkt_pool.payloads[slot];
+  return &lwm2m_pkt_pool.pkts[slot];
+}
+
+int lwm2m_pkt_pool_enqueue(lwm2m_pkt_t* pkt)
+{
+  if (!lwm2m_pkt_pool_owns(pkt))
+    return -1;
+
+  /* The ring holds every slot, so it can only be full if a packet was
+   * enqueued twice. */
+  if (lwm2m_pkt_ring_push(&lwm2m_pkt_pool.ready_ring, (uint8_t)(pkt - lwm2m_pkt_pool.pkts)) != 0)
+  {
+    lwm2m_pkt_pool.stats.ring_full++;
+    return -1;
+  }
+
+  lwm2m_pkt_pool.stats.enqueued++;
+  lwm2m_set_signal();
+  return 0;
+}
+
+int lwm2m_pkt_pool_receive(void * cHandle, void * clientData, const uint8_t * data, size_t length)
+{
+  lwm2m_pkt_payload_t * payload;
+  lwm2m_pkt_t * pkt;
+
+  if (length > LWM2M_PKT_PAYLOAD_SIZE)
+  {
+    lwm2m_pkt_pool.stats.oversize++;
+    return -1;
+  }
+
+  pkt = lwm2m_pkt_pool_get();
+  if (pkt == NULL)
+    return -1;
+
+  payload = (lwm2m_pkt_payload_t *)pkt->cmd_data.message;
+  memcpy(payload->data, data, length);
+  payload->length = (uint16_t)length;
+  pkt->cmd_hdr.cmd_id = LWM2M_REQ_PKT;
+  pkt->cmd_data.cHandle = cHandle;
+  pkt->cmd_data.clientData = clientData;
+  return lwm2m_pkt_pool_enqueue(pkt);
+}
+
+int lwm2m_pkt_pool_drain(lwm2m_pkt_handler_t handler)
+{
+  int handled = 0;
+  int slot;
+
+  while ((slot = lwm2m_pkt_ring_pop(&lwm2m_pkt_pool.ready_ring)) >= 0)
+  {
+    if (handler != NULL)
+      handler(&lwm2m_pkt_pool.pkts[slot]);
+    lwm2m_pkt_ring_push(&lwm2m_pkt_pool.free_ring, (uint8_t)slot);
+    handled++;
+  }
+  return handled;
+}
+
+int lwm2m_pkt_pool_pending(void)
+{
+  return (int)(lwm2m_pkt_pool.ready_ring.tail - lwm2m_pkt_pool.ready_ring.head);
+}
+
+void lwm2m_pkt_pool_get_stats(lwm2m_pkt_pool_stats_t * stats)
+{
+  if (stats != NULL)
+    memcpy(stats, &lwm2m_pkt_pool.stats, sizeof(lwm2m_pkt_pool_stats_t));
+}
@@ -2304,6 +2304,16 @@
 #if !defined LWIP_CHECKSUM_ON_COPY || defined __DOXYGEN__
 #define LWIP_CHECKSUM_ON_COPY           0
 #endif
+
+/**
+ * LWIP_CHKSUM: the Internet checksum of the stack. With MW_CHKSUM_LWIP_ENABLE,
+ * mwInetChksum() (mw_chksum.c) adds 32-bit words, with the same result as
+ * lwip_standard_chksum().
+ */
+#if defined MW_CHKSUM_LWIP_ENABLE && !defined LWIP_CHKSUM
+unsigned short mwInetChksum(const void *data, long len);
+#define LWIP_CHKSUM                     mwInetChksum
+#endif
 /**
  * @}
  */
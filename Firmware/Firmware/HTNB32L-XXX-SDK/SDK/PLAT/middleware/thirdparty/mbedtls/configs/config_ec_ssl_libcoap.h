@@ -1412,6 +1412,32 @@
  */
 //#define MBEDTLS_SSL_DTLS_BADMAC_LIMIT
 
+/**
+ * \def MBEDTLS_SSL_DTLS_CONNECTION_ID
+ *
+ * Enable support for the DTLS Connection ID extension
+ * (draft-ietf-tls-dtls-connection-id-05, the version implemented by this
+ * mbed TLS release), which keeps a DTLS connection usable when the NAT in
+ * front of the device rebinds its UDP port during PSM or eDRX sleep.
+ *
+ * The device asks for a zero length CID of its own, so only the server
+ * CID is added to outgoing records.
+ *
+ * Requires: MBEDTLS_SSL_PROTO_DTLS
+ */
+#define MBEDTLS_SSL_DTLS_CONNECTION_ID
+#define MBEDTLS_SSL_CID_IN_LEN_MAX          8
+#define MBEDTLS_SSL_CID_OUT_LEN_MAX         16
+
+/**
+ * \def MBEDTLS_SSL_CONTEXT_SERIALIZATION
+ *
+ * Enable mbedtls_ssl_context_save() and mbedtls_ssl_context_load(), used to
+ * keep an established DTLS connection (keys, epoch, record counters and
+ * CID) in the file system across hibernate.
+ */
+#define MBEDTLS_SSL_CONTEXT_SERIALIZATION
+
 /**
  * \def MBEDTLS_SSL_SESSION_TICKETS
  *
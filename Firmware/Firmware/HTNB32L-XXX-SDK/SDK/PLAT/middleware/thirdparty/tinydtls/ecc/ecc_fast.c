@@ -0,0 +1,573 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 HT Micron Semicondutores S.A.
+ * All rights reserved.
+ *
+ * ecc_fast.c - secp256r1 ECDH/ECDSA for tinydtls with fast field arithmetic
+ *
+ * Drop-in replacement for ecc/ecc.c, selected with TINYDTLS_FAST_ECC (see
+ * Makefile.inc). Same API and number format: 8 little endian 32 bit words,
+ * affine points in and out.
+ *
+ * Where the time goes compared to the reference:
+ * - field multiplication is a product scanning 8x8 word multiply (UMLAL
+ *   on the Cortex-M3) followed by the NIST fast reduction for
+ *   p = 2^256 - 2^224 + 2^192 + 2^96 - 1, instead of a generic modular
+ *   reduction loop;
+ * - points are kept in Jacobian coordinates, so the only inversion is
+ *   the final conversion to affine, done with a fixed addition chain;
+ * - scalar multiplication uses a 4 bit window (15 precomputed points),
+ *   ECDSA verification computes u1*G + u2*Q in one pass (Shamir's trick);
+ * - arithmetic modulo the group order uses Montgomery multiplication.
+ *
+ * Like the reference, run time depends on the scalar. The window table
+ * costs 1.5 KB of stack during ecc_ec_mult().
+ *
+ * The TEST_INCLUDE helpers of ecc.h belong to the reference and are not
+ * provided here.
+ *
+ *******************************************************************************/
+
+#include <string.h>
+#include "ecc.h"
+
+#ifdef TINYDTLS_FAST_ECC
+
+#define FE_WORDS  arrayLength
+
+typedef uint32_t fe_t[FE_WORDS];
+
+typedef struct
+{
+  fe_t x;
+  fe_t y;
+  fe_t z;                   /* 0 for the point at infinity */
+} ecc_jac_t;
+
+const uint32_t ecc_g_point_x[8] = { 0xD898C296, 0xF4A13945, 0x2DEB33A0, 0x77037D81,
+                                    0x63A440F2, 0xF8BCE6E5, 0xE12C4247, 0x6B17D1F2 };
+const uint32_t ecc_g_point_y[8] = { 0x37BF51F5, 0xCBB64068, 0x6B315ECE, 0x2BCE3357,
+                                    0x7C0F9E16, 0x8EE7EB4A, 0xFE1A7F9B, 0x4FE342E2 };
+
+static const uint32_t ecc_prime_p[8] = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000,
+                                         0x00000000, 0x00000000, 0x00000001, 0xFFFFFFFF };
+static const uint32_t ecc_order_n[8] = { 0xFC632551, 0xF3B9CAC2, 0xA7179E84, 0xBCE6FAAD,
+                                         0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF };
+/* -n^-1 mod 2^32 and 2^512 mod n, for Montgomery arithmetic modulo n. */
+#define ECC_ORDER_N0INV  0xEE00BC4F
+static const uint32_t ecc_order_r2[8] = { 0xBE79EEA2, 0x83244C95, 0x49BD6FA6, 0x4699799C,
+                                          0x2B6BEC59, 0x2845B239, 0xF3D95620, 0x66E12D94 };
+
+/*---------------------------------------------------------------------------
+  Multi-word helpers
+---------------------------------------------------------------------------*/
+
+static uint32_t mw_add(uint32_t * r, const uint32_t * a, const uint32_t * b)
+{
+  uint64_t c = 0;
+  int i;
+
+  for (i = 0; i < FE_WORDS; i++)
+  {
+    c += (uint64_t)a[i] + b[i];
+    r[i] = (uint32_t)c;
+    c >>= 32;
+  }
+  return (uint32_t)c;
+}
+
+static uint32_t mw_sub(uint32_t * r, const uint32_t * a, const uint32_t * b)
+{
+  int64_t c = 0;
+  int i;
+
+  for (i = 0; i < FE_WORDS; i++)
+  {
+    c += (int64_t)a[i] - b[i];
+    r[i] = (uint32_t)c;
+    c >>= 32;                  /* arithmetic shift, -1 or 0 */
+  }
+  return (uint32_t)(c & 1);
+}
+
+/* 1 if a >= b */
+static int mw_geq(const uint32_t * a, const uint32_t * b)
+{
+  int i;
+
+  for (i = FE_WORDS - 1; i >= 0; i--)
+  {
+    if (a[i] != b[i])
+      return a[i] > b[i];
+  }
+  return 1;
+}
+
+static int mw_is_zero(const uint32_t * a)
+{
+  uint32_t acc = 0;
+  int i;
+
+  for (i = 0; i < FE_WORDS; i++)
+    acc |= a[i];
+  return acc == 0;
+}
+
+static void mw_set_word(uint32_t * r, uint32_t w)
+{
+  memset(r, 0, FE_WORDS * sizeof(uint32_t));
+  r[0] = w;
+}
+
+static int mw_bit(const uint32_t * a, int bit)
+{
+  return (a[bit >> 5] >> (bit & 31)) & 1;
+}
+
+/* 16 word product of two 8 word numbers, column by column. */
+static void mw_mul(uint32_t r[16], const uint32_t * a, const uint32_t * b)
+{
+  uint64_t acc = 0;
+  uint32_t hi = 0;
+  int i, k;
+
+  for (k = 0; k < 2 * FE_WORDS - 1; k++)
+  {
+    int lo = (k < FE_WORDS) ? 0 : k - FE_WORDS + 1;
+    int up = (k < FE_WORDS) ? k : FE_WORDS - 1;
+
+    for (i = lo; i <= up; i++)
+    {
+      uint64_t p = (uint64_t)a[i] * b[k - i];
+      acc += p;
+      hi += (acc < p);
+    }
+    r[k] = (uint32_t)acc;
+    acc = (acc >> 32) | ((uint64_t)hi << 32);
+    hi = 0;
+  }
+  r[2 * FE_WORDS - 1] = (uint32_t)acc;
+}
+
+/*---------------------------------------------------------------------------
+  Field arithmetic modulo p
+---------------------------------------------------------------------------*/
+
+static void fe_add(fe_t r, const fe_t a, const fe_t b)
+{
+  if (mw_add(r, a, b) || mw_geq(r, ecc_prime_p))
+    mw_sub(r, r, ecc_prime_p);
+}
+
+static void fe_sub(fe_t r, const fe_t a, const fe_t b)
+{
+  if (mw_sub(r, a, b))
+    mw_add(r, r, ecc_prime_p);
+}
+
+/* NIST P-256 fast reduction (FIPS 186-4, D.2.3) of a 512 bit product:
+ * r = s1 + 2 s2 + 2 s3 + s4 + s5 - s6 - s7 - s8 - s9, summed word by word
+ * with a signed carry. The carry left above 2^256 is folded back with
+ * 2^256 = 2^224 - 2^192 - 2^96 + 1 (mod p). */
+static void fe_reduce(fe_t r, const uint32_t c[16])
+{
+  int64_t acc;
+  int64_t carry;
+
+  acc  = (int64_t)c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14];
+  r[0] = (uint32_t)acc; acc >>= 32;
+  acc += (int64_t)c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15];
+  r[1] = (uint32_t)acc; acc >>= 32;
+  acc += (int64_t)c[2] + c[10] + c[11] - c[13] - c[14] - c[15];
+  r[2] = (uint32_t)acc; acc >>= 32;
+  acc += (int64_t)c[3] + 2 * ((int64_t)c[11] + c[12]) + c[13] - c[15] - c[8] - c[9];
+  r[3] = (uint32_t)acc; acc >>= 32;
+  acc += (int64_t)c[4] + 2 * ((int64_t)c[12] + c[13]) + c[14] - c[9] - c[10];
+  r[4] = (uint32_t)acc; acc >>= 32;
+  acc += (int64_t)c[5] + 2 * ((int64_t)c[13] + c[14]) + c[15] - c[10] - c[11];
+  r[5] = (uint32_t)acc; acc >>= 32;
+  acc += (int64_t)c[6] + 3 * (int64_t)c[14] + 2 * (int64_t)c[15] + c[13] - c[8] - c[9];
+  r[6] = (uint32_t)acc; acc >>= 32;
+  acc += (int64_t)c[7] + 3 * (int64_t)c[15] + c[8] - c[10] - c[11] - c[12] - c[13];
+  r[7] = (uint32_t)acc; acc >>= 32;
+
+  carry = acc;
+  while (carry != 0)
+  {
+    acc  = (int64_t)r[0] + carry;         r[0] = (uint32_t)acc; acc >>= 32;
+    acc += r[1];                          r[1] = (uint32_t)acc; acc >>= 32;
+    acc += r[2];                          r[2] = (uint32_t)acc; acc >>= 32;
+    acc += (int64_t)r[3] - carry;         r[3] = (uint32_t)acc; acc >>= 32;
+    acc += r[4];                          r[4] = (uint32_t)acc; acc >>= 32;
+    acc += r[5];                          r[5] = (uint32_t)acc; acc >>= 32;
+    acc += (int64_t)r[6] - carry;         r[6] = (uint32_t)acc; acc >>= 32;
+    acc += (int64_t)r[7] + carry;         r[7] = (uint32_t)acc; acc >>= 32;
+    carry = acc;
+  }
+
+  if (mw_geq(r, ecc_prime_p))
+    mw_sub(r, r, ecc_prime_p);
+}
+
+static void fe_mul(fe_t r, const fe_t a, const fe_t b)
+{
+  uint32_t t[2 * FE_WORDS];
+
+  mw_mul(t, a, b);
+  fe_reduce(r, t);
+}
+
+static void fe_sqr(fe_t r, const fe_t a)
+{
+  fe_mul(r, a, a);
+}
+
+static void fe_sqr_n(fe_t r, const fe_t a, int n)
+{
+  fe_sqr(r, a);
+  while (--n > 0)
+    fe_sqr(r, r);
+}
+
+/* a^(p-2) with the chain x2, x3, x6, x12, x15, x30, x32 (xk = a^(2^k - 1)):
+ * p - 2 = ffffffff 00000001 00000000 00000000 00000000 ffffffff ffffffff fffffffd */
+static void fe_inv(fe_t r, const fe_t a)
+{
+  fe_t x2, x3, x6, x12, x15, x30, x32, t;
+
+  fe_sqr(t, a);          fe_mul(x2, t, a);
+  fe_sqr(t, x2);         fe_mul(x3, t, a);
+  fe_sqr_n(t, x3, 3);    fe_mul(x6, t, x3);
+  fe_sqr_n(t, x6, 6);    fe_mul(x12, t, x6);
+  fe_sqr_n(t, x12, 3);   fe_mul(x15, t, x3);
+  fe_sqr_n(t, x15, 15);  fe_mul(x30, t, x15);
+  fe_sqr_n(t, x30, 2);   fe_mul(x32, t, x2);
+
+  fe_sqr_n(t, x32, 32);  fe_mul(t, t, a);
+  fe_sqr_n(t, t, 128);   fe_mul(t, t, x32);
+  fe_sqr_n(t, t, 32);    fe_mul(t, t, x32);
+  fe_sqr_n(t, t, 30);    fe_mul(t, t, x30);
+  fe_sqr_n(t, t, 2);     fe_mul(r, t, a);
+}
+
+/*---------------------------------------------------------------------------
+  Jacobian point arithmetic, y^2 = x^3 - 3x + b
+---------------------------------------------------------------------------*/
+
+static void jac_set_affine(ecc_jac_t * r, const uint32_t * x, const uint32_t * y)
+{
+  memcpy(r->x, x, sizeof(fe_t));
+  memcpy(r->y, y, sizeof(fe_t));
+  mw_set_word(r->z, 1);
+}
+
+static int jac_is_inf(const ecc_jac_t * p)
+{
+  return mw_is_zero(p->z);
+}
+
+/* dbl-2001-b */
+static void jac_double(ecc_jac_t * r, const ecc_jac_t * p)
+{
+  fe_t delta, gamma, beta, alpha, t1, t2;
+
+  if (jac_is_inf(p) || mw_is_zero(p->y))
+  {
+    memset(r, 0, sizeof(*r));
+    return;
+  }
+
+  fe_sqr(delta, p->z);
+  fe_sqr(gamma, p->y);
+  fe_mul(beta, p->x, gamma);
+
+  fe_sub(t1, p->x, delta);
+  fe_add(t2, p->x, delta);
+  fe_mul(alpha, t1, t2);
+  fe_add(t1, alpha, alpha);
+  fe_add(alpha, alpha, t1);               /* alpha = 3 (x - delta)(x + delta) */
+
+  fe_add(t1, p->y, p->z);
+  fe_sqr(t1, t1);
+  fe_sub(t1, t1, gamma);
+  fe_sub(r->z, t1, delta);                /* z3 = (y + z)^2 - gamma - delta */
+
+  fe_add(beta, beta, beta);
+  fe_add(beta, beta, beta);               /* 4 beta */
+  fe_sqr(t1, alpha);
+  fe_add(t2, beta, beta);
+  fe_sub(r->x, t1, t2);                   /* x3 = alpha^2 - 8 beta */
+
+  fe_sub(t1, beta, r->x);
+  fe_mul(t1, alpha, t1);
+  fe_sqr(gamma, gamma);
+  fe_add(gamma, gamma, gamma);
+  fe_add(gamma, gamma, gamma);
+  fe_add(gamma, gamma, gamma);            /* 8 gamma^2 */
+  fe_sub(r->y, t1, gamma);                /* y3 = alpha (4 beta - x3) - 8 gamma^2 */
+}
+
+/* add-1998-cmo-2, handles the doubling and inverse cases. r may alias p. */
+static void jac_add(ecc_jac_t * r, const ecc_jac_t * p, const ecc_jac_t * q)
+{
+  fe_t z1z1, z2z2, u1, u2, s1, s2, h, rr, hh, hhh, t;
+
+  if (jac_is_inf(p))
+  {
+    *r = *q;
+    return;
+  }
+  if (jac_is_inf(q))
+  {
+    *r = *p;
+    return;
+  }
+
+  fe_sqr(z1z1, p->z);
+  fe_sqr(z2z2, q->z);
+  fe_mul(u1, p->x, z2z2);
+  fe_mul(u2, q->x, z1z1);
+  fe_mul(s1, p->y, q->z);
+  fe_mul(s1, s1, z2z2);
+  fe_mul(s2, q->y, p->z);
+  fe_mul(s2, s2, z1z1);
+
+  fe_sub(h, u2, u1);
+  fe_sub(rr, s2, s1);
+
+  if (mw_is_zero(h))
+  {
+    if (mw_is_zero(rr))
+      jac_double(r, p);
+    else
+      memset(r, 0, sizeof(*r));
+    return;
+  }
+
+  fe_sqr(hh, h);
+  fe_mul(hhh, hh, h);
+  fe_mul(u1, u1, hh);                     /* u1 h^2 */
+
+  fe_mul(t, p->z, q->z);
+  fe_mul(r->z, t, h);
+
+  fe_sqr(t, rr);
+  fe_sub(t, t, hhh);
+  fe_sub(t, t, u1);
+  fe_sub(r->x, t, u1);                    /* x3 = r^2 - h^3 - 2 u1 h^2 */
+
+  fe_sub(t, u1, r->x);
+  fe_mul(t, rr, t);
+  fe_mul(s1, s1, hhh);
+  fe_sub(r->y, t, s1);                    /* y3 = r (u1 h^2 - x3) - s1 h^3 */
+}
+
+static void jac_to_affine(uint32_t * x, uint32_t * y, const ecc_jac_t * p)
+{
+  fe_t zi, zi2;
+
+  if (jac_is_inf(p))
+  {
+    memset(x, 0, sizeof(fe_t));
+    memset(y, 0, sizeof(fe_t));
+    return;
+  }
+
+  fe_inv(zi, p->z);
+  fe_sqr(zi2, zi);
+  fe_mul(x, p->x, zi2);
+  fe_mul(zi2, zi2, zi);
+  fe_mul(y, p->y, zi2);
+}
+
+static int scalar_nibble(const uint32_t * k, int i)
+{
+  return (k[i >> 3] >> ((i & 7) * 4)) & 0xf;
+}
+
+void ecc_ec_mult(const uint32_t *px, const uint32_t *py, const uint32_t *secret, uint32_t *resultx, uint32_t *resulty)
+{
+  ecc_jac_t table[15];
+  ecc_jac_t acc;
+  int i, d;
+
+  jac_set_affine(&table[0], px, py);
+  jac_double(&table[1], &table[0]);
+  for (i = 2; i < 15; i++)
+    jac_add(&table[i], &table[i - 1], &table[0]);
+
+  memset(&acc, 0, sizeof(acc));
+  for (i = 2 * FE_WORDS * 4 - 1; i >= 0; i--)
+  {
+    if (!jac_is_inf(&acc))
+    {
+      jac_double(&acc, &acc);
+      jac_double(&acc, &acc);
+      jac_double(&acc, &acc);
+      jac_double(&acc, &acc);
+    }
+    d = scalar_nibble(secret, i);
+    if (d != 0)
+      jac_add(&acc, &acc, &table[d - 1]);
+  }
+
+  jac_to_affine(resultx, resulty, &acc);
+  memset(table, 0, sizeof(table));
+}
+
+/*---------------------------------------------------------------------------
+  Arithmetic modulo the group order n
+---------------------------------------------------------------------------*/
+
+/* r = a b / 2^256 mod n (CIOS). */
+static void mn_mont_mul(uint32_t * r, const uint32_t * a, const uint32_t * b)
+{
+  uint32_t t[FE_WORDS + 2];
+  uint64_t c;
+  uint32_t m;
+  int i, j;
+
+  memset(t, 0, sizeof(t));
+  for (i = 0; i < FE_WORDS; i++)
+  {
+    c = 0;
+    for (j = 0; j < FE_WORDS; j++)
+    {
+      c += (uint64_t)t[j] + (uint64_t)a[j] * b[i];
+      t[j] = (uint32_t)c;
+      c >>= 32;
+    }
+    c += t[FE_WORDS];
+    t[FE_WORDS] = (uint32_t)c;
+    t[FE_WORDS + 1] = (uint32_t)(c >> 32);
+
+    m = t[0] * ECC_ORDER_N0INV;
+    c = ((uint64_t)t[0] + (uint64_t)m * ecc_order_n[0]) >> 32;
+    for (j = 1; j < FE_WORDS; j++)
+    {
+      c += (uint64_t)t[j] + (uint64_t)m * ecc_order_n[j];
+      t[j - 1] = (uint32_t)c;
+      c >>= 32;
+    }
+    c += t[FE_WORDS];
+    t[FE_WORDS - 1] = (uint32_t)c;
+    t[FE_WORDS] = t[FE_WORDS + 1] + (uint32_t)(c >> 32);
+  }
+
+  if (t[FE_WORDS] != 0 || mw_geq(t, ecc_order_n))
+    mw_sub(t, t, ecc_order_n);
+  memcpy(r, t, sizeof(fe_t));
+}
+
+static void mn_to_mont(uint32_t * r, const uint32_t * a)
+{
+  mn_mont_mul(r, a, ecc_order_r2);
+}
+
+/* a < 2^256 < 2n, so one subtraction reduces it. */
+static void mn_reduce(uint32_t * r, const uint32_t * a)
+{
+  if (mw_geq(a, ecc_order_n))
+    mw_sub(r, a, ecc_order_n);
+  else if (r != a)
+    memcpy(r, a, sizeof(fe_t));
+}
+
+static void mn_add(uint32_t * r, const uint32_t * a, const uint32_t * b)
+{
+  if (mw_add(r, a, b) || mw_geq(r, ecc_order_n))
+    mw_sub(r, r, ecc_order_n);
+}
+
+/* Montgomery form in and out: a R -> a^-1 R, by a^(n-2). */
+static void mn_inv_mont(uint32_t * r, const uint32_t * a)
+{
+  fe_t e, acc, one;
+  int i;
+
+  memcpy(e, ecc_order_n, sizeof(fe_t));
+  e[0] -= 2;                              /* no borrow, n[0] ends in ...51 */
+
+  mw_set_word(one, 1);
+  mn_to_mont(acc, one);
+  for (i = 255; i >= 0; i--)
+  {
+    mn_mont_mul(acc, acc, acc);
+    if (mw_bit(e, i))
+      mn_mont_mul(acc, acc, a);
+  }
+  memcpy(r, acc, sizeof(fe_t));
+}
+
+int ecc_is_valid_key(const uint32_t * priv_key)
+{
+  return !mw_geq(priv_key, ecc_order_n);
+}
+
+int ecc_ecdsa_sign(const uint32_t *d, const uint32_t *e, const uint32_t *k, uint32_t *r, uint32_t *s)
+{
+  fe_t rx, ry, km, kinv, t, ee;
+
+  ecc_ec_mult(ecc_g_point_x, ecc_g_point_y, k, rx, ry);
+  mn_reduce(r, rx);
+  if (mw_is_zero(r))
+    return -1;
+
+  mn_to_mont(km, k);
+  mn_inv_mont(kinv, km);                  /* k^-1 R */
+
+  mn_to_mont(t, r);
+  mn_mont_mul(t, t, d);                   /* r d */
+  mn_reduce(ee, e);
+  mn_add(t, t, ee);                       /* e + r d */
+  mn_mont_mul(s, kinv, t);                /* k^-1 (e + r d) */
+
+  memset(kinv, 0, sizeof(kinv));
+  memset(km, 0, sizeof(km));
+  if (mw_is_zero(s))
+    return -1;
+  return 0;
+}
+
+int ecc_ecdsa_validate(const uint32_t *x, const uint32_t *y, const uint32_t *e, const uint32_t *r, const uint32_t *s)
+{
+  ecc_jac_t g, q, gq, acc;
+  fe_t w, u1, u2, ee, vx, vy;
+  int i, b1, b2;
+
+  if (mw_is_zero(r) || mw_is_zero(s) || mw_geq(r, ecc_order_n) || mw_geq(s, ecc_order_n))
+    return -1;
+
+  mn_to_mont(w, s);
+  mn_inv_mont(w, w);                      /* s^-1 R */
+  mn_reduce(ee, e);
+  mn_mont_mul(u1, w, ee);                 /* e s^-1 */
+  mn_mont_mul(u2, w, r);                  /* r s^-1 */
+
+  jac_set_affine(&g, ecc_g_point_x, ecc_g_point_y);
+  jac_set_affine(&q, x, y);
+  jac_add(&gq, &g, &q);
+
+  memset(&acc, 0, sizeof(acc));
+  for (i = 255; i >= 0; i--)
+  {
+    jac_double(&acc, &acc);
+    b1 = mw_bit(u1, i);
+    b2 = mw_bit(u2, i);
+    if (b1 && b2)
+      jac_add(&acc, &acc, &gq);
+    else if (b1)
+      jac_add(&acc, &acc, &g);
+    else if (b2)
+      jac_add(&acc, &acc, &q);
+  }
+
+  if (jac_is_inf(&acc))
+    return -1;
+
+  jac_to_affine(vx, vy, &acc);
+  mn_reduce(vx, vx);
+  return (memcmp(vx, r, sizeof(fe_t)) == 0) ? 0 : -1;
+}
+
+#endif /* TINYDTLS_FAST_ECC */
@@ -0,0 +1,235 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2026 HT Micron Semicondutores S.A.
+ * All rights reserved.
+ *
+ * sha2_fast.c - Unrolled SHA-256 for tinydtls (HMAC, PRF and handshake hash)
+ *
+ * Drop-in replacement for the SHA-256 part of sha2/sha2.c, selected with
+ * TINYDTLS_FAST_SHA256 (see Makefile.inc). The reference loops over the
+ * 64 rounds and the message schedule with an array of 64 words and
+ * rotates the eight working variables through memory each round.
+ *
+ * Here the 64 rounds are unrolled eight at a time with the working
+ * variables renamed instead of moved, the schedule lives in a 16 word
+ * ring that is expanded in place, and whole 64 byte blocks are hashed
+ * straight from the caller's buffer without going through ctx->buffer.
+ * Debug/Scripts/hosttest/tinydtls_crypto_test.c checks it.
+ *
+ *******************************************************************************/
+
+#include <string.h>
+#include "sha2.h"
+
+#ifdef TINYDTLS_FAST_SHA256
+
+#if defined(WITH_SHA384) || defined(WITH_SHA512)
+#error "sha2_fast.c implements SHA-256 only, keep sha2.c for SHA-384/512"
+#endif
+
+#define ROTR(x, n)    (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define S0(x)         (ROTR((x), 2) ^ ROTR((x), 13) ^ ROTR((x), 22))
+#define S1(x)         (ROTR((x), 6) ^ ROTR((x), 11) ^ ROTR((x), 25))
+#define s0(x)         (ROTR((x), 7) ^ ROTR((x), 18) ^ ((x) >> 3))
+#define s1(x)         (ROTR((x), 17) ^ ROTR((x), 19) ^ ((x) >> 10))
+
+#define CH(x, y, z)   (((x) & ((y) ^ (z))) ^ (z))
+#define MAJ(x, y, z)  (((x) & (y)) | ((z) & ((x) | (y))))
+
+#define LOAD32(p)     (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | \
+                       ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+#define STORE32(p, v) { (p)[0] = (uint8_t)((v) >> 24); (p)[1] = (uint8_t)((v) >> 16); \
+                        (p)[2] = (uint8_t)((v) >> 8); (p)[3] = (uint8_t)(v); }
+
+static const uint32_t K256[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t H256[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+/* W[i & 15] for rounds 16..63, expanded in place. */
+#define W_EXPAND(i)   (W[(i) & 15] += s1(W[((i) - 2) & 15]) + W[((i) - 7) & 15] + s0(W[((i) - 15) & 15]))
+
+#define ROUND(a, b, c, d, e, f, g, h, i, w)                     \
+  {                                                             \
+    uint32_t t1 = (h) + S1(e) + CH((e), (f), (g)) + K256[i] + (w); \
+    (d) += t1;                                                  \
+    (h) = t1 + S0(a) + MAJ((a), (b), (c));                      \
+  }
+
+#define ROUNDS8_LOAD(i)                                         \
+  ROUND(a, b, c, d, e, f, g, h, (i) + 0, W[(i) + 0]);           \
+  ROUND(h, a, b, c, d, e, f, g, (i) + 1, W[(i) + 1]);           \
+  ROUND(g, h, a, b, c, d, e, f, (i) + 2, W[(i) + 2]);           \
+  ROUND(f, g, h, a, b, c, d, e, (i) + 3, W[(i) + 3]);           \
+  ROUND(e, f, g, h, a, b, c, d, (i) + 4, W[(i) + 4]);           \
+  ROUND(d, e, f, g, h, a, b, c, (i) + 5, W[(i) + 5]);           \
+  ROUND(c, d, e, f, g, h, a, b, (i) + 6, W[(i) + 6]);           \
+  ROUND(b, c, d, e, f, g, h, a, (i) + 7, W[(i) + 7])
+
+#define ROUNDS8_EXPAND(i)                                       \
+  ROUND(a, b, c, d, e, f, g, h, (i) + 0, W_EXPAND((i) + 0));    \
+  ROUND(h, a, b, c, d, e, f, g, (i) + 1, W_EXPAND((i) + 1));    \
+  ROUND(g, h, a, b, c, d, e, f, (i) + 2, W_EXPAND((i) + 2));    \
+  ROUND(f, g, h, a, b, c, d, e, (i) + 3, W_EXPAND((i) + 3));    \
+  ROUND(e, f, g, h, a, b, c, d, (i) + 4, W_EXPAND((i) + 4));    \
+  ROUND(d, e, f, g, h, a, b, c, (i) + 5, W_EXPAND((i) + 5));    \
+  ROUND(c, d, e, f, g, h, a, b, (i) + 6, W_EXPAND((i) + 6));    \
+  ROUND(b, c, d, e, f, g, h, a, (i) + 7, W_EXPAND((i) + 7))
+
+static void dtls_sha256_transform(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+  uint32_t W[16];
+  uint32_t a, b, c, d, e, f, g, h;
+  int i;
+
+  while (blocks-- > 0)
+  {
+    for (i = 0; i < 16; i++)
+      W[i] = LOAD32(data + 4 * i);
+
+    a = state[0]; b = state[1]; c = state[2]; d = state[3];
+    e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+    ROUNDS8_LOAD(0);
+    ROUNDS8_LOAD(8);
+    for (i = 16; i < 64; i += 16)
+    {
+      ROUNDS8_EXPAND(i);
+      ROUNDS8_EXPAND(i + 8);
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+
+    data += DTLS_SHA256_BLOCK_LENGTH;
+  }
+}
+
+void dtls_sha256_init(dtls_sha256_ctx *context)
+{
+  if (context == NULL)
+    return;
+
+  memcpy(context->state, H256, sizeof(H256));
+  memset(context->buffer, 0, DTLS_SHA256_BLOCK_LENGTH);
+  context->bitcount = 0;
+}
+
+void dtls_sha256_update(dtls_sha256_ctx *context, const uint8_t *data, size_t len)
+{
+  size_t used;
+  size_t fill;
+
+  if (context == NULL || len == 0)
+    return;
+
+  used = (size_t)((context->bitcount >> 3) % DTLS_SHA256_BLOCK_LENGTH);
+  context->bitcount += (uint64_t)len << 3;
+
+  if (used > 0)
+  {
+    fill = DTLS_SHA256_BLOCK_LENGTH - used;
+    if (len < fill)
+    {
+      memcpy(&context->buffer[used], data, len);
+      return;
+    }
+    memcpy(&context->buffer[used], data, fill);
+    dtls_sha256_transform(context->state, context->buffer, 1);
+    data += fill;
+    len -= fill;
+  }
+
+  if (len >= DTLS_SHA256_BLOCK_LENGTH)
+  {
+    dtls_sha256_transform(context->state, data, len / DTLS_SHA256_BLOCK_LENGTH);
+    data += len & ~(size_t)(DTLS_SHA256_BLOCK_LENGTH - 1);
+    len &= DTLS_SHA256_BLOCK_LENGTH - 1;
+  }
+
+  if (len > 0)
+    memcpy(context->buffer, data, len);
+}
+
+void dtls_sha256_final(uint8_t digest[DTLS_SHA256_DIGEST_LENGTH], dtls_sha256_ctx *context)
+{
+  uint64_t bits;
+  size_t used;
+  int i;
+
+  if (context == NULL)
+    return;
+
+  bits = context->bitcount;
+  used = (size_t)((bits >> 3) % DTLS_SHA256_BLOCK_LENGTH);
+
+  context->buffer[used++] = 0x80;
+  if (used > DTLS_SHA256_BLOCK_LENGTH - 8)
+  {
+    memset(&context->buffer[used], 0, DTLS_SHA256_BLOCK_LENGTH - used);
+    dtls_sha256_transform(context->state, context->buffer, 1);
+    used = 0;
+  }
+  memset(&context->buffer[used], 0, DTLS_SHA256_BLOCK_LENGTH - 8 - used);
+
+  STORE32(&context->buffer[DTLS_SHA256_BLOCK_LENGTH - 8], (uint32_t)(bits >> 32));
+  STORE32(&context->buffer[DTLS_SHA256_BLOCK_LENGTH - 4], (uint32_t)bits);
+  dtls_sha256_transform(context->state, context->buffer, 1);
+
+  if (digest != NULL)
+  {
+    for (i = 0; i < 8; i++)
+      STORE32(&digest[4 * i], context->state[i]);
+  }
+
+  /* Clean up state data, as the reference does. */
+  memset(context, 0, sizeof(*context));
+}
+
+char *dtls_sha256_end(dtls_sha256_ctx *context, char buffer[DTLS_SHA256_DIGEST_STRING_LENGTH])
+{
+  static const char hex[] = "0123456789abcdef";
+  uint8_t digest[DTLS_SHA256_DIGEST_LENGTH];
+  int i;
+
+  if (context == NULL)
+    return NULL;
+
+  if (buffer == NULL)
+  {
+    memset(context, 0, sizeof(*context));
+    return NULL;
+  }
+
+  dtls_sha256_final(digest, context);
+  for (i = 0; i < DTLS_SHA256_DIGEST_LENGTH; i++)
+  {
+    buffer[2 * i]     = hex[digest[i] >> 4];
+    buffer[2 * i + 1] = hex[digest[i] & 0x0f];
+  }
+  buffer[2 * DTLS_SHA256_DIGEST_LENGTH] = '\0';
+  memset(digest, 0, sizeof(digest));
+  return buffer;
+}
+
+char *dtls_sha256_data(const uint8_t *data, size_t len, char digest[DTLS_SHA256_DIGEST_STRING_LENGTH])
+{
+  dtls_sha256_ctx context;
+
+  dtls_sha256_init(&context);
+  dtls_sha256_update(&context, data, len);
+  return dtls_sha256_end(&context, digest);
+}
+
+#endif /* TINYDTLS_FAST_SHA256 */
@@ -22,6 +22,9 @@
 // #include "FreeRTOS_IP.h"
 #include "semphr.h"
 #include "task.h"
+#if defined(MQTT_USE_PBUF)
+#include "qurt_network.h"
+#endif
 
 ///MQTT client results
 typedef enum {
@@ -53,6 +56,12 @@ typedef struct Network Network;
 struct Network
 {
 	xSocket_t my_socket;
+#if defined(MQTT_USE_PBUF)
+	qapi_nc_t nc;               /* used instead of my_socket */
+	struct pbuf* rx;            /* last chain received, kept until the next receive */
+	qapi_pbuf_reader_t rd;      /* unread part of rx */
+	int err;                    /* lwIP error of the last receive or send */
+#endif
 	int (*mqttread) (Network*, unsigned char*, int, int);
 	int (*mqttwrite) (Network*, unsigned char*, int, int);
 	int (*disconnect) (Network*);
@@ -83,6 +92,9 @@ int ThreadStart(Thread*, void (*fn)(void*), void* arg);
 int FreeRTOS_read(Network*, unsigned char*, int, int);
 int FreeRTOS_write(Network*, unsigned char*, int, int);
 int FreeRTOS_disconnect(Network*);
+#if defined(MQTT_USE_PBUF)
+int NetworkPacketInPlace(Network*, unsigned char**, int);
+#endif
 
 void NetworkInit(Network*);
 int NetworkConnect(Network*, char*, int);
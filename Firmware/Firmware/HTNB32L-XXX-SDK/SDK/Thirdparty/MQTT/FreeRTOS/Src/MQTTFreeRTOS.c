@@ -18,6 +18,15 @@
 #include "MQTTFreeRTOS.h"
 #include "debug_log.h"
 
+#if defined(MQTT_USE_DNS_CACHE)
+#include "mw_dns.h"
+#define MQTTGetHostByName(name, addr)   mwDnsGetHostByName(name, addr)
+#define MQTTDnsInvalidate(name)         mwDnsInvalidate(name)
+#else
+#define MQTTGetHostByName(name, addr)   FreeRTOS_gethostbyname(name, addr)
+#define MQTTDnsInvalidate(name)         ((void)(name))
+#endif
+
 int ThreadStart(Thread* thread, void (*fn)(void*), void* arg)
 {
     int rc = 0;
@@ -143,6 +152,130 @@ int FreeRTOS_disconnect(Network* n)
     return ret;
 }
 
+#if defined(MQTT_USE_PBUF)
+/*
+ * Plain TCP over a netconn: the received pbuf chains are parsed in place
+ * (NetworkPacketInPlace) instead of being copied into readbuf first.
+ */
+
+/* Drop the chain that was read up and wait for the next one */
+static int NetworkRecvChain(Network* n, int timeout_ms)
+{
+    struct pbuf* p = NULL;
+
+    qapi_pbuf_release(n->rx);
+    n->rx = NULL;
+    qapi_pbuf_reader_init(&n->rd, NULL);
+
+    qapi_nc_set_recvtimeout(n->nc, (timeout_ms > 0) ? timeout_ms : 1); /* 0 would block forever */
+    n->err = qapi_nc_recv(n->nc, &p, NULL, NULL);
+    if (n->err != ERR_OK)
+        return (n->err == ERR_TIMEOUT) ? 0 : -1;
+
+    n->rx = p;
+    qapi_pbuf_reader_init(&n->rd, p);
+    return 1;
+}
+
+/*
+ * If the whole of the next MQTT packet sits in one pbuf of the chain, point
+ * *pkt at it and return its length, moving the reader past it. The pointer
+ * stays valid until the next read. Otherwise *pkt is NULL and the packet
+ * is left for FreeRTOS_pbuf_read() to copy. Returns 0 on timeout and -1
+ * on error, like FreeRTOS_read(), when nothing could be received.
+ */
+int NetworkPacketInPlace(Network* n, unsigned char** pkt, int timeout_ms)
+{
+    qapi_pbuf_reader_t r;
+    int rem_len = 0;
+    int multiplier = 1;
+    int i, b, rc;
+
+    *pkt = NULL;
+    if (qapi_pbuf_reader_left(&n->rd) == 0 && (rc = NetworkRecvChain(n, timeout_ms)) <= 0)
+        return rc;
+
+    /* Peek at the fixed header with a copy of the reader */
+    r = n->rd;
+    qapi_pbuf_read_u8(&r);
+    for (i = 1; i <= 4; i++)
+    {
+        if ((b = qapi_pbuf_read_u8(&r)) < 0)
+            return 1;
+        rem_len += (b & 127) * multiplier;
+        multiplier *= 128;
+        if ((b & 128) == 0)
+            break;
+    }
+    if (i > 4)
+        return 1;   /* bad data, readPacket() reports it */
+
+    r = n->rd;
+    *pkt = (unsigned char*)qapi_pbuf_contig(&r, 1 + i + rem_len);
+    if (*pkt == NULL)
+        return 1;
+
+    n->rd = r;
+    return 1 + i + rem_len;
+}
+
+static int FreeRTOS_pbuf_read(Network* n, unsigned char* buffer, int len, int timeout_ms)
+{
+    TickType_t xTicksToWait = timeout_ms / portTICK_PERIOD_MS; /* convert milliseconds to ticks */
+    TimeOut_t xTimeOut;
+    int recvLen = 0;
+
+    vTaskSetTimeOutState(&xTimeOut); /* Record the time at which this function was entered. */
+    do
+    {
+        if (qapi_pbuf_reader_left(&n->rd) == 0)
+        {
+            int rc = NetworkRecvChain(n, xTicksToWait * portTICK_PERIOD_MS);
+
+            if (rc < 0)
+            {
+                recvLen = rc;
+                break;
+            }
+        }
+        recvLen += qapi_pbuf_read(&n->rd, buffer + recvLen, len - recvLen);
+    } while (recvLen < len && xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) == pdFALSE);
+
+    return recvLen;
+}
+
+static int FreeRTOS_pbuf_write(Network* n, unsigned char* buffer, int len, int timeout_ms)
+{
+    int sentLen = 0;
+
+    /* The send timeout was set on the netconn by NetworkSetConnTimeout() */
+    while (sentLen < len)
+    {
+        int chunk = ((len - sentLen) > 0xFFFF) ? 0xFFFF : (len - sentLen);
+
+        n->err = qapi_nc_send(n->nc, buffer + sentLen, (uint16_t)chunk, NULL, 0);
+        if (n->err != ERR_OK)
+            return (sentLen > 0) ? sentLen : -1;
+        sentLen += chunk;
+    }
+
+    return sentLen;
+}
+
+static int FreeRTOS_pbuf_disconnect(Network* n)
+{
+    int ret = 0;
+
+    qapi_pbuf_release(n->rx);
+    n->rx = NULL;
+    qapi_pbuf_reader_init(&n->rd, NULL);
+    if (n->nc != NULL)
+        ret = qapi_nc_close(n->nc);
+    n->nc = NULL;
+    return ret;
+}
+#endif
+
 int FreeRTOSConnectTimeout(INT32 connectFd, UINT32 timeout)
 {
     fd_set writeSet;
@@ -190,9 +323,19 @@ int FreeRTOSConnectTimeout(INT32 connectFd, UINT32 timeout)
 }
 void NetworkInit(Network* n) {
     n->my_socket = -1;
+#if defined(MQTT_USE_PBUF)
+    n->nc = NULL;
+    n->rx = NULL;
+    qapi_pbuf_reader_init(&n->rd, NULL);
+    n->err = ERR_OK;
+    n->mqttread = FreeRTOS_pbuf_read;
+    n->mqttwrite = FreeRTOS_pbuf_write;
+    n->disconnect = FreeRTOS_pbuf_disconnect;
+#else
     n->mqttread = FreeRTOS_read;
     n->mqttwrite = FreeRTOS_write;
     n->disconnect = FreeRTOS_disconnect;
+#endif
 }
 
 int TLSNetworkConnect(Network* n, char* addr, int port, int timeout_ms)
@@ -203,7 +346,7 @@ int TLSNetworkConnect(Network* n, char* addr, int port, int timeout_ms)
     INT32 errCode;
     INT32 flags = 0;
 
-    if ((FreeRTOS_gethostbyname(addr, &ipAddress)) != 0)
+    if ((MQTTGetHostByName(addr, &ipAddress)) != 0)
         goto exit;
     sAddr.sin_family = AF_INET;
     sAddr.sin_port = FreeRTOS_htons((uint16_t)port);
@@ -247,12 +390,45 @@ int TLSNetworkConnect(Network* n, char* addr, int port, int timeout_ms)
     /* Initialize TLS contexts and set credentials. */
     /* Perform TLS handshake. */
     
+    /* The cached address may be stale, let the next attempt look it up again */
+    if (retVal != 0)
+        MQTTDnsInvalidate(addr);
+
     fcntl(n->my_socket, F_SETFL, flags&~O_NONBLOCK); 
 
 exit:
     return retVal;
 }
 
+#if defined(MQTT_USE_PBUF)
+int NetworkConnect(Network* n, char* addr, int port)
+{
+    ip_addr_t ipAddress;
+
+    if ((MQTTGetHostByName(addr, &ipAddress)) != 0)
+        return -1;
+
+    /* Blocks until the handshake completes or TCP gives up */
+    n->err = qapi_nc_connect(n->nc, &ipAddress, (uint16_t)port);
+    if (n->err != ERR_OK)
+    {
+        MQTTDnsInvalidate(addr);
+        return 1;
+    }
+
+    return 0;
+}
+
+int NetworkSetConnTimeout(Network* n, int send_timeout, int recv_timeout)
+{
+    if ((n->nc = qapi_nc_new(AF_INET, SOCK_STREAM)) == NULL)
+        return 1;
+
+    netconn_set_sendtimeout(n->nc, send_timeout);
+    qapi_nc_set_recvtimeout(n->nc, recv_timeout);
+    return 0;
+}
+#else
 int NetworkConnect(Network* n, char* addr, int port)
 {
     struct sockaddr_in sAddr;
@@ -261,7 +437,7 @@ int NetworkConnect(Network* n, char* addr, int port)
     INT32 errCode;
     INT32 flags = 0;
 
-    if ((FreeRTOS_gethostbyname(addr, &ipAddress)) != 0) {
+    if ((MQTTGetHostByName(addr, &ipAddress)) != 0) {
         goto exit;
     }
         
@@ -303,6 +479,10 @@ int NetworkConnect(Network* n, char* addr, int port)
         //HT_TRACE(UNILOG_MQTT, mqttConnectSocket_1, P_ERROR, 0, "mqttConnectSocket connect success");
     }
 
+    /* The cached address may be stale, let the next attempt look it up again */
+    if (retVal != 0)
+        MQTTDnsInvalidate(addr);
+
     fcntl(n->my_socket, F_SETFL, flags&~O_NONBLOCK); 
 
 exit:
@@ -350,3 +530,4 @@ int NetworkSetConnTimeout(Network* n, int send_timeout, int recv_timeout)
     
     return 0;
 }
+#endif
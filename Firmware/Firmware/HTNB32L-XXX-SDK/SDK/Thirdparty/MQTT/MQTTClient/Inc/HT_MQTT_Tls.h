@@ -90,6 +90,7 @@ typedef struct MqttClientContextTag {
 } MqttClientContext;
 
 int32_t HT_MQTT_TLSConnect(MqttClientContext *context, Network *network);
+int HT_MQTT_TLSPending(void);
 
 #endif /*__HT_MQTT_H__*/
 
@@ -40,6 +40,9 @@
 
 #include "MQTTPacket.h"
 #include "MQTTFreeRTOS.h"
+#if defined(MQTT_USE_REACTOR)
+#include "mw_reactor.h"
+#endif
 
 #if defined(MQTTCLIENT_PLATFORM_HEADER)
 /* The following sequence of macros converts the MQTTCLIENT_PLATFORM_HEADER value
@@ -56,6 +59,11 @@
 #define MAX_MESSAGE_HANDLERS 5 /* redefinable - how many subscriptions do you want? */
 #endif
 
+#if defined(MQTT_USE_REACTOR)
+#define MQTT_REACTOR_READ_MS 100  /* longest wait for the rest of a packet once the socket is readable */
+#define MQTT_REACTOR_TICK_MS 1000 /* keepalive check period */
+#endif
+
 enum QoS { QOS0, QOS1, QOS2, SUBFAIL=0x80 };
 
 /* all failure return codes must be negative */
@@ -134,6 +142,13 @@ typedef struct MQTTClient
     Mutex mutex;
     Thread thread;
 #endif
+#if defined(MQTT_USE_REACTOR)
+    MwReactorTimer reactorTimer;
+#endif
+#if defined(MQTT_USE_PBUF)
+    unsigned char* rxpkt;   /* packet read last: in the received pbuf, or readbuf */
+    int rxlen;
+#endif
 } MQTTClient;
 
 typedef struct
@@ -229,6 +244,17 @@ DLLExport int MQTTConnect(MQTTClient* client, MQTTPacket_connectData* options);
  */
 DLLExport int MQTTPublish(MQTTClient* client, const char*, MQTTMessage*);
 
+#if defined(MQTT_USE_UPLINK)
+/** MQTT Publish through the prioritized uplink arbiter
+ *  @param client - the client object to use
+ *  @param cls - MwUplinkClass the message is queued in
+ *  @param topic - the topic to publish to
+ *  @param message - the message to send, copied before returning
+ *  @return success code, once queued
+ */
+DLLExport int MQTTPublishPrio(MQTTClient* client, int cls, const char*, MQTTMessage*);
+#endif
+
 /** MQTT SetMessageHandler - set or remove a per topic message handler
  *  @param client - the client object to use
  *  @param topicFilter - the topic filter set the message handler for
@@ -302,6 +328,10 @@ int app_mqtt_demo_task_init(void);
 
 void MQTTRun(void* parm);
 int MQTTStartRECVTask(MQTTClient* c);
+#if defined(MQTT_USE_REACTOR)
+int MQTTStartReactor(MQTTClient* c);
+void MQTTStopReactor(MQTTClient* c);
+#endif
 void MQTTCleanSession(MQTTClient* c);
 void MQTTCloseSession(MQTTClient* c);
 
@@ -39,6 +39,14 @@ static int HT_MQTT_TLSWrite(Network * network, unsigned char *buffer, int len, i
 	return written;
 }
 
+/* Decrypted bytes already pulled off the socket, which select() cannot see. */
+int HT_MQTT_TLSPending(void) {
+	if (ssl == NULL)
+		return 0;
+
+	return (int)mbedtls_ssl_get_bytes_avail(&(ssl->sslContext));
+}
+
 static int HT_MQTT_TLSRead(Network * network, unsigned char *buffer, int len, int timeout_ms) {
 	int rxLen = 0;
 	int ret_val = -1;
@@ -17,6 +17,24 @@
 //  *******************************************************************************/
 #include "MQTTClient.h"
 #include "HT_MQTT_Api.h"
+#if defined(MQTT_USE_UPLINK)
+#include "mw_uplink.h"
+#endif
+#if defined(MQTT_USE_REACTOR) && MQTT_TLS_ENABLE == 1
+#include "HT_MQTT_Tls.h"
+#endif
+
+#if defined(MQTT_USE_PBUF)
+#if defined(MQTT_USE_REACTOR) || MQTT_TLS_ENABLE == 1
+#error "MQTT_USE_PBUF needs plain TCP and no MQTT_USE_REACTOR, both of which work on the socket fd"
+#endif
+/* The packet read last, which readPacket() may leave in the received pbuf */
+#define MQTT_RXBUF(c)       ((c)->rxpkt)
+#define MQTT_RXBUF_SIZE(c)  ((c)->rxlen)
+#else
+#define MQTT_RXBUF(c)       ((c)->readbuf)
+#define MQTT_RXBUF_SIZE(c)  ((c)->readbuf_size)
+#endif
 
 // #include "ht_mqtt_api.h"
 // #include "ht_gpio_api.h"
@@ -245,6 +263,10 @@ void MQTTClientInit(MQTTClient* c, Network* network, unsigned int command_timeou
     c->buf_size = sendbuf_size;
     c->readbuf = readbuf;
     c->readbuf_size = readbuf_size;
+#if defined(MQTT_USE_PBUF)
+    c->rxpkt = readbuf;
+    c->rxlen = 0;
+#endif
     c->isconnected = 0;
     c->cleansession = 0;
     c->ping_outstanding = 0;
@@ -289,9 +311,23 @@ static int readPacket(MQTTClient* c, Timer* timer)
     MQTTHeader header = {0};
     int len = 0;
     int rem_len = 0;
+    int rc;
+
+#if defined(MQTT_USE_PBUF)
+    /* 0. most packets sit in one pbuf, parse those where lwIP put them */
+    rc = NetworkPacketInPlace(c->ipstack, &c->rxpkt, TimerLeftMS(timer));
+    if (rc <= 0)
+        goto exit;
+    if (c->rxpkt != NULL)
+    {
+        c->rxlen = rc;
+        goto parse;
+    }
+    c->rxpkt = c->readbuf;  /* split across pbufs, copy it */
+#endif
 
     /* 1. read the header byte.  This has the packet type in it */
-    int rc = c->ipstack->mqttread(c->ipstack, c->readbuf, 1, TimerLeftMS(timer));
+    rc = c->ipstack->mqttread(c->ipstack, c->readbuf, 1, TimerLeftMS(timer));
     if (rc != 1)
         goto exit;
 
@@ -312,7 +348,11 @@ static int readPacket(MQTTClient* c, Timer* timer)
         goto exit;
     }
 
-    header.byte = c->readbuf[0];
+#if defined(MQTT_USE_PBUF)
+    c->rxlen = len + rem_len;
+parse:
+#endif
+    header.byte = MQTT_RXBUF(c)[0];
     rc = header.bits.type;
     if (c->keepAliveInterval > 0)
         TimerCountdown(&c->last_received, c->keepAliveInterval); // record the fact that we have successfully received a packet
@@ -491,6 +531,51 @@ void MQTTCloseSession(MQTTClient* c)
         MQTTCleanSession(c);
 }
 
+static int socketIsDead(MQTTClient* c)
+{
+#if defined(MQTT_USE_PBUF)
+    int socket_stat = c->ipstack->err;
+#else
+    int socket_stat = sock_get_errno(c->ipstack->my_socket);
+#endif
+
+    return (socket_stat == MQTT_ERR_ABRT)||(socket_stat == MQTT_ERR_RST)||(socket_stat == MQTT_ERR_CLSD)||(socket_stat == MQTT_ERR_BADE);
+}
+
+static int keepaliveCheck(MQTTClient* c)
+{
+    mqttSendMsg mqttMsg;
+
+    if (keepalive(c) == SUCCESS)
+        return SUCCESS;
+
+    if(socketIsDead(c))
+    {
+        /* send  reconnect msg to send task */
+        memset(&mqttMsg, 0, sizeof(mqttMsg));
+        mqttMsg.cmdType = MQTT_DEMO_MSG_RECONNECT;
+
+        xQueueSend(mqttSendMsgHandle, &mqttMsg, MQTT_MSG_TIMEOUT);
+    }
+    else
+    {
+        if(mqtt_keepalive_retry_count>3)
+        {
+            mqtt_keepalive_retry_count = 0;
+            /* send  reconnect msg to send task */
+            memset(&mqttMsg, 0, sizeof(mqttMsg));
+            mqttMsg.cmdType = MQTT_DEMO_MSG_RECONNECT;
+
+            xQueueSend(mqttSendMsgHandle, &mqttMsg, MQTT_MSG_TIMEOUT);
+        }
+        else
+        {
+            keepaliveRetry(c);
+        }
+    }
+    return FAILURE;
+}
+
 int cycle(MQTTClient* c, Timer* timer)
 {
     int len = 0,
@@ -528,7 +613,7 @@ int cycle(MQTTClient* c, Timer* timer)
             int intQoS;
             msg.payloadlen = 0; /* this is a size_t, but deserialize publish sets this as int */
             if (MQTTDeserialize_publish(&msg.dup, &intQoS, &msg.retained, &msg.id, &topicName,
-               (unsigned char**)&msg.payload, (int*)&msg.payloadlen, c->readbuf, c->readbuf_size) != 1)
+               (unsigned char**)&msg.payload, (int*)&msg.payloadlen, MQTT_RXBUF(c), MQTT_RXBUF_SIZE(c)) != 1)
                 goto exit;
             msg.qos = (enum QoS)intQoS;
             deliverMessage(c, &topicName, &msg);
@@ -555,7 +640,7 @@ int cycle(MQTTClient* c, Timer* timer)
         {
             unsigned short mypacketid;
             unsigned char dup, type;
-            if (MQTTDeserialize_ack(&type, &dup, &mypacketid, c->readbuf, c->readbuf_size) != 1)
+            if (MQTTDeserialize_ack(&type, &dup, &mypacketid, MQTT_RXBUF(c), MQTT_RXBUF_SIZE(c)) != 1)
                 rc = FAILURE;
             else if ((len = MQTTSerialize_ack(c->buf, c->buf_size,
                 (packet_type == PUBREC) ? PUBREL : PUBCOMP, 0, mypacketid)) <= 0)
@@ -574,37 +659,9 @@ int cycle(MQTTClient* c, Timer* timer)
             break;
     }
 
-    if (keepalive(c) != SUCCESS) {
-        int socket_stat = 0;
-        mqttSendMsg mqttMsg;
-        //check only keepalive FAILURE status so that previous FAILURE status can be considered as FAULT
+    //check only keepalive FAILURE status so that previous FAILURE status can be considered as FAULT
+    if (keepaliveCheck(c) != SUCCESS)
         rc = FAILURE;
-        socket_stat = sock_get_errno(c->ipstack->my_socket);
-        if((socket_stat == MQTT_ERR_ABRT)||(socket_stat == MQTT_ERR_RST)||(socket_stat == MQTT_ERR_CLSD)||(socket_stat == MQTT_ERR_BADE))
-        {
-            /* send  reconnect msg to send task */
-            memset(&mqttMsg, 0, sizeof(mqttMsg));
-            mqttMsg.cmdType = MQTT_DEMO_MSG_RECONNECT;
-
-            xQueueSend(mqttSendMsgHandle, &mqttMsg, MQTT_MSG_TIMEOUT);
-        }
-        else
-        {
-            if(mqtt_keepalive_retry_count>3)
-            {
-                mqtt_keepalive_retry_count = 0;
-                /* send  reconnect msg to send task */
-                memset(&mqttMsg, 0, sizeof(mqttMsg));
-                mqttMsg.cmdType = MQTT_DEMO_MSG_RECONNECT;
-
-                xQueueSend(mqttSendMsgHandle, &mqttMsg, MQTT_MSG_TIMEOUT);
-            }
-            else
-            {
-                keepaliveRetry(c);
-            }
-        }
-    }
 
 exit:
     if (rc == SUCCESS)
@@ -645,14 +702,8 @@ int MQTTYield(MQTTClient* c, int timeout_ms)
 //   return client->isconnected;
 // }
 
-void MQTTRun(void* parm)
+static void MQTTRunInit(void)
 {
-    Timer timer;
-#if MQTT_TLS_ENABLE == 1
-    MQTTClient* c = (MQTTClient*)parm;
-#else
-    MQTTClient* c = (MQTTClient*)parm;
-#endif
     if(mqttSendMsgHandle == NULL)
     {
         mqttSendMsgHandle = xQueueCreate(16, sizeof(mqttSendMsg));
@@ -667,6 +718,17 @@ void MQTTRun(void* parm)
     {
         MutexInit(&mqttMutex1);
     }
+}
+
+void MQTTRun(void* parm)
+{
+    Timer timer;
+#if MQTT_TLS_ENABLE == 1
+    MQTTClient* c = (MQTTClient*)parm;
+#else
+    MQTTClient* c = (MQTTClient*)parm;
+#endif
+    MQTTRunInit();
 
     TimerInit(&timer);
 
@@ -695,8 +757,100 @@ int MQTTStartTask(MQTTClient* client)
 }
 #endif
 
+#if defined(MQTT_USE_REACTOR)
+/*
+ * Reactor mode: instead of the mqttRecv task polling the socket every 200 ms,
+ * the shared reactor task runs cycle() when the socket turns readable and
+ * runs the keepalive check from a timer.
+ */
+static void MQTTReactorRead(INT32 fd, UINT8 events, void *arg)
+{
+    MQTTClient* c = (MQTTClient*)arg;
+    Timer timer;
+    int rc;
+
+#if defined(MQTT_TASK)
+    MutexLock(&c->mutex);
+#endif
+    MutexLock(&mqttMutex1);
+
+    /* The socket is readable, so this only waits for the rest of a packet
+     * that arrived split. With TLS, one record may carry more than one
+     * packet and the rest stays inside mbedTLS, out of select()'s sight. */
+    do
+    {
+        TimerInit(&timer);
+        TimerCountdownMS(&timer, MQTT_REACTOR_READ_MS);
+        rc = cycle(c, &timer);
+    }
+#if MQTT_TLS_ENABLE == 1
+    while (rc > 0 && HT_MQTT_TLSPending() > 0);
+#else
+    while (0);
+#endif
+
+    /* A closed or reset socket stays readable. Stop watching it and leave
+     * the reconnect to the keepalive tick, as the mqttRecv task did. */
+    if (rc <= 0 && socketIsDead(c))
+        mwReactorDelSocket(fd);
+
+    MutexUnlock(&mqttMutex1);
+#if defined(MQTT_TASK)
+    MutexUnlock(&c->mutex);
+#endif
+}
+
+static void MQTTReactorTick(MwReactorTimer *timer, void *arg)
+{
+    MQTTClient* c = (MQTTClient*)arg;
+
+#if defined(MQTT_TASK)
+    MutexLock(&c->mutex);
+#endif
+    MutexLock(&mqttMutex1);
+    if (c->isconnected)
+        keepaliveCheck(c);
+    MutexUnlock(&mqttMutex1);
+#if defined(MQTT_TASK)
+    MutexUnlock(&c->mutex);
+#endif
+}
+
+int MQTTStartReactor(MQTTClient* c)
+{
+    MQTTRunInit();
+
+    if (mwReactorStart() != MW_REACTOR_OK)
+        return FAILURE;
+
+    /* Started again after a reconnect */
+    mwReactorTimerStop(&c->reactorTimer);
+    mwReactorTimerInit(&c->reactorTimer, MQTTReactorTick, c);
+    if (mwReactorAddSocket(c->ipstack->my_socket, MW_REACTOR_EV_READ, MQTTReactorRead, c) != MW_REACTOR_OK)
+        return FAILURE;
+
+    if (mwReactorTimerStart(&c->reactorTimer, MQTT_REACTOR_TICK_MS, MQTT_REACTOR_TICK_MS) != MW_REACTOR_OK)
+    {
+        mwReactorDelSocket(c->ipstack->my_socket);
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/* Call before the socket is closed; MQTTReConnect() and MQTTDisconnect() do. */
+void MQTTStopReactor(MQTTClient* c)
+{
+    mwReactorTimerStop(&c->reactorTimer);
+    mwReactorDelSocket(c->ipstack->my_socket);
+}
+#endif
+
 int MQTTStartRECVTask(MQTTClient* c)
 {
+#if defined(MQTT_USE_REACTOR)
+    return MQTTStartReactor(c);
+#else
     osThreadAttr_t task_attr;
 
     memset(&task_attr, 0, sizeof(task_attr));
@@ -711,6 +865,7 @@ int MQTTStartRECVTask(MQTTClient* c)
     }
 
     return SUCCESS;
+#endif
 }
 
 int waitfor(MQTTClient* c, int packet_type, Timer* timer)
@@ -760,7 +915,7 @@ int MQTTConnectWithResults(MQTTClient* c, MQTTPacket_connectData* options, MQTTC
     {
         data->rc = 0;
         data->sessionPresent = 0;
-        if (MQTTDeserialize_connack(&data->sessionPresent, &data->rc, c->readbuf, c->readbuf_size) == 1)
+        if (MQTTDeserialize_connack(&data->sessionPresent, &data->rc, MQTT_RXBUF(c), MQTT_RXBUF_SIZE(c)) == 1)
             rc = data->rc;
         else
             rc = FAILURE;
@@ -786,6 +941,10 @@ int MQTTReConnect(MQTTClient* client, MQTTPacket_connectData* connectData)
 {
     int ret = FAILURE;
 
+#if defined(MQTT_USE_REACTOR)
+    /* The reactor must let go of the socket before it is closed */
+    MQTTStopReactor(client);
+#endif
     client->ipstack->disconnect(client->ipstack);
 
     if ((NetworkSetConnTimeout(client->ipstack, MQTT_SEND_TIMEOUT, MQTT_RECV_TIMEOUT)) != 0)
@@ -808,7 +967,11 @@ int MQTTReConnect(MQTTClient* client, MQTTPacket_connectData* connectData)
             }
             else
             {
+#if defined(MQTT_USE_REACTOR)
+                ret = MQTTStartReactor(client);
+#else
                 ret = SUCCESS;
+#endif
             }
         }
     }
@@ -893,7 +1056,7 @@ int MQTTSubscribeWithResults(MQTTClient* c, const char* topicFilter, enum QoS qo
         unsigned short mypacketid;
         data->grantedQoS = QOS0;
         mqttQos = (int)data->grantedQoS;
-        if (MQTTDeserialize_suback(&mypacketid, 1, &count, (int*)&mqttQos, c->readbuf, c->readbuf_size) == 1)
+        if (MQTTDeserialize_suback(&mypacketid, 1, &count, (int*)&mqttQos, MQTT_RXBUF(c), MQTT_RXBUF_SIZE(c)) == 1)
         {
             if (data->grantedQoS != 0x80)
                 rc = MQTTSetMessageHandler(c, topicFilter, messageHandler);
@@ -949,7 +1112,7 @@ int MQTTUnsubscribe(MQTTClient* c, const char* topicFilter)
     if (waitfor(c, UNSUBACK, &timer) == UNSUBACK)
     {
         unsigned short mypacketid;  // should be the same as the packetid above
-        if (MQTTDeserialize_unsuback(&mypacketid, c->readbuf, c->readbuf_size) == 1)
+        if (MQTTDeserialize_unsuback(&mypacketid, MQTT_RXBUF(c), MQTT_RXBUF_SIZE(c)) == 1)
         {
             /* remove the subscription message handler associated with this topic, if there is one */
             MQTTSetMessageHandler(c, topicFilter, NULL);
@@ -1004,7 +1167,7 @@ int MQTTPublish(MQTTClient* c, const char* topicName, MQTTMessage* message)
         {
             unsigned short mypacketid;
             unsigned char dup, type;
-            if (MQTTDeserialize_ack(&type, &dup, &mypacketid, c->readbuf, c->readbuf_size) != 1)
+            if (MQTTDeserialize_ack(&type, &dup, &mypacketid, MQTT_RXBUF(c), MQTT_RXBUF_SIZE(c)) != 1)
                 rc = FAILURE;
         }
         else
@@ -1016,7 +1179,7 @@ int MQTTPublish(MQTTClient* c, const char* topicName, MQTTMessage* message)
         {
             unsigned short mypacketid;
             unsigned char dup, type;
-            if (MQTTDeserialize_ack(&type, &dup, &mypacketid, c->readbuf, c->readbuf_size) != 1)
+            if (MQTTDeserialize_ack(&type, &dup, &mypacketid, MQTT_RXBUF(c), MQTT_RXBUF_SIZE(c)) != 1)
                 rc = FAILURE;
         }
         else
@@ -1039,12 +1202,83 @@ exit:
     return rc;
 }
 
+#if defined(MQTT_USE_UPLINK)
+/* Runs in the uplink task: data is the topic, its NUL, then the payload.
+ * Only the PUBLISH is sent here, the MQTT receive side takes its ack, so a
+ * slow broker does not hold up the classes queued behind it. */
+static INT32 MQTTUplinkSend(void *ctx, UINT32 param, const UINT8 *data, UINT16 len)
+{
+    MQTTClient* c = (MQTTClient*)ctx;
+    MQTTString topic = MQTTString_initializer;
+    int qos = (int)(param & 0x03);
+    unsigned short id = 0;
+    int payloadlen;
+    int rc = FAILURE;
+    Timer timer;
+
+    topic.cstring = (char*)data;
+    payloadlen = len - (int)strlen((const char*)data) - 1;
+
+#if defined(MQTT_TASK)
+    MutexLock(&c->mutex);
+#endif
+    if (mqttMutex1.sem != NULL)
+        MutexLock(&mqttMutex1);     /* c->buf is shared with cycle() */
+
+    if (!c->isconnected)
+        goto exit;
+
+    TimerInit(&timer);
+    TimerCountdownMS(&timer, c->command_timeout_ms);
+
+    if (qos == QOS1 || qos == QOS2)
+        id = getNextPacketId(c);
+
+    len = MQTTSerialize_publish(c->buf, c->buf_size, 0, qos, (unsigned char)((param >> 2) & 0x01), id,
+              topic, (unsigned char*)(data + len - payloadlen), payloadlen);
+    if (len > 0)
+        rc = sendPacket(c, len, &timer);
+
+exit:
+    if (mqttMutex1.sem != NULL)
+        MutexUnlock(&mqttMutex1);
+#if defined(MQTT_TASK)
+    MutexUnlock(&c->mutex);
+#endif
+    return (rc == SUCCESS) ? (INT32)payloadlen : FAILURE;
+}
+
+/* MQTTPublish() through the uplink arbiter (mw_uplink.h), which sends the
+ * message after anything queued in a higher class. Topic and payload are
+ * copied, the return value only says whether it was queued. */
+int MQTTPublishPrio(MQTTClient* c, int cls, const char* topicName, MQTTMessage* message)
+{
+    UINT32 param = ((UINT32)message->qos & 0x03) | ((UINT32)(message->retained ? 1 : 0) << 2);
+    size_t topicLen = strlen(topicName);
+
+    /* The arbiter keeps the topic, its NUL and the payload in one 16-bit length */
+    if (topicLen >= 0xFFFF || message->payloadlen > 0xFFFF - (topicLen + 1))
+        return FAILURE;
+
+    if (mwUplinkSubmitV((MwUplinkClass)cls, MQTTUplinkSend, NULL, c, param,
+                        (const UINT8*)topicName, (UINT16)(topicLen + 1),
+                        (const UINT8*)message->payload, (UINT16)message->payloadlen) != MW_UPLINK_OK)
+        return FAILURE;
+
+    return SUCCESS;
+}
+#endif
+
 int MQTTDisconnect(MQTTClient* c)
 {
     int rc = FAILURE;
     Timer timer;     // we might wait for incomplete incoming publishes to complete
     int len = 0;
 
+#if defined(MQTT_USE_REACTOR)
+    /* Before taking the mutex: a read callback running holds it until it returns */
+    MQTTStopReactor(c);
+#endif
 #if defined(MQTT_TASK)
     MutexLock(&c->mutex);
 #endif